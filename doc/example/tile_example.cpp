@@ -1,8 +1,9 @@
 // z.lib example code for tile-based threading.
 //
 // Example code demonstrates the use of z.lib to scale a single image by
-// dividing the output into tiles. For processing multiple images, it is
-// recommended to use frame-based threading for higher efficiency.
+// dividing the output into tiles, all of which are processed by the same
+// graph. For processing multiple images, it is recommended to use
+// frame-based threading for higher efficiency.
 
 #include <algorithm>
 #include <cstddef>
@@ -21,8 +22,8 @@
 #include "argparse.h"
 #include "win32_bitmap.h"
 
-#if ZIMG_API_VERSION < ZIMG_MAKE_API_VERSION(2, 1)
-  #error API 2.1 required
+#if ZIMG_API_VERSION < ZIMG_MAKE_API_VERSION(2, 5)
+  #error API 2.5 required
 #endif
 
 namespace {
@@ -59,32 +60,21 @@ const ArgparseCommandLine program_def = { program_switches, program_positional,
 
 
 struct TileTask {
-	zimgxx::zimage_format src_format;
-	zimgxx::zimage_format dst_format;
-	unsigned tile_left;
-	unsigned tile_top;
+	unsigned left;
+	unsigned top;
+	unsigned width;
+	unsigned height;
 };
 
-struct Callback {
-	const WindowsBitmap *in_bmp;
-	WindowsBitmap *out_bmp;
-	const TileTask *task;
-	const zimgxx::zimage_buffer *src_buf;
-	const zimgxx::zimage_buffer *dst_buf;
-};
-
-std::pair<zimgxx::zimage_buffer, std::shared_ptr<void>> allocate_buffer(const zimgxx::zimage_format &format, unsigned count)
+std::pair<zimgxx::zimage_buffer, std::shared_ptr<void>> allocate_buffer(const zimgxx::zimage_format &format)
 {
 	zimgxx::zimage_buffer buffer;
 	std::shared_ptr<void> handle;
 	unsigned char *ptr;
 
-	unsigned mask = zimg_select_buffer_mask(count);
 	size_t channel_size[3] = { 0 };
 	size_t pixel_size;
 
-	count = (mask == ZIMG_BUFFER_MAX) ? format.height : mask + 1;
-
 	if (format.pixel_type == ZIMG_PIXEL_FLOAT)
 		pixel_size = sizeof(float);
 	else if (format.pixel_type == ZIMG_PIXEL_WORD || format.pixel_type == ZIMG_PIXEL_HALF)
@@ -93,17 +83,17 @@ std::pair<zimgxx::zimage_buffer, std::shared_ptr<void>> allocate_buffer(const zi
 		pixel_size = sizeof(uint8_t);
 
 	for (unsigned p = 0; p < (format.color_family == ZIMG_COLOR_GREY ? 1U : 3U); ++p) {
-		unsigned count_plane = p ? count >> format.subsample_h : count;
-		unsigned mask_plane = (mask == ZIMG_BUFFER_MAX) ? mask : mask >> format.subsample_h;
-		size_t row_size = format.width * pixel_size;
-		ptrdiff_t stride = (row_size + 31) & ~31;
+		unsigned width = p ? format.width >> format.subsample_w : format.width;
+		unsigned height = p ? format.height >> format.subsample_h : format.height;
+		size_t row_size = width * pixel_size;
+		ptrdiff_t stride = (row_size + 63) & ~63;
 
-		buffer.mask(p) = mask_plane;
+		buffer.mask(p) = ZIMG_BUFFER_MAX;
 		buffer.stride(p) = stride;
-		channel_size[p] = static_cast<size_t>(stride) * count_plane;
+		channel_size[p] = static_cast<size_t>(stride) * height;
 	}
 
-	handle.reset(aligned_malloc(channel_size[0] + channel_size[1] + channel_size[2], 32), &aligned_free);
+	handle.reset(aligned_malloc(channel_size[0] + channel_size[1] + channel_size[2], 64), &aligned_free);
 	ptr = static_cast<unsigned char *>(handle.get());
 
 	for (unsigned p = 0; p < (format.color_family == ZIMG_COLOR_GREY ? 1U : 3U); ++p) {
@@ -116,69 +106,66 @@ std::pair<zimgxx::zimage_buffer, std::shared_ptr<void>> allocate_buffer(const zi
 
 std::shared_ptr<void> allocate_buffer(size_t size)
 {
-	return{ aligned_malloc(size, 32), &aligned_free };
+	return{ aligned_malloc(size, 64), &aligned_free };
 }
 
-int unpack_bmp(void *user, unsigned i, unsigned left, unsigned right)
+void unpack_bmp(const WindowsBitmap &bmp, const zimgxx::zimage_buffer &buf)
 {
-	Callback *cb = static_cast<Callback *>(user);
-
-	// Pixel indices in the input image are relative to the whole image.
-	const uint8_t *packed_bgr = cb->in_bmp->read_ptr() + static_cast<ptrdiff_t>(i) * cb->in_bmp->stride();
-	uint8_t *planar_r = static_cast<uint8_t *>(cb->src_buf->line_at(i, 0));
-	uint8_t *planar_g = static_cast<uint8_t *>(cb->src_buf->line_at(i, 1));
-	uint8_t *planar_b = static_cast<uint8_t *>(cb->src_buf->line_at(i, 2));
-	unsigned step = cb->in_bmp->bit_count() / 8;
-
-	for (unsigned j = left; j < right; ++j) {
-		uint8_t r, g, b;
-
-		b = packed_bgr[j * step + 0];
-		g = packed_bgr[j * step + 1];
-		r = packed_bgr[j * step + 2];
-
-		planar_r[j] = r;
-		planar_g[j] = g;
-		planar_b[j] = b;
+	unsigned step = bmp.bit_count() / 8;
+
+	for (unsigned i = 0; i < static_cast<unsigned>(bmp.height()); ++i) {
+		const uint8_t *packed_bgr = bmp.read_ptr() + static_cast<ptrdiff_t>(i) * bmp.stride();
+		uint8_t *planar_r = static_cast<uint8_t *>(buf.line_at(i, 0));
+		uint8_t *planar_g = static_cast<uint8_t *>(buf.line_at(i, 1));
+		uint8_t *planar_b = static_cast<uint8_t *>(buf.line_at(i, 2));
+
+		for (unsigned j = 0; j < static_cast<unsigned>(bmp.width()); ++j) {
+			planar_b[j] = packed_bgr[j * step + 0];
+			planar_g[j] = packed_bgr[j * step + 1];
+			planar_r[j] = packed_bgr[j * step + 2];
+		}
 	}
-
-	return 0;
 }
 
-int pack_bmp(void *user, unsigned i, unsigned left, unsigned right)
+void pack_bmp(const zimgxx::zimage_buffer &buf, WindowsBitmap *bmp, const TileTask &task)
 {
-	Callback *cb = static_cast<Callback *>(user);
-
-	// Pixel indices in the output image are relative to the tile.
-	const uint8_t *planar_r = static_cast<const uint8_t *>(cb->dst_buf->line_at(i, 0));
-	const uint8_t *planar_g = static_cast<const uint8_t *>(cb->dst_buf->line_at(i, 1));
-	const uint8_t *planar_b = static_cast<const uint8_t *>(cb->dst_buf->line_at(i, 2));
-	uint8_t *packed_bgr = cb->out_bmp->write_ptr() + static_cast<ptrdiff_t>(i + cb->task->tile_top) * cb->out_bmp->stride() + (cb->task->tile_left * cb->out_bmp->bit_count() / 8);
-	unsigned step = cb->out_bmp->bit_count() / 8;
-
-	for (unsigned j = left; j < right; ++j) {
-		uint8_t r, g, b;
-
-		r = planar_r[j];
-		g = planar_g[j];
-		b = planar_b[j];
-
-		packed_bgr[j * step + 0] = b;
-		packed_bgr[j * step + 1] = g;
-		packed_bgr[j * step + 2] = r;
+	unsigned step = bmp->bit_count() / 8;
+
+	// Pixel indices are relative to the whole image.
+	for (unsigned i = task.top; i < task.top + task.height; ++i) {
+		const uint8_t *planar_r = static_cast<const uint8_t *>(buf.line_at(i, 0));
+		const uint8_t *planar_g = static_cast<const uint8_t *>(buf.line_at(i, 1));
+		const uint8_t *planar_b = static_cast<const uint8_t *>(buf.line_at(i, 2));
+		uint8_t *packed_bgr = bmp->write_ptr() + static_cast<ptrdiff_t>(i) * bmp->stride();
+
+		for (unsigned j = task.left; j < task.left + task.width; ++j) {
+			packed_bgr[j * step + 0] = planar_b[j];
+			packed_bgr[j * step + 1] = planar_g[j];
+			packed_bgr[j * step + 2] = planar_r[j];
+		}
 	}
-
-	return 0;
 }
 
-void thread_func(const WindowsBitmap *in_bmp, WindowsBitmap *out_bmp, std::vector<TileTask> *tasks, std::mutex *mutex, std::exception_ptr *eptr, bool interactive);
+struct ThreadContext {
+	const zimgxx::FilterGraph *graph;
+	const zimgxx::zimage_buffer *src_buf;
+	const zimgxx::zimage_buffer *dst_buf;
+	WindowsBitmap *out_bmp;
+	std::vector<TileTask> *tasks;
+	std::mutex *mutex;
+	std::exception_ptr *eptr;
+	size_t tmp_size;
+	bool interactive;
+};
+
+void thread_func(ThreadContext ctx);
 
 void execute(const Arguments &args)
 {
 	WindowsBitmap in_bmp{ args.inpath, WindowsBitmap::READ_TAG };
 	WindowsBitmap out_bmp{ args.outpath, static_cast<int>(args.out_w), static_cast<int>(args.out_h), 24 };
 
-	// (1) Fill the common fields in the format descriptors for the input and output files.
+	// (1) Fill the format descriptors for the input and output files.
 	zimgxx::zimage_format in_format;
 	zimgxx::zimage_format out_format;
 
@@ -188,48 +175,37 @@ void execute(const Arguments &args)
 	in_format.color_family = ZIMG_COLOR_RGB;
 	in_format.pixel_range = ZIMG_RANGE_FULL;
 
+	out_format.width = out_bmp.width();
+	out_format.height = out_bmp.height();
 	out_format.pixel_type = ZIMG_PIXEL_BYTE;
 	out_format.color_family = ZIMG_COLOR_RGB;
 	out_format.pixel_range = ZIMG_RANGE_FULL;
 
-	std::vector<TileTask> task_queue;
-
-	// (2) Calculate the bounds of the input regions from the output regions. For
-	// each tile, a graph creates an image of tile_width x tile_height from a
-	// subset of the input image. Note that the input tile is specified through
-	// the active_region field, unlike the output tile.
-	double scale_w = static_cast<double>(in_bmp.width()) / args.out_w;
-	double scale_h = static_cast<double>(in_bmp.height()) / args.out_h;
+	// (2) Build a single graph for the whole image. Tiles are processed from
+	// the same graph, so filter coefficients are computed only once.
+	zimgxx::FilterGraph graph{ zimgxx::FilterGraph::build(in_format, out_format) };
 
-	// The destination buffer passed to zimg_filter_graph_process will point to
-	// the upper-left corner of the tile. As a result, when not using a pack
-	// callback, incrementing the output image by tile_width pixels must
-	// maintain alignment.
-	if (args.tile_width % 32)
-		std::cout << "warning: tile width results in unaligned image\n";
+	// (3) Divide the output into tiles. Each thread needs a temporary buffer
+	// large enough for the biggest tile.
+	std::vector<TileTask> task_queue;
+	size_t tmp_size = 0;
 
 	for (unsigned i = 0; i < args.out_h; i += args.tile_height) {
 		for (unsigned j = 0; j < args.out_w; j += args.tile_width) {
-			zimgxx::zimage_format tile_in_format = in_format;
-			zimgxx::zimage_format tile_out_format = out_format;
-
-			unsigned tile_right = out_bmp.width() - j >= args.tile_width ? j + args.tile_width : out_bmp.width();
-			unsigned tile_bottom = out_bmp.height() - i >= args.tile_height ? i + args.tile_height : out_bmp.height();
-
-			tile_in_format.active_region.left = j * scale_w;
-			tile_in_format.active_region.top = i * scale_h;
-			tile_in_format.active_region.width = (tile_right - j) * scale_w;
-			tile_in_format.active_region.height = (tile_bottom - i) * scale_h;
+			unsigned tile_width = std::min(args.tile_width, args.out_w - j);
+			unsigned tile_height = std::min(args.tile_height, args.out_h - i);
 
-			tile_out_format.width = tile_right - j;
-			tile_out_format.height = tile_bottom - i;
-
-			task_queue.push_back({ tile_in_format, tile_out_format, j, i });
+			tmp_size = std::max(tmp_size, graph.get_tmp_size_region(j, i, tile_width, tile_height));
+			task_queue.push_back({ j, i, tile_width, tile_height });
 		}
 	}
 
-	// (3) Distribute the tiles across threads. Note that the calls to
-	// zimg_filter_graph_create must also be parallelized for maximum effect.
+	// (4) Region processing operates on whole images in memory.
+	auto src_buf = allocate_buffer(in_format);
+	auto dst_buf = allocate_buffer(out_format);
+	unpack_bmp(in_bmp, src_buf.first);
+
+	// (5) Distribute the tiles across threads.
 	std::vector<std::thread> threads;
 	unsigned num_threads = args.interactive ? 1 : (args.threads ? args.threads : std::thread::hardware_concurrency());
 	std::exception_ptr eptr;
@@ -240,7 +216,8 @@ void execute(const Arguments &args)
 
 	threads.reserve(num_threads);
 	for (unsigned i = 0; i < num_threads; ++i) {
-		threads.emplace_back(thread_func, &in_bmp, &out_bmp, &task_queue, &mutex, &eptr, !!args.interactive);
+		ThreadContext ctx{ &graph, &src_buf.first, &dst_buf.first, &out_bmp, &task_queue, &mutex, &eptr, tmp_size, !!args.interactive };
+		threads.emplace_back(thread_func, ctx);
 	}
 
 	for (std::thread &th : threads) {
@@ -251,45 +228,34 @@ void execute(const Arguments &args)
 		std::rethrow_exception(eptr);
 }
 
-void thread_func(const WindowsBitmap *in_bmp, WindowsBitmap *out_bmp, std::vector<TileTask> *tasks, std::mutex *mutex, std::exception_ptr *eptr, bool interactive)
+void thread_func(ThreadContext ctx)
 {
 	try {
+		// (6) Allocate a private temporary buffer.
+		auto tmp = allocate_buffer(ctx.tmp_size);
+
 		while (true) {
-			std::unique_lock<std::mutex> lock{ *mutex };
-			if (tasks->empty())
+			std::unique_lock<std::mutex> lock{ *ctx.mutex };
+			if (ctx.tasks->empty())
 				break;
 
-			TileTask task = tasks->back();
-			tasks->pop_back();
+			TileTask task = ctx.tasks->back();
+			ctx.tasks->pop_back();
 			lock.unlock();
 
-			// (4) Build the processing context for the tile.
-			zimgxx::FilterGraph graph{ zimgxx::FilterGraph::build(task.src_format, task.dst_format) };
-			unsigned input_buffering = graph.get_input_buffering();
-			unsigned output_buffering = graph.get_output_buffering();
-			size_t tmp_size = graph.get_tmp_size();
-
-			if (input_buffering == ZIMG_BUFFER_MAX || output_buffering == ZIMG_BUFFER_MAX)
-				throw std::logic_error{ "graph can not be processed with tiles" };
-
-			// (5) Allocate scanline buffers for the input and output data.
-			auto src_buf = allocate_buffer(task.src_format, input_buffering);
-			auto dst_buf = allocate_buffer(task.dst_format, output_buffering);
-			auto tmp = allocate_buffer(tmp_size);
+			// (7) Process the tile. Only the pixels in the tile are written.
+			ctx.graph->process_region(ctx.src_buf->as_const(), *ctx.dst_buf, tmp.get(), task.left, task.top, task.width, task.height);
+			pack_bmp(*ctx.dst_buf, ctx.out_bmp, task);
 
-			// (6) Process the tile.
-			Callback cb{ in_bmp, out_bmp, &task, &src_buf.first, &dst_buf.first };
-			graph.process(src_buf.first.as_const(), dst_buf.first, tmp.get(), unpack_bmp, &cb, pack_bmp, &cb);
-
-			if (interactive) {
-				out_bmp->flush();
+			if (ctx.interactive) {
+				ctx.out_bmp->flush();
 				std::cout << "Press enter to continue...";
 				std::cin.get();
 			}
 		}
 	} catch (...) {
-		std::lock_guard<std::mutex> lock{ *mutex };
-		*eptr = std::current_exception();
+		std::lock_guard<std::mutex> lock{ *ctx.mutex };
+		*ctx.eptr = std::current_exception();
 	}
 }
 
@@ -307,21 +273,11 @@ int main(int argc, char **argv)
 	if ((ret = argparse_parse(&program_def, &args, argc, argv)) < 0)
 		return ret == ARGPARSE_HELP_MESSAGE ? 0 : ret;
 
-	if (zimg_get_api_version(nullptr, nullptr) < ZIMG_MAKE_API_VERSION(2, 1)) {
-		std::cerr << "error: subpixel operation requires API 2.1\n";
+	if (zimg_get_api_version(nullptr, nullptr) < ZIMG_MAKE_API_VERSION(2, 5)) {
+		std::cerr << "error: region processing requires API 2.5\n";
 		return 2;
 	}
 
-	// Prior to z.lib 2.9, using horizontal tiling results in redundant loading
-	// of scanlines above the first row in the tile.
-	if (args.tile_height < args.out_h) {
-		unsigned version[3];
-		zimg_get_version_info(version, version + 1, version + 2);
-
-		if (version[0] < 2 || (version[0] == 2 && version[1] < 9))
-			std::cerr << "warning: horizontal tiling may be slow in z.lib versions prior to 2.9\n";
-	}
-
 	try {
 		execute(args);
 	} catch (const std::system_error &e) {
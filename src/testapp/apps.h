@@ -8,6 +8,10 @@
 "fullrange: f=fullrange, l=limited\n" \
 "chroma:    c=chroma, l=luma\n"
 
+#define FILTER_SPECIFIER_HELP_STR \
+"Resampling filter specifier: filter[:param_a[:param_b]]\n" \
+"filter: point, bilinear, bicubic, spline16, spline36, lanczos\n"
+
 struct ArgparseOption;
 
 #ifdef __cplusplus
@@ -18,9 +22,12 @@ int arg_decode_cpu(const struct ArgparseOption *opt, void *out, const char *para
 
 int arg_decode_pixfmt(const struct ArgparseOption *opt, void *out, const char *param, int negated);
 
+int arg_decode_filter(const struct ArgparseOption *opt, void *out, const char *param, int negated);
+
 int colorspace_main(int argc, char **argv);
 int cpuinfo_main(int argc, char **argv);
 int depth_main(int argc, char **argv);
+int filter_main(int argc, char **argv);
 int graph_main(int argc, char **argv);
 int resize_main(int argc, char **argv);
 int unresize_main(int argc, char **argv);
@@ -72,6 +72,7 @@ struct Arguments {
 	double peak_luminance;
 	char approximate_gamma;
 	char scene_referred;
+	unsigned lut3d_size;
 	const char *visualise_path;
 	unsigned times;
 	zimg::CPUClass cpu;
@@ -85,6 +86,7 @@ const ArgparseOption program_switches[] = {
 	{ OPTION_FLOAT,  nullptr, "peak-luminance", offsetof(Arguments, peak_luminance),    nullptr, "nominal peak luminance for SDR (cd/m^2)" },
 	{ OPTION_FLAG,   nullptr, "lut",            offsetof(Arguments, approximate_gamma), nullptr, "use LUT to evaluate transfer functions" },
 	{ OPTION_FLAG,   "s",     "scene-referred", offsetof(Arguments, scene_referred),    nullptr, "use scene-referred transfer functions" },
+	{ OPTION_UINT,   nullptr, "lut3d",          offsetof(Arguments, lut3d_size),        nullptr, "approximate conversion with 3D LUT of given size" },
 	{ OPTION_STRING, nullptr, "visualise",      offsetof(Arguments, visualise_path),    nullptr, "path to BMP file for visualisation" },
 	{ OPTION_UINT,   nullptr, "times",          offsetof(Arguments, times),             nullptr, "number of benchmark cycles" },
 	{ OPTION_USER1,  nullptr, "cpu",            offsetof(Arguments, cpu),               arg_decode_cpu, "select CPU type" },
@@ -138,10 +140,22 @@ int colorspace_main(int argc, char **argv)
 		    .set_csp_out(args.csp_out)
 		    .set_approximate_gamma(!!args.approximate_gamma)
 		    .set_scene_referred(!!args.scene_referred)
+		    .set_lut_size(args.lut3d_size)
 		    .set_cpu(args.cpu);
 		if (!std::isnan(args.peak_luminance))
 			conv.set_peak_luminance(args.peak_luminance);
 
+		if (args.lut3d_size && zimg::colorspace::is_lut3d_supported(args.csp_in)) {
+			unsigned samples = 2 * (args.lut3d_size - 1) + 1;
+			zimg::colorspace::Lut3DAccuracy accuracy = zimg::colorspace::measure_lut3d_accuracy(conv, samples);
+
+			std::cout << "3D LUT: " << args.lut3d_size << "^3 nodes, " << accuracy.num_samples << " samples\n";
+			std::cout << "max error: " << accuracy.max_error << '\n';
+			std::cout << "rms error: " << accuracy.rms_error << '\n';
+		} else if (args.lut3d_size) {
+			std::cerr << "warning: 3D LUT not supported for input colorspace\n";
+		}
+
 		auto convert = conv.create();
 		execute(convert.get(), &src_frame, &dst_frame, args.times);
 
@@ -102,7 +102,7 @@ const ArgparseOption program_positional[] = {
 };
 
 const char help_str[] =
-"Dithering methods: none, ordered, random, error_diffusion\n"
+"Dithering methods: none, ordered, random, error_diffusion, random_counter\n"
 "\n"
 PIXFMT_SPECIFIER_HELP_STR
 "\n"
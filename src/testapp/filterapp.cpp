@@ -0,0 +1,93 @@
+#include <cmath>
+#include <iostream>
+#include "common/except.h"
+#include "resize/filter.h"
+
+#include "apps.h"
+#include "argparse.h"
+#include "table.h"
+#include "timer.h"
+
+namespace {
+
+struct Arguments {
+	unsigned src_dim;
+	unsigned dst_dim;
+	zimg::resize::Filter *filter;
+	double shift;
+	double subwidth;
+	unsigned times;
+
+	Arguments(const Arguments &) = delete;
+
+	~Arguments() { delete filter; }
+
+	Arguments &operator=(const Arguments &) = delete;
+};
+
+const ArgparseOption program_switches[] = {
+	{ OPTION_USER1, nullptr, "filter",    offsetof(Arguments, filter),   arg_decode_filter, "select resampling filter" },
+	{ OPTION_FLOAT, nullptr, "shift",     offsetof(Arguments, shift),    nullptr, "subpixel shift" },
+	{ OPTION_FLOAT, nullptr, "sub-width", offsetof(Arguments, subwidth), nullptr, "active image width" },
+	{ OPTION_UINT,  nullptr, "times",     offsetof(Arguments, times),    nullptr, "number of benchmark cycles" },
+	{ OPTION_NULL }
+};
+
+const ArgparseOption program_positional[] = {
+	{ OPTION_UINT, nullptr, "src-dim", offsetof(Arguments, src_dim), nullptr, "input dimension" },
+	{ OPTION_UINT, nullptr, "dst-dim", offsetof(Arguments, dst_dim), nullptr, "output dimension" },
+	{ OPTION_NULL }
+};
+
+const ArgparseCommandLine program_def = {
+	program_switches,
+	program_positional,
+	"filter",
+	"benchmark resampling filter construction",
+	FILTER_SPECIFIER_HELP_STR
+};
+
+} // namespace
+
+
+int filter_main(int argc, char **argv)
+{
+	Arguments args{};
+	int ret;
+
+	args.shift = 0.0;
+	args.subwidth = NAN;
+	args.times = 1;
+
+	if ((ret = argparse_parse(&program_def, &args, argc, argv)) < 0)
+		return ret == ARGPARSE_HELP_MESSAGE ? 0 : ret;
+
+	if (!args.filter)
+		args.filter = g_resize_table["bicubic"](NAN, NAN).release();
+	if (std::isnan(args.subwidth))
+		args.subwidth = args.src_dim;
+
+	try {
+		zimg::resize::FilterContext filter{};
+
+		// The uncached variant is timed, so that each cycle computes the filter.
+		auto results = measure_benchmark(args.times, [&]()
+		{
+			filter = zimg::resize::compute_filter(*args.filter, args.src_dim, args.dst_dim, args.shift, args.subwidth);
+		}, [](unsigned n, double d)
+		{
+			std::cout << '#' << n << ": " << d << '\n';
+		});
+
+		double taps = static_cast<double>(filter.filter_width) * filter.filter_rows;
+
+		std::cout << "filter: " << filter.filter_rows << " rows x " << filter.filter_width << " taps\n";
+		std::cout << "avg: " << results.first << " (" << results.first * 1e9 / taps << " ns/tap)\n";
+		std::cout << "min: " << results.second << " (" << results.second * 1e9 / taps << " ns/tap)\n";
+	} catch (const zimg::error::Exception &e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	}
+
+	return 0;
+}
@@ -285,7 +285,7 @@ std::unique_ptr<zimg::graph::FilterGraph> setup_read_graph(const PathSpecifier &
 	}
 
 	graphengine::node_id sink_id = graph->add_sink(spec.planes, ids.data());
-	return std::make_unique<zimg::graph::FilterGraph>(std::move(graph), std::make_shared<std::vector<std::unique_ptr<graphengine::Filter>>>(std::move(filter_instances)), src_id, sink_id);
+	return std::make_unique<zimg::graph::FilterGraph>(std::move(graph), std::make_shared<std::vector<std::unique_ptr<graphengine::Filter>>>(std::move(filter_instances)), src_id, std::vector<graphengine::node_id>{ sink_id });
 }
 
 ImageFrame read_from_planar(const PathSpecifier &spec, unsigned width, unsigned height, zimg::PixelType type, bool fullrange)
@@ -464,7 +464,7 @@ std::unique_ptr<zimg::graph::FilterGraph> setup_write_graph(const PathSpecifier
 	}
 
 	graphengine::node_id sink_id = graph->add_sink(spec.planes, ids.data());
-	return std::make_unique<zimg::graph::FilterGraph>(std::move(graph), std::make_shared<std::vector<std::unique_ptr<graphengine::Filter>>>(std::move(filter_instances)), src_id, sink_id);
+	return std::make_unique<zimg::graph::FilterGraph>(std::move(graph), std::make_shared<std::vector<std::unique_ptr<graphengine::Filter>>>(std::move(filter_instances)), src_id, std::vector<graphengine::node_id>{ sink_id });
 }
 
 void write_to_planar(const ImageFrame &frame, const PathSpecifier &spec, unsigned depth_in, bool fullrange)
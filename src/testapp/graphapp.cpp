@@ -1,4 +1,5 @@
 #include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <fstream>
 #include <exception>
@@ -7,12 +8,14 @@
 #include <streambuf>
 #include <string>
 #include <thread>
+#include <vector>
 #include "common/alloc.h"
 #include "common/except.h"
 #include "common/static_map.h"
 #include "depth/depth.h"
 #include "graph/filtergraph.h"
 #include "graph/graphbuilder.h"
+#include "graph/profiler.h"
 #include "resize/filter.h"
 #include "resize/resize.h"
 #include "unresize/unresize.h"
@@ -291,6 +294,10 @@ void read_graph_params(zimg::graph::GraphBuilder::params *params, const JsonObje
 		params->approximate_gamma = val.boolean();
 	if (const auto &val = obj["scene_referred"])
 		params->scene_referred = val.boolean();
+	if (const auto &val = obj["colorspace_lut_size"])
+		params->colorspace_lut_size = static_cast<unsigned>(val.number());
+	if (const auto &val = obj["error_diffusion_threads"])
+		params->error_diffusion_threads = static_cast<unsigned>(val.number());
 	if (const auto &val = obj["cpu"])
 		params->cpu = lookup(g_cpu_table, val);
 }
@@ -298,7 +305,8 @@ void read_graph_params(zimg::graph::GraphBuilder::params *params, const JsonObje
 std::unique_ptr<zimg::graph::FilterGraph> create_graph(const json::Object &spec,
                                                        zimg::graph::GraphBuilder::state *src_state_out,
                                                        zimg::graph::GraphBuilder::state *dst_state_out,
-                                                       zimg::CPUClass cpu)
+                                                       zimg::CPUClass cpu,
+                                                       bool profile)
 {
 	zimg::graph::GraphBuilder::state src_state{};
 	zimg::graph::GraphBuilder::state dst_state{};
@@ -322,6 +330,11 @@ std::unique_ptr<zimg::graph::FilterGraph> create_graph(const json::Object &spec,
 
 		if (cpu >= static_cast<zimg::CPUClass>(0))
 			params.cpu = cpu;
+
+		if (profile) {
+			params.profile = true;
+			has_params = true;
+		}
 	} catch (const std::invalid_argument &e) {
 		throw std::runtime_error{ e.what() };
 	} catch (const std::out_of_range &e) {
@@ -374,11 +387,38 @@ void thread_target(const zimg::graph::FilterGraph *graph,
 	}
 }
 
-void execute(const json::Object &spec, unsigned times, unsigned threads, unsigned tile_width, zimg::CPUClass cpu)
+void print_profile(const zimg::graph::FilterProfiler &profiler, unsigned iterations)
+{
+	std::vector<zimg::graph::FilterProfiler::node_stats> stats = profiler.get_stats();
+	uint64_t total_ns = 0;
+
+	for (const auto &node : stats) {
+		total_ns += node.nanoseconds;
+	}
+
+	std::cout << '\n';
+	std::printf("%-14s %5s %11s %9s %10s %7s %10s %10s %8s\n", "filter", "plane", "size", "calls", "us/frame", "time", "MB in", "MB out", "skipped");
+
+	for (const auto &node : stats) {
+		char size[32];
+		std::snprintf(size, sizeof(size), "%ux%u", node.width, node.height);
+
+		std::printf("%-14s %5d %11s %9llu %10.1f %6.1f%% %10.2f %10.2f %7.1f%%\n",
+		            node.name, node.plane, size,
+		            static_cast<unsigned long long>(node.calls / iterations),
+		            node.nanoseconds / 1e3 / iterations,
+		            total_ns ? 100.0 * node.nanoseconds / total_ns : 0.0,
+		            node.bytes_read / 1e6 / iterations,
+		            node.bytes_written / 1e6 / iterations,
+		            node.pixels ? 100.0 * node.pixels_skipped / node.pixels : 0.0);
+	}
+}
+
+void execute(const json::Object &spec, unsigned times, unsigned threads, unsigned tile_width, zimg::CPUClass cpu, bool profile)
 {
 	zimg::graph::GraphBuilder::state src_state;
 	zimg::graph::GraphBuilder::state dst_state;
-	std::unique_ptr<zimg::graph::FilterGraph> graph = create_graph(spec, &src_state, &dst_state, cpu);
+	std::unique_ptr<zimg::graph::FilterGraph> graph = create_graph(spec, &src_state, &dst_state, cpu, profile);
 
 	if (tile_width)
 		graph->set_tile_width(tile_width);
@@ -421,6 +461,11 @@ void execute(const json::Object &spec, unsigned times, unsigned threads, unsigne
 		std::cout << "threads:    " << n << '\n';
 		std::cout << "iterations: " << times * n << '\n';
 		std::cout << "fps:        " << (times * n) / timer.elapsed() << '\n';
+
+		if (zimg::graph::FilterProfiler *profiler = graph->get_profiler()) {
+			print_profile(*profiler, times * n);
+			profiler->reset();
+		}
 	}
 }
 
@@ -431,6 +476,7 @@ struct Arguments {
 	unsigned threads;
 	unsigned tile_width;
 	zimg::CPUClass cpu;
+	char profile;
 };
 
 const ArgparseOption program_switches[] = {
@@ -438,6 +484,7 @@ const ArgparseOption program_switches[] = {
 	{ OPTION_UINT,  nullptr, "threads",    offsetof(Arguments, threads),    nullptr, "number of threads" },
 	{ OPTION_UINT,  nullptr, "tile-width", offsetof(Arguments, tile_width), nullptr, "graph tile width" },
 	{ OPTION_USER1, nullptr, "cpu",        offsetof(Arguments, cpu),        arg_decode_cpu, "select CPU type" },
+	{ OPTION_FLAG,  nullptr, "profile",    offsetof(Arguments, profile),    nullptr, "print time spent in each filter" },
 	{ OPTION_NULL }
 };
 
@@ -464,7 +511,7 @@ int graph_main(int argc, char **argv)
 
 	try {
 		json::Object spec = read_graph_spec(args.specpath);
-		execute(spec, args.times, args.threads, args.tile_width, args.cpu);
+		execute(spec, args.times, args.threads, args.tile_width, args.cpu, !!args.profile);
 	} catch (const zimg::error::Exception &e) {
 		std::cerr << e.what() << '\n';
 		return 2;
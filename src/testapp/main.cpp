@@ -1,8 +1,11 @@
+#include <cmath>
 #include <iostream>
 #include <regex>
+#include <stdexcept>
 #include <string>
 #include "common/except.h"
 #include "common/pixel.h"
+#include "resize/filter.h"
 
 #include "apps.h"
 #include "table.h"
@@ -17,6 +20,7 @@ void usage()
 	std::cout << "    colorspace - change colorspace\n";
 	std::cout << "    cpuinfo    - show CPU information\n";
 	std::cout << "    depth      - change depth\n";
+	std::cout << "    filter     - benchmark resampling filter construction\n";
 	std::cout << "    graph      - benchmark filter graph\n";
 	std::cout << "    graph2     - benchmark filter graph\n";
 	std::cout << "    resize     - resize images\n";
@@ -25,10 +29,11 @@ void usage()
 
 main_func lookup_app(const char *name)
 {
-	static const zimg::static_string_map<main_func, 7> map{
+	static const zimg::static_string_map<main_func, 8> map{
 		{ "colorspace", colorspace_main },
 		{ "cpuinfo",    cpuinfo_main },
 		{ "depth",      depth_main },
+		{ "filter",     filter_main },
 		{ "graph",     graph_main },
 		{ "resize",     resize_main },
 		{ "unresize",   unresize_main }
@@ -82,6 +87,36 @@ int arg_decode_pixfmt(const struct ArgparseOption *, void *out, const char *para
 	return 0;
 }
 
+int arg_decode_filter(const struct ArgparseOption *, void *out, const char *param, int)
+{
+	try {
+		zimg::resize::Filter **filter = static_cast<zimg::resize::Filter **>(out);
+		std::regex filter_regex{ R"(^(point|bilinear|bicubic|spline16|spline36|lanczos)(?::([\w.+-]+)(?::([\w.+-]+))?)?$)" };
+		std::cmatch match;
+		std::string filter_str;
+		double param_a = NAN;
+		double param_b = NAN;
+
+		if (!std::regex_match(param, match, filter_regex))
+			throw std::runtime_error{ "bad filter string" };
+
+		filter_str = match[1];
+
+		if (match.size() >= 2 && match[2].length())
+			param_a = std::stod(match[2]);
+		if (match.size() >= 3 && match[3].length())
+			param_b = std::stod(match[3]);
+
+		*filter = g_resize_table[filter_str.c_str()](param_a, param_b).release();
+	} catch (const std::exception &e) {
+		std::cerr << "error parsing filter: " << param << '\n';
+		std::cerr << e.what() << '\n';
+		return -1;
+	}
+
+	return 0;
+}
+
 
 int main(int argc, char **argv)
 {
@@ -110,11 +110,12 @@ const zimg::static_string_map<ColorPrimaries, 12> g_primaries_table{
 	{ "ebu",       ColorPrimaries::EBU_3213_E },
 };
 
-const zimg::static_string_map<DitherType, 4> g_dither_table{
+const zimg::static_string_map<DitherType, 5> g_dither_table{
 	{ "none",            DitherType::NONE },
 	{ "ordered",         DitherType::ORDERED },
 	{ "random",          DitherType::RANDOM },
 	{ "error_diffusion", DitherType::ERROR_DIFFUSION },
+	{ "random_counter",  DitherType::RANDOM_COUNTER },
 };
 
 const zimg::static_string_map<std::unique_ptr<zimg::resize::Filter>(*)(double, double), 8> g_resize_table{
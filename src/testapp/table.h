@@ -39,7 +39,7 @@ extern const zimg::static_string_map<zimg::PixelType, 4> g_pixel_table;
 extern const zimg::static_string_map<zimg::colorspace::MatrixCoefficients, 12> g_matrix_table;
 extern const zimg::static_string_map<zimg::colorspace::TransferCharacteristics, 13> g_transfer_table;
 extern const zimg::static_string_map<zimg::colorspace::ColorPrimaries, 12> g_primaries_table;
-extern const zimg::static_string_map<zimg::depth::DitherType, 4> g_dither_table;
+extern const zimg::static_string_map<zimg::depth::DitherType, 5> g_dither_table;
 extern const zimg::static_string_map<std::unique_ptr<zimg::resize::Filter>(*)(double, double), 8> g_resize_table;
 
 #endif // TABLE_H_
@@ -196,6 +196,13 @@ public:
 		return ret;
 	}
 
+	size_t get_tmp_size_region(unsigned left, unsigned top, unsigned width, unsigned height) const
+	{
+		size_t ret;
+		check(zimg_filter_graph_get_tmp_size_region(m_graph, left, top, width, height, &ret));
+		return ret;
+	}
+
 	unsigned get_input_buffering() const
 	{
 		unsigned ret;
@@ -217,6 +224,25 @@ public:
 		check(zimg_filter_graph_process(m_graph, &src, &dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user));
 	}
 
+	void process_multi(const zimg_image_buffer_const &src, const zimg_image_buffer * const dst[], unsigned num_outputs, void *tmp,
+	                   zimg_filter_graph_callback unpack_cb = 0, void *unpack_user = 0,
+	                   const zimg_filter_graph_callback pack_cb[] = 0, void * const pack_user[] = 0) const
+	{
+		check(zimg_filter_graph_process_multi(m_graph, &src, dst, num_outputs, tmp, unpack_cb, unpack_user, pack_cb, pack_user));
+	}
+
+	void process_region(const zimg_image_buffer_const &src, const zimg_image_buffer &dst, void *tmp,
+	                    unsigned left, unsigned top, unsigned width, unsigned height) const
+	{
+		check(zimg_filter_graph_process_region(m_graph, &src, &dst, tmp, left, top, width, height));
+	}
+
+	void process_mt(const zimg_image_buffer_const &src, const zimg_image_buffer &dst, unsigned num_threads = 0,
+	                zimg_filter_graph_dispatch_callback dispatch_cb = 0, void *dispatch_user = 0) const
+	{
+		check(zimg_filter_graph_process_mt(m_graph, &src, &dst, num_threads, dispatch_cb, dispatch_user));
+	}
+
 #if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
 	static FilterGraph build(const zimg_image_format &src_format, const zimg_image_format &dst_format, const zimg_graph_builder_params *params = 0)
 	{
@@ -227,6 +253,28 @@ public:
 
 		return FilterGraph(graph);
 	}
+
+	static FilterGraph build_multi(const zimg_image_format &src_format, const zimg_image_format * const dst_formats[], unsigned num_outputs,
+	                               const zimg_graph_builder_params *params = 0)
+	{
+		zimg_filter_graph *graph;
+
+		if (!(graph = zimg_filter_graph_build_multi(&src_format, dst_formats, num_outputs, params)))
+			throw zerror();
+
+		return FilterGraph(graph);
+	}
+
+	static FilterGraph build_pyramid(const zimg_image_format &src_format, const zimg_image_format &dst_format, unsigned num_levels,
+	                                 const zimg_graph_builder_params *params = 0)
+	{
+		zimg_filter_graph *graph;
+
+		if (!(graph = zimg_filter_graph_build_pyramid(&src_format, &dst_format, num_levels, params)))
+			throw zerror();
+
+		return FilterGraph(graph);
+	}
 #else
 	static zimg_filter_graph *build(const zimg_image_format &src_format, const zimg_image_format &dst_format, const zimg_graph_builder_params *params = 0)
 	{
@@ -237,6 +285,28 @@ public:
 
 		return graph;
 	}
+
+	static zimg_filter_graph *build_multi(const zimg_image_format &src_format, const zimg_image_format * const dst_formats[], unsigned num_outputs,
+	                                      const zimg_graph_builder_params *params = 0)
+	{
+		zimg_filter_graph *graph;
+
+		if (!(graph = zimg_filter_graph_build_multi(&src_format, dst_formats, num_outputs, params)))
+			throw zerror();
+
+		return graph;
+	}
+
+	static zimg_filter_graph *build_pyramid(const zimg_image_format &src_format, const zimg_image_format &dst_format, unsigned num_levels,
+	                                        const zimg_graph_builder_params *params = 0)
+	{
+		zimg_filter_graph *graph;
+
+		if (!(graph = zimg_filter_graph_build_pyramid(&src_format, &dst_format, num_levels, params)))
+			throw zerror();
+
+		return graph;
+	}
 #endif
 };
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <memory>
@@ -5,6 +6,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include "common/cpuinfo.h"
 #include "common/except.h"
 #include "common/pixel.h"
@@ -12,6 +14,8 @@
 #include "common/zassert.h"
 #include "graph/filtergraph.h"
 #include "graph/graphbuilder.h"
+#include "graph/graphcache.h"
+#include "graph/profiler.h"
 #include "colorspace/colorspace.h"
 #include "depth/depth.h"
 #include "resize/filter.h"
@@ -25,6 +29,9 @@ constexpr unsigned API_VERSION_2_0 = ZIMG_MAKE_API_VERSION(2, 0);
 constexpr unsigned API_VERSION_2_1 = ZIMG_MAKE_API_VERSION(2, 1);
 constexpr unsigned API_VERSION_2_2 = ZIMG_MAKE_API_VERSION(2, 2);
 constexpr unsigned API_VERSION_2_4 = ZIMG_MAKE_API_VERSION(2, 4);
+constexpr unsigned API_VERSION_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+
+static_assert(ZIMG_FILTER_GRAPH_MAX_OUTPUTS == zimg::graph::FilterGraph::MAX_OUTPUTS, "");
 
 #define API_VERSION_ASSERT(x) zassert_d((x) >= API_VERSION_2_0, "API version invalid")
 #define POINTER_ALIGNMENT_ASSERT(x) zassert_d(!(x) || reinterpret_cast<uintptr_t>(x) % zimg::ALIGNMENT_RELAXED == 0, "pointer not aligned")
@@ -313,11 +320,12 @@ zimg::depth::DitherType translate_dither(zimg_dither_type_e dither)
 {
 	using zimg::depth::DitherType;
 
-	static constexpr const zimg::static_map<zimg_dither_type_e, DitherType, 4> map{
+	static constexpr const zimg::static_map<zimg_dither_type_e, DitherType, 5> map{
 		{ ZIMG_DITHER_NONE,            DitherType::NONE },
 		{ ZIMG_DITHER_ORDERED,         DitherType::ORDERED },
 		{ ZIMG_DITHER_RANDOM,          DitherType::RANDOM },
 		{ ZIMG_DITHER_ERROR_DIFFUSION, DitherType::ERROR_DIFFUSION },
+		{ ZIMG_DITHER_RANDOM_COUNTER,  DitherType::RANDOM_COUNTER },
 	};
 	return search_enum_map(map, dither, "unrecognized dither type");
 }
@@ -371,6 +379,32 @@ std::array<graphengine::BufferDescriptor, 4> import_image_buffer(const T &src)
 	return dst;
 }
 
+void check_buffer_alignment(const zimg::graph::FilterGraph *graph, const zimg_image_buffer_const &src, const zimg_image_buffer &dst)
+{
+	unsigned src_planes = src.version >= API_VERSION_2_4 ? 4 : 3;
+	unsigned dst_planes = dst.version >= API_VERSION_2_4 ? 4 : 3;
+
+	if (graph->requires_64b_alignment()) {
+		for (unsigned p = 0; p < src_planes; ++p) {
+			POINTER_ALIGNMENT64_ASSERT(src.plane[p].data);
+			STRIDE_ALIGNMENT64_ASSERT(src.plane[p].stride);
+		}
+		for (unsigned p = 0; p < dst_planes; ++p) {
+			POINTER_ALIGNMENT64_ASSERT(dst.plane[p].data);
+			STRIDE_ALIGNMENT64_ASSERT(dst.plane[p].stride);
+		}
+	} else {
+		for (unsigned p = 0; p < src_planes; ++p) {
+			POINTER_ALIGNMENT_ASSERT(src.plane[p].data);
+			STRIDE_ALIGNMENT_ASSERT(src.plane[p].stride);
+		}
+		for (unsigned p = 0; p < dst_planes; ++p) {
+			POINTER_ALIGNMENT_ASSERT(dst.plane[p].data);
+			STRIDE_ALIGNMENT_ASSERT(dst.plane[p].stride);
+		}
+	}
+}
+
 void import_graph_state_common(const zimg_image_format &src, zimg::graph::GraphBuilder::state *out)
 {
 	if (src.version >= API_VERSION_2_0) {
@@ -439,6 +473,39 @@ std::pair<zimg::graph::GraphBuilder::state, zimg::graph::GraphBuilder::state> im
 	return{ src_state, dst_state };
 }
 
+// The source colorspace is left unspecified when converting to the same
+// constants, so it must be reconciled with the other targets.
+std::pair<zimg::graph::GraphBuilder::state, std::vector<zimg::graph::GraphBuilder::state>>
+import_graph_state_multi(const zimg_image_format &src, const zimg_image_format * const dst[], unsigned num_dst)
+{
+	zimg::graph::GraphBuilder::state src_state{};
+	std::vector<zimg::graph::GraphBuilder::state> dst_states(num_dst);
+	bool src_colorspace_set = false;
+
+	for (unsigned i = 0; i < num_dst; ++i) {
+		zassert_d(dst[i], "null pointer");
+
+		zimg::graph::GraphBuilder::state src_state_i;
+		std::tie(src_state_i, dst_states[i]) = import_graph_state(src, *dst[i]);
+
+		bool noop = src_state_i.colorspace == zimg::colorspace::ColorspaceDefinition{} && dst_states[i].colorspace == zimg::colorspace::ColorspaceDefinition{};
+
+		if (i == 0 || (!src_colorspace_set && !noop)) {
+			for (unsigned j = 0; j < i; ++j) {
+				dst_states[j].colorspace = src_state_i.colorspace;
+			}
+			src_state = src_state_i;
+			src_colorspace_set = !noop;
+		} else if (noop) {
+			dst_states[i].colorspace = src_state.colorspace;
+		} else if (src_state_i.colorspace != src_state.colorspace) {
+			zimg::error::throw_<zimg::error::IllegalArgument>("outputs imply different source colorspaces");
+		}
+	}
+
+	return{ src_state, dst_states };
+}
+
 zimg::graph::GraphBuilder::params import_graph_params(const zimg_graph_builder_params &src, std::unique_ptr<zimg::resize::Filter> filters[2])
 {
 	API_VERSION_ASSERT(src.version);
@@ -459,10 +526,44 @@ zimg::graph::GraphBuilder::params import_graph_params(const zimg_graph_builder_p
 		params.peak_luminance = src.nominal_peak_luminance;
 		params.approximate_gamma = !!src.allow_approximate_gamma;
 	}
+	if (src.version >= API_VERSION_2_5) {
+		params.profile = !!src.enable_profiling;
+		params.colorspace_lut_size = src.colorspace_lut_size;
+		params.error_diffusion_threads = src.error_diffusion_threads;
+	}
 
 	return params;
 }
 
+void add_resize_filter_key(zimg::graph::GraphCache::Key &key, zimg_resample_filter_e filter_type, double param_a, double param_b)
+{
+	// Mirror the parameter defaults in translate_resize_filter.
+	key.add(static_cast<int>(filter_type));
+
+	if (filter_type == ZIMG_RESIZE_BICUBIC) {
+		key.add(std::isnan(param_a) ? zimg::resize::BicubicFilter::DEFAULT_B : param_a);
+		key.add(std::isnan(param_b) ? zimg::resize::BicubicFilter::DEFAULT_C : param_b);
+	} else if (filter_type == ZIMG_RESIZE_LANCZOS) {
+		key.add(std::isnan(param_a) ? zimg::resize::LanczosFilter::DEFAULT_TAPS : static_cast<unsigned>(std::max(param_a, 1.0)));
+	}
+}
+
+zimg::graph::GraphCache::Key make_graph_cache_key(const zimg::graph::GraphBuilder::state &src_state, const zimg::graph::GraphBuilder::state &dst_state,
+                                                  const zimg_graph_builder_params *params, const zimg::graph::GraphBuilder::params &graph_params)
+{
+	zimg::graph::GraphCache::Key key;
+	key.add(src_state).add(dst_state).add(graph_params);
+
+	if (params) {
+		add_resize_filter_key(key, params->resample_filter, params->filter_param_a, params->filter_param_b);
+		add_resize_filter_key(key, params->resample_filter_uv, params->filter_param_a_uv, params->filter_param_b_uv);
+	} else {
+		add_resize_filter_key(key, ZIMG_RESIZE_BICUBIC, NAN, NAN);
+		add_resize_filter_key(key, ZIMG_RESIZE_BILINEAR, NAN, NAN);
+	}
+	return key;
+}
+
 } // namespace
 
 
@@ -645,6 +746,141 @@ zimg_error_code_e zimg_filter_graph_process(const zimg_filter_graph *ptr, const
 	EX_END
 }
 
+zimg_error_code_e zimg_filter_graph_process_multi(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer * const dst[], unsigned num_outputs, void *tmp,
+                                                  zimg_filter_graph_callback unpack_cb, void *unpack_user,
+                                                  const zimg_filter_graph_callback pack_cb[], void * const pack_user[])
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(src, "null pointer");
+	zassert_d(dst, "null pointer");
+
+	EX_BEGIN
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+
+	if (num_outputs != graph->get_num_outputs())
+		zimg::error::throw_<zimg::error::IllegalArgument>("number of outputs does not match graph");
+
+	if (graph->requires_64b_alignment())
+		POINTER_ALIGNMENT64_ASSERT(tmp);
+	else
+		POINTER_ALIGNMENT_ASSERT(tmp);
+
+	std::array<graphengine::BufferDescriptor, 4> dst_buf[zimg::graph::FilterGraph::MAX_OUTPUTS];
+	for (unsigned i = 0; i < num_outputs; ++i) {
+		zassert_d(dst[i], "null pointer");
+		check_buffer_alignment(graph, *src, *dst[i]);
+		dst_buf[i] = import_image_buffer(*dst[i]);
+	}
+
+	auto src_buf = import_image_buffer(*src);
+	graph->process(src_buf, dst_buf, tmp, unpack_cb, unpack_user, pack_cb, pack_user);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_get_tmp_size_region(const zimg_filter_graph *ptr, unsigned left, unsigned top, unsigned width, unsigned height, size_t *out)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(out, "null pointer");
+
+	EX_BEGIN
+	*out = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr)->get_tmp_size(left, top, width, height);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_process_region(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                   unsigned left, unsigned top, unsigned width, unsigned height)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(src, "null pointer");
+	zassert_d(dst, "null pointer");
+
+	EX_BEGIN
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+
+	if (graph->requires_64b_alignment())
+		POINTER_ALIGNMENT64_ASSERT(tmp);
+	else
+		POINTER_ALIGNMENT_ASSERT(tmp);
+
+	check_buffer_alignment(graph, *src, *dst);
+
+	auto src_buf = import_image_buffer(*src);
+	auto dst_buf = import_image_buffer(*dst);
+	graph->process_region(src_buf, dst_buf, tmp, left, top, width, height);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_process_mt(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, unsigned num_threads,
+                                               zimg_filter_graph_dispatch_callback dispatch_cb, void *dispatch_user)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(src, "null pointer");
+	zassert_d(dst, "null pointer");
+
+	EX_BEGIN
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+
+	check_buffer_alignment(graph, *src, *dst);
+
+	auto src_buf = import_image_buffer(*src);
+	auto dst_buf = import_image_buffer(*dst);
+	graph->process_mt(src_buf, dst_buf, num_threads, dispatch_cb, dispatch_user);
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_get_stats(const zimg_filter_graph *ptr, zimg_filter_stats *stats, unsigned *count, unsigned version)
+{
+	zassert_d(ptr, "null pointer");
+	zassert_d(count, "null pointer");
+	API_VERSION_ASSERT(version);
+
+	EX_BEGIN
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+	const zimg::graph::FilterProfiler *profiler = graph->get_profiler();
+
+	if (!profiler)
+		zimg::error::throw_<zimg::error::UnsupportedOperation>("graph was built without profiling");
+
+	std::vector<zimg::graph::FilterProfiler::node_stats> node_stats = profiler->get_stats();
+
+	for (size_t i = 0; stats && i < std::min(static_cast<size_t>(*count), node_stats.size()); ++i) {
+		const zimg::graph::FilterProfiler::node_stats &src = node_stats[i];
+		zimg_filter_stats &dst = stats[i];
+
+		dst.version = version;
+
+		if (version >= API_VERSION_2_5) {
+			dst.name = src.name;
+			dst.plane = src.plane;
+			dst.width = src.width;
+			dst.height = src.height;
+			dst.calls = src.calls;
+			dst.pixels = src.pixels;
+			dst.bytes_read = src.bytes_read;
+			dst.bytes_written = src.bytes_written;
+			dst.seconds = src.nanoseconds / 1e9;
+			dst.pixels_skipped = src.pixels_skipped;
+		}
+	}
+	*count = static_cast<unsigned>(node_stats.size());
+	EX_END
+}
+
+zimg_error_code_e zimg_filter_graph_reset_stats(const zimg_filter_graph *ptr)
+{
+	zassert_d(ptr, "null pointer");
+
+	EX_BEGIN
+	const zimg::graph::FilterGraph *graph = assert_dynamic_type<const zimg::graph::FilterGraph>(ptr);
+	zimg::graph::FilterProfiler *profiler = graph->get_profiler();
+
+	if (!profiler)
+		zimg::error::throw_<zimg::error::UnsupportedOperation>("graph was built without profiling");
+
+	profiler->reset();
+	EX_END
+}
+
 #undef EX_BEGIN
 #undef EX_END
 
@@ -709,6 +945,11 @@ void zimg_graph_builder_params_default(zimg_graph_builder_params *ptr, unsigned
 		ptr->nominal_peak_luminance = NAN;
 		ptr->allow_approximate_gamma = 0;
 	}
+	if (version >= API_VERSION_2_5) {
+		ptr->enable_profiling = 0;
+		ptr->colorspace_lut_size = 0;
+		ptr->error_diffusion_threads = 0;
+	}
 }
 
 zimg_filter_graph *zimg_filter_graph_build(const zimg_image_format *src_format, const zimg_image_format *dst_format, const zimg_graph_builder_params *params)
@@ -727,13 +968,130 @@ zimg_filter_graph *zimg_filter_graph_build(const zimg_image_format *src_format,
 		if (params)
 			graph_params = import_graph_params(*params, filters);
 
+		zimg::graph::GraphCache &cache = zimg::graph::GraphCache::instance();
+		bool use_cache = cache.enabled() && !graph_params.profile;
+		zimg::graph::GraphCache::Key key;
+
+		if (use_cache) {
+			key = make_graph_cache_key(src_state, dst_state, params, graph_params);
+			if (std::unique_ptr<zimg::graph::FilterGraph> graph = cache.find(key))
+				return graph.release();
+		}
+
 		zimg::graph::GraphBuilder builder;
-		return builder.set_source(src_state)
+		std::unique_ptr<zimg::graph::FilterGraph> graph = builder.set_source(src_state)
 			.connect(dst_state, params ? &graph_params : nullptr)
-			.build_graph()
-			.release();
+			.build_graph();
+
+		if (use_cache)
+			cache.insert(key, *graph);
+
+		return graph.release();
 	} catch (...) {
 		handle_exception(std::current_exception());
 		return nullptr;
 	}
 }
+
+zimg_filter_graph *zimg_filter_graph_build_multi(const zimg_image_format *src_format, const zimg_image_format * const dst_formats[], unsigned num_outputs,
+                                                 const zimg_graph_builder_params *params)
+{
+	zassert_d(src_format, "null pointer");
+	zassert_d(dst_formats, "null pointer");
+
+	try {
+		zimg::graph::GraphBuilder::state src_state;
+		std::vector<zimg::graph::GraphBuilder::state> dst_states;
+		zimg::graph::GraphBuilder::params graph_params;
+
+		std::unique_ptr<zimg::resize::Filter> filters[2];
+
+		if (!num_outputs || num_outputs > zimg::graph::FilterGraph::MAX_OUTPUTS)
+			zimg::error::throw_<zimg::error::IllegalArgument>("invalid number of outputs");
+
+		std::tie(src_state, dst_states) = import_graph_state_multi(*src_format, dst_formats, num_outputs);
+		if (params)
+			graph_params = import_graph_params(*params, filters);
+
+		zimg::graph::GraphBuilder builder;
+		std::unique_ptr<zimg::graph::FilterGraph> graph = builder.set_source(src_state)
+			.connect(dst_states.data(), num_outputs, params ? &graph_params : nullptr)
+			.build_graph();
+
+		return graph.release();
+	} catch (...) {
+		handle_exception(std::current_exception());
+		return nullptr;
+	}
+}
+
+zimg_filter_graph *zimg_filter_graph_build_pyramid(const zimg_image_format *src_format, const zimg_image_format *dst_format, unsigned num_levels,
+                                                   const zimg_graph_builder_params *params)
+{
+	zassert_d(src_format, "null pointer");
+	zassert_d(dst_format, "null pointer");
+
+	try {
+		zimg::graph::GraphBuilder::state src_state;
+		zimg::graph::GraphBuilder::state dst_state;
+		zimg::graph::GraphBuilder::params graph_params;
+
+		std::unique_ptr<zimg::resize::Filter> filters[2];
+
+		std::tie(src_state, dst_state) = import_graph_state(*src_format, *dst_format);
+		if (params)
+			graph_params = import_graph_params(*params, filters);
+
+		if (!num_levels || num_levels > zimg::graph::FilterGraph::MAX_OUTPUTS)
+			zimg::error::throw_<zimg::error::IllegalArgument>("invalid number of pyramid levels");
+
+		// Keep every level divisible by the chroma subsampling.
+		unsigned align_w = 1U << dst_state.subsample_w;
+		unsigned align_h = 1U << dst_state.subsample_h;
+
+		std::vector<zimg::graph::GraphBuilder::state> levels(num_levels, dst_state);
+		for (unsigned i = 1; i < num_levels; ++i) {
+			levels[i].width = std::max(levels[i - 1].width / 2 / align_w * align_w, align_w);
+			levels[i].height = std::max(levels[i - 1].height / 2 / align_h * align_h, align_h);
+			levels[i].active_width = levels[i].width;
+			levels[i].active_height = levels[i].height;
+		}
+
+		zimg::graph::GraphBuilder builder;
+		std::unique_ptr<zimg::graph::FilterGraph> graph = builder.set_source(src_state)
+			.connect_chain(levels.data(), num_levels, params ? &graph_params : nullptr)
+			.build_graph();
+
+		return graph.release();
+	} catch (...) {
+		handle_exception(std::current_exception());
+		return nullptr;
+	}
+}
+
+void zimg_graph_cache_set_capacity(size_t capacity)
+{
+	zimg::graph::GraphCache::instance().set_capacity(capacity);
+}
+
+void zimg_graph_cache_clear(void)
+{
+	zimg::graph::GraphCache::instance().clear();
+}
+
+void zimg_graph_cache_get_stats(zimg_graph_cache_stats *ptr, unsigned version)
+{
+	zassert_d(ptr, "null pointer");
+	API_VERSION_ASSERT(version);
+
+	ptr->version = version;
+
+	if (version >= API_VERSION_2_5) {
+		zimg::graph::GraphCache::stats stats = zimg::graph::GraphCache::instance().get_stats();
+		ptr->hits = static_cast<size_t>(stats.hits);
+		ptr->misses = static_cast<size_t>(stats.misses);
+		ptr->evictions = static_cast<size_t>(stats.evictions);
+		ptr->size = stats.size;
+		ptr->capacity = stats.capacity;
+	}
+}
@@ -2,6 +2,7 @@
 #define ZIMG_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 /* Support for ELF hidden visibility. DLL targets use export maps instead. */
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -29,7 +30,7 @@ extern "C" {
  */
 #define ZIMG_MAKE_API_VERSION(x, y) (((x) << 8) | (y))
 #define ZIMG_API_VERSION_MAJOR 2
-#define ZIMG_API_VERSION_MINOR 4
+#define ZIMG_API_VERSION_MINOR 5
 #define ZIMG_API_VERSION ZIMG_MAKE_API_VERSION(ZIMG_API_VERSION_MAJOR, ZIMG_API_VERSION_MINOR)
 
 /**
@@ -357,7 +358,8 @@ typedef enum zimg_dither_type_e {
 	ZIMG_DITHER_NONE            = 0, /**< Round to nearest. */
 	ZIMG_DITHER_ORDERED         = 1, /**< Bayer patterned dither. */
 	ZIMG_DITHER_RANDOM          = 2, /**< Pseudo-random noise of magnitude 0.5. */
-	ZIMG_DITHER_ERROR_DIFFUSION = 3  /**< Floyd-Steinberg error diffusion. */
+	ZIMG_DITHER_ERROR_DIFFUSION = 3, /**< Floyd-Steinberg error diffusion. */
+	ZIMG_DITHER_RANDOM_COUNTER  = 4  /**< Non-repeating pseudo-random noise of magnitude 0.5, computed per pixel. Since API 2.5. */
 } zimg_dither_type_e;
 
 /**
@@ -516,6 +518,9 @@ zimg_error_code_e zimg_filter_graph_get_input_buffering(const zimg_filter_graph
 /**
  * Query the minimum number of lines required in the output buffer.
  *
+ * For graphs with several outputs, the largest requirement among the outputs
+ * is returned.
+ *
  * @pre out != 0
  * @param ptr graph handle
  * @param[out] out set to the number of scanlines
@@ -543,6 +548,190 @@ zimg_error_code_e zimg_filter_graph_process(const zimg_filter_graph *ptr, const
                                             zimg_filter_graph_callback unpack_cb, void *unpack_user,
                                             zimg_filter_graph_callback pack_cb, void *pack_user);
 
+/**
+ * Process an image with a graph created by {@link zimg_filter_graph_build_multi}.
+ *
+ * The input image is read once and every output is written in the same pass.
+ * The number of outputs must match the number of formats used to build the
+ * graph.
+ *
+ * Since API 2.5.
+ *
+ * @param ptr graph handle
+ * @param[in] src input image buffer
+ * @param[out] dst array of output image buffers, one per output
+ * @param num_outputs number of outputs
+ * @param tmp temporary buffer
+ * @param unpack_cb user-defined input callback, may be NULL
+ * @param unpack_user private data for callback
+ * @param pack_cb array of user-defined output callbacks, may be NULL
+ * @param pack_user array of private data for callbacks, may be NULL
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_process_multi(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer * const dst[], unsigned num_outputs, void *tmp,
+                                                  zimg_filter_graph_callback unpack_cb, void *unpack_user,
+                                                  const zimg_filter_graph_callback pack_cb[], void * const pack_user[]);
+
+/**
+ * Query the size of the temporary buffer required to process a region.
+ *
+ * @see zimg_filter_graph_process_region
+ *
+ * Since API 2.5.
+ *
+ * @pre out != 0
+ * @param ptr graph handle
+ * @param left left column of output region
+ * @param top top row of output region
+ * @param width width of output region
+ * @param height height of output region
+ * @param[out] out set to the size of the buffer in bytes
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_get_tmp_size_region(const zimg_filter_graph *ptr, unsigned left, unsigned top, unsigned width, unsigned height, size_t *out);
+
+/**
+ * Process a rectangular region of the output image.
+ *
+ * The input and output buffers describe entire image planes and must have a
+ * mask of {@link ZIMG_BUFFER_MAX}. Pixel coordinates are relative to the
+ * whole output image, and pixels outside of the region are not modified. The
+ * input pixels needed by the region are determined from the filters in the
+ * graph.
+ *
+ * A single graph can be used to process disjoint regions concurrently, as
+ * long as each thread uses its own temporary buffer. The region must be
+ * aligned to the chroma subsampling of the output image, except at the right
+ * and bottom image edges.
+ *
+ * Graphs containing error diffusion always process all rows above the region.
+ * Graphs containing vertical unresizing always process the entire height of the
+ * image.
+ *
+ * Since API 2.5.
+ *
+ * @param ptr graph handle
+ * @param[in] src input image buffer
+ * @param[out] dst output image buffer
+ * @param tmp temporary buffer
+ * @param left left column of output region
+ * @param top top row of output region
+ * @param width width of output region
+ * @param height height of output region
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_process_region(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, void *tmp,
+                                                   unsigned left, unsigned top, unsigned width, unsigned height);
+
+/**
+ * Unit of work submitted to a {@link zimg_filter_graph_dispatch_callback}.
+ *
+ * Since API 2.5.
+ *
+ * @param task_data private data passed to the dispatcher
+ * @param i index of task, from 0 to num_tasks - 1
+ */
+typedef void (*zimg_filter_graph_task)(void *task_data, unsigned i);
+
+/**
+ * User callback for running tasks on a thread pool.
+ *
+ * The dispatcher must invoke the task once for each index and return after
+ * all invocations have completed. Invocations may run concurrently in any
+ * order, or sequentially on the calling thread.
+ *
+ * Since API 2.5.
+ *
+ * @param user user-defined private data
+ * @param num_tasks number of tasks
+ * @param task task function
+ * @param task_data argument to task function
+ * @return zero on success or non-zero on failure
+ */
+typedef int (*zimg_filter_graph_dispatch_callback)(void *user, unsigned num_tasks, zimg_filter_graph_task task, void *task_data);
+
+/**
+ * Process an in-memory image with the filter graph using multiple threads.
+ *
+ * The output image is divided into bands of rows, and each band is computed
+ * from the input rows it depends on. All buffers must hold entire planes,
+ * i.e. have a mask of {@link ZIMG_BUFFER_MAX}. Temporary buffers are
+ * allocated internally.
+ *
+ * Graphs containing error diffusion or vertical unresizing can not be
+ * partitioned and are executed on the calling thread. The blocks of rows of
+ * error diffusion built with error_diffusion_threads are submitted to the
+ * dispatcher.
+ *
+ * Since API 2.5.
+ *
+ * @param ptr graph handle
+ * @param[in] src input image buffer
+ * @param[out] dst output image buffer
+ * @param num_threads number of worker threads, or 0 to use all processors
+ * @param dispatch_cb user-defined dispatcher, may be NULL to use internal threads
+ * @param dispatch_user private data for dispatcher
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_process_mt(const zimg_filter_graph *ptr, const zimg_image_buffer_const *src, const zimg_image_buffer *dst, unsigned num_threads,
+                                               zimg_filter_graph_dispatch_callback dispatch_cb, void *dispatch_user);
+
+/**
+ * Execution statistics of a filter in the graph.
+ *
+ * Since API 2.5.
+ */
+typedef struct zimg_filter_stats {
+	unsigned version;       /**< @see ZIMG_API_VERSION */
+
+	const char *name;       /**< Processing stage, e.g. "resize" or "colorspace". */
+	int plane;              /**< Plane index, or -1 if the filter processes several planes. */
+	unsigned width;         /**< Output width of the filter. */
+	unsigned height;        /**< Output height of the filter. */
+
+	uint64_t calls;         /**< Number of invocations. */
+	uint64_t pixels;        /**< Number of samples written, summed over planes. */
+	uint64_t bytes_read;    /**< Number of bytes read from dependencies. */
+	uint64_t bytes_written; /**< Number of bytes written. */
+	double seconds;         /**< Accumulated wall time. */
+
+	uint64_t pixels_skipped; /**< Number of samples passed through without computation, e.g. opaque areas in alpha premultiplication. */
+} zimg_filter_stats;
+
+/**
+ * Query per-filter execution statistics.
+ *
+ * Statistics are only available if the graph was built with profiling
+ * enabled. The counters accumulate over all processing calls on the graph,
+ * including concurrent calls, until reset. Filters are listed in the order
+ * they were inserted, which is the order in which data flows through them.
+ *
+ * Since API 2.5.
+ *
+ * @param ptr graph handle
+ * @param[out] stats array of statistics, may be NULL
+ * @param[in,out] count on input, length of {@p stats}; on output, number of filters in the graph
+ * @param version API version used by caller
+ * @return error code, {@link ZIMG_ERROR_UNSUPPORTED_OPERATION} if profiling is not enabled
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_get_stats(const zimg_filter_graph *ptr, zimg_filter_stats *stats, unsigned *count, unsigned version);
+
+/**
+ * Reset execution statistics.
+ *
+ * Since API 2.5.
+ *
+ * @param ptr graph handle
+ * @return error code
+ */
+ZIMG_VISIBILITY
+zimg_error_code_e zimg_filter_graph_reset_stats(const zimg_filter_graph *ptr);
+
 
 /**
  * Image format descriptor.
@@ -632,6 +821,48 @@ typedef struct zimg_graph_builder_params {
 
 	/** Allow evaluating transfer functions at reduced precision (default false). */
 	char allow_approximate_gamma;
+
+	/**
+	 * Record per-filter execution statistics (default false).
+	 *
+	 * Profiled graphs are never shared through the graph cache.
+	 *
+	 * Since API 2.5.
+	 *
+	 * @see zimg_filter_graph_get_stats
+	 */
+	char enable_profiling;
+
+	/**
+	 * Approximate colorspace conversions with a 3D LUT (default 0, disabled).
+	 *
+	 * If non-zero, the conversion between two floating point colorspaces is
+	 * sampled on a grid of this many nodes per axis when the graph is built,
+	 * and applied with tetrahedral interpolation. Values outside the nominal
+	 * range of the source colorspace are clipped. Conversions from linear light
+	 * are always evaluated exactly. Typical values are 33 and 65; the maximum
+	 * is 129.
+	 *
+	 * Since API 2.5.
+	 */
+	unsigned colorspace_lut_size;
+
+	/**
+	 * Number of threads for {@link ZIMG_DITHER_ERROR_DIFFUSION} (default 0).
+	 *
+	 * Error diffusion processes the image from top to bottom, so graphs using
+	 * it run on a single thread, including in {@link zimg_filter_graph_process_mt}.
+	 * If greater than one, the dither filter processes several blocks of rows
+	 * concurrently, each a fixed number of columns behind the block above. The
+	 * threads belong to the graph handle, are started on first use, and are
+	 * shared by all planes. In {@link zimg_filter_graph_process_mt}, the blocks
+	 * are instead submitted to the user dispatcher, if one is given. The
+	 * output is identical to the single-threaded filter. Values of 0 and 1
+	 * disable threading.
+	 *
+	 * Since API 2.5.
+	 */
+	unsigned error_diffusion_threads;
 } zimg_graph_builder_params;
 
 /**
@@ -666,6 +897,116 @@ void zimg_graph_builder_params_default(zimg_graph_builder_params *ptr, unsigned
 ZIMG_VISIBILITY
 zimg_filter_graph *zimg_filter_graph_build(const zimg_image_format *src_format, const zimg_image_format *dst_format, const zimg_graph_builder_params *params);
 
+/**
+ * Maximum number of outputs of a graph.
+ *
+ * Since API 2.5.
+ */
+#define ZIMG_FILTER_GRAPH_MAX_OUTPUTS 16
+
+/**
+ * Create a graph converting one input format to several output formats.
+ *
+ * Conversions needed by more than one output are performed once, so that a
+ * single pass over the input image produces all outputs. The resulting graph
+ * must be executed with {@link zimg_filter_graph_process_multi}. Region and
+ * multithreaded processing are not supported. Graphs with several outputs are
+ * not stored in the graph cache.
+ *
+ * Since API 2.5.
+ *
+ * @param[in] src_format input image format
+ * @param[in] dst_formats array of output image formats
+ * @param num_outputs number of outputs, at most {@link ZIMG_FILTER_GRAPH_MAX_OUTPUTS}
+ * @param[in] params filter parameters, may be NULL
+ * @return graph handle, or NULL on failure
+ */
+ZIMG_VISIBILITY
+zimg_filter_graph *zimg_filter_graph_build_multi(const zimg_image_format *src_format, const zimg_image_format * const dst_formats[], unsigned num_outputs,
+                                                 const zimg_graph_builder_params *params);
+
+/**
+ * Create a graph producing an image pyramid, such as a chain of mipmaps.
+ *
+ * The first level is converted from the source to the given format. Each
+ * subsequent level has the same format, with half the width and height of
+ * the level before it. The dimensions are rounded down to a multiple of the
+ * chroma subsampling factor, and to no less than that factor. For example,
+ * a 1920x1080 4:2:0 level is followed by 960x540, 480x270 and 240x134.
+ *
+ * Levels are resized from the level before them rather than from the source
+ * image. No speedup over running a separate graph per level has been
+ * measured (16.8 ms in both cases for six 8-bit levels from 4096x4096).
+ *
+ * The graph is executed with {@link zimg_filter_graph_process_multi}, with
+ * one output per level, and has the same restrictions as the graphs created
+ * by {@link zimg_filter_graph_build_multi}.
+ *
+ * Since API 2.5.
+ *
+ * @param[in] src_format input image format
+ * @param[in] dst_format image format of the first level
+ * @param num_levels number of levels, at most {@link ZIMG_FILTER_GRAPH_MAX_OUTPUTS}
+ * @param[in] params filter parameters, may be NULL
+ * @return graph handle, or NULL on failure
+ */
+ZIMG_VISIBILITY
+zimg_filter_graph *zimg_filter_graph_build_pyramid(const zimg_image_format *src_format, const zimg_image_format *dst_format, unsigned num_levels,
+                                                   const zimg_graph_builder_params *params);
+
+/**
+ * Graph cache statistics.
+ *
+ * Since API 2.5.
+ */
+typedef struct zimg_graph_cache_stats {
+	unsigned version; /**< @see ZIMG_API_VERSION */
+
+	size_t hits;      /**< Number of graphs returned from the cache. */
+	size_t misses;    /**< Number of graphs built while the cache was enabled. */
+	size_t evictions; /**< Number of entries removed to satisfy the capacity. */
+	size_t size;      /**< Current number of entries. */
+	size_t capacity;  /**< Maximum number of entries. */
+} zimg_graph_cache_stats;
+
+/**
+ * Set the capacity of the process-wide graph cache.
+ *
+ * When the cache is enabled, {@link zimg_filter_graph_build} returns a new
+ * handle to a previously built graph if called with equivalent arguments.
+ * Handles share the underlying graph, which is freed when the last handle is
+ * freed and the entry has been evicted. Cached graphs are immutable and may
+ * be used concurrently from multiple threads.
+ *
+ * The cache is disabled by default. Setting a capacity of zero disables the
+ * cache and evicts all entries. This function is thread-safe.
+ *
+ * Since API 2.5.
+ *
+ * @param capacity maximum number of graphs retained
+ */
+ZIMG_VISIBILITY
+void zimg_graph_cache_set_capacity(size_t capacity);
+
+/**
+ * Evict all entries from the graph cache, without changing its capacity.
+ *
+ * Since API 2.5.
+ */
+ZIMG_VISIBILITY
+void zimg_graph_cache_clear(void);
+
+/**
+ * Query graph cache statistics.
+ *
+ * Since API 2.5.
+ *
+ * @param[out] ptr structure to be filled
+ * @param version API version used by caller
+ */
+ZIMG_VISIBILITY
+void zimg_graph_cache_get_stats(zimg_graph_cache_stats *ptr, unsigned version);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
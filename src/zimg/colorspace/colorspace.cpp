@@ -1,55 +1,179 @@
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <memory>
+#include "common/align.h"
+#include "common/alloc.h"
 #include "common/cpuinfo.h"
 #include "common/except.h"
 #include "common/pixel.h"
 #include "common/zassert.h"
+#include "depth/quantize.h"
 #include "graph/filter_base.h"
 #include "colorspace.h"
+#include "colorspace_param.h"
 #include "graph.h"
+#include "integer_matrix.h"
+#include "lut3d.h"
+#include "matrix3.h"
 #include "operation.h"
+#include "operation_impl.h"
 
 namespace zimg {
 namespace colorspace {
 
 namespace {
 
+constexpr unsigned INTEGER_TRANSFER_MAX_DEPTH = 12;
+
+// SMPTE 240M is decoded with the Rec.709 transfer function, unless the conversion is scene-referred.
+ColorspaceDefinition adjust_240m_transfer(const ColorspaceDefinition &csp, bool scene_referred)
+{
+	if (!scene_referred && csp.transfer == TransferCharacteristics::SMPTE_240M)
+		return csp.to(TransferCharacteristics::REC_709);
+	return csp;
+}
+
+bool is_ncl_matrix(MatrixCoefficients matrix)
+{
+	switch (matrix) {
+	case MatrixCoefficients::REC_601:
+	case MatrixCoefficients::REC_709:
+	case MatrixCoefficients::FCC:
+	case MatrixCoefficients::SMPTE_240M:
+	case MatrixCoefficients::YCGCO:
+	case MatrixCoefficients::REC_2020_NCL:
+	case MatrixCoefficients::CHROMATICITY_DERIVED_NCL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool is_matrix_only(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
+{
+	auto is_yuv_or_rgb = [](const ColorspaceDefinition &csp)
+	{
+		if (csp.matrix == MatrixCoefficients::CHROMATICITY_DERIVED_NCL && csp.primaries == ColorPrimaries::UNSPECIFIED)
+			return false;
+		return csp.matrix == MatrixCoefficients::RGB || is_ncl_matrix(csp.matrix);
+	};
+
+	return in.matrix != out.matrix && in.transfer == out.transfer && in.primaries == out.primaries &&
+		is_yuv_or_rgb(in) && is_yuv_or_rgb(out);
+}
+
+Matrix3x3 get_ncl_matrix(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
+{
+	Matrix3x3 to_rgb = Matrix3x3::identity();
+	Matrix3x3 from_rgb = Matrix3x3::identity();
+
+	if (in.matrix == MatrixCoefficients::CHROMATICITY_DERIVED_NCL)
+		to_rgb = ncl_yuv_to_rgb_matrix_from_primaries(in.primaries);
+	else if (in.matrix != MatrixCoefficients::RGB)
+		to_rgb = ncl_yuv_to_rgb_matrix(in.matrix);
+
+	if (out.matrix == MatrixCoefficients::CHROMATICITY_DERIVED_NCL)
+		from_rgb = ncl_rgb_to_yuv_matrix_from_primaries(out.primaries);
+	else if (out.matrix != MatrixCoefficients::RGB)
+		from_rgb = ncl_rgb_to_yuv_matrix(out.matrix);
+
+	return from_rgb * to_rgb;
+}
+
+void get_plane_formats(const ColorspaceDefinition &csp, const PixelFormat &format, PixelFormat planes[3])
+{
+	bool yuv = csp.matrix != MatrixCoefficients::RGB;
+	bool ycgco = csp.matrix == MatrixCoefficients::YCGCO;
+
+	planes[0] = { format.type, format.depth, format.fullrange, false, ycgco };
+	planes[1] = { format.type, format.depth, format.fullrange, yuv, ycgco };
+	planes[2] = planes[1];
+}
+
+template <class T>
+void lookup_plane(const float *lut, unsigned max_code, const T *src, float *dst, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; ++j) {
+		dst[j] = lut[std::min(static_cast<unsigned>(src[j]), max_code)];
+	}
+}
+
 class ColorspaceConversionImpl : public graph::PointFilter {
 	std::array<std::unique_ptr<Operation>, 6> m_operations;
+	AlignedVector<float> m_input_lut;
+	PixelType m_type_in;
 
 	void build_graph(const ColorspaceDefinition &in, const ColorspaceDefinition &out, const OperationParams &params, CPUClass cpu)
 	{
-		ColorspaceDefinition csp_in = in;
-		ColorspaceDefinition csp_out = out;
-
-		if (!params.scene_referred) {
-			if (csp_in.transfer == TransferCharacteristics::SMPTE_240M)
-				csp_in.transfer = TransferCharacteristics::REC_709;
-			if (csp_out.transfer == TransferCharacteristics::SMPTE_240M)
-				csp_out.transfer = TransferCharacteristics::REC_709;
-		}
+		ColorspaceDefinition csp_in = adjust_240m_transfer(in, params.scene_referred);
+		ColorspaceDefinition csp_out = adjust_240m_transfer(out, params.scene_referred);
 
-		auto path = get_operation_path(csp_in, csp_out);
+		const auto &path = get_operation_path(csp_in, csp_out);
 		zassert(!path.empty(), "empty path");
 		zassert(path.size() <= 6, "too many operations");
 
-		for (size_t i = 0; i < path.size(); ++i) {
-			m_operations[i] = path[i](params, cpu);
+		// Runs of 3x3 matrices are multiplied together and applied in one pass.
+		size_t num_operations = 0;
+
+		for (const auto &factory : path) {
+			std::unique_ptr<Operation> op = factory(params, cpu);
+			const MatrixOperationImpl *cur = dynamic_cast<const MatrixOperationImpl *>(op.get());
+			const MatrixOperationImpl *prev = nullptr;
+
+			if (num_operations)
+				prev = dynamic_cast<const MatrixOperationImpl *>(m_operations[num_operations - 1].get());
+
+			if (cur && prev)
+				m_operations[num_operations - 1] = create_matrix_operation(cur->matrix() * prev->matrix(), cpu);
+			else
+				m_operations[num_operations++] = std::move(op);
 		}
 	}
+
+	// Evaluate the first operation, which linearizes each channel, on every
+	// code value of the input format. The table then replaces both the
+	// conversion to float and the operation.
+	void build_input_lut(const PixelFormat &format)
+	{
+		const unsigned num_codes = 1U << format.depth;
+		const size_t stride = ceil_n(num_codes, AlignmentOf<float>);
+		const double range = depth::integer_range(format);
+		const double offset = depth::integer_offset(format);
+
+		AlignedVector<float> tmp(stride * 4);
+		float *codes = tmp.data();
+		float *dst[3] = { tmp.data() + stride, tmp.data() + stride * 2, tmp.data() + stride * 3 };
+
+		for (unsigned x = 0; x < num_codes; ++x) {
+			codes[x] = static_cast<float>((x - offset) / range);
+		}
+
+		const float *src[3] = { codes, codes, codes };
+		m_operations[0]->process(src, dst, 0, num_codes);
+		m_input_lut.assign(dst[0], dst[0] + num_codes);
+
+		std::move(m_operations.begin() + 1, m_operations.end(), m_operations.begin());
+		m_operations.back() = nullptr;
+	}
 public:
 	ColorspaceConversionImpl(unsigned width, unsigned height,
 	                         const ColorspaceDefinition &in, const ColorspaceDefinition &out,
-	                         const OperationParams &params, CPUClass cpu) :
-		PointFilter(width, height, PixelType::FLOAT)
+	                         const OperationParams &params, CPUClass cpu, const PixelFormat &pixel_in = PixelType::FLOAT) :
+		PointFilter(width, height, PixelType::FLOAT),
+		m_type_in{ pixel_in.type }
 	{
 		zassert_d(width <= pixel_max_width(PixelType::FLOAT), "overflow");
+		zassert_d(width <= pixel_max_width(pixel_in.type), "overflow");
 
 		m_desc.num_deps = 3;
 		m_desc.num_planes = 3;
-		m_desc.flags.in_place = 1;
+		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(PixelType::FLOAT);
 
 		build_graph(in, out, params, cpu);
+
+		if (pixel_is_integer(pixel_in.type))
+			build_input_lut(pixel_in);
 	}
 
 	void process(const graphengine::BufferDescriptor in[3], const graphengine::BufferDescriptor out[3],
@@ -63,6 +187,23 @@ public:
 			dst_ptr[p] = out[p].get_line<float>(i);
 		}
 
+		if (!m_input_lut.empty()) {
+			unsigned max_code = static_cast<unsigned>(m_input_lut.size() - 1);
+
+			for (unsigned p = 0; p < 3; ++p) {
+				if (m_type_in == PixelType::BYTE)
+					lookup_plane(m_input_lut.data(), max_code, in[p].get_line<uint8_t>(i), dst_ptr[p], left, right);
+				else
+					lookup_plane(m_input_lut.data(), max_code, in[p].get_line<uint16_t>(i), dst_ptr[p], left, right);
+			}
+
+			if (!m_operations[0])
+				return;
+			src_ptr[0] = dst_ptr[0];
+			src_ptr[1] = dst_ptr[1];
+			src_ptr[2] = dst_ptr[2];
+		}
+
 		m_operations[0]->process(src_ptr, dst_ptr, left, right);
 
 		if (!m_operations[1])
@@ -95,9 +236,12 @@ ColorspaceConversion::ColorspaceConversion(unsigned width, unsigned height) :
 	height{ height },
 	csp_in{},
 	csp_out{},
+	pixel_in{ PixelType::FLOAT },
+	pixel_out{ PixelType::FLOAT },
 	peak_luminance{ 100.0 },
 	approximate_gamma{},
 	scene_referred{},
+	lut_size{},
 	cpu{ CPUClass::NONE }
 {}
 
@@ -114,10 +258,103 @@ std::unique_ptr<graphengine::Filter> ColorspaceConversion::create() const try
 	      .set_approximate_gamma(approximate_gamma)
 	      .set_scene_referred(scene_referred);
 
+	if (pixel_is_integer(pixel_in.type) && !pixel_is_integer(pixel_out.type)) {
+		if (!is_integer_transfer_supported(csp_in, csp_out, pixel_in, pixel_out, approximate_gamma, scene_referred))
+			error::throw_<error::InternalError>("conversion not supported on integer pixels");
+
+		return std::make_unique<ColorspaceConversionImpl>(width, height, csp_in, csp_out, params, cpu, pixel_in);
+	}
+
+	if (pixel_is_integer(pixel_in.type) || pixel_is_integer(pixel_out.type)) {
+		if (!is_integer_conversion_supported(csp_in, csp_out, pixel_in, pixel_out))
+			error::throw_<error::InternalError>("conversion not supported on integer pixels");
+
+		PixelFormat planes_in[3];
+		PixelFormat planes_out[3];
+		get_plane_formats(csp_in, pixel_in, planes_in);
+		get_plane_formats(csp_out, pixel_out, planes_out);
+
+		return create_integer_matrix(width, height, get_ncl_matrix(csp_in, csp_out), planes_in, planes_out, cpu);
+	}
+
+	if (lut_size && is_lut3d_supported(csp_in)) {
+		if (lut_size < LUT3D_MIN_SIZE || lut_size > LUT3D_MAX_SIZE)
+			error::throw_<error::IllegalArgument>("3D LUT size out of range");
+
+		ColorspaceConversionImpl sampler{ lut_size * lut_size, 1, csp_in, csp_out, params, cpu };
+		return create_lut3d(sampler, width, height, lut_size, csp_in.matrix != MatrixCoefficients::RGB, cpu);
+	}
+
 	return std::make_unique<ColorspaceConversionImpl>(width, height, csp_in, csp_out, params, cpu);
 } catch (const std::bad_alloc &) {
 	error::throw_<error::OutOfMemory>();
 }
 
+bool is_lut3d_supported(const ColorspaceDefinition &csp_in)
+{
+	return csp_in.transfer != TransferCharacteristics::LINEAR;
+}
+
+Lut3DAccuracy measure_lut3d_accuracy(const ColorspaceConversion &conv, unsigned samples)
+{
+	if (!conv.lut_size || !is_lut3d_supported(conv.csp_in))
+		error::throw_<error::IllegalArgument>("conversion does not use a 3D LUT");
+	if (pixel_is_integer(conv.pixel_in.type) || pixel_is_integer(conv.pixel_out.type))
+		error::throw_<error::IllegalArgument>("3D LUT requires floating point pixels");
+	if (samples < 2)
+		error::throw_<error::IllegalArgument>("too few samples");
+
+	ColorspaceConversion exact_conv = conv;
+	exact_conv.width = samples;
+	exact_conv.height = 1;
+
+	ColorspaceConversion approx_conv = exact_conv;
+	exact_conv.set_lut_size(0);
+
+	auto exact = exact_conv.create();
+	auto approx = approx_conv.create();
+	if (!exact || !approx)
+		error::throw_<error::IllegalArgument>("conversion is a no-op");
+
+	return measure_lut3d_accuracy(*exact, *approx, samples, conv.csp_in.matrix != MatrixCoefficients::RGB);
+}
+
+bool is_integer_conversion_supported(const ColorspaceDefinition &csp_in, const ColorspaceDefinition &csp_out,
+                                     const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+{
+	auto is_supported_format = [](const PixelFormat &format)
+	{
+		return pixel_is_integer(format.type) && format.depth >= 8 && format.depth <= INTEGER_MATRIX_MAX_DEPTH;
+	};
+
+	return is_matrix_only(csp_in, csp_out) && is_supported_format(pixel_in) && is_supported_format(pixel_out);
+}
+
+bool is_integer_transfer_supported(const ColorspaceDefinition &csp_in, const ColorspaceDefinition &csp_out,
+                                   const PixelFormat &pixel_in, const PixelFormat &pixel_out,
+                                   bool approximate_gamma, bool scene_referred)
+{
+	if (!pixel_is_integer(pixel_in.type) || pixel_in.depth > INTEGER_TRANSFER_MAX_DEPTH || pixel_in.depth > pixel_depth(pixel_in.type))
+		return false;
+	if (pixel_out.type != PixelType::FLOAT)
+		return false;
+
+	ColorspaceDefinition in = adjust_240m_transfer(csp_in, scene_referred);
+	ColorspaceDefinition out = adjust_240m_transfer(csp_out, scene_referred);
+
+	// Any path from non-linear RGB to a different transfer function or
+	// primaries begins by linearizing the input.
+	if (in.matrix != MatrixCoefficients::RGB || in.transfer == TransferCharacteristics::UNSPECIFIED || in.transfer == TransferCharacteristics::LINEAR)
+		return false;
+	if (in.transfer == out.transfer && in.primaries == out.primaries)
+		return false;
+
+	// The display-referred ARIB STD-B67 EOTF depends on all three channels.
+	if (in.transfer == TransferCharacteristics::ARIB_B67 && in.primaries != ColorPrimaries::UNSPECIFIED && !approximate_gamma && !scene_referred)
+		return false;
+
+	return true;
+}
+
 } // namespace colorspace
 } // namespace zimg
@@ -4,6 +4,7 @@
 #define ZIMG_COLORSPACE_COLORSPACE_H_
 
 #include <memory>
+#include "common/pixel.h"
 
 namespace graphengine {
 class Filter;
@@ -116,9 +117,12 @@ struct ColorspaceConversion {
 #include "common/builder.h"
 	BUILDER_MEMBER(ColorspaceDefinition, csp_in)
 	BUILDER_MEMBER(ColorspaceDefinition, csp_out)
+	BUILDER_MEMBER(PixelFormat, pixel_in)
+	BUILDER_MEMBER(PixelFormat, pixel_out)
 	BUILDER_MEMBER(double, peak_luminance)
 	BUILDER_MEMBER(bool, approximate_gamma)
 	BUILDER_MEMBER(bool, scene_referred)
+	BUILDER_MEMBER(unsigned, lut_size)
 	BUILDER_MEMBER(CPUClass, cpu)
 #undef BUILDER_MEMBER
 
@@ -127,6 +131,75 @@ struct ColorspaceConversion {
 	std::unique_ptr<graphengine::Filter> create() const;
 };
 
+/**
+ * Error of a 3D LUT relative to the exact conversion.
+ */
+struct Lut3DAccuracy {
+	double max_error;
+	double rms_error;
+	unsigned long long num_samples;
+};
+
+/**
+ * Check if a conversion can be approximated by a 3D LUT.
+ *
+ * The LUT covers the nominal range of the input colorspace, so conversions
+ * from linear light, which is unbounded, are always evaluated exactly.
+ *
+ * @param csp_in input colorspace
+ * @return true if supported, else false
+ */
+bool is_lut3d_supported(const ColorspaceDefinition &csp_in);
+
+/**
+ * Compare the 3D LUT approximation of a conversion against the exact path.
+ *
+ * The conversions are evaluated on a regular grid of {@p samples} points per
+ * axis. Choosing 2 * (lut_size - 1) + 1 samples visits every LUT node and the
+ * midpoint of every cell edge.
+ *
+ * @param conv conversion, with {@link ColorspaceConversion::lut_size} set
+ * @param samples number of samples per axis
+ * @return error statistics
+ */
+Lut3DAccuracy measure_lut3d_accuracy(const ColorspaceConversion &conv, unsigned samples);
+
+/**
+ * Check if a conversion can be performed directly on integer pixels.
+ *
+ * Conversions consisting only of a 3x3 matrix between YUV and RGB are
+ * supported for integer formats of up to 12 bits. The pixel formats describe
+ * the luma plane; chroma is inferred from the matrix coefficients.
+ *
+ * @param csp_in input colorspace
+ * @param csp_out output colorspace
+ * @param pixel_in input format
+ * @param pixel_out output format
+ * @return true if supported, else false
+ */
+bool is_integer_conversion_supported(const ColorspaceDefinition &csp_in, const ColorspaceDefinition &csp_out,
+                                     const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+
+/**
+ * Check if integer RGB input can be linearized by table lookup.
+ *
+ * This applies to conversions that start by removing the transfer function
+ * from each channel, with input of up to 12 bits and FLOAT output. A table
+ * indexed by code value replaces the conversion to float and the transfer
+ * function.
+ *
+ * @param csp_in input colorspace
+ * @param csp_out output colorspace
+ * @param pixel_in input format
+ * @param pixel_out output format
+ * @param approximate_gamma see {@link ColorspaceConversion::approximate_gamma}
+ * @param scene_referred see {@link ColorspaceConversion::scene_referred}
+ * @return true if supported, else false
+ */
+bool is_integer_transfer_supported(const ColorspaceDefinition &csp_in, const ColorspaceDefinition &csp_out,
+                                   const PixelFormat &pixel_in, const PixelFormat &pixel_out,
+                                   bool approximate_gamma, bool scene_referred);
+
 } // namespace colorspace
 } // namespace zimg
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <deque>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -102,12 +103,21 @@ constexpr bool is_valid_csp(const ColorspaceDefinition &csp)
 
 
 struct ColorspaceHash {
-	bool operator()(const ColorspaceDefinition &csp) const
+	static unsigned pack(const ColorspaceDefinition &csp)
 	{
-		return std::hash<unsigned>{}(
-			(static_cast<unsigned>(csp.matrix) << 16) |
+		return (static_cast<unsigned>(csp.matrix) << 16) |
 			(static_cast<unsigned>(csp.transfer) << 8) |
-			(static_cast<unsigned>(csp.primaries)));
+			(static_cast<unsigned>(csp.primaries));
+	}
+
+	size_t operator()(const ColorspaceDefinition &csp) const
+	{
+		return std::hash<unsigned>{}(pack(csp));
+	}
+
+	size_t operator()(const std::pair<ColorspaceDefinition, ColorspaceDefinition> &csp) const
+	{
+		return std::hash<unsigned long long>{}((static_cast<unsigned long long>(pack(csp.first)) << 32) | pack(csp.second));
 	}
 };
 
@@ -119,9 +129,9 @@ std::vector<ColorspaceNode> get_neighboring_colorspaces(const ColorspaceDefiniti
 
 	std::vector<ColorspaceNode> edges;
 
-	auto add_edge = [&](const ColorspaceDefinition &out_csp, auto func)
+	auto add_edge = [&](const ColorspaceDefinition &out_csp, OperationFactory::func_type func)
 	{
-		edges.emplace_back(out_csp, std::bind(func, csp, out_csp, std::placeholders::_1, std::placeholders::_2));
+		edges.emplace_back(out_csp, OperationFactory{ csp, out_csp, func });
 	};
 
 	if (csp.matrix == MatrixCoefficients::RGB) {
@@ -193,14 +203,8 @@ std::vector<ColorspaceNode> get_neighboring_colorspaces(const ColorspaceDefiniti
 	return edges;
 }
 
-} // namespace
-
-
-std::vector<OperationFactory> get_operation_path(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
+std::vector<OperationFactory> search_operation_path(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
 {
-	if (!is_valid_csp(in) || !is_valid_csp(out))
-		error::throw_<error::NoColorspaceConversion>("invalid colorspace definition");
-
 	std::vector<OperationFactory> path;
 	std::deque<ColorspaceDefinition> queue;
 	std::unordered_set<ColorspaceDefinition, ColorspaceHash> visited;
@@ -224,7 +228,7 @@ std::vector<OperationFactory> get_operation_path(const ColorspaceDefinition &in,
 
 			visited.insert(edge.first);
 			queue.push_back(edge.first);
-			parents[edge.first] = std::make_pair(vertex, std::move(edge.second));
+			parents[edge.first] = std::make_pair(vertex, edge.second);
 		}
 	}
 	if (vertex != out)
@@ -234,14 +238,62 @@ std::vector<OperationFactory> get_operation_path(const ColorspaceDefinition &in,
 		auto it = parents.find(vertex);
 		zassert_d(it != parents.end(), "missing link in traversal path");
 
-		ColorspaceNode node = std::move(it->second);
-		path.push_back(std::move(node.second));
-		vertex = node.first;
+		path.push_back(it->second.second);
+		vertex = it->second.first;
 	}
 	std::reverse(path.begin(), path.end());
 
 	return path;
 }
 
+class OperationPathStore {
+	std::unordered_map<std::pair<ColorspaceDefinition, ColorspaceDefinition>, std::vector<OperationFactory>, ColorspaceHash> m_map;
+	std::mutex m_mutex;
+public:
+	const std::vector<OperationFactory> *find(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		auto it = m_map.find({ in, out });
+		return it == m_map.end() ? nullptr : &it->second;
+	}
+
+	const std::vector<OperationFactory> &insert(const ColorspaceDefinition &in, const ColorspaceDefinition &out, std::vector<OperationFactory> path)
+	{
+		// Entries are never removed, so references to them remain valid.
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_map.emplace(std::make_pair(in, out), std::move(path)).first->second;
+	}
+};
+
+OperationPathStore &operation_path_store()
+{
+	static OperationPathStore store;
+	return store;
+}
+
+} // namespace
+
+
+std::unique_ptr<Operation> OperationFactory::operator()(const OperationParams &params, CPUClass cpu) const
+{
+	return func(in, out, params, cpu);
+}
+
+const std::vector<OperationFactory> &get_operation_path(const ColorspaceDefinition &in, const ColorspaceDefinition &out)
+{
+	if (!is_valid_csp(in) || !is_valid_csp(out))
+		error::throw_<error::NoColorspaceConversion>("invalid colorspace definition");
+
+	try {
+		OperationPathStore &store = operation_path_store();
+		if (const std::vector<OperationFactory> *path = store.find(in, out))
+			return *path;
+
+		return store.insert(in, out, search_operation_path(in, out));
+	} catch (const std::bad_alloc &) {
+		error::throw_<error::OutOfMemory>();
+	}
+}
+
 } // namespace colorspace
 } // namespace zimg
@@ -3,9 +3,9 @@
 #ifndef ZIMG_COLORSPACE_GRAPH_H_
 #define ZIMG_COLORSPACE_GRAPH_H_
 
-#include <functional>
 #include <memory>
 #include <vector>
+#include "colorspace.h"
 
 namespace zimg {
 
@@ -13,20 +13,33 @@ enum class CPUClass;
 
 namespace colorspace {
 
-struct ColorspaceDefinition;
 struct OperationParams;
 class Operation;
 
-typedef std::function<std::unique_ptr<Operation>(const OperationParams &, CPUClass)> OperationFactory;
+/**
+ * Factory for the operation converting between two adjacent colorspaces.
+ */
+struct OperationFactory {
+	typedef std::unique_ptr<Operation> (*func_type)(const ColorspaceDefinition &, const ColorspaceDefinition &, const OperationParams &, CPUClass);
+
+	ColorspaceDefinition in;
+	ColorspaceDefinition out;
+	func_type func;
+
+	std::unique_ptr<Operation> operator()(const OperationParams &params, CPUClass cpu) const;
+};
 
 /**
  * Find the shortest path between two colorspaces.
  *
+ * The path between each pair of colorspaces is searched once per process and
+ * remembered, so that later calls are a table lookup.
+ *
  * @param in input colorspace
  * @param out output colorspace
- * @return vector of factory functors for operations
+ * @return vector of factory functors for operations, valid until program exit
  */
-std::vector<OperationFactory> get_operation_path(const ColorspaceDefinition &in, const ColorspaceDefinition &out);
+const std::vector<OperationFactory> &get_operation_path(const ColorspaceDefinition &in, const ColorspaceDefinition &out);
 
 } // namespace colorspace
 } // namespace zimg
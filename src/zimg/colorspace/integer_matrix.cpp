@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "common/except.h"
+#include "common/pixel.h"
+#include "common/zassert.h"
+#include "depth/quantize.h"
+#include "graph/filter_base.h"
+#include "integer_matrix.h"
+#include "matrix3.h"
+
+#if defined(ZIMG_X86)
+  #include "x86/integer_matrix_x86.h"
+#endif
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+template <class T, class U>
+void integer_matrix_c(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	const T *src0 = static_cast<const T *>(src[0]);
+	const T *src1 = static_cast<const T *>(src[1]);
+	const T *src2 = static_cast<const T *>(src[2]);
+	U *dst_p[3] = { static_cast<U *>(dst[0]), static_cast<U *>(dst[1]), static_cast<U *>(dst[2]) };
+
+	for (unsigned j = left; j < right; ++j) {
+		int32_t a = src0[j];
+		int32_t b = src1[j];
+		int32_t c = src2[j];
+
+		for (unsigned p = 0; p < 3; ++p) {
+			int32_t x = matrix.coeffs[p][0] * a + matrix.coeffs[p][1] * b + matrix.coeffs[p][2] * c + matrix.offset[p];
+			x >>= matrix.shift;
+			dst_p[p][j] = static_cast<U>(std::min(std::max(x, static_cast<int32_t>(0)), static_cast<int32_t>(matrix.max_value)));
+		}
+	}
+}
+
+integer_matrix_func select_integer_matrix_func(PixelType type_in, PixelType type_out)
+{
+	if (type_in == PixelType::BYTE && type_out == PixelType::BYTE)
+		return integer_matrix_c<uint8_t, uint8_t>;
+	else if (type_in == PixelType::BYTE && type_out == PixelType::WORD)
+		return integer_matrix_c<uint8_t, uint16_t>;
+	else if (type_in == PixelType::WORD && type_out == PixelType::BYTE)
+		return integer_matrix_c<uint16_t, uint8_t>;
+	else if (type_in == PixelType::WORD && type_out == PixelType::WORD)
+		return integer_matrix_c<uint16_t, uint16_t>;
+	else
+		error::throw_<error::InternalError>("no conversion between pixel types");
+}
+
+bool is_supported_format(const PixelFormat &format)
+{
+	return pixel_is_integer(format.type) && format.depth >= 8 && format.depth <= INTEGER_MATRIX_MAX_DEPTH &&
+		format.depth <= pixel_depth(format.type);
+}
+
+
+class IntegerMatrixFilter : public graph::PointFilter {
+	IntegerMatrix m_matrix;
+	integer_matrix_func m_func;
+public:
+	IntegerMatrixFilter(integer_matrix_func func, unsigned width, unsigned height, const IntegerMatrix &matrix, PixelType type_in, PixelType type_out) :
+		PointFilter(width, height, type_out),
+		m_matrix(matrix),
+		m_func{ func }
+	{
+		zassert_d(width <= pixel_max_width(type_in), "overflow");
+		zassert_d(width <= pixel_max_width(type_out), "overflow");
+
+		m_desc.num_deps = 3;
+		m_desc.num_planes = 3;
+		m_desc.flags.in_place = pixel_size(type_in) == pixel_size(type_out);
+	}
+
+	void process(const graphengine::BufferDescriptor in[3], const graphengine::BufferDescriptor out[3],
+	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
+	{
+		const void *src[3] = { in[0].get_line(i), in[1].get_line(i), in[2].get_line(i) };
+		void *dst[3] = { out[0].get_line(i), out[1].get_line(i), out[2].get_line(i) };
+
+		m_func(src, dst, m_matrix, left, right);
+	}
+};
+
+} // namespace
+
+
+IntegerMatrix::IntegerMatrix(const Matrix3x3 &m, const PixelFormat pixel_in[3], const PixelFormat pixel_out[3]) :
+	coeffs{},
+	offset{},
+	shift{},
+	max_value{}
+{
+	double scaled[3][3];
+	double max_coeff = 0.0;
+
+	for (unsigned i = 0; i < 3; ++i) {
+		zassert_d(is_supported_format(pixel_in[i]) && is_supported_format(pixel_out[i]), "unsupported format");
+		zassert_d(pixel_out[i].depth == pixel_out[0].depth, "output depth must match");
+
+		for (unsigned j = 0; j < 3; ++j) {
+			scaled[i][j] = m[i][j] * depth::integer_range(pixel_out[i]) / depth::integer_range(pixel_in[j]);
+			max_coeff = std::max(max_coeff, std::fabs(scaled[i][j]));
+		}
+	}
+
+	// Use as many fractional bits as the largest coefficient permits.
+	shift = 14;
+	while (shift > 1 && std::lrint(std::ldexp(max_coeff, shift)) > INT16_MAX) {
+		--shift;
+	}
+	if (std::lrint(std::ldexp(max_coeff, shift)) > INT16_MAX)
+		error::throw_<error::InternalError>("matrix coefficient out of range");
+
+	for (unsigned i = 0; i < 3; ++i) {
+		// The input offsets are subtracted with the quantized coefficients, so that
+		// rounding errors are proportional to the distance from black or neutral.
+		int32_t sum = static_cast<int32_t>(std::lrint(std::ldexp(depth::integer_offset(pixel_out[i]), shift)));
+		sum += 1L << (shift - 1);
+
+		for (unsigned j = 0; j < 3; ++j) {
+			coeffs[i][j] = static_cast<int16_t>(std::lrint(std::ldexp(scaled[i][j], shift)));
+			sum -= coeffs[i][j] * depth::integer_offset(pixel_in[j]);
+		}
+		offset[i] = sum;
+	}
+
+	max_value = static_cast<int16_t>(depth::numeric_max(pixel_out[0].depth));
+}
+
+std::unique_ptr<graphengine::Filter> create_integer_matrix(unsigned width, unsigned height, const Matrix3x3 &m,
+                                                           const PixelFormat pixel_in[3], const PixelFormat pixel_out[3], CPUClass cpu)
+{
+	for (unsigned p = 0; p < 3; ++p) {
+		if (!is_supported_format(pixel_in[p]) || !is_supported_format(pixel_out[p]))
+			error::throw_<error::InternalError>("unsupported format for integer matrix");
+		if (pixel_in[p].type != pixel_in[0].type || pixel_out[p].type != pixel_out[0].type)
+			error::throw_<error::InternalError>("pixel types must match");
+	}
+
+	integer_matrix_func func = nullptr;
+
+#if defined(ZIMG_X86)
+	func = select_integer_matrix_func_x86(pixel_in[0].type, pixel_out[0].type, cpu);
+#endif
+	if (!func)
+		func = select_integer_matrix_func(pixel_in[0].type, pixel_out[0].type);
+
+	return std::make_unique<IntegerMatrixFilter>(func, width, height, IntegerMatrix{ m, pixel_in, pixel_out }, pixel_in[0].type, pixel_out[0].type);
+}
+
+} // namespace colorspace
+} // namespace zimg
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef ZIMG_COLORSPACE_INTEGER_MATRIX_H_
+#define ZIMG_COLORSPACE_INTEGER_MATRIX_H_
+
+#include <cstdint>
+#include <memory>
+
+namespace graphengine {
+class Filter;
+}
+
+
+namespace zimg {
+
+struct PixelFormat;
+
+enum class CPUClass;
+
+namespace colorspace {
+
+struct Matrix3x3;
+
+/**
+ * Fixed-point 3x3 matrix with range conversion folded into the coefficients.
+ *
+ * Each output sample is computed as (sum(coeffs[i][j] * x[j]) + offset[i]) >> shift,
+ * clamped to [0, max_value]. All intermediate values fit in 32 bits.
+ */
+struct IntegerMatrix {
+	int16_t coeffs[3][3];
+	int32_t offset[3];
+	unsigned shift;
+	int16_t max_value;
+
+	/**
+	 * Quantize a matrix operating on normalized pixels.
+	 *
+	 * @param m transformation matrix
+	 * @param pixel_in input format of each plane
+	 * @param pixel_out output format of each plane
+	 */
+	IntegerMatrix(const Matrix3x3 &m, const PixelFormat pixel_in[3], const PixelFormat pixel_out[3]);
+};
+
+typedef void (*integer_matrix_func)(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right);
+
+/**
+ * Maximum bit depth supported by {@link IntegerMatrix}.
+ */
+constexpr unsigned INTEGER_MATRIX_MAX_DEPTH = 12;
+
+std::unique_ptr<graphengine::Filter> create_integer_matrix(unsigned width, unsigned height, const Matrix3x3 &m,
+                                                           const PixelFormat pixel_in[3], const PixelFormat pixel_out[3], CPUClass cpu);
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_COLORSPACE_INTEGER_MATRIX_H_
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include "common/align.h"
+#include "common/except.h"
+#include "common/pixel.h"
+#include "common/zassert.h"
+#include "graph/filter_base.h"
+#include "graphengine/filter.h"
+#include "colorspace.h"
+#include "lut3d.h"
+
+#if defined(ZIMG_X86)
+  #include "x86/lut3d_x86.h"
+#endif
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+void lut3d_tetrahedral_c(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right)
+{
+	const float *data = lut.data.data();
+	const unsigned n = lut.size;
+	const unsigned stride[3] = { 4, 4 * n, 4 * n * n };
+	const unsigned stride_sum = stride[0] + stride[1] + stride[2];
+	const float limit = static_cast<float>(n - 1);
+
+	for (unsigned j = left; j < right; ++j) {
+		float f[3];
+		unsigned base = 0;
+
+		for (unsigned c = 0; c < 3; ++c) {
+			float x = src[c][j] * lut.scale[c] + lut.offset[c];
+			x = std::max(0.0f, std::min(x, limit));
+
+			unsigned idx = std::min(static_cast<unsigned>(x), n - 2);
+			f[c] = x - static_cast<float>(idx);
+			base += idx * stride[c];
+		}
+
+		// Select the tetrahedron containing the point. Ties are broken in a fixed
+		// order, so that the largest and smallest axes are always distinct.
+		unsigned axis_max = f[0] >= f[1] && f[0] >= f[2] ? 0 : f[1] >= f[2] ? 1 : 2;
+		unsigned axis_min = f[2] <= f[0] && f[2] <= f[1] ? 2 : f[1] <= f[0] ? 1 : 0;
+
+		float a = f[axis_max];
+		float c = f[axis_min];
+		float b = f[0] + f[1] + f[2] - a - c;
+
+		const float *p0 = data + base;
+		const float *p1 = p0 + stride[axis_max];
+		const float *p3 = p0 + stride_sum;
+		const float *p2 = p3 - stride[axis_min];
+
+		for (unsigned p = 0; p < 3; ++p) {
+			dst[p][j] = (1.0f - a) * p0[p] + (a - b) * p1[p] + (b - c) * p2[p] + c * p3[p];
+		}
+	}
+}
+
+
+class Lut3DFilter : public graph::PointFilter {
+	Lut3D m_lut;
+	lut3d_func m_func;
+public:
+	Lut3DFilter(lut3d_func func, unsigned width, unsigned height, Lut3D lut) :
+		PointFilter(width, height, PixelType::FLOAT),
+		m_lut(std::move(lut)),
+		m_func{ func }
+	{
+		m_desc.num_deps = 3;
+		m_desc.num_planes = 3;
+		m_desc.flags.in_place = 1;
+	}
+
+	void process(const graphengine::BufferDescriptor in[3], const graphengine::BufferDescriptor out[3],
+	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
+	{
+		const float *src[3] = { in[0].get_line<float>(i), in[1].get_line<float>(i), in[2].get_line<float>(i) };
+		float *dst[3] = { out[0].get_line<float>(i), out[1].get_line<float>(i), out[2].get_line<float>(i) };
+
+		m_func(m_lut, src, dst, left, right);
+	}
+};
+
+
+// Runs a point filter on a single row held in three planar buffers.
+class RowEvaluator {
+	AlignedVector<float> m_src;
+	AlignedVector<float> m_dst;
+	size_t m_stride;
+	unsigned m_width;
+public:
+	explicit RowEvaluator(unsigned width) :
+		m_stride{ ceil_n(width, AlignmentOf<float>) },
+		m_width{ width }
+	{
+		m_src.resize(m_stride * 3);
+		m_dst.resize(m_stride * 3);
+	}
+
+	float *src(unsigned p) { return m_src.data() + p * m_stride; }
+	const float *dst(unsigned p) const { return m_dst.data() + p * m_stride; }
+
+	void run(const graphengine::Filter &filter)
+	{
+		graphengine::BufferDescriptor in[3];
+		graphengine::BufferDescriptor out[3];
+
+		for (unsigned p = 0; p < 3; ++p) {
+			in[p] = { m_src.data() + p * m_stride, static_cast<ptrdiff_t>(m_stride * sizeof(float)), graphengine::BUFFER_MAX };
+			out[p] = { m_dst.data() + p * m_stride, static_cast<ptrdiff_t>(m_stride * sizeof(float)), graphengine::BUFFER_MAX };
+		}
+
+		zassert_d(filter.descriptor().context_size == 0 && filter.descriptor().scratchpad_size == 0, "point filter expected");
+		filter.process(in, out, 0, 0, m_width, nullptr, nullptr);
+	}
+};
+
+} // namespace
+
+
+Lut3D::Lut3D(unsigned size, bool yuv_in) :
+	data(static_cast<size_t>(size) * size * size * 4),
+	size{ size },
+	scale{},
+	offset{}
+{
+	zassert_d(size >= LUT3D_MIN_SIZE && size <= LUT3D_MAX_SIZE, "lut size out of range");
+
+	for (unsigned c = 0; c < 3; ++c) {
+		float lo = yuv_in && c != 0 ? -0.5f : 0.0f;
+		float hi = lo + 1.0f;
+
+		scale[c] = static_cast<float>(size - 1) / (hi - lo);
+		offset[c] = -lo * scale[c];
+	}
+}
+
+std::unique_ptr<graphengine::Filter> create_lut3d(const graphengine::Filter &exact, unsigned width, unsigned height, unsigned size, bool yuv_in, CPUClass cpu)
+{
+	if (size < LUT3D_MIN_SIZE || size > LUT3D_MAX_SIZE)
+		error::throw_<error::IllegalArgument>("3D LUT size out of range");
+
+	Lut3D lut{ size, yuv_in };
+	RowEvaluator row{ size * size };
+
+	// Evaluate one plane of the cube (constant third coordinate) at a time.
+	for (unsigned z = 0; z < size; ++z) {
+		for (unsigned y = 0; y < size; ++y) {
+			for (unsigned x = 0; x < size; ++x) {
+				row.src(0)[y * size + x] = lut.node_value(0, x);
+				row.src(1)[y * size + x] = lut.node_value(1, y);
+				row.src(2)[y * size + x] = lut.node_value(2, z);
+			}
+		}
+
+		row.run(exact);
+
+		float *node = lut.data.data() + static_cast<size_t>(z) * size * size * 4;
+		for (unsigned k = 0; k < size * size; ++k) {
+			node[k * 4 + 0] = row.dst(0)[k];
+			node[k * 4 + 1] = row.dst(1)[k];
+			node[k * 4 + 2] = row.dst(2)[k];
+			node[k * 4 + 3] = 0.0f;
+		}
+	}
+
+	lut3d_func func = nullptr;
+
+#if defined(ZIMG_X86)
+	func = select_lut3d_func_x86(cpu);
+#endif
+	if (!func)
+		func = lut3d_tetrahedral_c;
+
+	return std::make_unique<Lut3DFilter>(func, width, height, std::move(lut));
+}
+
+Lut3DAccuracy measure_lut3d_accuracy(const graphengine::Filter &exact, const graphengine::Filter &approx, unsigned samples, bool yuv_in)
+{
+	zassert_d(samples >= 2, "too few samples");
+
+	RowEvaluator row_exact{ samples };
+	RowEvaluator row_approx{ samples };
+
+	auto grid_value = [=](unsigned c, unsigned idx)
+	{
+		float lo = yuv_in && c != 0 ? -0.5f : 0.0f;
+		return lo + static_cast<float>(idx) / (samples - 1);
+	};
+
+	Lut3DAccuracy result{};
+	double sum_sq = 0.0;
+
+	for (unsigned z = 0; z < samples; ++z) {
+		for (unsigned y = 0; y < samples; ++y) {
+			for (unsigned x = 0; x < samples; ++x) {
+				row_exact.src(0)[x] = row_approx.src(0)[x] = grid_value(0, x);
+				row_exact.src(1)[x] = row_approx.src(1)[x] = grid_value(1, y);
+				row_exact.src(2)[x] = row_approx.src(2)[x] = grid_value(2, z);
+			}
+
+			row_exact.run(exact);
+			row_approx.run(approx);
+
+			for (unsigned p = 0; p < 3; ++p) {
+				for (unsigned x = 0; x < samples; ++x) {
+					double err = std::fabs(static_cast<double>(row_exact.dst(p)[x]) - row_approx.dst(p)[x]);
+					result.max_error = std::max(result.max_error, err);
+					sum_sq += err * err;
+				}
+			}
+			result.num_samples += samples;
+		}
+	}
+
+	result.rms_error = std::sqrt(sum_sq / (static_cast<double>(result.num_samples) * 3));
+	return result;
+}
+
+} // namespace colorspace
+} // namespace zimg
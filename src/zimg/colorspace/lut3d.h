@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef ZIMG_COLORSPACE_LUT3D_H_
+#define ZIMG_COLORSPACE_LUT3D_H_
+
+#include <memory>
+#include "common/alloc.h"
+
+namespace graphengine {
+class Filter;
+}
+
+
+namespace zimg {
+
+enum class CPUClass;
+
+namespace colorspace {
+
+struct Lut3DAccuracy;
+
+/**
+ * Colorspace conversion sampled on a regular grid.
+ *
+ * Nodes are stored with four interleaved floats (the fourth is padding), with
+ * the first channel varying fastest. Inputs are clamped to the nominal range
+ * of the source colorspace before the lookup.
+ */
+struct Lut3D {
+	AlignedVector<float> data;
+	unsigned size;
+	float scale[3];
+	float offset[3];
+
+	/**
+	 * Allocate an uninitialized table.
+	 *
+	 * @param size number of nodes per axis
+	 * @param yuv_in true if the second and third inputs are centered on zero
+	 */
+	Lut3D(unsigned size, bool yuv_in);
+
+	float node_value(unsigned c, unsigned idx) const { return (idx - offset[c]) / scale[c]; }
+};
+
+typedef void (*lut3d_func)(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right);
+
+/**
+ * Minimum and maximum supported number of nodes per axis.
+ */
+constexpr unsigned LUT3D_MIN_SIZE = 2;
+constexpr unsigned LUT3D_MAX_SIZE = 129;
+
+/**
+ * Sample a conversion into a 3D LUT and return a filter applying it with
+ * tetrahedral interpolation.
+ *
+ * @param exact conversion to sample, must accept rows of at least size^2 pixels
+ * @param width image width
+ * @param height image height
+ * @param size number of nodes per axis
+ * @param yuv_in true if the input colorspace is YUV
+ * @param cpu create filter optimized for given cpu
+ * @return filter
+ */
+std::unique_ptr<graphengine::Filter> create_lut3d(const graphengine::Filter &exact, unsigned width, unsigned height, unsigned size, bool yuv_in, CPUClass cpu);
+
+/**
+ * Compare two conversions on a grid covering the nominal input range.
+ *
+ * @param exact reference conversion
+ * @param approx conversion to evaluate
+ * @param samples number of samples per axis, both filters must accept rows of that width
+ * @param yuv_in true if the input colorspace is YUV
+ * @return error statistics over all channels
+ */
+Lut3DAccuracy measure_lut3d_accuracy(const graphengine::Filter &exact, const graphengine::Filter &approx, unsigned samples, bool yuv_in);
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_COLORSPACE_LUT3D_H_
@@ -153,38 +153,21 @@ public:
 
 class CLToRGBOperationC final : public Operation {
 	gamma_func m_func;
-	float m_kr;
-	float m_kg;
-	float m_kb;
-	float m_nb;
-	float m_pb;
-	float m_nr;
-	float m_pr;
+	CLConstants m_constants;
 	float m_scale;
 public:
-	CLToRGBOperationC(gamma_func to_gamma, gamma_func to_linear, double kr, double kg, double kb, float scale) :
+	CLToRGBOperationC(gamma_func to_linear, const CLConstants &constants, float scale) :
 		m_func{ to_linear },
-		m_kr{ static_cast<float>(kr) },
-		m_kg{ static_cast<float>(kg) },
-		m_kb{ static_cast<float>(kb) },
-		m_nb{},
-		m_pb{},
-		m_nr{},
-		m_pr{},
+		m_constants(constants),
 		m_scale{ scale }
-	{
-		EnsureSinglePrecision x87;
-
-		m_nb = to_gamma(1.0f - static_cast<float>(kb));
-		m_pb = 1.0f - to_gamma(static_cast<float>(kb));
-		m_nr = to_gamma(1.0f - static_cast<float>(kr));
-		m_pr = 1.0f - to_gamma(static_cast<float>(kr));
-	}
+	{}
 
 	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
 	{
 		EnsureSinglePrecision x87;
 
+		const CLConstants &c = m_constants;
+
 		for (unsigned i = left; i < right; ++i) {
 			float y = src[0][i];
 			float u = src[1][i];
@@ -194,20 +177,20 @@ public:
 			float b_minus_y, r_minus_y;
 
 			if (u < 0)
-				b_minus_y = u * 2.0f * m_nb;
+				b_minus_y = u * 2.0f * c.nb;
 			else
-				b_minus_y = u * 2.0f * m_pb;
+				b_minus_y = u * 2.0f * c.pb;
 
 			if (v < 0)
-				r_minus_y = v * 2.0f * m_nr;
+				r_minus_y = v * 2.0f * c.nr;
 			else
-				r_minus_y = v * 2.0f * m_pr;
+				r_minus_y = v * 2.0f * c.pr;
 
 			b = m_func(b_minus_y + y);
 			r = m_func(r_minus_y + y);
 
 			y = m_func(y);
-			g = (y - m_kr * r - m_kb * b) / m_kg;
+			g = (y - c.kr * r - c.kb * b) / c.kg;
 
 			dst[0][i] = r * m_scale;
 			dst[1][i] = g * m_scale;
@@ -218,58 +201,41 @@ public:
 
 class CLToYUVOperationC final : public Operation {
 	gamma_func m_func;
-	float m_kr;
-	float m_kg;
-	float m_kb;
-	float m_nb;
-	float m_pb;
-	float m_nr;
-	float m_pr;
+	CLConstants m_constants;
 	float m_scale;
 public:
-	CLToYUVOperationC(gamma_func func, double kr, double kg, double kb, float scale) :
-		m_func{ func },
-		m_kr{ static_cast<float>(kr) },
-		m_kg{ static_cast<float>(kg) },
-		m_kb{ static_cast<float>(kb) },
-		m_nb{},
-		m_pb{},
-		m_nr{},
-		m_pr{},
+	CLToYUVOperationC(gamma_func to_gamma, const CLConstants &constants, float scale) :
+		m_func{ to_gamma },
+		m_constants(constants),
 		m_scale{ scale }
-	{
-		EnsureSinglePrecision x87;
-
-		m_nb = func(1.0f - static_cast<float>(kb));
-		m_pb = 1.0f - func(static_cast<float>(kb));
-		m_nr = func(1.0f - static_cast<float>(kr));
-		m_pr = 1.0f - func(static_cast<float>(kr));
-	}
+	{}
 
 	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
 	{
 		EnsureSinglePrecision x87;
 
+		const CLConstants &c = m_constants;
+
 		for (unsigned i = left; i < right; ++i) {
 			float r = src[0][i] * m_scale;
 			float g = src[1][i] * m_scale;
 			float b = src[2][i] * m_scale;
 
-			float y = m_func(m_kr * r + m_kg * g + m_kb * b);
+			float y = m_func(c.kr * r + c.kg * g + c.kb * b);
 			float u, v;
 
 			b = m_func(b);
 			r = m_func(r);
 
 			if (b - y < 0.0f)
-				u = (b - y) / (2.0f * m_nb);
+				u = (b - y) / (2.0f * c.nb);
 			else
-				u = (b - y) / (2.0f * m_pb);
+				u = (b - y) / (2.0f * c.pb);
 
 			if (r - y < 0.0f)
-				v = (r - y) / (2.0f * m_nr);
+				v = (r - y) / (2.0f * c.nr);
 			else
-				v = (r - y) / (2.0f * m_pr);
+				v = (r - y) / (2.0f * c.pr);
 
 			dst[0][i] = y;
 			dst[1][i] = u;
@@ -281,7 +247,7 @@ public:
 } // namespace
 
 
-MatrixOperationImpl::MatrixOperationImpl(const Matrix3x3 &m)
+MatrixOperationImpl::MatrixOperationImpl(const Matrix3x3 &m) : m_source(m)
 {
 	for (int i = 0; i < 3; ++i) {
 		for (int j = 0; j < 3; ++j) {
@@ -290,6 +256,29 @@ MatrixOperationImpl::MatrixOperationImpl(const Matrix3x3 &m)
 	}
 }
 
+Matrix3x3 MatrixOperationImpl::matrix() const
+{
+	return m_source;
+}
+
+
+CLConstants::CLConstants(gamma_func to_gamma, double kr, double kg, double kb) :
+	kr{ static_cast<float>(kr) },
+	kg{ static_cast<float>(kg) },
+	kb{ static_cast<float>(kb) },
+	nb{},
+	pb{},
+	nr{},
+	pr{}
+{
+	EnsureSinglePrecision x87;
+
+	nb = to_gamma(1.0f - static_cast<float>(kb));
+	pb = 1.0f - to_gamma(static_cast<float>(kb));
+	nr = to_gamma(1.0f - static_cast<float>(kr));
+	pr = 1.0f - to_gamma(static_cast<float>(kr));
+}
+
 
 std::unique_ptr<Operation> create_matrix_operation(const Matrix3x3 &m, CPUClass cpu)
 {
@@ -336,20 +325,36 @@ std::unique_ptr<Operation> create_inverse_gamma_operation(const TransferFunction
 	return ret;
 }
 
-std::unique_ptr<Operation> create_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params)
+std::unique_ptr<Operation> create_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params, CPUClass cpu)
 {
 	zassert_d(!params.scene_referred, "must be display-referred");
 
 	TransferFunction func = select_transfer_function(TransferCharacteristics::ARIB_B67, params.peak_luminance, false);
-	return std::make_unique<AribB67OperationC>(m[0][0], m[0][1], m[0][2], func.to_gamma_scale);
+	std::unique_ptr<Operation> ret;
+
+#if defined(ZIMG_X86)
+	ret = create_arib_b67_operation_x86(m, func, cpu);
+#endif
+	if (!ret)
+		ret = std::make_unique<AribB67OperationC>(m[0][0], m[0][1], m[0][2], func.to_gamma_scale);
+
+	return ret;
 }
 
-std::unique_ptr<Operation> create_inverse_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params)
+std::unique_ptr<Operation> create_inverse_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params, CPUClass cpu)
 {
 	zassert_d(!params.scene_referred, "must be display-referred");
 
 	TransferFunction func = select_transfer_function(TransferCharacteristics::ARIB_B67, params.peak_luminance, false);
-	return std::make_unique<AribB67InverseOperationC>(m[0][0], m[0][1], m[0][2], func.to_linear_scale);
+	std::unique_ptr<Operation> ret;
+
+#if defined(ZIMG_X86)
+	ret = create_inverse_arib_b67_operation_x86(m, func, cpu);
+#endif
+	if (!ret)
+		ret = std::make_unique<AribB67InverseOperationC>(m[0][0], m[0][1], m[0][2], func.to_linear_scale);
+
+	return ret;
 }
 
 std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation(const ColorspaceDefinition &in, const ColorspaceDefinition &out, const OperationParams &params, CPUClass cpu)
@@ -361,7 +366,16 @@ std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation(const ColorspaceDefini
 	// CL is always scene-referred.
 	TransferFunction func = select_transfer_function(in.transfer, params.peak_luminance, true);
 	Matrix3x3 m = in.matrix == MatrixCoefficients::CHROMATICITY_DERIVED_CL ? ncl_rgb_to_yuv_matrix_from_primaries(in.primaries) : ncl_rgb_to_yuv_matrix(in.matrix);
-	return std::make_unique<CLToRGBOperationC>(func.to_gamma, func.to_linear, m[0][0], m[0][1], m[0][2], func.to_linear_scale);
+	CLConstants constants{ func.to_gamma, m[0][0], m[0][1], m[0][2] };
+	std::unique_ptr<Operation> ret;
+
+#if defined(ZIMG_X86)
+	ret = create_cl_yuv_to_rgb_operation_x86(constants, func, cpu);
+#endif
+	if (!ret)
+		ret = std::make_unique<CLToRGBOperationC>(func.to_linear, constants, func.to_linear_scale);
+
+	return ret;
 }
 
 std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation(const ColorspaceDefinition &in, const ColorspaceDefinition &out, const OperationParams &params, CPUClass cpu)
@@ -373,7 +387,16 @@ std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation(const ColorspaceDefini
 	// CL is always scene-referred.
 	TransferFunction func = select_transfer_function(out.transfer, params.peak_luminance, true);
 	Matrix3x3 m = out.matrix == MatrixCoefficients::CHROMATICITY_DERIVED_CL ? ncl_rgb_to_yuv_matrix_from_primaries(out.primaries) : ncl_rgb_to_yuv_matrix(out.matrix);
-	return std::make_unique<CLToYUVOperationC>(func.to_gamma, m[0][0], m[0][1], m[0][2], func.to_gamma_scale);
+	CLConstants constants{ func.to_gamma, m[0][0], m[0][1], m[0][2] };
+	std::unique_ptr<Operation> ret;
+
+#if defined(ZIMG_X86)
+	ret = create_cl_rgb_to_yuv_operation_x86(constants, func, cpu);
+#endif
+	if (!ret)
+		ret = std::make_unique<CLToYUVOperationC>(func.to_gamma, constants, func.to_gamma_scale);
+
+	return ret;
 }
 
 } // namespace colorspace
@@ -4,6 +4,7 @@
 #define ZIMG_COLORSPACE_OPERATION_IMPL_H_
 
 #include "common/libm_wrapper.h"
+#include "matrix3.h"
 #include "operation.h"
 
 namespace zimg {
@@ -12,13 +13,13 @@ enum class CPUClass;
 
 namespace colorspace {
 
-struct Matrix3x3;
 struct TransferFunction;
 
 /**
  * Base class for matrix operation implementations.
  */
 class MatrixOperationImpl : public Operation {
+	Matrix3x3 m_source;
 protected:
 	/**
 	 * Transformation matrix.
@@ -31,6 +32,36 @@ protected:
 	 * @param m transformation matrix
 	 */
 	explicit MatrixOperationImpl(const Matrix3x3 &matrix);
+public:
+	/**
+	 * Get the transformation matrix at the precision it was created with.
+	 *
+	 * @return matrix
+	 */
+	Matrix3x3 matrix() const;
+};
+
+/**
+ * Coefficients for ITU-R BT.2020 constant luminance YUV.
+ */
+struct CLConstants {
+	float kr;
+	float kg;
+	float kb;
+	float nb;
+	float pb;
+	float nr;
+	float pr;
+
+	/**
+	 * Derive the chroma scaling factors from the luma coefficients.
+	 *
+	 * @param to_gamma OETF
+	 * @param kr red coefficient
+	 * @param kg green coefficient
+	 * @param kb blue coefficient
+	 */
+	CLConstants(float (*to_gamma)(float), double kr, double kg, double kb);
 };
 
 /**
@@ -64,18 +95,20 @@ std::unique_ptr<Operation> create_inverse_gamma_operation(const TransferFunction
  *
  * @param m RGB to YUV conversion matrix for color primaries
  * @param params parameters
+ * @param cpu create operation optimized for given cpu
  * @return concrete operation
  */
-std::unique_ptr<Operation> create_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params);
+std::unique_ptr<Operation> create_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params, CPUClass cpu);
 
 /**
  * Create operation consisting of converting ARIB STD-B67 to linear light using display-referred EOTF.
  *
  * @param m RGB to YUV conversion matrix for color primaries
  * @param params parameters
+ * @param cpu create operation optimized for given cpu
  * @return concrete operation
  */
-std::unique_ptr<Operation> create_inverse_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params);
+std::unique_ptr<Operation> create_inverse_arib_b67_operation(const Matrix3x3 &m, const OperationParams &params, CPUClass cpu);
 
 } // namespace colorspace
 } // namespace zimg
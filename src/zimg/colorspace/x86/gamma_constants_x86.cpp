@@ -1,13 +1,13 @@
-#ifdef ZIMG_X86_AVX512
+#ifdef ZIMG_X86
 
 #include <algorithm>
 #include <cfloat>
 #include <cmath>
-#include "gamma_constants_avx512.h"
+#include "gamma_constants_x86.h"
 
 namespace zimg {
 namespace colorspace {
-namespace avx512constants {
+namespace x86constants {
 
 const float Rec1886EOTF::horner[6] = {
 	3.9435861748560828e-3f,
@@ -192,6 +192,29 @@ const float ST2084InverseEOTF::horner4 alignas(64)[32] = {
 };
 
 
+const float Log2::horner[9] = {
+	-8.6656995117664337e-3f,
+	4.9433369189500809e-2f,
+	-1.3314692676067352e-1f,
+	2.3804198205471039e-1f,
+	-3.4542933106422424e-1f,
+	4.7817644476890564e-1f,
+	-7.2109574079513550e-1f,
+	1.4426858425140381e0f,
+	5.6422440053438550e-8f,
+};
+
+const float Exp2::horner[7] = {
+	2.1865784947294742e-4f,
+	1.2391331838443875e-3f,
+	9.6841864287853241e-3f,
+	5.5480629205703735e-2f,
+	2.4023045599460602e-1f,
+	6.9314694404602051e-1f,
+	1.0000000000000000e0f,
+};
+
+
 // Debug implementations.
 namespace {
 
@@ -283,6 +306,43 @@ float segmented_polynomial(float x)
 	return std::max(result, 0.0f);
 }
 
+// Valid for positive normal numbers.
+float log2_polynomial(float x)
+{
+	int exp;
+	float mant, result;
+
+	mant = frexp_1_2(x, &exp) - 1.0f;
+
+	result = Log2::horner[0];
+	for (unsigned i = 1; i < sizeof(Log2::horner) / sizeof(Log2::horner[0]); ++i) {
+		result = std::fma(result, mant, Log2::horner[i]);
+	}
+
+	return result + static_cast<float>(exp);
+}
+
+float exp2_polynomial(float x)
+{
+	float ipart, fpart, result;
+
+	x = std::min(std::max(x, -126.0f), 127.0f);
+	ipart = std::floor(x);
+	fpart = x - ipart;
+
+	result = Exp2::horner[0];
+	for (unsigned i = 1; i < sizeof(Exp2::horner) / sizeof(Exp2::horner[0]); ++i) {
+		result = std::fma(result, fpart, Exp2::horner[i]);
+	}
+
+	return std::ldexp(result, static_cast<int>(ipart));
+}
+
+float power_polynomial(float x, float p)
+{
+	return x > 0.0f ? exp2_polynomial(log2_polynomial(x) * p) : 0.0f;
+}
+
 } // namespace
 
 
@@ -316,8 +376,38 @@ float st_2084_inverse_eotf(float x)
 	return segmented_polynomial<ST2084InverseEOTF, true>(x);
 }
 
-} // namespace avx512constants
+float arib_b67_oetf(float x)
+{
+	x = std::max(x, 0.0f);
+
+	if (x <= 1.0f / 12.0f)
+		return std::sqrt(3.0f * x);
+	else
+		return std::fma(log2_polynomial(std::fma(x, 12.0f, -AribB67::b)), AribB67::log_scale, AribB67::c);
+}
+
+float arib_b67_inverse_oetf(float x)
+{
+	x = std::max(x, 0.0f);
+
+	if (x <= 0.5f)
+		return x * x * (1.0f / 3.0f);
+	else
+		return (exp2_polynomial((x - AribB67::c) * AribB67::exp_scale) + AribB67::b) * (1.0f / 12.0f);
+}
+
+float arib_b67_eotf(float x)
+{
+	return power_polynomial(arib_b67_inverse_oetf(x), 1.2f);
+}
+
+float arib_b67_inverse_eotf(float x)
+{
+	return arib_b67_oetf(power_polynomial(x, 1.0f / 1.2f));
+}
+
+} // namespace x86constants
 } // namespace colorspace
 } // namespace zimg
 
-#endif // ZIMG_X86_AVX512
+#endif // ZIMG_X86
@@ -1,13 +1,13 @@
 #pragma once
 
-#ifdef ZIMG_X86_AVX512
+#ifdef ZIMG_X86
 
-#ifndef ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_H_
-#define ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_H_
+#ifndef ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_X86_H_
+#define ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_X86_H_
 
 namespace zimg {
 namespace colorspace {
-namespace avx512constants {
+namespace x86constants {
 
 struct Rec1886EOTF {
 	// 5-th order polynomial on domain [1, 2).
@@ -63,6 +63,31 @@ struct ST2084InverseEOTF {
 	static const float horner4 alignas(64)[32];
 };
 
+struct Log2 {
+	// 8-th order polynomial for log2(1 + x) on domain [0, 1).
+	static const float horner[9];
+};
+
+struct Exp2 {
+	// 6-th order polynomial for 2^x on domain [0, 1).
+	static const float horner[7];
+};
+
+struct Rec709 {
+	static constexpr float alpha = 1.09929682680944f;
+	static constexpr float beta = 0.018053968510807f;
+};
+
+struct AribB67 {
+	static constexpr float a = 0.17883277f;
+	static constexpr float b = 0.28466892f;
+	static constexpr float c = 0.55991073f;
+
+	// ln(x) = log2(x) * ln(2), exp(x) = 2^(x * log2(e)).
+	static constexpr float log_scale = a * 0.693147180559945f;
+	static constexpr float exp_scale = 1.442695040888963f / a;
+};
+
 // Debug implementations.
 float rec_1886_eotf(float x);
 float rec_1886_inverse_eotf(float x);
@@ -73,10 +98,15 @@ float srgb_inverse_eotf(float x);
 float st_2084_eotf(float x);
 float st_2084_inverse_eotf(float x);
 
-} // namespace avx512constants
+float arib_b67_oetf(float x);
+float arib_b67_inverse_oetf(float x);
+float arib_b67_eotf(float x);
+float arib_b67_inverse_eotf(float x);
+
+} // namespace x86constants
 } // namespace colorspace
 } // namespace zimg
 
-#endif // ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_H_
+#endif // ZIMG_COLORSPACE_X86_GAMMA_CONSTANTS_X86_H_
 
-#endif // ZIMG_X86_AVX512
+#endif // ZIMG_X86
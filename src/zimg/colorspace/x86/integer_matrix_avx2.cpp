@@ -0,0 +1,206 @@
+#ifdef ZIMG_X86
+
+#include <cstdint>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "integer_matrix_x86.h"
+
+#include "common/x86/sse2_util.h"
+#include "common/x86/avx2_util.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+struct LoadU8 {
+	typedef uint8_t src_type;
+
+	static inline FORCE_INLINE __m256i load16(const uint8_t *ptr)
+	{
+		return _mm256_cvtepu8_epi16(_mm_load_si128((const __m128i *)ptr));
+	}
+};
+
+struct LoadU16 {
+	typedef uint16_t src_type;
+
+	static inline FORCE_INLINE __m256i load16(const uint16_t *ptr)
+	{
+		return _mm256_load_si256((const __m256i *)ptr);
+	}
+};
+
+struct StoreU8 {
+	typedef uint8_t dst_type;
+
+	static inline FORCE_INLINE __m128i pack(__m256i x)
+	{
+		x = _mm256_packus_epi16(x, x);
+		x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+		return _mm256_castsi256_si128(x);
+	}
+
+	static inline FORCE_INLINE void store16(uint8_t *ptr, __m256i x)
+	{
+		_mm_store_si128((__m128i *)ptr, pack(x));
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(uint8_t *ptr, __m256i x, unsigned idx)
+	{
+		mm_store_idxlo_epi8((__m128i *)ptr, pack(x), idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(uint8_t *ptr, __m256i x, unsigned idx)
+	{
+		mm_store_idxhi_epi8((__m128i *)ptr, pack(x), idx);
+	}
+};
+
+struct StoreU16 {
+	typedef uint16_t dst_type;
+
+	static inline FORCE_INLINE void store16(uint16_t *ptr, __m256i x)
+	{
+		_mm256_store_si256((__m256i *)ptr, x);
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(uint16_t *ptr, __m256i x, unsigned idx)
+	{
+		mm256_store_idxlo_epi16((__m256i *)ptr, x, idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(uint16_t *ptr, __m256i x, unsigned idx)
+	{
+		mm256_store_idxhi_epi16((__m256i *)ptr, x, idx);
+	}
+};
+
+struct MatrixCoeffs {
+	// Pairs of coefficients, multiplied with interleaved samples by vpmaddwd.
+	__m256i c01[3];
+	__m256i c2[3];
+	__m256i offset[3];
+	__m128i shift;
+	__m256i max_value;
+
+	explicit MatrixCoeffs(const IntegerMatrix &matrix)
+	{
+		auto pack = [](int16_t lo, int16_t hi) { return static_cast<int>(static_cast<uint16_t>(lo) | (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16)); };
+
+		for (unsigned p = 0; p < 3; ++p) {
+			c01[p] = _mm256_set1_epi32(pack(matrix.coeffs[p][0], matrix.coeffs[p][1]));
+			c2[p] = _mm256_set1_epi32(pack(matrix.coeffs[p][2], 0));
+			offset[p] = _mm256_set1_epi32(matrix.offset[p]);
+		}
+		shift = _mm_cvtsi32_si128(matrix.shift);
+		max_value = _mm256_set1_epi16(matrix.max_value);
+	}
+};
+
+inline FORCE_INLINE __m256i matrix_row_avx2(__m256i x01_lo, __m256i x01_hi, __m256i x2_lo, __m256i x2_hi,
+                                            __m256i c01, __m256i c2, __m256i offset, __m128i shift, __m256i max_value)
+{
+	__m256i lo = _mm256_add_epi32(_mm256_madd_epi16(x01_lo, c01), _mm256_madd_epi16(x2_lo, c2));
+	__m256i hi = _mm256_add_epi32(_mm256_madd_epi16(x01_hi, c01), _mm256_madd_epi16(x2_hi, c2));
+
+	lo = _mm256_sra_epi32(_mm256_add_epi32(lo, offset), shift);
+	hi = _mm256_sra_epi32(_mm256_add_epi32(hi, offset), shift);
+
+	// Unpack and pack both operate within 128-bit lanes, so the pixel order is preserved.
+	__m256i x = _mm256_packs_epi32(lo, hi);
+	x = _mm256_max_epi16(x, _mm256_setzero_si256());
+	x = _mm256_min_epi16(x, max_value);
+	return x;
+}
+
+template <class Load>
+inline FORCE_INLINE void integer_matrix_avx2_xiter(unsigned j, const typename Load::src_type * const src[3], const MatrixCoeffs &c,
+                                                   __m256i &y0, __m256i &y1, __m256i &y2)
+{
+	__m256i x0 = Load::load16(src[0] + j);
+	__m256i x1 = Load::load16(src[1] + j);
+	__m256i x2 = Load::load16(src[2] + j);
+
+	__m256i x01_lo = _mm256_unpacklo_epi16(x0, x1);
+	__m256i x01_hi = _mm256_unpackhi_epi16(x0, x1);
+	__m256i x2_lo = _mm256_unpacklo_epi16(x2, _mm256_setzero_si256());
+	__m256i x2_hi = _mm256_unpackhi_epi16(x2, _mm256_setzero_si256());
+
+	y0 = matrix_row_avx2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[0], c.c2[0], c.offset[0], c.shift, c.max_value);
+	y1 = matrix_row_avx2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[1], c.c2[1], c.offset[1], c.shift, c.max_value);
+	y2 = matrix_row_avx2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[2], c.c2[2], c.offset[2], c.shift, c.max_value);
+}
+
+template <class Load, class Store>
+inline FORCE_INLINE void integer_matrix_avx2_impl(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	typedef typename Load::src_type src_type;
+	typedef typename Store::dst_type dst_type;
+
+	const src_type *src_p[3] = { static_cast<const src_type *>(src[0]), static_cast<const src_type *>(src[1]), static_cast<const src_type *>(src[2]) };
+	dst_type *dst0 = static_cast<dst_type *>(dst[0]);
+	dst_type *dst1 = static_cast<dst_type *>(dst[1]);
+	dst_type *dst2 = static_cast<dst_type *>(dst[2]);
+
+	const MatrixCoeffs c{ matrix };
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	if (left != vec_left) {
+		__m256i y0, y1, y2;
+		integer_matrix_avx2_xiter<Load>(vec_left - 16, src_p, c, y0, y1, y2);
+
+		Store::store16_idxhi(dst0 + vec_left - 16, y0, left % 16);
+		Store::store16_idxhi(dst1 + vec_left - 16, y1, left % 16);
+		Store::store16_idxhi(dst2 + vec_left - 16, y2, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256i y0, y1, y2;
+		integer_matrix_avx2_xiter<Load>(j, src_p, c, y0, y1, y2);
+
+		Store::store16(dst0 + j, y0);
+		Store::store16(dst1 + j, y1);
+		Store::store16(dst2 + j, y2);
+	}
+
+	if (right != vec_right) {
+		__m256i y0, y1, y2;
+		integer_matrix_avx2_xiter<Load>(vec_right, src_p, c, y0, y1, y2);
+
+		Store::store16_idxlo(dst0 + vec_right, y0, right % 16);
+		Store::store16_idxlo(dst1 + vec_right, y1, right % 16);
+		Store::store16_idxlo(dst2 + vec_right, y2, right % 16);
+	}
+}
+
+} // namespace
+
+
+void integer_matrix_b2b_avx2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx2_impl<LoadU8, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_b2w_avx2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx2_impl<LoadU8, StoreU16>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2b_avx2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx2_impl<LoadU16, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2w_avx2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx2_impl<LoadU16, StoreU16>(src, dst, matrix, left, right);
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,182 @@
+#ifdef ZIMG_X86_AVX512
+
+#include <cstdint>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "integer_matrix_x86.h"
+
+#include "common/x86/avx512_util.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+struct LoadU8 {
+	typedef uint8_t src_type;
+
+	static inline FORCE_INLINE __m512i load32(const uint8_t *ptr)
+	{
+		return _mm512_cvtepu8_epi16(_mm256_load_si256((const __m256i *)ptr));
+	}
+};
+
+struct LoadU16 {
+	typedef uint16_t src_type;
+
+	static inline FORCE_INLINE __m512i load32(const uint16_t *ptr)
+	{
+		return _mm512_load_si512(ptr);
+	}
+};
+
+struct StoreU8 {
+	typedef uint8_t dst_type;
+
+	static inline FORCE_INLINE void mask_store32(uint8_t *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm256_mask_storeu_epi8(ptr, mask, _mm512_maskz_cvtepi16_epi8(0xFFFFFFFFU, x));
+	}
+};
+
+struct StoreU16 {
+	typedef uint16_t dst_type;
+
+	static inline FORCE_INLINE void mask_store32(uint16_t *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm512_mask_storeu_epi16(ptr, mask, x);
+	}
+};
+
+struct MatrixCoeffs {
+	// Pairs of coefficients, multiplied with interleaved samples by vpmaddwd.
+	__m512i c01[3];
+	__m512i c2[3];
+	__m512i offset[3];
+	__m128i shift;
+	__m512i max_value;
+
+	explicit MatrixCoeffs(const IntegerMatrix &matrix)
+	{
+		auto pack = [](int16_t lo, int16_t hi) { return static_cast<int>(static_cast<uint16_t>(lo) | (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16)); };
+
+		for (unsigned p = 0; p < 3; ++p) {
+			c01[p] = _mm512_set1_epi32(pack(matrix.coeffs[p][0], matrix.coeffs[p][1]));
+			c2[p] = _mm512_set1_epi32(pack(matrix.coeffs[p][2], 0));
+			offset[p] = _mm512_set1_epi32(matrix.offset[p]);
+		}
+		shift = _mm_cvtsi32_si128(matrix.shift);
+		max_value = _mm512_set1_epi16(matrix.max_value);
+	}
+};
+
+inline FORCE_INLINE __m512i matrix_row_avx512(__m512i x01_lo, __m512i x01_hi, __m512i x2_lo, __m512i x2_hi,
+                                              __m512i c01, __m512i c2, __m512i offset, __m128i shift, __m512i max_value)
+{
+	__m512i lo = _mm512_add_epi32(_mm512_madd_epi16(x01_lo, c01), _mm512_madd_epi16(x2_lo, c2));
+	__m512i hi = _mm512_add_epi32(_mm512_madd_epi16(x01_hi, c01), _mm512_madd_epi16(x2_hi, c2));
+
+	// The zero-masked shift avoids the undefined pass-through operand of
+	// _mm512_sra_epi32, which GCC 12 reports as maybe-uninitialized.
+	lo = _mm512_maskz_sra_epi32(0xFFFF, _mm512_add_epi32(lo, offset), shift);
+	hi = _mm512_maskz_sra_epi32(0xFFFF, _mm512_add_epi32(hi, offset), shift);
+
+	// Unpack and pack both operate within 128-bit lanes, so the pixel order is preserved.
+	__m512i x = _mm512_packs_epi32(lo, hi);
+	x = _mm512_max_epi16(x, _mm512_setzero_si512());
+	x = _mm512_min_epi16(x, max_value);
+	return x;
+}
+
+template <class Load>
+inline FORCE_INLINE void integer_matrix_avx512_xiter(unsigned j, const typename Load::src_type * const src[3], const MatrixCoeffs &c,
+                                                     __m512i &y0, __m512i &y1, __m512i &y2)
+{
+	__m512i x0 = Load::load32(src[0] + j);
+	__m512i x1 = Load::load32(src[1] + j);
+	__m512i x2 = Load::load32(src[2] + j);
+
+	__m512i x01_lo = _mm512_unpacklo_epi16(x0, x1);
+	__m512i x01_hi = _mm512_unpackhi_epi16(x0, x1);
+	__m512i x2_lo = _mm512_unpacklo_epi16(x2, _mm512_setzero_si512());
+	__m512i x2_hi = _mm512_unpackhi_epi16(x2, _mm512_setzero_si512());
+
+	y0 = matrix_row_avx512(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[0], c.c2[0], c.offset[0], c.shift, c.max_value);
+	y1 = matrix_row_avx512(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[1], c.c2[1], c.offset[1], c.shift, c.max_value);
+	y2 = matrix_row_avx512(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[2], c.c2[2], c.offset[2], c.shift, c.max_value);
+}
+
+template <class Load, class Store>
+inline FORCE_INLINE void integer_matrix_avx512_impl(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	typedef typename Load::src_type src_type;
+	typedef typename Store::dst_type dst_type;
+
+	const src_type *src_p[3] = { static_cast<const src_type *>(src[0]), static_cast<const src_type *>(src[1]), static_cast<const src_type *>(src[2]) };
+	dst_type *dst0 = static_cast<dst_type *>(dst[0]);
+	dst_type *dst1 = static_cast<dst_type *>(dst[1]);
+	dst_type *dst2 = static_cast<dst_type *>(dst[2]);
+
+	const MatrixCoeffs c{ matrix };
+
+	unsigned vec_left = ceil_n(left, 32);
+	unsigned vec_right = floor_n(right, 32);
+
+	if (left != vec_left) {
+		__m512i y0, y1, y2;
+		integer_matrix_avx512_xiter<Load>(vec_left - 32, src_p, c, y0, y1, y2);
+
+		__mmask32 mask = mmask32_set_hi(vec_left - left);
+		Store::mask_store32(dst0 + vec_left - 32, mask, y0);
+		Store::mask_store32(dst1 + vec_left - 32, mask, y1);
+		Store::mask_store32(dst2 + vec_left - 32, mask, y2);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 32) {
+		__m512i y0, y1, y2;
+		integer_matrix_avx512_xiter<Load>(j, src_p, c, y0, y1, y2);
+
+		Store::mask_store32(dst0 + j, 0xFFFFFFFFU, y0);
+		Store::mask_store32(dst1 + j, 0xFFFFFFFFU, y1);
+		Store::mask_store32(dst2 + j, 0xFFFFFFFFU, y2);
+	}
+
+	if (right != vec_right) {
+		__m512i y0, y1, y2;
+		integer_matrix_avx512_xiter<Load>(vec_right, src_p, c, y0, y1, y2);
+
+		__mmask32 mask = mmask32_set_lo(right - vec_right);
+		Store::mask_store32(dst0 + vec_right, mask, y0);
+		Store::mask_store32(dst1 + vec_right, mask, y1);
+		Store::mask_store32(dst2 + vec_right, mask, y2);
+	}
+}
+
+} // namespace
+
+
+void integer_matrix_b2b_avx512(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx512_impl<LoadU8, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_b2w_avx512(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx512_impl<LoadU8, StoreU16>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2b_avx512(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx512_impl<LoadU16, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2w_avx512(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_avx512_impl<LoadU16, StoreU16>(src, dst, matrix, left, right);
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86_AVX512
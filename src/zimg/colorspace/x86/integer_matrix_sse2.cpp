@@ -0,0 +1,219 @@
+#ifdef ZIMG_X86
+
+#include <cstdint>
+#include <emmintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "integer_matrix_x86.h"
+
+#include "common/x86/sse2_util.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+struct LoadU8 {
+	typedef uint8_t src_type;
+
+	static inline FORCE_INLINE void load16(const uint8_t *ptr, __m128i &lo, __m128i &hi)
+	{
+		__m128i x = _mm_load_si128((const __m128i *)ptr);
+		lo = _mm_unpacklo_epi8(x, _mm_setzero_si128());
+		hi = _mm_unpackhi_epi8(x, _mm_setzero_si128());
+	}
+};
+
+struct LoadU16 {
+	typedef uint16_t src_type;
+
+	static inline FORCE_INLINE void load16(const uint16_t *ptr, __m128i &lo, __m128i &hi)
+	{
+		lo = _mm_load_si128((const __m128i *)(ptr + 0));
+		hi = _mm_load_si128((const __m128i *)(ptr + 8));
+	}
+};
+
+struct StoreU8 {
+	typedef uint8_t dst_type;
+
+	static inline FORCE_INLINE void store16(uint8_t *ptr, __m128i lo, __m128i hi)
+	{
+		_mm_store_si128((__m128i *)ptr, _mm_packus_epi16(lo, hi));
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(uint8_t *ptr, __m128i lo, __m128i hi, unsigned idx)
+	{
+		mm_store_idxlo_epi8((__m128i *)ptr, _mm_packus_epi16(lo, hi), idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(uint8_t *ptr, __m128i lo, __m128i hi, unsigned idx)
+	{
+		mm_store_idxhi_epi8((__m128i *)ptr, _mm_packus_epi16(lo, hi), idx);
+	}
+};
+
+struct StoreU16 {
+	typedef uint16_t dst_type;
+
+	static inline FORCE_INLINE void store16(uint16_t *ptr, __m128i lo, __m128i hi)
+	{
+		_mm_store_si128((__m128i *)(ptr + 0), lo);
+		_mm_store_si128((__m128i *)(ptr + 8), hi);
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(uint16_t *ptr, __m128i lo, __m128i hi, unsigned idx)
+	{
+		if (idx >= 8) {
+			_mm_store_si128((__m128i *)ptr, lo);
+			mm_store_idxlo_epi16((__m128i *)(ptr + 8), hi, idx - 8);
+		} else {
+			mm_store_idxlo_epi16((__m128i *)ptr, lo, idx);
+		}
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(uint16_t *ptr, __m128i lo, __m128i hi, unsigned idx)
+	{
+		if (idx < 8) {
+			mm_store_idxhi_epi16((__m128i *)ptr, lo, idx);
+			_mm_store_si128((__m128i *)(ptr + 8), hi);
+		} else {
+			mm_store_idxhi_epi16((__m128i *)(ptr + 8), hi, idx - 8);
+		}
+	}
+};
+
+struct MatrixCoeffs {
+	// Pairs of coefficients, multiplied with interleaved samples by pmaddwd.
+	__m128i c01[3];
+	__m128i c2[3];
+	__m128i offset[3];
+	__m128i shift;
+	__m128i max_value;
+
+	explicit MatrixCoeffs(const IntegerMatrix &matrix)
+	{
+		auto pack = [](int16_t lo, int16_t hi) { return static_cast<int>(static_cast<uint16_t>(lo) | (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16)); };
+
+		for (unsigned p = 0; p < 3; ++p) {
+			c01[p] = _mm_set1_epi32(pack(matrix.coeffs[p][0], matrix.coeffs[p][1]));
+			c2[p] = _mm_set1_epi32(pack(matrix.coeffs[p][2], 0));
+			offset[p] = _mm_set1_epi32(matrix.offset[p]);
+		}
+		shift = _mm_cvtsi32_si128(matrix.shift);
+		max_value = _mm_set1_epi16(matrix.max_value);
+	}
+};
+
+inline FORCE_INLINE __m128i matrix_row_sse2(__m128i x01_lo, __m128i x01_hi, __m128i x2_lo, __m128i x2_hi,
+                                            __m128i c01, __m128i c2, __m128i offset, __m128i shift, __m128i max_value)
+{
+	__m128i lo = _mm_add_epi32(_mm_madd_epi16(x01_lo, c01), _mm_madd_epi16(x2_lo, c2));
+	__m128i hi = _mm_add_epi32(_mm_madd_epi16(x01_hi, c01), _mm_madd_epi16(x2_hi, c2));
+
+	lo = _mm_sra_epi32(_mm_add_epi32(lo, offset), shift);
+	hi = _mm_sra_epi32(_mm_add_epi32(hi, offset), shift);
+
+	__m128i x = _mm_packs_epi32(lo, hi);
+	x = _mm_max_epi16(x, _mm_setzero_si128());
+	x = _mm_min_epi16(x, max_value);
+	return x;
+}
+
+inline FORCE_INLINE void matrix_sse2(const MatrixCoeffs &c, __m128i x0, __m128i x1, __m128i x2, __m128i &y0, __m128i &y1, __m128i &y2)
+{
+	__m128i x01_lo = _mm_unpacklo_epi16(x0, x1);
+	__m128i x01_hi = _mm_unpackhi_epi16(x0, x1);
+	__m128i x2_lo = _mm_unpacklo_epi16(x2, _mm_setzero_si128());
+	__m128i x2_hi = _mm_unpackhi_epi16(x2, _mm_setzero_si128());
+
+	y0 = matrix_row_sse2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[0], c.c2[0], c.offset[0], c.shift, c.max_value);
+	y1 = matrix_row_sse2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[1], c.c2[1], c.offset[1], c.shift, c.max_value);
+	y2 = matrix_row_sse2(x01_lo, x01_hi, x2_lo, x2_hi, c.c01[2], c.c2[2], c.offset[2], c.shift, c.max_value);
+}
+
+template <class Load>
+inline FORCE_INLINE void integer_matrix_sse2_xiter(unsigned j, const typename Load::src_type * const src[3], const MatrixCoeffs &c,
+                                                   __m128i &y0_lo, __m128i &y0_hi, __m128i &y1_lo, __m128i &y1_hi, __m128i &y2_lo, __m128i &y2_hi)
+{
+	__m128i x0_lo, x0_hi, x1_lo, x1_hi, x2_lo, x2_hi;
+
+	Load::load16(src[0] + j, x0_lo, x0_hi);
+	Load::load16(src[1] + j, x1_lo, x1_hi);
+	Load::load16(src[2] + j, x2_lo, x2_hi);
+
+	matrix_sse2(c, x0_lo, x1_lo, x2_lo, y0_lo, y1_lo, y2_lo);
+	matrix_sse2(c, x0_hi, x1_hi, x2_hi, y0_hi, y1_hi, y2_hi);
+}
+
+template <class Load, class Store>
+inline FORCE_INLINE void integer_matrix_sse2_impl(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	typedef typename Load::src_type src_type;
+	typedef typename Store::dst_type dst_type;
+
+	const src_type *src_p[3] = { static_cast<const src_type *>(src[0]), static_cast<const src_type *>(src[1]), static_cast<const src_type *>(src[2]) };
+	dst_type *dst0 = static_cast<dst_type *>(dst[0]);
+	dst_type *dst1 = static_cast<dst_type *>(dst[1]);
+	dst_type *dst2 = static_cast<dst_type *>(dst[2]);
+
+	const MatrixCoeffs c{ matrix };
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	if (left != vec_left) {
+		__m128i y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi;
+		integer_matrix_sse2_xiter<Load>(vec_left - 16, src_p, c, y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi);
+
+		Store::store16_idxhi(dst0 + vec_left - 16, y0_lo, y0_hi, left % 16);
+		Store::store16_idxhi(dst1 + vec_left - 16, y1_lo, y1_hi, left % 16);
+		Store::store16_idxhi(dst2 + vec_left - 16, y2_lo, y2_hi, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m128i y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi;
+		integer_matrix_sse2_xiter<Load>(j, src_p, c, y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi);
+
+		Store::store16(dst0 + j, y0_lo, y0_hi);
+		Store::store16(dst1 + j, y1_lo, y1_hi);
+		Store::store16(dst2 + j, y2_lo, y2_hi);
+	}
+
+	if (right != vec_right) {
+		__m128i y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi;
+		integer_matrix_sse2_xiter<Load>(vec_right, src_p, c, y0_lo, y0_hi, y1_lo, y1_hi, y2_lo, y2_hi);
+
+		Store::store16_idxlo(dst0 + vec_right, y0_lo, y0_hi, right % 16);
+		Store::store16_idxlo(dst1 + vec_right, y1_lo, y1_hi, right % 16);
+		Store::store16_idxlo(dst2 + vec_right, y2_lo, y2_hi, right % 16);
+	}
+}
+
+} // namespace
+
+
+void integer_matrix_b2b_sse2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_sse2_impl<LoadU8, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_b2w_sse2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_sse2_impl<LoadU8, StoreU16>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2b_sse2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_sse2_impl<LoadU16, StoreU8>(src, dst, matrix, left, right);
+}
+
+void integer_matrix_w2w_sse2(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+{
+	integer_matrix_sse2_impl<LoadU16, StoreU16>(src, dst, matrix, left, right);
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,91 @@
+#ifdef ZIMG_X86
+
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "integer_matrix_x86.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+integer_matrix_func select_integer_matrix_func_sse2(PixelType type_in, PixelType type_out)
+{
+	if (type_in == PixelType::BYTE && type_out == PixelType::BYTE)
+		return integer_matrix_b2b_sse2;
+	else if (type_in == PixelType::BYTE && type_out == PixelType::WORD)
+		return integer_matrix_b2w_sse2;
+	else if (type_in == PixelType::WORD && type_out == PixelType::BYTE)
+		return integer_matrix_w2b_sse2;
+	else if (type_in == PixelType::WORD && type_out == PixelType::WORD)
+		return integer_matrix_w2w_sse2;
+	else
+		return nullptr;
+}
+
+integer_matrix_func select_integer_matrix_func_avx2(PixelType type_in, PixelType type_out)
+{
+	if (type_in == PixelType::BYTE && type_out == PixelType::BYTE)
+		return integer_matrix_b2b_avx2;
+	else if (type_in == PixelType::BYTE && type_out == PixelType::WORD)
+		return integer_matrix_b2w_avx2;
+	else if (type_in == PixelType::WORD && type_out == PixelType::BYTE)
+		return integer_matrix_w2b_avx2;
+	else if (type_in == PixelType::WORD && type_out == PixelType::WORD)
+		return integer_matrix_w2w_avx2;
+	else
+		return nullptr;
+}
+
+#ifdef ZIMG_X86_AVX512
+integer_matrix_func select_integer_matrix_func_avx512(PixelType type_in, PixelType type_out)
+{
+	if (type_in == PixelType::BYTE && type_out == PixelType::BYTE)
+		return integer_matrix_b2b_avx512;
+	else if (type_in == PixelType::BYTE && type_out == PixelType::WORD)
+		return integer_matrix_b2w_avx512;
+	else if (type_in == PixelType::WORD && type_out == PixelType::BYTE)
+		return integer_matrix_w2b_avx512;
+	else if (type_in == PixelType::WORD && type_out == PixelType::WORD)
+		return integer_matrix_w2w_avx512;
+	else
+		return nullptr;
+}
+#endif // ZIMG_X86_AVX512
+
+} // namespace
+
+
+integer_matrix_func select_integer_matrix_func_x86(PixelType type_in, PixelType type_out, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	integer_matrix_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			func = select_integer_matrix_func_avx512(type_in, type_out);
+#endif
+		if (!func && caps.avx2)
+			func = select_integer_matrix_func_avx2(type_in, type_out);
+		if (!func && caps.sse2)
+			func = select_integer_matrix_func_sse2(type_in, type_out);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu >= CPUClass::X86_AVX512)
+			func = select_integer_matrix_func_avx512(type_in, type_out);
+#endif
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_integer_matrix_func_avx2(type_in, type_out);
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = select_integer_matrix_func_sse2(type_in, type_out);
+	}
+
+	return func;
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef ZIMG_X86
+
+#ifndef ZIMG_COLORSPACE_X86_INTEGER_MATRIX_X86_H_
+#define ZIMG_COLORSPACE_X86_INTEGER_MATRIX_X86_H_
+
+#include "colorspace/integer_matrix.h"
+
+namespace zimg {
+
+enum class PixelType;
+
+namespace colorspace {
+
+#define DECLARE_INTEGER_MATRIX(x, cpu) \
+void integer_matrix_##x##_##cpu(const void * const src[3], void * const dst[3], const IntegerMatrix &matrix, unsigned left, unsigned right)
+
+DECLARE_INTEGER_MATRIX(b2b, sse2);
+DECLARE_INTEGER_MATRIX(b2w, sse2);
+DECLARE_INTEGER_MATRIX(w2b, sse2);
+DECLARE_INTEGER_MATRIX(w2w, sse2);
+DECLARE_INTEGER_MATRIX(b2b, avx2);
+DECLARE_INTEGER_MATRIX(b2w, avx2);
+DECLARE_INTEGER_MATRIX(w2b, avx2);
+DECLARE_INTEGER_MATRIX(w2w, avx2);
+DECLARE_INTEGER_MATRIX(b2b, avx512);
+DECLARE_INTEGER_MATRIX(b2w, avx512);
+DECLARE_INTEGER_MATRIX(w2b, avx512);
+DECLARE_INTEGER_MATRIX(w2w, avx512);
+
+#undef DECLARE_INTEGER_MATRIX
+
+integer_matrix_func select_integer_matrix_func_x86(PixelType type_in, PixelType type_out, CPUClass cpu);
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_COLORSPACE_X86_INTEGER_MATRIX_X86_H_
+
+#endif // ZIMG_X86
@@ -0,0 +1,140 @@
+#ifdef ZIMG_X86
+
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "colorspace/lut3d.h"
+#include "lut3d_x86.h"
+
+#include "common/x86/avx_util.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+struct Lut3DConstants {
+	__m256 scale[3];
+	__m256 offset[3];
+	__m256 limit;
+	__m256i max_idx;
+	__m256i stride[3];
+	__m256i stride_sum;
+
+	explicit Lut3DConstants(const Lut3D &lut)
+	{
+		const unsigned n = lut.size;
+		const int stride_[3] = { 4, static_cast<int>(4 * n), static_cast<int>(4 * n * n) };
+
+		for (unsigned c = 0; c < 3; ++c) {
+			scale[c] = _mm256_set1_ps(lut.scale[c]);
+			offset[c] = _mm256_set1_ps(lut.offset[c]);
+			stride[c] = _mm256_set1_epi32(stride_[c]);
+		}
+		limit = _mm256_set1_ps(static_cast<float>(n - 1));
+		max_idx = _mm256_set1_epi32(static_cast<int>(n - 2));
+		stride_sum = _mm256_set1_epi32(stride_[0] + stride_[1] + stride_[2]);
+	}
+};
+
+inline FORCE_INLINE __m256i blendv_epi32(__m256i a, __m256i b, __m256 mask)
+{
+	return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), mask));
+}
+
+inline FORCE_INLINE void lut3d_avx2_xiter(unsigned j, const float *data, const Lut3DConstants &k, const float * const src[3],
+                                          __m256 &y0, __m256 &y1, __m256 &y2)
+{
+	__m256 f[3];
+	__m256i base = _mm256_setzero_si256();
+
+	for (unsigned c = 0; c < 3; ++c) {
+		__m256 x = _mm256_fmadd_ps(_mm256_load_ps(src[c] + j), k.scale[c], k.offset[c]);
+		x = _mm256_max_ps(_mm256_min_ps(x, k.limit), _mm256_setzero_ps());
+
+		__m256i idx = _mm256_min_epi32(_mm256_cvttps_epi32(x), k.max_idx);
+		f[c] = _mm256_sub_ps(x, _mm256_cvtepi32_ps(idx));
+		base = _mm256_add_epi32(base, _mm256_mullo_epi32(idx, k.stride[c]));
+	}
+
+	// Tetrahedron selection, with the same tie-breaking as the C implementation.
+	__m256 max_x = _mm256_and_ps(_mm256_cmp_ps(f[0], f[1], _CMP_GE_OQ), _mm256_cmp_ps(f[0], f[2], _CMP_GE_OQ));
+	__m256 max_y = _mm256_andnot_ps(max_x, _mm256_cmp_ps(f[1], f[2], _CMP_GE_OQ));
+	__m256 min_z = _mm256_and_ps(_mm256_cmp_ps(f[2], f[0], _CMP_LE_OQ), _mm256_cmp_ps(f[2], f[1], _CMP_LE_OQ));
+	__m256 min_y = _mm256_andnot_ps(min_z, _mm256_cmp_ps(f[1], f[0], _CMP_LE_OQ));
+
+	__m256 a = _mm256_blendv_ps(_mm256_blendv_ps(f[2], f[1], max_y), f[0], max_x);
+	__m256 c = _mm256_blendv_ps(_mm256_blendv_ps(f[0], f[1], min_y), f[2], min_z);
+	__m256 b = _mm256_sub_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(f[0], f[1]), f[2]), a), c);
+
+	__m256i stride_max = blendv_epi32(blendv_epi32(k.stride[2], k.stride[1], max_y), k.stride[0], max_x);
+	__m256i stride_min = blendv_epi32(blendv_epi32(k.stride[0], k.stride[1], min_y), k.stride[2], min_z);
+
+	__m256i idx0 = base;
+	__m256i idx1 = _mm256_add_epi32(base, stride_max);
+	__m256i idx3 = _mm256_add_epi32(base, k.stride_sum);
+	__m256i idx2 = _mm256_sub_epi32(idx3, stride_min);
+
+	__m256 w0 = _mm256_sub_ps(_mm256_set1_ps(1.0f), a);
+	__m256 w1 = _mm256_sub_ps(a, b);
+	__m256 w2 = _mm256_sub_ps(b, c);
+	__m256 w3 = c;
+
+	__m256 y[3];
+
+	for (unsigned p = 0; p < 3; ++p) {
+		__m256 v = _mm256_mul_ps(w0, _mm256_i32gather_ps(data + p, idx0, sizeof(float)));
+		v = _mm256_fmadd_ps(w1, _mm256_i32gather_ps(data + p, idx1, sizeof(float)), v);
+		v = _mm256_fmadd_ps(w2, _mm256_i32gather_ps(data + p, idx2, sizeof(float)), v);
+		v = _mm256_fmadd_ps(w3, _mm256_i32gather_ps(data + p, idx3, sizeof(float)), v);
+		y[p] = v;
+	}
+
+	y0 = y[0];
+	y1 = y[1];
+	y2 = y[2];
+}
+
+} // namespace
+
+
+void lut3d_tetrahedral_avx2(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right)
+{
+	const float *data = lut.data.data();
+	const Lut3DConstants k{ lut };
+
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	if (left != vec_left) {
+		__m256 y0, y1, y2;
+		lut3d_avx2_xiter(vec_left - 8, data, k, src, y0, y1, y2);
+
+		mm256_store_idxhi_ps(dst[0] + vec_left - 8, y0, left % 8);
+		mm256_store_idxhi_ps(dst[1] + vec_left - 8, y1, left % 8);
+		mm256_store_idxhi_ps(dst[2] + vec_left - 8, y2, left % 8);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		__m256 y0, y1, y2;
+		lut3d_avx2_xiter(j, data, k, src, y0, y1, y2);
+
+		_mm256_store_ps(dst[0] + j, y0);
+		_mm256_store_ps(dst[1] + j, y1);
+		_mm256_store_ps(dst[2] + j, y2);
+	}
+
+	if (right != vec_right) {
+		__m256 y0, y1, y2;
+		lut3d_avx2_xiter(vec_right, data, k, src, y0, y1, y2);
+
+		mm256_store_idxlo_ps(dst[0] + vec_right, y0, right % 8);
+		mm256_store_idxlo_ps(dst[1] + vec_right, y1, right % 8);
+		mm256_store_idxlo_ps(dst[2] + vec_right, y2, right % 8);
+	}
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,139 @@
+#ifdef ZIMG_X86_AVX512
+
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "colorspace/lut3d.h"
+#include "lut3d_x86.h"
+
+#include "common/x86/avx512_util.h"
+
+namespace zimg {
+namespace colorspace {
+
+namespace {
+
+struct Lut3DConstants {
+	__m512 scale[3];
+	__m512 offset[3];
+	__m512 limit;
+	__m512i max_idx;
+	__m512i stride[3];
+	__m512i stride_sum;
+
+	explicit Lut3DConstants(const Lut3D &lut)
+	{
+		const unsigned n = lut.size;
+		const int stride_[3] = { 4, static_cast<int>(4 * n), static_cast<int>(4 * n * n) };
+
+		for (unsigned c = 0; c < 3; ++c) {
+			scale[c] = _mm512_set1_ps(lut.scale[c]);
+			offset[c] = _mm512_set1_ps(lut.offset[c]);
+			stride[c] = _mm512_set1_epi32(stride_[c]);
+		}
+		limit = _mm512_set1_ps(static_cast<float>(n - 1));
+		max_idx = _mm512_set1_epi32(static_cast<int>(n - 2));
+		stride_sum = _mm512_set1_epi32(stride_[0] + stride_[1] + stride_[2]);
+	}
+};
+
+inline FORCE_INLINE void lut3d_avx512_xiter(unsigned j, const float *data, const Lut3DConstants &k, const float * const src[3],
+                                            __m512 &y0, __m512 &y1, __m512 &y2)
+{
+	__m512 f[3];
+	__m512i base = _mm512_setzero_si512();
+
+	// The zero-masked forms avoid the undefined pass-through operands of the
+	// unmasked intrinsics, which GCC 12 reports as maybe-uninitialized.
+	for (unsigned c = 0; c < 3; ++c) {
+		__m512 x = _mm512_fmadd_ps(_mm512_load_ps(src[c] + j), k.scale[c], k.offset[c]);
+		x = _mm512_maskz_max_ps(0xFFFF, _mm512_maskz_min_ps(0xFFFF, x, k.limit), _mm512_setzero_ps());
+
+		__m512i idx = _mm512_maskz_min_epi32(0xFFFF, _mm512_maskz_cvttps_epi32(0xFFFF, x), k.max_idx);
+		f[c] = _mm512_sub_ps(x, _mm512_maskz_cvtepi32_ps(0xFFFF, idx));
+		base = _mm512_add_epi32(base, _mm512_mullo_epi32(idx, k.stride[c]));
+	}
+
+	// Tetrahedron selection, with the same tie-breaking as the C implementation.
+	__mmask16 max_x = _mm512_cmp_ps_mask(f[0], f[1], _CMP_GE_OQ) & _mm512_cmp_ps_mask(f[0], f[2], _CMP_GE_OQ);
+	__mmask16 max_y = ~max_x & _mm512_cmp_ps_mask(f[1], f[2], _CMP_GE_OQ);
+	__mmask16 min_z = _mm512_cmp_ps_mask(f[2], f[0], _CMP_LE_OQ) & _mm512_cmp_ps_mask(f[2], f[1], _CMP_LE_OQ);
+	__mmask16 min_y = ~min_z & _mm512_cmp_ps_mask(f[1], f[0], _CMP_LE_OQ);
+
+	__m512 a = _mm512_mask_blend_ps(max_x, _mm512_mask_blend_ps(max_y, f[2], f[1]), f[0]);
+	__m512 c = _mm512_mask_blend_ps(min_z, _mm512_mask_blend_ps(min_y, f[0], f[1]), f[2]);
+	__m512 b = _mm512_sub_ps(_mm512_sub_ps(_mm512_add_ps(_mm512_add_ps(f[0], f[1]), f[2]), a), c);
+
+	__m512i stride_max = _mm512_mask_blend_epi32(max_x, _mm512_mask_blend_epi32(max_y, k.stride[2], k.stride[1]), k.stride[0]);
+	__m512i stride_min = _mm512_mask_blend_epi32(min_z, _mm512_mask_blend_epi32(min_y, k.stride[0], k.stride[1]), k.stride[2]);
+
+	__m512i idx0 = base;
+	__m512i idx1 = _mm512_add_epi32(base, stride_max);
+	__m512i idx3 = _mm512_add_epi32(base, k.stride_sum);
+	__m512i idx2 = _mm512_sub_epi32(idx3, stride_min);
+
+	__m512 w0 = _mm512_sub_ps(_mm512_set1_ps(1.0f), a);
+	__m512 w1 = _mm512_sub_ps(a, b);
+	__m512 w2 = _mm512_sub_ps(b, c);
+	__m512 w3 = c;
+
+	__m512 y[3];
+
+	for (unsigned p = 0; p < 3; ++p) {
+		__m512 v = _mm512_mul_ps(w0, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx0, data + p, sizeof(float)));
+		v = _mm512_fmadd_ps(w1, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx1, data + p, sizeof(float)), v);
+		v = _mm512_fmadd_ps(w2, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx2, data + p, sizeof(float)), v);
+		v = _mm512_fmadd_ps(w3, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx3, data + p, sizeof(float)), v);
+		y[p] = v;
+	}
+
+	y0 = y[0];
+	y1 = y[1];
+	y2 = y[2];
+}
+
+} // namespace
+
+
+void lut3d_tetrahedral_avx512(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right)
+{
+	const float *data = lut.data.data();
+	const Lut3DConstants k{ lut };
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	if (left != vec_left) {
+		__m512 y0, y1, y2;
+		lut3d_avx512_xiter(vec_left - 16, data, k, src, y0, y1, y2);
+
+		__mmask16 mask = mmask16_set_hi(vec_left - left);
+		_mm512_mask_store_ps(dst[0] + vec_left - 16, mask, y0);
+		_mm512_mask_store_ps(dst[1] + vec_left - 16, mask, y1);
+		_mm512_mask_store_ps(dst[2] + vec_left - 16, mask, y2);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m512 y0, y1, y2;
+		lut3d_avx512_xiter(j, data, k, src, y0, y1, y2);
+
+		_mm512_store_ps(dst[0] + j, y0);
+		_mm512_store_ps(dst[1] + j, y1);
+		_mm512_store_ps(dst[2] + j, y2);
+	}
+
+	if (right != vec_right) {
+		__m512 y0, y1, y2;
+		lut3d_avx512_xiter(vec_right, data, k, src, y0, y1, y2);
+
+		__mmask16 mask = mmask16_set_lo(right - vec_right);
+		_mm512_mask_store_ps(dst[0] + vec_right, mask, y0);
+		_mm512_mask_store_ps(dst[1] + vec_right, mask, y1);
+		_mm512_mask_store_ps(dst[2] + vec_right, mask, y2);
+	}
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86_AVX512
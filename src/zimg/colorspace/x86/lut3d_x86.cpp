@@ -0,0 +1,37 @@
+#ifdef ZIMG_X86
+
+#include "common/cpuinfo.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "lut3d_x86.h"
+
+namespace zimg {
+namespace colorspace {
+
+lut3d_func select_lut3d_func_x86(CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	lut3d_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			func = lut3d_tetrahedral_avx512;
+#endif
+		if (!func && caps.avx2 && !cpu_has_slow_gather(caps))
+			func = lut3d_tetrahedral_avx2;
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu >= CPUClass::X86_AVX512)
+			func = lut3d_tetrahedral_avx512;
+#endif
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = lut3d_tetrahedral_avx2;
+	}
+
+	return func;
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef ZIMG_X86
+
+#ifndef ZIMG_COLORSPACE_X86_LUT3D_X86_H_
+#define ZIMG_COLORSPACE_X86_LUT3D_X86_H_
+
+#include "colorspace/lut3d.h"
+
+namespace zimg {
+namespace colorspace {
+
+void lut3d_tetrahedral_avx2(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right);
+void lut3d_tetrahedral_avx512(const Lut3D &lut, const float * const src[3], float * const dst[3], unsigned left, unsigned right);
+
+lut3d_func select_lut3d_func_x86(CPUClass cpu);
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_COLORSPACE_X86_LUT3D_X86_H_
+
+#endif // ZIMG_X86
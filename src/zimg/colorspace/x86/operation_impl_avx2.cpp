@@ -1,15 +1,21 @@
 #ifdef ZIMG_X86
 
 #include <algorithm>
+#include <cfloat>
 #include <cstdint>
 #include <vector>
 #include <immintrin.h>
 #include "common/align.h"
 #include "common/ccdep.h"
 #include "colorspace/gamma.h"
+#include "colorspace/matrix3.h"
 #include "colorspace/operation.h"
+#include "colorspace/operation_impl.h"
+#include "gamma_constants_x86.h"
 #include "operation_impl_x86.h"
 
+#include "common/x86/avx_util.h"
+
 namespace zimg {
 namespace colorspace {
 
@@ -79,6 +85,485 @@ void to_gamma_lut_filter_line(const float *RESTRICT lut, const float *src, float
 	}
 }
 
+// Read a 16-element table indexed by the low 4 bits of each lane.
+inline FORCE_INLINE __m256 mm256_permute16_ps(const float *table, __m256i idx)
+{
+	__m256 lo = _mm256_permutevar8x32_ps(_mm256_load_ps(table + 0), idx);
+	__m256 hi = _mm256_permutevar8x32_ps(_mm256_load_ps(table + 8), idx);
+	return _mm256_blendv_ps(lo, hi, _mm256_castsi256_ps(_mm256_slli_epi32(idx, 28)));
+}
+
+// Read a 32-element table indexed by the low 5 bits of each lane.
+inline FORCE_INLINE __m256 mm256_permute32_ps(const float *table, __m256i idx)
+{
+	__m256 lo = mm256_permute16_ps(table + 0, idx);
+	__m256 hi = mm256_permute16_ps(table + 16, idx);
+	return _mm256_blendv_ps(lo, hi, _mm256_castsi256_ps(_mm256_slli_epi32(idx, 27)));
+}
+
+// Valid for positive normal numbers.
+inline FORCE_INLINE __m256 mm256_log2_ps(__m256 x)
+{
+	typedef x86constants::Log2 T;
+
+	const __m256i mant_mask = _mm256_set1_epi32(0x007FFFFF);
+	const __m256i one = _mm256_set1_epi32(0x3F800000);
+
+	__m256 mant, exp, result;
+
+	mant = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(x), mant_mask), one));
+	mant = _mm256_sub_ps(mant, _mm256_set1_ps(1.0f));
+	exp = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(127)));
+
+	result = _mm256_set1_ps(T::horner[0]);
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[1]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[2]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[3]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[4]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[5]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[6]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[7]));
+	result = _mm256_fmadd_ps(result, mant, _mm256_set1_ps(T::horner[8]));
+
+	return _mm256_add_ps(result, exp);
+}
+
+inline FORCE_INLINE __m256 mm256_exp2_ps(__m256 x)
+{
+	typedef x86constants::Exp2 T;
+
+	__m256 ipart, fpart, result;
+	__m256i exp;
+
+	x = _mm256_max_ps(x, _mm256_set1_ps(-126.0f));
+	x = _mm256_min_ps(x, _mm256_set1_ps(127.0f));
+	ipart = _mm256_floor_ps(x);
+	fpart = _mm256_sub_ps(x, ipart);
+
+	result = _mm256_set1_ps(T::horner[0]);
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[1]));
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[2]));
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[3]));
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[4]));
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[5]));
+	result = _mm256_fmadd_ps(result, fpart, _mm256_set1_ps(T::horner[6]));
+
+	// Scale by 2^ipart.
+	exp = _mm256_add_epi32(_mm256_cvttps_epi32(ipart), _mm256_set1_epi32(127));
+	exp = _mm256_slli_epi32(exp, 23);
+	return _mm256_mul_ps(result, _mm256_castsi256_ps(exp));
+}
+
+// x ^ p for positive x, 0 otherwise.
+inline FORCE_INLINE __m256 mm256_pow_ps(__m256 x, float p)
+{
+	__m256 result = mm256_exp2_ps(_mm256_mul_ps(mm256_log2_ps(x), _mm256_set1_ps(p)));
+	return _mm256_and_ps(result, _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ));
+}
+
+
+template <class T, bool Prescale>
+struct PowerFunction {
+	static inline FORCE_INLINE __m256 func(__m256 x, __m256 scale)
+	{
+		constexpr bool ExtendedExponent = sizeof(T::table) / sizeof(T::table[0]) == 32;
+
+		const __m256i exponent_min = _mm256_set1_epi32(127 - (ExtendedExponent ? 31 : 15));
+		const __m256 two_minus_eps = _mm256_set1_ps(1.99999988f);
+		const __m256 sign = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000U));
+		const __m256i mant_mask = _mm256_set1_epi32(0x007FFFFF);
+		const __m256i one = _mm256_set1_epi32(0x3F800000);
+
+		__m256 orig, mant, mantpart, exppart;
+		__m256i exp;
+
+		if (Prescale)
+			x = _mm256_mul_ps(x, scale);
+
+		orig = x;
+		x = _mm256_andnot_ps(sign, x);
+		x = _mm256_min_ps(x, two_minus_eps);
+
+		// Decompose into mantissa and exponent.
+		mant = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(x), mant_mask), one));
+		exp = _mm256_srli_epi32(_mm256_castps_si256(x), 23);
+		exp = _mm256_max_epi32(exp, exponent_min);
+
+		// Apply polynomial approximation to mantissa.
+		mantpart = _mm256_set1_ps(T::horner[0]);
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[1]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[2]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[3]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[4]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[5]));
+
+		// Read f(2^e) from a 16 or 32-element LUT.
+		if (ExtendedExponent)
+			exppart = mm256_permute32_ps(T::table, exp);
+		else
+			exppart = mm256_permute16_ps(T::table, exp);
+
+		// f(m * 2^e) == f(m) * f(2^e)
+		x = _mm256_mul_ps(mantpart, exppart);
+
+		if (!Prescale)
+			x = _mm256_mul_ps(x, scale);
+
+		// copysign(x, orig)
+		x = _mm256_or_ps(_mm256_andnot_ps(sign, x), _mm256_and_ps(sign, orig));
+		return x;
+	}
+};
+
+template <class T, bool Eotf, bool Prescale>
+struct SRGBPowerFunction {
+	static inline FORCE_INLINE __m256 func(__m256 x, __m256 scale)
+	{
+		constexpr bool ExtendedExponent = sizeof(T::table) / sizeof(T::table[0]) == 32;
+
+		const __m256 two_minus_eps = _mm256_set1_ps(1.99999988f);
+		const __m256 sign = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000U));
+		const __m256i mant_mask = _mm256_set1_epi32(0x007FFFFF);
+		const __m256i one = _mm256_set1_epi32(0x3F800000);
+
+		__m256 orig, mant, mantpart, exppart, mask;
+		__m256i exp;
+
+		if (Prescale)
+			x = _mm256_mul_ps(x, scale);
+
+		orig = x;
+		x = _mm256_andnot_ps(sign, x);
+		x = _mm256_min_ps(x, two_minus_eps);
+
+		// Check if the argument belongs to the linear or the power domain.
+		mask = _mm256_cmp_ps(x, _mm256_set1_ps(T::knee), _CMP_LE_OQ);
+
+		// f(x) = (x * a + b) ^ p
+		if (Eotf)
+			x = _mm256_fmadd_ps(x, _mm256_set1_ps(T::power_scale), _mm256_set1_ps(T::power_offset));
+
+		// Decompose into mantissa and exponent.
+		mant = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(x), mant_mask), one));
+		exp = _mm256_srli_epi32(_mm256_castps_si256(x), 23); // Exponent range limit not needed because of mask.
+
+		// Apply polynomial approximation to mantissa.
+		mantpart = _mm256_set1_ps(T::horner[0]);
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[1]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[2]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[3]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[4]));
+		mantpart = _mm256_fmadd_ps(mantpart, mant, _mm256_set1_ps(T::horner[5]));
+
+		// Read f(2^e) from a 16-element LUT.
+		exppart = mm256_permute16_ps(ExtendedExponent ? T::table + 16 : T::table, exp);
+
+		// f(m * 2^e) == f(m) * f(2^e)
+		x = _mm256_mul_ps(mantpart, exppart);
+
+		// f(x) = (x ^ p) * a + b
+		if (!Eotf)
+			x = _mm256_fmadd_ps(x, _mm256_set1_ps(T::power_scale), _mm256_set1_ps(T::power_offset));
+
+		// Merge with the linear segment.
+		x = _mm256_blendv_ps(x, _mm256_mul_ps(orig, _mm256_set1_ps(T::linear_scale)), mask);
+
+		if (!Prescale)
+			x = _mm256_mul_ps(x, scale);
+
+		// copysign(x, orig)
+		x = _mm256_or_ps(_mm256_andnot_ps(sign, x), _mm256_and_ps(sign, orig));
+		return x;
+	}
+};
+
+template <bool InverseOotf>
+struct AribB67OETF {
+	static inline FORCE_INLINE __m256 func(__m256 x, __m256 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m256 lin, log, mask;
+
+		x = _mm256_mul_ps(x, scale);
+		x = _mm256_max_ps(x, _mm256_setzero_ps());
+
+		if (InverseOotf)
+			x = mm256_pow_ps(x, 1.0f / 1.2f);
+
+		mask = _mm256_cmp_ps(x, _mm256_set1_ps(1.0f / 12.0f), _CMP_LE_OQ);
+
+		// f(x) = sqrt(3 * x)
+		lin = _mm256_sqrt_ps(_mm256_mul_ps(x, _mm256_set1_ps(3.0f)));
+
+		// f(x) = a * ln(12 * x - b) + c
+		log = _mm256_fmadd_ps(x, _mm256_set1_ps(12.0f), _mm256_set1_ps(-T::b));
+		log = _mm256_fmadd_ps(mm256_log2_ps(log), _mm256_set1_ps(T::log_scale), _mm256_set1_ps(T::c));
+
+		return _mm256_blendv_ps(log, lin, mask);
+	}
+};
+
+template <bool Ootf>
+struct AribB67InverseOETF {
+	static inline FORCE_INLINE __m256 func(__m256 x, __m256 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m256 sq, exp, mask;
+
+		x = _mm256_max_ps(x, _mm256_setzero_ps());
+		mask = _mm256_cmp_ps(x, _mm256_set1_ps(0.5f), _CMP_LE_OQ);
+
+		// f(x) = x^2 / 3
+		sq = _mm256_mul_ps(_mm256_mul_ps(x, x), _mm256_set1_ps(1.0f / 3.0f));
+
+		// f(x) = (exp((x - c) / a) + b) / 12
+		exp = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(T::c)), _mm256_set1_ps(T::exp_scale));
+		exp = _mm256_mul_ps(_mm256_add_ps(mm256_exp2_ps(exp), _mm256_set1_ps(T::b)), _mm256_set1_ps(1.0f / 12.0f));
+
+		x = _mm256_blendv_ps(exp, sq, mask);
+
+		if (Ootf)
+			x = mm256_pow_ps(x, 1.2f);
+
+		return _mm256_mul_ps(x, scale);
+	}
+};
+
+struct Rec709OETF {
+	static inline FORCE_INLINE __m256 func(__m256 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m256 lin, pow, mask;
+
+		x = _mm256_max_ps(x, _mm256_setzero_ps());
+		mask = _mm256_cmp_ps(x, _mm256_set1_ps(T::beta), _CMP_LT_OQ);
+
+		// f(x) = 4.5 * x
+		lin = _mm256_mul_ps(x, _mm256_set1_ps(4.5f));
+
+		// f(x) = alpha * x^0.45 - (alpha - 1)
+		pow = _mm256_fmadd_ps(mm256_pow_ps(x, 0.45f), _mm256_set1_ps(T::alpha), _mm256_set1_ps(1.0f - T::alpha));
+
+		return _mm256_blendv_ps(pow, lin, mask);
+	}
+};
+
+struct Rec709InverseOETF {
+	static inline FORCE_INLINE __m256 func(__m256 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m256 lin, pow, mask;
+
+		x = _mm256_max_ps(x, _mm256_setzero_ps());
+		mask = _mm256_cmp_ps(x, _mm256_set1_ps(4.5f * T::beta), _CMP_LT_OQ);
+
+		// f(x) = x / 4.5
+		lin = _mm256_mul_ps(x, _mm256_set1_ps(1.0f / 4.5f));
+
+		// f(x) = ((x + (alpha - 1)) / alpha)^(1 / 0.45)
+		pow = _mm256_fmadd_ps(x, _mm256_set1_ps(1.0f / T::alpha), _mm256_set1_ps((T::alpha - 1.0f) / T::alpha));
+		pow = mm256_pow_ps(pow, 1.0f / 0.45f);
+
+		return _mm256_blendv_ps(pow, lin, mask);
+	}
+};
+
+typedef PowerFunction<x86constants::Rec1886EOTF, false> FuncRec1886EOTF;
+typedef SRGBPowerFunction<x86constants::SRGBEOTF, true, false> FuncSRGBEOTF;
+typedef AribB67OETF<false> FuncAribB67OETF;
+typedef AribB67InverseOETF<false> FuncAribB67InverseOETF;
+
+template <class Op>
+void gamma_filter_line_avx2(const float *src, float *dst, float scale, unsigned left, unsigned right)
+{
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	if (left != vec_left) {
+		__m256 x = Op::func(_mm256_load_ps(src + vec_left - 8), _mm256_set1_ps(scale));
+		mm256_store_idxhi_ps(dst + vec_left - 8, x, left % 8);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		__m256 x = Op::func(_mm256_load_ps(src + j), _mm256_set1_ps(scale));
+		_mm256_store_ps(dst + j, x);
+	}
+
+	if (right != vec_right) {
+		__m256 x = Op::func(_mm256_load_ps(src + vec_right), _mm256_set1_ps(scale));
+		mm256_store_idxlo_ps(dst + vec_right, x, right % 8);
+	}
+}
+
+// Operations on pixel triplets. The kernels are constructed on the stack, as
+// the operations themselves are not guaranteed to be suitably aligned.
+struct AribB67Kernel {
+	__m256 kr, kg, kb, scale;
+
+	AribB67Kernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm256_set1_ps(kr_) }, kg{ _mm256_set1_ps(kg_) }, kb{ _mm256_set1_ps(kb_) }, scale{ _mm256_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m256 &r, __m256 &g, __m256 &b) const
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		__m256 yd, ys_inv;
+
+		r = _mm256_mul_ps(r, scale);
+		g = _mm256_mul_ps(g, scale);
+		b = _mm256_mul_ps(b, scale);
+
+		yd = _mm256_fmadd_ps(kb, b, _mm256_fmadd_ps(kg, g, _mm256_mul_ps(kr, r)));
+		yd = _mm256_max_ps(yd, _mm256_set1_ps(FLT_MIN));
+		ys_inv = mm256_pow_ps(yd, (1.0f - 1.2f) / 1.2f);
+
+		r = FuncAribB67OETF::func(_mm256_mul_ps(r, ys_inv), one);
+		g = FuncAribB67OETF::func(_mm256_mul_ps(g, ys_inv), one);
+		b = FuncAribB67OETF::func(_mm256_mul_ps(b, ys_inv), one);
+	}
+};
+
+struct AribB67InverseKernel {
+	__m256 kr, kg, kb, scale;
+
+	AribB67InverseKernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm256_set1_ps(kr_) }, kg{ _mm256_set1_ps(kg_) }, kb{ _mm256_set1_ps(kb_) }, scale{ _mm256_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m256 &r, __m256 &g, __m256 &b) const
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		__m256 ys;
+
+		r = FuncAribB67InverseOETF::func(r, one);
+		g = FuncAribB67InverseOETF::func(g, one);
+		b = FuncAribB67InverseOETF::func(b, one);
+
+		ys = _mm256_fmadd_ps(kb, b, _mm256_fmadd_ps(kg, g, _mm256_mul_ps(kr, r)));
+		ys = _mm256_max_ps(ys, _mm256_set1_ps(FLT_MIN));
+		ys = _mm256_mul_ps(mm256_pow_ps(ys, 1.2f - 1.0f), scale);
+
+		r = _mm256_mul_ps(r, ys);
+		g = _mm256_mul_ps(g, ys);
+		b = _mm256_mul_ps(b, ys);
+	}
+};
+
+struct CLToRGBKernel {
+	__m256 kr, kb, kg_inv;
+	__m256 nb2, pb2, nr2, pr2;
+	__m256 scale;
+
+	CLToRGBKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm256_set1_ps(kr_) }, kb{ _mm256_set1_ps(kb_) }, kg_inv{ _mm256_set1_ps(1.0f / kg_) },
+		nb2{ _mm256_set1_ps(2.0f * nb) }, pb2{ _mm256_set1_ps(2.0f * pb) }, nr2{ _mm256_set1_ps(2.0f * nr) }, pr2{ _mm256_set1_ps(2.0f * pr) },
+		scale{ _mm256_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m256 &y, __m256 &u, __m256 &v) const
+	{
+		__m256 r, g, b;
+		__m256 b_minus_y, r_minus_y;
+
+		b_minus_y = _mm256_mul_ps(u, _mm256_blendv_ps(pb2, nb2, _mm256_cmp_ps(u, _mm256_setzero_ps(), _CMP_LT_OQ)));
+		r_minus_y = _mm256_mul_ps(v, _mm256_blendv_ps(pr2, nr2, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_LT_OQ)));
+
+		b = Rec709InverseOETF::func(_mm256_add_ps(b_minus_y, y));
+		r = Rec709InverseOETF::func(_mm256_add_ps(r_minus_y, y));
+
+		y = Rec709InverseOETF::func(y);
+		g = _mm256_mul_ps(_mm256_fnmadd_ps(kb, b, _mm256_fnmadd_ps(kr, r, y)), kg_inv);
+
+		y = _mm256_mul_ps(r, scale);
+		u = _mm256_mul_ps(g, scale);
+		v = _mm256_mul_ps(b, scale);
+	}
+};
+
+struct CLToYUVKernel {
+	__m256 kr, kg, kb;
+	__m256 nb2_inv, pb2_inv, nr2_inv, pr2_inv;
+	__m256 scale;
+
+	CLToYUVKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm256_set1_ps(kr_) }, kg{ _mm256_set1_ps(kg_) }, kb{ _mm256_set1_ps(kb_) },
+		nb2_inv{ _mm256_set1_ps(1.0f / (2.0f * nb)) }, pb2_inv{ _mm256_set1_ps(1.0f / (2.0f * pb)) },
+		nr2_inv{ _mm256_set1_ps(1.0f / (2.0f * nr)) }, pr2_inv{ _mm256_set1_ps(1.0f / (2.0f * pr)) },
+		scale{ _mm256_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m256 &r, __m256 &g, __m256 &b) const
+	{
+		__m256 y, u, v;
+
+		r = _mm256_mul_ps(r, scale);
+		g = _mm256_mul_ps(g, scale);
+		b = _mm256_mul_ps(b, scale);
+
+		y = Rec709OETF::func(_mm256_fmadd_ps(kb, b, _mm256_fmadd_ps(kg, g, _mm256_mul_ps(kr, r))));
+		b = _mm256_sub_ps(Rec709OETF::func(b), y);
+		r = _mm256_sub_ps(Rec709OETF::func(r), y);
+
+		u = _mm256_mul_ps(b, _mm256_blendv_ps(pb2_inv, nb2_inv, _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_LT_OQ)));
+		v = _mm256_mul_ps(r, _mm256_blendv_ps(pr2_inv, nr2_inv, _mm256_cmp_ps(r, _mm256_setzero_ps(), _CMP_LT_OQ)));
+
+		r = y;
+		g = u;
+		b = v;
+	}
+};
+
+template <class Kernel>
+void triplet_filter_line_avx2(const Kernel &kernel, const float * const * RESTRICT src, float * const * RESTRICT dst, unsigned left, unsigned right)
+{
+	const float *src0 = src[0];
+	const float *src1 = src[1];
+	const float *src2 = src[2];
+	float *dst0 = dst[0];
+	float *dst1 = dst[1];
+	float *dst2 = dst[2];
+
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	if (left != vec_left) {
+		__m256 a = _mm256_load_ps(src0 + vec_left - 8);
+		__m256 b = _mm256_load_ps(src1 + vec_left - 8);
+		__m256 c = _mm256_load_ps(src2 + vec_left - 8);
+		kernel.xiter(a, b, c);
+
+		mm256_store_idxhi_ps(dst0 + vec_left - 8, a, left % 8);
+		mm256_store_idxhi_ps(dst1 + vec_left - 8, b, left % 8);
+		mm256_store_idxhi_ps(dst2 + vec_left - 8, c, left % 8);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		__m256 a = _mm256_load_ps(src0 + j);
+		__m256 b = _mm256_load_ps(src1 + j);
+		__m256 c = _mm256_load_ps(src2 + j);
+		kernel.xiter(a, b, c);
+
+		_mm256_store_ps(dst0 + j, a);
+		_mm256_store_ps(dst1 + j, b);
+		_mm256_store_ps(dst2 + j, c);
+	}
+
+	if (right != vec_right) {
+		__m256 a = _mm256_load_ps(src0 + vec_right);
+		__m256 b = _mm256_load_ps(src1 + vec_right);
+		__m256 c = _mm256_load_ps(src2 + vec_right);
+		kernel.xiter(a, b, c);
+
+		mm256_store_idxlo_ps(dst0 + vec_right, a, right % 8);
+		mm256_store_idxlo_ps(dst1 + vec_right, b, right % 8);
+		mm256_store_idxlo_ps(dst2 + vec_right, c, right % 8);
+	}
+}
+
 
 class ToLinearLutOperationAVX2 final : public Operation {
 	std::vector<float> m_lut;
@@ -128,6 +613,90 @@ public:
 	}
 };
 
+template <class Op>
+class GammaOperationAVX2 final : public Operation {
+	float m_scale;
+public:
+	explicit GammaOperationAVX2(float scale) : m_scale{ scale } {}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		gamma_filter_line_avx2<Op>(src[0], dst[0], m_scale, left, right);
+		gamma_filter_line_avx2<Op>(src[1], dst[1], m_scale, left, right);
+		gamma_filter_line_avx2<Op>(src[2], dst[2], m_scale, left, right);
+	}
+};
+
+class AribB67OperationAVX2 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67OperationAVX2(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_avx2(AribB67Kernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class AribB67InverseOperationAVX2 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67InverseOperationAVX2(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_avx2(AribB67InverseKernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToRGBOperationAVX2 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToRGBOperationAVX2(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_avx2(CLToRGBKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToYUVOperationAVX2 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToYUVOperationAVX2(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_avx2(CLToYUVKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
 } // namespace
 
 
@@ -144,9 +713,41 @@ std::unique_ptr<Operation> create_inverse_gamma_operation_avx2(const TransferFun
 	if (!params.approximate_gamma)
 		return nullptr;
 
+	// The LUT is faster for all other functions, even when warm.
+	if (transfer.to_linear == rec_1886_eotf)
+		return std::make_unique<GammaOperationAVX2<FuncRec1886EOTF>>(transfer.to_linear_scale);
+	else if (transfer.to_linear == srgb_eotf)
+		return std::make_unique<GammaOperationAVX2<FuncSRGBEOTF>>(transfer.to_linear_scale);
+
 	return std::make_unique<ToLinearLutOperationAVX2>(transfer.to_linear, LUT_DEPTH, transfer.to_linear_scale);
 }
 
+std::unique_ptr<Operation> create_arib_b67_operation_avx2(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67OperationAVX2>(m[0][0], m[0][1], m[0][2], transfer.to_gamma_scale);
+}
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_avx2(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67InverseOperationAVX2>(m[0][0], m[0][1], m[0][2], transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_avx2(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_linear != rec_709_inverse_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToRGBOperationAVX2>(constants, transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_avx2(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_gamma != rec_709_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToYUVOperationAVX2>(constants, transfer.to_gamma_scale);
+}
+
 } // namespace colorspace
 } // namespace zimg
 
@@ -5,8 +5,9 @@
 #include "common/align.h"
 #include "common/ccdep.h"
 #include "colorspace/gamma.h"
+#include "colorspace/matrix3.h"
 #include "colorspace/operation_impl.h"
-#include "gamma_constants_avx512.h"
+#include "gamma_constants_x86.h"
 #include "operation_impl_x86.h"
 
 #include "common/x86/avx512_util.h"
@@ -16,6 +17,10 @@ namespace colorspace {
 
 namespace {
 
+// Unmasked AVX-512 intrinsics pass an undefined vector as their pass-through
+// operand, which GCC 12 reports as maybe-uninitialized. Use the zero-masked
+// forms with a full mask instead.
+
 inline FORCE_INLINE void matrix_filter_line_avx512_xiter(unsigned j, const float *src0, const float *src1, const float *src2,
                                                          const __m512 &c00, const __m512 &c01, const __m512 &c02,
                                                          const __m512 &c10, const __m512 &c11, const __m512 &c12,
@@ -52,15 +57,15 @@ void matrix_filter_line_avx512(const float *matrix, const float * const * RESTRI
 	float *dst1 = dst[1];
 	float *dst2 = dst[2];
 
-	const __m512 c00 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 0));
-	const __m512 c01 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 1));
-	const __m512 c02 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 2));
-	const __m512 c10 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 3));
-	const __m512 c11 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 4));
-	const __m512 c12 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 5));
-	const __m512 c20 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 6));
-	const __m512 c21 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 7));
-	const __m512 c22 = _mm512_broadcastss_ps(_mm_load_ss(matrix + 8));
+	const __m512 c00 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 0));
+	const __m512 c01 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 1));
+	const __m512 c02 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 2));
+	const __m512 c10 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 3));
+	const __m512 c11 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 4));
+	const __m512 c12 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 5));
+	const __m512 c20 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 6));
+	const __m512 c21 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 7));
+	const __m512 c22 = _mm512_maskz_broadcastss_ps(0xFFFF, _mm_load_ss(matrix + 8));
 	__m512 out0, out1, out2;
 
 	unsigned vec_left = ceil_n(left, 16);
@@ -98,6 +103,60 @@ void matrix_filter_line_avx512(const float *matrix, const float * const * RESTRI
 }
 
 
+// Valid for positive normal numbers.
+inline FORCE_INLINE __m512 mm512_log2_ps(__m512 x)
+{
+	typedef x86constants::Log2 T;
+
+	__m512 mant, exp, result;
+
+	mant = _mm512_sub_ps(_mm512_maskz_getmant_ps(0xFFFF, x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero), _mm512_set1_ps(1.0f));
+	exp = _mm512_maskz_getexp_ps(0xFFFF, x);
+
+	result = _mm512_set1_ps(T::horner[0]);
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[1]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[2]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[3]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[4]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[5]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[6]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[7]));
+	result = _mm512_fmadd_ps(result, mant, _mm512_set1_ps(T::horner[8]));
+
+	return _mm512_add_ps(result, exp);
+}
+
+inline FORCE_INLINE __m512 mm512_exp2_ps(__m512 x)
+{
+	typedef x86constants::Exp2 T;
+
+	__m512 ipart, fpart, result;
+
+	x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_set1_ps(-126.0f));
+	x = _mm512_maskz_min_ps(0xFFFF, x, _mm512_set1_ps(127.0f));
+	ipart = _mm512_maskz_roundscale_ps(0xFFFF, x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+	fpart = _mm512_sub_ps(x, ipart);
+
+	result = _mm512_set1_ps(T::horner[0]);
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[1]));
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[2]));
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[3]));
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[4]));
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[5]));
+	result = _mm512_fmadd_ps(result, fpart, _mm512_set1_ps(T::horner[6]));
+
+	// Scale by 2^ipart.
+	return _mm512_maskz_scalef_ps(0xFFFF, result, ipart);
+}
+
+// x ^ p for positive x, 0 otherwise.
+inline FORCE_INLINE __m512 mm512_pow_ps(__m512 x, float p)
+{
+	__m512 result = mm512_exp2_ps(_mm512_mul_ps(mm512_log2_ps(x), _mm512_set1_ps(p)));
+	return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ), result);
+}
+
+
 template <class T, bool Prescale>
 struct PowerFunction {
 	static inline FORCE_INLINE __m512 func(__m512 x, __m512 scale)
@@ -118,9 +177,9 @@ struct PowerFunction {
 		x = _mm512_range_ps(x, two_minus_eps, 0x08); // fabs(min(x, 2.0))
 
 		// Decompose into mantissa and exponent.
-		mant = _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_nan);
-		exp = _mm512_srli_epi32(_mm512_castps_si512(x), 23);
-		exp = _mm512_max_epi32(exp, exponent_min);
+		mant = _mm512_maskz_getmant_ps(0xFFFF, x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_nan);
+		exp = _mm512_maskz_srli_epi32(0xFFFF, _mm512_castps_si512(x), 23);
+		exp = _mm512_maskz_max_epi32(0xFFFF, exp, exponent_min);
 
 		// Apply polynomial approximation to mantissa.
 		mantpart = _mm512_set1_ps(T::horner[0]);
@@ -134,7 +193,7 @@ struct PowerFunction {
 		if (ExtendedExponent)
 			exppart = _mm512_permutex2var_ps(_mm512_load_ps(T::table), exp, _mm512_load_ps(T::table + 16));
 		else
-			exppart = _mm512_permutexvar_ps(exp, _mm512_load_ps(T::table));
+			exppart = _mm512_maskz_permutexvar_ps(0xFFFF, exp, _mm512_load_ps(T::table));
 
 		// f(m * 2^e) == f(m) * f(2^e)
 		x = _mm512_mul_ps(mantpart, exppart);
@@ -175,8 +234,8 @@ struct SRGBPowerFunction {
 			x = _mm512_fmadd_ps(x, _mm512_set1_ps(T::power_scale), _mm512_set1_ps(T::power_offset));
 
 		// Decompose into mantissa and exponent.
-		mant = _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_nan);
-		exp = _mm512_srli_epi32(_mm512_castps_si512(x), 23); // Exponent range limit not needed because of mask.
+		mant = _mm512_maskz_getmant_ps(0xFFFF, x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_nan);
+		exp = _mm512_maskz_srli_epi32(0xFFFF, _mm512_castps_si512(x), 23); // Exponent range limit not needed because of mask.
 
 		// Apply polynomial approximation to mantissa.
 		mantpart = _mm512_set1_ps(T::horner[0]);
@@ -187,7 +246,7 @@ struct SRGBPowerFunction {
 		mantpart = _mm512_fmadd_ps(mantpart, mant, _mm512_set1_ps(T::horner[5]));
 
 		// Read f(2^e) from a 16-element LUT.
-		exppart = _mm512_permutexvar_ps(exp, _mm512_load_ps(ExtendedExponent ? T::table + 16 : T::table));
+		exppart = _mm512_maskz_permutexvar_ps(0xFFFF, exp, _mm512_load_ps(ExtendedExponent ? T::table + 16 : T::table));
 
 		// f(m * 2^e) == f(m) * f(2^e)
 		x = _mm512_mul_ps(mantpart, exppart);
@@ -218,23 +277,23 @@ struct SegmentedPolynomial {
 		if (Prescale)
 			x = _mm512_mul_ps(x, scale);
 
-		x = _mm512_max_ps(x, _mm512_set1_ps(FLT_MIN));
+		x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_set1_ps(FLT_MIN));
 
 		if (Log) {
 			// Classify the argument into one of 32 segments by its exponent.
 			const __m512i exponent_min = _mm512_set1_epi32(127 - 32);
 			const __m512i exponent_max = _mm512_set1_epi32(127 - 1);
-			idx = _mm512_srli_epi32(_mm512_castps_si512(x), 23);
-			idx = _mm512_max_epi32(idx, exponent_min);
-			idx = _mm512_min_epi32(idx, exponent_max);
+			idx = _mm512_maskz_srli_epi32(0xFFFF, _mm512_castps_si512(x), 23);
+			idx = _mm512_maskz_max_epi32(0xFFFF, idx, exponent_min);
+			idx = _mm512_maskz_min_epi32(0xFFFF, idx, exponent_max);
 		} else {
 			// Classify the argument into one of 32 uniform segments on [0, 1].
 			const __m512 one_minus_eps = _mm512_set1_ps(0.999999940f);
 			__m512 tmp = x;
-			tmp = _mm512_max_ps(tmp, _mm512_setzero_ps());
-			tmp = _mm512_min_ps(tmp, one_minus_eps);
+			tmp = _mm512_maskz_max_ps(0xFFFF, tmp, _mm512_setzero_ps());
+			tmp = _mm512_maskz_min_ps(0xFFFF, tmp, one_minus_eps);
 			tmp = _mm512_mul_ps(tmp, _mm512_set1_ps(32.0f));
-			idx = _mm512_cvttps_epi32(tmp);
+			idx = _mm512_maskz_cvttps_epi32(0xFFFF, tmp);
 		}
 
 		// Apply the polynomial approximation for the segment.
@@ -245,7 +304,7 @@ struct SegmentedPolynomial {
 		result = _mm512_fmadd_ps(result, x, _mm512_permutex2var_ps(_mm512_load_ps(T::horner4), idx, _mm512_load_ps(T::horner4 + 16)));
 
 		if (!Log)
-			result = _mm512_max_ps(result, _mm512_setzero_ps());
+			result = _mm512_maskz_max_ps(0xFFFF, result, _mm512_setzero_ps());
 
 		if (!Prescale)
 			result = _mm512_mul_ps(result, scale);
@@ -254,12 +313,115 @@ struct SegmentedPolynomial {
 	}
 };
 
-typedef PowerFunction<avx512constants::Rec1886EOTF, false> FuncRec1886EOTF;
-typedef PowerFunction<avx512constants::Rec1886InverseEOTF, true> FuncRec1886InverseEOTF;
-typedef SRGBPowerFunction<avx512constants::SRGBEOTF, true, false> FuncSRGBEOTF;
-typedef SRGBPowerFunction<avx512constants::SRGBInverseEOTF, false, true> FuncSRGBInverseEOTF;
-typedef SegmentedPolynomial<avx512constants::ST2084EOTF, false, false> FuncST2084EOTF;
-typedef SegmentedPolynomial<avx512constants::ST2084InverseEOTF, true, true> FuncST2084InverseEOTF;
+template <bool InverseOotf>
+struct AribB67OETF {
+	static inline FORCE_INLINE __m512 func(__m512 x, __m512 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m512 lin, log;
+		__mmask16 mask;
+
+		x = _mm512_mul_ps(x, scale);
+		x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_setzero_ps());
+
+		if (InverseOotf)
+			x = mm512_pow_ps(x, 1.0f / 1.2f);
+
+		mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(1.0f / 12.0f), _CMP_LE_OQ);
+
+		// f(x) = sqrt(3 * x)
+		lin = _mm512_maskz_sqrt_ps(0xFFFF, _mm512_mul_ps(x, _mm512_set1_ps(3.0f)));
+
+		// f(x) = a * ln(12 * x - b) + c
+		log = _mm512_fmadd_ps(x, _mm512_set1_ps(12.0f), _mm512_set1_ps(-T::b));
+		log = _mm512_fmadd_ps(mm512_log2_ps(log), _mm512_set1_ps(T::log_scale), _mm512_set1_ps(T::c));
+
+		return _mm512_mask_blend_ps(mask, log, lin);
+	}
+};
+
+template <bool Ootf>
+struct AribB67InverseOETF {
+	static inline FORCE_INLINE __m512 func(__m512 x, __m512 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m512 sq, exp;
+		__mmask16 mask;
+
+		x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_setzero_ps());
+		mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(0.5f), _CMP_LE_OQ);
+
+		// f(x) = x^2 / 3
+		sq = _mm512_mul_ps(_mm512_mul_ps(x, x), _mm512_set1_ps(1.0f / 3.0f));
+
+		// f(x) = (exp((x - c) / a) + b) / 12
+		exp = _mm512_mul_ps(_mm512_sub_ps(x, _mm512_set1_ps(T::c)), _mm512_set1_ps(T::exp_scale));
+		exp = _mm512_mul_ps(_mm512_add_ps(mm512_exp2_ps(exp), _mm512_set1_ps(T::b)), _mm512_set1_ps(1.0f / 12.0f));
+
+		x = _mm512_mask_blend_ps(mask, exp, sq);
+
+		if (Ootf)
+			x = mm512_pow_ps(x, 1.2f);
+
+		return _mm512_mul_ps(x, scale);
+	}
+};
+
+struct Rec709OETF {
+	static inline FORCE_INLINE __m512 func(__m512 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m512 lin, pow;
+		__mmask16 mask;
+
+		x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_setzero_ps());
+		mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(T::beta), _CMP_LT_OQ);
+
+		// f(x) = 4.5 * x
+		lin = _mm512_mul_ps(x, _mm512_set1_ps(4.5f));
+
+		// f(x) = alpha * x^0.45 - (alpha - 1)
+		pow = _mm512_fmadd_ps(mm512_pow_ps(x, 0.45f), _mm512_set1_ps(T::alpha), _mm512_set1_ps(1.0f - T::alpha));
+
+		return _mm512_mask_blend_ps(mask, pow, lin);
+	}
+};
+
+struct Rec709InverseOETF {
+	static inline FORCE_INLINE __m512 func(__m512 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m512 lin, pow;
+		__mmask16 mask;
+
+		x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_setzero_ps());
+		mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(4.5f * T::beta), _CMP_LT_OQ);
+
+		// f(x) = x / 4.5
+		lin = _mm512_mul_ps(x, _mm512_set1_ps(1.0f / 4.5f));
+
+		// f(x) = ((x + (alpha - 1)) / alpha)^(1 / 0.45)
+		pow = _mm512_fmadd_ps(x, _mm512_set1_ps(1.0f / T::alpha), _mm512_set1_ps((T::alpha - 1.0f) / T::alpha));
+		pow = mm512_pow_ps(pow, 1.0f / 0.45f);
+
+		return _mm512_mask_blend_ps(mask, pow, lin);
+	}
+};
+
+typedef PowerFunction<x86constants::Rec1886EOTF, false> FuncRec1886EOTF;
+typedef PowerFunction<x86constants::Rec1886InverseEOTF, true> FuncRec1886InverseEOTF;
+typedef SRGBPowerFunction<x86constants::SRGBEOTF, true, false> FuncSRGBEOTF;
+typedef SRGBPowerFunction<x86constants::SRGBInverseEOTF, false, true> FuncSRGBInverseEOTF;
+typedef SegmentedPolynomial<x86constants::ST2084EOTF, false, false> FuncST2084EOTF;
+typedef SegmentedPolynomial<x86constants::ST2084InverseEOTF, true, true> FuncST2084InverseEOTF;
+typedef AribB67OETF<false> FuncAribB67OETF;
+typedef AribB67OETF<true> FuncAribB67InverseEOTF;
+typedef AribB67InverseOETF<false> FuncAribB67InverseOETF;
+typedef AribB67InverseOETF<true> FuncAribB67EOTF;
 
 template <class Op>
 void gamma_filter_line_avx512(const float *src, float *dst, float scale, unsigned left, unsigned right)
@@ -284,7 +446,172 @@ void gamma_filter_line_avx512(const float *src, float *dst, float scale, unsigne
 		_mm512_mask_store_ps(dst + vec_right, mask, x);
 	}
 }
+// Operations on pixel triplets. The kernels are constructed on the stack, as
+// the operations themselves are not guaranteed to be suitably aligned.
+struct AribB67Kernel {
+	__m512 kr, kg, kb, scale;
+
+	AribB67Kernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm512_set1_ps(kr_) }, kg{ _mm512_set1_ps(kg_) }, kb{ _mm512_set1_ps(kb_) }, scale{ _mm512_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m512 &r, __m512 &g, __m512 &b) const
+	{
+		const __m512 one = _mm512_set1_ps(1.0f);
+		__m512 yd, ys_inv;
+
+		r = _mm512_mul_ps(r, scale);
+		g = _mm512_mul_ps(g, scale);
+		b = _mm512_mul_ps(b, scale);
+
+		yd = _mm512_fmadd_ps(kb, b, _mm512_fmadd_ps(kg, g, _mm512_mul_ps(kr, r)));
+		yd = _mm512_maskz_max_ps(0xFFFF, yd, _mm512_set1_ps(FLT_MIN));
+		ys_inv = mm512_pow_ps(yd, (1.0f - 1.2f) / 1.2f);
+
+		r = FuncAribB67OETF::func(_mm512_mul_ps(r, ys_inv), one);
+		g = FuncAribB67OETF::func(_mm512_mul_ps(g, ys_inv), one);
+		b = FuncAribB67OETF::func(_mm512_mul_ps(b, ys_inv), one);
+	}
+};
+
+struct AribB67InverseKernel {
+	__m512 kr, kg, kb, scale;
+
+	AribB67InverseKernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm512_set1_ps(kr_) }, kg{ _mm512_set1_ps(kg_) }, kb{ _mm512_set1_ps(kb_) }, scale{ _mm512_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m512 &r, __m512 &g, __m512 &b) const
+	{
+		const __m512 one = _mm512_set1_ps(1.0f);
+		__m512 ys;
+
+		r = FuncAribB67InverseOETF::func(r, one);
+		g = FuncAribB67InverseOETF::func(g, one);
+		b = FuncAribB67InverseOETF::func(b, one);
+
+		ys = _mm512_fmadd_ps(kb, b, _mm512_fmadd_ps(kg, g, _mm512_mul_ps(kr, r)));
+		ys = _mm512_maskz_max_ps(0xFFFF, ys, _mm512_set1_ps(FLT_MIN));
+		ys = _mm512_mul_ps(mm512_pow_ps(ys, 1.2f - 1.0f), scale);
+
+		r = _mm512_mul_ps(r, ys);
+		g = _mm512_mul_ps(g, ys);
+		b = _mm512_mul_ps(b, ys);
+	}
+};
+
+struct CLToRGBKernel {
+	__m512 kr, kb, kg_inv;
+	__m512 nb2, pb2, nr2, pr2;
+	__m512 scale;
+
+	CLToRGBKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm512_set1_ps(kr_) }, kb{ _mm512_set1_ps(kb_) }, kg_inv{ _mm512_set1_ps(1.0f / kg_) },
+		nb2{ _mm512_set1_ps(2.0f * nb) }, pb2{ _mm512_set1_ps(2.0f * pb) }, nr2{ _mm512_set1_ps(2.0f * nr) }, pr2{ _mm512_set1_ps(2.0f * pr) },
+		scale{ _mm512_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m512 &y, __m512 &u, __m512 &v) const
+	{
+		__m512 r, g, b;
+		__m512 b_minus_y, r_minus_y;
+
+		b_minus_y = _mm512_mul_ps(u, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(u, _mm512_setzero_ps(), _CMP_LT_OQ), pb2, nb2));
+		r_minus_y = _mm512_mul_ps(v, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_LT_OQ), pr2, nr2));
 
+		b = Rec709InverseOETF::func(_mm512_add_ps(b_minus_y, y));
+		r = Rec709InverseOETF::func(_mm512_add_ps(r_minus_y, y));
+
+		y = Rec709InverseOETF::func(y);
+		g = _mm512_mul_ps(_mm512_fnmadd_ps(kb, b, _mm512_fnmadd_ps(kr, r, y)), kg_inv);
+
+		y = _mm512_mul_ps(r, scale);
+		u = _mm512_mul_ps(g, scale);
+		v = _mm512_mul_ps(b, scale);
+	}
+};
+
+struct CLToYUVKernel {
+	__m512 kr, kg, kb;
+	__m512 nb2_inv, pb2_inv, nr2_inv, pr2_inv;
+	__m512 scale;
+
+	CLToYUVKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm512_set1_ps(kr_) }, kg{ _mm512_set1_ps(kg_) }, kb{ _mm512_set1_ps(kb_) },
+		nb2_inv{ _mm512_set1_ps(1.0f / (2.0f * nb)) }, pb2_inv{ _mm512_set1_ps(1.0f / (2.0f * pb)) },
+		nr2_inv{ _mm512_set1_ps(1.0f / (2.0f * nr)) }, pr2_inv{ _mm512_set1_ps(1.0f / (2.0f * pr)) },
+		scale{ _mm512_set1_ps(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m512 &r, __m512 &g, __m512 &b) const
+	{
+		__m512 y, u, v;
+
+		r = _mm512_mul_ps(r, scale);
+		g = _mm512_mul_ps(g, scale);
+		b = _mm512_mul_ps(b, scale);
+
+		y = Rec709OETF::func(_mm512_fmadd_ps(kb, b, _mm512_fmadd_ps(kg, g, _mm512_mul_ps(kr, r))));
+		b = _mm512_sub_ps(Rec709OETF::func(b), y);
+		r = _mm512_sub_ps(Rec709OETF::func(r), y);
+
+		u = _mm512_mul_ps(b, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b, _mm512_setzero_ps(), _CMP_LT_OQ), pb2_inv, nb2_inv));
+		v = _mm512_mul_ps(r, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(r, _mm512_setzero_ps(), _CMP_LT_OQ), pr2_inv, nr2_inv));
+
+		r = y;
+		g = u;
+		b = v;
+	}
+};
+
+template <class Kernel>
+void triplet_filter_line_avx512(const Kernel &kernel, const float * const * RESTRICT src, float * const * RESTRICT dst, unsigned left, unsigned right)
+{
+	const float *src0 = src[0];
+	const float *src1 = src[1];
+	const float *src2 = src[2];
+	float *dst0 = dst[0];
+	float *dst1 = dst[1];
+	float *dst2 = dst[2];
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	if (left != vec_left) {
+		__m512 a = _mm512_load_ps(src0 + vec_left - 16);
+		__m512 b = _mm512_load_ps(src1 + vec_left - 16);
+		__m512 c = _mm512_load_ps(src2 + vec_left - 16);
+		kernel.xiter(a, b, c);
+
+		__mmask16 mask = mmask16_set_hi(vec_left - left);
+		_mm512_mask_store_ps(dst0 + vec_left - 16, mask, a);
+		_mm512_mask_store_ps(dst1 + vec_left - 16, mask, b);
+		_mm512_mask_store_ps(dst2 + vec_left - 16, mask, c);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m512 a = _mm512_load_ps(src0 + j);
+		__m512 b = _mm512_load_ps(src1 + j);
+		__m512 c = _mm512_load_ps(src2 + j);
+		kernel.xiter(a, b, c);
+
+		_mm512_store_ps(dst0 + j, a);
+		_mm512_store_ps(dst1 + j, b);
+		_mm512_store_ps(dst2 + j, c);
+	}
+
+	if (right != vec_right) {
+		__m512 a = _mm512_load_ps(src0 + vec_right);
+		__m512 b = _mm512_load_ps(src1 + vec_right);
+		__m512 c = _mm512_load_ps(src2 + vec_right);
+		kernel.xiter(a, b, c);
+
+		__mmask16 mask = mmask16_set_lo(right - vec_right);
+		_mm512_mask_store_ps(dst0 + vec_right, mask, a);
+		_mm512_mask_store_ps(dst1 + vec_right, mask, b);
+		_mm512_mask_store_ps(dst2 + vec_right, mask, c);
+	}
+}
 
 class MatrixOperationAVX512 final : public MatrixOperationImpl {
 public:
@@ -313,6 +640,76 @@ public:
 	}
 };
 
+class AribB67OperationAVX512 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67OperationAVX512(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_avx512(AribB67Kernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class AribB67InverseOperationAVX512 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67InverseOperationAVX512(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_avx512(AribB67InverseKernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToRGBOperationAVX512 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToRGBOperationAVX512(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_avx512(CLToRGBKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToYUVOperationAVX512 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToYUVOperationAVX512(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_avx512(CLToYUVKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
 } // namespace
 
 
@@ -332,6 +729,10 @@ std::unique_ptr<Operation> create_gamma_operation_avx512(const TransferFunction
 		return std::make_unique<GammaOperationAVX512<FuncSRGBInverseEOTF>>(transfer.to_gamma_scale);
 	else if (transfer.to_gamma == st_2084_inverse_eotf)
 		return std::make_unique<GammaOperationAVX512<FuncST2084InverseEOTF>>(transfer.to_gamma_scale);
+	else if (transfer.to_gamma == arib_b67_oetf)
+		return std::make_unique<GammaOperationAVX512<FuncAribB67OETF>>(transfer.to_gamma_scale);
+	else if (transfer.to_gamma == arib_b67_inverse_eotf)
+		return std::make_unique<GammaOperationAVX512<FuncAribB67InverseEOTF>>(transfer.to_gamma_scale);
 
 	return nullptr;
 }
@@ -347,10 +748,40 @@ std::unique_ptr<Operation> create_inverse_gamma_operation_avx512(const TransferF
 		return std::make_unique<GammaOperationAVX512<FuncSRGBEOTF>>(transfer.to_linear_scale);
 	else if (transfer.to_linear == st_2084_eotf)
 		return std::make_unique<GammaOperationAVX512<FuncST2084EOTF>>(transfer.to_linear_scale);
+	else if (transfer.to_linear == arib_b67_inverse_oetf)
+		return std::make_unique<GammaOperationAVX512<FuncAribB67InverseOETF>>(transfer.to_linear_scale);
+	else if (transfer.to_linear == arib_b67_eotf)
+		return std::make_unique<GammaOperationAVX512<FuncAribB67EOTF>>(transfer.to_linear_scale);
 
 	return nullptr;
 }
 
+std::unique_ptr<Operation> create_arib_b67_operation_avx512(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67OperationAVX512>(m[0][0], m[0][1], m[0][2], transfer.to_gamma_scale);
+}
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_avx512(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67InverseOperationAVX512>(m[0][0], m[0][1], m[0][2], transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_avx512(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_linear != rec_709_inverse_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToRGBOperationAVX512>(constants, transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_avx512(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_gamma != rec_709_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToYUVOperationAVX512>(constants, transfer.to_gamma_scale);
+}
+
 } // namespace colorspace
 } // namespace zimg
 
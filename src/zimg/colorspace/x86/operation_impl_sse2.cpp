@@ -1,6 +1,7 @@
 #ifdef ZIMG_X86
 
 #include <algorithm>
+#include <cfloat>
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
@@ -9,10 +10,13 @@
 #include "common/align.h"
 #include "common/ccdep.h"
 #include "colorspace/gamma.h"
+#include "colorspace/matrix3.h"
 #include "colorspace/operation.h"
 #include "colorspace/operation_impl.h"
+#include "gamma_constants_x86.h"
 #include "operation_impl_x86.h"
 
+#include "common/x86/sse_util.h"
 #include "common/x86/sse2_util.h"
 
 namespace zimg {
@@ -133,6 +137,338 @@ void to_gamma_lut_filter_line(const float *RESTRICT lut, const float *src, float
 	}
 }
 
+inline FORCE_INLINE __m128 mm_blendv_ps(__m128 a, __m128 b, __m128 mask)
+{
+	return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+}
+
+// Valid for positive normal numbers.
+inline FORCE_INLINE __m128 mm_log2_ps(__m128 x)
+{
+	typedef x86constants::Log2 T;
+
+	const __m128i mant_mask = _mm_set1_epi32(0x007FFFFF);
+	const __m128i one = _mm_set1_epi32(0x3F800000);
+
+	__m128 mant, exp, result;
+
+	mant = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(_mm_castps_si128(x), mant_mask), one));
+	mant = _mm_sub_ps(mant, _mm_set_ps1(1.0f));
+	exp = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(127)));
+
+	result = _mm_set_ps1(T::horner[0]);
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[1]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[2]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[3]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[4]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[5]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[6]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[7]));
+	result = _mm_add_ps(_mm_mul_ps(result, mant), _mm_set_ps1(T::horner[8]));
+
+	return _mm_add_ps(result, exp);
+}
+
+inline FORCE_INLINE __m128 mm_exp2_ps(__m128 x)
+{
+	typedef x86constants::Exp2 T;
+
+	__m128 ipart, fpart, result;
+	__m128i exp;
+
+	x = _mm_max_ps(x, _mm_set_ps1(-126.0f));
+	x = _mm_min_ps(x, _mm_set_ps1(127.0f));
+
+	// floor(x)
+	ipart = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	ipart = _mm_sub_ps(ipart, _mm_and_ps(_mm_cmpgt_ps(ipart, x), _mm_set_ps1(1.0f)));
+	fpart = _mm_sub_ps(x, ipart);
+
+	result = _mm_set_ps1(T::horner[0]);
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[1]));
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[2]));
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[3]));
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[4]));
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[5]));
+	result = _mm_add_ps(_mm_mul_ps(result, fpart), _mm_set_ps1(T::horner[6]));
+
+	// Scale by 2^ipart.
+	exp = _mm_add_epi32(_mm_cvttps_epi32(ipart), _mm_set1_epi32(127));
+	exp = _mm_slli_epi32(exp, 23);
+	return _mm_mul_ps(result, _mm_castsi128_ps(exp));
+}
+
+// x ^ p for positive x, 0 otherwise.
+inline FORCE_INLINE __m128 mm_pow_ps(__m128 x, float p)
+{
+	__m128 result = mm_exp2_ps(_mm_mul_ps(mm_log2_ps(x), _mm_set_ps1(p)));
+	return _mm_and_ps(result, _mm_cmpgt_ps(x, _mm_setzero_ps()));
+}
+
+
+template <bool InverseOotf>
+struct AribB67OETF {
+	static inline FORCE_INLINE __m128 func(__m128 x, __m128 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m128 lin, log, mask;
+
+		x = _mm_mul_ps(x, scale);
+		x = _mm_max_ps(x, _mm_setzero_ps());
+
+		if (InverseOotf)
+			x = mm_pow_ps(x, 1.0f / 1.2f);
+
+		mask = _mm_cmple_ps(x, _mm_set_ps1(1.0f / 12.0f));
+
+		// f(x) = sqrt(3 * x)
+		lin = _mm_sqrt_ps(_mm_mul_ps(x, _mm_set_ps1(3.0f)));
+
+		// f(x) = a * ln(12 * x - b) + c
+		log = _mm_sub_ps(_mm_mul_ps(x, _mm_set_ps1(12.0f)), _mm_set_ps1(T::b));
+		log = _mm_add_ps(_mm_mul_ps(mm_log2_ps(log), _mm_set_ps1(T::log_scale)), _mm_set_ps1(T::c));
+
+		return mm_blendv_ps(log, lin, mask);
+	}
+};
+
+template <bool Ootf>
+struct AribB67InverseOETF {
+	static inline FORCE_INLINE __m128 func(__m128 x, __m128 scale)
+	{
+		typedef x86constants::AribB67 T;
+
+		__m128 sq, exp, mask;
+
+		x = _mm_max_ps(x, _mm_setzero_ps());
+		mask = _mm_cmple_ps(x, _mm_set_ps1(0.5f));
+
+		// f(x) = x^2 / 3
+		sq = _mm_mul_ps(_mm_mul_ps(x, x), _mm_set_ps1(1.0f / 3.0f));
+
+		// f(x) = (exp((x - c) / a) + b) / 12
+		exp = _mm_mul_ps(_mm_sub_ps(x, _mm_set_ps1(T::c)), _mm_set_ps1(T::exp_scale));
+		exp = _mm_mul_ps(_mm_add_ps(mm_exp2_ps(exp), _mm_set_ps1(T::b)), _mm_set_ps1(1.0f / 12.0f));
+
+		x = mm_blendv_ps(exp, sq, mask);
+
+		if (Ootf)
+			x = mm_pow_ps(x, 1.2f);
+
+		return _mm_mul_ps(x, scale);
+	}
+};
+
+struct Rec709OETF {
+	static inline FORCE_INLINE __m128 func(__m128 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m128 lin, pow, mask;
+
+		x = _mm_max_ps(x, _mm_setzero_ps());
+		mask = _mm_cmplt_ps(x, _mm_set_ps1(T::beta));
+
+		// f(x) = 4.5 * x
+		lin = _mm_mul_ps(x, _mm_set_ps1(4.5f));
+
+		// f(x) = alpha * x^0.45 - (alpha - 1)
+		pow = _mm_add_ps(_mm_mul_ps(mm_pow_ps(x, 0.45f), _mm_set_ps1(T::alpha)), _mm_set_ps1(1.0f - T::alpha));
+
+		return mm_blendv_ps(pow, lin, mask);
+	}
+};
+
+struct Rec709InverseOETF {
+	static inline FORCE_INLINE __m128 func(__m128 x)
+	{
+		typedef x86constants::Rec709 T;
+
+		__m128 lin, pow, mask;
+
+		x = _mm_max_ps(x, _mm_setzero_ps());
+		mask = _mm_cmplt_ps(x, _mm_set_ps1(4.5f * T::beta));
+
+		// f(x) = x / 4.5
+		lin = _mm_mul_ps(x, _mm_set_ps1(1.0f / 4.5f));
+
+		// f(x) = ((x + (alpha - 1)) / alpha)^(1 / 0.45)
+		pow = _mm_add_ps(_mm_mul_ps(x, _mm_set_ps1(1.0f / T::alpha)), _mm_set_ps1((T::alpha - 1.0f) / T::alpha));
+		pow = mm_pow_ps(pow, 1.0f / 0.45f);
+
+		return mm_blendv_ps(pow, lin, mask);
+	}
+};
+
+typedef AribB67OETF<false> FuncAribB67OETF;
+typedef AribB67InverseOETF<false> FuncAribB67InverseOETF;
+
+// Operations on pixel triplets. The kernels are constructed on the stack, as
+// the operations themselves are not guaranteed to be suitably aligned.
+struct AribB67Kernel {
+	__m128 kr, kg, kb, scale;
+
+	AribB67Kernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm_set_ps1(kr_) }, kg{ _mm_set_ps1(kg_) }, kb{ _mm_set_ps1(kb_) }, scale{ _mm_set_ps1(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m128 &r, __m128 &g, __m128 &b) const
+	{
+		const __m128 one = _mm_set_ps1(1.0f);
+		__m128 yd, ys_inv;
+
+		r = _mm_mul_ps(r, scale);
+		g = _mm_mul_ps(g, scale);
+		b = _mm_mul_ps(b, scale);
+
+		yd = _mm_add_ps(_mm_mul_ps(kb, b), _mm_add_ps(_mm_mul_ps(kg, g), _mm_mul_ps(kr, r)));
+		yd = _mm_max_ps(yd, _mm_set_ps1(FLT_MIN));
+		ys_inv = mm_pow_ps(yd, (1.0f - 1.2f) / 1.2f);
+
+		r = FuncAribB67OETF::func(_mm_mul_ps(r, ys_inv), one);
+		g = FuncAribB67OETF::func(_mm_mul_ps(g, ys_inv), one);
+		b = FuncAribB67OETF::func(_mm_mul_ps(b, ys_inv), one);
+	}
+};
+
+struct AribB67InverseKernel {
+	__m128 kr, kg, kb, scale;
+
+	AribB67InverseKernel(float kr_, float kg_, float kb_, float scale_) :
+		kr{ _mm_set_ps1(kr_) }, kg{ _mm_set_ps1(kg_) }, kb{ _mm_set_ps1(kb_) }, scale{ _mm_set_ps1(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m128 &r, __m128 &g, __m128 &b) const
+	{
+		const __m128 one = _mm_set_ps1(1.0f);
+		__m128 ys;
+
+		r = FuncAribB67InverseOETF::func(r, one);
+		g = FuncAribB67InverseOETF::func(g, one);
+		b = FuncAribB67InverseOETF::func(b, one);
+
+		ys = _mm_add_ps(_mm_mul_ps(kb, b), _mm_add_ps(_mm_mul_ps(kg, g), _mm_mul_ps(kr, r)));
+		ys = _mm_max_ps(ys, _mm_set_ps1(FLT_MIN));
+		ys = _mm_mul_ps(mm_pow_ps(ys, 1.2f - 1.0f), scale);
+
+		r = _mm_mul_ps(r, ys);
+		g = _mm_mul_ps(g, ys);
+		b = _mm_mul_ps(b, ys);
+	}
+};
+
+struct CLToRGBKernel {
+	__m128 kr, kb, kg_inv;
+	__m128 nb2, pb2, nr2, pr2;
+	__m128 scale;
+
+	CLToRGBKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm_set_ps1(kr_) }, kb{ _mm_set_ps1(kb_) }, kg_inv{ _mm_set_ps1(1.0f / kg_) },
+		nb2{ _mm_set_ps1(2.0f * nb) }, pb2{ _mm_set_ps1(2.0f * pb) }, nr2{ _mm_set_ps1(2.0f * nr) }, pr2{ _mm_set_ps1(2.0f * pr) },
+		scale{ _mm_set_ps1(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m128 &y, __m128 &u, __m128 &v) const
+	{
+		__m128 r, g, b;
+		__m128 b_minus_y, r_minus_y;
+
+		b_minus_y = _mm_mul_ps(u, mm_blendv_ps(pb2, nb2, _mm_cmplt_ps(u, _mm_setzero_ps())));
+		r_minus_y = _mm_mul_ps(v, mm_blendv_ps(pr2, nr2, _mm_cmplt_ps(v, _mm_setzero_ps())));
+
+		b = Rec709InverseOETF::func(_mm_add_ps(b_minus_y, y));
+		r = Rec709InverseOETF::func(_mm_add_ps(r_minus_y, y));
+
+		y = Rec709InverseOETF::func(y);
+		g = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(kr, r)), _mm_mul_ps(kb, b)), kg_inv);
+
+		y = _mm_mul_ps(r, scale);
+		u = _mm_mul_ps(g, scale);
+		v = _mm_mul_ps(b, scale);
+	}
+};
+
+struct CLToYUVKernel {
+	__m128 kr, kg, kb;
+	__m128 nb2_inv, pb2_inv, nr2_inv, pr2_inv;
+	__m128 scale;
+
+	CLToYUVKernel(float kr_, float kg_, float kb_, float nb, float pb, float nr, float pr, float scale_) :
+		kr{ _mm_set_ps1(kr_) }, kg{ _mm_set_ps1(kg_) }, kb{ _mm_set_ps1(kb_) },
+		nb2_inv{ _mm_set_ps1(1.0f / (2.0f * nb)) }, pb2_inv{ _mm_set_ps1(1.0f / (2.0f * pb)) },
+		nr2_inv{ _mm_set_ps1(1.0f / (2.0f * nr)) }, pr2_inv{ _mm_set_ps1(1.0f / (2.0f * pr)) },
+		scale{ _mm_set_ps1(scale_) }
+	{}
+
+	inline FORCE_INLINE void xiter(__m128 &r, __m128 &g, __m128 &b) const
+	{
+		__m128 y, u, v;
+
+		r = _mm_mul_ps(r, scale);
+		g = _mm_mul_ps(g, scale);
+		b = _mm_mul_ps(b, scale);
+
+		y = Rec709OETF::func(_mm_add_ps(_mm_mul_ps(kb, b), _mm_add_ps(_mm_mul_ps(kg, g), _mm_mul_ps(kr, r))));
+		b = _mm_sub_ps(Rec709OETF::func(b), y);
+		r = _mm_sub_ps(Rec709OETF::func(r), y);
+
+		u = _mm_mul_ps(b, mm_blendv_ps(pb2_inv, nb2_inv, _mm_cmplt_ps(b, _mm_setzero_ps())));
+		v = _mm_mul_ps(r, mm_blendv_ps(pr2_inv, nr2_inv, _mm_cmplt_ps(r, _mm_setzero_ps())));
+
+		r = y;
+		g = u;
+		b = v;
+	}
+};
+
+template <class Kernel>
+void triplet_filter_line_sse2(const Kernel &kernel, const float * const * RESTRICT src, float * const * RESTRICT dst, unsigned left, unsigned right)
+{
+	const float *src0 = src[0];
+	const float *src1 = src[1];
+	const float *src2 = src[2];
+	float *dst0 = dst[0];
+	float *dst1 = dst[1];
+	float *dst2 = dst[2];
+
+	unsigned vec_left = ceil_n(left, 4);
+	unsigned vec_right = floor_n(right, 4);
+
+	if (left != vec_left) {
+		__m128 a = _mm_load_ps(src0 + vec_left - 4);
+		__m128 b = _mm_load_ps(src1 + vec_left - 4);
+		__m128 c = _mm_load_ps(src2 + vec_left - 4);
+		kernel.xiter(a, b, c);
+
+		mm_store_idxhi_ps(dst0 + vec_left - 4, a, left % 4);
+		mm_store_idxhi_ps(dst1 + vec_left - 4, b, left % 4);
+		mm_store_idxhi_ps(dst2 + vec_left - 4, c, left % 4);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 4) {
+		__m128 a = _mm_load_ps(src0 + j);
+		__m128 b = _mm_load_ps(src1 + j);
+		__m128 c = _mm_load_ps(src2 + j);
+		kernel.xiter(a, b, c);
+
+		_mm_store_ps(dst0 + j, a);
+		_mm_store_ps(dst1 + j, b);
+		_mm_store_ps(dst2 + j, c);
+	}
+
+	if (right != vec_right) {
+		__m128 a = _mm_load_ps(src0 + vec_right);
+		__m128 b = _mm_load_ps(src1 + vec_right);
+		__m128 c = _mm_load_ps(src2 + vec_right);
+		kernel.xiter(a, b, c);
+
+		mm_store_idxlo_ps(dst0 + vec_right, a, right % 4);
+		mm_store_idxlo_ps(dst1 + vec_right, b, right % 4);
+		mm_store_idxlo_ps(dst2 + vec_right, c, right % 4);
+	}
+}
+
 
 class ToLinearLutOperationSSE2 final : public Operation {
 	std::vector<float> m_lut;
@@ -181,6 +517,76 @@ public:
 	}
 };
 
+class AribB67OperationSSE2 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67OperationSSE2(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_sse2(AribB67Kernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class AribB67InverseOperationSSE2 final : public Operation {
+	float m_kr;
+	float m_kg;
+	float m_kb;
+	float m_scale;
+public:
+	AribB67InverseOperationSSE2(double kr, double kg, double kb, float scale) :
+		m_kr{ static_cast<float>(kr) },
+		m_kg{ static_cast<float>(kg) },
+		m_kb{ static_cast<float>(kb) },
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		triplet_filter_line_sse2(AribB67InverseKernel{ m_kr, m_kg, m_kb, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToRGBOperationSSE2 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToRGBOperationSSE2(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_sse2(CLToRGBKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
+class CLToYUVOperationSSE2 final : public Operation {
+	CLConstants m_constants;
+	float m_scale;
+public:
+	CLToYUVOperationSSE2(const CLConstants &constants, float scale) :
+		m_constants(constants),
+		m_scale{ scale }
+	{}
+
+	void process(const float * const *src, float * const *dst, unsigned left, unsigned right) const override
+	{
+		const CLConstants &c = m_constants;
+		triplet_filter_line_sse2(CLToYUVKernel{ c.kr, c.kg, c.kb, c.nb, c.pb, c.nr, c.pr, m_scale }, src, dst, left, right);
+	}
+};
+
 } // namespace
 
 
@@ -189,6 +595,7 @@ std::unique_ptr<Operation> create_gamma_operation_sse2(const TransferFunction &t
 	if (!params.approximate_gamma)
 		return nullptr;
 
+	// Without FMA and permutes, polynomial evaluation is 2-12x slower than the LUT.
 	return std::make_unique<ToGammaLutOperationSSE2>(transfer.to_gamma, transfer.to_gamma_scale);
 }
 
@@ -200,6 +607,32 @@ std::unique_ptr<Operation> create_inverse_gamma_operation_sse2(const TransferFun
 	return std::make_unique<ToLinearLutOperationSSE2>(transfer.to_linear, LUT_DEPTH, transfer.to_linear_scale);
 }
 
+std::unique_ptr<Operation> create_arib_b67_operation_sse2(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67OperationSSE2>(m[0][0], m[0][1], m[0][2], transfer.to_gamma_scale);
+}
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_sse2(const Matrix3x3 &m, const TransferFunction &transfer)
+{
+	return std::make_unique<AribB67InverseOperationSSE2>(m[0][0], m[0][1], m[0][2], transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_sse2(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_linear != rec_709_inverse_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToRGBOperationSSE2>(constants, transfer.to_linear_scale);
+}
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_sse2(const CLConstants &constants, const TransferFunction &transfer)
+{
+	if (transfer.to_gamma != rec_709_oetf)
+		return nullptr;
+
+	return std::make_unique<CLToYUVOperationSSE2>(constants, transfer.to_gamma_scale);
+}
+
 } // namespace colorspace
 } // namespace zimg
 
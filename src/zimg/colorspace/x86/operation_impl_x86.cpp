@@ -93,6 +93,118 @@ std::unique_ptr<Operation> create_inverse_gamma_operation_x86(const TransferFunc
 	return ret;
 }
 
+std::unique_ptr<Operation> create_arib_b67_operation_x86(const Matrix3x3 &m, const TransferFunction &transfer, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<Operation> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			ret = create_arib_b67_operation_avx512(m, transfer);
+#endif
+		if (!ret && caps.avx2 && caps.fma)
+			ret = create_arib_b67_operation_avx2(m, transfer);
+		if (!ret && caps.sse2)
+			ret = create_arib_b67_operation_sse2(m, transfer);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_arib_b67_operation_avx512(m, transfer);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_arib_b67_operation_avx2(m, transfer);
+		if (!ret && cpu >= CPUClass::X86_SSE2)
+			ret = create_arib_b67_operation_sse2(m, transfer);
+	}
+
+	return ret;
+}
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_x86(const Matrix3x3 &m, const TransferFunction &transfer, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<Operation> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			ret = create_inverse_arib_b67_operation_avx512(m, transfer);
+#endif
+		if (!ret && caps.avx2 && caps.fma)
+			ret = create_inverse_arib_b67_operation_avx2(m, transfer);
+		if (!ret && caps.sse2)
+			ret = create_inverse_arib_b67_operation_sse2(m, transfer);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_inverse_arib_b67_operation_avx512(m, transfer);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_inverse_arib_b67_operation_avx2(m, transfer);
+		if (!ret && cpu >= CPUClass::X86_SSE2)
+			ret = create_inverse_arib_b67_operation_sse2(m, transfer);
+	}
+
+	return ret;
+}
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_x86(const CLConstants &constants, const TransferFunction &transfer, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<Operation> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			ret = create_cl_yuv_to_rgb_operation_avx512(constants, transfer);
+#endif
+		if (!ret && caps.avx2 && caps.fma)
+			ret = create_cl_yuv_to_rgb_operation_avx2(constants, transfer);
+		if (!ret && caps.sse2)
+			ret = create_cl_yuv_to_rgb_operation_sse2(constants, transfer);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_cl_yuv_to_rgb_operation_avx512(constants, transfer);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_cl_yuv_to_rgb_operation_avx2(constants, transfer);
+		if (!ret && cpu >= CPUClass::X86_SSE2)
+			ret = create_cl_yuv_to_rgb_operation_sse2(constants, transfer);
+	}
+
+	return ret;
+}
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_x86(const CLConstants &constants, const TransferFunction &transfer, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	std::unique_ptr<Operation> ret;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			ret = create_cl_rgb_to_yuv_operation_avx512(constants, transfer);
+#endif
+		if (!ret && caps.avx2 && caps.fma)
+			ret = create_cl_rgb_to_yuv_operation_avx2(constants, transfer);
+		if (!ret && caps.sse2)
+			ret = create_cl_rgb_to_yuv_operation_sse2(constants, transfer);
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_cl_rgb_to_yuv_operation_avx512(constants, transfer);
+#endif
+		if (!ret && cpu >= CPUClass::X86_AVX2)
+			ret = create_cl_rgb_to_yuv_operation_avx2(constants, transfer);
+		if (!ret && cpu >= CPUClass::X86_SSE2)
+			ret = create_cl_rgb_to_yuv_operation_sse2(constants, transfer);
+	}
+
+	return ret;
+}
+
 } // namespace colorspace
 } // namespace zimg
 
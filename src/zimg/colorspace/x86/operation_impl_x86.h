@@ -13,6 +13,7 @@ enum class CPUClass;
 
 namespace colorspace {
 
+struct CLConstants;
 struct Matrix3x3;
 struct OperationParams;
 struct TransferFunction;
@@ -36,6 +37,30 @@ std::unique_ptr<Operation> create_inverse_gamma_operation_avx512(const TransferF
 
 std::unique_ptr<Operation> create_inverse_gamma_operation_x86(const TransferFunction &transfer, const OperationParams &params, CPUClass cpu);
 
+std::unique_ptr<Operation> create_arib_b67_operation_sse2(const Matrix3x3 &m, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_arib_b67_operation_avx2(const Matrix3x3 &m, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_arib_b67_operation_avx512(const Matrix3x3 &m, const TransferFunction &transfer);
+
+std::unique_ptr<Operation> create_arib_b67_operation_x86(const Matrix3x3 &m, const TransferFunction &transfer, CPUClass cpu);
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_sse2(const Matrix3x3 &m, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_avx2(const Matrix3x3 &m, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_avx512(const Matrix3x3 &m, const TransferFunction &transfer);
+
+std::unique_ptr<Operation> create_inverse_arib_b67_operation_x86(const Matrix3x3 &m, const TransferFunction &transfer, CPUClass cpu);
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_sse2(const CLConstants &constants, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_avx2(const CLConstants &constants, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_avx512(const CLConstants &constants, const TransferFunction &transfer);
+
+std::unique_ptr<Operation> create_cl_yuv_to_rgb_operation_x86(const CLConstants &constants, const TransferFunction &transfer, CPUClass cpu);
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_sse2(const CLConstants &constants, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_avx2(const CLConstants &constants, const TransferFunction &transfer);
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_avx512(const CLConstants &constants, const TransferFunction &transfer);
+
+std::unique_ptr<Operation> create_cl_rgb_to_yuv_operation_x86(const CLConstants &constants, const TransferFunction &transfer, CPUClass cpu);
+
 } // namespace colorspace
 } // namespace zimg
 
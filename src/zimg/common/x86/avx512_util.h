@@ -72,23 +72,23 @@ static inline FORCE_INLINE void mm512_transpose8_x4_epi16(__m512i &row0, __m512i
 	t6 = _mm512_unpackhi_epi16(row4, row5);
 	t7 = _mm512_unpackhi_epi16(row6, row7);
 
-	tt0 = _mm512_unpacklo_epi32(t0, t1);
-	tt1 = _mm512_unpackhi_epi32(t0, t1);
-	tt2 = _mm512_unpacklo_epi32(t2, t3);
-	tt3 = _mm512_unpackhi_epi32(t2, t3);
-	tt4 = _mm512_unpacklo_epi32(t4, t5);
-	tt5 = _mm512_unpackhi_epi32(t4, t5);
-	tt6 = _mm512_unpacklo_epi32(t6, t7);
-	tt7 = _mm512_unpackhi_epi32(t6, t7);
-
-	row0 = _mm512_unpacklo_epi64(tt0, tt2);
-	row1 = _mm512_unpackhi_epi64(tt0, tt2);
-	row2 = _mm512_unpacklo_epi64(tt1, tt3);
-	row3 = _mm512_unpackhi_epi64(tt1, tt3);
-	row4 = _mm512_unpacklo_epi64(tt4, tt6);
-	row5 = _mm512_unpackhi_epi64(tt4, tt6);
-	row6 = _mm512_unpacklo_epi64(tt5, tt7);
-	row7 = _mm512_unpackhi_epi64(tt5, tt7);
+	tt0 = _mm512_maskz_unpacklo_epi32(0xFFFF, t0, t1);
+	tt1 = _mm512_maskz_unpackhi_epi32(0xFFFF, t0, t1);
+	tt2 = _mm512_maskz_unpacklo_epi32(0xFFFF, t2, t3);
+	tt3 = _mm512_maskz_unpackhi_epi32(0xFFFF, t2, t3);
+	tt4 = _mm512_maskz_unpacklo_epi32(0xFFFF, t4, t5);
+	tt5 = _mm512_maskz_unpackhi_epi32(0xFFFF, t4, t5);
+	tt6 = _mm512_maskz_unpacklo_epi32(0xFFFF, t6, t7);
+	tt7 = _mm512_maskz_unpackhi_epi32(0xFFFF, t6, t7);
+
+	row0 = _mm512_maskz_unpacklo_epi64(0xFF, tt0, tt2);
+	row1 = _mm512_maskz_unpackhi_epi64(0xFF, tt0, tt2);
+	row2 = _mm512_maskz_unpacklo_epi64(0xFF, tt1, tt3);
+	row3 = _mm512_maskz_unpackhi_epi64(0xFF, tt1, tt3);
+	row4 = _mm512_maskz_unpacklo_epi64(0xFF, tt4, tt6);
+	row5 = _mm512_maskz_unpackhi_epi64(0xFF, tt4, tt6);
+	row6 = _mm512_maskz_unpacklo_epi64(0xFF, tt5, tt7);
+	row7 = _mm512_maskz_unpackhi_epi64(0xFF, tt5, tt7);
 }
 
 // Transpose the 4x4 matrix stored in [row0]-[row3].
@@ -96,15 +96,15 @@ static inline FORCE_INLINE void mm512_transpose4_si128(__m512i &row0, __m512i &r
 {
 	__m512i t0, t1, t2, t3;
 
-	t0 = _mm512_shuffle_i32x4(row0, row1, 0x88);
-	t1 = _mm512_shuffle_i32x4(row0, row1, 0xdd);
-	t2 = _mm512_shuffle_i32x4(row2, row3, 0x88);
-	t3 = _mm512_shuffle_i32x4(row2, row3, 0xdd);
+	t0 = _mm512_maskz_shuffle_i32x4(0xFFFF, row0, row1, 0x88);
+	t1 = _mm512_maskz_shuffle_i32x4(0xFFFF, row0, row1, 0xdd);
+	t2 = _mm512_maskz_shuffle_i32x4(0xFFFF, row2, row3, 0x88);
+	t3 = _mm512_maskz_shuffle_i32x4(0xFFFF, row2, row3, 0xdd);
 
-	row0 = _mm512_shuffle_i32x4(t0, t2, 0x88);
-	row1 = _mm512_shuffle_i32x4(t1, t3, 0x88);
-	row2 = _mm512_shuffle_i32x4(t0, t2, 0xdd);
-	row3 = _mm512_shuffle_i32x4(t1, t3, 0xdd);
+	row0 = _mm512_maskz_shuffle_i32x4(0xFFFF, t0, t2, 0x88);
+	row1 = _mm512_maskz_shuffle_i32x4(0xFFFF, t1, t3, 0x88);
+	row2 = _mm512_maskz_shuffle_i32x4(0xFFFF, t0, t2, 0xdd);
+	row3 = _mm512_maskz_shuffle_i32x4(0xFFFF, t1, t3, 0xdd);
 }
 
 } // namespace _avx512
@@ -45,7 +45,8 @@ DepthConversion::DepthConversion(unsigned width, unsigned height) :
 	pixel_out{},
 	dither_type{ DitherType::NONE },
 	planes{ true, false, false, false },
-	cpu{ CPUClass::NONE }
+	cpu{ CPUClass::NONE },
+	error_diffusion_threads{}
 {}
 
 DepthConversion::result DepthConversion::create() const try
@@ -62,7 +63,7 @@ DepthConversion::result DepthConversion::create() const try
 	else if (pixel_is_float(pixel_out.type))
 		return{ create_convert_to_float(width, height, pixel_in, pixel_out, cpu), planes.data() };
 	else
-		return create_dither(dither_type, width, height, pixel_in, pixel_out, planes.data(), cpu);
+		return create_dither(dither_type, width, height, pixel_in, pixel_out, planes.data(), cpu, error_diffusion_threads);
 } catch (const std::bad_alloc &) {
 	error::throw_<error::OutOfMemory>();
 }
@@ -23,6 +23,7 @@ enum class DitherType {
 	ORDERED,
 	RANDOM,
 	ERROR_DIFFUSION,
+	RANDOM_COUNTER,
 };
 
 struct DepthConversion {
@@ -46,6 +47,7 @@ struct DepthConversion {
 	BUILDER_MEMBER(std::array<bool COMMA 4>, planes)
 #undef COMMA
 	BUILDER_MEMBER(CPUClass, cpu)
+	BUILDER_MEMBER(unsigned, error_diffusion_threads)
 #undef BUILDER_MEMBER
 
 	DepthConversion(unsigned width, unsigned height);
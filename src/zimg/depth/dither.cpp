@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
+#include "common/align.h"
 #include "common/alloc.h"
 #include "common/checked_int.h"
 #include "common/except.h"
@@ -14,6 +17,7 @@
 #include "depth.h"
 #include "dither.h"
 #include "quantize.h"
+#include "wavefront.h"
 
 #if defined(ZIMG_X86)
   #include "x86/dither_x86.h"
@@ -83,6 +87,29 @@ void half_to_float_n(const void *src, void *dst, unsigned left, unsigned right)
 	std::transform(src_p + left, src_p + right, dst_p + left, half_to_float);
 }
 
+uint32_t counter_hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= DITHER_COUNTER_MUL1;
+	x ^= x >> 15;
+	x *= DITHER_COUNTER_MUL2;
+	x ^= x >> 16;
+	return x;
+}
+
+uint32_t counter_key(unsigned plane, unsigned i)
+{
+	return counter_hash(static_cast<uint32_t>(i) * 4 + plane);
+}
+
+void counter_noise(uint32_t key, float *dst, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; ++j) {
+		uint32_t x = counter_hash((j * DITHER_COUNTER_STEP) ^ key);
+		dst[j] = static_cast<float>(x >> 8) * (1.0f / (1UL << 24)) - (0.5f - 1.0f / (1UL << 25));
+	}
+}
+
 
 dither_convert_func select_ordered_dither_func(PixelType pixel_in, PixelType pixel_out)
 {
@@ -284,12 +311,82 @@ public:
 };
 
 
+class CounterDither : public graph::PointFilter {
+	dither_noise_func m_noise;
+	dither_convert_func m_func;
+	dither_f16c_func m_f16c;
+	size_t m_noise_size;
+	float m_scale;
+	float m_offset;
+	unsigned m_depth;
+	unsigned m_plane;
+
+	void check_preconditions(unsigned width, const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+	{
+		zassert_d(width <= pixel_max_width(pixel_in.type), "overflow");
+		zassert_d(width <= pixel_max_width(pixel_out.type), "overflow");
+
+		if (!pixel_is_integer(pixel_out.type))
+			error::throw_<error::InternalError>("cannot dither to non-integer format");
+	}
+public:
+	CounterDither(dither_noise_func noise, dither_convert_func func, dither_f16c_func f16c, unsigned width, unsigned height,
+	              const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned plane) :
+		PointFilter(width, height, pixel_out.type),
+		m_noise{ noise },
+		m_func{ func },
+		m_f16c{ f16c },
+		m_noise_size{},
+		m_scale{},
+		m_offset{},
+		m_depth{ pixel_out.depth },
+		m_plane{ plane }
+	{
+		check_preconditions(width, pixel_in, pixel_out);
+
+		// The dither is read in aligned groups of up to 16 pixels.
+		checked_size_t noise_size = static_cast<checked_size_t>(ceil_n(width, 16)) * sizeof(float);
+		checked_size_t f16c_size = m_f16c ? static_cast<checked_size_t>(width) * sizeof(float) : static_cast<checked_size_t>(0);
+
+		m_noise_size = noise_size.get();
+
+		m_desc.num_deps = 1;
+		m_desc.num_planes = 1;
+		m_desc.scratchpad_size = (noise_size + f16c_size).get();
+		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(pixel_out.type);
+
+		std::tie(m_scale, m_offset) = get_scale_offset(pixel_in, pixel_out);
+	}
+
+	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
+	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
+	{
+		float *noise = static_cast<float *>(tmp);
+		m_noise(counter_key(m_plane, i), noise, floor_n(left, 16), ceil_n(right, 16));
+
+		const void *src_line = in->get_line(i);
+		void *dst_line = out->get_line(i);
+
+		if (m_f16c) {
+			void *f16c_tmp = static_cast<unsigned char *>(tmp) + m_noise_size;
+			m_f16c(src_line, f16c_tmp, left, right);
+			src_line = f16c_tmp;
+		}
+
+		m_func(noise, 0, UINT_MAX, src_line, dst_line, m_scale, m_offset, m_depth, left, right);
+	}
+};
+
+
 class ErrorDiffusion : public graph::FilterBase {
 public:
 	typedef void (*ed_func)(const void *src, void *dst, void *error_top, void *error_cur, float scale, float offset, unsigned bits, unsigned width);
 private:
 	ed_func m_func;
 	dither_f16c_func m_f16c;
+	unsigned m_num_rows;
+	unsigned m_src_size;
+	unsigned m_dst_size;
 	float m_scale;
 	float m_offset;
 	unsigned m_depth;
@@ -302,10 +399,38 @@ private:
 		if (!pixel_is_integer(pixel_out.type))
 			error::throw_<error::InternalError>("cannot dither to non-integer format");
 	}
+
+	void process_row(const void *src, void *dst, void *context, void *tmp, unsigned i, const WavefrontSync *sync) const
+	{
+		unsigned width = m_desc.format.width;
+		size_t row_size = m_desc.context_size / (m_num_rows + 1);
+
+		// Row i reads the errors of row i - 1 from a ring of m_num_rows + 1 rows.
+		float *error_top = reinterpret_cast<float *>(static_cast<unsigned char *>(context) + row_size * ((i + m_num_rows) % (m_num_rows + 1)));
+		float *error_cur = reinterpret_cast<float *>(static_cast<unsigned char *>(context) + row_size * (i % (m_num_rows + 1)));
+
+		if (m_f16c) {
+			m_f16c(src, tmp, 0, width);
+			src = tmp;
+		}
+
+		// Each column reads the error of the next column in the row above.
+		for (unsigned j = 0; j < width; j += WAVEFRONT_CHUNK) {
+			unsigned j_end = std::min(j + WAVEFRONT_CHUNK, width);
+			wavefront_wait(sync, std::min(j_end + 1, width));
+
+			m_func(static_cast<const unsigned char *>(src) + static_cast<size_t>(j) * m_src_size, static_cast<unsigned char *>(dst) + static_cast<size_t>(j) * m_dst_size,
+			       error_top + j, error_cur + j, m_scale, m_offset, m_depth, j_end - j);
+			wavefront_signal(sync, j_end);
+		}
+	}
 public:
-	ErrorDiffusion(ed_func func, dither_f16c_func f16c, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out) :
+	ErrorDiffusion(ed_func func, dither_f16c_func f16c, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads) :
 		m_func{ func },
 		m_f16c{ f16c },
+		m_num_rows{ wavefront_num_blocks(threads, height, 1) },
+		m_src_size{ f16c ? static_cast<unsigned>(sizeof(float)) : pixel_size(pixel_in.type) },
+		m_dst_size{ pixel_size(pixel_out.type) },
 		m_scale{},
 		m_offset{},
 		m_depth{ pixel_out.depth }
@@ -315,10 +440,10 @@ public:
 		m_desc.format = { width, height, pixel_size(pixel_out.type) };
 		m_desc.num_deps = 1;
 		m_desc.num_planes = 1;
-		m_desc.step = 1;
+		m_desc.step = m_num_rows;
 
-		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * 2).get();
-		m_desc.scratchpad_size = m_f16c ? (static_cast<checked_size_t>(width) * sizeof(float)).get() : 0;
+		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * (m_num_rows + 1)).get();
+		m_desc.scratchpad_size = m_f16c ? (ceil_n(static_cast<checked_size_t>(width) * sizeof(float), ALIGNMENT) * m_num_rows).get() : 0;
 
 		m_desc.flags.stateful = 1;
 		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(pixel_out.type);
@@ -327,7 +452,11 @@ public:
 		std::tie(m_scale, m_offset) = get_scale_offset(pixel_in, pixel_out);
 	}
 
-	pair_unsigned get_row_deps(unsigned i) const noexcept override { return{ i, i + 1 }; }
+	pair_unsigned get_row_deps(unsigned i) const noexcept override
+	{
+		unsigned last = std::min(i, UINT_MAX - m_num_rows) + m_num_rows;
+		return{ i, std::min(last, m_desc.format.height) };
+	}
 
 	pair_unsigned get_col_deps(unsigned, unsigned) const noexcept override { return{ 0, m_desc.format.width }; }
 
@@ -339,21 +468,18 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *context, void *tmp) const noexcept override
 	{
-		const void *src_p = in->get_line(i);
-		void *dst_p = out->get_line(i);
-
-		void *error_a = context;
-		void *error_b = static_cast<uint8_t *>(context) + m_desc.context_size / 2;
+		unsigned num_rows = std::min(m_num_rows, m_desc.format.height - i);
+		size_t tmp_stride = ceil_n(static_cast<size_t>(m_desc.format.width) * sizeof(float), ALIGNMENT);
 
-		void *error_top = i % 2 ? error_a : error_b;
-		void *error_cur = i % 2 ? error_b : error_a;
-
-		if (m_f16c) {
-			m_f16c(src_p, tmp, 0, m_desc.format.width);
-			src_p = tmp;
+		if (m_num_rows == 1) {
+			process_row(in->get_line(i), out->get_line(i), context, tmp, i, nullptr);
+			return;
 		}
 
-		m_func(src_p, dst_p, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
+		wavefront_run(num_rows, [&](unsigned n, const WavefrontSync &sync)
+		{
+			process_row(in->get_line(i + n), out->get_line(i + n), context, static_cast<unsigned char *>(tmp) + tmp_stride * n, i + n, &sync);
+		});
 	}
 };
 
@@ -372,10 +498,10 @@ std::unique_ptr<OrderedDitherTable> create_dither_table(DitherType type, unsigne
 	}
 }
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graphengine::Filter> create_error_diffusion(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads)
 {
-#ifdef ZIMG_X86
-	if (auto ret = create_error_diffusion_x86(width, height, pixel_in, pixel_out, cpu))
+#if defined(ZIMG_X86)
+	if (auto ret = create_error_diffusion_x86(width, height, pixel_in, pixel_out, cpu, threads))
 		return ret;
 #endif
 
@@ -388,16 +514,16 @@ std::unique_ptr<graphengine::Filter> create_error_diffusion(unsigned width, unsi
 	if (needs_f16c && !f16c)
 		f16c = half_to_float_n;
 
-	return std::make_unique<ErrorDiffusion>(func, f16c, width, height, pixel_in, pixel_out);
+	return std::make_unique<ErrorDiffusion>(func, f16c, width, height, pixel_in, pixel_out, threads);
 }
 
 } // namespace
 
 
-DepthConversion::result create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, const bool planes[4], CPUClass cpu)
+DepthConversion::result create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, const bool planes[4], CPUClass cpu, unsigned threads)
 {
 	if (type == DitherType::ERROR_DIFFUSION)
-		return{ create_error_diffusion(width, height, pixel_in, pixel_out, cpu), planes };
+		return{ create_error_diffusion(width, height, pixel_in, pixel_out, cpu, threads), planes };
 
 	dither_convert_func func = nullptr;
 	dither_f16c_func f16c = nullptr;
@@ -423,8 +549,27 @@ DepthConversion::result create_dither(DitherType type, unsigned width, unsigned
 			f16c = half_to_float_n;
 	}
 
-	std::shared_ptr<OrderedDitherTable> table = create_dither_table(type, width, height);
 	DepthConversion::result res{};
+
+	if (type == DitherType::RANDOM_COUNTER) {
+		dither_noise_func noise = nullptr;
+#if defined(ZIMG_X86)
+		noise = select_dither_noise_func_x86(cpu);
+#endif
+		if (!noise)
+			noise = counter_noise;
+
+		for (unsigned p = 0; p < 4; ++p) {
+			if (!planes[p])
+				continue;
+
+			res.filters[p] = std::make_unique<CounterDither>(noise, func, f16c, width, height, pixel_in, pixel_out, p);
+			res.filter_refs[p] = res.filters[p].get();
+		}
+		return res;
+	}
+
+	std::shared_ptr<OrderedDitherTable> table = create_dither_table(type, width, height);
 	for (unsigned p = 0; p < 4; ++p) {
 		if (!planes[p])
 			continue;
@@ -3,6 +3,7 @@
 #ifndef ZIMG_DEPTH_DITHER_H_
 #define ZIMG_DEPTH_DITHER_H_
 
+#include <cstdint>
 #include <memory>
 #include "depth.h"
 
@@ -26,7 +27,41 @@ typedef void (*dither_convert_func)(const float *dither, unsigned dither_offset,
                                     const void *src, void *dst, float scale, float offset, unsigned bits, unsigned left, unsigned right);
 typedef void (*dither_f16c_func)(const void *src, void *dst, unsigned left, unsigned right);
 
-DepthConversion::result create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, const bool planes[4], CPUClass cpu);
+/**
+ * Generate the dither of columns [left, right) of a row into dst.
+ *
+ * The noise at each column is a hash of the column index and the row key, so
+ * any span of any row can be generated independently. The range [left, right)
+ * must be aligned to 16 pixels.
+ */
+typedef void (*dither_noise_func)(uint32_t key, float *dst, unsigned left, unsigned right);
+
+/**
+ * Constants of the counter-based dither.
+ *
+ * The counter of column j is j * STEP, which visits every 32-bit value. It is
+ * combined with the row key and mixed by xorshift-multiply rounds with MUL1 and
+ * MUL2. The upper 24 bits of the hash are mapped to (-0.5, 0.5).
+ */
+constexpr uint32_t DITHER_COUNTER_STEP = 0x9E3779B9U;
+constexpr uint32_t DITHER_COUNTER_MUL1 = 0x7FEB352DU;
+constexpr uint32_t DITHER_COUNTER_MUL2 = 0x846CA68BU;
+
+/**
+ * Create a filter reducing the bit depth of an image with dithering.
+ *
+ * Error diffusion processes one row after another. If threads is greater than
+ * one, the rows are divided into blocks, each lagging the block above by a
+ * fixed number of columns. The blocks run concurrently on the executor of the
+ * calling thread (see {@link wavefront_run}). The output is identical to the
+ * serial filter. Other dither types ignore the thread count.
+ *
+ * Counter-based random dither computes the noise of each pixel from its plane,
+ * row, and column, and needs no table.
+ *
+ * @param threads number of threads for error diffusion
+ */
+DepthConversion::result create_dither(DitherType type, unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, const bool planes[4], CPUClass cpu, unsigned threads = 1);
 
 } // namespace depth
 } // namespace zimg
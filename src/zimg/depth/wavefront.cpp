@@ -0,0 +1,153 @@
+#include <new>
+#include <system_error>
+#include "wavefront.h"
+
+namespace zimg {
+namespace depth {
+
+namespace {
+
+thread_local WavefrontExecutor *g_executor = nullptr;
+
+void run_serial(unsigned num_blocks, WavefrontExecutor::block_func func, void *user) noexcept
+{
+	// Each block starts after the block above it has completed.
+	std::atomic_uint progress{};
+
+	for (unsigned n = 0; n < num_blocks; ++n) {
+		WavefrontSync sync{ nullptr, &progress };
+		func(user, n, sync);
+	}
+}
+
+} // namespace
+
+
+void WavefrontTask::work() noexcept
+{
+	unsigned n;
+
+	while ((n = next++) < num_blocks) {
+		WavefrontSync sync{ n ? &progress[n - 1] : nullptr, &progress[n] };
+		func(user, n, sync);
+	}
+}
+
+
+WavefrontPool::WavefrontPool(unsigned num_threads) :
+	m_progress{ new std::atomic_uint[num_threads * WAVEFRONT_BLOCKS_PER_THREAD] },
+	m_num_threads{ num_threads },
+	m_max_blocks{ num_threads * WAVEFRONT_BLOCKS_PER_THREAD },
+	m_started{},
+	m_task{},
+	m_generation{},
+	m_active{},
+	m_quit{}
+{}
+
+WavefrontPool::~WavefrontPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_quit = true;
+	}
+	m_start_cv.notify_all();
+
+	for (std::thread &th : m_threads) {
+		th.join();
+	}
+}
+
+void WavefrontPool::start() noexcept
+{
+	m_started = true;
+
+	// Any blocks left by workers that fail to launch are run by the caller.
+	try {
+		for (unsigned i = 1; i < m_num_threads; ++i) {
+			m_threads.emplace_back(&WavefrontPool::worker_main, this);
+		}
+	} catch (const std::system_error &) {
+		// Continue with the threads already started.
+	} catch (const std::bad_alloc &) {
+		// Continue with the threads already started.
+	}
+}
+
+void WavefrontPool::worker_main() noexcept
+{
+	// Workers start from the initial generation, since a call to run may
+	// already have been made by the time the thread is scheduled.
+	std::unique_lock<std::mutex> lock{ m_mutex };
+	unsigned generation = 0;
+
+	while (true) {
+		m_start_cv.wait(lock, [&]() { return m_quit || m_generation != generation; });
+		if (m_quit)
+			break;
+
+		generation = m_generation;
+		WavefrontTask *task = m_task;
+		lock.unlock();
+		task->work();
+		lock.lock();
+
+		if (--m_active == 0)
+			m_done_cv.notify_one();
+	}
+}
+
+void WavefrontPool::run(unsigned num_blocks, block_func func, void *user) noexcept
+{
+	std::unique_lock<std::mutex> run_lock{ m_run_mutex, std::try_to_lock };
+
+	if (!run_lock.owns_lock() || num_blocks <= 1 || num_blocks > m_max_blocks) {
+		run_serial(num_blocks, func, user);
+		return;
+	}
+
+	if (!m_started)
+		start();
+
+	for (unsigned n = 0; n < num_blocks; ++n) {
+		m_progress[n].store(0, std::memory_order_relaxed);
+	}
+
+	WavefrontTask task{ func, user, m_progress.get(), num_blocks, { 0 } };
+
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_task = &task;
+		m_active = static_cast<unsigned>(m_threads.size());
+		++m_generation;
+	}
+	m_start_cv.notify_all();
+
+	task.work();
+
+	std::unique_lock<std::mutex> lock{ m_mutex };
+	m_done_cv.wait(lock, [&]() { return m_active == 0; });
+}
+
+
+WavefrontScope::WavefrontScope(WavefrontExecutor *executor) noexcept : m_prev{ g_executor }
+{
+	g_executor = executor;
+}
+
+WavefrontScope::~WavefrontScope()
+{
+	g_executor = m_prev;
+}
+
+
+void wavefront_run(unsigned num_blocks, WavefrontExecutor::block_func func, void *user) noexcept
+{
+	if (g_executor && num_blocks > 1)
+		g_executor->run(num_blocks, func, user);
+	else
+		run_serial(num_blocks, func, user);
+}
+
+} // namespace depth
+} // namespace zimg
@@ -0,0 +1,231 @@
+#pragma once
+
+#ifndef ZIMG_DEPTH_WAVEFRONT_H_
+#define ZIMG_DEPTH_WAVEFRONT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zimg {
+namespace depth {
+
+/**
+ * Number of columns processed between synchronization points.
+ */
+constexpr unsigned WAVEFRONT_CHUNK = 128;
+
+/**
+ * Number of blocks of rows per thread in each call to a parallel filter.
+ */
+constexpr unsigned WAVEFRONT_BLOCKS_PER_THREAD = 4;
+
+/**
+ * Number of blocks of rows per call to a filter, or 1 to run serially.
+ *
+ * @param threads number of threads
+ * @param height image height
+ * @param block_height number of rows per block
+ * @return number of blocks
+ */
+inline unsigned wavefront_num_blocks(unsigned threads, unsigned height, unsigned block_height) noexcept
+{
+	unsigned blocks = height / block_height;
+
+	if (threads <= 1 || blocks <= 1)
+		return 1;
+
+	return std::min(std::min(threads, blocks) * WAVEFRONT_BLOCKS_PER_THREAD, blocks);
+}
+
+/**
+ * Orders a block of rows after the block above it.
+ *
+ * Error diffusion reads the errors of the row above up to a bounded number of
+ * columns to the right of the current pixel. A block may therefore run
+ * concurrently with the block above, provided that it stays that many columns
+ * behind.
+ */
+class WavefrontSync {
+	const std::atomic_uint *m_top;
+	std::atomic_uint *m_cur;
+public:
+	/**
+	 * Initialize the synchronization of a block.
+	 *
+	 * @param top progress of the block above, or nullptr if it is complete
+	 * @param cur progress of the current block
+	 */
+	WavefrontSync(const std::atomic_uint *top, std::atomic_uint *cur) noexcept : m_top{ top }, m_cur{ cur } {}
+
+	/**
+	 * Wait for columns [0, col) of the last row of the block above.
+	 *
+	 * @param col column count
+	 */
+	void wait(unsigned col) const noexcept
+	{
+		if (!m_top)
+			return;
+
+		while (m_top->load(std::memory_order_acquire) < col) {
+			std::this_thread::yield();
+		}
+	}
+
+	/**
+	 * Publish columns [0, col) of the last row of the current block.
+	 *
+	 * @param col column count
+	 */
+	void signal(unsigned col) const noexcept
+	{
+		m_cur->store(col, std::memory_order_release);
+	}
+};
+
+inline void wavefront_wait(const WavefrontSync *sync, unsigned col) noexcept
+{
+	if (sync)
+		sync->wait(col);
+}
+
+inline void wavefront_signal(const WavefrontSync *sync, unsigned col) noexcept
+{
+	if (sync)
+		sync->signal(col);
+}
+
+
+/**
+ * Runs the blocks of a wavefront filter.
+ *
+ * Filters do not own threads. A graph installs an executor on the calling
+ * thread for the duration of a processing call, and filters run their blocks
+ * through {@link wavefront_run}.
+ */
+class WavefrontExecutor {
+public:
+	typedef void (*block_func)(void *user, unsigned n, const WavefrontSync &sync);
+
+	virtual ~WavefrontExecutor() = default;
+
+	/**
+	 * Process blocks [0, num_blocks) and wait for their completion.
+	 *
+	 * Block 0 does not wait for any other block.
+	 *
+	 * @param num_blocks number of blocks
+	 * @param func callback
+	 * @param user user pointer passed to callback
+	 */
+	virtual void run(unsigned num_blocks, block_func func, void *user) noexcept = 0;
+};
+
+/**
+ * Blocks of a call to {@link WavefrontExecutor::run}, shared by its threads.
+ *
+ * Blocks are taken in ascending order, so every block waits only on a block
+ * already in progress. Any thread may call {@link work}, and the blocks are
+ * complete once every thread that called it has returned.
+ */
+struct WavefrontTask {
+	WavefrontExecutor::block_func func;
+	void *user;
+	std::atomic_uint *progress;
+	unsigned num_blocks;
+	std::atomic_uint next;
+
+	void work() noexcept;
+};
+
+/**
+ * Persistent set of threads processing blocks of rows as a wavefront.
+ *
+ * The threads are started by the first call to {@link run}. The calling
+ * thread participates in the work, and the pool remains correct if no worker
+ * could be started. A call made while the pool is busy runs its blocks
+ * serially instead of waiting.
+ */
+class WavefrontPool : public WavefrontExecutor {
+	std::vector<std::thread> m_threads;
+	std::unique_ptr<std::atomic_uint[]> m_progress;
+	unsigned m_num_threads;
+	unsigned m_max_blocks;
+	bool m_started;
+
+	std::mutex m_run_mutex;
+	std::mutex m_mutex;
+	std::condition_variable m_start_cv;
+	std::condition_variable m_done_cv;
+
+	WavefrontTask *m_task;
+	unsigned m_generation;
+	unsigned m_active;
+	bool m_quit;
+
+	void start() noexcept;
+
+	void worker_main() noexcept;
+public:
+	/**
+	 * Initialize the pool.
+	 *
+	 * @param num_threads total number of threads, including the caller
+	 */
+	explicit WavefrontPool(unsigned num_threads);
+
+	WavefrontPool(const WavefrontPool &) = delete;
+
+	~WavefrontPool();
+
+	WavefrontPool &operator=(const WavefrontPool &) = delete;
+
+	unsigned num_threads() const noexcept { return m_num_threads; }
+
+	void run(unsigned num_blocks, block_func func, void *user) noexcept override;
+};
+
+/**
+ * Sets the executor of the current thread for the lifetime of the object.
+ */
+class WavefrontScope {
+	WavefrontExecutor *m_prev;
+public:
+	/**
+	 * Install an executor.
+	 *
+	 * @param executor executor, or nullptr to run blocks serially
+	 */
+	explicit WavefrontScope(WavefrontExecutor *executor) noexcept;
+
+	WavefrontScope(const WavefrontScope &) = delete;
+
+	~WavefrontScope();
+
+	WavefrontScope &operator=(const WavefrontScope &) = delete;
+};
+
+/**
+ * Process blocks [0, num_blocks) with the executor of the current thread.
+ *
+ * Without an executor, the blocks run serially on the calling thread.
+ *
+ * @see WavefrontExecutor::run
+ */
+void wavefront_run(unsigned num_blocks, WavefrontExecutor::block_func func, void *user) noexcept;
+
+template <class F>
+void wavefront_run(unsigned num_blocks, F f) noexcept
+{
+	wavefront_run(num_blocks, [](void *user, unsigned n, const WavefrontSync &sync) { (*static_cast<F *>(user))(n, sync); }, &f);
+}
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_DEPTH_WAVEFRONT_H_
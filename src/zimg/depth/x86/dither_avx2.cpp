@@ -158,6 +158,19 @@ inline FORCE_INLINE void ordered_dither_avx2_impl(const float *dither, unsigned
 #undef XARGS
 }
 
+
+inline FORCE_INLINE __m256 counter_noise_avx2_xiter(__m256i x, const __m256i &key, const __m256i &mul1, const __m256i &mul2, const __m256 &scale, const __m256 &offset)
+{
+	x = _mm256_xor_si256(x, key);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	x = _mm256_mullo_epi32(x, mul1);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+	x = _mm256_mullo_epi32(x, mul2);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+
+	return _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), scale), offset);
+}
+
 } // namespace
 
 
@@ -209,6 +222,25 @@ void ordered_dither_f2w_avx2(const float *dither, unsigned dither_offset, unsign
 	ordered_dither_avx2_impl<LoadF32, StoreU16>(dither, dither_offset, dither_mask, src, dst, scale, offset, bits, left, right);
 }
 
+
+void counter_noise_avx2(uint32_t key, float *dst, unsigned left, unsigned right)
+{
+	const __m256i key_epi32 = _mm256_set1_epi32(key);
+	const __m256i mul1 = _mm256_set1_epi32(DITHER_COUNTER_MUL1);
+	const __m256i mul2 = _mm256_set1_epi32(DITHER_COUNTER_MUL2);
+	const __m256i step = _mm256_set1_epi32(DITHER_COUNTER_STEP * 8);
+	const __m256 scale = _mm256_set1_ps(1.0f / (1UL << 24));
+	const __m256 offset = _mm256_set1_ps(0.5f - 1.0f / (1UL << 25));
+
+	// The counter of each column is advanced by addition.
+	__m256i ctr = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(left), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)), _mm256_set1_epi32(DITHER_COUNTER_STEP));
+
+	for (unsigned j = left; j < right; j += 8) {
+		_mm256_store_ps(dst + j, counter_noise_avx2_xiter(ctr, key_epi32, mul1, mul2, scale, offset));
+		ctr = _mm256_add_epi32(ctr, step);
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
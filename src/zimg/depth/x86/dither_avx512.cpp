@@ -13,12 +13,16 @@ namespace depth {
 
 namespace {
 
+// Unmasked AVX-512 conversions and shifts pass an undefined vector as their
+// pass-through operand, which GCC 12 reports as maybe-uninitialized. Use the
+// zero-masked forms with a full mask instead.
+
 struct LoadU8 {
 	typedef uint8_t type;
 
 	static inline FORCE_INLINE __m512 load16(const uint8_t *ptr)
 	{
-		return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_load_si128((const __m128i *)ptr)));
+		return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepu8_epi32(0xFFFF, _mm_load_si128((const __m128i *)ptr)));
 	}
 };
 
@@ -27,7 +31,7 @@ struct LoadU16 {
 
 	static inline FORCE_INLINE __m512 load16(const uint16_t *ptr)
 	{
-		return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_load_si256((const __m256i *)ptr)));
+		return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepu16_epi32(0xFFFF, _mm256_load_si256((const __m256i *)ptr)));
 
 	}
 };
@@ -37,7 +41,7 @@ struct LoadF16 {
 
 	static inline FORCE_INLINE __m512 load16(const uint16_t *ptr)
 	{
-		return _mm512_cvtph_ps(_mm256_load_si256((const __m256i *)ptr));
+		return _mm512_maskz_cvtph_ps(0xFFFF, _mm256_load_si256((const __m256i *)ptr));
 	}
 };
 
@@ -55,7 +59,7 @@ struct StoreU8 {
 
 	static inline FORCE_INLINE void mask_store16(uint8_t *ptr, __mmask16 mask, __m512i x)
 	{
-		_mm_mask_storeu_epi8(ptr, mask, _mm512_cvtusepi32_epi8(x));
+		_mm_mask_storeu_epi8(ptr, mask, _mm512_maskz_cvtusepi32_epi8(0xFFFF, x));
 	}
 };
 
@@ -64,7 +68,7 @@ struct StoreU16 {
 
 	static inline FORCE_INLINE void mask_store16(uint16_t *ptr, __mmask16 mask, __m512i x)
 	{
-		_mm256_mask_storeu_epi16(ptr, mask, _mm512_cvtusepi32_epi16(x));
+		_mm256_mask_storeu_epi16(ptr, mask, _mm512_maskz_cvtusepi32_epi16(0xFFFF, x));
 	}
 };
 
@@ -77,9 +81,9 @@ inline FORCE_INLINE __m512i ordered_dither_avx512_xiter(__m512 x, unsigned j, co
 
 	x = _mm512_fmadd_ps(scale, x, offset);
 	x = _mm512_add_ps(x, dith);
-	out = _mm512_cvtps_epi32(x);
-	out = _mm512_min_epi32(out, out_max);
-	out = _mm512_max_epi32(out, _mm512_setzero_si512());
+	out = _mm512_maskz_cvtps_epi32(0xFFFF, x);
+	out = _mm512_maskz_min_epi32(0xFFFF, out, out_max);
+	out = _mm512_maskz_max_epi32(0xFFFF, out, _mm512_setzero_si512());
 
 	return out;
 }
@@ -122,6 +126,19 @@ inline FORCE_INLINE void ordered_dither_avx512_impl(const float *dither, unsigne
 #undef XARGS
 }
 
+
+inline FORCE_INLINE __m512 counter_noise_avx512_xiter(__m512i x, const __m512i &key, const __m512i &mul1, const __m512i &mul2, const __m512 &scale, const __m512 &offset)
+{
+	x = _mm512_xor_si512(x, key);
+	x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xFFFF, x, 16));
+	x = _mm512_mullo_epi32(x, mul1);
+	x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xFFFF, x, 15));
+	x = _mm512_mullo_epi32(x, mul2);
+	x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xFFFF, x, 16));
+
+	return _mm512_sub_ps(_mm512_mul_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_srli_epi32(0xFFFF, x, 8)), scale), offset);
+}
+
 } // namespace
 
 
@@ -173,6 +190,25 @@ void ordered_dither_f2w_avx512(const float *dither, unsigned dither_offset, unsi
 	ordered_dither_avx512_impl<LoadF32, StoreU16>(dither, dither_offset, dither_mask, src, dst, scale, offset, bits, left, right);
 }
 
+
+void counter_noise_avx512(uint32_t key, float *dst, unsigned left, unsigned right)
+{
+	const __m512i key_epi32 = _mm512_set1_epi32(key);
+	const __m512i mul1 = _mm512_set1_epi32(DITHER_COUNTER_MUL1);
+	const __m512i mul2 = _mm512_set1_epi32(DITHER_COUNTER_MUL2);
+	const __m512i step = _mm512_set1_epi32(DITHER_COUNTER_STEP * 16);
+	const __m512 scale = _mm512_set1_ps(1.0f / (1UL << 24));
+	const __m512 offset = _mm512_set1_ps(0.5f - 1.0f / (1UL << 25));
+
+	// The counter of each column is advanced by addition.
+	__m512i ctr = _mm512_mullo_epi32(_mm512_add_epi32(_mm512_set1_epi32(left), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)), _mm512_set1_epi32(DITHER_COUNTER_STEP));
+
+	for (unsigned j = left; j < right; j += 16) {
+		_mm512_store_ps(dst + j, counter_noise_avx512_xiter(ctr, key_epi32, mul1, mul2, scale, offset));
+		ctr = _mm512_add_epi32(ctr, step);
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
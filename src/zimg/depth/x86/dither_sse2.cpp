@@ -265,6 +265,30 @@ inline FORCE_INLINE __m128i ordered_dither_f2w_sse2_xiter(unsigned j, const floa
 	return x;
 }
 
+
+// Multiply the packed 32-bit integers in [a] and [b], keeping the low 32 bits.
+inline FORCE_INLINE __m128i mm_mullo_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	even = _mm_shuffle_epi32(even, _MM_SHUFFLE(2, 0, 2, 0));
+	odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(2, 0, 2, 0));
+	return _mm_unpacklo_epi32(even, odd);
+}
+
+inline FORCE_INLINE __m128 counter_noise_sse2_xiter(__m128i x, const __m128i &key, const __m128i &mul1, const __m128i &mul2, const __m128 &scale, const __m128 &offset)
+{
+	x = _mm_xor_si128(x, key);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+	x = mm_mullo_epi32_sse2(x, mul1);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+	x = mm_mullo_epi32_sse2(x, mul2);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+
+	return _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), scale), offset);
+}
+
 } // namespace
 
 
@@ -483,6 +507,25 @@ void ordered_dither_f2w_sse2(const float *dither, unsigned dither_offset, unsign
 #undef XARGS
 }
 
+
+void counter_noise_sse2(uint32_t key, float *dst, unsigned left, unsigned right)
+{
+	const __m128i key_epi32 = _mm_set1_epi32(key);
+	const __m128i mul1 = _mm_set1_epi32(DITHER_COUNTER_MUL1);
+	const __m128i mul2 = _mm_set1_epi32(DITHER_COUNTER_MUL2);
+	const __m128i step = _mm_set1_epi32(DITHER_COUNTER_STEP * 4);
+	const __m128 scale = _mm_set1_ps(1.0f / (1UL << 24));
+	const __m128 offset = _mm_set1_ps(0.5f - 1.0f / (1UL << 25));
+
+	// The counter of each column is advanced by addition.
+	__m128i ctr = _mm_setr_epi32(left * DITHER_COUNTER_STEP, (left + 1) * DITHER_COUNTER_STEP, (left + 2) * DITHER_COUNTER_STEP, (left + 3) * DITHER_COUNTER_STEP);
+
+	for (unsigned j = left; j < right; j += 4) {
+		_mm_store_ps(dst + j, counter_noise_sse2_xiter(ctr, key_epi32, mul1, mul2, scale, offset));
+		ctr = _mm_add_epi32(ctr, step);
+	}
+}
+
 } // namespace depth
 } // namespace zimg
 
@@ -130,6 +130,34 @@ dither_f16c_func select_dither_f16c_func_x86(CPUClass cpu)
 	return func;
 }
 
+dither_noise_func select_dither_noise_func_x86(CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	dither_noise_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu == CPUClass::AUTO_64B && caps.avx512f)
+			func = counter_noise_avx512;
+#endif
+		if (!func && caps.avx2)
+			func = counter_noise_avx2;
+		if (!func && caps.sse2)
+			func = counter_noise_sse2;
+	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!func && cpu >= CPUClass::X86_AVX512)
+			func = counter_noise_avx512;
+#endif
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = counter_noise_avx2;
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = counter_noise_sse2;
+	}
+
+	return func;
+}
+
 bool needs_dither_f16c_func_x86(CPUClass cpu)
 {
 	X86Capabilities caps = query_x86_capabilities();
@@ -140,21 +168,29 @@ bool needs_dither_f16c_func_x86(CPUClass cpu)
 		return cpu < CPUClass::X86_AVX2;
 }
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graphengine::Filter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads)
 {
 	X86Capabilities caps = query_x86_capabilities();
 	std::unique_ptr<graphengine::Filter> ret;
 
 	if (cpu_is_autodetect(cpu)) {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu == CPUClass::AUTO_64B && caps.avx512f && caps.avx512bw && caps.avx512vl)
+			ret = create_error_diffusion_avx512(width, height, pixel_in, pixel_out, threads);
+#endif
 		if (!ret && caps.avx2 && caps.f16c && caps.fma)
-			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out);
+			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out, threads);
 		if (!ret && caps.sse2)
-			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu);
+			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu, threads);
 	} else {
+#ifdef ZIMG_X86_AVX512
+		if (!ret && cpu >= CPUClass::X86_AVX512)
+			ret = create_error_diffusion_avx512(width, height, pixel_in, pixel_out, threads);
+#endif
 		if (!ret && cpu >= CPUClass::X86_AVX2)
-			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out);
+			ret = create_error_diffusion_avx2(width, height, pixel_in, pixel_out, threads);
 		if (!ret && cpu >= CPUClass::X86_SSE2)
-			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu);
+			ret = create_error_diffusion_sse2(width, height, pixel_in, pixel_out, cpu, threads);
 	}
 
 	return ret;
@@ -46,16 +46,23 @@ DECLARE_ORDERED_DITHER(f2w, avx512)
 
 #undef DECLARE_ORDERED_DITHER
 
+void counter_noise_sse2(uint32_t key, float *dst, unsigned left, unsigned right);
+void counter_noise_avx2(uint32_t key, float *dst, unsigned left, unsigned right);
+void counter_noise_avx512(uint32_t key, float *dst, unsigned left, unsigned right);
+
 dither_convert_func select_ordered_dither_func_x86(const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
 
 dither_f16c_func select_dither_f16c_func_x86(CPUClass cpu);
 
+dither_noise_func select_dither_noise_func_x86(CPUClass cpu);
+
 bool needs_dither_f16c_func_x86(CPUClass cpu);
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
-std::unique_ptr<graphengine::Filter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out);
+std::unique_ptr<graphengine::Filter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads);
+std::unique_ptr<graphengine::Filter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads);
+std::unique_ptr<graphengine::Filter> create_error_diffusion_avx512(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads);
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu);
+std::unique_ptr<graphengine::Filter> create_error_diffusion_x86(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads);
 
 } // namespace depth
 } // namespace zimg
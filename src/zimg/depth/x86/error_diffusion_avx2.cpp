@@ -13,6 +13,7 @@
 #include "common/pixel.h"
 #include "common/zassert.h"
 #include "depth/quantize.h"
+#include "depth/wavefront.h"
 #include "graph/filter_base.h"
 #include "dither_x86.h"
 
@@ -234,7 +235,7 @@ inline FORCE_INLINE void error_diffusion_wf_avx2_xiter(__m256 &v, unsigned j, co
 
 template <PixelType SrcType, PixelType DstType, class T, class U>
 void error_diffusion_wf_avx2(const Buffer<const T> &src, const Buffer<U> &dst, unsigned i,
-                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned width)
+                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned left, unsigned right)
 {
 	typedef error_diffusion_traits<SrcType> src_traits;
 	typedef error_diffusion_traits<DstType> dst_traits;
@@ -262,7 +263,7 @@ void error_diffusion_wf_avx2(const Buffer<const T> &src, const Buffer<U> &dst, u
 
 #define XITER error_diffusion_wf_avx2_xiter
 #define XARGS error_top, error_cur, max_val, err_left_w, err_top_right_w, err_top_w, err_top_left_w, err_left, err_top_right, err_top, err_top_left
-	for (unsigned j = 0; j < width; j += 8) {
+	for (unsigned j = left; j < right; j += 8) {
 		__m256 v0 = src_traits::load8(src[i + 0] + j + 14);
 		__m256 v1 = src_traits::load8(src[i + 1] + j + 12);
 		__m256 v2 = src_traits::load8(src[i + 2] + j + 10);
@@ -314,7 +315,7 @@ void error_diffusion_wf_avx2(const Buffer<const T> &src, const Buffer<U> &dst, u
 
 template <PixelType SrcType, PixelType DstType>
 void error_diffusion_avx2(const Buffer<const void> &src_, const Buffer<void> &dst_, unsigned i,
-                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width)
+                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width, const WavefrontSync *sync)
 {
 	typedef error_diffusion_traits<SrcType> src_traits;
 	typedef error_diffusion_traits<DstType> dst_traits;
@@ -329,6 +330,7 @@ void error_diffusion_avx2(const Buffer<const void> &src_, const Buffer<void> &ds
 	float error_tmp[7][24] = {};
 
 	// Prologue.
+	wavefront_wait(sync, std::min(17U, width));
 	error_diffusion_scalar<SrcType, DstType>(src[i + 0], dst[i + 0], error_top, error_tmp[0], scale, offset, bits, 14);
 	error_diffusion_scalar<SrcType, DstType>(src[i + 1], dst[i + 1], error_tmp[0], error_tmp[1], scale, offset, bits, 12);
 	error_diffusion_scalar<SrcType, DstType>(src[i + 2], dst[i + 2], error_tmp[1], error_tmp[2], scale, offset, bits, 10);
@@ -374,8 +376,16 @@ void error_diffusion_avx2(const Buffer<const void> &src_, const Buffer<void> &ds
 	state.err_top_left[6] = error_tmp[5][1 + 1];
 	state.err_top_left[7] = 0.0f;
 
+	// The first row leads the last row by 14 columns.
 	unsigned vec_count = floor_n(width - 14, 8);
-	error_diffusion_wf_avx2<SrcType, DstType>(src, dst, i, error_top, error_cur, &state, scale, offset, bits, vec_count);
+
+	for (unsigned j = 0; j < vec_count; j += WAVEFRONT_CHUNK) {
+		unsigned j_end = std::min(j + WAVEFRONT_CHUNK, vec_count);
+
+		wavefront_wait(sync, std::min(j_end + 17, width));
+		error_diffusion_wf_avx2<SrcType, DstType>(src, dst, i, error_top, error_cur, &state, scale, offset, bits, j, j_end);
+		wavefront_signal(sync, j_end);
+	}
 
 	error_tmp[0][13 + 1] = state.err_top_right[1];
 	error_tmp[0][12 + 1] = state.err_top[1];
@@ -406,6 +416,7 @@ void error_diffusion_avx2(const Buffer<const void> &src_, const Buffer<void> &ds
 	error_tmp[6][0] = state.err_top_left[7];
 
 	// Epilogue.
+	wavefront_wait(sync, width);
 	error_diffusion_scalar<SrcType, DstType>(src[i + 0] + vec_count + 14, dst[i + 0] + vec_count + 14, error_top + vec_count + 14, error_tmp[0] + 14,
 	                                         scale, offset, bits, width - vec_count - 14);
 	error_diffusion_scalar<SrcType, DstType>(src[i + 1] + vec_count + 12, dst[i + 1] + vec_count + 12, error_tmp[0] + 12, error_tmp[1] + 12,
@@ -422,6 +433,7 @@ void error_diffusion_avx2(const Buffer<const void> &src_, const Buffer<void> &ds
 	                                         scale, offset, bits, width - vec_count - 2);
 	error_diffusion_scalar<SrcType, DstType>(src[i + 7] + vec_count + 0, dst[i + 7] + vec_count + 0, error_tmp[6] + 0, error_cur + vec_count + 0,
 	                                         scale, offset, bits, width - vec_count - 0);
+	wavefront_signal(sync, width);
 }
 
 auto select_error_diffusion_avx2_func(PixelType pixel_in, PixelType pixel_out)
@@ -450,36 +462,38 @@ auto select_error_diffusion_avx2_func(PixelType pixel_in, PixelType pixel_out)
 class ErrorDiffusionAVX2 : public graph::FilterBase {
 	decltype(select_error_diffusion_scalar_func({}, {})) m_scalar_func;
 	decltype(select_error_diffusion_avx2_func({}, {})) m_avx2_func;
+	unsigned m_num_blocks;
 
 	float m_scale;
 	float m_offset;
 	unsigned m_depth;
 
-	void process_scalar(void *ctx, const void *src, void *dst, bool parity) const
+	float *error_row(void *ctx, unsigned n) const
 	{
-		float *ctx_a = reinterpret_cast<float *>(ctx);
-		float *ctx_b = reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + m_desc.context_size / 2);
+		size_t row_size = m_desc.context_size / (m_num_blocks + 1);
+		return reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + row_size * (n % (m_num_blocks + 1)));
+	}
 
-		float *error_top = parity ? ctx_a : ctx_b;
-		float *error_cur = parity ? ctx_b : ctx_a;
+	void process_scalar(void *ctx, const void *src, void *dst, unsigned n) const
+	{
+		float *error_top = error_row(ctx, n + m_num_blocks);
+		float *error_cur = error_row(ctx, n);
 
 		m_scalar_func(src, dst, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
 	}
 
-	void process_vector(void *ctx, const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out, unsigned i) const
+	void process_vector(void *ctx, const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out, unsigned i, const WavefrontSync *sync) const
 	{
-		float *ctx_a = reinterpret_cast<float *>(ctx);
-		float *ctx_b = reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + m_desc.context_size / 2);
+		float *error_top = error_row(ctx, i / 8 + m_num_blocks);
+		float *error_cur = error_row(ctx, i / 8);
 
-		float *error_top = (i / 8) % 2 ? ctx_a : ctx_b;
-		float *error_cur = (i / 8) % 2 ? ctx_b : ctx_a;
-
-		m_avx2_func(*in, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
+		m_avx2_func(*in, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width, sync);
 	}
 public:
-	ErrorDiffusionAVX2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out) try :
+	ErrorDiffusionAVX2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads) try :
 		m_scalar_func{ select_error_diffusion_scalar_func(pixel_in.type, pixel_out.type) },
 		m_avx2_func{ select_error_diffusion_avx2_func(pixel_in.type, pixel_out.type) },
+		m_num_blocks{ wavefront_num_blocks(threads, height, 8) },
 		m_scale{},
 		m_offset{},
 		m_depth{ pixel_out.depth }
@@ -493,8 +507,9 @@ public:
 		m_desc.format = { width, height, pixel_size(pixel_out.type) };
 		m_desc.num_deps = 1;
 		m_desc.num_planes = 1;
-		m_desc.step = 8;
-		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * 2).get();
+		m_desc.step = 8 * m_num_blocks;
+		// Each block of rows reads the errors of the block above from a ring.
+		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * (m_num_blocks + 1)).get();
 
 		m_desc.flags.stateful = 1;
 		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(pixel_out.type);
@@ -507,7 +522,7 @@ public:
 
 	pair_unsigned get_row_deps(unsigned i) const noexcept override
 	{
-		unsigned last = std::min(i, UINT_MAX - 8) + 8;
+		unsigned last = std::min(i, UINT_MAX - m_desc.step) + m_desc.step;
 		return{ i, std::min(last, m_desc.format.height) };
 	}
 
@@ -524,15 +539,19 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *context, void *) const noexcept override
 	{
-		if (m_desc.format.height - i < 8) {
-			bool parity = !!((i / 8) % 2);
-
-			for (unsigned ii = i; ii < m_desc.format.height; ++ii) {
-				process_scalar(context, in->get_line(ii), out->get_line(ii), parity);
-				parity = !parity;
-			}
-		} else {
-			process_vector(context, in, out, i);
+		unsigned num_rows = std::min(m_desc.format.height - i, m_desc.step);
+		unsigned num_blocks = num_rows / 8;
+
+		if (num_blocks > 1)
+			wavefront_run(num_blocks, [&](unsigned n, const WavefrontSync &sync) { process_vector(context, in, out, i + n * 8, &sync); });
+		else if (num_blocks)
+			process_vector(context, in, out, i, nullptr);
+
+		// Rows at the bottom of the image are processed one at a time.
+		unsigned n = i / 8 + num_blocks;
+
+		for (unsigned ii = i + num_blocks * 8; ii < i + num_rows; ++ii) {
+			process_scalar(context, in->get_line(ii), out->get_line(ii), n++);
 		}
 	}
 };
@@ -540,12 +559,12 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out)
+std::unique_ptr<graphengine::Filter> create_error_diffusion_avx2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads)
 {
 	if (width < 14)
 		return nullptr;
 
-	return std::make_unique<ErrorDiffusionAVX2>(width, height, pixel_in, pixel_out);
+	return std::make_unique<ErrorDiffusionAVX2>(width, height, pixel_in, pixel_out, threads);
 }
 
 } // namespace depth
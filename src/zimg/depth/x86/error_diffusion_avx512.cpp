@@ -0,0 +1,541 @@
+#ifdef ZIMG_X86_AVX512
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "common/checked_int.h"
+#include "common/except.h"
+#include "common/pixel.h"
+#include "common/zassert.h"
+#include "depth/quantize.h"
+#include "depth/wavefront.h"
+#include "graph/filter_base.h"
+#include "dither_x86.h"
+
+#include "common/x86/avx512_util.h"
+
+namespace zimg {
+namespace depth {
+
+namespace {
+
+template <class T>
+struct Buffer {
+	const graphengine::BufferDescriptor &buffer;
+
+	Buffer(const graphengine::BufferDescriptor &buffer) : buffer{ buffer } {}
+
+	T *operator[](unsigned i) const { return buffer.get_line<T>(i); }
+};
+
+
+struct error_state {
+	float err_left[16];
+	float err_top_right[16];
+	float err_top[16];
+	float err_top_left[16];
+};
+
+
+template <PixelType SrcType>
+struct error_diffusion_traits;
+
+template <>
+struct error_diffusion_traits<PixelType::BYTE> {
+	typedef uint8_t type;
+
+	static float load1(const uint8_t *ptr) { return *ptr; }
+	static void store1(uint8_t *ptr, uint32_t x) { *ptr = static_cast<uint8_t>(x); }
+
+	static __m512 load16(const uint8_t *ptr)
+	{
+		return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepu8_epi32(0xFFFF, _mm_loadu_si128((const __m128i *)ptr)));
+	}
+
+	static void store16(uint8_t *ptr, __m512i x)
+	{
+		_mm_storeu_si128((__m128i *)ptr, _mm512_maskz_cvtusepi32_epi8(0xFFFF, x));
+	}
+};
+
+template <>
+struct error_diffusion_traits<PixelType::WORD> {
+	typedef uint16_t type;
+
+	static float load1(const uint16_t *ptr) { return *ptr; }
+	static void store1(uint16_t *ptr, uint32_t x) { *ptr = static_cast<uint32_t>(x); }
+
+	static __m512 load16(const uint16_t *ptr)
+	{
+		return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_maskz_cvtepu16_epi32(0xFFFF, _mm256_loadu_si256((const __m256i *)ptr)));
+	}
+
+	static void store16(uint16_t *ptr, __m512i x)
+	{
+		_mm256_storeu_si256((__m256i *)ptr, _mm512_maskz_cvtusepi32_epi16(0xFFFF, x));
+	}
+};
+
+template <>
+struct error_diffusion_traits<PixelType::HALF> {
+	typedef uint16_t type;
+
+	static float load1(const uint16_t *ptr)
+	{
+		return _mm_cvtss_f32(_mm_maskz_cvtph_ps(1, _mm_cvtsi32_si128(*ptr)));
+	}
+
+	static __m512 load16(const uint16_t *ptr) {
+		return _mm512_maskz_cvtph_ps(0xFFFF, _mm256_loadu_si256((const __m256i *)ptr));
+	}
+};
+
+template <>
+struct error_diffusion_traits<PixelType::FLOAT> {
+	typedef float type;
+
+	static float load1(const float *ptr) { return *ptr; }
+	static __m512 load16(const float *ptr) { return _mm512_loadu_ps(ptr); }
+};
+
+
+inline FORCE_INLINE float fma(float a, float b, float c)
+{
+	return _mm_cvtss_f32(_mm_mask_fmadd_ss(_mm_set_ss(a), 1, _mm_set_ss(b), _mm_set_ss(c)));
+}
+
+inline FORCE_INLINE float max(float x, float y)
+{
+	return _mm_cvtss_f32(_mm_max_ss(_mm_set_ss(x), _mm_set_ss(y)));
+}
+
+inline FORCE_INLINE float min(float x, float y)
+{
+	return _mm_cvtss_f32(_mm_min_ss(_mm_set_ss(x), _mm_set_ss(y)));
+}
+
+
+template <PixelType SrcType, PixelType DstType>
+void error_diffusion_scalar(const void *src, void *dst, const float * RESTRICT error_top, float * RESTRICT error_cur,
+                            float scale, float offset, unsigned bits, unsigned width)
+{
+	typedef error_diffusion_traits<SrcType> src_traits;
+	typedef error_diffusion_traits<DstType> dst_traits;
+
+	const typename src_traits::type *src_p = static_cast<const typename src_traits::type *>(src);
+	typename dst_traits::type *dst_p = static_cast<typename dst_traits::type *>(dst);
+
+	float err_left = error_cur[0];
+	float err_top_right;
+	float err_top = error_top[0 + 1];
+	float err_top_left = error_top[0];
+
+	for (unsigned j = 0; j < width; ++j) {
+		// Error array is padded by one on each side.
+		unsigned j_err = j + 1;
+		err_top_right = error_top[j_err + 1];
+
+		float x = fma(src_traits::load1(src_p + j), scale, offset);
+		float err, err0, err1;
+
+		err0 = err_left * (7.0f / 16.0f);
+		err0 = fma(err_top_right, 3.0f / 16.0f, err0);
+		err1 = err_top * (5.0f / 16.0f);
+		err1 = fma(err_top_left, 1.0f / 16.0f, err1);
+		err = err0 + err1;
+
+		x += err;
+		x = min(max(x, 0.0f), static_cast<float>(1L << bits) - 1);
+
+		uint32_t q = _mm_cvt_ss2si(_mm_set_ss(x));
+		err = x - static_cast<float>(q);
+
+		dst_traits::store1(dst_p + j, q);
+		error_cur[j_err] = err;
+
+		err_left = err;
+		err_top_left = err_top;
+		err_top = err_top_right;
+	}
+}
+
+auto select_error_diffusion_scalar_func(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
+		return error_diffusion_scalar<PixelType::BYTE, PixelType::BYTE>;
+	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
+		return error_diffusion_scalar<PixelType::BYTE, PixelType::WORD>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
+		return error_diffusion_scalar<PixelType::WORD, PixelType::BYTE>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
+		return error_diffusion_scalar<PixelType::WORD, PixelType::WORD>;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
+		return error_diffusion_scalar<PixelType::HALF, PixelType::BYTE>;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
+		return error_diffusion_scalar<PixelType::HALF, PixelType::WORD>;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return error_diffusion_scalar<PixelType::FLOAT, PixelType::BYTE>;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return error_diffusion_scalar<PixelType::FLOAT, PixelType::WORD>;
+	else
+		error::throw_<error::InternalError>("no conversion between pixel types");
+}
+
+
+inline FORCE_INLINE void error_diffusion_wf_avx512_xiter(__m512 &v, unsigned j, const float *error_top, float *error_cur, const __m512 &max_val,
+                                                         const __m512 &err_left_w, const __m512 &err_top_right_w, const __m512 &err_top_w, const __m512 &err_top_left_w,
+                                                         __m512 &err_left, __m512 &err_top_right, __m512 &err_top, __m512 &err_top_left)
+{
+	const __m512i rot_mask = _mm512_set_epi32(14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15);
+
+	unsigned j_err = j + 1;
+
+	__m512 err0 = _mm512_mul_ps(err_left_w, err_left);
+	err0 = _mm512_fmadd_ps(err_top_right_w, err_top_right, err0);
+	__m512 err1 = _mm512_mul_ps(err_top_w, err_top);
+	err1 = _mm512_fmadd_ps(err_top_left_w, err_top_left, err1);
+	err0 = _mm512_add_ps(err0, err1);
+
+	__m512 x = _mm512_add_ps(v, err0);
+	x = _mm512_maskz_max_ps(0xFFFF, x, _mm512_setzero_ps());
+	x = _mm512_maskz_min_ps(0xFFFF, x, max_val);
+	__m512i q = _mm512_maskz_cvtps_epi32(0xFFFF, x);
+	v = _mm512_castsi512_ps(q);
+
+	// Equal to x - round(x), without waiting for the conversion to integer.
+	err0 = _mm512_reduce_ps(x, 0);
+
+	// Left-rotate err0 by 32 bits.
+	__m512 err_rot = _mm512_maskz_permutexvar_ps(0xFFFF, rot_mask, err0);
+
+	// Extract the previous high error.
+	error_cur[j_err + 0] = _mm512_cvtss_f32(err_rot);
+
+	// Insert the next error into the low position.
+	err_rot = _mm512_mask_mov_ps(err_rot, 1, _mm512_castps128_ps512(_mm_set_ss(error_top[j_err + 30 + 2])));
+
+	err_left = err0;
+	err_top_left = err_top;
+	err_top = err_top_right;
+	err_top_right = err_rot;
+}
+
+template <PixelType SrcType, PixelType DstType, class T, class U>
+void error_diffusion_wf_avx512(const Buffer<const T> &src, const Buffer<U> &dst, unsigned i,
+                               const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned left, unsigned right)
+{
+	typedef error_diffusion_traits<SrcType> src_traits;
+	typedef error_diffusion_traits<DstType> dst_traits;
+
+	typedef typename src_traits::type src_type;
+	typedef typename dst_traits::type dst_type;
+
+	static_assert(std::is_same<T, src_type>::value, "wrong type");
+	static_assert(std::is_same<U, dst_type>::value, "wrong type");
+
+	const __m512 err_left_w = _mm512_set1_ps(7.0f / 16.0f);
+	const __m512 err_top_right_w = _mm512_set1_ps(3.0f / 16.0f);
+	const __m512 err_top_w = _mm512_set1_ps(5.0f / 16.0f);
+	const __m512 err_top_left_w = _mm512_set1_ps(1.0f / 16.0f);
+
+	const __m512 scale_ps = _mm512_set1_ps(scale);
+	const __m512 offset_ps = _mm512_set1_ps(offset);
+
+	const __m512 max_val = _mm512_set1_ps(static_cast<float>((1UL << bits) - 1));
+
+	__m512 err_left = _mm512_load_ps(state->err_left);
+	__m512 err_top_right = _mm512_load_ps(state->err_top_right);
+	__m512 err_top = _mm512_load_ps(state->err_top);
+	__m512 err_top_left = _mm512_load_ps(state->err_top_left);
+
+#define XITER error_diffusion_wf_avx512_xiter
+#define XARGS error_top, error_cur, max_val, err_left_w, err_top_right_w, err_top_w, err_top_left_w, err_left, err_top_right, err_top, err_top_left
+	for (unsigned j = left; j < right; j += 16) {
+		__m512 v0 = src_traits::load16(src[i + 0] + j + 30);
+		__m512 v1 = src_traits::load16(src[i + 1] + j + 28);
+		__m512 v2 = src_traits::load16(src[i + 2] + j + 26);
+		__m512 v3 = src_traits::load16(src[i + 3] + j + 24);
+		__m512 v4 = src_traits::load16(src[i + 4] + j + 22);
+		__m512 v5 = src_traits::load16(src[i + 5] + j + 20);
+		__m512 v6 = src_traits::load16(src[i + 6] + j + 18);
+		__m512 v7 = src_traits::load16(src[i + 7] + j + 16);
+		__m512 v8 = src_traits::load16(src[i + 8] + j + 14);
+		__m512 v9 = src_traits::load16(src[i + 9] + j + 12);
+		__m512 v10 = src_traits::load16(src[i + 10] + j + 10);
+		__m512 v11 = src_traits::load16(src[i + 11] + j + 8);
+		__m512 v12 = src_traits::load16(src[i + 12] + j + 6);
+		__m512 v13 = src_traits::load16(src[i + 13] + j + 4);
+		__m512 v14 = src_traits::load16(src[i + 14] + j + 2);
+		__m512 v15 = src_traits::load16(src[i + 15] + j + 0);
+
+		v0 = _mm512_fmadd_ps(v0, scale_ps, offset_ps);
+		v1 = _mm512_fmadd_ps(v1, scale_ps, offset_ps);
+		v2 = _mm512_fmadd_ps(v2, scale_ps, offset_ps);
+		v3 = _mm512_fmadd_ps(v3, scale_ps, offset_ps);
+		v4 = _mm512_fmadd_ps(v4, scale_ps, offset_ps);
+		v5 = _mm512_fmadd_ps(v5, scale_ps, offset_ps);
+		v6 = _mm512_fmadd_ps(v6, scale_ps, offset_ps);
+		v7 = _mm512_fmadd_ps(v7, scale_ps, offset_ps);
+		v8 = _mm512_fmadd_ps(v8, scale_ps, offset_ps);
+		v9 = _mm512_fmadd_ps(v9, scale_ps, offset_ps);
+		v10 = _mm512_fmadd_ps(v10, scale_ps, offset_ps);
+		v11 = _mm512_fmadd_ps(v11, scale_ps, offset_ps);
+		v12 = _mm512_fmadd_ps(v12, scale_ps, offset_ps);
+		v13 = _mm512_fmadd_ps(v13, scale_ps, offset_ps);
+		v14 = _mm512_fmadd_ps(v14, scale_ps, offset_ps);
+		v15 = _mm512_fmadd_ps(v15, scale_ps, offset_ps);
+
+		mm512_transpose16_ps(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15);
+
+		XITER(v0, j + 0, XARGS);
+		XITER(v1, j + 1, XARGS);
+		XITER(v2, j + 2, XARGS);
+		XITER(v3, j + 3, XARGS);
+		XITER(v4, j + 4, XARGS);
+		XITER(v5, j + 5, XARGS);
+		XITER(v6, j + 6, XARGS);
+		XITER(v7, j + 7, XARGS);
+		XITER(v8, j + 8, XARGS);
+		XITER(v9, j + 9, XARGS);
+		XITER(v10, j + 10, XARGS);
+		XITER(v11, j + 11, XARGS);
+		XITER(v12, j + 12, XARGS);
+		XITER(v13, j + 13, XARGS);
+		XITER(v14, j + 14, XARGS);
+		XITER(v15, j + 15, XARGS);
+
+		mm512_transpose16_ps(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15);
+
+		dst_traits::store16(dst[i + 0] + j + 30, _mm512_castps_si512(v0));
+		dst_traits::store16(dst[i + 1] + j + 28, _mm512_castps_si512(v1));
+		dst_traits::store16(dst[i + 2] + j + 26, _mm512_castps_si512(v2));
+		dst_traits::store16(dst[i + 3] + j + 24, _mm512_castps_si512(v3));
+		dst_traits::store16(dst[i + 4] + j + 22, _mm512_castps_si512(v4));
+		dst_traits::store16(dst[i + 5] + j + 20, _mm512_castps_si512(v5));
+		dst_traits::store16(dst[i + 6] + j + 18, _mm512_castps_si512(v6));
+		dst_traits::store16(dst[i + 7] + j + 16, _mm512_castps_si512(v7));
+		dst_traits::store16(dst[i + 8] + j + 14, _mm512_castps_si512(v8));
+		dst_traits::store16(dst[i + 9] + j + 12, _mm512_castps_si512(v9));
+		dst_traits::store16(dst[i + 10] + j + 10, _mm512_castps_si512(v10));
+		dst_traits::store16(dst[i + 11] + j + 8, _mm512_castps_si512(v11));
+		dst_traits::store16(dst[i + 12] + j + 6, _mm512_castps_si512(v12));
+		dst_traits::store16(dst[i + 13] + j + 4, _mm512_castps_si512(v13));
+		dst_traits::store16(dst[i + 14] + j + 2, _mm512_castps_si512(v14));
+		dst_traits::store16(dst[i + 15] + j + 0, _mm512_castps_si512(v15));
+	}
+#undef XITER
+#undef XARGS
+
+	_mm512_store_ps(state->err_left, err_left);
+	_mm512_store_ps(state->err_top_right, err_top_right);
+	_mm512_store_ps(state->err_top, err_top);
+	_mm512_store_ps(state->err_top_left, err_top_left);
+}
+
+template <PixelType SrcType, PixelType DstType>
+void error_diffusion_avx512(const Buffer<const void> &src_, const Buffer<void> &dst_, unsigned i,
+                            const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width, const WavefrontSync *sync)
+{
+	typedef error_diffusion_traits<SrcType> src_traits;
+	typedef error_diffusion_traits<DstType> dst_traits;
+
+	typedef typename src_traits::type src_type;
+	typedef typename dst_traits::type dst_type;
+
+	Buffer<const src_type> src = src_.buffer;
+	Buffer<dst_type> dst = dst_.buffer;
+
+	error_state state alignas(64) = {};
+	float error_tmp[15][48] = {};
+
+	// Prologue. Row r starts 2 * (15 - r) columns ahead of the last row.
+	wavefront_wait(sync, std::min(33U, width));
+
+	for (unsigned r = 0; r < 15; ++r) {
+		const float *top = r ? error_tmp[r - 1] : error_top;
+		error_diffusion_scalar<SrcType, DstType>(src[i + r], dst[i + r], top, error_tmp[r], scale, offset, bits, 2 * (15 - r));
+	}
+
+	// Wavefront.
+	for (unsigned r = 0; r < 16; ++r) {
+		const float *top = r ? error_tmp[r - 1] : error_top;
+		unsigned w = 2 * (15 - r);
+
+		state.err_left[r] = r < 15 ? error_tmp[r][w] : 0.0f;
+		state.err_top_right[r] = top[w + 2];
+		state.err_top[r] = top[w + 1];
+		state.err_top_left[r] = top[w];
+	}
+
+	unsigned vec_count = floor_n(width - 30, 16);
+
+	for (unsigned j = 0; j < vec_count; j += WAVEFRONT_CHUNK) {
+		unsigned j_end = std::min(j + WAVEFRONT_CHUNK, vec_count);
+
+		wavefront_wait(sync, std::min(j_end + 33, width));
+		error_diffusion_wf_avx512<SrcType, DstType>(src, dst, i, error_top, error_cur, &state, scale, offset, bits, j, j_end);
+		wavefront_signal(sync, j_end);
+	}
+
+	for (unsigned r = 1; r < 16; ++r) {
+		unsigned w = 2 * (15 - r);
+
+		error_tmp[r - 1][w + 2] = state.err_top_right[r];
+		error_tmp[r - 1][w + 1] = state.err_top[r];
+		error_tmp[r - 1][w] = state.err_top_left[r];
+	}
+
+	// Epilogue.
+	wavefront_wait(sync, width);
+
+	for (unsigned r = 0; r < 16; ++r) {
+		unsigned w = 2 * (15 - r);
+		const float *top = r ? error_tmp[r - 1] + w : error_top + vec_count + w;
+		float *cur = r < 15 ? error_tmp[r] + w : error_cur + vec_count;
+
+		error_diffusion_scalar<SrcType, DstType>(src[i + r] + vec_count + w, dst[i + r] + vec_count + w, top, cur,
+		                                         scale, offset, bits, width - vec_count - w);
+	}
+	wavefront_signal(sync, width);
+}
+
+auto select_error_diffusion_avx512_func(PixelType pixel_in, PixelType pixel_out)
+{
+	if (pixel_in == PixelType::BYTE && pixel_out == PixelType::BYTE)
+		return error_diffusion_avx512<PixelType::BYTE, PixelType::BYTE>;
+	else if (pixel_in == PixelType::BYTE && pixel_out == PixelType::WORD)
+		return error_diffusion_avx512<PixelType::BYTE, PixelType::WORD>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::BYTE)
+		return error_diffusion_avx512<PixelType::WORD, PixelType::BYTE>;
+	else if (pixel_in == PixelType::WORD && pixel_out == PixelType::WORD)
+		return error_diffusion_avx512<PixelType::WORD, PixelType::WORD>;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::BYTE)
+		return error_diffusion_avx512<PixelType::HALF, PixelType::BYTE>;
+	else if (pixel_in == PixelType::HALF && pixel_out == PixelType::WORD)
+		return error_diffusion_avx512<PixelType::HALF, PixelType::WORD>;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::BYTE)
+		return error_diffusion_avx512<PixelType::FLOAT, PixelType::BYTE>;
+	else if (pixel_in == PixelType::FLOAT && pixel_out == PixelType::WORD)
+		return error_diffusion_avx512<PixelType::FLOAT, PixelType::WORD>;
+	else
+		error::throw_<error::InternalError>("no conversion between pixel types");
+}
+
+
+class ErrorDiffusionAVX512 : public graph::FilterBase {
+	decltype(select_error_diffusion_scalar_func({}, {})) m_scalar_func;
+	decltype(select_error_diffusion_avx512_func({}, {})) m_avx512_func;
+	unsigned m_num_blocks;
+
+	float m_scale;
+	float m_offset;
+	unsigned m_depth;
+
+	float *error_row(void *ctx, unsigned n) const
+	{
+		size_t row_size = m_desc.context_size / (m_num_blocks + 1);
+		return reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + row_size * (n % (m_num_blocks + 1)));
+	}
+
+	void process_scalar(void *ctx, const void *src, void *dst, unsigned n) const
+	{
+		float *error_top = error_row(ctx, n + m_num_blocks);
+		float *error_cur = error_row(ctx, n);
+
+		m_scalar_func(src, dst, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
+	}
+
+	void process_vector(void *ctx, const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out, unsigned i, const WavefrontSync *sync) const
+	{
+		float *error_top = error_row(ctx, i / 16 + m_num_blocks);
+		float *error_cur = error_row(ctx, i / 16);
+
+		m_avx512_func(*in, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width, sync);
+	}
+public:
+	ErrorDiffusionAVX512(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads) try :
+		m_scalar_func{ select_error_diffusion_scalar_func(pixel_in.type, pixel_out.type) },
+		m_avx512_func{ select_error_diffusion_avx512_func(pixel_in.type, pixel_out.type) },
+		m_num_blocks{ wavefront_num_blocks(threads, height, 16) },
+		m_scale{},
+		m_offset{},
+		m_depth{ pixel_out.depth }
+	{
+		zassert_d(width <= pixel_max_width(pixel_in.type), "overflow");
+		zassert_d(width <= pixel_max_width(pixel_out.type), "overflow");
+
+		if (!pixel_is_integer(pixel_out.type))
+			error::throw_<error::InternalError>("cannot dither to non-integer format");
+
+		m_desc.format = { width, height, pixel_size(pixel_out.type) };
+		m_desc.num_deps = 1;
+		m_desc.num_planes = 1;
+		m_desc.step = 16 * m_num_blocks;
+		// Each block of rows reads the errors of the block above from a ring.
+		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * (m_num_blocks + 1)).get();
+
+		m_desc.flags.stateful = 1;
+		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(pixel_out.type);
+		m_desc.flags.entire_row = 1;
+
+		std::tie(m_scale, m_offset) = get_scale_offset(pixel_in, pixel_out);
+	} catch (const std::overflow_error &) {
+		error::throw_<error::OutOfMemory>();
+	}
+
+	pair_unsigned get_row_deps(unsigned i) const noexcept override
+	{
+		unsigned last = std::min(i, UINT_MAX - m_desc.step) + m_desc.step;
+		return{ i, std::min(last, m_desc.format.height) };
+	}
+
+	pair_unsigned get_col_deps(unsigned, unsigned) const noexcept override
+	{
+		return{ 0, m_desc.format.width };
+	}
+
+	void init_context(void *ctx) const noexcept override
+	{
+		std::fill_n(static_cast<unsigned char *>(ctx), m_desc.context_size, 0);
+	}
+
+	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
+	             unsigned i, unsigned left, unsigned right, void *context, void *) const noexcept override
+	{
+		unsigned num_rows = std::min(m_desc.format.height - i, m_desc.step);
+		unsigned num_blocks = num_rows / 16;
+
+		if (num_blocks > 1)
+			wavefront_run(num_blocks, [&](unsigned n, const WavefrontSync &sync) { process_vector(context, in, out, i + n * 16, &sync); });
+		else if (num_blocks)
+			process_vector(context, in, out, i, nullptr);
+
+		// Rows at the bottom of the image are processed one at a time.
+		unsigned n = i / 16 + num_blocks;
+
+		for (unsigned ii = i + num_blocks * 16; ii < i + num_rows; ++ii) {
+			process_scalar(context, in->get_line(ii), out->get_line(ii), n++);
+		}
+	}
+};
+
+} // namespace
+
+
+std::unique_ptr<graphengine::Filter> create_error_diffusion_avx512(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, unsigned threads)
+{
+	if (width < 30)
+		return nullptr;
+
+	return std::make_unique<ErrorDiffusionAVX512>(width, height, pixel_in, pixel_out, threads);
+}
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_X86_AVX512
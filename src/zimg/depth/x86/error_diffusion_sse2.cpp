@@ -13,6 +13,7 @@
 #include "common/pixel.h"
 #include "common/zassert.h"
 #include "depth/quantize.h"
+#include "depth/wavefront.h"
 #include "graph/filter_base.h"
 #include "dither_x86.h"
 
@@ -200,7 +201,7 @@ inline FORCE_INLINE void error_diffusion_wf_sse2_xiter(__m128 &v, unsigned j, co
 
 template <class T, class U>
 void error_diffusion_wf_sse2(const Buffer<const T> &src, const Buffer<U> &dst, unsigned i,
-                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned width)
+                             const float *error_top, float *error_cur, error_state *state, float scale, float offset, unsigned bits, unsigned left, unsigned right)
 {
 	typedef error_diffusion_traits<T> src_traits;
 	typedef error_diffusion_traits<U> dst_traits;
@@ -232,7 +233,7 @@ void error_diffusion_wf_sse2(const Buffer<const T> &src, const Buffer<U> &dst, u
 
 #define XITER error_diffusion_wf_sse2_xiter
 #define XARGS error_top, error_cur, max_val, err_left_w, err_top_right_w, err_top_w, err_top_left_w, err_left, err_top_right, err_top, err_top_left
-	for (unsigned j = 0; j < width; j += 4) {
+	for (unsigned j = left; j < right; j += 4) {
 		__m128 v0 = src_traits::load4(src_p0 + j + 6);
 		__m128 v1 = src_traits::load4(src_p1 + j + 4);
 		__m128 v2 = src_traits::load4(src_p2 + j + 2);
@@ -268,7 +269,7 @@ void error_diffusion_wf_sse2(const Buffer<const T> &src, const Buffer<U> &dst, u
 
 template <class T, class U>
 void error_diffusion_sse2(const Buffer<const void> &src_, const Buffer<void> &dst_, unsigned i,
-                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width)
+                          const float *error_top, float *error_cur, float scale, float offset, unsigned bits, unsigned width, const WavefrontSync *sync)
 {
 	Buffer<const T> src{ src_.buffer };
 	Buffer<U> dst{ dst_.buffer };
@@ -277,6 +278,7 @@ void error_diffusion_sse2(const Buffer<const void> &src_, const Buffer<void> &ds
 	float error_tmp[3][12] = {};
 
 	// Prologue.
+	wavefront_wait(sync, std::min(9U, width));
 	error_diffusion_scalar<T, U>(src[i + 0], dst[i + 0], error_top, error_tmp[0], scale, offset, bits, 6);
 	error_diffusion_scalar<T, U>(src[i + 1], dst[i + 1], error_tmp[0], error_tmp[1], scale, offset, bits, 4);
 	error_diffusion_scalar<T, U>(src[i + 2], dst[i + 2], error_tmp[1], error_tmp[2], scale, offset, bits, 2);
@@ -302,8 +304,16 @@ void error_diffusion_sse2(const Buffer<const void> &src_, const Buffer<void> &ds
 	state.err_top_left[2] = error_tmp[1][1 + 1];
 	state.err_top_left[3] = 0.0f;
 
+	// The first row leads the last row by 6 columns.
 	unsigned vec_count = floor_n(width - 6, 4);
-	error_diffusion_wf_sse2<T, U>(src, dst, i, error_top, error_cur, &state, scale, offset, bits, vec_count);
+
+	for (unsigned j = 0; j < vec_count; j += WAVEFRONT_CHUNK) {
+		unsigned j_end = std::min(j + WAVEFRONT_CHUNK, vec_count);
+
+		wavefront_wait(sync, std::min(j_end + 9, width));
+		error_diffusion_wf_sse2<T, U>(src, dst, i, error_top, error_cur, &state, scale, offset, bits, j, j_end);
+		wavefront_signal(sync, j_end);
+	}
 
 	error_tmp[0][5 + 1] = state.err_top_right[1];
 	error_tmp[0][4 + 1] = state.err_top[1];
@@ -318,6 +328,7 @@ void error_diffusion_sse2(const Buffer<const void> &src_, const Buffer<void> &ds
 	error_tmp[2][0] = state.err_top_left[3];
 
 	// Epilogue.
+	wavefront_wait(sync, width);
 	error_diffusion_scalar<T, U>(src[i + 0] + vec_count + 6, dst[i + 0] + vec_count + 6, error_top + vec_count + 6, error_tmp[0] + 6,
 	                             scale, offset, bits, width - vec_count - 6);
 	error_diffusion_scalar<T, U>(src[i + 1] + vec_count + 4, dst[i + 1] + vec_count + 4, error_tmp[0] + 4, error_tmp[1] + 4,
@@ -326,6 +337,7 @@ void error_diffusion_sse2(const Buffer<const void> &src_, const Buffer<void> &ds
 	                             scale, offset, bits, width - vec_count - 2);
 	error_diffusion_scalar<T, U>(src[i + 3] + vec_count + 0, dst[i + 3] + vec_count + 0, error_tmp[2] + 0, error_cur + vec_count + 0,
 	                             scale, offset, bits, width - vec_count - 0);
+	wavefront_signal(sync, width);
 }
 
 auto select_error_diffusion_sse2_func(PixelType pixel_in, PixelType pixel_out)
@@ -354,18 +366,22 @@ class ErrorDiffusionSSE2 : public graph::FilterBase {
 	decltype(select_error_diffusion_scalar_func({}, {})) m_scalar_func;
 	decltype(select_error_diffusion_sse2_func({}, {})) m_sse2_func;
 	dither_f16c_func m_f16c;
+	unsigned m_num_blocks;
 
 	float m_scale;
 	float m_offset;
 	unsigned m_depth;
 
-	void process_scalar(void *ctx, const void *src, void *dst, void *tmp, bool parity) const
+	float *error_row(void *ctx, unsigned n) const
 	{
-		float *ctx_a = reinterpret_cast<float *>(ctx);
-		float *ctx_b = reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + m_desc.context_size / 2);
+		size_t row_size = m_desc.context_size / (m_num_blocks + 1);
+		return reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + row_size * (n % (m_num_blocks + 1)));
+	}
 
-		float *error_top = parity ? ctx_a : ctx_b;
-		float *error_cur = parity ? ctx_b : ctx_a;
+	void process_scalar(void *ctx, const void *src, void *dst, void *tmp, unsigned n) const
+	{
+		float *error_top = error_row(ctx, n + m_num_blocks);
+		float *error_cur = error_row(ctx, n);
 
 		if (m_f16c) {
 			m_f16c(src, tmp, 0, m_desc.format.width);
@@ -374,21 +390,31 @@ class ErrorDiffusionSSE2 : public graph::FilterBase {
 		m_scalar_func(src, dst, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
 	}
 
-	void process_vector(void *ctx, const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out, unsigned i) const
+	void process_vector(void *ctx, const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out, unsigned i, void *tmp, const WavefrontSync *sync) const
 	{
-		float *ctx_a = reinterpret_cast<float *>(ctx);
-		float *ctx_b = reinterpret_cast<float *>(static_cast<unsigned char *>(ctx) + m_desc.context_size / 2);
+		float *error_top = error_row(ctx, i / 4 + m_num_blocks);
+		float *error_cur = error_row(ctx, i / 4);
 
-		float *error_top = (i / 4) % 2 ? ctx_a : ctx_b;
-		float *error_cur = (i / 4) % 2 ? ctx_b : ctx_a;
+		if (m_f16c) {
+			float *tmp_p = static_cast<float *>(tmp);
+			ptrdiff_t tmp_stride = ceil_n(m_desc.format.width * sizeof(float), ALIGNMENT);
+
+			for (unsigned n = 0; n < 4; ++n) {
+				m_f16c(in->get_line(i + n), tmp_p + n * (tmp_stride / sizeof(float)), 0, m_desc.format.width);
+			}
 
-		m_sse2_func(*in, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width);
+			graphengine::BufferDescriptor tmp_buf{ tmp_p, tmp_stride, 0x3 };
+			m_sse2_func(tmp_buf, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width, sync);
+		} else {
+			m_sse2_func(*in, *out, i, error_top, error_cur, m_scale, m_offset, m_depth, m_desc.format.width, sync);
+		}
 	}
 public:
-	ErrorDiffusionSSE2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu) try :
+	ErrorDiffusionSSE2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads) try :
 		m_scalar_func{ select_error_diffusion_scalar_func(pixel_in.type, pixel_out.type) },
 		m_sse2_func{ select_error_diffusion_sse2_func(pixel_in.type, pixel_out.type) },
 		m_f16c{},
+		m_num_blocks{ wavefront_num_blocks(threads, height, 4) },
 		m_scale{},
 		m_offset{},
 		m_depth{ pixel_out.depth }
@@ -405,10 +431,11 @@ public:
 		m_desc.format = { width, height, pixel_size(pixel_out.type) };
 		m_desc.num_deps = 1;
 		m_desc.num_planes = 1;
-		m_desc.step = 4;
-		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * 2).get();
+		m_desc.step = 4 * m_num_blocks;
+		// Each block of rows reads the errors of the block above from a ring.
+		m_desc.context_size = ((static_cast<checked_size_t>(width) + 2) * sizeof(float) * (m_num_blocks + 1)).get();
 		if (m_f16c)
-			m_desc.scratchpad_size = (ceil_n(static_cast<checked_size_t>(width) * sizeof(float), ALIGNMENT) * 4).get();
+			m_desc.scratchpad_size = (ceil_n(static_cast<checked_size_t>(width) * sizeof(float), ALIGNMENT) * 4 * m_num_blocks).get();
 
 		m_desc.flags.stateful = 1;
 		m_desc.flags.in_place = pixel_size(pixel_in.type) == pixel_size(pixel_out.type);
@@ -421,7 +448,7 @@ public:
 
 	pair_unsigned get_row_deps(unsigned i) const noexcept override
 	{
-		unsigned last = std::min(i, UINT_MAX - 4) + 4;
+		unsigned last = std::min(i, UINT_MAX - m_desc.step) + m_desc.step;
 		return{ i, std::min(last, m_desc.format.height) };
 	}
 
@@ -438,25 +465,24 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
                  unsigned i, unsigned left, unsigned right, void *context, void *tmp) const noexcept override
 	{
-		if (m_desc.format.height - i < 4) {
-			bool parity = !!((i / 4) % 2);
-
-			for (unsigned ii = i; ii < m_desc.format.height; ++ii) {
-				process_scalar(context, in->get_line(ii), out->get_line(ii), tmp, parity);
-				parity = !parity;
-			}
-		} else if (m_f16c) {
-			float *tmp_p = static_cast<float *>(tmp);
-			ptrdiff_t tmp_stride = ceil_n(m_desc.format.width * sizeof(float), ALIGNMENT);
+		unsigned num_rows = std::min(m_desc.format.height - i, m_desc.step);
+		unsigned num_blocks = num_rows / 4;
+		size_t tmp_size = m_desc.scratchpad_size / m_num_blocks;
+
+		if (num_blocks > 1) {
+			wavefront_run(num_blocks, [&](unsigned n, const WavefrontSync &sync)
+			{
+				process_vector(context, in, out, i + n * 4, static_cast<unsigned char *>(tmp) + tmp_size * n, &sync);
+			});
+		} else if (num_blocks) {
+			process_vector(context, in, out, i, tmp, nullptr);
+		}
 
-			for (unsigned n = 0; n < 4; ++n) {
-				m_f16c(in->get_line(i + n), tmp_p + n * (tmp_stride / sizeof(float)), 0, m_desc.format.width);
-			}
+		// Rows at the bottom of the image are processed one at a time.
+		unsigned n = i / 4 + num_blocks;
 
-			graphengine::BufferDescriptor tmp_buf{ tmp_p, tmp_stride, 0x3 };
-			process_vector(context, &tmp_buf, out, i);
-		} else {
-			process_vector(context, in, out, i);
+		for (unsigned ii = i + num_blocks * 4; ii < i + num_rows; ++ii) {
+			process_scalar(context, in->get_line(ii), out->get_line(ii), tmp, n++);
 		}
 	}
 };
@@ -464,12 +490,12 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu)
+std::unique_ptr<graphengine::Filter> create_error_diffusion_sse2(unsigned width, unsigned height, const PixelFormat &pixel_in, const PixelFormat &pixel_out, CPUClass cpu, unsigned threads)
 {
 	if (width < 6)
 		return nullptr;
 
-	return std::make_unique<ErrorDiffusionSSE2>(width, height, pixel_in, pixel_out, cpu);
+	return std::make_unique<ErrorDiffusionSSE2>(width, height, pixel_in, pixel_out, cpu, threads);
 }
 
 } // namespace depth
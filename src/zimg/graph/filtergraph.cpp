@@ -1,27 +1,175 @@
 #include <algorithm>
+#include <atomic>
 #include <climits>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "common/alloc.h"
 #include "common/except.h"
 #include "common/zassert.h"
+#include "depth/wavefront.h"
 #include "graphengine/graph.h"
 #include "graphengine/types.h"
 #include "filtergraph.h"
 #include "graphengine_except.h"
+#include "profiler.h"
+#include "tilegraph.h"
 
 namespace zimg {
 namespace graph {
 
-FilterGraph::FilterGraph(std::unique_ptr<graphengine::Graph> graph, std::shared_ptr<void> instance_data, graphengine::node_id source_id, graphengine::node_id sink_id) :
+namespace {
+
+// Bands are oversubscribed to balance load between uneven workers.
+constexpr unsigned BANDS_PER_THREAD = 4;
+constexpr unsigned MIN_BAND_HEIGHT = 16;
+
+TileGraph::rect import_region(const TileGraph *graph, unsigned left, unsigned top, unsigned width, unsigned height)
+{
+	if (!graph)
+		error::throw_<error::UnsupportedOperation>("graph does not support region processing");
+	if (width > graph->output_width() || left > graph->output_width() - width || height > graph->output_height() || top > graph->output_height() - height)
+		error::throw_<error::InvalidImageSize>("region exceeds image bounds");
+
+	return{ left, top, left + width, top + height };
+}
+
+void check_full_buffers(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst)
+{
+	for (unsigned p = 0; p < 4; ++p) {
+		if ((src[p].ptr && src[p].mask != graphengine::BUFFER_MAX) || (dst[p].ptr && dst[p].mask != graphengine::BUFFER_MAX))
+			error::throw_<error::IllegalArgument>("region processing requires full image buffers");
+	}
+}
+
+struct band_task {
+	const TileGraph *graph;
+	const graphengine::BufferDescriptor *src;
+	const graphengine::BufferDescriptor *dst;
+	std::vector<TileGraph::rect> bands;
+	std::vector<AlignedVector<unsigned char>> tmp;
+	std::atomic_uint next;
+	std::mutex error_mutex;
+	std::exception_ptr error;
+};
+
+void band_worker(void *task_data, unsigned i)
+{
+	band_task *task = static_cast<band_task *>(task_data);
+	unsigned n;
+
+	if (i >= task->tmp.size())
+		return;
+
+	try {
+		while ((n = task->next++) < task->bands.size()) {
+			task->graph->process(task->src, task->dst, task->bands[n], task->tmp[i].data());
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> lock{ task->error_mutex };
+		if (!task->error)
+			task->error = std::current_exception();
+	}
+}
+
+int thread_dispatch(void *, unsigned num_tasks, void (*task)(void *, unsigned), void *task_data)
+{
+	std::vector<std::thread> threads;
+
+	// Workers pull bands from a shared counter, so any tasks that fail to
+	// launch are covered by the ones that do.
+	try {
+		for (unsigned i = 1; i < num_tasks; ++i) {
+			threads.emplace_back(task, task_data, i);
+		}
+	} catch (const std::system_error &) {
+		// Continue with the threads already started.
+	} catch (const std::bad_alloc &) {
+		// Continue with the threads already started.
+	}
+
+	task(task_data, 0);
+
+	for (std::thread &th : threads) {
+		th.join();
+	}
+	return 0;
+}
+
+// Runs the blocks of error diffusion on the tasks of a user dispatcher.
+class DispatchWavefrontExecutor : public depth::WavefrontExecutor {
+	int (*m_dispatch)(void *, unsigned, void (*)(void *, unsigned), void *);
+	void *m_dispatch_user;
+	unsigned m_num_threads;
+	bool m_failed;
+
+	static void task_func(void *task_data, unsigned)
+	{
+		static_cast<depth::WavefrontTask *>(task_data)->work();
+	}
+public:
+	DispatchWavefrontExecutor(int (*dispatch)(void *, unsigned, void (*)(void *, unsigned), void *), void *dispatch_user, unsigned num_threads) :
+		m_dispatch{ dispatch },
+		m_dispatch_user{ dispatch_user },
+		m_num_threads{ num_threads },
+		m_failed{}
+	{}
+
+	bool failed() const { return m_failed; }
+
+	void run(unsigned num_blocks, block_func func, void *user) noexcept override
+	{
+		std::unique_ptr<std::atomic_uint[]> progress{ new (std::nothrow) std::atomic_uint[num_blocks] };
+		if (!progress) {
+			depth::WavefrontScope scope{ nullptr };
+			depth::wavefront_run(num_blocks, func, user);
+			return;
+		}
+
+		for (unsigned n = 0; n < num_blocks; ++n) {
+			progress[n].store(0, std::memory_order_relaxed);
+		}
+
+		depth::WavefrontTask task{ func, user, progress.get(), num_blocks, { 0 } };
+
+		// Tasks take blocks in order, so a dispatcher running them one at a
+		// time completes the image in the first task. Blocks left by a failed
+		// dispatcher are run by the caller.
+		if (m_dispatch(m_dispatch_user, std::min(m_num_threads, num_blocks), task_func, &task))
+			m_failed = true;
+		task.work();
+	}
+};
+
+} // namespace
+
+
+FilterGraph::FilterGraph(std::unique_ptr<graphengine::Graph> graph, std::shared_ptr<void> instance_data, graphengine::node_id source_id, std::vector<graphengine::node_id> sink_ids) :
 	m_graph{ std::move(graph) },
 	m_instance_data{ std::move(instance_data) },
 	m_source_id{ source_id },
-	m_sink_id{ sink_id },
+	m_sink_ids(std::move(sink_ids)),
+	m_sink_greyalpha(m_sink_ids.size()),
 	m_requires_64b{},
-	m_source_greyalpha{},
-	m_sink_greyalpha{}
-{}
+	m_source_greyalpha{}
+{
+	zassert_d(!m_sink_ids.empty() && m_sink_ids.size() <= MAX_OUTPUTS, "invalid number of outputs");
+}
 
 FilterGraph::~FilterGraph() = default;
 
+std::unique_ptr<FilterGraph> FilterGraph::clone() const
+{
+	std::unique_ptr<FilterGraph> graph{ new FilterGraph{ *this } };
+	if (m_wavefront_pool)
+		graph->set_wavefront_threads(m_wavefront_pool->num_threads());
+	return graph;
+}
+
 size_t FilterGraph::get_tmp_size() const try
 {
 	return m_graph->get_tmp_size();
@@ -29,6 +177,14 @@ size_t FilterGraph::get_tmp_size() const try
 	rethrow_graphengine_exception(e);
 }
 
+size_t FilterGraph::get_tmp_size(unsigned left, unsigned top, unsigned width, unsigned height) const try
+{
+	TileGraph::rect region = import_region(m_tile_graph.get(), left, top, width, height);
+	return m_tile_graph->get_tmp_size(region);
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
 unsigned FilterGraph::get_input_buffering() const try
 {
 	graphengine::Graph::BufferingRequirement buffering = m_graph->get_buffering_requirement();
@@ -42,9 +198,14 @@ unsigned FilterGraph::get_input_buffering() const try
 unsigned FilterGraph::get_output_buffering() const try
 {
 	graphengine::Graph::BufferingRequirement buffering = m_graph->get_buffering_requirement();
-	auto it = std::find_if(buffering.begin(), buffering.end(), [=](const auto &entry) { return entry.id == m_sink_id; });
-	zassert(it != buffering.end(), "invalid node id");
-	return std::min(it->mask, UINT_MAX - 1) + 1;
+	unsigned mask = 0;
+
+	for (graphengine::node_id id : m_sink_ids) {
+		auto it = std::find_if(buffering.begin(), buffering.end(), [=](const auto &entry) { return entry.id == id; });
+		zassert(it != buffering.end(), "invalid node id");
+		mask = std::max(mask, it->mask);
+	}
+	return std::min(mask, UINT_MAX - 1) + 1;
 } catch (const graphengine::Exception &e) {
 	rethrow_graphengine_exception(e);
 }
@@ -61,12 +222,40 @@ void FilterGraph::set_tile_width(unsigned tile_width)
 	graphengine::GraphImpl::from(m_graph.get())->set_tile_width(tile_width);
 }
 
+void FilterGraph::set_wavefront_threads(unsigned num_threads)
+{
+	m_wavefront_pool = std::make_shared<depth::WavefrontPool>(num_threads);
+}
+
+void FilterGraph::set_tile_graph(std::unique_ptr<TileGraph> tile_graph)
+{
+	m_tile_graph = std::move(tile_graph);
+}
+
+void FilterGraph::set_profiler(std::unique_ptr<FilterProfiler> profiler)
+{
+	m_profiler = std::move(profiler);
+}
+
 void FilterGraph::process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, void *tmp, callback_type unpack_cb, void *unpack_user, callback_type pack_cb, void *pack_user) const
 {
-	graphengine::Graph::Endpoint endpoints[] = {
-		{ m_source_id, src.data(), { unpack_cb, unpack_user } },
-		{ m_sink_id, dst.data(), { pack_cb, pack_user } },
-	};
+	if (m_sink_ids.size() != 1)
+		error::throw_<error::IllegalArgument>("graph has multiple outputs");
+
+	process(src, &dst, tmp, unpack_cb, unpack_user, &pack_cb, &pack_user);
+}
+
+void FilterGraph::process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> dst[], void *tmp, callback_type unpack_cb, void *unpack_user,
+                          const callback_type pack_cb[], void * const pack_user[]) const
+{
+	process(src, dst, tmp, unpack_cb, unpack_user, pack_cb, pack_user, m_wavefront_pool.get());
+}
+
+void FilterGraph::process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> dst[], void *tmp, callback_type unpack_cb, void *unpack_user,
+                          const callback_type pack_cb[], void * const pack_user[], depth::WavefrontExecutor *executor) const
+{
+	graphengine::Graph::Endpoint endpoints[MAX_OUTPUTS + 1];
+	endpoints[0] = { m_source_id, src.data(), { unpack_cb, unpack_user } };
 
 	graphengine::BufferDescriptor src_reorder[2];
 	if (m_source_greyalpha) {
@@ -75,13 +264,20 @@ void FilterGraph::process(const std::array<graphengine::BufferDescriptor, 4> &sr
 		endpoints[0].buffer = src_reorder;
 	}
 
-	graphengine::BufferDescriptor dst_reorder[2];
-	if (m_sink_greyalpha) {
-		dst_reorder[0] = dst[0];
-		dst_reorder[1] = dst[3];
-		endpoints[1].buffer = dst_reorder;
+	graphengine::BufferDescriptor dst_reorder[MAX_OUTPUTS][2];
+	for (size_t i = 0; i < m_sink_ids.size(); ++i) {
+		graphengine::Graph::Endpoint &endpoint = endpoints[i + 1];
+		endpoint = { m_sink_ids[i], dst[i].data(), { pack_cb ? pack_cb[i] : nullptr, pack_user ? pack_user[i] : nullptr } };
+
+		if (m_sink_greyalpha[i]) {
+			dst_reorder[i][0] = dst[i][0];
+			dst_reorder[i][1] = dst[i][3];
+			endpoint.buffer = dst_reorder[i];
+		}
 	}
 
+	depth::WavefrontScope scope{ executor };
+
 	try {
 		m_graph->run(endpoints, tmp);
 	} catch (const graphengine::Exception &e) {
@@ -89,5 +285,76 @@ void FilterGraph::process(const std::array<graphengine::BufferDescriptor, 4> &sr
 	}
 }
 
+void FilterGraph::process_region(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, void *tmp, unsigned left, unsigned top, unsigned width, unsigned height) const try
+{
+	TileGraph::rect region = import_region(m_tile_graph.get(), left, top, width, height);
+	check_full_buffers(src, dst);
+	m_tile_graph->process(src.data(), dst.data(), region, tmp);
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+void FilterGraph::process_mt(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, unsigned num_threads, dispatch_type dispatch, void *dispatch_user) const try
+{
+	check_full_buffers(src, dst);
+
+	if (!num_threads)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+	// Stateful filters must visit every row in order, and filters on entire
+	// columns compute the whole image, so each band would repeat the work of
+	// the others.
+	if (!m_tile_graph || m_tile_graph->is_stateful() || m_tile_graph->has_entire_col() || num_threads == 1) {
+		AlignedVector<unsigned char> tmp(get_tmp_size());
+
+		if (!dispatch || !m_wavefront_pool) {
+			process(src, dst, tmp.data(), nullptr, nullptr, nullptr, nullptr);
+			return;
+		}
+		if (m_sink_ids.size() != 1)
+			error::throw_<error::IllegalArgument>("graph has multiple outputs");
+
+		DispatchWavefrontExecutor executor{ dispatch, dispatch_user, std::min(num_threads, m_wavefront_pool->num_threads()) };
+		process(src, &dst, tmp.data(), nullptr, nullptr, nullptr, nullptr, &executor);
+
+		if (executor.failed())
+			error::throw_<error::UserCallbackFailed>("user dispatcher failed");
+		return;
+	}
+
+	unsigned width = m_tile_graph->output_width();
+	unsigned height = m_tile_graph->output_height();
+	unsigned band_height = (height + num_threads * BANDS_PER_THREAD - 1) / (num_threads * BANDS_PER_THREAD);
+	band_height = ceil_n(std::max(band_height, MIN_BAND_HEIGHT), 1U << m_tile_graph->subsample_h());
+
+	band_task task{ m_tile_graph.get(), src.data(), dst.data() };
+	size_t tmp_size = 0;
+
+	for (unsigned i = 0; i < height; i += band_height) {
+		TileGraph::rect band{ 0, i, width, std::min(i + band_height, height) };
+		tmp_size = std::max(tmp_size, m_tile_graph->get_tmp_size(band));
+		task.bands.push_back(band);
+	}
+
+	num_threads = std::min(num_threads, static_cast<unsigned>(task.bands.size()));
+	task.tmp.resize(num_threads);
+	for (auto &tmp : task.tmp) {
+		tmp.resize(tmp_size);
+	}
+
+	if (!dispatch)
+		dispatch = thread_dispatch;
+
+	int ret = dispatch(dispatch_user, num_threads, band_worker, &task);
+
+	// Report the first worker failure in preference to the dispatcher.
+	if (task.error)
+		std::rethrow_exception(task.error);
+	if (ret || task.next < task.bands.size())
+		error::throw_<error::UserCallbackFailed>("user dispatcher failed");
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
 } // namespace graph
 } // namespace zimg
@@ -5,6 +5,7 @@
 
 #include <array>
 #include <memory>
+#include <vector>
 #include "graphengine/types.h"
 
 // Base class in global namespace for API export.
@@ -21,29 +22,70 @@ class Graph;
 
 
 namespace zimg {
+
+namespace depth {
+class WavefrontExecutor;
+class WavefrontPool;
+}
+
 namespace graph {
 
+class FilterProfiler;
+class TileGraph;
+
 class FilterGraph : public zimg_filter_graph {
 	typedef int (*callback_type)(void *user, unsigned i, unsigned left, unsigned right);
+	typedef void (*task_type)(void *task_data, unsigned i);
+	typedef int (*dispatch_type)(void *user, unsigned num_tasks, task_type task, void *task_data);
 
-	std::unique_ptr<graphengine::Graph> m_graph;
+	std::shared_ptr<graphengine::Graph> m_graph;
+	std::shared_ptr<TileGraph> m_tile_graph;
+	std::shared_ptr<FilterProfiler> m_profiler;
 	std::shared_ptr<void> m_instance_data;
+	std::shared_ptr<depth::WavefrontPool> m_wavefront_pool;
 	graphengine::node_id m_source_id;
-	graphengine::node_id m_sink_id;
+	std::vector<graphengine::node_id> m_sink_ids;
+	std::vector<char> m_sink_greyalpha;
 	bool m_requires_64b;
 	bool m_source_greyalpha;
-	bool m_sink_greyalpha;
+
+	FilterGraph(const FilterGraph &other) = default;
+
+	void process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> dst[], void *tmp, callback_type unpack_cb, void *unpack_user,
+	             const callback_type pack_cb[], void * const pack_user[], depth::WavefrontExecutor *executor) const;
 public:
-	FilterGraph(std::unique_ptr<graphengine::Graph> graph, std::shared_ptr<void> instance_data, graphengine::node_id source_id, graphengine::node_id sink_id);
+	// Endpoints are kept on the stack during processing.
+	static constexpr unsigned MAX_OUTPUTS = 16;
+
+	FilterGraph(std::unique_ptr<graphengine::Graph> graph, std::shared_ptr<void> instance_data, graphengine::node_id source_id, std::vector<graphengine::node_id> sink_ids);
 
 	~FilterGraph();
 
+	/**
+	 * Create a new handle sharing the compiled graph.
+	 *
+	 * Each handle has its own wavefront threads, so handles can be processed
+	 * concurrently.
+	 *
+	 * @return graph
+	 */
+	std::unique_ptr<FilterGraph> clone() const;
+
 	size_t get_tmp_size() const;
 
+	size_t get_tmp_size(unsigned left, unsigned top, unsigned width, unsigned height) const;
+
 	unsigned get_input_buffering() const;
 
+	/**
+	 * Get the number of lines buffered by the outputs.
+	 *
+	 * @return largest requirement among the outputs
+	 */
 	unsigned get_output_buffering() const;
 
+	unsigned get_num_outputs() const { return static_cast<unsigned>(m_sink_ids.size()); }
+
 	unsigned get_tile_width() const;
 
 	void set_tile_width(unsigned tile_width);
@@ -52,11 +94,74 @@ public:
 
 	void set_requires_64b_alignment() { m_requires_64b = true; }
 
+	/**
+	 * Run error diffusion on a pool of threads owned by the handle.
+	 *
+	 * The threads are started on first use and shared by all planes.
+	 *
+	 * @param num_threads total number of threads, including the caller
+	 */
+	void set_wavefront_threads(unsigned num_threads);
+
 	void set_source_greyalpha() { m_source_greyalpha = true; }
 
-	void set_sink_greyalpha() { m_sink_greyalpha = true; }
+	void set_sink_greyalpha(unsigned index) { m_sink_greyalpha[index] = 1; }
+
+	void set_tile_graph(std::unique_ptr<TileGraph> tile_graph);
+
+	void set_profiler(std::unique_ptr<FilterProfiler> profiler);
+
+	/**
+	 * Get the execution statistics of the graph.
+	 *
+	 * @return profiler, or null if the graph was built without profiling
+	 */
+	FilterProfiler *get_profiler() const { return m_profiler.get(); }
 
 	void process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, void *tmp, callback_type unpack_cb, void *unpack_user, callback_type pack_cb, void *pack_user) const;
+
+	/**
+	 * Process an image, writing all outputs of the graph.
+	 *
+	 * @param src input buffers
+	 * @param dst output buffers, one per output
+	 * @param tmp temporary buffer
+	 * @param unpack_cb input callback, may be null
+	 * @param unpack_user private data for input callback
+	 * @param pack_cb output callbacks, one per output, may be null
+	 * @param pack_user private data for output callbacks, may be null
+	 */
+	void process(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> dst[], void *tmp, callback_type unpack_cb, void *unpack_user,
+	             const callback_type pack_cb[], void * const pack_user[]) const;
+
+	/**
+	 * Compute a rectangle of the output image from an in-memory image.
+	 *
+	 * Buffers address the entire image. Only the pixels in the rectangle are
+	 * written, so disjoint rectangles can be processed concurrently.
+	 *
+	 * @param src input buffers, must have a mask of BUFFER_MAX
+	 * @param dst output buffers, must have a mask of BUFFER_MAX
+	 * @param tmp temporary buffer, sized for the rectangle
+	 */
+	void process_region(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, void *tmp, unsigned left, unsigned top, unsigned width, unsigned height) const;
+
+	/**
+	 * Process an in-memory image on multiple threads.
+	 *
+	 * The output is divided into row bands, which are computed independently
+	 * from the full input image. If no dispatcher is given, the bands are
+	 * processed on internally created threads. Graphs that can not be divided
+	 * run on the calling thread, except for the blocks of rows of error
+	 * diffusion, which are submitted to the dispatcher if one is given.
+	 *
+	 * @param src input buffers, must have a mask of BUFFER_MAX
+	 * @param dst output buffers, must have a mask of BUFFER_MAX
+	 * @param num_threads number of workers, 0 for hardware concurrency
+	 * @param dispatch user dispatcher, may be null
+	 * @param dispatch_user private data for dispatcher
+	 */
+	void process_mt(const std::array<graphengine::BufferDescriptor, 4> &src, const std::array<graphengine::BufferDescriptor, 4> &dst, unsigned num_threads, dispatch_type dispatch, void *dispatch_user) const;
 };
 
 } // namespace graph
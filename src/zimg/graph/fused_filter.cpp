@@ -0,0 +1,143 @@
+#include <algorithm>
+#include "common/align.h"
+#include "common/checked_int.h"
+#include "common/zassert.h"
+#include "fused_filter.h"
+
+namespace zimg {
+namespace graph {
+
+static_assert(FusedPointFilter::STRIP_WIDTH % ALIGNMENT == 0, "strip must be a multiple of the vector width");
+
+FusedPointFilter::FusedPointFilter(const std::vector<stage> &stages, const std::vector<plane_ref> &outputs, unsigned num_inputs) :
+	m_stage_tmp_size{}
+{
+	zassert_d(!stages.empty(), "empty group");
+	zassert_d(!outputs.empty() && outputs.size() <= graphengine::NODE_MAX_PLANES, "too many outputs");
+	zassert_d(num_inputs <= graphengine::NODE_MAX_PLANES, "too many inputs");
+
+	const graphengine::FilterDescriptor &first_desc = stages.front().filter->descriptor();
+	const graphengine::FilterDescriptor &output_desc = stages[outputs.front().stage].filter->descriptor();
+
+	m_desc.format = { first_desc.format.width, first_desc.format.height, output_desc.format.bytes_per_sample };
+	m_desc.num_deps = num_inputs;
+	m_desc.num_planes = static_cast<unsigned>(outputs.size());
+	m_desc.step = 1;
+
+	checked_size_t context_size = 0;
+	checked_size_t scratch_size = 0;
+	size_t stage_tmp_size = 0;
+	bool in_place = true;
+
+	for (const stage &s : stages) {
+		const graphengine::FilterDescriptor &desc = s.filter->descriptor();
+		zassert_d(desc.format.width == m_desc.format.width && desc.format.height == m_desc.format.height, "dimensions must match");
+
+		stage_info info{ s.filter };
+		std::copy_n(s.deps, desc.num_deps, info.deps);
+
+		for (unsigned p = 0; p < desc.num_planes; ++p) {
+			auto it = std::find_if(outputs.begin(), outputs.end(), [&](const plane_ref &ref)
+			{
+				return ref.stage == static_cast<int>(m_stages.size()) && ref.plane == p;
+			});
+
+			if (it != outputs.end()) {
+				zassert_d(desc.format.bytes_per_sample == m_desc.format.bytes_per_sample, "output formats must match");
+				info.planes[p] = { static_cast<int>(it - outputs.begin()), 0 };
+			} else {
+				info.planes[p] = { -1, scratch_size.get() };
+				scratch_size += ceil_n(static_cast<checked_size_t>(STRIP_WIDTH) * desc.format.bytes_per_sample, ALIGNMENT);
+			}
+		}
+		info.context_offset = context_size.get();
+
+		context_size += ceil_n(checked_size_t{ desc.context_size }, ALIGNMENT);
+		stage_tmp_size = std::max(stage_tmp_size, desc.scratchpad_size);
+		m_desc.alignment_mask |= desc.alignment_mask;
+		in_place = in_place && desc.flags.in_place && desc.format.bytes_per_sample == m_desc.format.bytes_per_sample;
+
+		m_stages.push_back(info);
+	}
+
+	// Output N may alias input N only if no stage reads input N after the
+	// stage writing output N, other than through its own in-place plane.
+	for (unsigned n = 0; n < std::min(static_cast<unsigned>(outputs.size()), num_inputs) && in_place; ++n) {
+		const plane_ref &dst = outputs[n];
+
+		for (size_t k = dst.stage; k < stages.size() && in_place; ++k) {
+			const graphengine::FilterDescriptor &desc = stages[k].filter->descriptor();
+
+			for (unsigned p = 0; p < desc.num_deps; ++p) {
+				const plane_ref &src = stages[k].deps[p];
+				bool own_plane = static_cast<int>(k) == dst.stage && p == dst.plane;
+
+				if (src.stage < 0 && src.plane == n && !own_plane)
+					in_place = false;
+			}
+		}
+	}
+	m_desc.flags.in_place = in_place;
+
+	m_stage_tmp_size = ceil_n(checked_size_t{ stage_tmp_size }, ALIGNMENT).get();
+	m_desc.context_size = context_size.get();
+	m_desc.scratchpad_size = (scratch_size + m_stage_tmp_size).get();
+}
+
+graphengine::BufferDescriptor FusedPointFilter::get_buffer(plane_ref ref, const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+                                                           unsigned char *scratch, unsigned strip_left) const
+{
+	if (ref.stage < 0)
+		return in[ref.plane];
+
+	const stage_info &info = m_stages[ref.stage];
+	const plane_location &location = info.planes[ref.plane];
+
+	if (location.output >= 0)
+		return out[location.output];
+
+	// Scratch lines hold one strip and are addressed by absolute column.
+	size_t bytes_per_sample = info.filter->descriptor().format.bytes_per_sample;
+	unsigned char *ptr = scratch + location.scratch_offset - floor_n(strip_left, STRIP_WIDTH) * bytes_per_sample;
+	return{ ptr, 0, 0 };
+}
+
+void FusedPointFilter::init_context(void *context) const noexcept
+{
+	for (const stage_info &info : m_stages) {
+		if (info.filter->descriptor().context_size)
+			info.filter->init_context(static_cast<unsigned char *>(context) + info.context_offset);
+	}
+}
+
+void FusedPointFilter::process(const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+                               unsigned i, unsigned left, unsigned right, void *context, void *tmp) const noexcept
+{
+	unsigned char *stage_tmp = static_cast<unsigned char *>(tmp);
+	unsigned char *scratch = stage_tmp + m_stage_tmp_size;
+
+	for (unsigned strip_left = left; strip_left < right;) {
+		unsigned strip_right = std::min(floor_n(strip_left, STRIP_WIDTH) + STRIP_WIDTH, right);
+
+		for (const stage_info &info : m_stages) {
+			const graphengine::FilterDescriptor &desc = info.filter->descriptor();
+			graphengine::BufferDescriptor stage_in[graphengine::NODE_MAX_PLANES];
+			graphengine::BufferDescriptor stage_out[graphengine::NODE_MAX_PLANES];
+
+			for (unsigned p = 0; p < desc.num_deps; ++p) {
+				stage_in[p] = get_buffer(info.deps[p], in, out, scratch, strip_left);
+			}
+			for (unsigned p = 0; p < desc.num_planes; ++p) {
+				stage_out[p] = get_buffer({ static_cast<int>(&info - m_stages.data()), p }, in, out, scratch, strip_left);
+			}
+
+			void *stage_context = desc.context_size ? static_cast<unsigned char *>(context) + info.context_offset : nullptr;
+			info.filter->process(stage_in, stage_out, i, strip_left, strip_right, stage_context, stage_tmp);
+		}
+
+		strip_left = strip_right;
+	}
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_FUSED_FILTER_H_
+#define ZIMG_GRAPH_FUSED_FILTER_H_
+
+#include <cstddef>
+#include <vector>
+#include "graphengine/filter.h"
+#include "filter_base.h"
+
+namespace zimg {
+namespace graph {
+
+/**
+ * Executes a group of point filters as a single filter.
+ *
+ * Each row is processed in strips, running every stage on a strip before
+ * moving to the next one, so that intermediate lines stay in cache. Planes
+ * which are not outputs of the group are stored in the scratchpad.
+ */
+class FusedPointFilter : public FilterBase {
+public:
+	static constexpr unsigned STRIP_WIDTH = 512;
+
+	// Plane of an earlier stage, or input plane if |stage| is negative.
+	struct plane_ref {
+		int stage;
+		unsigned plane;
+	};
+
+	struct stage {
+		const graphengine::Filter *filter;
+		plane_ref deps[graphengine::NODE_MAX_PLANES];
+	};
+private:
+	struct plane_location {
+		int output;
+		size_t scratch_offset;
+	};
+
+	struct stage_info {
+		const graphengine::Filter *filter;
+		plane_ref deps[graphengine::NODE_MAX_PLANES];
+		plane_location planes[graphengine::NODE_MAX_PLANES];
+		size_t context_offset;
+	};
+
+	std::vector<stage_info> m_stages;
+	size_t m_stage_tmp_size;
+
+	graphengine::BufferDescriptor get_buffer(plane_ref ref, const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+	                                         unsigned char *scratch, unsigned strip_left) const;
+public:
+	/**
+	 * Initialize the filter.
+	 *
+	 * @param stages filters in execution order, which must have equal dimensions
+	 * @param outputs stage planes written to the output of the filter
+	 * @param num_inputs number of inputs referenced by the stages
+	 */
+	FusedPointFilter(const std::vector<stage> &stages, const std::vector<plane_ref> &outputs, unsigned num_inputs);
+
+	pair_unsigned get_row_deps(unsigned i) const noexcept override { return{ i, i + 1 }; }
+
+	pair_unsigned get_col_deps(unsigned left, unsigned right) const noexcept override { return{ left, right }; }
+
+	void init_context(void *context) const noexcept override;
+
+	void process(const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+	             unsigned i, unsigned left, unsigned right, void *context, void *tmp) const noexcept override;
+};
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_FUSED_FILTER_H_
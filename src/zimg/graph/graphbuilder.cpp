@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include "colorspace/colorspace.h"
 #include "common/cpuinfo.h"
@@ -10,12 +12,17 @@
 #include "graphengine/filter.h"
 #include "graphengine/graph.h"
 #include "resize/filter.h"
+#include "resize/chroma_upsample.h"
 #include "resize/resize.h"
 #include "unresize/unresize.h"
 #include "filtergraph.h"
+#include "fused_filter.h"
 #include "graphbuilder.h"
+#include "graphcache.h"
 #include "graphengine_except.h"
+#include "profiler.h"
 #include "simple_filters.h"
+#include "tilegraph.h"
 
 
 #ifndef ZIMG_UNSAFE_IMAGE_SIZE
@@ -240,14 +247,17 @@ void validate_state(const GraphBuilder::state &state)
 SubGraph::SubGraph() :
 	m_subgraph(std::make_unique<graphengine::SubGraphImpl>()),
 	m_source_ids{},
-	m_sink_ids{}
+	m_next_id{},
+	m_source_bytes_per_sample{},
+	m_fusion{}
 {
 	m_source_ids[0] = m_subgraph->add_source();
 	m_source_ids[1] = m_subgraph->add_source();
 	m_source_ids[2] = m_subgraph->add_source();
 	m_source_ids[3] = m_subgraph->add_source();
 
-	std::fill_n(m_sink_ids, 4, graphengine::null_node);
+	// Transforms are numbered locally until they are inserted in set_sink.
+	m_next_id = *std::max_element(m_source_ids, m_source_ids + 4) + 1;
 }
 
 SubGraph::SubGraph(SubGraph &&other) noexcept = default;
@@ -262,22 +272,294 @@ const graphengine::Filter *SubGraph::save_filter(std::unique_ptr<graphengine::Fi
 	return m_filters.back().get();
 }
 
-graphengine::node_id SubGraph::add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[])
+unsigned SubGraph::get_bytes_per_sample(graphengine::node_dep_desc dep) const
+{
+	if (std::find(m_source_ids, m_source_ids + 4, dep.id) != m_source_ids + 4)
+		return m_source_bytes_per_sample;
+
+	auto it = std::find_if(m_transforms.begin(), m_transforms.end(), [=](const transform_record &record) { return record.id == dep.id; });
+	zassert_d(it != m_transforms.end(), "node not found");
+	return it->filter->descriptor().format.bytes_per_sample;
+}
+
+graphengine::node_id SubGraph::add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[], const char *name, int plane)
 {
 	zassert_d(m_subgraph, "");
-	return m_subgraph->add_transform(filter, deps);
+
+	bool point = dynamic_cast<const PointFilter *>(filter) && filter->descriptor().num_deps;
+
+	if (m_profiler) {
+		unsigned input_bytes_per_sample[4] = {};
+		for (unsigned p = 0; p < filter->descriptor().num_deps; ++p) {
+			input_bytes_per_sample[p] = get_bytes_per_sample(deps[p]);
+		}
+		filter = m_profiler->wrap(filter, name, plane, input_bytes_per_sample);
+	}
+
+	transform_record record{ m_next_id++, filter, {}, point };
+	std::fill(record.deps.begin(), record.deps.end(), graphengine::null_dep);
+	std::copy_n(deps, filter->descriptor().num_deps, record.deps.begin());
+	m_transforms.push_back(record);
+
+	return record.id;
+}
+
+void SubGraph::enable_profiling(unsigned source_bytes_per_sample)
+{
+	m_profiler = std::make_unique<FilterProfiler>();
+	m_source_bytes_per_sample = source_bytes_per_sample;
+}
+
+void SubGraph::fuse_point_filters()
+{
+	size_t num_transforms = m_transforms.size();
+
+	auto find_transform = [&](graphengine::node_id id) -> size_t
+	{
+		auto it = std::find_if(m_transforms.begin(), m_transforms.end(), [=](const transform_record &record) { return record.id == id; });
+		return it - m_transforms.begin();
+	};
+
+	auto same_dimensions = [](const graphengine::Filter *a, const graphengine::Filter *b)
+	{
+		return a->descriptor().format.width == b->descriptor().format.width && a->descriptor().format.height == b->descriptor().format.height;
+	};
+
+	// Find the external inputs and outputs of group |g|.
+	auto get_group_io = [&](const std::vector<size_t> &group, size_t g,
+	                        std::vector<graphengine::node_dep_desc> &inputs, std::vector<graphengine::node_dep_desc> &outputs)
+	{
+		auto add_unique = [](std::vector<graphengine::node_dep_desc> &v, graphengine::node_dep_desc dep)
+		{
+			if (std::find_if(v.begin(), v.end(), [=](graphengine::node_dep_desc x) { return x.id == dep.id && x.plane == dep.plane; }) == v.end())
+				v.push_back(dep);
+		};
+
+		inputs.clear();
+		outputs.clear();
+
+		for (size_t k = 0; k < num_transforms; ++k) {
+			const transform_record &record = m_transforms[k];
+
+			for (unsigned p = 0; p < record.filter->descriptor().num_deps; ++p) {
+				size_t dep_idx = find_transform(record.deps[p].id);
+				bool dep_member = dep_idx != num_transforms && group[dep_idx] == g;
+
+				if (group[k] == g && !dep_member)
+					add_unique(inputs, record.deps[p]);
+				else if (group[k] != g && dep_member)
+					add_unique(outputs, record.deps[p]);
+			}
+		}
+
+		for (graphengine::node_dep_desc dep : m_sink_deps) {
+			size_t dep_idx = find_transform(dep.id);
+			if (dep_idx != num_transforms && group[dep_idx] == g)
+				add_unique(outputs, dep);
+		}
+	};
+
+	// Check that the graph remains acyclic when each group is one node.
+	auto is_acyclic = [&](const std::vector<size_t> &group)
+	{
+		std::vector<char> done(num_transforms);
+		bool progress = true;
+
+		while (progress) {
+			progress = false;
+
+			for (size_t g = 0; g < num_transforms; ++g) {
+				if (done[g] || std::find(group.begin(), group.end(), g) == group.end())
+					continue;
+
+				bool ready = true;
+				for (size_t k = 0; k < num_transforms && ready; ++k) {
+					if (group[k] != g)
+						continue;
+
+					const transform_record &record = m_transforms[k];
+					for (unsigned p = 0; p < record.filter->descriptor().num_deps; ++p) {
+						size_t dep_idx = find_transform(record.deps[p].id);
+						if (dep_idx != num_transforms && group[dep_idx] != g && !done[group[dep_idx]])
+							ready = false;
+					}
+				}
+
+				if (ready) {
+					done[g] = 1;
+					progress = true;
+				}
+			}
+		}
+
+		return std::all_of(group.begin(), group.end(), [&](size_t g) { return done[g]; });
+	};
+
+	auto is_valid_group = [&](const std::vector<size_t> &group, size_t g)
+	{
+		std::vector<graphengine::node_dep_desc> inputs;
+		std::vector<graphengine::node_dep_desc> outputs;
+
+		get_group_io(group, g, inputs, outputs);
+		if (inputs.size() > graphengine::NODE_MAX_PLANES || outputs.empty() || outputs.size() > graphengine::NODE_MAX_PLANES)
+			return false;
+
+		unsigned bytes_per_sample = get_bytes_per_sample(outputs.front());
+		return std::all_of(outputs.begin(), outputs.end(), [&](graphengine::node_dep_desc dep) { return get_bytes_per_sample(dep) == bytes_per_sample; });
+	};
+
+	// Visit the nodes from the sinks upward, merging each point filter with
+	// the groups of its point filter consumers.
+	std::vector<size_t> group(num_transforms);
+	std::iota(group.begin(), group.end(), 0);
+
+	for (size_t k = num_transforms; k-- != 0;) {
+		const transform_record &record = m_transforms[k];
+		if (!record.point)
+			continue;
+
+		std::vector<size_t> candidate = group;
+		bool merged = false;
+
+		for (size_t j = k + 1; j < num_transforms; ++j) {
+			const transform_record &consumer = m_transforms[j];
+			if (!consumer.point || !same_dimensions(record.filter, consumer.filter) || candidate[j] == candidate[k])
+				continue;
+			if (std::none_of(consumer.deps.begin(), consumer.deps.end(), [&](graphengine::node_dep_desc dep) { return dep.id == record.id; }))
+				continue;
+
+			size_t old_group = candidate[j];
+			std::replace(candidate.begin(), candidate.end(), old_group, candidate[k]);
+			merged = true;
+		}
+
+		if (merged && is_valid_group(candidate, candidate[k]) && is_acyclic(candidate))
+			group = std::move(candidate);
+	}
+
+	// Replace each group with a fused filter.
+	std::vector<transform_record> remaining;
+	std::vector<std::pair<graphengine::node_dep_desc, graphengine::node_dep_desc>> dep_map;
+
+	for (size_t g = 0; g < num_transforms; ++g) {
+		std::vector<size_t> members;
+		for (size_t k = 0; k < num_transforms; ++k) {
+			if (group[k] == g)
+				members.push_back(k);
+		}
+
+		if (members.size() == 1)
+			remaining.push_back(m_transforms[members.front()]);
+		if (members.size() <= 1)
+			continue;
+
+		std::vector<graphengine::node_dep_desc> inputs;
+		std::vector<graphengine::node_dep_desc> outputs;
+		get_group_io(group, g, inputs, outputs);
+
+		auto to_plane_ref = [&](graphengine::node_dep_desc dep) -> FusedPointFilter::plane_ref
+		{
+			auto member_it = std::find(members.begin(), members.end(), find_transform(dep.id));
+			if (member_it != members.end())
+				return{ static_cast<int>(member_it - members.begin()), dep.plane };
+
+			auto input_it = std::find_if(inputs.begin(), inputs.end(), [=](graphengine::node_dep_desc x) { return x.id == dep.id && x.plane == dep.plane; });
+			return{ -1, static_cast<unsigned>(input_it - inputs.begin()) };
+		};
+
+		std::vector<FusedPointFilter::stage> stages;
+		for (size_t k : members) {
+			const transform_record &record = m_transforms[k];
+			FusedPointFilter::stage stage{ record.filter };
+
+			for (unsigned p = 0; p < record.filter->descriptor().num_deps; ++p) {
+				stage.deps[p] = to_plane_ref(record.deps[p]);
+			}
+			stages.push_back(stage);
+		}
+
+		std::vector<FusedPointFilter::plane_ref> output_refs;
+		std::transform(outputs.begin(), outputs.end(), std::back_inserter(output_refs), to_plane_ref);
+
+		const graphengine::Filter *fused = save_filter(std::make_unique<FusedPointFilter>(stages, output_refs, static_cast<unsigned>(inputs.size())));
+
+		transform_record record{ m_next_id++, fused, {}, false };
+		std::fill(record.deps.begin(), record.deps.end(), graphengine::null_dep);
+		std::copy(inputs.begin(), inputs.end(), record.deps.begin());
+		remaining.push_back(record);
+
+		for (unsigned p = 0; p < outputs.size(); ++p) {
+			dep_map.emplace_back(outputs[p], graphengine::node_dep_desc{ record.id, p });
+		}
+	}
+
+	auto map_dep = [&](graphengine::node_dep_desc &dep)
+	{
+		auto it = std::find_if(dep_map.begin(), dep_map.end(), [=](const auto &entry) { return entry.first.id == dep.id && entry.first.plane == dep.plane; });
+		if (it != dep_map.end())
+			dep = it->second;
+	};
+
+	for (transform_record &record : remaining) {
+		std::for_each(record.deps.begin(), record.deps.end(), map_dep);
+	}
+	std::for_each(m_sink_deps.begin(), m_sink_deps.end(), map_dep);
+
+	// Restore a topological order, since a group executes at its first member.
+	m_transforms.clear();
+
+	while (!remaining.empty()) {
+		auto it = std::find_if(remaining.begin(), remaining.end(), [&](const transform_record &record)
+		{
+			return std::all_of(record.deps.begin(), record.deps.begin() + record.filter->descriptor().num_deps, [&](graphengine::node_dep_desc dep)
+			{
+				return std::find(m_source_ids, m_source_ids + 4, dep.id) != m_source_ids + 4 || find_transform(dep.id) != m_transforms.size();
+			});
+		});
+		zassert_d(it != remaining.end(), "cycle in graph");
+
+		m_transforms.push_back(*it);
+		remaining.erase(it);
+	}
 }
 
 void SubGraph::set_sink(unsigned num_planes, const graphengine::node_dep_desc deps[])
 {
 	zassert_d(m_subgraph, "");
 
-	for (unsigned p = 0; p < num_planes; ++p) {
-		m_sink_ids[p] = m_subgraph->add_sink(deps[p]);
+	m_sink_deps.assign(deps, deps + num_planes);
+	if (m_fusion)
+		fuse_point_filters();
+
+	std::vector<std::pair<graphengine::node_id, graphengine::node_id>> id_map;
+
+	auto map_dep = [&](graphengine::node_dep_desc dep) -> graphengine::node_dep_desc
+	{
+		if (std::find(m_source_ids, m_source_ids + 4, dep.id) != m_source_ids + 4)
+			return dep;
+
+		auto it = std::find_if(id_map.begin(), id_map.end(), [=](const auto &entry) { return entry.first == dep.id; });
+		zassert_d(it != id_map.end(), "node not found");
+		return{ it->second, dep.plane };
+	};
+
+	for (transform_record &record : m_transforms) {
+		for (unsigned p = 0; p < record.filter->descriptor().num_deps; ++p) {
+			record.deps[p] = map_dep(record.deps[p]);
+		}
+
+		graphengine::node_id id = m_subgraph->add_transform(record.filter, record.deps.data());
+		id_map.emplace_back(record.id, id);
+		record.id = id;
+	}
+
+	for (graphengine::node_dep_desc &dep : m_sink_deps) {
+		dep = map_dep(dep);
+		m_sink_ids.push_back(m_subgraph->add_sink(dep));
 	}
 }
 
-std::array<graphengine::node_dep_desc, 4> SubGraph::connect(graphengine::Graph *graph, const graphengine::node_dep_desc source_deps[4]) const
+std::vector<graphengine::node_dep_desc> SubGraph::connect(graphengine::Graph *graph, const graphengine::node_dep_desc source_deps[4]) const
 {
 	zassert_d(m_subgraph, "");
 
@@ -287,19 +569,45 @@ std::array<graphengine::node_dep_desc, 4> SubGraph::connect(graphengine::Graph *
 	source_mapping[2] = { m_source_ids[2], source_deps[2] };
 	source_mapping[3] = { m_source_ids[3], source_deps[3] };
 
-	graphengine::SubGraph::Mapping sink_mapping[4];
-	m_subgraph->connect(graph, 4, source_mapping, sink_mapping);
+	std::vector<graphengine::SubGraph::Mapping> sink_mapping(m_sink_ids.size());
+	m_subgraph->connect(graph, 4, source_mapping, sink_mapping.data());
 
-	std::array<graphengine::node_dep_desc, 4> result{};
-	auto result_it = result.begin();
+	std::vector<graphengine::node_dep_desc> result;
 
 	for (graphengine::node_id id : m_sink_ids) {
-		if (id < 0)
-			continue;
+		auto it = std::find_if(sink_mapping.begin(), sink_mapping.end(), [=](const graphengine::SubGraph::Mapping &m) { return m.internal_id == id; });
+		result.push_back(it->external_dep);
+	}
+	return result;
+}
+
+std::vector<graphengine::node_dep_desc> SubGraph::connect(TileGraph *graph, const graphengine::node_dep_desc source_deps[4]) const
+{
+	std::vector<std::pair<graphengine::node_id, graphengine::node_id>> id_map;
+
+	auto map_dep = [&](graphengine::node_dep_desc dep) -> graphengine::node_dep_desc
+	{
+		auto source_it = std::find(m_source_ids, m_source_ids + 4, dep.id);
+		if (source_it != m_source_ids + 4)
+			return source_deps[source_it - m_source_ids];
 
-		auto it = std::find_if(sink_mapping, sink_mapping + 4, [=](const graphengine::SubGraph::Mapping &m) { return m.internal_id == id; });
-		*result_it++ = it->external_dep;
+		auto it = std::find_if(id_map.begin(), id_map.end(), [=](const auto &entry) { return entry.first == dep.id; });
+		zassert_d(it != id_map.end(), "node not found");
+		return{ it->second, dep.plane };
+	};
+
+	for (const transform_record &record : m_transforms) {
+		unsigned num_deps = record.filter->descriptor().num_deps;
+		graphengine::node_dep_desc deps[4];
+
+		for (unsigned p = 0; p < num_deps; ++p) {
+			deps[p] = map_dep(record.deps[p]);
+		}
+		id_map.emplace_back(record.id, graph->add_transform(record.filter, deps));
 	}
+
+	std::vector<graphengine::node_dep_desc> result;
+	std::transform(m_sink_deps.begin(), m_sink_deps.end(), std::back_inserter(result), map_dep);
 	return result;
 }
 
@@ -315,6 +623,11 @@ std::shared_ptr<void> SubGraph::release_filters_opaque()
 	return std::make_unique<decltype(release_filters())>(release_filters());
 }
 
+std::unique_ptr<FilterProfiler> SubGraph::release_profiler()
+{
+	return std::move(m_profiler);
+}
+
 
 struct GraphBuilder::internal_state {
 	struct plane {
@@ -459,16 +772,102 @@ private:
 		ALPHA,
 	};
 
+	// Operations which can be shared between the branches of a graph.
+	enum class Operation {
+		COPY,
+		DEPTH,
+		RESIZE,
+		COLORSPACE,
+	};
+
+	struct output {
+		internal_state state;
+		std::array<graphengine::node_dep_desc, PLANE_NUM> ids;
+	};
+
+	struct memo_entry {
+		GraphCache::Key key;
+		output result;
+	};
+
 	SubGraph m_graph;
 	std::array<graphengine::node_dep_desc, PLANE_NUM> m_ids;
 	state m_source_state;
 	internal_state m_state;
+	std::vector<output> m_outputs;
+	std::vector<memo_entry> m_memo;
 	bool m_requires_64b;
+	unsigned m_wavefront_threads;
 
-	internal_state make_float_444_state(const internal_state &state, bool include_alpha)
+	static void add_format_key(GraphCache::Key &key, const PixelFormat &format)
+	{
+		key.add(static_cast<int>(format.type))
+			.add(format.depth)
+			.add(format.fullrange)
+			.add(format.chroma)
+			.add(format.ycgco);
+	}
+
+	static void add_plane_key(GraphCache::Key &key, const internal_state::plane &plane)
+	{
+		add_format_key(key, plane.format);
+		key.add(plane.width)
+			.add(plane.height)
+			.add(plane.active_left)
+			.add(plane.active_top)
+			.add(plane.active_width)
+			.add(plane.active_height);
+	}
+
+	// Describe an operation by its inputs. Arguments are appended by the caller.
+	GraphCache::Key make_memo_key(Operation op, plane_mask mask)
+	{
+		GraphCache::Key key;
+		key.add(static_cast<int>(op))
+			.add(static_cast<int>(m_state.color))
+			.add(static_cast<int>(m_state.colorspace.matrix))
+			.add(static_cast<int>(m_state.colorspace.transfer))
+			.add(static_cast<int>(m_state.colorspace.primaries))
+			.add(static_cast<int>(m_state.alpha));
+
+		for (int p = 0; p < PLANE_NUM; ++p) {
+			key.add(mask[p]);
+			if (!mask[p])
+				continue;
+
+			add_plane_key(key, m_state.planes[p]);
+			key.add(m_ids[p].id).add(m_ids[p].plane);
+		}
+		return key;
+	}
+
+	// Reuse the nodes of an earlier branch that applied the same operation to
+	// the same nodes. Only valid while the filter parameters are unchanged.
+	template <class Func>
+	void memoize(GraphCache::Key key, plane_mask mask, Func func)
+	{
+		auto it = std::find_if(m_memo.begin(), m_memo.end(), [&](const memo_entry &entry) { return entry.key == key; });
+		if (it == m_memo.end()) {
+			func();
+			m_memo.push_back({ std::move(key), { m_state, m_ids } });
+			return;
+		}
+
+		const output &result = it->result;
+		apply_mask(mask, [&](int p)
+		{
+			m_state.planes[p] = result.state.planes[p];
+			m_ids[p] = result.ids[p];
+		});
+		m_state.color = result.state.color;
+		m_state.colorspace = result.state.colorspace;
+		m_state.alpha = result.state.alpha;
+	}
+
+	internal_state make_444_state(const internal_state &state, const PixelFormat &format, bool include_alpha)
 	{
 		internal_state result = state;
-		result.planes[PLANE_Y].format = PixelType::FLOAT;
+		result.planes[PLANE_Y].format = format;
 
 		if (result.has_chroma())
 			result.chroma_from_luma_444();
@@ -478,6 +877,11 @@ private:
 		return result;
 	}
 
+	internal_state make_float_444_state(const internal_state &state, bool include_alpha)
+	{
+		return make_444_state(state, PixelType::FLOAT, include_alpha);
+	}
+
 	template <class Func>
 	void apply_mask(plane_mask mask, Func func)
 	{
@@ -487,20 +891,20 @@ private:
 		}
 	}
 
-	void attach_greyscale_filter(const graphengine::Filter *filter, plane_mask mask)
+	void attach_greyscale_filter(const graphengine::Filter *filter, plane_mask mask, const char *name)
 	{
-		apply_mask(mask, [&](int p) { m_ids[p] = { m_graph.add_transform(filter, &m_ids[p]), 0 }; });
+		apply_mask(mask, [&](int p) { m_ids[p] = { m_graph.add_transform(filter, &m_ids[p], name, p), 0 }; });
 	}
 
-	void check_is_444_float(bool check_alpha)
+	void check_is_444(PixelType type, bool check_alpha)
 	{
-		iassert(m_state.planes[PLANE_Y].format.type == PixelType::FLOAT);
+		iassert(m_state.planes[PLANE_Y].format.type == type);
 		if (m_state.has_chroma()) {
-			iassert(m_state.planes[PLANE_U].format.type == PixelType::FLOAT);
-			iassert(m_state.planes[PLANE_V].format.type == PixelType::FLOAT);
+			iassert(m_state.planes[PLANE_U].format.type == type);
+			iassert(m_state.planes[PLANE_V].format.type == type);
 		}
 		if (check_alpha && m_state.has_alpha())
-			iassert(m_state.planes[PLANE_A].format.type == PixelType::FLOAT);
+			iassert(m_state.planes[PLANE_A].format.type == type);
 
 		if (m_state.has_chroma()) {
 			iassert(m_state.planes[0].width == m_state.planes[1].width && m_state.planes[0].height == m_state.planes[1].height);
@@ -508,6 +912,11 @@ private:
 		}
 	}
 
+	void check_is_444_float(bool check_alpha)
+	{
+		check_is_444(PixelType::FLOAT, check_alpha);
+	}
+
 	bool needs_colorspace(const internal_state &target)
 	{
 		colorspace::ColorspaceDefinition csp_in = m_state.colorspace;
@@ -668,7 +1077,7 @@ private:
 
 		auto filter = std::make_unique<ValueInitializeFilter>(
 			target.planes[PLANE_U].width, target.planes[PLANE_U].height, format.type, val);
-		graphengine::node_id id = m_graph.add_transform(m_graph.save_filter(std::move(filter)), nullptr);
+		graphengine::node_id id = m_graph.add_transform(m_graph.save_filter(std::move(filter)), nullptr, "grey_to_yuv");
 		m_ids[PLANE_U] = { id, 0 };
 		m_ids[PLANE_V] = { id, 0 };
 
@@ -680,38 +1089,56 @@ private:
 		m_state.planes[PLANE_V].format = format;
 	}
 
-	void premultiply(FilterObserver &observer)
+	void premultiply(const params &params, FilterObserver &observer)
 	{
 		iassert(m_state.alpha == AlphaType::STRAIGHT);
-		check_is_444_float(true);
+		check_is_444(m_state.planes[PLANE_Y].format.type, true);
 
 		observer.premultiply();
 
-		auto filter = std::make_unique<PremultiplyFilter>(
-			m_state.planes[PLANE_Y].width, m_state.planes[PLANE_Y].height);
+		// Luma and chroma are premultiplied around different integer offsets.
+		std::unique_ptr<PremultiplyFilter> filters[2];
 		for (unsigned p = 0; p < (m_state.has_chroma() ? 3U : 1U); ++p) {
+			std::unique_ptr<PremultiplyFilter> &filter = filters[p ? 1 : 0];
+			if (!filter) {
+				filter = std::make_unique<PremultiplyFilter>(
+					m_state.planes[p].width, m_state.planes[p].height, m_state.planes[p].format, params.cpu);
+			}
+
 			graphengine::node_dep_desc deps[2] = { m_ids[p], m_ids[PLANE_A] };
-			m_ids[p] = { m_graph.add_transform(filter.get(), deps), 0 };
+			m_ids[p] = { m_graph.add_transform(filter.get(), deps, "premultiply", p), 0 };
+			m_state.planes[p].format = premultiplied_format(m_state.planes[p].format);
+		}
+		for (std::unique_ptr<PremultiplyFilter> &filter : filters) {
+			if (filter)
+				m_graph.save_filter(std::move(filter));
 		}
-		m_graph.save_filter(std::move(filter));
 
 		m_state.alpha = AlphaType::PREMULTIPLIED;
 	}
 
-	void unpremultiply(FilterObserver &observer)
+	void unpremultiply(const params &params, FilterObserver &observer)
 	{
 		iassert(m_state.alpha == AlphaType::PREMULTIPLIED);
-		check_is_444_float(true);
+		check_is_444(m_state.planes[PLANE_Y].format.type, true);
 
 		observer.unpremultiply();
 
-		auto filter = std::make_unique<UnpremultiplyFilter>(
-			m_state.planes[PLANE_Y].width, m_state.planes[PLANE_Y].height);
+		std::unique_ptr<UnpremultiplyFilter> filters[2];
 		for (unsigned p = 0; p < (m_state.has_chroma() ? 3U : 1U); ++p) {
-			graphengine::node_dep_desc deps[2] = {m_ids[p], m_ids[PLANE_A]};
-			m_ids[p] = { m_graph.add_transform(filter.get(), deps), 0 };
+			std::unique_ptr<UnpremultiplyFilter> &filter = filters[p ? 1 : 0];
+			if (!filter) {
+				filter = std::make_unique<UnpremultiplyFilter>(
+					m_state.planes[p].width, m_state.planes[p].height, m_state.planes[p].format, params.cpu);
+			}
+
+			graphengine::node_dep_desc deps[2] = { m_ids[p], m_ids[PLANE_A] };
+			m_ids[p] = { m_graph.add_transform(filter.get(), deps, "unpremultiply", p), 0 };
+		}
+		for (std::unique_ptr<UnpremultiplyFilter> &filter : filters) {
+			if (filter)
+				m_graph.save_filter(std::move(filter));
 		}
-		m_graph.save_filter(std::move(filter));
 
 		m_state.alpha = AlphaType::STRAIGHT;
 	}
@@ -734,26 +1161,45 @@ private:
 
 		auto filter = std::make_unique<ValueInitializeFilter>(
 			m_state.planes[PLANE_Y].width, m_state.planes[PLANE_Y].height, format.type, val);
-		m_ids[PLANE_A] = { m_graph.add_transform(m_graph.save_filter(std::move(filter)), nullptr), 0 };
+		m_ids[PLANE_A] = { m_graph.add_transform(m_graph.save_filter(std::move(filter)), nullptr, "add_opaque", PLANE_A), 0 };
 
 		m_state.alpha = type;
 		m_state.alpha_from_luma();
 	}
 
+	bool is_single_pass_resize(const internal_state &target, int p)
+	{
+		const internal_state::plane &src_plane = m_state.planes[p];
+		const internal_state::plane &dst_plane = target.planes[p];
+
+		// Mirrors the conditions under which ResizeConversion skips a pass.
+		auto is_full_width = [](const internal_state::plane &plane) { return plane.active_left == 0 && plane.active_width == plane.width; };
+		auto is_full_height = [](const internal_state::plane &plane) { return plane.active_top == 0 && plane.active_height == plane.height; };
+
+		bool skip_h = src_plane.width == dst_plane.width && is_full_width(src_plane) && is_full_width(dst_plane);
+		bool skip_v = src_plane.height == dst_plane.height && is_full_height(src_plane) && is_full_height(dst_plane);
+		return skip_h || skip_v;
+	}
+
 	PixelFormat choose_resize_format(const internal_state &target, const params &params, int p)
 	{
 		if (params.unresize)
 			return PixelType::FLOAT;
 
-		bool supported[4] = { false, true, cpu_has_fast_f16(params.cpu), true };
+		PixelFormat src_format = m_state.planes[p].format;
+		PixelFormat dst_format = target.planes[p].format;
+
+		// Only resize in BYTE if no depth conversion is needed. Two-pass 8-bit
+		// resizes keep a 16-bit intermediate between the passes.
+		bool byte_ok = src_format.type == PixelType::BYTE && dst_format.type == PixelType::BYTE &&
+			src_format.depth == dst_format.depth && src_format.fullrange == dst_format.fullrange &&
+			resize::byte_resize_supported() && (is_single_pass_resize(target, p) || src_format.depth == 8);
+		bool supported[4] = { byte_ok, true, cpu_has_fast_f16(params.cpu), true };
 		auto is_supported_type = [=](PixelType type) { return supported[static_cast<int>(type)]; };
 
 		double src_pels = static_cast<double>(m_state.planes[p].width) * m_state.planes[p].height;
 		double dst_pels = static_cast<double>(target.planes[p].width) * target.planes[p].height;
 
-		PixelFormat src_format = m_state.planes[p].format;
-		PixelFormat dst_format = target.planes[p].format;
-
 		// If both formats are supported, pick the one that ends up converting the fewest pixels.
 		if (is_supported_type(src_format.type) && is_supported_type(dst_format.type))
 			return src_pels < dst_pels ? dst_format : src_format;
@@ -777,6 +1223,16 @@ private:
 		if (!needs_resize_plane(target, p))
 			return;
 
+		internal_state::plane dst_plane = target.planes[p];
+		dst_plane.format = m_state.planes[p].format;
+
+		GraphCache::Key key = make_memo_key(Operation::RESIZE, mask);
+		add_plane_key(key, dst_plane);
+		memoize(std::move(key), mask, [&]() { create_resize(target, params, observer, mask, p); });
+	}
+
+	void create_resize(const internal_state &target, const params &params, FilterObserver &observer, plane_mask mask, int p)
+	{
 		const internal_state::plane &src_plane = m_state.planes[p];
 		const internal_state::plane &dst_plane = target.planes[p];
 
@@ -799,6 +1255,7 @@ private:
 
 		std::unique_ptr<graphengine::Filter> first;
 		std::unique_ptr<graphengine::Filter> second;
+		std::unique_ptr<graphengine::Filter> chroma;
 
 		if (params.unresize) {
 			unresize::UnresizeConversion conv{ src_plane.width, src_plane.height, src_plane.format.type };
@@ -827,15 +1284,29 @@ private:
 
 			observer.resize(conv, p);
 
-			auto filter_list = conv.create();
-			first = std::move(filter_list.first);
-			second = std::move(filter_list.second);
+			// Upsample both chroma planes in a single pass if the filter is short enough.
+			if (p == PLANE_U && mask[PLANE_V])
+				chroma = resize::create_chroma_upsample(conv);
+
+			if (!chroma) {
+				auto filter_list = conv.create();
+				first = std::move(filter_list.first);
+				second = std::move(filter_list.second);
+			}
 		}
 
+		const char *name = params.unresize ? "unresize" : "resize";
 		if (first)
-			attach_greyscale_filter(m_graph.save_filter(std::move(first)), mask);
+			attach_greyscale_filter(m_graph.save_filter(std::move(first)), mask, name);
 		if (second)
-			attach_greyscale_filter(m_graph.save_filter(std::move(second)), mask);
+			attach_greyscale_filter(m_graph.save_filter(std::move(second)), mask, name);
+
+		if (chroma) {
+			graphengine::node_dep_desc deps[2] = { m_ids[PLANE_U], m_ids[PLANE_V] };
+			graphengine::node_id id = m_graph.add_transform(m_graph.save_filter(std::move(chroma)), deps, name);
+			m_ids[PLANE_U] = { id, 0 };
+			m_ids[PLANE_V] = { id, 1 };
+		}
 
 		apply_mask(mask, [&](int q)
 		{
@@ -845,19 +1316,30 @@ private:
 		});
 	}
 
-	void convert_colorspace(const colorspace::ColorspaceDefinition &csp, const params &params, FilterObserver &observer)
+	void convert_colorspace(const colorspace::ColorspaceDefinition &csp, const PixelFormat &format, const params &params, FilterObserver &observer)
 	{
 		iassert(m_state.color != ColorFamily::GREY);
-		check_is_444_float(false);
+		check_is_444(m_state.planes[PLANE_Y].format.type, false);
 
 		if (m_state.colorspace == csp)
 			return;
 
+		GraphCache::Key key = make_memo_key(Operation::COLORSPACE, luma_planes | chroma_planes);
+		key.add(static_cast<int>(csp.matrix)).add(static_cast<int>(csp.transfer)).add(static_cast<int>(csp.primaries));
+		add_format_key(key, format);
+		memoize(std::move(key), luma_planes | chroma_planes, [&]() { create_colorspace(csp, format, params, observer); });
+	}
+
+	void create_colorspace(const colorspace::ColorspaceDefinition &csp, const PixelFormat &format, const params &params, FilterObserver &observer)
+	{
 		colorspace::ColorspaceConversion conv{ m_state.planes[0].width, m_state.planes[0].height };
 		conv.set_csp_in(m_state.colorspace)
 			.set_csp_out(csp)
+			.set_pixel_in(m_state.planes[PLANE_Y].format)
+			.set_pixel_out(format)
 			.set_approximate_gamma(params.approximate_gamma)
 			.set_scene_referred(params.scene_referred)
+			.set_lut_size(params.colorspace_lut_size)
 			.set_cpu(params.cpu);
 		if (!std::isnan(params.peak_luminance))
 			conv.set_peak_luminance(params.peak_luminance);
@@ -866,21 +1348,19 @@ private:
 
 		auto filter = conv.create();
 		if (filter) {
-			graphengine::node_id id = m_graph.add_transform(m_graph.save_filter(std::move(filter)), m_ids.data());
+			graphengine::node_id id = m_graph.add_transform(m_graph.save_filter(std::move(filter)), m_ids.data(), "colorspace");
 			m_ids[PLANE_Y] = { id, 0 };
 			m_ids[PLANE_U] = { id, 1 };
 			m_ids[PLANE_V] = { id, 2 };
 		}
 
-		if (csp.matrix == colorspace::MatrixCoefficients::RGB) {
-			m_state.color = ColorFamily::RGB;
-			m_state.planes[PLANE_U].format.chroma = false;
-			m_state.planes[PLANE_V].format.chroma = false;
-		} else {
-			m_state.color = ColorFamily::YUV;
-			m_state.planes[PLANE_U].format.chroma = true;
-			m_state.planes[PLANE_V].format.chroma = true;
-		}
+		bool yuv = csp.matrix != colorspace::MatrixCoefficients::RGB;
+		bool ycgco = csp.matrix == colorspace::MatrixCoefficients::YCGCO;
+
+		m_state.color = yuv ? ColorFamily::YUV : ColorFamily::RGB;
+		m_state.planes[PLANE_Y].format = { format.type, format.depth, format.fullrange, false, ycgco };
+		m_state.planes[PLANE_U].format = { format.type, format.depth, format.fullrange, yuv, ycgco };
+		m_state.planes[PLANE_V].format = m_state.planes[PLANE_U].format;
 		m_state.colorspace = csp;
 	}
 
@@ -889,20 +1369,32 @@ private:
 		if (m_state.planes[p].format == format)
 			return;
 
+		GraphCache::Key key = make_memo_key(Operation::DEPTH, mask);
+		add_format_key(key, format);
+		memoize(std::move(key), mask, [&]() { create_depth(format, params, observer, mask, p); });
+	}
+
+	void create_depth(const PixelFormat &format, const params &params, FilterObserver &observer, plane_mask mask, int p)
+	{
 		depth::DepthConversion conv{ m_state.planes[p].width, m_state.planes[p].height };
 		conv.set_pixel_in(m_state.planes[p].format)
 			.set_pixel_out(format)
 			.set_dither_type(params.dither_type)
 			.set_planes(mask)
-			.set_cpu(params.cpu);
+			.set_cpu(params.cpu)
+			.set_error_diffusion_threads(params.error_diffusion_threads);
 
 		observer.depth(conv, p);
 
+		// Error diffusion runs its blocks of rows on threads owned by the graph.
+		if (params.dither_type == depth::DitherType::ERROR_DIFFUSION && params.error_diffusion_threads > 1)
+			m_wavefront_threads = std::max(m_wavefront_threads, params.error_diffusion_threads);
+
 		auto result = conv.create();
 		apply_mask(mask, [&](int q)
 		{
 			if (result.filter_refs[q])
-				m_ids[q] = { m_graph.add_transform(result.filter_refs[q], &m_ids[q]), 0 };
+				m_ids[q] = { m_graph.add_transform(result.filter_refs[q], &m_ids[q], "depth", q), 0 };
 		});
 		for (auto &&filter : result.filters) {
 			m_graph.save_filter(std::move(filter));
@@ -948,15 +1440,24 @@ private:
 			unsigned left = static_cast<unsigned>(m_state.planes[p].active_left - tmp.planes[p].active_left);
 			unsigned top = static_cast<unsigned>(m_state.planes[p].active_top - tmp.planes[p].active_top);
 
-			observer.subrectangle(left, top, tmp.planes[p].width, tmp.planes[p].height, p);
+			internal_state::plane dst_plane = tmp.planes[p];
+			dst_plane.format = format;
 
-			auto filter = std::make_unique<CopyRectFilter>(left, top, tmp.planes[p].width, tmp.planes[p].height, format.type);
-			attach_greyscale_filter(m_graph.save_filter(std::move(filter)), mask);
+			GraphCache::Key key = make_memo_key(Operation::COPY, mask);
+			add_plane_key(key, dst_plane);
 
-			apply_mask(mask, [&](int q)
+			memoize(std::move(key), mask, [&]()
 			{
-				m_state.planes[q] = tmp.planes[q];
-				m_state.planes[q].format = format;
+				observer.subrectangle(left, top, tmp.planes[p].width, tmp.planes[p].height, p);
+
+				auto filter = std::make_unique<CopyRectFilter>(left, top, tmp.planes[p].width, tmp.planes[p].height, format.type);
+				attach_greyscale_filter(m_graph.save_filter(std::move(filter)), mask, "copy");
+
+				apply_mask(mask, [&](int q)
+				{
+					m_state.planes[q] = tmp.planes[q];
+					m_state.planes[q].format = format;
+				});
 			});
 
 			iassert(!needs_resize_plane(tmp, p));
@@ -986,6 +1487,30 @@ private:
 			connect_plane(target, params, observer, ConnectMode::CHROMA, reinterpret_range);
 	}
 
+	bool can_use_integer_colorspace(const internal_state &target, const params &params)
+	{
+		// The fixed-point matrix rounds directly to the output depth, so it is not used when dithering.
+		if (params.unresize || params.dither_type != depth::DitherType::NONE)
+			return false;
+		if (!m_state.has_chroma())
+			return false;
+
+		return colorspace::is_integer_conversion_supported(m_state.colorspace, target.colorspace,
+			m_state.planes[PLANE_Y].format, target.planes[PLANE_Y].format);
+	}
+
+	bool can_use_integer_transfer(const internal_state &target, const params &params)
+	{
+		// The 3D LUT is sampled from FLOAT input.
+		if (params.colorspace_lut_size && colorspace::is_lut3d_supported(m_state.colorspace))
+			return false;
+		if (m_state.color != ColorFamily::RGB)
+			return false;
+
+		return colorspace::is_integer_transfer_supported(m_state.colorspace, target.colorspace,
+			m_state.planes[PLANE_Y].format, PixelType::FLOAT, params.approximate_gamma, params.scene_referred);
+	}
+
 	void connect_color_channels(const internal_state &target, const params &params, FilterObserver &observer)
 	{
 		if (needs_colorspace(target)) {
@@ -1001,6 +1526,20 @@ private:
 			tmp.planes[PLANE_Y].active_width = w.planes[PLANE_Y].active_width;
 			tmp.planes[PLANE_Y].active_height = h.planes[PLANE_Y].active_height;
 
+			internal_state::plane geometry = tmp.planes[PLANE_Y];
+			geometry.format = m_state.planes[PLANE_Y].format;
+			bool resampled = geometry != m_state.planes[PLANE_Y];
+
+			// Matrix-only conversions between integer formats skip the round trip through FLOAT.
+			// Integer RGB which is not resampled first is linearized by table lookup.
+			PixelFormat format = PixelType::FLOAT;
+			if (can_use_integer_colorspace(target, params)) {
+				format = target.planes[PLANE_Y].format;
+				tmp.planes[PLANE_Y].format = m_state.planes[PLANE_Y].format;
+			} else if (!resampled && can_use_integer_transfer(target, params)) {
+				tmp.planes[PLANE_Y].format = m_state.planes[PLANE_Y].format;
+			}
+
 			if (tmp.has_chroma())
 				tmp.chroma_from_luma_444();
 
@@ -1012,7 +1551,7 @@ private:
 				grey_to_rgb(matrix, observer);
 			}
 
-			convert_colorspace(target.colorspace, params, observer);
+			convert_colorspace(target.colorspace, format, params, observer);
 			iassert(m_state.colorspace == target.colorspace);
 		}
 
@@ -1046,11 +1585,18 @@ private:
 			internal_state::plane orig_alpha_plane = m_state.planes[PLANE_A];
 			graphengine::node_dep_desc orig_alpha_node = m_ids[PLANE_A];
 
-			internal_state tmp = make_float_444_state(m_state, true);
+			// Integer images are premultiplied to 16 bits, unless they are
+			// converted to FLOAT for a colorspace conversion anyway.
+			const PixelFormat &format_in = m_state.planes[PLANE_Y].format;
+			bool integer = pixel_is_integer(format_in.type) &&
+				pixel_is_integer(target.planes[PLANE_Y].format.type) &&
+				!needs_colorspace(target);
+
+			internal_state tmp = make_444_state(m_state, integer ? format_in : PixelType::FLOAT, true);
 			connect_color_channels(tmp, params, observer);
 			connect_plane(tmp, params, observer, ConnectMode::ALPHA, false);
 
-			premultiply(observer);
+			premultiply(params, observer);
 
 			if (target.has_alpha() && target.planes[PLANE_A] == orig_alpha_plane) {
 				m_ids[PLANE_A] = orig_alpha_node;
@@ -1068,11 +1614,22 @@ private:
 			internal_state::plane orig_alpha_plane = m_state.planes[PLANE_A];
 			graphengine::node_dep_desc orig_alpha_node = m_ids[PLANE_A];
 
-			internal_state tmp = make_float_444_state(target, true);
+			const PixelFormat &format_out = target.planes[PLANE_Y].format;
+			bool integer = pixel_is_integer(m_state.planes[PLANE_Y].format.type) &&
+				pixel_is_integer(format_out.type) &&
+				!needs_colorspace(target);
+
+			PixelFormat format = PixelType::FLOAT;
+			if (integer) {
+				format = premultiplied_format(format_out);
+				format.chroma = false;
+			}
+
+			internal_state tmp = make_444_state(target, format, true);
 			connect_color_channels(tmp, params, observer);
 			connect_plane(tmp, params, observer, ConnectMode::ALPHA, false);
 
-			unpremultiply(observer);
+			unpremultiply(params, observer);
 
 			if (target.has_alpha() && target.planes[PLANE_A] == orig_alpha_plane) {
 				m_ids[PLANE_A] = orig_alpha_node;
@@ -1097,7 +1654,8 @@ public:
 		m_ids(),
 		m_source_state{},
 		m_state{},
-		m_requires_64b{}
+		m_requires_64b{},
+		m_wavefront_threads{}
 	{
 		std::fill(m_ids.begin(), m_ids.end(), graphengine::null_dep);
 	}
@@ -1110,6 +1668,7 @@ public:
 		m_source_state = source;
 		m_state = internal_state{ source };
 		m_requires_64b = false;
+		m_wavefront_threads = 0;
 
 		m_ids[PLANE_Y] = m_graph.source_plane_0();
 		if (m_state.has_chroma()) {
@@ -1120,13 +1679,24 @@ public:
 			m_ids[PLANE_A] = m_graph.source_plane_3();
 	}
 
-	void connect(const state &target, const params &params, FilterObserver &observer)
+	void begin_connect(const params &params)
 	{
 		if (!m_state.planes[0].width)
 			error::throw_<error::InternalError>("graph not initialized");
+		if (!m_outputs.empty())
+			error::throw_<error::InternalError>("graph already has multiple outputs");
 
-		internal_state internal_target{ target };
-		connect_internal(internal_target, params, observer);
+		if (params.profile && !m_graph.profiling_enabled())
+			m_graph.enable_profiling(pixel_size(m_source_state.type));
+		if (params.fuse_filters)
+			m_graph.enable_fusion();
+
+		m_memo.clear();
+	}
+
+	void end_connect(const params &params)
+	{
+		m_memo.clear();
 
 		if (true
 #ifdef ZIMG_X86
@@ -1137,29 +1707,70 @@ public:
 		}
 	}
 
+	std::vector<unsigned> get_num_sink_planes() const
+	{
+		auto num_planes = [](const internal_state &state) { return 1U + (state.has_chroma() ? 2 : 0) + (state.has_alpha() ? 1 : 0); };
+
+		if (m_outputs.empty())
+			return{ num_planes(m_state) };
+
+		std::vector<unsigned> result;
+		std::transform(m_outputs.begin(), m_outputs.end(), std::back_inserter(result), [&](const output &out) { return num_planes(out.state); });
+		return result;
+	}
+
+	void connect(const state &target, const params &params, FilterObserver &observer)
+	{
+		begin_connect(params);
+
+		internal_state internal_target{ target };
+		connect_internal(internal_target, params, observer);
+
+		end_connect(params);
+	}
+
+	void connect(const state targets[], unsigned num_targets, bool chain, const params &params, FilterObserver &observer)
+	{
+		begin_connect(params);
+
+		// Each target is a branch from the current node, or from the previous target in a chain.
+		output branch{ m_state, m_ids };
+
+		for (unsigned i = 0; i < num_targets; ++i) {
+			if (!chain) {
+				m_state = branch.state;
+				m_ids = branch.ids;
+			}
+
+			internal_state internal_target{ targets[i] };
+			connect_internal(internal_target, params, observer);
+			m_outputs.push_back({ m_state, m_ids });
+		}
+
+		end_connect(params);
+	}
+
 	SubGraph build_subgraph()
 	{
 		if (!m_state.planes[0].width)
 			error::throw_<error::InternalError>("graph not initialized");
 
-		std::array<graphengine::node_dep_desc, graphengine::NODE_MAX_PLANES> sink_deps;
-		std::fill(sink_deps.begin(), sink_deps.end(), graphengine::null_dep);
+		if (m_outputs.empty())
+			m_outputs.push_back({ m_state, m_ids });
 
-		unsigned num_sink_deps;
-		{
-			auto sink_deps_it = sink_deps.begin();
+		// The planes of all outputs are concatenated.
+		std::vector<graphengine::node_dep_desc> sink_deps;
 
-			*sink_deps_it++ = m_ids[PLANE_Y];
-			if (m_state.has_chroma()) {
-				*sink_deps_it++ = m_ids[PLANE_U];
-				*sink_deps_it++ = m_ids[PLANE_V];
+		for (const output &out : m_outputs) {
+			sink_deps.push_back(out.ids[PLANE_Y]);
+			if (out.state.has_chroma()) {
+				sink_deps.push_back(out.ids[PLANE_U]);
+				sink_deps.push_back(out.ids[PLANE_V]);
 			}
-			if (m_state.has_alpha())
-				*sink_deps_it++ = m_ids[PLANE_A];
-
-			num_sink_deps = static_cast<unsigned>(sink_deps_it - sink_deps.begin());
+			if (out.state.has_alpha())
+				sink_deps.push_back(out.ids[PLANE_A]);
 		}
-		m_graph.set_sink(num_sink_deps, sink_deps.data());
+		m_graph.set_sink(static_cast<unsigned>(sink_deps.size()), sink_deps.data());
 
 		SubGraph result = std::move(m_graph);
 		*this = impl();
@@ -1169,7 +1780,7 @@ public:
 	std::unique_ptr<FilterGraph> build_graph()
 	{
 		state source_state = m_source_state;
-		unsigned num_sink_planes = 1 + (m_state.has_chroma() ? 2 : 0) + (m_state.has_alpha() ? 1 : 0);
+		std::vector<unsigned> num_sink_planes = get_num_sink_planes();
 
 		SubGraph subgraph = build_subgraph();
 		std::unique_ptr<graphengine::Graph> real_graph = std::make_unique<graphengine::GraphImpl>();
@@ -1199,16 +1810,69 @@ public:
 		}
 		auto real_sink_deps = subgraph.connect(real_graph.get(), source_deps.data());
 
+		// Mirror the graph for rectangle-based execution. Planes are addressed
+		// by their position in the user buffer. Only single outputs are supported.
+		std::unique_ptr<TileGraph> tile_graph;
+		if (num_sink_planes.size() == 1) {
+			tile_graph = std::make_unique<TileGraph>();
+
+			std::array<graphengine::PlaneDescriptor, PLANE_NUM> tile_source_desc{};
+			std::array<graphengine::node_dep_desc, PLANE_NUM> tile_source_deps;
+			std::array<graphengine::node_dep_desc, PLANE_NUM> tile_sink_deps;
+			std::fill(tile_sink_deps.begin(), tile_sink_deps.end(), graphengine::null_dep);
+
+			tile_source_desc[PLANE_Y] = source_desc[0];
+			if (source_state.color != ColorFamily::GREY) {
+				tile_source_desc[PLANE_U] = source_desc[1];
+				tile_source_desc[PLANE_V] = source_desc[2];
+			}
+			if (source_state.alpha != AlphaType::NONE)
+				tile_source_desc[PLANE_A] = source_desc[num_source_planes - 1];
+
+			graphengine::node_id tile_source_id = tile_graph->add_source(tile_source_desc.data());
+			for (unsigned p = 0; p < PLANE_NUM; ++p) {
+				tile_source_deps[p] = { tile_source_id, p };
+			}
+
+			auto tile_real_sink_deps = subgraph.connect(tile_graph.get(), tile_source_deps.data());
+			auto tile_real_sink_it = tile_real_sink_deps.begin();
+
+			tile_sink_deps[PLANE_Y] = *tile_real_sink_it++;
+			if (num_sink_planes[0] >= 3) {
+				tile_sink_deps[PLANE_U] = *tile_real_sink_it++;
+				tile_sink_deps[PLANE_V] = *tile_real_sink_it++;
+			}
+			if (num_sink_planes[0] == 2 || num_sink_planes[0] == 4)
+				tile_sink_deps[PLANE_A] = *tile_real_sink_it++;
+
+			tile_graph->set_sink(tile_sink_deps.data());
+		}
+
 		// Compile the final graph.
-		graphengine::node_id sink_id = real_graph->add_sink(num_sink_planes, real_sink_deps.data());
-		auto finished_graph = std::make_unique<FilterGraph>(std::move(real_graph), subgraph.release_filters_opaque(), source_id, sink_id);
+		std::vector<graphengine::node_id> sink_ids;
+		size_t sink_offset = 0;
+
+		for (unsigned n : num_sink_planes) {
+			sink_ids.push_back(real_graph->add_sink(n, real_sink_deps.data() + sink_offset));
+			sink_offset += n;
+		}
+
+		auto finished_graph = std::make_unique<FilterGraph>(std::move(real_graph), subgraph.release_filters_opaque(), source_id, std::move(sink_ids));
+		if (tile_graph)
+			finished_graph->set_tile_graph(std::move(tile_graph));
+		if (subgraph.profiling_enabled())
+			finished_graph->set_profiler(subgraph.release_profiler());
 		if (m_requires_64b)
 			finished_graph->set_requires_64b_alignment();
+		if (m_wavefront_threads)
+			finished_graph->set_wavefront_threads(m_wavefront_threads);
 
 		if (num_source_planes == 2)
 			finished_graph->set_source_greyalpha();
-		if (num_sink_planes == 2)
-			finished_graph->set_sink_greyalpha();
+		for (unsigned i = 0; i < num_sink_planes.size(); ++i) {
+			if (num_sink_planes[i] == 2)
+				finished_graph->set_sink_greyalpha(i);
+		}
 
 		return finished_graph;
 	}
@@ -1223,7 +1887,11 @@ GraphBuilder::params::params() noexcept :
 	peak_luminance{ NAN },
 	approximate_gamma{},
 	scene_referred{},
-	cpu{ CPUClass::AUTO }
+	colorspace_lut_size{},
+	error_diffusion_threads{},
+	cpu{ CPUClass::AUTO },
+	profile{},
+	fuse_filters{ true }
 {
 	static const resize::BicubicFilter bicubic;
 	static const resize::BilinearFilter bilinear;
@@ -1254,21 +1922,47 @@ GraphBuilder &GraphBuilder::set_source(const state &source) try
 	error::throw_<error::InternalError>(e.what());
 }
 
-GraphBuilder &GraphBuilder::connect(const state &target, const params *params, FilterObserver *observer) try
+GraphBuilder &GraphBuilder::connect(const state &target, const params *params, FilterObserver *observer)
+{
+	return connect(&target, 1, params, observer);
+}
+
+GraphBuilder &GraphBuilder::connect(const state targets[], unsigned num_targets, const params *params, FilterObserver *observer)
+{
+	return connect_multi(targets, num_targets, false, params, observer);
+}
+
+GraphBuilder &GraphBuilder::connect_chain(const state targets[], unsigned num_targets, const params *params, FilterObserver *observer)
+{
+	return connect_multi(targets, num_targets, true, params, observer);
+}
+
+GraphBuilder &GraphBuilder::connect_multi(const state targets[], unsigned num_targets, bool chain, const params *params, FilterObserver *observer) try
 {
 	static const GraphBuilder::params default_params;
 	DefaultFilterObserver default_factory;
 
-	validate_state(target);
-	if (target.active_left != 0 || target.active_top != 0 || target.active_width != target.width || target.active_height != target.height)
-		error::throw_<error::ResamplingNotAvailable>("active subregion not supported on target image");
+	if (!num_targets || num_targets > FilterGraph::MAX_OUTPUTS)
+		error::throw_<error::IllegalArgument>("invalid number of target formats");
+
+	for (unsigned i = 0; i < num_targets; ++i) {
+		const state &target = targets[i];
+
+		validate_state(target);
+		if (target.active_left != 0 || target.active_top != 0 || target.active_width != target.width || target.active_height != target.height)
+			error::throw_<error::ResamplingNotAvailable>("active subregion not supported on target image");
+	}
 
 	if (!params)
 		params = &default_params;
 	if (!observer)
 		observer = &default_factory;
 
-	get_impl()->connect(target, *params, *observer);
+	if (num_targets == 1)
+		get_impl()->connect(targets[0], *params, *observer);
+	else
+		get_impl()->connect(targets, num_targets, chain, *params, *observer);
+
 	return *this;
 } catch (const graphengine::Exception &e) {
 	rethrow_graphengine_exception(e);
@@ -40,6 +40,8 @@ struct UnresizeConversion;
 namespace graph {
 
 class FilterGraph2;
+class FilterProfiler;
+class TileGraph;
 
 /**
  * Observer interface for debugging filter instantiation.
@@ -71,10 +73,27 @@ public:
  */
 class SubGraph {
 private:
+	struct transform_record {
+		graphengine::node_id id;
+		const graphengine::Filter *filter;
+		std::array<graphengine::node_dep_desc, 4> deps;
+		bool point;
+	};
+
 	std::vector<std::unique_ptr<graphengine::Filter>> m_filters;
 	std::unique_ptr<graphengine::SubGraph> m_subgraph;
+	std::unique_ptr<FilterProfiler> m_profiler;
+	std::vector<transform_record> m_transforms;
 	graphengine::node_id m_source_ids[4];
-	graphengine::node_id m_sink_ids[4];
+	std::vector<graphengine::node_id> m_sink_ids;
+	std::vector<graphengine::node_dep_desc> m_sink_deps;
+	graphengine::node_id m_next_id;
+	unsigned m_source_bytes_per_sample;
+	bool m_fusion;
+
+	unsigned get_bytes_per_sample(graphengine::node_dep_desc dep) const;
+
+	void fuse_point_filters();
 public:
 	SubGraph();
 
@@ -91,20 +110,55 @@ public:
 
 	const graphengine::Filter *save_filter(std::unique_ptr<graphengine::Filter> filter);
 
-	graphengine::node_id add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[]);
+	/**
+	 * Add a filter to the subgraph.
+	 *
+	 * @param filter filter
+	 * @param deps dependencies
+	 * @param name stage name for profiling, must have static storage duration
+	 * @param plane plane index for profiling, or -1 for multiple planes
+	 * @return node id
+	 */
+	graphengine::node_id add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[], const char *name, int plane = -1);
+
+	/**
+	 * Instrument subsequently added filters with a profiler.
+	 *
+	 * @param source_bytes_per_sample sample size of the source planes
+	 */
+	void enable_profiling(unsigned source_bytes_per_sample);
+
+	bool profiling_enabled() const { return !!m_profiler; }
 
+	/**
+	 * Merge adjacent point filters into fused filters when the sink is set.
+	 */
+	void enable_fusion() { m_fusion = true; }
+
+	/**
+	 * Set the sink and insert the filters into the subgraph.
+	 *
+	 * The planes of several outputs may be concatenated into a single sink.
+	 *
+	 * @param num_planes number of planes
+	 * @param deps plane dependencies
+	 */
 	void set_sink(unsigned num_planes, const graphengine::node_dep_desc deps[]);
 
-	std::array<graphengine::node_dep_desc, 4> connect(graphengine::Graph *graph, const graphengine::node_dep_desc source_deps[4]) const;
+	std::vector<graphengine::node_dep_desc> connect(graphengine::Graph *graph, const graphengine::node_dep_desc source_deps[4]) const;
+
+	std::vector<graphengine::node_dep_desc> connect(TileGraph *graph, const graphengine::node_dep_desc source_deps[4]) const;
 
 	std::vector<std::unique_ptr<graphengine::Filter>> release_filters();
 
 	std::shared_ptr<void> release_filters_opaque();
+
+	std::unique_ptr<FilterProfiler> release_profiler();
 };
 
 
 /**
- * Models a filter graph with one source node and one sink node.
+ * Models a filter graph with one source node and one or more sink nodes.
  */
 class GraphBuilder {
 	struct internal_state;
@@ -179,7 +233,11 @@ public:
 		double peak_luminance;
 		bool approximate_gamma;
 		bool scene_referred;
+		unsigned colorspace_lut_size;
+		unsigned error_diffusion_threads;
 		CPUClass cpu;
+		bool profile;
+		bool fuse_filters;
 
 		params() noexcept;
 	};
@@ -189,6 +247,8 @@ private:
 	std::unique_ptr<impl> m_impl;
 
 	impl *get_impl() noexcept { return m_impl.get(); }
+
+	GraphBuilder &connect_multi(const state targets[], unsigned num_targets, bool chain, const params *params, FilterObserver *observer);
 public:
 	/**
 	 * Default construct GraphBuilder, creating an empty graph.
@@ -228,6 +288,40 @@ public:
 	 */
 	GraphBuilder &connect(const state &target, const params *params, FilterObserver *observer = nullptr);
 
+	/**
+	 * Convert current graph node to several target formats.
+	 *
+	 * Each target becomes a separate output of the graph, in the order given.
+	 * Operations shared between the targets, such as the conversion of the
+	 * current format to a common intermediate, are only instantiated once.
+	 * The observer is not called again for shared operations.
+	 *
+	 * No further connections can be made after this call.
+	 *
+	 * @param targets image formats
+	 * @param num_targets number of targets
+	 * @param params filter instantiation parameters
+	 * @param observer observer
+	 */
+	GraphBuilder &connect(const state targets[], unsigned num_targets, const params *params, FilterObserver *observer = nullptr);
+
+	/**
+	 * Convert current graph node to a chain of target formats.
+	 *
+	 * Like the multiple target overload of GraphBuilder::connect, except that
+	 * each target is converted from the previous target rather than from the
+	 * current node. This builds image pyramids in which every level is
+	 * resized from the level above it, one row band at a time.
+	 *
+	 * No further connections can be made after this call.
+	 *
+	 * @param targets image formats
+	 * @param num_targets number of targets
+	 * @param params filter instantiation parameters
+	 * @param observer observer
+	 */
+	GraphBuilder &connect_chain(const state targets[], unsigned num_targets, const params *params, FilterObserver *observer = nullptr);
+
 	/**
 	 * Finalize and return a partial graph.
 	 *
@@ -241,7 +335,8 @@ public:
 	/**
 	 * Finalize and return a complete filter graph.
 	 *
-	 * Returns a graph with the output node set to the current format.
+	 * Returns a graph with the output node set to the current format, or one
+	 * output node per target if several targets were connected.
 	 *
 	 * @return graph
 	 */
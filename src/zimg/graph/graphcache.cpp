@@ -0,0 +1,160 @@
+#include <cmath>
+#include <limits>
+#include "common/except.h"
+#include "filtergraph.h"
+#include "graphcache.h"
+
+namespace zimg {
+namespace graph {
+
+GraphCache::Key &GraphCache::Key::add(double x)
+{
+	// Equal values must have equal representations.
+	if (std::isnan(x))
+		x = std::numeric_limits<double>::quiet_NaN();
+	else if (x == 0.0)
+		x = 0.0;
+
+	append_raw(x);
+	return *this;
+}
+
+GraphCache::Key &GraphCache::Key::add(const GraphBuilder::state &state)
+{
+	add(state.width);
+	add(state.height);
+	add(static_cast<int>(state.type));
+	add(state.subsample_w);
+	add(state.subsample_h);
+
+	add(static_cast<int>(state.color));
+	add(static_cast<int>(state.colorspace.matrix));
+	add(static_cast<int>(state.colorspace.transfer));
+	add(static_cast<int>(state.colorspace.primaries));
+
+	add(state.depth);
+	add(state.fullrange);
+
+	add(static_cast<int>(state.parity));
+	add(static_cast<int>(state.chroma_location_w));
+	add(static_cast<int>(state.chroma_location_h));
+
+	add(state.active_left);
+	add(state.active_top);
+	add(state.active_width);
+	add(state.active_height);
+
+	add(static_cast<int>(state.alpha));
+	return *this;
+}
+
+GraphCache::Key &GraphCache::Key::add(const GraphBuilder::params &params)
+{
+	// Resize filters are identified by the caller.
+	add(params.unresize);
+	add(static_cast<int>(params.dither_type));
+	add(params.peak_luminance);
+	add(params.approximate_gamma);
+	add(params.scene_referred);
+	add(params.colorspace_lut_size);
+	add(params.error_diffusion_threads);
+	add(static_cast<int>(params.cpu));
+	add(params.profile);
+	add(params.fuse_filters);
+	return *this;
+}
+
+
+GraphCache::GraphCache() : m_stats{} {}
+
+GraphCache::~GraphCache() = default;
+
+GraphCache &GraphCache::instance()
+{
+	static GraphCache cache;
+	return cache;
+}
+
+void GraphCache::shrink(size_t capacity)
+{
+	while (m_lru.size() > capacity) {
+		m_map.erase(m_lru.back().first);
+		m_lru.pop_back();
+		++m_stats.evictions;
+	}
+}
+
+void GraphCache::set_capacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_stats.capacity = capacity;
+	shrink(capacity);
+}
+
+bool GraphCache::enabled() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_stats.capacity != 0;
+}
+
+void GraphCache::clear()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_map.clear();
+	m_lru.clear();
+}
+
+GraphCache::stats GraphCache::get_stats() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	stats result = m_stats;
+	result.size = m_lru.size();
+	return result;
+}
+
+std::unique_ptr<FilterGraph> GraphCache::find(const Key &key) try
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_map.find(key);
+	if (it == m_map.end()) {
+		++m_stats.misses;
+		return nullptr;
+	}
+
+	m_lru.splice(m_lru.begin(), m_lru, it->second);
+	++m_stats.hits;
+	return it->second->second->clone();
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+void GraphCache::insert(const Key &key, const FilterGraph &graph) try
+{
+	std::shared_ptr<const FilterGraph> entry = graph.clone();
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (!m_stats.capacity)
+		return;
+
+	// Another thread may have built the same graph concurrently.
+	auto it = m_map.find(key);
+	if (it != m_map.end()) {
+		m_lru.splice(m_lru.begin(), m_lru, it->second);
+		return;
+	}
+
+	m_lru.emplace_front(key, std::move(entry));
+	try {
+		m_map.emplace(key, m_lru.begin());
+	} catch (...) {
+		m_lru.pop_front();
+		throw;
+	}
+	shrink(m_stats.capacity);
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,117 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_GRAPHCACHE_H_
+#define ZIMG_GRAPH_GRAPHCACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "graphbuilder.h"
+
+namespace zimg {
+namespace graph {
+
+class FilterGraph;
+
+/**
+ * Bounded LRU cache of compiled graphs.
+ *
+ * Entries are shared with the handles returned from the cache, so evicting
+ * an entry does not invalidate graphs in use.
+ */
+class GraphCache {
+public:
+	/**
+	 * Canonical byte representation of a graph request.
+	 */
+	class Key {
+		std::string m_data;
+
+		template <class T>
+		void append_raw(const T &x) { m_data.append(reinterpret_cast<const char *>(&x), sizeof(x)); }
+	public:
+		Key &add(const GraphBuilder::state &state);
+		Key &add(const GraphBuilder::params &params);
+
+		Key &add(unsigned x) { append_raw(x); return *this; }
+		Key &add(int x) { append_raw(x); return *this; }
+		Key &add(bool x) { append_raw(static_cast<unsigned char>(x)); return *this; }
+		Key &add(double x);
+
+		const std::string &data() const { return m_data; }
+
+		bool operator==(const Key &other) const { return m_data == other.m_data; }
+	};
+
+	struct stats {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions;
+		size_t size;
+		size_t capacity;
+	};
+private:
+	struct key_hash {
+		size_t operator()(const Key &key) const { return std::hash<std::string>{}(key.data()); }
+	};
+
+	typedef std::list<std::pair<Key, std::shared_ptr<const FilterGraph>>> lru_list;
+
+	lru_list m_lru;
+	std::unordered_map<Key, lru_list::iterator, key_hash> m_map;
+	mutable std::mutex m_mutex;
+	stats m_stats;
+
+	void shrink(size_t capacity);
+public:
+	GraphCache();
+
+	~GraphCache();
+
+	/**
+	 * Get the process-wide instance. The cache is disabled by default.
+	 *
+	 * @return cache
+	 */
+	static GraphCache &instance();
+
+	/**
+	 * Set the maximum number of entries. A capacity of zero disables the
+	 * cache and removes all entries.
+	 *
+	 * @param capacity number of entries
+	 */
+	void set_capacity(size_t capacity);
+
+	bool enabled() const;
+
+	void clear();
+
+	stats get_stats() const;
+
+	/**
+	 * Look up a graph, counting a hit or a miss.
+	 *
+	 * @param key request
+	 * @return new handle sharing the cached graph, or null if not found
+	 */
+	std::unique_ptr<FilterGraph> find(const Key &key);
+
+	/**
+	 * Insert a graph as the most recently used entry.
+	 *
+	 * @param key request
+	 * @param graph graph to share
+	 */
+	void insert(const Key &key, const FilterGraph &graph);
+};
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_GRAPHCACHE_H_
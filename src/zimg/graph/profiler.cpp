@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <chrono>
+#include "common/except.h"
+#include "graphengine/filter.h"
+#include "profiler.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+thread_local uint64_t *g_skipped_counter = nullptr;
+
+} // namespace
+
+
+class FilterProfiler::ProfilingFilter : public graphengine::Filter {
+	const graphengine::Filter *m_filter;
+	const char *m_name;
+	int m_plane;
+	unsigned m_input_bytes_per_sample[graphengine::NODE_MAX_PLANES];
+	mutable counters m_counters;
+public:
+	ProfilingFilter(const graphengine::Filter *filter, const char *name, int plane, const unsigned input_bytes_per_sample[]) :
+		m_filter{ filter },
+		m_name{ name },
+		m_plane{ plane },
+		m_input_bytes_per_sample{},
+		m_counters{}
+	{
+		std::copy_n(input_bytes_per_sample, filter->descriptor().num_deps, m_input_bytes_per_sample);
+	}
+
+	int version() const noexcept override { return m_filter->version(); }
+
+	const graphengine::FilterDescriptor &descriptor() const noexcept override { return m_filter->descriptor(); }
+
+	pair_unsigned get_row_deps(unsigned i) const noexcept override { return m_filter->get_row_deps(i); }
+
+	pair_unsigned get_col_deps(unsigned left, unsigned right) const noexcept override { return m_filter->get_col_deps(left, right); }
+
+	void init_context(void *context) const noexcept override { m_filter->init_context(context); }
+
+	void process(const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+	             unsigned i, unsigned left, unsigned right, void *context, void *tmp) const noexcept override
+	{
+		uint64_t skipped = 0;
+		uint64_t *prev_counter = g_skipped_counter;
+		g_skipped_counter = &skipped;
+
+		auto start = std::chrono::steady_clock::now();
+		m_filter->process(in, out, i, left, right, context, tmp);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+
+		g_skipped_counter = prev_counter;
+
+		const graphengine::FilterDescriptor &desc = m_filter->descriptor();
+		uint64_t rows = std::min(desc.step, desc.format.height - i);
+		uint64_t pixels = (right - left) * rows * desc.num_planes;
+
+		auto row_range = m_filter->get_row_deps(i);
+		auto col_range = m_filter->get_col_deps(left, right);
+		uint64_t input_pixels = static_cast<uint64_t>(row_range.second - row_range.first) * (col_range.second - col_range.first);
+		uint64_t bytes_read = 0;
+
+		for (unsigned p = 0; p < desc.num_deps; ++p) {
+			bytes_read += input_pixels * m_input_bytes_per_sample[p];
+		}
+
+		m_counters.calls.fetch_add(1, std::memory_order_relaxed);
+		m_counters.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+		m_counters.pixels.fetch_add(pixels, std::memory_order_relaxed);
+		m_counters.bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+		m_counters.bytes_written.fetch_add(pixels * desc.format.bytes_per_sample, std::memory_order_relaxed);
+		if (skipped)
+			m_counters.pixels_skipped.fetch_add(skipped, std::memory_order_relaxed);
+	}
+
+	node_stats get_stats() const
+	{
+		const graphengine::FilterDescriptor &desc = m_filter->descriptor();
+
+		node_stats stats{ m_name, m_plane, desc.format.width, desc.format.height };
+		stats.calls = m_counters.calls.load(std::memory_order_relaxed);
+		stats.nanoseconds = m_counters.nanoseconds.load(std::memory_order_relaxed);
+		stats.pixels = m_counters.pixels.load(std::memory_order_relaxed);
+		stats.bytes_read = m_counters.bytes_read.load(std::memory_order_relaxed);
+		stats.bytes_written = m_counters.bytes_written.load(std::memory_order_relaxed);
+		stats.pixels_skipped = m_counters.pixels_skipped.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void reset()
+	{
+		m_counters.calls = 0;
+		m_counters.nanoseconds = 0;
+		m_counters.pixels = 0;
+		m_counters.bytes_read = 0;
+		m_counters.bytes_written = 0;
+		m_counters.pixels_skipped = 0;
+	}
+};
+
+
+FilterProfiler::FilterProfiler() = default;
+
+FilterProfiler::~FilterProfiler() = default;
+
+const graphengine::Filter *FilterProfiler::wrap(const graphengine::Filter *filter, const char *name, int plane, const unsigned input_bytes_per_sample[]) try
+{
+	m_filters.push_back(std::make_unique<ProfilingFilter>(filter, name, plane, input_bytes_per_sample));
+	return m_filters.back().get();
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+std::vector<FilterProfiler::node_stats> FilterProfiler::get_stats() const try
+{
+	std::vector<node_stats> stats;
+	for (const auto &filter : m_filters) {
+		stats.push_back(filter->get_stats());
+	}
+	return stats;
+} catch (const std::bad_alloc &) {
+	error::throw_<error::OutOfMemory>();
+}
+
+void FilterProfiler::reset()
+{
+	for (const auto &filter : m_filters) {
+		filter->reset();
+	}
+}
+
+
+void profiler_count_skipped(uint64_t samples) noexcept
+{
+	if (g_skipped_counter)
+		*g_skipped_counter += samples;
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_PROFILER_H_
+#define ZIMG_GRAPH_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace graphengine {
+class Filter;
+}
+
+
+namespace zimg {
+namespace graph {
+
+/**
+ * Collects execution statistics for the filters in a graph.
+ *
+ * Filters are instrumented by wrapping them in a forwarding filter, which
+ * measures each call to process. Counters are updated atomically, so the
+ * graph may be executed concurrently.
+ */
+class FilterProfiler {
+public:
+	struct node_stats {
+		const char *name;
+		int plane;
+		unsigned width;
+		unsigned height;
+		uint64_t calls;
+		uint64_t nanoseconds;
+		uint64_t pixels;
+		uint64_t bytes_read;
+		uint64_t bytes_written;
+		uint64_t pixels_skipped;
+	};
+private:
+	class ProfilingFilter;
+
+	struct counters {
+		std::atomic<uint64_t> calls;
+		std::atomic<uint64_t> nanoseconds;
+		std::atomic<uint64_t> pixels;
+		std::atomic<uint64_t> bytes_read;
+		std::atomic<uint64_t> bytes_written;
+		std::atomic<uint64_t> pixels_skipped;
+	};
+
+	std::vector<std::unique_ptr<ProfilingFilter>> m_filters;
+public:
+	FilterProfiler();
+
+	~FilterProfiler();
+
+	/**
+	 * Create an instrumented proxy for a filter.
+	 *
+	 * @param filter filter, must outlive the profiler
+	 * @param name stage name, must have static storage duration
+	 * @param plane plane index, or -1 if the filter processes several planes
+	 * @param input_bytes_per_sample sample size of each dependency
+	 * @return proxy, owned by the profiler
+	 */
+	const graphengine::Filter *wrap(const graphengine::Filter *filter, const char *name, int plane, const unsigned input_bytes_per_sample[]);
+
+	/**
+	 * Get the statistics of each filter, in order of insertion.
+	 */
+	std::vector<node_stats> get_stats() const;
+
+	void reset();
+};
+
+/**
+ * Record samples that a filter passed through without computation.
+ *
+ * The count is attributed to the filter being profiled on the calling thread,
+ * and is discarded if no filter is being profiled.
+ *
+ * @param samples number of samples
+ */
+void profiler_count_skipped(uint64_t samples) noexcept;
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_PROFILER_H_
@@ -1,11 +1,232 @@
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include "common/align.h"
 #include "common/pixel.h"
+#include "common/zassert.h"
+#include "depth/quantize.h"
+#include "profiler.h"
 #include "simple_filters.h"
 
+#if defined(ZIMG_X86)
+  #include "x86/premultiply_x86.h"
+#endif
+
 namespace zimg {
 namespace graph {
 
+namespace {
+
+void premultiply_f32_c(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	const float *alpha_p = static_cast<const float *>(alpha);
+	float *dst_p = static_cast<float *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		dst_p[j] = src_p[j] * alpha_p[j];
+	}
+}
+
+void unpremultiply_f32_c(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	const float *alpha_p = static_cast<const float *>(alpha);
+	float *dst_p = static_cast<float *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		float a = alpha_p[j];
+		a = std::min(std::max(a, 0.0f), 1.0f);
+		dst_p[j] = a == 0.0f ? 0.0f : src_p[j] / a;
+	}
+}
+
+// Computes (x * mul + bias) >> shift, saturated to 16 bits. The sum wraps
+// around at 32 bits like in the SIMD kernels.
+uint16_t premultiply_widen(uint32_t x, int32_t mul, int32_t bias, unsigned shift)
+{
+	int32_t y = static_cast<int32_t>(x * static_cast<uint32_t>(mul) + static_cast<uint32_t>(bias)) >> shift;
+	return static_cast<uint16_t>(std::min(std::max(y, static_cast<int32_t>(0)), static_cast<int32_t>(UINT16_MAX)));
+}
+
+// Computes round((y * a + offset * (65535 - a)) / 65535).
+uint16_t premultiply_blend(uint32_t y, uint32_t a, uint32_t offset)
+{
+	uint32_t m = y * a + offset * (UINT16_MAX - a) + UINT16_MAX / 2;
+	return static_cast<uint16_t>((m + (m >> 16) + 1) >> 16);
+}
+
+template <class T>
+void premultiply_i16_c(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	const T *alpha_p = static_cast<const T *>(alpha);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		uint32_t x = src_p[j];
+		uint32_t a = std::min(static_cast<int32_t>(alpha_p[j]), params.alpha_max);
+
+		x = premultiply_widen(x, params.color_mul, params.color_bias, params.shift);
+		a = premultiply_widen(a, params.alpha_mul, params.alpha_bias, params.shift);
+		dst_p[j] = premultiply_blend(x, a, params.offset);
+	}
+}
+
+// Premultiplies samples with opaque alpha, which only widens them.
+template <class T>
+void premultiply_opaque_i16_c(const void *src, const void *, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const T *src_p = static_cast<const T *>(src);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		dst_p[j] = premultiply_widen(src_p[j], params.color_mul, params.color_bias, params.shift);
+	}
+}
+
+void unpremultiply_i16_c(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const uint16_t *src_p = static_cast<const uint16_t *>(src);
+	const uint16_t *alpha_p = static_cast<const uint16_t *>(alpha);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		int64_t x = src_p[j];
+		int64_t a = alpha_p[j];
+
+		if (!a) {
+			dst_p[j] = static_cast<uint16_t>(params.offset);
+			continue;
+		}
+
+		// offset + floor((x - offset) * 65535 / a + 1/2), as a single fraction.
+		int64_t n = 2 * a * params.offset + 2 * (x - params.offset) * UINT16_MAX + a;
+		dst_p[j] = n < 0 ? 0 : static_cast<uint16_t>(std::min(n / (2 * a), static_cast<int64_t>(UINT16_MAX)));
+	}
+}
+
+template <class T>
+bool alpha_opaque_c(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const T *alpha_p = static_cast<const T *>(alpha);
+	const T alpha_max = static_cast<T>(params.alpha_max);
+
+	return std::all_of(alpha_p + left, alpha_p + right, [=](T a) { return a == alpha_max; });
+}
+
+// Converts x * scale + offset, rounded to nearest, to fixed point.
+void fixed_point_scale(double scale, double offset, unsigned shift, int32_t &mul, int32_t &bias)
+{
+	double unit = static_cast<double>(1UL << shift);
+
+	mul = static_cast<int32_t>(std::lround(scale * unit));
+	bias = static_cast<int32_t>(std::floor((offset + 0.5) * unit));
+}
+
+premultiply_func select_premultiply_func(PixelType type, CPUClass cpu)
+{
+	premultiply_func func = nullptr;
+
+#if defined(ZIMG_X86)
+	func = select_premultiply_func_x86(type, cpu);
+#endif
+	if (func)
+		return func;
+
+	switch (type) {
+	case PixelType::BYTE: return premultiply_i16_c<uint8_t>;
+	case PixelType::WORD: return premultiply_i16_c<uint16_t>;
+	case PixelType::FLOAT: return premultiply_f32_c;
+	default: return nullptr;
+	}
+}
+
+premultiply_func select_unpremultiply_func(PixelType type, CPUClass cpu)
+{
+	premultiply_func func = nullptr;
+
+#if defined(ZIMG_X86)
+	func = select_unpremultiply_func_x86(type, cpu);
+#endif
+	if (func)
+		return func;
+
+	switch (type) {
+	case PixelType::WORD: return unpremultiply_i16_c;
+	case PixelType::FLOAT: return unpremultiply_f32_c;
+	default: return nullptr;
+	}
+}
+
+alpha_opaque_func select_alpha_opaque_func(PixelType type, CPUClass cpu)
+{
+	alpha_opaque_func func = nullptr;
+
+#if defined(ZIMG_X86)
+	func = select_alpha_opaque_func_x86(type, cpu);
+#endif
+	if (func)
+		return func;
+
+	switch (type) {
+	case PixelType::BYTE: return alpha_opaque_c<uint8_t>;
+	case PixelType::WORD: return alpha_opaque_c<uint16_t>;
+	case PixelType::FLOAT: return alpha_opaque_c<float>;
+	default: return nullptr;
+	}
+}
+
+// Applies the kernel to the blocks of [left, right) containing transparent
+// pixels. The other blocks are passed to widen_func if the format changes,
+// or else copied.
+void premultiply_skip_opaque(premultiply_func func, alpha_opaque_func opaque_func, premultiply_func widen_func, const PremultiplyParams &params,
+                             unsigned bytes_per_sample, const void *src, const void *alpha, void *dst, unsigned left, unsigned right)
+{
+	unsigned skipped = 0;
+	unsigned run_left = left;
+	bool run_opaque = false;
+
+	auto flush = [&](unsigned run_right)
+	{
+		if (run_left == run_right)
+			return;
+
+		if (!run_opaque) {
+			func(src, alpha, dst, params, run_left, run_right);
+		} else if (widen_func) {
+			widen_func(src, alpha, dst, params, run_left, run_right);
+		} else if (src != dst) {
+			std::memcpy(static_cast<unsigned char *>(dst) + static_cast<size_t>(run_left) * bytes_per_sample,
+			            static_cast<const unsigned char *>(src) + static_cast<size_t>(run_left) * bytes_per_sample,
+			            static_cast<size_t>(run_right - run_left) * bytes_per_sample);
+		}
+
+		if (run_opaque)
+			skipped += run_right - run_left;
+	};
+
+	for (unsigned j = left; j < right;) {
+		unsigned block_right = std::min(floor_n(j, ALPHA_OPAQUE_BLOCK) + ALPHA_OPAQUE_BLOCK, right);
+		bool opaque = opaque_func(alpha, params, j, block_right);
+
+		if (opaque != run_opaque) {
+			flush(j);
+			run_left = j;
+			run_opaque = opaque;
+		}
+		j = block_right;
+	}
+	flush(right);
+
+	if (skipped)
+		profiler_count_skipped(skipped);
+}
+
+} // namespace
+
+
 CopyRectFilter::CopyRectFilter(unsigned left, unsigned top, unsigned width, unsigned height, PixelType type) :
 	m_left{ left },
 	m_top{ top }
@@ -67,47 +288,93 @@ void ValueInitializeFilter::process(const graphengine::BufferDescriptor *in, con
 }
 
 
-PremultiplyFilter::PremultiplyFilter(unsigned width, unsigned height) : PointFilter(width, height, PixelType::FLOAT)
+PixelFormat premultiplied_format(const PixelFormat &format)
+{
+	if (!pixel_is_integer(format.type))
+		return format;
+
+	PixelFormat result = format;
+	result.type = PixelType::WORD;
+	result.depth = pixel_depth(PixelType::WORD);
+	return result;
+}
+
+
+PremultiplyFilter::PremultiplyFilter(unsigned width, unsigned height, const PixelFormat &format, CPUClass cpu) :
+	PointFilter(width, height, premultiplied_format(format).type),
+	m_params{},
+	m_func{ select_premultiply_func(format.type, cpu) },
+	m_opaque_func{ select_alpha_opaque_func(format.type, cpu) },
+	m_widen_func{}
 {
+	zassert_d(m_func, "pixel type not supported");
+
 	m_desc.num_deps = 2;
 	m_desc.num_planes = 1;
-	m_desc.flags.in_place = 1;
+	m_desc.flags.in_place = pixel_size(format.type) == m_desc.format.bytes_per_sample;
+
+	// Opaque pixels are unchanged if the format is preserved, and otherwise
+	// only widened to 16 bits.
+	if (premultiplied_format(format) != format)
+		m_widen_func = format.type == PixelType::BYTE ? premultiply_opaque_i16_c<uint8_t> : premultiply_opaque_i16_c<uint16_t>;
+
+	if (pixel_is_integer(format.type)) {
+		PixelFormat format_out = premultiplied_format(format);
+		double range_in = depth::integer_range(format);
+		double range_out = depth::integer_range(format_out);
+		double offset_in = depth::integer_offset(format);
+		double offset_out = depth::integer_offset(format_out);
+
+		// The largest shift that keeps the multipliers within 16 bits.
+		m_params.shift = format.depth - 1;
+		m_params.offset = depth::integer_offset(format_out);
+		m_params.alpha_max = depth::numeric_max(format.depth);
+
+		fixed_point_scale(range_out / range_in, offset_out - offset_in * range_out / range_in, m_params.shift, m_params.color_mul, m_params.color_bias);
+		fixed_point_scale(static_cast<double>(UINT16_MAX) / m_params.alpha_max, 0.0, m_params.shift, m_params.alpha_mul, m_params.alpha_bias);
+	} else {
+		m_params.alpha_max = 1;
+	}
 }
 
 void PremultiplyFilter::process(const graphengine::BufferDescriptor in[2], const graphengine::BufferDescriptor *out,
                                 unsigned i, unsigned left, unsigned right, void *, void *) const noexcept
 {
-	const float *src_p = in[0].get_line<float>(i);
-	const float *alpha = in[1].get_line<float>(i);
-	float *dst_p = out->get_line<float>(i);
-
-	for (unsigned j = left; j < right; ++j) {
-		float a = alpha[j];
-		a = std::min(std::max(a, 0.0f), 1.0f);
-		dst_p[j] = src_p[j] * alpha[j];
-	}
+	if (m_opaque_func)
+		premultiply_skip_opaque(m_func, m_opaque_func, m_widen_func, m_params, m_desc.format.bytes_per_sample, in[0].get_line(i), in[1].get_line(i), out->get_line(i), left, right);
+	else
+		m_func(in[0].get_line(i), in[1].get_line(i), out->get_line(i), m_params, left, right);
 }
 
 
-UnpremultiplyFilter::UnpremultiplyFilter(unsigned width, unsigned height) : PointFilter(width, height, PixelType::FLOAT)
+UnpremultiplyFilter::UnpremultiplyFilter(unsigned width, unsigned height, const PixelFormat &format, CPUClass cpu) :
+	PointFilter(width, height, format.type),
+	m_params{},
+	m_func{ select_unpremultiply_func(format.type, cpu) },
+	m_opaque_func{ select_alpha_opaque_func(format.type, cpu) }
 {
+	zassert_d(m_func, "pixel type not supported");
+	zassert_d(!pixel_is_integer(format.type) || format.depth == pixel_depth(format.type), "must be premultiplied format");
+
 	m_desc.num_deps = 2;
 	m_desc.num_planes = 1;
 	m_desc.flags.in_place = 1;
+
+	if (pixel_is_integer(format.type)) {
+		m_params.offset = depth::integer_offset(format);
+		m_params.alpha_max = depth::numeric_max(format.depth);
+	} else {
+		m_params.alpha_max = 1;
+	}
 }
 
 void UnpremultiplyFilter::process(const graphengine::BufferDescriptor in[2], const graphengine::BufferDescriptor *out,
                                   unsigned i, unsigned left, unsigned right, void *, void *) const noexcept
 {
-	const float *src_p = in[0].get_line<float>(i);
-	const float *alpha = in[1].get_line<float>(i);
-	float *dst_p = out->get_line<float>(i);
-
-	for (unsigned j = left; j < right; ++j) {
-		float a = alpha[j];
-		a = std::min(std::max(a, 0.0f), 1.0f);
-		dst_p[j] = a == 0.0f ? 0.0f : src_p[j] / a;
-	}
+	if (m_opaque_func)
+		premultiply_skip_opaque(m_func, m_opaque_func, nullptr, m_params, m_desc.format.bytes_per_sample, in[0].get_line(i), in[1].get_line(i), out->get_line(i), left, right);
+	else
+		m_func(in[0].get_line(i), in[1].get_line(i), out->get_line(i), m_params, left, right);
 }
 
 } // namespace graph
@@ -9,7 +9,9 @@
 
 namespace zimg {
 
+enum class CPUClass;
 enum class PixelType;
+struct PixelFormat;
 
 namespace graph {
 
@@ -49,19 +51,73 @@ public:
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override;
 };
 
-// Premultiplies an image.
+/**
+ * Constants for integer premultiplication, which is computed at 16 bits in
+ * fixed point. Color samples are widened to 16 bits as
+ *   y = (x * color_mul + color_bias) >> shift,
+ * and alpha samples, clamped to alpha_max, as
+ *   a = (alpha * alpha_mul + alpha_bias) >> shift,
+ * both saturated to [0, 65535]. The premultiplied sample is
+ *   dst = round((y * a + offset * (65535 - a)) / 65535).
+ * Unpremultiplication inverts the last step for 16-bit images, rounding the
+ * quotient to nearest. FLOAT images only use alpha_max, which is 1.
+ */
+struct PremultiplyParams {
+	int32_t color_mul;
+	int32_t color_bias;
+	int32_t alpha_mul;
+	int32_t alpha_bias;
+	unsigned shift;
+	int32_t offset;
+	int32_t alpha_max;
+};
+
+typedef void (*premultiply_func)(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right);
+
+// Tests whether every alpha sample in [left, right) equals alpha_max.
+typedef bool (*alpha_opaque_func)(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right);
+
+/**
+ * Number of samples tested at once for opaque alpha.
+ *
+ * The premultiply filters pass color samples through unchanged in aligned
+ * blocks of this size where alpha is at its maximum. Premultiplication to a
+ * wider format only widens the samples in those blocks.
+ */
+constexpr unsigned ALPHA_OPAQUE_BLOCK = 64;
+
+/**
+ * Format of an image after premultiplication.
+ *
+ * Integer images are premultiplied to 16 bits, so that resizing them does not
+ * lose the precision of samples with a small alpha.
+ *
+ * @param format straight alpha format
+ * @return premultiplied format
+ */
+PixelFormat premultiplied_format(const PixelFormat &format);
+
+// Premultiplies an image. The alpha plane has the same type and depth as the
+// image, in full range.
 class PremultiplyFilter : public PointFilter {
+	PremultiplyParams m_params;
+	premultiply_func m_func;
+	alpha_opaque_func m_opaque_func;
+	premultiply_func m_widen_func;
 public:
-	PremultiplyFilter(unsigned width, unsigned height);
+	PremultiplyFilter(unsigned width, unsigned height, const PixelFormat &format, CPUClass cpu);
 
 	void process(const graphengine::BufferDescriptor in[2], const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override;
 };
 
-// Unpremultiplies an image.
+// Unpremultiplies an image. Only FLOAT and 16-bit WORD images are supported.
 class UnpremultiplyFilter : public PointFilter {
+	PremultiplyParams m_params;
+	premultiply_func m_func;
+	alpha_opaque_func m_opaque_func;
 public:
-	UnpremultiplyFilter(unsigned width, unsigned height);
+	UnpremultiplyFilter(unsigned width, unsigned height, const PixelFormat &format, CPUClass cpu);
 
 	void process(const graphengine::BufferDescriptor in[2], const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override;
@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "common/alloc.h"
+#include "common/checked_int.h"
+#include "common/except.h"
+#include "common/zassert.h"
+#include "graphengine/filter.h"
+#include "tilegraph.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+constexpr graphengine::node_id SOURCE_ID = 0;
+
+TileGraph::rect rect_union(const TileGraph::rect &lhs, const TileGraph::rect &rhs)
+{
+	if (lhs.empty())
+		return rhs;
+	if (rhs.empty())
+		return lhs;
+
+	return{ std::min(lhs.left, rhs.left), std::min(lhs.top, rhs.top), std::max(lhs.right, rhs.right), std::max(lhs.bottom, rhs.bottom) };
+}
+
+unsigned floor_div_n(unsigned x, unsigned n) { return x - x % n; }
+
+// Saturates instead of wrapping for filters with an unbounded step.
+unsigned ceil_div_n(unsigned x, unsigned n)
+{
+	unsigned floor = floor_div_n(x, n);
+	return floor == x ? x : floor + std::min(n, UINT_MAX - floor);
+}
+
+unsigned ceil_pow2(unsigned x)
+{
+	unsigned n = 1;
+	while (n < x) {
+		n <<= 1;
+	}
+	return n;
+}
+
+size_t plane_stride(const graphengine::PlaneDescriptor &desc)
+{
+	return ceil_n(static_cast<size_t>(desc.width) * desc.bytes_per_sample, ALIGNMENT);
+}
+
+} // namespace
+
+
+struct TileGraph::node_plan {
+	rect region;
+	unsigned rows;
+	unsigned mask;
+};
+
+
+TileGraph::TileGraph() :
+	m_sink_deps{},
+	m_sink_planes{},
+	m_subsample_w{},
+	m_subsample_h{},
+	m_stateful{},
+	m_entire_col{}
+{
+	std::fill(m_sink_deps.begin(), m_sink_deps.end(), graphengine::null_dep);
+}
+
+TileGraph::~TileGraph() = default;
+
+graphengine::node_id TileGraph::add_source(const graphengine::PlaneDescriptor desc[graphengine::NODE_MAX_PLANES])
+{
+	zassert_d(m_nodes.empty(), "source already set");
+
+	node source{};
+	std::fill(source.deps.begin(), source.deps.end(), graphengine::null_dep);
+	std::copy_n(desc, graphengine::NODE_MAX_PLANES, source.planes.begin());
+
+	m_nodes.push_back(source);
+	return SOURCE_ID;
+}
+
+graphengine::node_id TileGraph::add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[])
+{
+	zassert_d(!m_nodes.empty(), "source not set");
+
+	const graphengine::FilterDescriptor &desc = filter->descriptor();
+
+	node transform{ filter };
+	std::fill(transform.deps.begin(), transform.deps.end(), graphengine::null_dep);
+	std::copy_n(deps, desc.num_deps, transform.deps.begin());
+	std::fill_n(transform.planes.begin(), desc.num_planes, desc.format);
+
+	for (unsigned p = 0; p < desc.num_deps; ++p) {
+		if (deps[p].id < 0 || static_cast<size_t>(deps[p].id) >= m_nodes.size())
+			error::throw_<error::InternalError>("invalid node id");
+	}
+
+	m_stateful = m_stateful || desc.flags.stateful;
+	m_entire_col = m_entire_col || desc.flags.entire_col;
+	m_nodes.push_back(transform);
+	return static_cast<graphengine::node_id>(m_nodes.size() - 1);
+}
+
+void TileGraph::set_sink(const graphengine::node_dep_desc deps[graphengine::NODE_MAX_PLANES])
+{
+	zassert_d(deps[0].id >= 0, "missing luma plane");
+
+	for (unsigned p = 0; p < graphengine::NODE_MAX_PLANES; ++p) {
+		m_sink_deps[p] = deps[p];
+		if (deps[p].id >= 0)
+			m_sink_planes[p] = m_nodes[deps[p].id].planes[deps[p].plane];
+	}
+
+	for (unsigned p = 1; p < graphengine::NODE_MAX_PLANES; ++p) {
+		if (m_sink_deps[p].id < 0)
+			continue;
+
+		while ((m_sink_planes[0].width >> m_subsample_w) > m_sink_planes[p].width)
+			++m_subsample_w;
+		while ((m_sink_planes[0].height >> m_subsample_h) > m_sink_planes[p].height)
+			++m_subsample_h;
+	}
+}
+
+std::vector<TileGraph::node_plan> TileGraph::plan(const rect &region) const
+{
+	if (region.empty() || region.right > output_width() || region.bottom > output_height())
+		error::throw_<error::InvalidImageSize>("invalid output rectangle");
+	if (region.left % (1U << m_subsample_w) || (region.right != output_width() && region.right % (1U << m_subsample_w)))
+		error::throw_<error::ImageNotDivisible>("output rectangle must be aligned to chroma subsampling");
+	if (region.top % (1U << m_subsample_h) || (region.bottom != output_height() && region.bottom % (1U << m_subsample_h)))
+		error::throw_<error::ImageNotDivisible>("output rectangle must be aligned to chroma subsampling");
+
+	std::vector<node_plan> result(m_nodes.size(), node_plan{});
+
+	// Sinks request the output rectangle, scaled for subsampled planes.
+	for (unsigned p = 0; p < graphengine::NODE_MAX_PLANES; ++p) {
+		graphengine::node_dep_desc dep = m_sink_deps[p];
+		if (dep.id <= SOURCE_ID)
+			continue;
+
+		const graphengine::PlaneDescriptor &desc = m_sink_planes[p];
+		unsigned sw = p == 0 || p == 3 ? 0 : m_subsample_w;
+		unsigned sh = p == 0 || p == 3 ? 0 : m_subsample_h;
+
+		rect plane_region{
+			region.left >> sw,
+			region.top >> sh,
+			std::min((region.right + (1U << sw) - 1) >> sw, desc.width),
+			std::min((region.bottom + (1U << sh) - 1) >> sh, desc.height),
+		};
+		result[dep.id].region = rect_union(result[dep.id].region, plane_region);
+	}
+
+	// Propagate the requested area backwards through the graph. Nodes are
+	// stored in topological order, so each node is complete once its
+	// consumers have been visited.
+	for (size_t id = m_nodes.size() - 1; id > SOURCE_ID; --id) {
+		const node &cur_node = m_nodes[id];
+		const graphengine::FilterDescriptor &desc = cur_node.filter->descriptor();
+		rect &cur = result[id].region;
+
+		if (cur.empty())
+			continue;
+
+		if (desc.flags.entire_row) {
+			cur.left = 0;
+			cur.right = desc.format.width;
+		}
+		if (desc.flags.stateful)
+			cur.top = 0;
+
+		unsigned col_align = std::max(desc.alignment_mask + 1, static_cast<unsigned>(ALIGNMENT) / desc.format.bytes_per_sample);
+		cur.left = floor_div_n(cur.left, col_align);
+		cur.right = std::min(ceil_div_n(cur.right, col_align), desc.format.width);
+
+		// Filters operating on entire columns produce every row in a single
+		// call, regardless of their step.
+		if (desc.flags.entire_col) {
+			cur.top = 0;
+			cur.bottom = desc.format.height;
+		} else {
+			cur.top = floor_div_n(cur.top, desc.step);
+			cur.bottom = std::min(ceil_div_n(cur.bottom, desc.step), desc.format.height);
+		}
+
+		unsigned rows = cur.bottom - cur.top;
+		unsigned last = cur.top + floor_div_n(rows - 1, desc.step);
+		auto col_deps = cur_node.filter->get_col_deps(cur.left, cur.right);
+		rect dep_region{ col_deps.first, cur_node.filter->get_row_deps(cur.top).first, col_deps.second, cur_node.filter->get_row_deps(last).second };
+
+		for (unsigned p = 0; p < desc.num_deps; ++p) {
+			if (cur_node.deps[p].id == SOURCE_ID)
+				continue;
+			result[cur_node.deps[p].id].region = rect_union(result[cur_node.deps[p].id].region, dep_region);
+		}
+	}
+
+	// Size each buffer from a dry run of the row schedule, so intermediate
+	// nodes only hold the rows that their consumers still need.
+	std::vector<unsigned> live(m_nodes.size());
+	stream(result, region, live.data(), [](size_t, unsigned) {}, [](unsigned, unsigned, unsigned) {});
+
+	for (size_t id = SOURCE_ID + 1; id < m_nodes.size(); ++id) {
+		if (result[id].region.empty())
+			continue;
+
+		unsigned height = m_nodes[id].filter->descriptor().format.height;
+		result[id].rows = std::min(ceil_pow2(live[id]), height);
+		result[id].mask = result[id].rows == height ? graphengine::BUFFER_MAX : result[id].rows - 1;
+	}
+
+	return result;
+}
+
+template <class Process, class Emit>
+void TileGraph::stream(const std::vector<node_plan> &plan, const rect &region, unsigned *live, Process process, Emit emit) const
+{
+	std::vector<std::vector<size_t>> consumers(m_nodes.size());
+	std::vector<unsigned> cursor(m_nodes.size());
+	std::array<unsigned, graphengine::NODE_MAX_PLANES> sink_cursor{};
+	std::array<unsigned, graphengine::NODE_MAX_PLANES> sink_bottom{};
+
+	for (size_t id = SOURCE_ID + 1; id < m_nodes.size(); ++id) {
+		const node &cur_node = m_nodes[id];
+
+		cursor[id] = plan[id].region.top;
+		if (plan[id].region.empty())
+			continue;
+
+		for (unsigned p = 0; p < cur_node.filter->descriptor().num_deps; ++p) {
+			consumers[cur_node.deps[p].id].push_back(id);
+		}
+	}
+
+	for (unsigned p = 0; p < graphengine::NODE_MAX_PLANES; ++p) {
+		unsigned sh = p == 0 || p == 3 ? 0 : m_subsample_h;
+		sink_cursor[p] = region.top >> sh;
+		sink_bottom[p] = std::min((region.bottom + (1U << sh) - 1) >> sh, m_sink_planes[p].height);
+	}
+
+	// Lowest row of a node that is still to be read by a consumer.
+	auto live_top = [&](size_t id)
+	{
+		unsigned top = cursor[id];
+
+		for (size_t c : consumers[id]) {
+			if (cursor[c] < plan[c].region.bottom)
+				top = std::min(top, m_nodes[c].filter->get_row_deps(cursor[c]).first);
+		}
+		for (unsigned p = 0; p < graphengine::NODE_MAX_PLANES; ++p) {
+			if (m_sink_deps[p].id == static_cast<graphengine::node_id>(id) && sink_cursor[p] < sink_bottom[p])
+				top = std::min(top, sink_cursor[p]);
+		}
+		return top;
+	};
+
+	// Produce rows of a node up to |bottom|, computing its inputs on demand.
+	auto pull = [&](auto &self, size_t id, unsigned bottom) -> void
+	{
+		const node &cur_node = m_nodes[id];
+		const graphengine::FilterDescriptor &desc = cur_node.filter->descriptor();
+
+		bottom = std::min(bottom, plan[id].region.bottom);
+
+		while (cursor[id] < bottom) {
+			unsigned i = cursor[id];
+			unsigned dep_bottom = cur_node.filter->get_row_deps(i).second;
+
+			for (unsigned p = 0; p < desc.num_deps; ++p) {
+				if (cur_node.deps[p].id != SOURCE_ID)
+					self(self, cur_node.deps[p].id, dep_bottom);
+			}
+
+			process(id, i);
+			cursor[id] = i + std::min(desc.step, plan[id].region.bottom - i);
+			live[id] = std::max(live[id], cursor[id] - std::min(live_top(id), i));
+		}
+	};
+
+	for (unsigned i = region.top; i < region.bottom; i += 1U << m_subsample_h) {
+		unsigned next = std::min(i + (1U << m_subsample_h), region.bottom);
+
+		for (unsigned p = 0; p < graphengine::NODE_MAX_PLANES; ++p) {
+			graphengine::node_dep_desc dep = m_sink_deps[p];
+			if (dep.id < 0)
+				continue;
+
+			unsigned sh = p == 0 || p == 3 ? 0 : m_subsample_h;
+			unsigned bottom = std::min((next + (1U << sh) - 1) >> sh, sink_bottom[p]);
+
+			if (dep.id != SOURCE_ID)
+				pull(pull, dep.id, bottom);
+
+			emit(p, sink_cursor[p], bottom);
+			sink_cursor[p] = bottom;
+		}
+	}
+}
+
+template <class Alloc>
+void TileGraph::layout(const std::vector<node_plan> &plan, Alloc &alloc, graphengine::BufferDescriptor *buffers, void **contexts, void **scratchpad) const
+{
+	size_t scratchpad_size = 0;
+
+	for (size_t id = SOURCE_ID + 1; id < m_nodes.size(); ++id) {
+		const graphengine::FilterDescriptor &desc = m_nodes[id].filter->descriptor();
+
+		if (plan[id].region.empty())
+			continue;
+
+		contexts[id] = alloc.allocate(desc.context_size);
+		scratchpad_size = std::max(scratchpad_size, desc.scratchpad_size);
+
+		for (unsigned p = 0; p < desc.num_planes; ++p) {
+			size_t stride = plane_stride(desc.format);
+			void *ptr = alloc.allocate((static_cast<checked_size_t>(plan[id].rows) * stride).get());
+			buffers[id * graphengine::NODE_MAX_PLANES + p] = { ptr, static_cast<ptrdiff_t>(stride), plan[id].mask };
+		}
+	}
+
+	*scratchpad = alloc.allocate(scratchpad_size);
+}
+
+size_t TileGraph::get_tmp_size(const rect &region) const
+{
+	std::vector<node_plan> plan = this->plan(region);
+	std::vector<graphengine::BufferDescriptor> buffers(m_nodes.size() * graphengine::NODE_MAX_PLANES);
+	std::vector<void *> contexts(m_nodes.size());
+	void *scratchpad;
+
+	FakeAllocator alloc;
+	layout(plan, alloc, buffers.data(), contexts.data(), &scratchpad);
+	return alloc.count();
+}
+
+void TileGraph::process(const graphengine::BufferDescriptor src[graphengine::NODE_MAX_PLANES], const graphengine::BufferDescriptor dst[graphengine::NODE_MAX_PLANES], const rect &region, void *tmp) const
+{
+	std::vector<node_plan> plan = this->plan(region);
+	std::vector<graphengine::BufferDescriptor> buffers(m_nodes.size() * graphengine::NODE_MAX_PLANES);
+	std::vector<void *> contexts(m_nodes.size());
+	void *scratchpad;
+
+	LinearAllocator alloc{ tmp };
+	layout(plan, alloc, buffers.data(), contexts.data(), &scratchpad);
+	std::copy_n(src, graphengine::NODE_MAX_PLANES, buffers.begin());
+
+	std::vector<unsigned> live(m_nodes.size());
+
+	for (size_t id = SOURCE_ID + 1; id < m_nodes.size(); ++id) {
+		if (!plan[id].region.empty())
+			m_nodes[id].filter->init_context(contexts[id]);
+	}
+
+	auto process_row = [&](size_t id, unsigned i)
+	{
+		const node &cur_node = m_nodes[id];
+		const graphengine::FilterDescriptor &desc = cur_node.filter->descriptor();
+
+		graphengine::BufferDescriptor in[graphengine::NODE_MAX_PLANES] = {};
+		for (unsigned p = 0; p < desc.num_deps; ++p) {
+			in[p] = buffers[cur_node.deps[p].id * graphengine::NODE_MAX_PLANES + cur_node.deps[p].plane];
+		}
+
+		const graphengine::BufferDescriptor *out = &buffers[id * graphengine::NODE_MAX_PLANES];
+		cur_node.filter->process(in, out, i, plan[id].region.left, plan[id].region.right, contexts[id], scratchpad);
+	};
+
+	auto emit_rows = [&](unsigned p, unsigned top, unsigned bottom)
+	{
+		graphengine::node_dep_desc dep = m_sink_deps[p];
+		const graphengine::PlaneDescriptor &desc = m_sink_planes[p];
+		const graphengine::BufferDescriptor &buf = buffers[dep.id * graphengine::NODE_MAX_PLANES + dep.plane];
+		unsigned sw = p == 0 || p == 3 ? 0 : m_subsample_w;
+
+		unsigned left = region.left >> sw;
+		unsigned right = std::min((region.right + (1U << sw) - 1) >> sw, desc.width);
+
+		for (unsigned i = top; i < bottom; ++i) {
+			const unsigned char *src_p = buf.get_line<unsigned char>(i) + static_cast<size_t>(left) * desc.bytes_per_sample;
+			unsigned char *dst_p = dst[p].get_line<unsigned char>(i) + static_cast<size_t>(left) * desc.bytes_per_sample;
+			std::memcpy(dst_p, src_p, static_cast<size_t>(right - left) * desc.bytes_per_sample);
+		}
+	};
+
+	stream(plan, region, live.data(), process_row, emit_rows);
+}
+
+} // namespace graph
+} // namespace zimg
@@ -0,0 +1,137 @@
+#pragma once
+
+#ifndef ZIMG_GRAPH_TILEGRAPH_H_
+#define ZIMG_GRAPH_TILEGRAPH_H_
+
+#include <array>
+#include <vector>
+#include "graphengine/types.h"
+
+namespace graphengine {
+class Filter;
+}
+
+
+namespace zimg {
+namespace graph {
+
+/**
+ * Executes a filter graph over an arbitrary rectangle of the output image.
+ *
+ * The graph is a flat copy of the nodes inserted into the main graph. Each
+ * call computes the input region required by every node from the filter
+ * dependency functions and streams the rows of that region from the sinks,
+ * as in the main graph. Intermediate buffers are rings that hold only the
+ * rows still needed by their consumers. Since no state is shared between
+ * calls, disjoint rectangles can be processed concurrently with separate
+ * temporary buffers.
+ */
+class TileGraph {
+public:
+	struct rect {
+		unsigned left;
+		unsigned top;
+		unsigned right;
+		unsigned bottom;
+
+		bool empty() const { return left >= right || top >= bottom; }
+	};
+private:
+	struct node {
+		const graphengine::Filter *filter;
+		std::array<graphengine::node_dep_desc, graphengine::NODE_MAX_PLANES> deps;
+		std::array<graphengine::PlaneDescriptor, graphengine::NODE_MAX_PLANES> planes;
+	};
+
+	struct node_plan;
+
+	std::vector<node> m_nodes;
+	std::array<graphengine::node_dep_desc, graphengine::NODE_MAX_PLANES> m_sink_deps;
+	std::array<graphengine::PlaneDescriptor, graphengine::NODE_MAX_PLANES> m_sink_planes;
+	unsigned m_subsample_w;
+	unsigned m_subsample_h;
+	bool m_stateful;
+	bool m_entire_col;
+
+	std::vector<node_plan> plan(const rect &region) const;
+
+	template <class Process, class Emit>
+	void stream(const std::vector<node_plan> &plan, const rect &region, unsigned *live, Process process, Emit emit) const;
+
+	template <class Alloc>
+	void layout(const std::vector<node_plan> &plan, Alloc &alloc, graphengine::BufferDescriptor *buffers, void **contexts, void **scratchpad) const;
+public:
+	TileGraph();
+
+	~TileGraph();
+
+	/**
+	 * Add the source node. Must be called exactly once before any transform.
+	 *
+	 * Planes are indexed by their position in the user buffer (Y-U-V-A), so
+	 * absent planes have zero dimensions.
+	 *
+	 * @param desc plane formats
+	 * @return node id
+	 */
+	graphengine::node_id add_source(const graphengine::PlaneDescriptor desc[graphengine::NODE_MAX_PLANES]);
+
+	graphengine::node_id add_transform(const graphengine::Filter *filter, const graphengine::node_dep_desc deps[]);
+
+	/**
+	 * Set the sink node.
+	 *
+	 * @param deps plane dependencies in user buffer order, null_dep if absent
+	 */
+	void set_sink(const graphengine::node_dep_desc deps[graphengine::NODE_MAX_PLANES]);
+
+	unsigned output_width() const { return m_sink_planes[0].width; }
+
+	unsigned output_height() const { return m_sink_planes[0].height; }
+
+	/**
+	 * Horizontal and vertical alignment of output rectangles, in log2 units.
+	 */
+	unsigned subsample_w() const { return m_subsample_w; }
+	unsigned subsample_h() const { return m_subsample_h; }
+
+	/**
+	 * Check if the graph contains a filter that must process all preceding
+	 * rows, such as error diffusion. Rectangles of such graphs always extend
+	 * to the top of the image.
+	 */
+	bool is_stateful() const { return m_stateful; }
+
+	/**
+	 * Check if the graph contains a filter that must process entire columns,
+	 * such as vertical unresize. Such filters compute every row of their
+	 * output for any rectangle.
+	 */
+	bool has_entire_col() const { return m_entire_col; }
+
+	/**
+	 * Query the temporary buffer size required to compute a rectangle.
+	 *
+	 * @param region output rectangle
+	 * @return size in bytes
+	 */
+	size_t get_tmp_size(const rect &region) const;
+
+	/**
+	 * Compute a rectangle of the output image.
+	 *
+	 * The input buffers must hold the entire source image. Only the pixels
+	 * within the rectangle are written to the output buffers.
+	 *
+	 * @param src input buffers, Y-U-V-A order
+	 * @param dst output buffers, Y-U-V-A order
+	 * @param region output rectangle, aligned to the subsampling factor
+	 * @param tmp temporary buffer
+	 */
+	void process(const graphengine::BufferDescriptor src[graphengine::NODE_MAX_PLANES], const graphengine::BufferDescriptor dst[graphengine::NODE_MAX_PLANES], const rect &region, void *tmp) const;
+};
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_TILEGRAPH_H_
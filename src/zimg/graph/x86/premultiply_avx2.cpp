@@ -0,0 +1,326 @@
+#ifdef ZIMG_X86
+
+#include <cstdint>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "premultiply_x86.h"
+
+#include "common/x86/avx_util.h"
+#include "common/x86/avx2_util.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+struct LoadU8 {
+	typedef uint8_t src_type;
+
+	static inline FORCE_INLINE __m256i load16(const uint8_t *ptr)
+	{
+		return _mm256_cvtepu8_epi16(_mm_load_si128((const __m128i *)ptr));
+	}
+};
+
+struct LoadU16 {
+	typedef uint16_t src_type;
+
+	static inline FORCE_INLINE __m256i load16(const uint16_t *ptr)
+	{
+		return _mm256_load_si256((const __m256i *)ptr);
+	}
+};
+
+// Computes (x * mul + bias) >> shift, saturated to 16 bits.
+inline FORCE_INLINE __m256i premultiply_widen(__m256i x, __m256i mul, __m256i bias, __m128i shift)
+{
+	__m256i lo = _mm256_mullo_epi16(x, mul);
+	__m256i hi = _mm256_mulhi_epu16(x, mul);
+
+	__m256i y0 = _mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), bias);
+	__m256i y1 = _mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), bias);
+
+	y0 = _mm256_sra_epi32(y0, shift);
+	y1 = _mm256_sra_epi32(y1, shift);
+
+	return _mm256_packus_epi32(y0, y1);
+}
+
+// Computes round((y * a + offset * (65535 - a)) / 65535).
+inline FORCE_INLINE __m256i premultiply_blend(__m256i y, __m256i a, __m256i offset)
+{
+	const __m256i rounding = _mm256_set1_epi32(UINT16_MAX / 2);
+	const __m256i one = _mm256_set1_epi32(1);
+
+	__m256i a_inv = _mm256_xor_si256(a, _mm256_set1_epi16(-1));
+
+	__m256i ya_lo = _mm256_mullo_epi16(y, a);
+	__m256i ya_hi = _mm256_mulhi_epu16(y, a);
+	__m256i oa_lo = _mm256_mullo_epi16(offset, a_inv);
+	__m256i oa_hi = _mm256_mulhi_epu16(offset, a_inv);
+
+	__m256i m0 = _mm256_add_epi32(_mm256_unpacklo_epi16(ya_lo, ya_hi), _mm256_unpacklo_epi16(oa_lo, oa_hi));
+	__m256i m1 = _mm256_add_epi32(_mm256_unpackhi_epi16(ya_lo, ya_hi), _mm256_unpackhi_epi16(oa_lo, oa_hi));
+	m0 = _mm256_add_epi32(m0, rounding);
+	m1 = _mm256_add_epi32(m1, rounding);
+
+	// Division by 65535, exact for numerators less than 65535 * 65536.
+	m0 = _mm256_add_epi32(_mm256_add_epi32(m0, _mm256_srli_epi32(m0, 16)), one);
+	m1 = _mm256_add_epi32(_mm256_add_epi32(m1, _mm256_srli_epi32(m1, 16)), one);
+
+	// The quotient is in the upper half. Sign extension makes the pack exact.
+	return _mm256_packs_epi32(_mm256_srai_epi32(m0, 16), _mm256_srai_epi32(m1, 16));
+}
+
+// Computes offset + (x - offset) * 65535 / a, rounded to nearest. Double
+// precision is exact enough to match the integer division of the C kernel.
+inline FORCE_INLINE __m128i unpremultiply_i32_4(__m128i x, __m128i a, __m256d offset, __m256d offset_round)
+{
+	__m256d xd = _mm256_cvtepi32_pd(x);
+	__m256d ad = _mm256_cvtepi32_pd(a);
+
+	xd = _mm256_mul_pd(_mm256_sub_pd(xd, offset), _mm256_set1_pd(UINT16_MAX));
+	xd = _mm256_add_pd(_mm256_div_pd(xd, ad), offset_round);
+	xd = _mm256_min_pd(_mm256_max_pd(xd, _mm256_setzero_pd()), _mm256_set1_pd(UINT16_MAX));
+
+	return _mm256_cvttpd_epi32(xd);
+}
+
+struct PremultiplyI16 {
+	__m256i color_mul;
+	__m256i color_bias;
+	__m256i alpha_mul;
+	__m256i alpha_bias;
+	__m256i offset;
+	__m256i alpha_max;
+	__m128i shift;
+	__m256d offset_pd;
+	__m256d offset_round_pd;
+
+	explicit PremultiplyI16(const PremultiplyParams &params) :
+		color_mul{ _mm256_set1_epi16(static_cast<uint16_t>(params.color_mul)) },
+		color_bias{ _mm256_set1_epi32(params.color_bias) },
+		alpha_mul{ _mm256_set1_epi16(static_cast<uint16_t>(params.alpha_mul)) },
+		alpha_bias{ _mm256_set1_epi32(params.alpha_bias) },
+		offset{ _mm256_set1_epi16(static_cast<uint16_t>(params.offset)) },
+		alpha_max{ _mm256_set1_epi16(static_cast<uint16_t>(params.alpha_max)) },
+		shift{ _mm_cvtsi32_si128(params.shift) },
+		offset_pd{ _mm256_set1_pd(params.offset) },
+		offset_round_pd{ _mm256_set1_pd(params.offset + 0.5) }
+	{}
+
+	inline FORCE_INLINE __m256i premultiply(__m256i x, __m256i a) const
+	{
+		a = _mm256_min_epu16(a, alpha_max);
+		x = premultiply_widen(x, color_mul, color_bias, shift);
+		a = premultiply_widen(a, alpha_mul, alpha_bias, shift);
+		return premultiply_blend(x, a, offset);
+	}
+
+	inline FORCE_INLINE __m256i unpremultiply(__m256i x, __m256i a) const
+	{
+		__m256i x0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(x));
+		__m256i x1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(x, 1));
+		__m256i a0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(a));
+		__m256i a1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(a, 1));
+
+		__m128i r0 = unpremultiply_i32_4(_mm256_castsi256_si128(x0), _mm256_castsi256_si128(a0), offset_pd, offset_round_pd);
+		__m128i r1 = unpremultiply_i32_4(_mm256_extracti128_si256(x0, 1), _mm256_extracti128_si256(a0, 1), offset_pd, offset_round_pd);
+		__m128i r2 = unpremultiply_i32_4(_mm256_castsi256_si128(x1), _mm256_castsi256_si128(a1), offset_pd, offset_round_pd);
+		__m128i r3 = unpremultiply_i32_4(_mm256_extracti128_si256(x1, 1), _mm256_extracti128_si256(a1, 1), offset_pd, offset_round_pd);
+
+		__m256i result = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_packus_epi32(r0, r1)), _mm_packus_epi32(r2, r3), 1);
+		__m256i mask = _mm256_cmpeq_epi16(a, _mm256_setzero_si256());
+		return _mm256_blendv_epi8(result, offset, mask);
+	}
+};
+
+template <class Load, bool Unpremultiply>
+inline FORCE_INLINE __m256i premultiply_i16_16(const PremultiplyI16 &c, const typename Load::src_type *src, const typename Load::src_type *alpha)
+{
+	__m256i x = Load::load16(src);
+	__m256i a = Load::load16(alpha);
+
+	return Unpremultiply ? c.unpremultiply(x, a) : c.premultiply(x, a);
+}
+
+template <class Load, bool Unpremultiply>
+void premultiply_i16_avx2_impl(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const typename Load::src_type *src_p = static_cast<const typename Load::src_type *>(src);
+	const typename Load::src_type *alpha_p = static_cast<const typename Load::src_type *>(alpha);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 16);
+	unsigned vec_right = floor_n(right, 16);
+
+	const PremultiplyI16 c{ params };
+
+	if (left != vec_left) {
+		__m256i x = premultiply_i16_16<Load, Unpremultiply>(c, src_p + vec_left - 16, alpha_p + vec_left - 16);
+		mm256_store_idxhi_epi16((__m256i *)(dst_p + vec_left - 16), x, left % 16);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256i x = premultiply_i16_16<Load, Unpremultiply>(c, src_p + j, alpha_p + j);
+		_mm256_store_si256((__m256i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m256i x = premultiply_i16_16<Load, Unpremultiply>(c, src_p + vec_right, alpha_p + vec_right);
+		mm256_store_idxlo_epi16((__m256i *)(dst_p + vec_right), x, right % 16);
+	}
+}
+
+inline FORCE_INLINE __m256 premultiply_f32_8(const float *src, const float *alpha)
+{
+	return _mm256_mul_ps(_mm256_load_ps(src), _mm256_load_ps(alpha));
+}
+
+inline FORCE_INLINE __m256 unpremultiply_f32_8(const float *src, const float *alpha)
+{
+	__m256 a = _mm256_load_ps(alpha);
+	a = _mm256_min_ps(_mm256_max_ps(a, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+
+	__m256 mask = _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_EQ_OQ);
+	return _mm256_andnot_ps(mask, _mm256_div_ps(_mm256_load_ps(src), a));
+}
+
+template <bool Unpremultiply>
+void premultiply_f32_avx2_impl(const void *src, const void *alpha, void *dst, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	const float *alpha_p = static_cast<const float *>(alpha);
+	float *dst_p = static_cast<float *>(dst);
+
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	auto kernel = [](const float *src, const float *alpha)
+	{
+		return Unpremultiply ? unpremultiply_f32_8(src, alpha) : premultiply_f32_8(src, alpha);
+	};
+
+	if (left != vec_left)
+		mm256_store_idxhi_ps(dst_p + vec_left - 8, kernel(src_p + vec_left - 8, alpha_p + vec_left - 8), left % 8);
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		_mm256_store_ps(dst_p + j, kernel(src_p + j, alpha_p + j));
+	}
+
+	if (right != vec_right)
+		mm256_store_idxlo_ps(dst_p + vec_right, kernel(src_p + vec_right, alpha_p + vec_right), right % 8);
+}
+
+inline FORCE_INLINE __m256i alpha_eq(const uint8_t *ptr, const PremultiplyParams &params)
+{
+	return _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)ptr), _mm256_set1_epi8(static_cast<uint8_t>(params.alpha_max)));
+}
+
+inline FORCE_INLINE __m256i alpha_eq(const uint16_t *ptr, const PremultiplyParams &params)
+{
+	return _mm256_cmpeq_epi16(_mm256_load_si256((const __m256i *)ptr), _mm256_set1_epi16(static_cast<uint16_t>(params.alpha_max)));
+}
+
+inline FORCE_INLINE __m256i alpha_eq(const float *ptr, const PremultiplyParams &params)
+{
+	return _mm256_castps_si256(_mm256_cmp_ps(_mm256_load_ps(ptr), _mm256_set1_ps(static_cast<float>(params.alpha_max)), _CMP_EQ_OQ));
+}
+
+// One bit per byte of the vector at j, cleared outside of [left, right).
+template <class T>
+inline FORCE_INLINE uint32_t alpha_lane_mask(unsigned j, unsigned left, unsigned right)
+{
+	constexpr unsigned N = 32 / sizeof(T);
+	uint32_t mask = UINT32_MAX;
+
+	if (j < left)
+		mask &= UINT32_MAX << ((left - j) * sizeof(T));
+	if (j + N > right)
+		mask &= UINT32_MAX >> ((j + N - right) * sizeof(T));
+	return mask;
+}
+
+template <class T>
+bool alpha_opaque_avx2_impl(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	constexpr unsigned N = 32 / sizeof(T);
+	const T *alpha_p = static_cast<const T *>(alpha);
+
+	unsigned vec_left = ceil_n(left, N);
+	unsigned vec_right = floor_n(right, N);
+
+	if (vec_left > vec_right) {
+		uint32_t mask = alpha_lane_mask<T>(vec_right, left, right);
+		return (static_cast<uint32_t>(_mm256_movemask_epi8(alpha_eq(alpha_p + vec_right, params))) & mask) == mask;
+	}
+
+	if (left != vec_left) {
+		uint32_t mask = alpha_lane_mask<T>(vec_left - N, left, right);
+		if ((static_cast<uint32_t>(_mm256_movemask_epi8(alpha_eq(alpha_p + vec_left - N, params))) & mask) != mask)
+			return false;
+	}
+
+	__m256i accum = _mm256_set1_epi8(-1);
+	for (unsigned j = vec_left; j < vec_right; j += N) {
+		accum = _mm256_and_si256(accum, alpha_eq(alpha_p + j, params));
+	}
+	if (_mm256_movemask_epi8(accum) != -1)
+		return false;
+
+	if (right != vec_right) {
+		uint32_t mask = alpha_lane_mask<T>(vec_right, left, right);
+		if ((static_cast<uint32_t>(_mm256_movemask_epi8(alpha_eq(alpha_p + vec_right, params))) & mask) != mask)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+
+void premultiply_b2w_avx2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_avx2_impl<LoadU8, false>(src, alpha, dst, params, left, right);
+}
+
+void premultiply_w2w_avx2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_avx2_impl<LoadU16, false>(src, alpha, dst, params, left, right);
+}
+
+void premultiply_f32_avx2(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	premultiply_f32_avx2_impl<false>(src, alpha, dst, left, right);
+}
+
+void unpremultiply_w2w_avx2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_avx2_impl<LoadU16, true>(src, alpha, dst, params, left, right);
+}
+
+void unpremultiply_f32_avx2(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	premultiply_f32_avx2_impl<true>(src, alpha, dst, left, right);
+}
+
+bool alpha_opaque_b_avx2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_avx2_impl<uint8_t>(alpha, params, left, right);
+}
+
+bool alpha_opaque_w_avx2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_avx2_impl<uint16_t>(alpha, params, left, right);
+}
+
+bool alpha_opaque_f32_avx2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_avx2_impl<float>(alpha, params, left, right);
+}
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,331 @@
+#ifdef ZIMG_X86
+
+#include <cstdint>
+#include <emmintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "premultiply_x86.h"
+
+#include "common/x86/sse_util.h"
+#include "common/x86/sse2_util.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+struct LoadU8 {
+	typedef uint8_t src_type;
+
+	static inline FORCE_INLINE __m128i load8(const uint8_t *ptr)
+	{
+		return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)ptr), _mm_setzero_si128());
+	}
+};
+
+struct LoadU16 {
+	typedef uint16_t src_type;
+
+	static inline FORCE_INLINE __m128i load8(const uint16_t *ptr)
+	{
+		return _mm_load_si128((const __m128i *)ptr);
+	}
+};
+
+inline FORCE_INLINE __m128i mm_min_epu16(__m128i x, __m128i y)
+{
+	return _mm_sub_epi16(x, _mm_subs_epu16(x, y));
+}
+
+// Computes (x * mul + bias) >> shift, saturated to 16 bits.
+inline FORCE_INLINE __m128i premultiply_widen(__m128i x, __m128i mul, __m128i bias, __m128i shift)
+{
+	__m128i lo = _mm_mullo_epi16(x, mul);
+	__m128i hi = _mm_mulhi_epu16(x, mul);
+
+	__m128i y0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), bias);
+	__m128i y1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), bias);
+
+	y0 = _mm_sra_epi32(y0, shift);
+	y1 = _mm_sra_epi32(y1, shift);
+
+	return mm_packus_epi32(y0, y1);
+}
+
+// Computes round((y * a + offset * (65535 - a)) / 65535).
+inline FORCE_INLINE __m128i premultiply_blend(__m128i y, __m128i a, __m128i offset)
+{
+	const __m128i rounding = _mm_set1_epi32(UINT16_MAX / 2);
+	const __m128i one = _mm_set1_epi32(1);
+
+	__m128i a_inv = _mm_xor_si128(a, _mm_set1_epi16(-1));
+
+	__m128i ya_lo = _mm_mullo_epi16(y, a);
+	__m128i ya_hi = _mm_mulhi_epu16(y, a);
+	__m128i oa_lo = _mm_mullo_epi16(offset, a_inv);
+	__m128i oa_hi = _mm_mulhi_epu16(offset, a_inv);
+
+	__m128i m0 = _mm_add_epi32(_mm_unpacklo_epi16(ya_lo, ya_hi), _mm_unpacklo_epi16(oa_lo, oa_hi));
+	__m128i m1 = _mm_add_epi32(_mm_unpackhi_epi16(ya_lo, ya_hi), _mm_unpackhi_epi16(oa_lo, oa_hi));
+	m0 = _mm_add_epi32(m0, rounding);
+	m1 = _mm_add_epi32(m1, rounding);
+
+	// Division by 65535, exact for numerators less than 65535 * 65536.
+	m0 = _mm_add_epi32(_mm_add_epi32(m0, _mm_srli_epi32(m0, 16)), one);
+	m1 = _mm_add_epi32(_mm_add_epi32(m1, _mm_srli_epi32(m1, 16)), one);
+
+	// The quotient is in the upper half. Sign extension makes the pack exact.
+	return _mm_packs_epi32(_mm_srai_epi32(m0, 16), _mm_srai_epi32(m1, 16));
+}
+
+// Computes offset + (x - offset) * 65535 / a, rounded to nearest, in the
+// lower two lanes. See the AVX2 kernel.
+inline FORCE_INLINE __m128i unpremultiply_i32_2(__m128i x, __m128i a, __m128d offset, __m128d offset_round)
+{
+	__m128d xd = _mm_cvtepi32_pd(x);
+	__m128d ad = _mm_cvtepi32_pd(a);
+
+	xd = _mm_mul_pd(_mm_sub_pd(xd, offset), _mm_set1_pd(UINT16_MAX));
+	xd = _mm_add_pd(_mm_div_pd(xd, ad), offset_round);
+	xd = _mm_min_pd(_mm_max_pd(xd, _mm_setzero_pd()), _mm_set1_pd(UINT16_MAX));
+
+	return _mm_cvttpd_epi32(xd);
+}
+
+struct PremultiplyI16 {
+	__m128i color_mul;
+	__m128i color_bias;
+	__m128i alpha_mul;
+	__m128i alpha_bias;
+	__m128i offset;
+	__m128i alpha_max;
+	__m128i shift;
+	__m128d offset_pd;
+	__m128d offset_round_pd;
+
+	explicit PremultiplyI16(const PremultiplyParams &params) :
+		color_mul{ _mm_set1_epi16(static_cast<uint16_t>(params.color_mul)) },
+		color_bias{ _mm_set1_epi32(params.color_bias) },
+		alpha_mul{ _mm_set1_epi16(static_cast<uint16_t>(params.alpha_mul)) },
+		alpha_bias{ _mm_set1_epi32(params.alpha_bias) },
+		offset{ _mm_set1_epi16(static_cast<uint16_t>(params.offset)) },
+		alpha_max{ _mm_set1_epi16(static_cast<uint16_t>(params.alpha_max)) },
+		shift{ _mm_cvtsi32_si128(params.shift) },
+		offset_pd{ _mm_set1_pd(params.offset) },
+		offset_round_pd{ _mm_set1_pd(params.offset + 0.5) }
+	{}
+
+	inline FORCE_INLINE __m128i premultiply(__m128i x, __m128i a) const
+	{
+		a = mm_min_epu16(a, alpha_max);
+		x = premultiply_widen(x, color_mul, color_bias, shift);
+		a = premultiply_widen(a, alpha_mul, alpha_bias, shift);
+		return premultiply_blend(x, a, offset);
+	}
+
+	inline FORCE_INLINE __m128i unpremultiply_i32_4(__m128i x, __m128i a) const
+	{
+		__m128i r0 = unpremultiply_i32_2(x, a, offset_pd, offset_round_pd);
+		__m128i r1 = unpremultiply_i32_2(_mm_unpackhi_epi64(x, x), _mm_unpackhi_epi64(a, a), offset_pd, offset_round_pd);
+		return _mm_unpacklo_epi64(r0, r1);
+	}
+
+	inline FORCE_INLINE __m128i unpremultiply(__m128i x, __m128i a) const
+	{
+		__m128i r0 = unpremultiply_i32_4(_mm_unpacklo_epi16(x, _mm_setzero_si128()), _mm_unpacklo_epi16(a, _mm_setzero_si128()));
+		__m128i r1 = unpremultiply_i32_4(_mm_unpackhi_epi16(x, _mm_setzero_si128()), _mm_unpackhi_epi16(a, _mm_setzero_si128()));
+
+		__m128i result = mm_packus_epi32(r0, r1);
+		__m128i mask = _mm_cmpeq_epi16(a, _mm_setzero_si128());
+		return _mm_or_si128(_mm_andnot_si128(mask, result), _mm_and_si128(mask, offset));
+	}
+};
+
+template <class Load, bool Unpremultiply>
+inline FORCE_INLINE __m128i premultiply_i16_8(const PremultiplyI16 &c, const typename Load::src_type *src, const typename Load::src_type *alpha)
+{
+	__m128i x = Load::load8(src);
+	__m128i a = Load::load8(alpha);
+
+	return Unpremultiply ? c.unpremultiply(x, a) : c.premultiply(x, a);
+}
+
+template <class Load, bool Unpremultiply>
+void premultiply_i16_sse2_impl(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	const typename Load::src_type *src_p = static_cast<const typename Load::src_type *>(src);
+	const typename Load::src_type *alpha_p = static_cast<const typename Load::src_type *>(alpha);
+	uint16_t *dst_p = static_cast<uint16_t *>(dst);
+
+	unsigned vec_left = ceil_n(left, 8);
+	unsigned vec_right = floor_n(right, 8);
+
+	const PremultiplyI16 c{ params };
+
+	if (left != vec_left) {
+		__m128i x = premultiply_i16_8<Load, Unpremultiply>(c, src_p + vec_left - 8, alpha_p + vec_left - 8);
+		mm_store_idxhi_epi16((__m128i *)(dst_p + vec_left - 8), x, left % 8);
+	}
+
+	for (unsigned j = vec_left; j < vec_right; j += 8) {
+		__m128i x = premultiply_i16_8<Load, Unpremultiply>(c, src_p + j, alpha_p + j);
+		_mm_store_si128((__m128i *)(dst_p + j), x);
+	}
+
+	if (right != vec_right) {
+		__m128i x = premultiply_i16_8<Load, Unpremultiply>(c, src_p + vec_right, alpha_p + vec_right);
+		mm_store_idxlo_epi16((__m128i *)(dst_p + vec_right), x, right % 8);
+	}
+}
+
+inline FORCE_INLINE __m128 premultiply_f32_4(const float *src, const float *alpha)
+{
+	return _mm_mul_ps(_mm_load_ps(src), _mm_load_ps(alpha));
+}
+
+inline FORCE_INLINE __m128 unpremultiply_f32_4(const float *src, const float *alpha)
+{
+	__m128 a = _mm_load_ps(alpha);
+	a = _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+	__m128 mask = _mm_cmpeq_ps(a, _mm_setzero_ps());
+	return _mm_andnot_ps(mask, _mm_div_ps(_mm_load_ps(src), a));
+}
+
+template <bool Unpremultiply>
+void premultiply_f32_sse2_impl(const void *src, const void *alpha, void *dst, unsigned left, unsigned right)
+{
+	const float *src_p = static_cast<const float *>(src);
+	const float *alpha_p = static_cast<const float *>(alpha);
+	float *dst_p = static_cast<float *>(dst);
+
+	unsigned vec_left = ceil_n(left, 4);
+	unsigned vec_right = floor_n(right, 4);
+
+	auto kernel = [](const float *src, const float *alpha)
+	{
+		return Unpremultiply ? unpremultiply_f32_4(src, alpha) : premultiply_f32_4(src, alpha);
+	};
+
+	if (left != vec_left)
+		mm_store_idxhi_ps(dst_p + vec_left - 4, kernel(src_p + vec_left - 4, alpha_p + vec_left - 4), left % 4);
+
+	for (unsigned j = vec_left; j < vec_right; j += 4) {
+		_mm_store_ps(dst_p + j, kernel(src_p + j, alpha_p + j));
+	}
+
+	if (right != vec_right)
+		mm_store_idxlo_ps(dst_p + vec_right, kernel(src_p + vec_right, alpha_p + vec_right), right % 4);
+}
+
+inline FORCE_INLINE __m128i alpha_eq(const uint8_t *ptr, const PremultiplyParams &params)
+{
+	return _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)ptr), _mm_set1_epi8(static_cast<uint8_t>(params.alpha_max)));
+}
+
+inline FORCE_INLINE __m128i alpha_eq(const uint16_t *ptr, const PremultiplyParams &params)
+{
+	return _mm_cmpeq_epi16(_mm_load_si128((const __m128i *)ptr), _mm_set1_epi16(static_cast<uint16_t>(params.alpha_max)));
+}
+
+inline FORCE_INLINE __m128i alpha_eq(const float *ptr, const PremultiplyParams &params)
+{
+	return _mm_castps_si128(_mm_cmpeq_ps(_mm_load_ps(ptr), _mm_set1_ps(static_cast<float>(params.alpha_max))));
+}
+
+// One bit per byte of the vector at j, cleared outside of [left, right).
+template <class T>
+inline FORCE_INLINE unsigned alpha_lane_mask(unsigned j, unsigned left, unsigned right)
+{
+	constexpr unsigned N = 16 / sizeof(T);
+	unsigned mask = 0xFFFFU;
+
+	if (j < left)
+		mask &= 0xFFFFU << ((left - j) * sizeof(T));
+	if (j + N > right)
+		mask &= 0xFFFFU >> ((j + N - right) * sizeof(T));
+	return mask;
+}
+
+template <class T>
+bool alpha_opaque_sse2_impl(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	constexpr unsigned N = 16 / sizeof(T);
+	const T *alpha_p = static_cast<const T *>(alpha);
+
+	unsigned vec_left = ceil_n(left, N);
+	unsigned vec_right = floor_n(right, N);
+
+	if (vec_left > vec_right) {
+		unsigned mask = alpha_lane_mask<T>(vec_right, left, right);
+		return (static_cast<unsigned>(_mm_movemask_epi8(alpha_eq(alpha_p + vec_right, params))) & mask) == mask;
+	}
+
+	if (left != vec_left) {
+		unsigned mask = alpha_lane_mask<T>(vec_left - N, left, right);
+		if ((static_cast<unsigned>(_mm_movemask_epi8(alpha_eq(alpha_p + vec_left - N, params))) & mask) != mask)
+			return false;
+	}
+
+	__m128i accum = _mm_set1_epi8(-1);
+	for (unsigned j = vec_left; j < vec_right; j += N) {
+		accum = _mm_and_si128(accum, alpha_eq(alpha_p + j, params));
+	}
+	if (_mm_movemask_epi8(accum) != 0xFFFF)
+		return false;
+
+	if (right != vec_right) {
+		unsigned mask = alpha_lane_mask<T>(vec_right, left, right);
+		if ((static_cast<unsigned>(_mm_movemask_epi8(alpha_eq(alpha_p + vec_right, params))) & mask) != mask)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+
+void premultiply_b2w_sse2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_sse2_impl<LoadU8, false>(src, alpha, dst, params, left, right);
+}
+
+void premultiply_w2w_sse2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_sse2_impl<LoadU16, false>(src, alpha, dst, params, left, right);
+}
+
+void premultiply_f32_sse2(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	premultiply_f32_sse2_impl<false>(src, alpha, dst, left, right);
+}
+
+void unpremultiply_w2w_sse2(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	premultiply_i16_sse2_impl<LoadU16, true>(src, alpha, dst, params, left, right);
+}
+
+void unpremultiply_f32_sse2(const void *src, const void *alpha, void *dst, const PremultiplyParams &, unsigned left, unsigned right)
+{
+	premultiply_f32_sse2_impl<true>(src, alpha, dst, left, right);
+}
+
+bool alpha_opaque_b_sse2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_sse2_impl<uint8_t>(alpha, params, left, right);
+}
+
+bool alpha_opaque_w_sse2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_sse2_impl<uint16_t>(alpha, params, left, right);
+}
+
+bool alpha_opaque_f32_sse2(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right)
+{
+	return alpha_opaque_sse2_impl<float>(alpha, params, left, right);
+}
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_X86
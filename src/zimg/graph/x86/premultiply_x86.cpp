@@ -0,0 +1,137 @@
+#ifdef ZIMG_X86
+
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "premultiply_x86.h"
+
+namespace zimg {
+namespace graph {
+
+namespace {
+
+premultiply_func select_premultiply_func_sse2(PixelType type)
+{
+	switch (type) {
+	case PixelType::BYTE: return premultiply_b2w_sse2;
+	case PixelType::WORD: return premultiply_w2w_sse2;
+	case PixelType::FLOAT: return premultiply_f32_sse2;
+	default: return nullptr;
+	}
+}
+
+premultiply_func select_unpremultiply_func_sse2(PixelType type)
+{
+	switch (type) {
+	case PixelType::WORD: return unpremultiply_w2w_sse2;
+	case PixelType::FLOAT: return unpremultiply_f32_sse2;
+	default: return nullptr;
+	}
+}
+
+alpha_opaque_func select_alpha_opaque_func_sse2(PixelType type)
+{
+	switch (type) {
+	case PixelType::BYTE: return alpha_opaque_b_sse2;
+	case PixelType::WORD: return alpha_opaque_w_sse2;
+	case PixelType::FLOAT: return alpha_opaque_f32_sse2;
+	default: return nullptr;
+	}
+}
+
+premultiply_func select_premultiply_func_avx2(PixelType type)
+{
+	switch (type) {
+	case PixelType::BYTE: return premultiply_b2w_avx2;
+	case PixelType::WORD: return premultiply_w2w_avx2;
+	case PixelType::FLOAT: return premultiply_f32_avx2;
+	default: return nullptr;
+	}
+}
+
+premultiply_func select_unpremultiply_func_avx2(PixelType type)
+{
+	switch (type) {
+	case PixelType::WORD: return unpremultiply_w2w_avx2;
+	case PixelType::FLOAT: return unpremultiply_f32_avx2;
+	default: return nullptr;
+	}
+}
+
+alpha_opaque_func select_alpha_opaque_func_avx2(PixelType type)
+{
+	switch (type) {
+	case PixelType::BYTE: return alpha_opaque_b_avx2;
+	case PixelType::WORD: return alpha_opaque_w_avx2;
+	case PixelType::FLOAT: return alpha_opaque_f32_avx2;
+	default: return nullptr;
+	}
+}
+
+} // namespace
+
+
+premultiply_func select_premultiply_func_x86(PixelType type, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	premultiply_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+		if (!func && caps.avx2)
+			func = select_premultiply_func_avx2(type);
+		if (!func && caps.sse2)
+			func = select_premultiply_func_sse2(type);
+	} else {
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_premultiply_func_avx2(type);
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = select_premultiply_func_sse2(type);
+	}
+
+	return func;
+}
+
+premultiply_func select_unpremultiply_func_x86(PixelType type, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	premultiply_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+		if (!func && caps.avx2)
+			func = select_unpremultiply_func_avx2(type);
+		if (!func && caps.sse2)
+			func = select_unpremultiply_func_sse2(type);
+	} else {
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_unpremultiply_func_avx2(type);
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = select_unpremultiply_func_sse2(type);
+	}
+
+	return func;
+}
+
+alpha_opaque_func select_alpha_opaque_func_x86(PixelType type, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	alpha_opaque_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+		if (!func && caps.avx2)
+			func = select_alpha_opaque_func_avx2(type);
+		if (!func && caps.sse2)
+			func = select_alpha_opaque_func_sse2(type);
+	} else {
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_alpha_opaque_func_avx2(type);
+		if (!func && cpu >= CPUClass::X86_SSE2)
+			func = select_alpha_opaque_func_sse2(type);
+	}
+
+	return func;
+}
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_X86
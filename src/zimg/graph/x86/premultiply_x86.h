@@ -0,0 +1,54 @@
+#pragma once
+
+#ifdef ZIMG_X86
+
+#ifndef ZIMG_GRAPH_X86_PREMULTIPLY_X86_H_
+#define ZIMG_GRAPH_X86_PREMULTIPLY_X86_H_
+
+#include "graph/simple_filters.h"
+
+namespace zimg {
+namespace graph {
+
+#define DECLARE_PREMULTIPLY(x, cpu) \
+void x##_##cpu(const void *src, const void *alpha, void *dst, const PremultiplyParams &params, unsigned left, unsigned right);
+
+DECLARE_PREMULTIPLY(premultiply_b2w, sse2)
+DECLARE_PREMULTIPLY(premultiply_w2w, sse2)
+DECLARE_PREMULTIPLY(premultiply_f32, sse2)
+DECLARE_PREMULTIPLY(unpremultiply_w2w, sse2)
+DECLARE_PREMULTIPLY(unpremultiply_f32, sse2)
+
+DECLARE_PREMULTIPLY(premultiply_b2w, avx2)
+DECLARE_PREMULTIPLY(premultiply_w2w, avx2)
+DECLARE_PREMULTIPLY(premultiply_f32, avx2)
+DECLARE_PREMULTIPLY(unpremultiply_w2w, avx2)
+DECLARE_PREMULTIPLY(unpremultiply_f32, avx2)
+
+#undef DECLARE_PREMULTIPLY
+
+#define DECLARE_ALPHA_OPAQUE(x, cpu) \
+bool alpha_opaque_##x##_##cpu(const void *alpha, const PremultiplyParams &params, unsigned left, unsigned right);
+
+DECLARE_ALPHA_OPAQUE(b, sse2)
+DECLARE_ALPHA_OPAQUE(w, sse2)
+DECLARE_ALPHA_OPAQUE(f32, sse2)
+
+DECLARE_ALPHA_OPAQUE(b, avx2)
+DECLARE_ALPHA_OPAQUE(w, avx2)
+DECLARE_ALPHA_OPAQUE(f32, avx2)
+
+#undef DECLARE_ALPHA_OPAQUE
+
+premultiply_func select_premultiply_func_x86(PixelType type, CPUClass cpu);
+
+premultiply_func select_unpremultiply_func_x86(PixelType type, CPUClass cpu);
+
+alpha_opaque_func select_alpha_opaque_func_x86(PixelType type, CPUClass cpu);
+
+} // namespace graph
+} // namespace zimg
+
+#endif // ZIMG_GRAPH_X86_PREMULTIPLY_X86_H_
+
+#endif // ZIMG_X86
@@ -8,7 +8,7 @@
 namespace zimg {
 namespace resize {
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_arm(const FilterContext &context, unsigned height, PixelType type, unsigned depth, CPUClass cpu)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_arm(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth, CPUClass cpu)
 {
 	ARMCapabilities caps = query_arm_capabilities();
 	std::unique_ptr<graphengine::Filter> ret;
@@ -24,7 +24,7 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_arm(const FilterContex
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_arm(const FilterContext &context, unsigned width, PixelType type, unsigned depth, CPUClass cpu)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_arm(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth, CPUClass cpu)
 {
 	ARMCapabilities caps = query_arm_capabilities();
 	std::unique_ptr<graphengine::Filter> ret;
@@ -715,18 +715,18 @@ class ResizeImplH_U16_Neon final : public ResizeImplH {
 	decltype(resize_line8_h_u16_neon_jt_small)::value_type m_func;
 	uint16_t m_pixel_max;
 public:
-	ResizeImplH_U16_Neon(const FilterContext &filter, unsigned height, unsigned depth) try :
+	ResizeImplH_U16_Neon(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth) try :
 		ResizeImplH(filter, height, PixelType::WORD),
 		m_func{},
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		m_desc.step = 8;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 8) * sizeof(uint16_t) * 8).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 8) * sizeof(uint16_t) * 8).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line8_h_u16_neon_jt_small[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line8_h_u16_neon_jt_small[filter->filter_width - 1];
 		else
-			m_func = resize_line8_h_u16_neon_jt_large[filter.filter_width % 8];
+			m_func = resize_line8_h_u16_neon_jt_large[filter->filter_width % 8];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -760,17 +760,17 @@ public:
 class ResizeImplH_F32_Neon final : public ResizeImplH {
 	decltype(resize_line4_h_f32_neon_jt_small)::value_type m_func;
 public:
-	ResizeImplH_F32_Neon(const FilterContext &filter, unsigned height) try :
+	ResizeImplH_F32_Neon(const std::shared_ptr<const FilterContext> &filter, unsigned height) try :
 		ResizeImplH(filter, height, PixelType::FLOAT),
 		m_func{}
 	{
 		m_desc.step = 4;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 4) * sizeof(float) * 4).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 4) * sizeof(float) * 4).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line4_h_f32_neon_jt_small[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line4_h_f32_neon_jt_small[filter->filter_width - 1];
 		else
-			m_func = resize_line4_h_f32_neon_jt_large[filter.filter_width % 4];
+			m_func = resize_line4_h_f32_neon_jt_large[filter->filter_width % 4];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -806,7 +806,7 @@ public:
 class ResizeImplV_U16_Neon : public ResizeImplV {
 	uint16_t m_pixel_max;
 public:
-	ResizeImplV_U16_Neon(const FilterContext &filter, unsigned width, unsigned depth) try :
+	ResizeImplV_U16_Neon(const std::shared_ptr<const FilterContext> &filter, unsigned width, unsigned depth) try :
 		ResizeImplV(filter, width, PixelType::WORD),
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
@@ -819,7 +819,7 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
 	{
-		const int16_t *filter_data = m_filter.data_i16.data() + i * m_filter.stride_i16;
+		const int16_t *filter_data = m_filter.row_i16(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -861,14 +861,14 @@ public:
 
 class ResizeImplV_F32_Neon : public ResizeImplV {
 public:
-	ResizeImplV_F32_Neon(const FilterContext &filter, unsigned width) :
+	ResizeImplV_F32_Neon(const std::shared_ptr<const FilterContext> &filter, unsigned width) :
 		ResizeImplV(filter, width, PixelType::FLOAT)
 	{}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		const float *filter_data = m_filter.data.data() + i * m_filter.stride;
+		const float *filter_data = m_filter.row(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -912,7 +912,7 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_neon(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_neon(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -924,7 +924,7 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_neon(const FilterConte
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_neon(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_neon(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "common/align.h"
+#include "common/pixel.h"
+#include "common/zassert.h"
+#include "graph/filter_base.h"
+#include "chroma_upsample.h"
+#include "filter.h"
+#include "resize.h"
+
+#if defined(ZIMG_X86)
+  #include "x86/chroma_upsample_x86.h"
+#endif
+
+namespace zimg {
+namespace resize {
+
+namespace {
+
+ChromaUpsamplePhases find_periodic_taps(const FilterContext &filter)
+{
+	ChromaUpsamplePhases taps{};
+
+	if (filter.filter_rows != filter.input_width * 2)
+		return taps;
+
+	// Take the phases from the middle of the row, which is furthest from the edges.
+	unsigned mid = (filter.filter_rows / 2) & ~1U;
+
+	for (unsigned q = 0; q < 2; ++q) {
+		unsigned row = mid + q;
+		taps.offset[q] = static_cast<int>(filter.left[row]) - static_cast<int>(row / 2);
+		std::copy_n(&filter.data[row * filter.stride], filter.filter_width, taps.coeffs[q]);
+		std::copy_n(&filter.data_i16[row * filter.stride_i16], filter.filter_width, taps.coeffs_i16[q]);
+	}
+
+	auto is_periodic = [&](unsigned j)
+	{
+		unsigned q = j % 2;
+
+		if (static_cast<int>(filter.left[j]) != taps.offset[q] + static_cast<int>(j / 2))
+			return false;
+		return std::equal(taps.coeffs[q], taps.coeffs[q] + filter.filter_width, &filter.data[j * filter.stride]) &&
+			std::equal(taps.coeffs_i16[q], taps.coeffs_i16[q] + filter.filter_width, &filter.data_i16[j * filter.stride_i16]);
+	};
+
+	taps.left = mid;
+	taps.right = mid;
+
+	while (taps.left > 0 && is_periodic(taps.left - 1)) {
+		--taps.left;
+	}
+	while (taps.right < filter.filter_rows && is_periodic(taps.right)) {
+		++taps.right;
+	}
+
+	return taps;
+}
+
+
+// Integer samples are biased to signed 16-bit, as in the separable resizer.
+struct PixelU8 {
+	typedef uint8_t src_type;
+	typedef uint8_t dst_type;
+
+	static int32_t unpack(uint8_t x) noexcept { return x; }
+
+	static void pack(int32_t x, int32_t pixel_max, uint8_t &dst) noexcept
+	{
+		x = (x + (1 << 13)) >> 14;
+		dst = static_cast<uint8_t>(std::max(std::min(x, pixel_max), static_cast<int32_t>(0)));
+	}
+};
+
+struct PixelU16 {
+	typedef uint16_t src_type;
+	typedef uint16_t dst_type;
+
+	static int32_t unpack(uint16_t x) noexcept { return static_cast<int32_t>(x) + INT16_MIN; }
+
+	static void pack(int32_t x, int32_t pixel_max, uint16_t &dst) noexcept
+	{
+		x = ((x + (1 << 13)) >> 14) - INT16_MIN;
+		dst = static_cast<uint16_t>(std::max(std::min(x, pixel_max), static_cast<int32_t>(0)));
+	}
+};
+
+template <class Traits, unsigned Taps>
+void upsample_line_v_int_c(const FilterContext &filter, const graphengine::BufferDescriptor &src, void *dst, unsigned i, unsigned left, unsigned right, unsigned pixel_max)
+{
+	typedef typename Traits::src_type src_type;
+	typedef typename Traits::dst_type dst_type;
+
+	const src_type *src_p[Taps];
+	int32_t c[Taps];
+	dst_type *dst_p = static_cast<dst_type *>(dst);
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		src_p[k] = src.get_line<const src_type>(filter.left[i] + k);
+		c[k] = filter.row_i16(i)[k];
+	}
+
+	for (unsigned j = left; j < right; ++j) {
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += c[k] * Traits::unpack(src_p[k][j]);
+		}
+
+		Traits::pack(accum, pixel_max, dst_p[j]);
+	}
+}
+
+template <class Traits, unsigned Taps>
+void upsample_line_h_int_c(const FilterContext &filter, const ChromaUpsamplePhases &, const void *src, void *dst, unsigned left, unsigned right, unsigned pixel_max)
+{
+	typedef typename Traits::src_type src_type;
+	typedef typename Traits::dst_type dst_type;
+
+	const src_type *src_p = static_cast<const src_type *>(src);
+	dst_type *dst_p = static_cast<dst_type *>(dst);
+
+	for (unsigned j = left; j < right; ++j) {
+		const int16_t *coeffs = &filter.data_i16[j * filter.stride_i16];
+		const src_type *src_col = src_p + filter.left[j];
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += coeffs[k] * Traits::unpack(src_col[k]);
+		}
+
+		Traits::pack(accum, pixel_max, dst_p[j]);
+	}
+}
+
+template <unsigned Taps>
+void upsample_line_v_c(const FilterContext &filter, const graphengine::BufferDescriptor &src, void *dst, unsigned i, unsigned left, unsigned right, unsigned)
+{
+	const float *src_p[Taps];
+	float *dst_p = static_cast<float *>(dst);
+	float c[Taps];
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		src_p[k] = src.get_line<const float>(filter.left[i] + k);
+		c[k] = filter.row(i)[k];
+	}
+
+	for (unsigned j = left; j < right; ++j) {
+		float accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += c[k] * src_p[k][j];
+		}
+
+		dst_p[j] = accum;
+	}
+}
+
+template <unsigned Taps>
+void upsample_line_h_c(const FilterContext &filter, const ChromaUpsamplePhases &periodic, const void *src, void *dst, unsigned left, unsigned right, unsigned)
+{
+	const float *src_p = static_cast<const float *>(src);
+	float *dst_p = static_cast<float *>(dst);
+
+	auto filter_column = [&](unsigned j)
+	{
+		const float *coeffs = &filter.data[j * filter.stride];
+		const float *src_col = src_p + filter.left[j];
+		float accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += coeffs[k] * src_col[k];
+		}
+
+		dst_p[j] = accum;
+	};
+
+	unsigned periodic_left = std::min(std::max(left, periodic.left), right);
+	unsigned periodic_right = std::max(std::min(right, periodic.right), periodic_left);
+	unsigned j = left;
+
+	for (; j < periodic_left; ++j) {
+		filter_column(j);
+	}
+
+	if (j % 2 && j < periodic_right)
+		filter_column(j++);
+
+	float c0[Taps];
+	float c1[Taps];
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		c0[k] = periodic.coeffs[0][k];
+		c1[k] = periodic.coeffs[1][k];
+	}
+
+	for (; j + 2 <= periodic_right; j += 2) {
+		const float *src0 = src_p + (periodic.offset[0] + static_cast<int>(j / 2));
+		const float *src1 = src_p + (periodic.offset[1] + static_cast<int>(j / 2));
+		float accum0 = 0;
+		float accum1 = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum0 += c0[k] * src0[k];
+			accum1 += c1[k] * src1[k];
+		}
+
+		dst_p[j + 0] = accum0;
+		dst_p[j + 1] = accum1;
+	}
+
+	for (; j < right; ++j) {
+		filter_column(j);
+	}
+}
+
+
+class ChromaUpsampleFilter : public graph::FilterBase {
+	std::shared_ptr<const FilterContext> m_filter_h;
+	std::shared_ptr<const FilterContext> m_filter_v;
+	ChromaUpsamplePhases m_periodic;
+	chroma_upsample_h_func m_func_h;
+	chroma_upsample_v_func m_func_v;
+	unsigned m_pixel_max;
+public:
+	ChromaUpsampleFilter(std::shared_ptr<const FilterContext> filter_h, chroma_upsample_h_func func_h,
+	                     std::shared_ptr<const FilterContext> filter_v, chroma_upsample_v_func func_v,
+	                     unsigned src_width, unsigned src_height, PixelType type, unsigned depth) :
+		m_filter_h{ std::move(filter_h) },
+		m_filter_v{ std::move(filter_v) },
+		m_periodic{},
+		m_func_h{ func_h },
+		m_func_v{ func_v },
+		m_pixel_max{ static_cast<unsigned>(1UL << depth) - 1 }
+	{
+		zassert_d(m_filter_h || m_filter_v, "no resize required");
+
+		if (m_filter_h)
+			m_periodic = find_periodic_taps(*m_filter_h);
+
+		m_desc.format = {
+			m_filter_h ? m_filter_h->filter_rows : src_width,
+			m_filter_v ? m_filter_v->filter_rows : src_height,
+			pixel_size(type)
+		};
+		m_desc.num_deps = 2;
+		m_desc.num_planes = 2;
+		m_desc.step = 1;
+		m_desc.scratchpad_size = m_filter_h && m_filter_v ? ceil_n(static_cast<size_t>(src_width) * pixel_size(type), ALIGNMENT) : 0;
+	}
+
+	pair_unsigned get_row_deps(unsigned i) const noexcept override
+	{
+		if (!m_filter_v)
+			return{ i, i + 1 };
+
+		unsigned top = m_filter_v->left[i];
+		return{ top, top + m_filter_v->filter_width };
+	}
+
+	pair_unsigned get_col_deps(unsigned left, unsigned right) const noexcept override
+	{
+		if (!m_filter_h)
+			return{ left, right };
+
+		return{ m_filter_h->left[left], m_filter_h->left[right - 1] + m_filter_h->filter_width };
+	}
+
+	void process(const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[],
+	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
+	{
+		pair_unsigned col_deps = get_col_deps(left, right);
+
+		for (unsigned p = 0; p < 2; ++p) {
+			void *dst = out[p].get_line(i);
+
+			if (!m_filter_h) {
+				m_func_v(*m_filter_v, in[p], dst, i, left, right, m_pixel_max);
+				continue;
+			}
+
+			// The vertical pass runs first, on the narrower input line.
+			const void *src = in[p].get_line(i);
+			if (m_filter_v) {
+				m_func_v(*m_filter_v, in[p], tmp, i, col_deps.first, col_deps.second, m_pixel_max);
+				src = tmp;
+			}
+
+			m_func_h(*m_filter_h, m_periodic, src, dst, left, right, m_pixel_max);
+		}
+	}
+};
+
+template <class Traits>
+chroma_upsample_v_func select_line_v_int_func(unsigned taps)
+{
+	switch (taps) {
+	case 1: return upsample_line_v_int_c<Traits, 1>;
+	case 2: return upsample_line_v_int_c<Traits, 2>;
+	case 3: return upsample_line_v_int_c<Traits, 3>;
+	case 4: return upsample_line_v_int_c<Traits, 4>;
+	default: return nullptr;
+	}
+}
+
+template <class Traits>
+chroma_upsample_h_func select_line_h_int_func(unsigned taps)
+{
+	switch (taps) {
+	case 1: return upsample_line_h_int_c<Traits, 1>;
+	case 2: return upsample_line_h_int_c<Traits, 2>;
+	case 3: return upsample_line_h_int_c<Traits, 3>;
+	case 4: return upsample_line_h_int_c<Traits, 4>;
+	default: return nullptr;
+	}
+}
+
+chroma_upsample_v_func select_line_v_func(unsigned taps, PixelType type)
+{
+	if (type == PixelType::BYTE)
+		return select_line_v_int_func<PixelU8>(taps);
+	if (type == PixelType::WORD)
+		return select_line_v_int_func<PixelU16>(taps);
+
+	switch (taps) {
+	case 1: return upsample_line_v_c<1>;
+	case 2: return upsample_line_v_c<2>;
+	case 3: return upsample_line_v_c<3>;
+	case 4: return upsample_line_v_c<4>;
+	default: return nullptr;
+	}
+}
+
+chroma_upsample_h_func select_line_h_func(unsigned taps, PixelType type)
+{
+	if (type == PixelType::BYTE)
+		return select_line_h_int_func<PixelU8>(taps);
+	if (type == PixelType::WORD)
+		return select_line_h_int_func<PixelU16>(taps);
+
+	switch (taps) {
+	case 1: return upsample_line_h_c<1>;
+	case 2: return upsample_line_h_c<2>;
+	case 3: return upsample_line_h_c<3>;
+	case 4: return upsample_line_h_c<4>;
+	default: return nullptr;
+	}
+}
+
+bool is_upsample_dim(unsigned src_dim, unsigned dst_dim, double subwidth)
+{
+	return subwidth == src_dim && (dst_dim == src_dim || (dst_dim / 2 == src_dim && dst_dim % 2 == 0));
+}
+
+} // namespace
+
+
+std::unique_ptr<graphengine::Filter> create_chroma_upsample(const ResizeConversion &conv)
+{
+	if (conv.type == PixelType::HALF || !conv.filter || conv.filter->support() > CHROMA_UPSAMPLE_MAX_TAPS / 2)
+		return nullptr;
+	if (conv.dst_width > pixel_max_width(conv.type))
+		return nullptr;
+	if (!is_upsample_dim(conv.src_width, conv.dst_width, conv.subwidth) || !is_upsample_dim(conv.src_height, conv.dst_height, conv.subheight))
+		return nullptr;
+
+	bool skip_h = conv.src_width == conv.dst_width && conv.shift_w == 0;
+	bool skip_v = conv.src_height == conv.dst_height && conv.shift_h == 0;
+
+	if (skip_h && skip_v)
+		return nullptr;
+
+	// The separable resizer filters 8-bit images horizontally first, on the
+	// subsampled rows, and keeps a 16-bit intermediate. Running the horizontal
+	// pass on every output row instead is slower than both passes together.
+	if (conv.type == PixelType::BYTE && !skip_h && !skip_v)
+		return nullptr;
+
+	std::shared_ptr<const FilterContext> filter_h;
+	std::shared_ptr<const FilterContext> filter_v;
+	chroma_upsample_h_func func_h = nullptr;
+	chroma_upsample_v_func func_v = nullptr;
+
+	if (!skip_h) {
+		filter_h = compute_filter_shared(*conv.filter, conv.src_width, conv.dst_width, conv.shift_w, conv.subwidth);
+#if defined(ZIMG_X86)
+		func_h = select_chroma_upsample_h_func_x86(filter_h->filter_width, conv.type, conv.cpu);
+#endif
+		if (!func_h)
+			func_h = select_line_h_func(filter_h->filter_width, conv.type);
+
+		if (!func_h || !std::is_sorted(filter_h->left.begin(), filter_h->left.end()))
+			return nullptr;
+	}
+	if (!skip_v) {
+		filter_v = compute_filter_shared(*conv.filter, conv.src_height, conv.dst_height, conv.shift_h, conv.subheight, true);
+#if defined(ZIMG_X86)
+		func_v = select_chroma_upsample_v_func_x86(filter_v->filter_width, conv.type, conv.cpu);
+#endif
+		if (!func_v)
+			func_v = select_line_v_func(filter_v->filter_width, conv.type);
+
+		if (!func_v || !std::is_sorted(filter_v->left.begin(), filter_v->left.end()))
+			return nullptr;
+	}
+
+	return std::make_unique<ChromaUpsampleFilter>(std::move(filter_h), func_h, std::move(filter_v), func_v, conv.src_width, conv.src_height, conv.type, conv.depth);
+}
+
+} // namespace resize
+} // namespace zimg
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef ZIMG_RESIZE_CHROMA_UPSAMPLE_H_
+#define ZIMG_RESIZE_CHROMA_UPSAMPLE_H_
+
+#include <cstdint>
+#include <memory>
+
+namespace graphengine {
+class Filter;
+struct BufferDescriptor;
+}
+
+
+namespace zimg {
+namespace resize {
+
+struct FilterContext;
+struct ResizeConversion;
+
+/**
+ * Maximum number of filter taps supported by {@link create_chroma_upsample}.
+ */
+constexpr unsigned CHROMA_UPSAMPLE_MAX_TAPS = 4;
+
+/**
+ * Output columns [left, right) of a 2x horizontal filter, whose taps repeat
+ * every two columns. Column j reads from input column offset[j % 2] + j / 2.
+ */
+struct ChromaUpsamplePhases {
+	unsigned left;
+	unsigned right;
+	int offset[2];
+	float coeffs[2][CHROMA_UPSAMPLE_MAX_TAPS];
+	int16_t coeffs_i16[2][CHROMA_UPSAMPLE_MAX_TAPS];
+};
+
+typedef void (*chroma_upsample_v_func)(const FilterContext &filter, const graphengine::BufferDescriptor &src, void *dst, unsigned i, unsigned left, unsigned right, unsigned pixel_max);
+typedef void (*chroma_upsample_h_func)(const FilterContext &filter, const ChromaUpsamplePhases &phases, const void *src, void *dst, unsigned left, unsigned right, unsigned pixel_max);
+
+/**
+ * Create a filter resizing both chroma planes of an image in one pass.
+ *
+ * The conversion must scale each dimension by exactly one or two without
+ * cropping, and the filter must have a support of at most two, so that each
+ * output sample is computed from at most four taps per direction. Away from
+ * the image edges, the horizontal taps repeat every two output samples and
+ * are held in registers.
+ *
+ * The filter consumes and produces two planes of the conversion's pixel type,
+ * which may be WORD or FLOAT, or BYTE if only one direction is resized.
+ * Integer samples are rounded to the conversion's depth after the vertical
+ * and the horizontal pass, as in the separable resizer.
+ *
+ * @param conv resize parameters, applied identically to both planes
+ * @return filter, or nullptr if the conversion is not supported
+ */
+std::unique_ptr<graphengine::Filter> create_chroma_upsample(const ResizeConversion &conv);
+
+} // namespace resize
+} // namespace zimg
+
+#endif // ZIMG_RESIZE_CHROMA_UPSAMPLE_H_
@@ -4,11 +4,16 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdlib>
+#include <initializer_list>
+#include <list>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "common/except.h"
 #include "common/libm_wrapper.h"
-#include "common/matrix.h"
 #include "common/zassert.h"
 #include "filter.h"
 
@@ -41,90 +46,141 @@ double round_halfup(double x) noexcept
 }
 
 
-FilterContext matrix_to_filter(const RowMatrix<double> &m)
+/* Dither filter coefficients when rounding them to their storage format.
+ * This minimizes accumulation of error and ensures that the filter
+ * continues to sum as close to 1.0 as possible after rounding.
+ */
+void quantize_row(const double *coeffs, unsigned width, float *dst, int16_t *dst_i16)
 {
-	size_t width = 0;
+	double f32_err = 0.0f;
+	double i16_err = 0;
 
-	for (size_t i = 0; i < m.rows(); ++i) {
-		width = std::max(width, m.row_right(i) - m.row_left(i));
-	}
-	zassert_d(width, "empty matrix");
+	double f32_sum = 0.0;
+	int16_t i16_sum = 0;
+	int16_t i16_greatest = 0;
+	unsigned i16_greatest_idx = 0;
 
-	if (width > floor_n(UINT_MAX, AlignmentOf<uint16_t>))
-		error::throw_<error::OutOfMemory>();
-	if (width > floor_n(UINT_MAX, AlignmentOf<float>))
-		error::throw_<error::OutOfMemory>();
+	for (unsigned j = 0; j < width; ++j) {
+		double coeff = coeffs[j];
 
-	FilterContext e{};
+		double coeff_expected_f32 = coeff - f32_err;
+		double coeff_expected_i16 = coeff * (1 << 14) - i16_err;
 
-	try {
-		e.filter_width = static_cast<unsigned>(width);
-		e.filter_rows = static_cast<unsigned>(m.rows());
-		e.input_width = static_cast<unsigned>(m.cols());
-		e.stride = static_cast<unsigned>(ceil_n(width, AlignmentOf<float>));
-		e.stride_i16 = static_cast<unsigned>(ceil_n(width, AlignmentOf<uint16_t>));
+		float coeff_f32 = static_cast<float>(coeff_expected_f32);
+		int16_t coeff_i16 = static_cast<int16_t>(std::lrint(coeff_expected_i16));
 
-		if (e.filter_rows > UINT_MAX / e.stride || e.filter_rows > UINT_MAX / e.stride_i16)
-			error::throw_<error::OutOfMemory>();
+		f32_err = static_cast<double>(coeff_f32) - coeff_expected_f32;
+		i16_err = static_cast<double>(coeff_i16) - coeff_expected_i16;
 
-		e.data.resize(static_cast<size_t>(e.stride) * e.filter_rows);
-		e.data_i16.resize(static_cast<size_t>(e.stride_i16) * e.filter_rows);
-		e.left.resize(e.filter_rows);
-	} catch (const std::length_error &) {
-		error::throw_<error::OutOfMemory>();
-	}
+		if (std::abs(coeff_i16) > i16_greatest) {
+			i16_greatest = coeff_i16;
+			i16_greatest_idx = j;
+		}
 
-	for (size_t i = 0; i < m.rows(); ++i) {
-		unsigned left = static_cast<unsigned>(std::min(m.row_left(i), m.cols() - width));
-		double f32_err = 0.0f;
-		double i16_err = 0;
+		f32_sum += coeff_f32;
+		i16_sum += coeff_i16;
 
-		double f32_sum = 0.0;
-		int16_t i16_sum = 0;
-		int16_t i16_greatest = 0;
-		size_t i16_greatest_idx = 0;
+		dst[j] = coeff_f32;
+		dst_i16[j] = coeff_i16;
+	}
 
-		/* Dither filter coefficients when rounding them to their storage format.
-		 * This minimizes accumulation of error and ensures that the filter
-		 * continues to sum as close to 1.0 as possible after rounding.
-		 */
-		for (size_t j = 0; j < width; ++j) {
-			double coeff = m[i][left + j];
+	/* The final sum may still be off by a few ULP. This can not be fixed for
+	 * floating point data, since the error is dependent on summation order,
+	 * but for integer data, the error can be added to the greatest coefficient.
+	 */
+	zassert_d(1.0 - f32_sum <= FLT_EPSILON, "error too great");
+	zassert_d(std::abs((1 << 14) - i16_sum) <= 1, "error too great");
 
-			double coeff_expected_f32 = coeff - f32_err;
-			double coeff_expected_i16 = coeff * (1 << 14) - i16_err;
+	dst_i16[i16_greatest_idx] += (1 << 14) - i16_sum;
+}
 
-			float coeff_f32 = static_cast<float>(coeff_expected_f32);
-			int16_t coeff_i16 = static_cast<int16_t>(std::lrint(coeff_expected_i16));
+template <class T>
+void append_key(std::string &key, const T &x)
+{
+	key.append(reinterpret_cast<const char *>(&x), sizeof(x));
+}
 
-			f32_err = static_cast<double>(coeff_f32) - coeff_expected_f32;
-			i16_err = static_cast<double>(coeff_i16) - coeff_expected_i16;
+std::string make_key(const char *name, std::initializer_list<double> params = {})
+{
+	std::string key = name;
+	for (double x : params) {
+		append_key(key, x == 0.0 ? 0.0 : x);
+	}
+	return key;
+}
 
-			if (std::abs(coeff_i16) > i16_greatest) {
-				i16_greatest = coeff_i16;
-				i16_greatest_idx = j;
-			}
+class FilterContextStore {
+	// Contexts are interned weakly, and the most recently used ones are also
+	// kept alive, so that rebuilding a freed graph reuses its coefficients.
+	static constexpr size_t RECENT_MAX = 16;
+
+	std::unordered_map<std::string, std::weak_ptr<const FilterContext>> m_map;
+	std::list<std::shared_ptr<const FilterContext>> m_recent;
+	std::mutex m_mutex;
+	size_t m_sweep_size;
+
+	void touch(std::shared_ptr<const FilterContext> filter)
+	{
+		auto it = std::find(m_recent.begin(), m_recent.end(), filter);
+		if (it != m_recent.end()) {
+			m_recent.splice(m_recent.begin(), m_recent, it);
+			return;
+		}
 
-			f32_sum += coeff_f32;
-			i16_sum += coeff_i16;
+		m_recent.push_front(std::move(filter));
+		if (m_recent.size() > RECENT_MAX)
+			m_recent.pop_back();
+	}
 
-			e.data[i * e.stride + j] = coeff_f32;
-			e.data_i16[i * e.stride_i16 + j] = coeff_i16;
+	void sweep()
+	{
+		for (auto it = m_map.begin(); it != m_map.end();) {
+			if (it->second.expired())
+				it = m_map.erase(it);
+			else
+				++it;
 		}
+		m_sweep_size = std::max(m_map.size() * 2, static_cast<size_t>(64));
+	}
+public:
+	FilterContextStore() : m_sweep_size{ 64 } {}
+
+	std::shared_ptr<const FilterContext> find(const std::string &key)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		auto it = m_map.find(key);
+		if (it == m_map.end())
+			return nullptr;
+
+		std::shared_ptr<const FilterContext> filter = it->second.lock();
+		if (filter)
+			touch(filter);
+		return filter;
+	}
 
-		/* The final sum may still be off by a few ULP. This can not be fixed for
-		 * floating point data, since the error is dependent on summation order,
-		 * but for integer data, the error can be added to the greatest coefficient.
-		 */
-		zassert_d(1.0 - f32_sum <= FLT_EPSILON, "error too great");
-		zassert_d(std::abs((1 << 14) - i16_sum) <= 1, "error too great");
+	std::shared_ptr<const FilterContext> insert(const std::string &key, std::shared_ptr<const FilterContext> filter)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
 
-		e.data_i16[i * e.stride_i16 + i16_greatest_idx] += (1 << 14) - i16_sum;
+		// Another thread may have computed the same filter concurrently.
+		std::weak_ptr<const FilterContext> &entry = m_map[key];
+		if (std::shared_ptr<const FilterContext> existing = entry.lock()) {
+			touch(existing);
+			return existing;
+		}
 
-		e.left[i] = left;
+		entry = filter;
+		touch(filter);
+		if (m_map.size() >= m_sweep_size)
+			sweep();
+		return filter;
 	}
+};
 
-	return e;
+FilterContextStore &filter_context_store()
+{
+	static FilterContextStore store;
+	return store;
 }
 
 } // namespace
@@ -132,10 +188,14 @@ FilterContext matrix_to_filter(const RowMatrix<double> &m)
 
 Filter::~Filter() = default;
 
+std::string Filter::cache_key() const { return{}; }
+
 unsigned PointFilter::support() const { return 0; }
 
 double PointFilter::operator()(double x) const { return 1.0; }
 
+std::string PointFilter::cache_key() const { return make_key("point"); }
+
 
 unsigned BilinearFilter::support() const { return 1; }
 
@@ -144,6 +204,8 @@ double BilinearFilter::operator()(double x) const
 	return std::max(1.0 - std::abs(x), 0.0);
 }
 
+std::string BilinearFilter::cache_key() const { return make_key("bilinear"); }
+
 
 BicubicFilter::BicubicFilter(double b, double c) :
 	p0{ (  6.0 -  2.0 * b           ) / 6.0 },
@@ -169,6 +231,8 @@ double BicubicFilter::operator()(double x) const
 		return 0.0;
 }
 
+std::string BicubicFilter::cache_key() const { return make_key("bicubic", { p0, p2, p3, q0, q1, q2, q3 }); }
+
 
 unsigned Spline16Filter::support() const { return 2; }
 
@@ -186,6 +250,8 @@ double Spline16Filter::operator()(double x) const
 	}
 }
 
+std::string Spline16Filter::cache_key() const { return make_key("spline16"); }
+
 
 unsigned Spline36Filter::support() const { return 3; }
 
@@ -206,6 +272,8 @@ double Spline36Filter::operator()(double x) const
 	}
 }
 
+std::string Spline36Filter::cache_key() const { return make_key("spline36"); }
+
 
 unsigned Spline64Filter::support() const { return 4; }
 
@@ -229,6 +297,8 @@ double Spline64Filter::operator()(double x) const
 	}
 }
 
+std::string Spline64Filter::cache_key() const { return make_key("spline64"); }
+
 
 LanczosFilter::LanczosFilter(unsigned taps) : taps{ taps }
 {
@@ -244,6 +314,8 @@ double LanczosFilter::operator()(double x) const
 	return x < taps ? sinc(x) * sinc(x / taps) : 0.0;
 }
 
+std::string LanczosFilter::cache_key() const { return make_key("lanczos", { static_cast<double>(taps) }); }
+
 
 FilterContext compute_filter(const Filter &f, unsigned src_dim, unsigned dst_dim, double shift, double width)
 {
@@ -255,53 +327,176 @@ FilterContext compute_filter(const Filter &f, unsigned src_dim, unsigned dst_dim
 	if (support > static_cast<unsigned>(UINT_MAX / 2))
 		error::throw_<error::ResamplingNotAvailable>("filter width too great");
 
+	// Position of output sample on input grid.
+	auto output_pos = [=](unsigned i) { return (i + 0.5) / scale + shift; };
+	auto begin_pos = [=](double pos) { return round_halfup(pos - filter_size / 2.0) + 0.5; };
+
+	auto input_index = [=](double xpos)
+	{
+		double real_pos;
+
+		// Mirror the position if it goes beyond image bounds.
+		if (xpos < 0.0)
+			real_pos = -xpos;
+		else if (xpos >= src_dim)
+			real_pos = 2.0 * src_dim - xpos;
+		else
+			real_pos = xpos;
+
+		// Clamp the position if it is still out of bounds.
+		real_pos = std::min(std::max(real_pos, 0.0), std::nextafter(src_dim, -INFINITY));
+
+		return static_cast<unsigned>(std::floor(real_pos));
+	};
+
+	FilterContext e{};
+	std::vector<double> taps;
+	std::vector<double> coeffs;
+
 	try {
-		RowMatrix<double> m{ dst_dim, src_dim };
+		if (filter_size > SIZE_MAX / dst_dim)
+			error::throw_<error::OutOfMemory>();
 
-		for (unsigned i = 0; i < dst_dim; ++i) {
-			// Position of output sample on input grid.
-			double pos = (i + 0.5) / scale + shift;
-			double begin_pos = round_halfup(pos - filter_size / 2.0) + 0.5;
+		e.filter_rows = dst_dim;
+		e.input_width = src_dim;
+		e.left.resize(dst_dim);
+		taps.resize(static_cast<size_t>(filter_size) * dst_dim);
+
+		// Evaluate the filter once per tap. The width of the stored filter is the
+		// widest range of input pixels, from the first tap to the last non-zero
+		// one, read by any row.
+		unsigned filter_width = 0;
 
+		for (unsigned i = 0; i < dst_dim; ++i) {
+			double *row_taps = taps.data() + static_cast<size_t>(i) * filter_size;
+			double pos = output_pos(i);
+			double xpos = begin_pos(pos);
 			double total = 0.0;
+
 			for (unsigned j = 0; j < filter_size; ++j) {
-				double xpos = begin_pos + j;
-				total += f((xpos - pos) * step);
+				row_taps[j] = f((xpos + j - pos) * step);
+				total += row_taps[j];
 			}
 
-			size_t left = SIZE_MAX;
+			unsigned left = UINT_MAX;
+			unsigned right = 0;
 
 			for (unsigned j = 0; j < filter_size; ++j) {
-				double xpos = begin_pos + j;
-				double real_pos;
-
-				// Mirror the position if it goes beyond image bounds.
-				if (xpos < 0.0)
-					real_pos = -xpos;
-				else if (xpos >= src_dim)
-					real_pos = 2.0 * src_dim - xpos;
-				else
-					real_pos = xpos;
-
-				// Clamp the position if it is still out of bounds.
-				real_pos = std::min(std::max(real_pos, 0.0), std::nextafter(src_dim, -INFINITY));
-
-				size_t idx = static_cast<size_t>(std::floor(real_pos));
-				m[i][idx] += f((xpos - pos) * step) / total;
+				unsigned idx = input_index(xpos + j);
+
+				row_taps[j] /= total;
 				left = std::min(left, idx);
+				right = row_taps[j] ? std::max(right, idx + 1) : right;
 			}
 
-			// Force allocating an entry to keep the left offset table sorted.
-			if (m[i][left] == 0.0) {
-				m[i][left] = DBL_EPSILON;
-				m[i][left] = 0.0;
-			}
+			e.left[i] = left;
+			filter_width = std::max(filter_width, std::max(right, left + 1) - left);
 		}
 
-		return matrix_to_filter(m);
+		if (filter_width > floor_n(UINT_MAX, AlignmentOf<uint16_t>))
+			error::throw_<error::OutOfMemory>();
+		if (filter_width > floor_n(UINT_MAX, AlignmentOf<float>))
+			error::throw_<error::OutOfMemory>();
+
+		e.filter_width = filter_width;
+		e.stride = static_cast<unsigned>(ceil_n(filter_width, AlignmentOf<float>));
+		e.stride_i16 = static_cast<unsigned>(ceil_n(filter_width, AlignmentOf<uint16_t>));
+
+		if (e.filter_rows > UINT_MAX / e.stride || e.filter_rows > UINT_MAX / e.stride_i16)
+			error::throw_<error::OutOfMemory>();
+
+		e.data.resize(static_cast<size_t>(e.stride) * e.filter_rows);
+		e.data_i16.resize(static_cast<size_t>(e.stride_i16) * e.filter_rows);
+		coeffs.resize(filter_width);
 	} catch (const std::length_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
+
+	for (unsigned i = 0; i < dst_dim; ++i) {
+		const double *row_taps = taps.data() + static_cast<size_t>(i) * filter_size;
+		double xpos = begin_pos(output_pos(i));
+
+		// The filter is never wider than the image, so the row can be moved inside it.
+		unsigned left = std::min(e.left[i], src_dim - e.filter_width);
+		std::fill(coeffs.begin(), coeffs.end(), 0.0);
+
+		for (unsigned j = 0; j < filter_size; ++j) {
+			unsigned idx = input_index(xpos + j);
+
+			if (idx - left < e.filter_width)
+				coeffs[idx - left] += row_taps[j];
+		}
+
+		quantize_row(coeffs.data(), e.filter_width, e.data.data() + static_cast<size_t>(i) * e.stride, e.data_i16.data() + static_cast<size_t>(i) * e.stride_i16);
+		e.left[i] = left;
+	}
+
+	return e;
+}
+
+FilterContext make_polyphase_filter(FilterContext filter)
+{
+	if (!filter.phase.empty())
+		return filter;
+
+	// Only convert filters where it at least halves the coefficient storage.
+	size_t max_phases = filter.filter_rows / 2;
+
+	std::unordered_map<std::string, unsigned> phase_map;
+	AlignedVector<unsigned> phase(filter.filter_rows);
+
+	for (unsigned i = 0; i < filter.filter_rows; ++i) {
+		std::string key{ reinterpret_cast<const char *>(filter.row(i)), filter.filter_width * sizeof(float) };
+		key.append(reinterpret_cast<const char *>(filter.row_i16(i)), filter.filter_width * sizeof(int16_t));
+
+		unsigned idx = static_cast<unsigned>(phase_map.size());
+		phase[i] = phase_map.emplace(std::move(key), idx).first->second;
+
+		if (phase_map.size() > max_phases)
+			return filter;
+	}
+
+	AlignedVector<float> data(static_cast<size_t>(filter.stride) * phase_map.size());
+	AlignedVector<int16_t> data_i16(static_cast<size_t>(filter.stride_i16) * phase_map.size());
+
+	for (unsigned i = 0; i < filter.filter_rows; ++i) {
+		std::copy_n(filter.row(i), filter.stride, data.data() + static_cast<size_t>(phase[i]) * filter.stride);
+		std::copy_n(filter.row_i16(i), filter.stride_i16, data_i16.data() + static_cast<size_t>(phase[i]) * filter.stride_i16);
+	}
+
+	filter.data = std::move(data);
+	filter.data_i16 = std::move(data_i16);
+	filter.phase = std::move(phase);
+	return filter;
+}
+
+std::shared_ptr<const FilterContext> compute_filter_shared(const Filter &f, unsigned src_dim, unsigned dst_dim, double shift, double width, bool polyphase)
+{
+	auto compute = [&]()
+	{
+		FilterContext filter = compute_filter(f, src_dim, dst_dim, shift, width);
+		return std::make_shared<FilterContext>(polyphase ? make_polyphase_filter(std::move(filter)) : std::move(filter));
+	};
+
+	try {
+		std::string key = f.cache_key();
+		if (key.empty())
+			return compute();
+
+		append_key(key, src_dim);
+		append_key(key, dst_dim);
+		append_key(key, shift == 0.0 ? 0.0 : shift);
+		append_key(key, width);
+		append_key(key, polyphase);
+
+		FilterContextStore &store = filter_context_store();
+		if (std::shared_ptr<const FilterContext> filter = store.find(key))
+			return filter;
+
+		return store.insert(key, compute());
+	} catch (const std::bad_alloc &) {
+		error::throw_<error::OutOfMemory>();
+	}
 }
 
 } // namespace resize
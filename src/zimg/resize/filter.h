@@ -4,6 +4,8 @@
 #define ZIMG_RESIZE_FILTER_H_
 
 #include <cstddef>
+#include <memory>
+#include <string>
 #include "common/alloc.h"
 
 namespace zimg {
@@ -29,6 +31,14 @@ public:
 	 * @return filter coefficient at position
 	 */
 	virtual double operator()(double x) const = 0;
+
+	/**
+	 * Identify the filter for sharing computed coefficients. Filters with
+	 * equal non-empty keys must evaluate identically.
+	 *
+	 * @return key, or empty string if the filter can not be shared
+	 */
+	virtual std::string cache_key() const;
 };
 
 /**
@@ -39,6 +49,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -49,6 +61,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -74,6 +88,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -84,6 +100,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -94,6 +112,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -104,6 +124,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -125,6 +147,8 @@ public:
 	unsigned support() const override;
 
 	double operator()(double x) const override;
+
+	std::string cache_key() const override;
 };
 
 /**
@@ -162,6 +186,21 @@ struct FilterContext {
 	 * Indices of leftmost non-zero coefficients.
 	 */
 	AlignedVector<unsigned> left;
+
+	/**
+	 * Coefficient row used by each filter row, if the filter is stored in
+	 * polyphase form. Empty if each filter row has its own coefficients.
+	 */
+	AlignedVector<unsigned> phase;
+
+	/**
+	 * Get the coefficients of a filter row in either storage format.
+	 *
+	 * @param i filter row
+	 * @return pointer to filter coefficients
+	 */
+	const float *row(unsigned i) const { return data.data() + static_cast<size_t>(phase.empty() ? i : phase[i]) * stride; }
+	const int16_t *row_i16(unsigned i) const { return data_i16.data() + static_cast<size_t>(phase.empty() ? i : phase[i]) * stride_i16; }
 };
 
 /**
@@ -177,6 +216,32 @@ struct FilterContext {
  */
 FilterContext compute_filter(const Filter &f, unsigned src_dim, unsigned dst_dim, double shift, double width);
 
+/**
+ * Store each distinct coefficient row of a filter once.
+ *
+ * Rational scale factors repeat the same few rows across the whole filter,
+ * with only the left offset advancing. Such filters are converted to the
+ * polyphase form described by {@link FilterContext::phase}. Other filters
+ * are returned unchanged.
+ *
+ * @param filter filter in dense form
+ * @return filter in polyphase or dense form
+ */
+FilterContext make_polyphase_filter(FilterContext filter);
+
+/**
+ * Get a shared, immutable instance of the filter returned by {@link compute_filter}.
+ *
+ * Requests with equal parameters return the same object as long as a
+ * reference to it is alive. The most recently used filters are also retained
+ * after their last reference is released. Filters without a cache key are
+ * never shared.
+ *
+ * @param polyphase allow the polyphase form, see {@link make_polyphase_filter}
+ * @see compute_filter
+ */
+std::shared_ptr<const FilterContext> compute_filter_shared(const Filter &f, unsigned src_dim, unsigned dst_dim, double shift, double width, bool polyphase = false);
+
 } // namespace resize
 } // namespace zimg
 
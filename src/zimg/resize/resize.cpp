@@ -21,6 +21,17 @@ bool resize_h_first(double xscale, double yscale) noexcept
 } // namespace
 
 
+bool byte_resize_supported() noexcept
+{
+#ifdef ZIMG_ARM
+	// No NEON kernels for BYTE. The WORD path is faster there.
+	return false;
+#else
+	return true;
+#endif
+}
+
+
 ResizeConversion::ResizeConversion(unsigned src_width, unsigned src_height, PixelType type) :
 	src_width{ src_width },
 	src_height{ src_height },
@@ -68,6 +79,11 @@ auto ResizeConversion::create() const -> filter_pair try
 	} else {
 		bool h_first = resize_h_first(static_cast<double>(dst_width) / subwidth, static_cast<double>(dst_height) / subheight);
 
+		// Keep 8-bit images in BYTE by passing a 16-bit intermediate between the passes.
+		bool byte_intermediate = type == PixelType::BYTE && depth == 8 && byte_resize_supported();
+		if (byte_intermediate)
+			builder.set_dst_type(PixelType::WORD);
+
 		if (h_first) {
 			ret.first = builder.set_horizontal(true)
 			                   .set_dst_dim(dst_width)
@@ -76,6 +92,11 @@ auto ResizeConversion::create() const -> filter_pair try
 			                   .create();
 
 			builder.src_width = dst_width;
+			if (byte_intermediate) {
+				builder.type = PixelType::WORD;
+				builder.set_depth(16)
+				       .set_dst_type(PixelType::BYTE);
+			}
 			ret.second = builder.set_horizontal(false)
 			                    .set_dst_dim(dst_height)
 			                    .set_shift(shift_h)
@@ -89,6 +110,11 @@ auto ResizeConversion::create() const -> filter_pair try
 			                   .create();
 
 			builder.src_height = dst_height;
+			if (byte_intermediate) {
+				builder.type = PixelType::WORD;
+				builder.set_depth(16)
+				       .set_dst_type(PixelType::BYTE);
+			}
 			ret.second = builder.set_horizontal(true)
 			                    .set_dst_dim(dst_width)
 			                    .set_shift(shift_w)
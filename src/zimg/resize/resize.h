@@ -44,6 +44,10 @@ struct ResizeConversion {
 	filter_pair create() const;
 };
 
+// Whether 8-bit resizes can stay in BYTE. Two-pass resizes use a 16-bit
+// intermediate between the passes.
+bool byte_resize_supported() noexcept;
+
 } // namespace resize
 } // namespace zimg
 
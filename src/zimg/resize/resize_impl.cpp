@@ -42,6 +42,53 @@ uint16_t pack_pixel_u16(int32_t x, int32_t pixel_max) noexcept
 	return static_cast<uint16_t>(x);
 }
 
+uint8_t pack_pixel_u8(int32_t x, int32_t pixel_max) noexcept
+{
+	x = (x + (1 << 13)) >> 14;
+	x = std::max(std::min(x, pixel_max), static_cast<int32_t>(0));
+
+	return static_cast<uint8_t>(x);
+}
+
+// Mixed-format passes keep 8-bit samples in a 16-bit intermediate scaled by 256.
+int32_t unpack_pixel_mixed(uint8_t x) noexcept
+{
+	return unpack_pixel_u16(static_cast<uint16_t>(x << 8));
+}
+
+int32_t unpack_pixel_mixed(uint16_t x) noexcept
+{
+	return unpack_pixel_u16(x);
+}
+
+void pack_pixel_mixed(int32_t x, uint8_t &dst) noexcept
+{
+	unsigned y = pack_pixel_u16(x, UINT16_MAX);
+	dst = static_cast<uint8_t>(std::min((y + 128) >> 8, 255U));
+}
+
+void pack_pixel_mixed(int32_t x, uint16_t &dst) noexcept
+{
+	dst = pack_pixel_u16(x, UINT16_MAX);
+}
+
+void resize_line_h_u8_c(const FilterContext &filter, const uint8_t *src, uint8_t *dst, unsigned left, unsigned right, unsigned pixel_max)
+{
+	for (unsigned j = left; j < right; ++j) {
+		unsigned left = filter.left[j];
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			int32_t coeff = filter.data_i16[j * filter.stride_i16 + k];
+			int32_t x = src[left + k];
+
+			accum += coeff * x;
+		}
+
+		dst[j] = pack_pixel_u8(accum, pixel_max);
+	}
+}
+
 void resize_line_h_u16_c(const FilterContext &filter, const uint16_t *src, uint16_t *dst, unsigned left, unsigned right, unsigned pixel_max)
 {
 	for (unsigned j = left; j < right; ++j) {
@@ -59,6 +106,24 @@ void resize_line_h_u16_c(const FilterContext &filter, const uint16_t *src, uint1
 	}
 }
 
+template <class T, class U>
+void resize_line_h_mixed_c(const FilterContext &filter, const T *src, U *dst, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; ++j) {
+		unsigned left = filter.left[j];
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			int32_t coeff = filter.data_i16[j * filter.stride_i16 + k];
+			int32_t x = unpack_pixel_mixed(src[left + k]);
+
+			accum += coeff * x;
+		}
+
+		pack_pixel_mixed(accum, dst[j]);
+	}
+}
+
 void resize_line_h_f32_c(const FilterContext &filter, const float *src, float *dst, unsigned left, unsigned right)
 {
 	for (unsigned j = left; j < right; ++j) {
@@ -76,9 +141,28 @@ void resize_line_h_f32_c(const FilterContext &filter, const float *src, float *d
 	}
 }
 
+void resize_line_v_u8_c(const FilterContext &filter, const Buffer<const uint8_t> &src, const Buffer<uint8_t> &dst, unsigned i, unsigned left, unsigned right, unsigned pixel_max)
+{
+	const int16_t *filter_coeffs = filter.row_i16(i);
+	unsigned top = filter.left[i];
+
+	for (unsigned j = left; j < right; ++j) {
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			int32_t coeff = filter_coeffs[k];
+			int32_t x = src[top + k][j];
+
+			accum += coeff * x;
+		}
+
+		dst[i][j] = pack_pixel_u8(accum, pixel_max);
+	}
+}
+
 void resize_line_v_u16_c(const FilterContext &filter, const Buffer<const uint16_t> &src, const Buffer<uint16_t> &dst, unsigned i, unsigned left, unsigned right, unsigned pixel_max)
 {
-	const int16_t *filter_coeffs = &filter.data_i16[i * filter.stride_i16];
+	const int16_t *filter_coeffs = filter.row_i16(i);
 	unsigned top = filter.left[i];
 
 	for (unsigned j = left; j < right; ++j) {
@@ -95,9 +179,29 @@ void resize_line_v_u16_c(const FilterContext &filter, const Buffer<const uint16_
 	}
 }
 
+template <class T, class U>
+void resize_line_v_mixed_c(const FilterContext &filter, const Buffer<const T> &src, const Buffer<U> &dst, unsigned i, unsigned left, unsigned right)
+{
+	const int16_t *filter_coeffs = filter.row_i16(i);
+	unsigned top = filter.left[i];
+
+	for (unsigned j = left; j < right; ++j) {
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			int32_t coeff = filter_coeffs[k];
+			int32_t x = unpack_pixel_mixed(src[top + k][j]);
+
+			accum += coeff * x;
+		}
+
+		pack_pixel_mixed(accum, dst[i][j]);
+	}
+}
+
 void resize_line_v_f32_c(const FilterContext &filter, const Buffer<const float> &src, const Buffer<float> &dst, unsigned i, unsigned left, unsigned right)
 {
-	const float *filter_coeffs = &filter.data[i * filter.stride];
+	const float *filter_coeffs = filter.row(i);
 	unsigned top = filter.left[i];
 
 	for (unsigned j = left; j < right; ++j) {
@@ -119,19 +223,21 @@ class ResizeImplH_C : public ResizeImplH {
 	PixelType m_type;
 	uint32_t m_pixel_max;
 public:
-	ResizeImplH_C(const FilterContext &filter, unsigned height, PixelType type, unsigned depth) :
+	ResizeImplH_C(const std::shared_ptr<const FilterContext> &filter, unsigned height, PixelType type, unsigned depth) :
 		ResizeImplH(filter, height, type),
 		m_type{ type },
 		m_pixel_max{ static_cast<uint32_t>(1UL << depth) - 1 }
 	{
-		if (m_type != PixelType::WORD && m_type != PixelType::FLOAT)
+		if (m_type != PixelType::BYTE && m_type != PixelType::WORD && m_type != PixelType::FLOAT)
 			error::throw_<error::InternalError>("pixel type not supported");
 	}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		if (m_type == PixelType::WORD)
+		if (m_type == PixelType::BYTE)
+			resize_line_h_u8_c(m_filter, in->get_line<uint8_t>(i), out->get_line<uint8_t>(i), left, right, m_pixel_max);
+		else if (m_type == PixelType::WORD)
 			resize_line_h_u16_c(m_filter, in->get_line<uint16_t>(i), out->get_line<uint16_t>(i), left, right, m_pixel_max);
 		else
 			resize_line_h_f32_c(m_filter, in->get_line<float>(i), out->get_line<float>(i), left, right);
@@ -142,33 +248,86 @@ class ResizeImplV_C : public ResizeImplV {
 	PixelType m_type;
 	uint32_t m_pixel_max;
 public:
-	ResizeImplV_C(const FilterContext &filter, unsigned width, PixelType type, unsigned depth) :
+	ResizeImplV_C(const std::shared_ptr<const FilterContext> &filter, unsigned width, PixelType type, unsigned depth) :
 		ResizeImplV(filter, width, type),
 		m_type{ type },
 		m_pixel_max{ static_cast<uint32_t>(1UL << depth) - 1 }
 	{
-		if (m_type != PixelType::WORD && m_type != PixelType::FLOAT)
+		if (m_type != PixelType::BYTE && m_type != PixelType::WORD && m_type != PixelType::FLOAT)
 			error::throw_<error::InternalError>("pixel type not supported");
 	}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		if (m_type == PixelType::WORD)
+		if (m_type == PixelType::BYTE)
+			resize_line_v_u8_c(m_filter, *in, *out, i, left, right, m_pixel_max);
+		else if (m_type == PixelType::WORD)
 			resize_line_v_u16_c(m_filter, *in, *out, i, left, right, m_pixel_max);
 		else
 			resize_line_v_f32_c(m_filter, *in, *out, i, left, right);
 	}
 };
 
+template <class T, class U>
+class ResizeImplH_Mixed_C : public ResizeImplH {
+public:
+	ResizeImplH_Mixed_C(const std::shared_ptr<const FilterContext> &filter, unsigned height, PixelType dst_type) :
+		ResizeImplH(filter, height, dst_type)
+	{}
+
+	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
+	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
+	{
+		resize_line_h_mixed_c(m_filter, in->get_line<T>(i), out->get_line<U>(i), left, right);
+	}
+};
+
+template <class T, class U>
+class ResizeImplV_Mixed_C : public ResizeImplV {
+public:
+	ResizeImplV_Mixed_C(const std::shared_ptr<const FilterContext> &filter, unsigned width, PixelType dst_type) :
+		ResizeImplV(filter, width, dst_type)
+	{}
+
+	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
+	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
+	{
+		resize_line_v_mixed_c<T, U>(m_filter, *in, *out, i, left, right);
+	}
+};
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_mixed_c(const std::shared_ptr<const FilterContext> &filter, bool horizontal, unsigned dim, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD) {
+		if (horizontal)
+			ret = std::make_unique<ResizeImplH_Mixed_C<uint8_t, uint16_t>>(filter, dim, dst_type);
+		else
+			ret = std::make_unique<ResizeImplV_Mixed_C<uint8_t, uint16_t>>(filter, dim, dst_type);
+	} else if (type == PixelType::WORD && dst_type == PixelType::BYTE) {
+		if (horizontal)
+			ret = std::make_unique<ResizeImplH_Mixed_C<uint16_t, uint8_t>>(filter, dim, dst_type);
+		else
+			ret = std::make_unique<ResizeImplV_Mixed_C<uint16_t, uint8_t>>(filter, dim, dst_type);
+	} else {
+		error::throw_<error::InternalError>("pixel type not supported");
+	}
+
+	return ret;
+}
+
 } // namespace
 
 
-ResizeImplH::ResizeImplH(const FilterContext &filter, unsigned height, PixelType type) :
-	m_filter(filter)
+ResizeImplH::ResizeImplH(std::shared_ptr<const FilterContext> filter, unsigned height, PixelType type) :
+	m_filter_storage{ std::move(filter) },
+	m_filter(*m_filter_storage)
 {
 	zassert_d(m_filter.input_width <= pixel_max_width(type), "overflow");
 	zassert_d(m_filter.filter_rows <= pixel_max_width(type), "overflow");
+	zassert_d(m_filter.phase.empty(), "polyphase filter not supported");
 
 	m_desc.format = { m_filter.filter_rows, height, pixel_size(type) };
 	m_desc.num_deps = 1;
@@ -196,13 +355,14 @@ auto ResizeImplH::get_col_deps(unsigned left, unsigned right) const noexcept ->
 }
 
 
-ResizeImplV::ResizeImplV(const FilterContext &filter, unsigned width, PixelType type) :
-	m_filter(filter),
+ResizeImplV::ResizeImplV(std::shared_ptr<const FilterContext> filter, unsigned width, PixelType type) :
+	m_filter_storage{ std::move(filter) },
+	m_filter(*m_filter_storage),
 	m_unsorted{}
 {
 	zassert_d(width <= pixel_max_width(type), "overflow");
 
-	m_desc.format = { width, filter.filter_rows, pixel_size(type) };
+	m_desc.format = { width, m_filter.filter_rows, pixel_size(type) };
 	m_desc.num_deps = 1;
 	m_desc.num_planes = 1;
 	m_desc.step = 1;
@@ -230,10 +390,56 @@ auto ResizeImplV::get_col_deps(unsigned left, unsigned right) const noexcept ->
 }
 
 
+FilterDecimation find_filter_decimation(const FilterContext &filter)
+{
+	if (filter.filter_rows < 2)
+		return{};
+
+	// Take the coefficients from the middle of the row, which is furthest from the edges.
+	unsigned mid = filter.filter_rows / 2 - 1;
+
+	// Only 2x reductions have a decimating kernel.
+	if (filter.left[mid + 1] != filter.left[mid] + 2)
+		return{};
+
+	FilterDecimation ret{};
+	ret.offset = static_cast<int>(filter.left[mid]) - static_cast<int>(mid * 2);
+
+	const float *coeffs = filter.row(mid);
+	const int16_t *coeffs_i16 = filter.row_i16(mid);
+
+	auto is_decimated = [&](unsigned j)
+	{
+		if (static_cast<int>(filter.left[j]) != static_cast<int>(j * 2) + ret.offset)
+			return false;
+		if (!std::equal(coeffs, coeffs + filter.filter_width, filter.row(j)))
+			return false;
+		return std::equal(coeffs_i16, coeffs_i16 + filter.filter_width, filter.row_i16(j));
+	};
+
+	ret.left = mid;
+	ret.right = mid;
+
+	while (ret.left > 0 && is_decimated(ret.left - 1)) {
+		--ret.left;
+	}
+	while (ret.right < filter.filter_rows && is_decimated(ret.right)) {
+		++ret.right;
+	}
+
+	// Non-integer ratios can match a few columns by coincidence.
+	if ((ret.right - ret.left) * 2 < filter.filter_rows)
+		return{};
+
+	return ret;
+}
+
+
 ResizeImplBuilder::ResizeImplBuilder(unsigned src_width, unsigned src_height, PixelType type) :
 	src_width{ src_width },
 	src_height{ src_height },
 	type{ type },
+	dst_type{ type },
 	horizontal{},
 	dst_dim{},
 	depth{},
@@ -248,7 +454,19 @@ std::unique_ptr<graphengine::Filter> ResizeImplBuilder::create() const
 	std::unique_ptr<graphengine::Filter> ret;
 
 	unsigned src_dim = horizontal ? src_width : src_height;
-	FilterContext filter_ctx = compute_filter(*filter, src_dim, dst_dim, shift, subwidth);
+	std::shared_ptr<const FilterContext> filter_ctx = compute_filter_shared(*filter, src_dim, dst_dim, shift, subwidth, !horizontal);
+
+	if (dst_type != type) {
+#if defined(ZIMG_X86)
+		ret = horizontal ?
+			create_resize_impl_h_mixed_x86(filter_ctx, src_height, type, dst_type, cpu) :
+			create_resize_impl_v_mixed_x86(filter_ctx, src_width, type, dst_type, cpu);
+#endif
+		if (!ret)
+			ret = create_resize_impl_mixed_c(filter_ctx, horizontal, horizontal ? src_height : src_width, type, dst_type);
+
+		return ret;
+	}
 
 #if defined(ZIMG_X86)
 	ret = horizontal ?
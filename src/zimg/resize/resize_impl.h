@@ -17,9 +17,10 @@ namespace resize {
 
 class ResizeImplH : public graph::FilterBase {
 protected:
-	FilterContext m_filter;
+	std::shared_ptr<const FilterContext> m_filter_storage;
+	const FilterContext &m_filter;
 
-	ResizeImplH(const FilterContext &filter, unsigned height, PixelType type);
+	ResizeImplH(std::shared_ptr<const FilterContext> filter, unsigned height, PixelType type);
 public:
 	pair_unsigned get_row_deps(unsigned i) const noexcept override;
 
@@ -30,10 +31,11 @@ public:
 
 class ResizeImplV : public graph::FilterBase {
 protected:
-	FilterContext m_filter;
+	std::shared_ptr<const FilterContext> m_filter_storage;
+	const FilterContext &m_filter;
 	bool m_unsorted;
 
-	ResizeImplV(const FilterContext &filter, unsigned width, PixelType type);
+	ResizeImplV(std::shared_ptr<const FilterContext> filter, unsigned width, PixelType type);
 public:
 	pair_unsigned get_row_deps(unsigned i) const noexcept override;
 
@@ -42,12 +44,35 @@ public:
 	void init_context(void *) const noexcept override {}
 };
 
+/**
+ * Span of a horizontal filter that reduces by exactly 2x.
+ *
+ * Output column j in [left, right) reads input columns starting at
+ * 2 * j + offset, with the coefficients of column left.
+ */
+struct FilterDecimation {
+	unsigned left;
+	unsigned right;
+	int offset;
+};
+
+/**
+ * Find the span of a filter that reduces by a factor of 2 with constant
+ * coefficients.
+ *
+ * @param filter filter
+ * @return span, empty if none was found
+ */
+FilterDecimation find_filter_decimation(const FilterContext &filter);
+
 struct ResizeImplBuilder {
 	unsigned src_width;
 	unsigned src_height;
 	PixelType type;
 
 #include "common/builder.h"
+	// BYTE to WORD or WORD to BYTE for passes around a 16-bit intermediate.
+	BUILDER_MEMBER(PixelType, dst_type)
 	BUILDER_MEMBER(bool, horizontal)
 	BUILDER_MEMBER(unsigned, dst_dim)
 	BUILDER_MEMBER(unsigned, depth)
@@ -0,0 +1,375 @@
+#ifdef ZIMG_X86
+
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+#include "common/align.h"
+#include "common/ccdep.h"
+#include "common/pixel.h"
+#include "graphengine/types.h"
+#include "resize/filter.h"
+#include "chroma_upsample_x86.h"
+
+namespace zimg {
+namespace resize {
+
+namespace {
+
+template <unsigned Taps>
+inline FORCE_INLINE __m256 dot_avx2(const __m256 c[Taps], const float *src)
+{
+	__m256 accum = _mm256_mul_ps(c[0], _mm256_loadu_ps(src));
+
+	for (unsigned k = 1; k < Taps; ++k) {
+		accum = _mm256_fmadd_ps(c[k], _mm256_loadu_ps(src + k), accum);
+	}
+	return accum;
+}
+
+template <unsigned Taps>
+void upsample_line_v_avx2(const FilterContext &filter, const graphengine::BufferDescriptor &src, void *dst, unsigned i, unsigned left, unsigned right, unsigned)
+{
+	const float *src_p[Taps];
+	float *dst_p = static_cast<float *>(dst);
+	__m256 c[Taps];
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		src_p[k] = src.get_line<const float>(filter.left[i] + k);
+		c[k] = _mm256_set1_ps(filter.row(i)[k]);
+	}
+
+	for (unsigned j = floor_n(left, 8); j < right; j += 8) {
+		__m256 accum = _mm256_mul_ps(c[0], _mm256_load_ps(src_p[0] + j));
+
+		for (unsigned k = 1; k < Taps; ++k) {
+			accum = _mm256_fmadd_ps(c[k], _mm256_load_ps(src_p[k] + j), accum);
+		}
+
+		if (j >= left && j + 8 <= right) {
+			_mm256_store_ps(dst_p + j, accum);
+		} else {
+			alignas(32) float tmp[8];
+			_mm256_store_ps(tmp, accum);
+
+			for (unsigned n = std::max(left, j); n < std::min(right, j + 8); ++n) {
+				dst_p[n] = tmp[n - j];
+			}
+		}
+	}
+}
+
+template <unsigned Taps>
+void upsample_line_h_avx2(const FilterContext &filter, const ChromaUpsamplePhases &phases, const void *src, void *dst, unsigned left, unsigned right, unsigned)
+{
+	const float *src_p = static_cast<const float *>(src);
+	float *dst_p = static_cast<float *>(dst);
+
+	auto filter_column = [&](unsigned j)
+	{
+		const float *coeffs = &filter.data[j * filter.stride];
+		const float *src_col = src_p + filter.left[j];
+		float accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += coeffs[k] * src_col[k];
+		}
+
+		dst_p[j] = accum;
+	};
+
+	unsigned vec_left = std::min(ceil_n(std::max(left, phases.left), 16), right);
+	unsigned vec_right = std::max(floor_n(std::min(right, phases.right), 16), vec_left);
+
+	__m256 c0[Taps];
+	__m256 c1[Taps];
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		c0[k] = _mm256_set1_ps(phases.coeffs[0][k]);
+		c1[k] = _mm256_set1_ps(phases.coeffs[1][k]);
+	}
+
+	for (unsigned j = left; j < vec_left; ++j) {
+		filter_column(j);
+	}
+
+	// Compute 8 even and 8 odd columns from contiguous inputs, then interleave.
+	for (unsigned j = vec_left; j < vec_right; j += 16) {
+		__m256 even = dot_avx2<Taps>(c0, src_p + (phases.offset[0] + static_cast<int>(j / 2)));
+		__m256 odd = dot_avx2<Taps>(c1, src_p + (phases.offset[1] + static_cast<int>(j / 2)));
+
+		__m256 lo = _mm256_unpacklo_ps(even, odd);
+		__m256 hi = _mm256_unpackhi_ps(even, odd);
+
+		_mm256_store_ps(dst_p + j + 0, _mm256_permute2f128_ps(lo, hi, 0x20));
+		_mm256_store_ps(dst_p + j + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+	}
+
+	for (unsigned j = vec_right; j < right; ++j) {
+		filter_column(j);
+	}
+}
+
+
+// Integer samples are processed as signed 16-bit with 32-bit sums of pairs of
+// taps, and follow the rounding of the C kernels.
+inline FORCE_INLINE __m256i round_pack_i32(__m256i lo, __m256i hi)
+{
+	const __m256i round = _mm256_set1_epi32(1 << 13);
+
+	lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), 14);
+	hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), 14);
+	return _mm256_packs_epi32(lo, hi);
+}
+
+inline FORCE_INLINE __m256i load_u8_i16(const uint8_t *src)
+{
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+}
+
+inline FORCE_INLINE __m256i load_u16_i16(const uint16_t *src)
+{
+	return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src)), _mm256_set1_epi16(INT16_MIN));
+}
+
+inline FORCE_INLINE __m256i pack_u16_i16(__m256i lo, __m256i hi, __m256i pixel_max)
+{
+	__m256i x = _mm256_xor_si256(round_pack_i32(lo, hi), _mm256_set1_epi16(INT16_MIN));
+	return _mm256_min_epu16(x, pixel_max);
+}
+
+inline FORCE_INLINE void store_u8_i16(uint8_t *dst, __m256i x)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+inline FORCE_INLINE void store_u16_i16(uint16_t *dst, __m256i x)
+{
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), x);
+}
+
+struct PixelU8 {
+	typedef uint8_t src_type;
+	typedef uint8_t dst_type;
+
+	static int32_t unpack(uint8_t x) { return x; }
+
+	static void pack(int32_t x, int32_t pixel_max, uint8_t &dst)
+	{
+		x = (x + (1 << 13)) >> 14;
+		dst = static_cast<uint8_t>(std::max(std::min(x, pixel_max), static_cast<int32_t>(0)));
+	}
+
+	static inline FORCE_INLINE __m256i load(const uint8_t *src) { return load_u8_i16(src); }
+
+	static inline FORCE_INLINE __m256i pack(__m256i lo, __m256i hi, __m256i pixel_max)
+	{
+		__m256i x = round_pack_i32(lo, hi);
+		return _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), pixel_max);
+	}
+
+	static inline FORCE_INLINE void store(uint8_t *dst, __m256i x) { store_u8_i16(dst, x); }
+};
+
+struct PixelU16 {
+	typedef uint16_t src_type;
+	typedef uint16_t dst_type;
+
+	static int32_t unpack(uint16_t x) { return static_cast<int32_t>(x) + INT16_MIN; }
+
+	static void pack(int32_t x, int32_t pixel_max, uint16_t &dst)
+	{
+		x = ((x + (1 << 13)) >> 14) - INT16_MIN;
+		dst = static_cast<uint16_t>(std::max(std::min(x, pixel_max), static_cast<int32_t>(0)));
+	}
+
+	static inline FORCE_INLINE __m256i load(const uint16_t *src) { return load_u16_i16(src); }
+
+	static inline FORCE_INLINE __m256i pack(__m256i lo, __m256i hi, __m256i pixel_max) { return pack_u16_i16(lo, hi, pixel_max); }
+
+	static inline FORCE_INLINE void store(uint16_t *dst, __m256i x) { store_u16_i16(dst, x); }
+};
+
+inline FORCE_INLINE __m256i coeff_pair_i16(int16_t c0, int16_t c1)
+{
+	return _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(c1)) << 16) | static_cast<uint16_t>(c0)));
+}
+
+// Accumulates 16 samples of a pair of taps into two vectors of 32-bit sums.
+inline FORCE_INLINE void madd_pair_i16(__m256i x0, __m256i x1, __m256i c, __m256i &accum_lo, __m256i &accum_hi)
+{
+	accum_lo = _mm256_add_epi32(accum_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(x0, x1), c));
+	accum_hi = _mm256_add_epi32(accum_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(x0, x1), c));
+}
+
+// Computes 16 outputs from the samples of each tap, taken by load(k).
+template <class Traits, unsigned Taps, class F>
+inline FORCE_INLINE __m256i dot_int_avx2(const __m256i c[(Taps + 1) / 2], F load, __m256i pixel_max)
+{
+	__m256i accum_lo = _mm256_setzero_si256();
+	__m256i accum_hi = _mm256_setzero_si256();
+
+	for (unsigned k = 0; k + 1 < Taps; k += 2) {
+		madd_pair_i16(load(k), load(k + 1), c[k / 2], accum_lo, accum_hi);
+	}
+	if (Taps % 2)
+		madd_pair_i16(load(Taps - 1), _mm256_setzero_si256(), c[Taps / 2], accum_lo, accum_hi);
+
+	return Traits::pack(accum_lo, accum_hi, pixel_max);
+}
+
+template <unsigned Taps>
+void load_coeff_pairs(const int16_t *coeffs, __m256i c[(Taps + 1) / 2])
+{
+	for (unsigned k = 0; k < Taps; k += 2) {
+		c[k / 2] = coeff_pair_i16(coeffs[k], k + 1 < Taps ? coeffs[k + 1] : 0);
+	}
+}
+
+template <class Traits, unsigned Taps>
+void upsample_line_v_int_avx2(const FilterContext &filter, const graphengine::BufferDescriptor &src, void *dst, unsigned i, unsigned left, unsigned right, unsigned pixel_max)
+{
+	typedef typename Traits::src_type src_type;
+	typedef typename Traits::dst_type dst_type;
+
+	const src_type *src_p[Taps];
+	dst_type *dst_p = static_cast<dst_type *>(dst);
+	__m256i c[(Taps + 1) / 2];
+
+	for (unsigned k = 0; k < Taps; ++k) {
+		src_p[k] = src.get_line<const src_type>(filter.left[i] + k);
+	}
+	load_coeff_pairs<Taps>(filter.row_i16(i), c);
+
+	const __m256i max = _mm256_set1_epi16(static_cast<int16_t>(pixel_max));
+
+	for (unsigned j = floor_n(left, 16); j < right; j += 16) {
+		__m256i x = dot_int_avx2<Traits, Taps>(c, [&](unsigned k) { return Traits::load(src_p[k] + j); }, max);
+
+		if (j >= left && j + 16 <= right) {
+			Traits::store(dst_p + j, x);
+		} else {
+			dst_type tmp[16];
+			Traits::store(tmp, x);
+
+			for (unsigned n = std::max(left, j); n < std::min(right, j + 16); ++n) {
+				dst_p[n] = tmp[n - j];
+			}
+		}
+	}
+}
+
+template <class Traits, unsigned Taps>
+void upsample_line_h_int_avx2(const FilterContext &filter, const ChromaUpsamplePhases &phases, const void *src, void *dst, unsigned left, unsigned right, unsigned pixel_max)
+{
+	typedef typename Traits::src_type src_type;
+	typedef typename Traits::dst_type dst_type;
+
+	const src_type *src_p = static_cast<const src_type *>(src);
+	dst_type *dst_p = static_cast<dst_type *>(dst);
+
+	auto filter_column = [&](unsigned j)
+	{
+		const int16_t *coeffs = &filter.data_i16[j * filter.stride_i16];
+		const src_type *src_col = src_p + filter.left[j];
+		int32_t accum = 0;
+
+		for (unsigned k = 0; k < Taps; ++k) {
+			accum += coeffs[k] * Traits::unpack(src_col[k]);
+		}
+
+		Traits::pack(accum, pixel_max, dst_p[j]);
+	};
+
+	unsigned vec_left = std::min(ceil_n(std::max(left, phases.left), 32), right);
+	unsigned vec_right = std::max(floor_n(std::min(right, phases.right), 32), vec_left);
+
+	const __m256i max = _mm256_set1_epi16(static_cast<int16_t>(pixel_max));
+	__m256i c0[(Taps + 1) / 2];
+	__m256i c1[(Taps + 1) / 2];
+
+	load_coeff_pairs<Taps>(phases.coeffs_i16[0], c0);
+	load_coeff_pairs<Taps>(phases.coeffs_i16[1], c1);
+
+	for (unsigned j = left; j < vec_left; ++j) {
+		filter_column(j);
+	}
+
+	// Compute 16 even and 16 odd columns from contiguous inputs, then interleave.
+	for (unsigned j = vec_left; j < vec_right; j += 32) {
+		const src_type *src0 = src_p + (phases.offset[0] + static_cast<int>(j / 2));
+		const src_type *src1 = src_p + (phases.offset[1] + static_cast<int>(j / 2));
+
+		__m256i even = dot_int_avx2<Traits, Taps>(c0, [&](unsigned k) { return Traits::load(src0 + k); }, max);
+		__m256i odd = dot_int_avx2<Traits, Taps>(c1, [&](unsigned k) { return Traits::load(src1 + k); }, max);
+
+		__m256i lo = _mm256_unpacklo_epi16(even, odd);
+		__m256i hi = _mm256_unpackhi_epi16(even, odd);
+
+		Traits::store(dst_p + j + 0, _mm256_permute2x128_si256(lo, hi, 0x20));
+		Traits::store(dst_p + j + 16, _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	for (unsigned j = vec_right; j < right; ++j) {
+		filter_column(j);
+	}
+}
+
+template <class Traits>
+chroma_upsample_h_func select_h_int_func(unsigned taps)
+{
+	switch (taps) {
+	case 2: return upsample_line_h_int_avx2<Traits, 2>;
+	case 3: return upsample_line_h_int_avx2<Traits, 3>;
+	case 4: return upsample_line_h_int_avx2<Traits, 4>;
+	default: return nullptr;
+	}
+}
+
+template <class Traits>
+chroma_upsample_v_func select_v_int_func(unsigned taps)
+{
+	switch (taps) {
+	case 2: return upsample_line_v_int_avx2<Traits, 2>;
+	case 3: return upsample_line_v_int_avx2<Traits, 3>;
+	case 4: return upsample_line_v_int_avx2<Traits, 4>;
+	default: return nullptr;
+	}
+}
+
+} // namespace
+
+
+chroma_upsample_h_func select_chroma_upsample_h_func_avx2(unsigned taps, PixelType type)
+{
+	if (type == PixelType::BYTE)
+		return select_h_int_func<PixelU8>(taps);
+	if (type == PixelType::WORD)
+		return select_h_int_func<PixelU16>(taps);
+
+	switch (taps) {
+	case 2: return upsample_line_h_avx2<2>;
+	case 3: return upsample_line_h_avx2<3>;
+	case 4: return upsample_line_h_avx2<4>;
+	default: return nullptr;
+	}
+}
+
+chroma_upsample_v_func select_chroma_upsample_v_func_avx2(unsigned taps, PixelType type)
+{
+	if (type == PixelType::BYTE)
+		return select_v_int_func<PixelU8>(taps);
+	if (type == PixelType::WORD)
+		return select_v_int_func<PixelU16>(taps);
+
+	switch (taps) {
+	case 2: return upsample_line_v_avx2<2>;
+	case 3: return upsample_line_v_avx2<3>;
+	case 4: return upsample_line_v_avx2<4>;
+	default: return nullptr;
+	}
+}
+
+} // namespace resize
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,45 @@
+#ifdef ZIMG_X86
+
+#include "common/cpuinfo.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "chroma_upsample_x86.h"
+
+namespace zimg {
+namespace resize {
+
+chroma_upsample_h_func select_chroma_upsample_h_func_x86(unsigned taps, PixelType type, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	chroma_upsample_h_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+		if (!func && caps.avx2 && caps.fma)
+			func = select_chroma_upsample_h_func_avx2(taps, type);
+	} else {
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_chroma_upsample_h_func_avx2(taps, type);
+	}
+
+	return func;
+}
+
+chroma_upsample_v_func select_chroma_upsample_v_func_x86(unsigned taps, PixelType type, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	chroma_upsample_v_func func = nullptr;
+
+	if (cpu_is_autodetect(cpu)) {
+		if (!func && caps.avx2 && caps.fma)
+			func = select_chroma_upsample_v_func_avx2(taps, type);
+	} else {
+		if (!func && cpu >= CPUClass::X86_AVX2)
+			func = select_chroma_upsample_v_func_avx2(taps, type);
+	}
+
+	return func;
+}
+
+} // namespace resize
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifdef ZIMG_X86
+
+#ifndef ZIMG_RESIZE_X86_CHROMA_UPSAMPLE_X86_H_
+#define ZIMG_RESIZE_X86_CHROMA_UPSAMPLE_X86_H_
+
+#include "resize/chroma_upsample.h"
+
+namespace zimg {
+
+enum class CPUClass;
+enum class PixelType;
+
+namespace resize {
+
+chroma_upsample_h_func select_chroma_upsample_h_func_avx2(unsigned taps, PixelType type);
+chroma_upsample_v_func select_chroma_upsample_v_func_avx2(unsigned taps, PixelType type);
+
+chroma_upsample_h_func select_chroma_upsample_h_func_x86(unsigned taps, PixelType type, CPUClass cpu);
+chroma_upsample_v_func select_chroma_upsample_v_func_x86(unsigned taps, PixelType type, CPUClass cpu);
+
+} // namespace resize
+} // namespace zimg
+
+#endif // ZIMG_RESIZE_X86_CHROMA_UPSAMPLE_X86_H_
+
+#endif // ZIMG_X86
@@ -336,17 +336,17 @@ constexpr auto resize_line_v_f32_avx_jt_cont = make_array(
 class ResizeImplH_F32_AVX : public ResizeImplH {
 	decltype(resize_line8_h_f32_avx_jt_small)::value_type m_func;
 public:
-	ResizeImplH_F32_AVX(const FilterContext &filter, unsigned height) try :
+	ResizeImplH_F32_AVX(const std::shared_ptr<const FilterContext> &filter, unsigned height) try :
 		ResizeImplH(filter, height, PixelType::FLOAT),
 		m_func{}
 	{
 		m_desc.step = 8;
-		m_desc.scratchpad_size = (ceil_n(static_cast<checked_size_t>(filter.input_width), 8) * sizeof(float) * 8).get();
+		m_desc.scratchpad_size = (ceil_n(static_cast<checked_size_t>(filter->input_width), 8) * sizeof(float) * 8).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line8_h_f32_avx_jt_small[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line8_h_f32_avx_jt_small[filter->filter_width - 1];
 		else
-			m_func = resize_line8_h_f32_avx_jt_large[filter.filter_width % 4];
+			m_func = resize_line8_h_f32_avx_jt_large[filter->filter_width % 4];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -389,14 +389,14 @@ public:
 
 class ResizeImplV_F32_AVX : public ResizeImplV {
 public:
-	ResizeImplV_F32_AVX(const FilterContext &filter, unsigned width) :
+	ResizeImplV_F32_AVX(const std::shared_ptr<const FilterContext> &filter, unsigned width) :
 		ResizeImplV(filter, width, zimg::PixelType::FLOAT)
 	{}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		const float *filter_data = m_filter.data.data() + i * m_filter.stride;
+		const float *filter_data = m_filter.row(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -440,7 +440,7 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -450,7 +450,7 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx(const FilterContex
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
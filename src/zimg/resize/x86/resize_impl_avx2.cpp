@@ -128,6 +128,120 @@ struct f32_traits {
 };
 
 
+struct u8_traits {
+	typedef uint8_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::BYTE;
+
+	static inline FORCE_INLINE __m256i load16(const pixel_type *ptr)
+	{
+		return _mm256_cvtepu8_epi16(_mm_load_si128((const __m128i *)ptr));
+	}
+
+	static inline FORCE_INLINE __m128i pack16(__m256i x)
+	{
+		return _mm_packus_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+	}
+
+	static inline FORCE_INLINE void store16(pixel_type *ptr, __m256i x)
+	{
+		_mm_store_si128((__m128i *)ptr, pack16(x));
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		mm_store_idxlo_epi8((__m128i *)ptr, pack16(x), idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		mm_store_idxhi_epi8((__m128i *)ptr, pack16(x), idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		*dst0 = static_cast<uint8_t>(_mm_extract_epi16(x, 0));
+		*dst1 = static_cast<uint8_t>(_mm_extract_epi16(x, 1));
+		*dst2 = static_cast<uint8_t>(_mm_extract_epi16(x, 2));
+		*dst3 = static_cast<uint8_t>(_mm_extract_epi16(x, 3));
+		*dst4 = static_cast<uint8_t>(_mm_extract_epi16(x, 4));
+		*dst5 = static_cast<uint8_t>(_mm_extract_epi16(x, 5));
+		*dst6 = static_cast<uint8_t>(_mm_extract_epi16(x, 6));
+		*dst7 = static_cast<uint8_t>(_mm_extract_epi16(x, 7));
+	}
+};
+
+struct u16_traits {
+	typedef uint16_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::WORD;
+
+	static inline FORCE_INLINE __m256i load16(const pixel_type *ptr)
+	{
+		return _mm256_load_si256((const __m256i *)ptr);
+	}
+
+	static inline FORCE_INLINE void store16(pixel_type *ptr, __m256i x)
+	{
+		_mm256_store_si256((__m256i *)ptr, x);
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		mm256_store_idxlo_epi16((__m256i *)ptr, x, idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		mm256_store_idxhi_epi16((__m256i *)ptr, x, idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		mm_scatter_epi16(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, x);
+	}
+};
+
+// Loads 8-bit samples into the high byte of a 16-bit intermediate.
+struct u8_wide_traits : u8_traits {
+	static inline FORCE_INLINE __m256i load16(const pixel_type *ptr)
+	{
+		return _mm256_slli_epi16(u8_traits::load16(ptr), 8);
+	}
+};
+
+// Rounds a 16-bit intermediate to 8-bit samples.
+struct u8_narrow_traits : u8_traits {
+	static inline FORCE_INLINE __m256i narrow(__m256i x)
+	{
+		return _mm256_srli_epi16(_mm256_adds_epu16(x, _mm256_set1_epi16(128)), 8);
+	}
+
+	static inline FORCE_INLINE void store16(pixel_type *ptr, __m256i x)
+	{
+		u8_traits::store16(ptr, narrow(x));
+	}
+
+	static inline FORCE_INLINE void store16_idxlo(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		u8_traits::store16_idxlo(ptr, narrow(x), idx);
+	}
+
+	static inline FORCE_INLINE void store16_idxhi(pixel_type *ptr, __m256i x, unsigned idx)
+	{
+		u8_traits::store16_idxhi(ptr, narrow(x), idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		x = _mm_srli_epi16(_mm_adds_epu16(x, _mm_set1_epi16(128)), 8);
+		u8_traits::scatter8(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, x);
+	}
+};
+
 inline FORCE_INLINE __m256i export_i30_u16(__m256i lo, __m256i hi)
 {
 	const __m256i round = _mm256_set1_epi32(1 << 13);
@@ -176,27 +290,29 @@ void transpose_line_8x8(T * RESTRICT dst, const T * const * RESTRICT src, unsign
 	}
 }
 
-void transpose_line_16x16_epi16(uint16_t * RESTRICT dst, const uint16_t * const * RESTRICT src, unsigned left, unsigned right)
+// Transposes 16 rows into a buffer of 16-bit samples.
+template <class Traits>
+void transpose_line_16x16(uint16_t * RESTRICT dst, const typename Traits::pixel_type * const * RESTRICT src, unsigned left, unsigned right)
 {
 	for (unsigned j = left; j < right; j += 16) {
 		__m256i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
 
-		x0 = _mm256_load_si256((const __m256i *)(src[0] + j));
-		x1 = _mm256_load_si256((const __m256i *)(src[1] + j));
-		x2 = _mm256_load_si256((const __m256i *)(src[2] + j));
-		x3 = _mm256_load_si256((const __m256i *)(src[3] + j));
-		x4 = _mm256_load_si256((const __m256i *)(src[4] + j));
-		x5 = _mm256_load_si256((const __m256i *)(src[5] + j));
-		x6 = _mm256_load_si256((const __m256i *)(src[6] + j));
-		x7 = _mm256_load_si256((const __m256i *)(src[7] + j));
-		x8 = _mm256_load_si256((const __m256i *)(src[8] + j));
-		x9 = _mm256_load_si256((const __m256i *)(src[9] + j));
-		x10 = _mm256_load_si256((const __m256i *)(src[10] + j));
-		x11 = _mm256_load_si256((const __m256i *)(src[11] + j));
-		x12 = _mm256_load_si256((const __m256i *)(src[12] + j));
-		x13 = _mm256_load_si256((const __m256i *)(src[13] + j));
-		x14 = _mm256_load_si256((const __m256i *)(src[14] + j));
-		x15 = _mm256_load_si256((const __m256i *)(src[15] + j));
+		x0 = Traits::load16(src[0] + j);
+		x1 = Traits::load16(src[1] + j);
+		x2 = Traits::load16(src[2] + j);
+		x3 = Traits::load16(src[3] + j);
+		x4 = Traits::load16(src[4] + j);
+		x5 = Traits::load16(src[5] + j);
+		x6 = Traits::load16(src[6] + j);
+		x7 = Traits::load16(src[7] + j);
+		x8 = Traits::load16(src[8] + j);
+		x9 = Traits::load16(src[9] + j);
+		x10 = Traits::load16(src[10] + j);
+		x11 = Traits::load16(src[11] + j);
+		x12 = Traits::load16(src[12] + j);
+		x13 = Traits::load16(src[13] + j);
+		x14 = Traits::load16(src[14] + j);
+		x15 = Traits::load16(src[15] + j);
 
 		mm256_transpose16_epi16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15);
 
@@ -378,9 +494,9 @@ inline FORCE_INLINE __m256i resize_line8_h_u16_avx2_xiter(unsigned j,
 	return accum_lo;
 }
 
-template <int Taps>
-void resize_line8_h_u16_avx2(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
-                             const uint16_t * RESTRICT src, uint16_t * const * /* RESTRICT */ dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
+template <class Traits, int Taps>
+void resize_line8_h_int_avx2(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
+                             const uint16_t * RESTRICT src, typename Traits::pixel_type * const * /* RESTRICT */ dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
 {
 	unsigned vec_left = ceil_n(left, 16);
 	unsigned vec_right = floor_n(right, 16);
@@ -390,8 +506,8 @@ void resize_line8_h_u16_avx2(const unsigned * RESTRICT filter_left, const int16_
 	for (unsigned j = left; j < vec_left; ++j) {
 		__m256i x = XITER(j, XARGS);
 
-		mm_scatter_epi16(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm256_castsi256_si128(x));
-		mm_scatter_epi16(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm256_extractf128_si256(x, 1));
+		Traits::scatter8(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm256_castsi256_si128(x));
+		Traits::scatter8(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm256_extractf128_si256(x, 1));
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 16) {
@@ -422,53 +538,55 @@ void resize_line8_h_u16_avx2(const unsigned * RESTRICT filter_left, const int16_
 
 		mm256_transpose16_epi16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15);
 
-		_mm256_store_si256((__m256i *)(dst[0] + j), x0);
-		_mm256_store_si256((__m256i *)(dst[1] + j), x1);
-		_mm256_store_si256((__m256i *)(dst[2] + j), x2);
-		_mm256_store_si256((__m256i *)(dst[3] + j), x3);
-		_mm256_store_si256((__m256i *)(dst[4] + j), x4);
-		_mm256_store_si256((__m256i *)(dst[5] + j), x5);
-		_mm256_store_si256((__m256i *)(dst[6] + j), x6);
-		_mm256_store_si256((__m256i *)(dst[7] + j), x7);
-		_mm256_store_si256((__m256i *)(dst[8] + j), x8);
-		_mm256_store_si256((__m256i *)(dst[9] + j), x9);
-		_mm256_store_si256((__m256i *)(dst[10] + j), x10);
-		_mm256_store_si256((__m256i *)(dst[11] + j), x11);
-		_mm256_store_si256((__m256i *)(dst[12] + j), x12);
-		_mm256_store_si256((__m256i *)(dst[13] + j), x13);
-		_mm256_store_si256((__m256i *)(dst[14] + j), x14);
-		_mm256_store_si256((__m256i *)(dst[15] + j), x15);
+		Traits::store16(dst[0] + j, x0);
+		Traits::store16(dst[1] + j, x1);
+		Traits::store16(dst[2] + j, x2);
+		Traits::store16(dst[3] + j, x3);
+		Traits::store16(dst[4] + j, x4);
+		Traits::store16(dst[5] + j, x5);
+		Traits::store16(dst[6] + j, x6);
+		Traits::store16(dst[7] + j, x7);
+		Traits::store16(dst[8] + j, x8);
+		Traits::store16(dst[9] + j, x9);
+		Traits::store16(dst[10] + j, x10);
+		Traits::store16(dst[11] + j, x11);
+		Traits::store16(dst[12] + j, x12);
+		Traits::store16(dst[13] + j, x13);
+		Traits::store16(dst[14] + j, x14);
+		Traits::store16(dst[15] + j, x15);
 	}
 
 	for (unsigned j = vec_right; j < right; ++j) {
 		__m256i x = XITER(j, XARGS);
 
-		mm_scatter_epi16(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm256_castsi256_si128(x));
-		mm_scatter_epi16(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm256_extractf128_si256(x, 1));
+		Traits::scatter8(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm256_castsi256_si128(x));
+		Traits::scatter8(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm256_extractf128_si256(x, 1));
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line8_h_u16_avx2_jt_small = make_array(
-	resize_line8_h_u16_avx2<2>,
-	resize_line8_h_u16_avx2<2>,
-	resize_line8_h_u16_avx2<4>,
-	resize_line8_h_u16_avx2<4>,
-	resize_line8_h_u16_avx2<6>,
-	resize_line8_h_u16_avx2<6>,
-	resize_line8_h_u16_avx2<8>,
-	resize_line8_h_u16_avx2<8>);
-
-constexpr auto resize_line8_h_u16_avx2_jt_large = make_array(
-	resize_line8_h_u16_avx2<0>,
-	resize_line8_h_u16_avx2<-2>,
-	resize_line8_h_u16_avx2<-2>,
-	resize_line8_h_u16_avx2<-4>,
-	resize_line8_h_u16_avx2<-4>,
-	resize_line8_h_u16_avx2<-6>,
-	resize_line8_h_u16_avx2<-6>,
-	resize_line8_h_u16_avx2<0>);
+template <class Traits>
+constexpr auto resize_line8_h_int_avx2_jt_small = make_array(
+	resize_line8_h_int_avx2<Traits, 2>,
+	resize_line8_h_int_avx2<Traits, 2>,
+	resize_line8_h_int_avx2<Traits, 4>,
+	resize_line8_h_int_avx2<Traits, 4>,
+	resize_line8_h_int_avx2<Traits, 6>,
+	resize_line8_h_int_avx2<Traits, 6>,
+	resize_line8_h_int_avx2<Traits, 8>,
+	resize_line8_h_int_avx2<Traits, 8>);
+
+template <class Traits>
+constexpr auto resize_line8_h_int_avx2_jt_large = make_array(
+	resize_line8_h_int_avx2<Traits, 0>,
+	resize_line8_h_int_avx2<Traits, -2>,
+	resize_line8_h_int_avx2<Traits, -2>,
+	resize_line8_h_int_avx2<Traits, -4>,
+	resize_line8_h_int_avx2<Traits, -4>,
+	resize_line8_h_int_avx2<Traits, -6>,
+	resize_line8_h_int_avx2<Traits, -6>,
+	resize_line8_h_int_avx2<Traits, 0>);
 
 
 template <class Traits, int Taps>
@@ -865,10 +983,10 @@ constexpr unsigned V_ACCUM_INITIAL = 1;
 constexpr unsigned V_ACCUM_UPDATE = 2;
 constexpr unsigned V_ACCUM_FINAL = 3;
 
-template <unsigned Taps, unsigned AccumMode>
-inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned accum_base,
-                                                         const uint16_t *src_p0, const uint16_t *src_p1, const uint16_t *src_p2, const uint16_t *src_p3,
-                                                         const uint16_t *src_p4, const uint16_t *src_p5, const uint16_t *src_p6, const uint16_t *src_p7,
+template <class Traits, unsigned Taps, unsigned AccumMode, class T = typename Traits::pixel_type>
+inline FORCE_INLINE __m256i resize_line_v_int_avx2_xiter(unsigned j, unsigned accum_base,
+                                                         const T *src_p0, const T *src_p1, const T *src_p2, const T *src_p3,
+                                                         const T *src_p4, const T *src_p5, const T *src_p6, const T *src_p7,
                                                          uint32_t * RESTRICT accum_p, const __m256i &c01, const __m256i &c23, const __m256i &c45, const __m256i &c67, uint16_t limit)
 {
 	static_assert(Taps >= 2 && Taps <= 8, "must have between 2-8 taps");
@@ -882,8 +1000,8 @@ inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned ac
 	__m256i x0, x1, xl, xh;
 
 	if (Taps >= 2) {
-		x0 = _mm256_load_si256((const __m256i *)(src_p0 + j));
-		x1 = _mm256_load_si256((const __m256i *)(src_p1 + j));
+		x0 = Traits::load16(src_p0 + j);
+		x1 = Traits::load16(src_p1 + j);
 		x0 = _mm256_add_epi16(x0, i16_min);
 		x1 = _mm256_add_epi16(x1, i16_min);
 
@@ -901,8 +1019,8 @@ inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned ac
 		}
 	}
 	if (Taps >= 4) {
-		x0 = _mm256_load_si256((const __m256i *)(src_p2 + j));
-		x1 = _mm256_load_si256((const __m256i *)(src_p3 + j));
+		x0 = Traits::load16(src_p2 + j);
+		x1 = Traits::load16(src_p3 + j);
 		x0 = _mm256_add_epi16(x0, i16_min);
 		x1 = _mm256_add_epi16(x1, i16_min);
 
@@ -915,8 +1033,8 @@ inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned ac
 		accum_hi = _mm256_add_epi32(accum_hi, xh);
 	}
 	if (Taps >= 6) {
-		x0 = _mm256_load_si256((const __m256i *)(src_p4 + j));
-		x1 = _mm256_load_si256((const __m256i *)(src_p5 + j));
+		x0 = Traits::load16(src_p4 + j);
+		x1 = Traits::load16(src_p5 + j);
 		x0 = _mm256_add_epi16(x0, i16_min);
 		x1 = _mm256_add_epi16(x1, i16_min);
 
@@ -929,8 +1047,8 @@ inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned ac
 		accum_hi = _mm256_add_epi32(accum_hi, xh);
 	}
 	if (Taps >= 8) {
-		x0 = _mm256_load_si256((const __m256i *)(src_p6 + j));
-		x1 = _mm256_load_si256((const __m256i *)(src_p7 + j));
+		x0 = Traits::load16(src_p6 + j);
+		x1 = Traits::load16(src_p7 + j);
 		x0 = _mm256_add_epi16(x0, i16_min);
 		x1 = _mm256_add_epi16(x1, i16_min);
 
@@ -956,17 +1074,18 @@ inline FORCE_INLINE __m256i resize_line_v_u16_avx2_xiter(unsigned j, unsigned ac
 	}
 }
 
-template <unsigned Taps, unsigned AccumMode>
-void resize_line_v_u16_avx2(const int16_t * RESTRICT filter_data, const uint16_t * const * RESTRICT src, uint16_t * RESTRICT dst, uint32_t * RESTRICT accum, unsigned left, unsigned right, uint16_t limit)
+template <class Traits, unsigned Taps, unsigned AccumMode, class DstTraits = Traits,
+          class T = typename Traits::pixel_type, class U = typename DstTraits::pixel_type>
+void resize_line_v_int_avx2(const int16_t * RESTRICT filter_data, const T * const * RESTRICT src, U * RESTRICT dst, uint32_t * RESTRICT accum, unsigned left, unsigned right, uint16_t limit)
 {
-	const uint16_t *src_p0 = src[0];
-	const uint16_t *src_p1 = src[1];
-	const uint16_t *src_p2 = src[2];
-	const uint16_t *src_p3 = src[3];
-	const uint16_t *src_p4 = src[4];
-	const uint16_t *src_p5 = src[5];
-	const uint16_t *src_p6 = src[6];
-	const uint16_t *src_p7 = src[7];
+	const T *src_p0 = src[0];
+	const T *src_p1 = src[1];
+	const T *src_p2 = src[2];
+	const T *src_p3 = src[3];
+	const T *src_p4 = src[4];
+	const T *src_p5 = src[5];
+	const T *src_p6 = src[6];
+	const T *src_p7 = src[7];
 
 	unsigned vec_left = ceil_n(left, 16);
 	unsigned vec_right = floor_n(right, 16);
@@ -979,54 +1098,58 @@ void resize_line_v_u16_avx2(const int16_t * RESTRICT filter_data, const uint16_t
 
 	__m256i out;
 
-#define XITER resize_line_v_u16_avx2_xiter<Taps, AccumMode>
+#define XITER resize_line_v_int_avx2_xiter<Traits, Taps, AccumMode>
 #define XARGS accum_base, src_p0, src_p1, src_p2, src_p3, src_p4, src_p5, src_p6, src_p7, accum, c01, c23, c45, c67, limit
 	if (left != vec_left) {
 		out = XITER(vec_left - 16, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			mm256_store_idxhi_epi16((__m256i *)(dst + vec_left - 16), out, left % 16);
+			DstTraits::store16_idxhi(dst + vec_left - 16, out, left % 16);
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 16) {
 		out = XITER(j, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			_mm256_store_si256((__m256i *)(dst + j), out);
+			DstTraits::store16(dst + j, out);
 	}
 
 	if (right != vec_right) {
 		out = XITER(vec_right, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			mm256_store_idxlo_epi16((__m256i *)(dst + vec_right), out, right % 16);
+			DstTraits::store16_idxlo(dst + vec_right, out, right % 16);
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line_v_u16_avx2_jt_small = make_array(
-	resize_line_v_u16_avx2<2, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<2, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<4, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<4, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<6, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<6, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<8, V_ACCUM_NONE>,
-	resize_line_v_u16_avx2<8, V_ACCUM_NONE>);
-
-constexpr auto resize_line_v_u16_avx2_initial = resize_line_v_u16_avx2<8, V_ACCUM_INITIAL>;
-constexpr auto resize_line_v_u16_avx2_update = resize_line_v_u16_avx2<8, V_ACCUM_UPDATE>;
-
-constexpr auto resize_line_v_u16_avx2_jt_final = make_array(
-	resize_line_v_u16_avx2<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<8, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx2<8, V_ACCUM_FINAL>);
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx2_jt_small = make_array(
+	resize_line_v_int_avx2<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 8, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx2<Traits, 8, V_ACCUM_NONE, DstTraits>);
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx2_initial = resize_line_v_int_avx2<Traits, 8, V_ACCUM_INITIAL, DstTraits>;
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx2_update = resize_line_v_int_avx2<Traits, 8, V_ACCUM_UPDATE, DstTraits>;
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx2_jt_final = make_array(
+	resize_line_v_int_avx2<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 8, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx2<Traits, 8, V_ACCUM_FINAL, DstTraits>);
 
 
 template <class Traits, unsigned Taps, bool Continue, class T = typename Traits::pixel_type>
@@ -1153,22 +1276,122 @@ constexpr auto resize_line_v_fp_avx2_jt_cont = make_array(
 	resize_line_v_fp_avx2<Traits, 8, true>);
 
 
-class ResizeImplH_U16_AVX2 : public ResizeImplH {
-	decltype(resize_line8_h_u16_avx2_jt_small)::value_type m_func;
+inline FORCE_INLINE __m256 loadu_2x128_ps(const float *lo, const float *hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+// Splits 8 * Factor consecutive samples into Factor vectors, one per phase.
+template <unsigned Factor>
+void deinterleave8_ps(const float *src, __m256 x[Factor]);
+
+template <>
+inline FORCE_INLINE void deinterleave8_ps<2>(const float *src, __m256 x[2])
+{
+	// Loading the upper half of the block into the upper lane keeps the result in order.
+	__m256 a = loadu_2x128_ps(src + 0, src + 8);
+	__m256 b = loadu_2x128_ps(src + 4, src + 12);
+
+	x[0] = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+	x[1] = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+template <unsigned Factor>
+void deinterleave_line_fp_avx2(const float * RESTRICT src, float * RESTRICT streams, size_t stream_stride, unsigned count)
+{
+	unsigned n = 0;
+
+	for (; n + 8 * Factor <= count; n += 8 * Factor) {
+		__m256 x[Factor];
+		deinterleave8_ps<Factor>(src + n, x);
+
+		for (unsigned p = 0; p < Factor; ++p) {
+			_mm256_store_ps(streams + p * stream_stride + n / Factor, x[p]);
+		}
+	}
+	for (; n < count; ++n) {
+		streams[(n % Factor) * stream_stride + n / Factor] = src[n];
+	}
+}
+
+template <unsigned Factor>
+void decimate_line_h_fp_avx2(const float * RESTRICT filter_data, unsigned filter_width, const float * RESTRICT streams, size_t stream_stride,
+                             float * RESTRICT dst, unsigned count)
+{
+	unsigned n = 0;
+
+	// Eight independent accumulators hide the latency of the multiply-add chain.
+	for (; n + 64 <= count; n += 64) {
+		__m256 accum0 = _mm256_setzero_ps();
+		__m256 accum1 = _mm256_setzero_ps();
+		__m256 accum2 = _mm256_setzero_ps();
+		__m256 accum3 = _mm256_setzero_ps();
+		__m256 accum4 = _mm256_setzero_ps();
+		__m256 accum5 = _mm256_setzero_ps();
+		__m256 accum6 = _mm256_setzero_ps();
+		__m256 accum7 = _mm256_setzero_ps();
+
+		for (unsigned k = 0; k < filter_width; ++k) {
+			const float *src_p = streams + (k % Factor) * stream_stride + k / Factor + n;
+			__m256 c = _mm256_broadcast_ss(filter_data + k);
+
+			accum0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 0), accum0);
+			accum1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 8), accum1);
+			accum2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 16), accum2);
+			accum3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 24), accum3);
+			accum4 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 32), accum4);
+			accum5 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 40), accum5);
+			accum6 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 48), accum6);
+			accum7 = _mm256_fmadd_ps(c, _mm256_loadu_ps(src_p + 56), accum7);
+		}
+
+		_mm256_storeu_ps(dst + n + 0, accum0);
+		_mm256_storeu_ps(dst + n + 8, accum1);
+		_mm256_storeu_ps(dst + n + 16, accum2);
+		_mm256_storeu_ps(dst + n + 24, accum3);
+		_mm256_storeu_ps(dst + n + 32, accum4);
+		_mm256_storeu_ps(dst + n + 40, accum5);
+		_mm256_storeu_ps(dst + n + 48, accum6);
+		_mm256_storeu_ps(dst + n + 56, accum7);
+	}
+	for (; n < count; n += 8) {
+		__m256 accum = _mm256_setzero_ps();
+
+		for (unsigned k = 0; k < filter_width; ++k) {
+			const float *src_p = streams + (k % Factor) * stream_stride + k / Factor + n;
+			accum = _mm256_fmadd_ps(_mm256_broadcast_ss(filter_data + k), _mm256_loadu_ps(src_p), accum);
+		}
+
+		if (n + 8 <= count) {
+			_mm256_storeu_ps(dst + n, accum);
+		} else {
+			alignas(32) float tmp[8];
+			_mm256_store_ps(tmp, accum);
+			std::copy_n(tmp, count - n, dst + n);
+		}
+	}
+}
+
+template <class Traits, class DstTraits = Traits>
+class ResizeImplH_Int_AVX2 : public ResizeImplH {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
+	typename decltype(resize_line8_h_int_avx2_jt_small<DstTraits>)::value_type m_func;
 	uint16_t m_pixel_max;
 public:
-	ResizeImplH_U16_AVX2(const FilterContext &filter, unsigned height, unsigned depth) try :
-		ResizeImplH(filter, height, PixelType::WORD),
+	ResizeImplH_Int_AVX2(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth) try :
+		ResizeImplH(filter, height, DstTraits::type_constant),
 		m_func{},
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		m_desc.step = 16;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 16) * sizeof(uint16_t) * 16).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 16) * sizeof(uint16_t) * 16).get();
 
-		if (filter.filter_width > 8)
-			m_func = resize_line8_h_u16_avx2_jt_large[filter.filter_width % 8];
+		if (filter->filter_width > 8)
+			m_func = resize_line8_h_int_avx2_jt_large<DstTraits>[filter->filter_width % 8];
 		else
-			m_func = resize_line8_h_u16_avx2_jt_small[filter.filter_width - 1];
+			m_func = resize_line8_h_int_avx2_jt_small<DstTraits>[filter->filter_width - 1];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -1178,19 +1401,19 @@ public:
 	{
 		auto range = get_col_deps(left, right);
 
-		const uint16_t *src_ptr[16] = { 0 };
-		uint16_t *dst_ptr[16] = { 0 };
+		const pixel_type *src_ptr[16] = { 0 };
+		dst_pixel_type *dst_ptr[16] = { 0 };
 		uint16_t *transpose_buf = static_cast<uint16_t *>(tmp);
 		unsigned height = m_desc.format.height;
 
 		for (unsigned n = 0; n < 16; ++n) {
-			src_ptr[n] = in->get_line<uint16_t>(std::min(i + n, height - 1));
+			src_ptr[n] = in->get_line<pixel_type>(std::min(i + n, height - 1));
 		}
 
-		transpose_line_16x16_epi16(transpose_buf, src_ptr, floor_n(range.first, 16), ceil_n(range.second, 16));
+		transpose_line_16x16<Traits>(transpose_buf, src_ptr, floor_n(range.first, 16), ceil_n(range.second, 16));
 
 		for (unsigned n = 0; n < 16; ++n) {
-			dst_ptr[n] = out->get_line<uint16_t>(std::min(i + n, height - 1));
+			dst_ptr[n] = out->get_line<dst_pixel_type>(std::min(i + n, height - 1));
 		}
 
 		m_func(m_filter.left.data(), m_filter.data_i16.data(), m_filter.stride_i16, m_filter.filter_width,
@@ -1206,17 +1429,17 @@ class ResizeImplH_FP_AVX2 : public ResizeImplH {
 
 	func_type m_func;
 public:
-	ResizeImplH_FP_AVX2(const FilterContext &filter, unsigned height) try :
+	ResizeImplH_FP_AVX2(const std::shared_ptr<const FilterContext> &filter, unsigned height) try :
 		ResizeImplH(filter, height, Traits::type_constant),
 		m_func{}
 	{
 		m_desc.step = 8;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 8) * sizeof(pixel_type) * 8).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 8) * sizeof(pixel_type) * 8).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line8_h_fp_avx2_jt_small<Traits>[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line8_h_fp_avx2_jt_small<Traits>[filter->filter_width - 1];
 		else
-			m_func = resize_line8_h_fp_avx2_jt_large<Traits>[filter.filter_width % 4];
+			m_func = resize_line8_h_fp_avx2_jt_large<Traits>[filter->filter_width % 4];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -1286,50 +1509,50 @@ class ResizeImplH_Permute_U16_AVX2 : public graph::FilterBase {
 		m_desc.flags.entire_row = !std::is_sorted(m_context.left.begin(), m_context.left.end());
 	}
 public:
-	static std::unique_ptr<graphengine::Filter> create(const FilterContext &filter, unsigned height, unsigned depth)
+	static std::unique_ptr<graphengine::Filter> create(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth)
 	{
 		// Transpose is faster for large filters.
-		if (filter.filter_width > 8)
+		if (filter->filter_width > 8)
 			return nullptr;
 
 		PermuteContext context{};
 
-		unsigned filter_width = ceil_n(filter.filter_width + 2, 2);
+		unsigned filter_width = ceil_n(filter->filter_width + 2, 2);
 
-		context.left.resize(ceil_n(filter.filter_rows, 8) / 8);
-		context.permute.resize(ceil_n(filter.filter_rows, 8));
-		context.data.resize(ceil_n(filter.filter_rows, 8) * filter_width);
-		context.filter_rows = filter.filter_rows;
+		context.left.resize(ceil_n(filter->filter_rows, 8) / 8);
+		context.permute.resize(ceil_n(filter->filter_rows, 8));
+		context.data.resize(ceil_n(filter->filter_rows, 8) * filter_width);
+		context.filter_rows = filter->filter_rows;
 		context.filter_width = filter_width;
-		context.input_width = filter.input_width;
+		context.input_width = filter->input_width;
 
-		for (unsigned i = 0; i < filter.filter_rows; i += 8) {
+		for (unsigned i = 0; i < filter->filter_rows; i += 8) {
 			unsigned left_min = UINT_MAX;
 			unsigned left_max = 0U;
 
 			for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-				left_min = std::min(left_min, filter.left[ii]);
-				left_max = std::max(left_max, filter.left[ii]);
+				left_min = std::min(left_min, filter->left[ii]);
+				left_max = std::max(left_max, filter->left[ii]);
 			}
 			if (floor_n(left_max - left_min, 2) >= 16)
 				return nullptr;
 
 			for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-				context.permute[ii] = floor_n(filter.left[ii] - left_min, 2) / 2;
+				context.permute[ii] = floor_n(filter->left[ii] - left_min, 2) / 2;
 			}
 			context.left[i / 8] = left_min;
 
 			int16_t *data = context.data.data() + i * context.filter_width;
-			for (unsigned k = 0; k < filter.filter_width; k += 2) {
+			for (unsigned k = 0; k < filter->filter_width; k += 2) {
 				for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-					unsigned offset = (filter.left[ii] - context.left[i / 8]) % 2;
+					unsigned offset = (filter->left[ii] - context.left[i / 8]) % 2;
 
 					if (offset) {
-						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 1] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 0];
-						data[static_cast<size_t>(k / 2 + 1) * 16 + (ii - i) * 2] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 1];
+						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 1] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 0];
+						data[static_cast<size_t>(k / 2 + 1) * 16 + (ii - i) * 2] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 1];
 					} else {
-						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 0] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 0];
-						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 1] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 1];
+						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 0] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 0];
+						data[static_cast<size_t>(k / 2) * 16 + (ii - i) * 2 + 1] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 1];
 					}
 				}
 			}
@@ -1389,41 +1612,41 @@ class ResizeImplH_Permute_FP_AVX2 : public graph::FilterBase {
 		m_desc.flags.entire_row = !std::is_sorted(m_context.left.begin(), m_context.left.end());
 	}
 public:
-	static std::unique_ptr<graphengine::Filter> create(const FilterContext &filter, unsigned height)
+	static std::unique_ptr<graphengine::Filter> create(const std::shared_ptr<const FilterContext> &filter, unsigned height)
 	{
 		// Transpose is faster for large filters.
-		if (filter.filter_width > 8)
+		if (filter->filter_width > 8)
 			return nullptr;
 
 		PermuteContext context{};
 
-		context.left.resize(ceil_n(filter.filter_rows, 8) / 8);
-		context.permute.resize(ceil_n(filter.filter_rows, 8));
-		context.data.resize(ceil_n(filter.filter_rows, 8) * filter.filter_width);
-		context.filter_rows = filter.filter_rows;
-		context.filter_width = filter.filter_width;
-		context.input_width = filter.input_width;
+		context.left.resize(ceil_n(filter->filter_rows, 8) / 8);
+		context.permute.resize(ceil_n(filter->filter_rows, 8));
+		context.data.resize(ceil_n(filter->filter_rows, 8) * filter->filter_width);
+		context.filter_rows = filter->filter_rows;
+		context.filter_width = filter->filter_width;
+		context.input_width = filter->input_width;
 
-		for (unsigned i = 0; i < filter.filter_rows; i += 8) {
+		for (unsigned i = 0; i < filter->filter_rows; i += 8) {
 			unsigned left_min = UINT_MAX;
 			unsigned left_max = 0U;
 
 			for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-				left_min = std::min(left_min, filter.left[ii]);
-				left_max = std::max(left_max, filter.left[ii]);
+				left_min = std::min(left_min, filter->left[ii]);
+				left_max = std::max(left_max, filter->left[ii]);
 			}
 			if (left_max - left_min >= 8)
 				return nullptr;
 
 			for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-				context.permute[ii] = filter.left[ii] - left_min;
+				context.permute[ii] = filter->left[ii] - left_min;
 			}
 			context.left[i / 8] = left_min;
 
 			float *data = context.data.data() + i * context.filter_width;
 			for (unsigned k = 0; k < context.filter_width; ++k) {
 				for (unsigned ii = i; ii < std::min(i + 8, context.filter_rows); ++ii) {
-					data[static_cast<size_t>(k) * 8 + (ii - i)] = filter.data[ii * static_cast<ptrdiff_t>(filter.stride) + k];
+					data[static_cast<size_t>(k) * 8 + (ii - i)] = filter->data[ii * static_cast<ptrdiff_t>(filter->stride) + k];
 				}
 			}
 		}
@@ -1453,11 +1676,15 @@ public:
 };
 
 
-class ResizeImplV_U16_AVX2 : public ResizeImplV {
+template <class Traits, class DstTraits = Traits>
+class ResizeImplV_Int_AVX2 : public ResizeImplV {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
 	uint16_t m_pixel_max;
 public:
-	ResizeImplV_U16_AVX2(const FilterContext &filter, unsigned width, unsigned depth) try :
-		ResizeImplV(filter, width, PixelType::WORD),
+	ResizeImplV_Int_AVX2(const std::shared_ptr<const FilterContext> &filter, unsigned width, unsigned depth) try :
+		ResizeImplV(filter, width, DstTraits::type_constant),
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		if (m_filter.filter_width > 8)
@@ -1469,12 +1696,12 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
 	{
-		const int16_t *filter_data = m_filter.data_i16.data() + i * m_filter.stride_i16;
+		const int16_t *filter_data = m_filter.row_i16(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
-		const uint16_t *src_lines[8] = { 0 };
-		uint16_t *dst_line = out->get_line<uint16_t>(i);
+		const pixel_type *src_lines[8] = { 0 };
+		dst_pixel_type *dst_line = out->get_line<dst_pixel_type>(i);
 		uint32_t *accum_buf = static_cast<uint32_t *>(tmp);
 
 		unsigned top = m_filter.left[i];
@@ -1482,26 +1709,26 @@ public:
 		auto calculate_line_address = [&](unsigned i)
 		{
 			for (unsigned n = 0; n < 8; ++n) {
-				src_lines[n] = in->get_line<uint16_t>(std::min(i + n, src_height - 1));
+				src_lines[n] = in->get_line<pixel_type>(std::min(i + n, src_height - 1));
 			}
 		};
 
 		if (filter_width <= 8) {
 			calculate_line_address(top);
-			resize_line_v_u16_avx2_jt_small[filter_width - 1](filter_data, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx2_jt_small<Traits, DstTraits>[filter_width - 1](filter_data, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 		} else {
 			unsigned k_end = ceil_n(filter_width, 8) - 8;
 
 			calculate_line_address(top);
-			resize_line_v_u16_avx2_initial(filter_data + 0, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx2_initial<Traits, DstTraits>(filter_data + 0, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 
 			for (unsigned k = 8; k < k_end; k += 8) {
 				calculate_line_address(top + k);
-				resize_line_v_u16_avx2_update(filter_data + k, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+				resize_line_v_int_avx2_update<Traits, DstTraits>(filter_data + k, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 			}
 
 			calculate_line_address(top + k_end);
-			resize_line_v_u16_avx2_jt_final[filter_width - k_end - 1](filter_data + k_end, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx2_jt_final<Traits, DstTraits>[filter_width - k_end - 1](filter_data + k_end, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 		}
 	}
 };
@@ -1511,14 +1738,14 @@ template <class Traits>
 class ResizeImplV_FP_AVX2 : public ResizeImplV {
 	typedef typename Traits::pixel_type pixel_type;
 public:
-	ResizeImplV_FP_AVX2(const FilterContext &filter, unsigned width) :
+	ResizeImplV_FP_AVX2(const std::shared_ptr<const FilterContext> &filter, unsigned width) :
 		ResizeImplV(filter, width, Traits::type_constant)
 	{}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		const float *filter_data = m_filter.data.data() + i * m_filter.stride;
+		const float *filter_data = m_filter.row(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -1559,10 +1786,69 @@ public:
 	}
 };
 
+
+// Computes the columns outside the decimated span.
+void resize_span_h_fp(const FilterContext &filter, const float *src, float *dst, unsigned left, unsigned right)
+{
+	for (unsigned j = left; j < right; ++j) {
+		const float *filter_coeffs = &filter.data[j * filter.stride];
+		const float *src_p = src + filter.left[j];
+		float accum = 0;
+
+		for (unsigned k = 0; k < filter.filter_width; ++k) {
+			accum += filter_coeffs[k] * src_p[k];
+		}
+
+		dst[j] = accum;
+	}
+}
+
+template <unsigned Factor>
+class ResizeImplH_Decimate_FP_AVX2 : public ResizeImplH {
+	FilterDecimation m_decimation;
+	size_t m_stream_stride;
+public:
+	ResizeImplH_Decimate_FP_AVX2(const std::shared_ptr<const FilterContext> &filter, const FilterDecimation &decimation, unsigned height) try :
+		ResizeImplH(filter, height, PixelType::FLOAT),
+		m_decimation(decimation),
+		m_stream_stride{}
+	{
+		// One sample per output column and phase, plus the filter overhang and vector padding.
+		m_stream_stride = ceil_n(checked_size_t{ filter->filter_rows } + filter->filter_width + 32, 8).get();
+		m_desc.scratchpad_size = (checked_size_t{ m_stream_stride } * Factor * sizeof(float)).get();
+	} catch (const std::overflow_error &) {
+		error::throw_<error::OutOfMemory>();
+	}
+
+	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
+	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
+	{
+		const float *src = in->get_line<float>(i);
+		float *dst = out->get_line<float>(i);
+		float *streams = static_cast<float *>(tmp);
+
+		unsigned span_left = std::min(std::max(left, m_decimation.left), right);
+		unsigned span_right = std::max(std::min(right, m_decimation.right), span_left);
+
+		resize_span_h_fp(m_filter, src, dst, left, span_left);
+
+		if (span_left < span_right) {
+			const float *src_p = src + (static_cast<int>(span_left * Factor) + m_decimation.offset);
+			unsigned count = span_right - span_left;
+
+			deinterleave_line_fp_avx2<Factor>(src_p, streams, m_stream_stride, (count - 1) * Factor + m_filter.filter_width);
+			decimate_line_h_fp_avx2<Factor>(&m_filter.data[m_decimation.left * m_filter.stride], m_filter.filter_width,
+			                                streams, m_stream_stride, dst + span_left, count);
+		}
+
+		resize_span_h_fp(m_filter, src, dst, span_right, right);
+	}
+};
+
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx2(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx2(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -1578,8 +1864,10 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx2(const FilterConte
 #endif
 
 	if (!ret) {
-		if (type == PixelType::WORD)
-			ret = std::make_unique<ResizeImplH_U16_AVX2>(context, height, depth);
+		if (type == PixelType::BYTE)
+			ret = std::make_unique<ResizeImplH_Int_AVX2<u8_traits>>(context, height, depth);
+		else if (type == PixelType::WORD)
+			ret = std::make_unique<ResizeImplH_Int_AVX2<u16_traits>>(context, height, depth);
 		else if (type == PixelType::HALF)
 			ret = std::make_unique<ResizeImplH_FP_AVX2<f16_traits>>(context, height);
 		else if (type == PixelType::FLOAT)
@@ -1589,12 +1877,27 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx2(const FilterConte
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx2(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_decimate_avx2(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
+{
+	// Only float reductions are faster than the transposing kernels.
+	if (type != PixelType::FLOAT)
+		return nullptr;
+
+	FilterDecimation decimation = find_filter_decimation(*context);
+	if (decimation.left == decimation.right)
+		return nullptr;
+
+	return std::make_unique<ResizeImplH_Decimate_FP_AVX2<2>>(context, decimation, height);
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx2(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
-	if (type == PixelType::WORD)
-		ret = std::make_unique<ResizeImplV_U16_AVX2>(context, width, depth);
+	if (type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX2<u8_traits>>(context, width, depth);
+	else if (type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX2<u16_traits>>(context, width, depth);
 	else if (type == PixelType::HALF)
 		ret = std::make_unique<ResizeImplV_FP_AVX2<f16_traits>>(context, width);
 	else if (type == PixelType::FLOAT)
@@ -1603,6 +1906,30 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx2(const FilterConte
 	return ret;
 }
 
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_avx2(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplH_Int_AVX2<u8_wide_traits, u16_traits>>(context, height, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplH_Int_AVX2<u16_traits, u8_narrow_traits>>(context, height, 16);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_avx2(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX2<u8_wide_traits, u16_traits>>(context, width, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX2<u16_traits, u8_narrow_traits>>(context, width, 16);
+
+	return ret;
+}
+
 } // namespace resize
 } // namespace zimg
 
@@ -663,17 +663,17 @@ class ResizeImplH_FP_AVX512 : public ResizeImplH {
 
 	func_type m_func;
 public:
-	ResizeImplH_FP_AVX512(const FilterContext &filter, unsigned height) try :
+	ResizeImplH_FP_AVX512(const std::shared_ptr<const FilterContext> &filter, unsigned height) try :
 		ResizeImplH(filter, height, Traits::type_constant),
 		m_func{}
 	{
 		m_desc.step = 16;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 16) * sizeof(pixel_type) * 16).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 16) * sizeof(pixel_type) * 16).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line16_h_fp_avx512_jt_small<Traits>[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line16_h_fp_avx512_jt_small<Traits>[filter->filter_width - 1];
 		else
-			m_func = resize_line16_h_fp_avx512_jt_large<Traits>[filter.filter_width % 4];
+			m_func = resize_line16_h_fp_avx512_jt_large<Traits>[filter->filter_width % 4];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -731,41 +731,41 @@ class ResizeImplH_Permute_FP_AVX512 : public graph::FilterBase {
 		m_desc.flags.entire_row = !std::is_sorted(m_context.left.begin(), m_context.left.end());
 	}
 public:
-	static std::unique_ptr<graphengine::Filter> create(const FilterContext &filter, unsigned height)
+	static std::unique_ptr<graphengine::Filter> create(const std::shared_ptr<const FilterContext> &filter, unsigned height)
 	{
 		// Transpose is faster for large filters.
-		if (filter.filter_width > 16)
+		if (filter->filter_width > 16)
 			return nullptr;
 
 		PermuteContext context{};
 
-		context.left.resize(ceil_n(filter.filter_rows, 16) / 16);
-		context.permute.resize(ceil_n(filter.filter_rows, 16));
-		context.data.resize(ceil_n(filter.filter_rows, 16) * filter.filter_width);
-		context.filter_rows = filter.filter_rows;
-		context.filter_width = filter.filter_width;
-		context.input_width = filter.input_width;
+		context.left.resize(ceil_n(filter->filter_rows, 16) / 16);
+		context.permute.resize(ceil_n(filter->filter_rows, 16));
+		context.data.resize(ceil_n(filter->filter_rows, 16) * filter->filter_width);
+		context.filter_rows = filter->filter_rows;
+		context.filter_width = filter->filter_width;
+		context.input_width = filter->input_width;
 
-		for (unsigned i = 0; i < filter.filter_rows; i += 16) {
+		for (unsigned i = 0; i < filter->filter_rows; i += 16) {
 			unsigned left_min = UINT_MAX;
 			unsigned left_max = 0U;
 
 			for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-				left_min = std::min(left_min, filter.left[ii]);
-				left_max = std::max(left_max, filter.left[ii]);
+				left_min = std::min(left_min, filter->left[ii]);
+				left_max = std::max(left_max, filter->left[ii]);
 			}
 			if (left_max - left_min >= 16)
 				return nullptr;
 
 			for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-				context.permute[ii] = filter.left[ii] - left_min;
+				context.permute[ii] = filter->left[ii] - left_min;
 			}
 			context.left[i / 16] = left_min;
 
 			float *data = context.data.data() + i * context.filter_width;
 			for (unsigned k = 0; k < context.filter_width; ++k) {
 				for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-					data[static_cast<size_t>(k) * 16 + (ii - i)] = filter.data[ii * static_cast<ptrdiff_t>(filter.stride) + k];
+					data[static_cast<size_t>(k) * 16 + (ii - i)] = filter->data[ii * static_cast<ptrdiff_t>(filter->stride) + k];
 				}
 			}
 		}
@@ -799,14 +799,14 @@ template <class Traits>
 class ResizeImplV_FP_AVX512 : public ResizeImplV {
 	typedef typename Traits::pixel_type pixel_type;
 public:
-	ResizeImplV_FP_AVX512(const FilterContext &filter, unsigned width) :
+	ResizeImplV_FP_AVX512(const std::shared_ptr<const FilterContext> &filter, unsigned width) :
 		ResizeImplV(filter, width, Traits::type_constant)
 	{}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		const float *filter_data = m_filter.data.data() + i * m_filter.stride;
+		const float *filter_data = m_filter.row(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -834,7 +834,7 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -848,8 +848,10 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512(const FilterCon
 #endif
 
 	if (!ret) {
-		if (type == PixelType::WORD)
-			ret = std::make_unique<ResizeImplH_U16_AVX512>(context, height, depth);
+		if (type == PixelType::BYTE)
+			ret = std::make_unique<ResizeImplH_Int_AVX512<u8_traits>>(context, height, depth);
+		else if (type == PixelType::WORD)
+			ret = std::make_unique<ResizeImplH_Int_AVX512<u16_traits>>(context, height, depth);
 		else if (type == PixelType::HALF)
 			ret = std::make_unique<ResizeImplH_FP_AVX512<f16_traits>>(context, height);
 		else if (type == PixelType::FLOAT)
@@ -859,12 +861,14 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512(const FilterCon
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx512(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx512(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
-	if (type == PixelType::WORD)
-		ret = std::make_unique<ResizeImplV_U16_AVX512>(context, width, depth);
+	if (type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u8_traits>>(context, width, depth);
+	else if (type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u16_traits>>(context, width, depth);
 	else if (type == PixelType::HALF)
 		ret = std::make_unique<ResizeImplV_FP_AVX512<f16_traits>>(context, width);
 	else if (type == PixelType::FLOAT)
@@ -873,6 +877,30 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx512(const FilterCon
 	return ret;
 }
 
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_avx512(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplH_Int_AVX512<u8_wide_traits, u16_traits>>(context, height, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplH_Int_AVX512<u16_traits, u8_narrow_traits>>(context, height, 16);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_avx512(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u8_wide_traits, u16_traits>>(context, width, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u16_traits, u8_narrow_traits>>(context, width, 16);
+
+	return ret;
+}
+
 } // namespace resize
 } // namespace zimg
 
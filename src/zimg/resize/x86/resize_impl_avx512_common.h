@@ -21,12 +21,106 @@ namespace zimg {
 namespace resize {
 namespace {
 
+struct u8_traits {
+	typedef uint8_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::BYTE;
+
+	static inline FORCE_INLINE __m512i load32(const pixel_type *ptr)
+	{
+		return _mm512_cvtepu8_epi16(_mm256_load_si256((const __m256i *)ptr));
+	}
+
+	static inline FORCE_INLINE void store32(pixel_type *ptr, __m512i x)
+	{
+		_mm256_store_si256((__m256i *)ptr, _mm512_maskz_cvtusepi16_epi8(0xFFFFFFFFU, x));
+	}
+
+	static inline FORCE_INLINE void mask_store32(pixel_type *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm256_mask_storeu_epi8(ptr, mask, _mm512_maskz_cvtusepi16_epi8(0xFFFFFFFFU, x));
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		*dst0 = static_cast<uint8_t>(_mm_extract_epi16(x, 0));
+		*dst1 = static_cast<uint8_t>(_mm_extract_epi16(x, 1));
+		*dst2 = static_cast<uint8_t>(_mm_extract_epi16(x, 2));
+		*dst3 = static_cast<uint8_t>(_mm_extract_epi16(x, 3));
+		*dst4 = static_cast<uint8_t>(_mm_extract_epi16(x, 4));
+		*dst5 = static_cast<uint8_t>(_mm_extract_epi16(x, 5));
+		*dst6 = static_cast<uint8_t>(_mm_extract_epi16(x, 6));
+		*dst7 = static_cast<uint8_t>(_mm_extract_epi16(x, 7));
+	}
+};
+
+struct u16_traits {
+	typedef uint16_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::WORD;
+
+	static inline FORCE_INLINE __m512i load32(const pixel_type *ptr)
+	{
+		return _mm512_load_si512(ptr);
+	}
+
+	static inline FORCE_INLINE void store32(pixel_type *ptr, __m512i x)
+	{
+		_mm512_store_si512(ptr, x);
+	}
+
+	static inline FORCE_INLINE void mask_store32(pixel_type *ptr, __mmask32 mask, __m512i x)
+	{
+		_mm512_mask_storeu_epi16(ptr, mask, x);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		mm_scatter_epi16(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, x);
+	}
+};
+
+// Loads 8-bit samples into the high byte of a 16-bit intermediate.
+struct u8_wide_traits : u8_traits {
+	static inline FORCE_INLINE __m512i load32(const pixel_type *ptr)
+	{
+		return _mm512_slli_epi16(u8_traits::load32(ptr), 8);
+	}
+};
+
+// Rounds a 16-bit intermediate to 8-bit samples.
+struct u8_narrow_traits : u8_traits {
+	static inline FORCE_INLINE __m512i narrow(__m512i x)
+	{
+		return _mm512_srli_epi16(_mm512_adds_epu16(x, _mm512_set1_epi16(128)), 8);
+	}
+
+	static inline FORCE_INLINE void store32(pixel_type *ptr, __m512i x)
+	{
+		u8_traits::store32(ptr, narrow(x));
+	}
+
+	static inline FORCE_INLINE void mask_store32(pixel_type *ptr, __mmask32 mask, __m512i x)
+	{
+		u8_traits::mask_store32(ptr, mask, narrow(x));
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		x = _mm_srli_epi16(_mm_adds_epu16(x, _mm_set1_epi16(128)), 8);
+		u8_traits::scatter8(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, x);
+	}
+};
+
 inline FORCE_INLINE __m256i export_i30_u16(__m512i x)
 {
 	const __m512i round = _mm512_set1_epi32(1 << 13);
 	x = _mm512_add_epi32(x, round);
-	x = _mm512_srai_epi32(x, 14);
-	return _mm512_cvtsepi32_epi16(x);
+	x = _mm512_maskz_srai_epi32(0xFFFF, x, 14);
+	return _mm512_maskz_cvtsepi32_epi16(0xFFFF, x);
 }
 
 inline FORCE_INLINE __m512i export2_i30_u16(__m512i lo, __m512i hi)
@@ -36,52 +130,54 @@ inline FORCE_INLINE __m512i export2_i30_u16(__m512i lo, __m512i hi)
 	lo = _mm512_add_epi32(lo, round);
 	hi = _mm512_add_epi32(hi, round);
 
-	lo = _mm512_srai_epi32(lo, 14);
-	hi = _mm512_srai_epi32(hi, 14);
+	lo = _mm512_maskz_srai_epi32(0xFFFF, lo, 14);
+	hi = _mm512_maskz_srai_epi32(0xFFFF, hi, 14);
 
 	lo = _mm512_packs_epi32(lo, hi);
 
 	return lo;
 }
 
-void transpose_line_32x32_epi16(uint16_t * RESTRICT dst, const uint16_t * const * RESTRICT src, unsigned left, unsigned right)
+// Transposes 32 rows into a buffer of 16-bit samples.
+template <class Traits>
+void transpose_line_32x32(uint16_t * RESTRICT dst, const typename Traits::pixel_type * const * RESTRICT src, unsigned left, unsigned right)
 {
 	for (unsigned j = left; j < right; j += 32) {
 		__m512i x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
 		__m512i x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27, x28, x29, x30, x31;
 
-		x0 = _mm512_load_si512(src[0] + j);
-		x1 = _mm512_load_si512(src[1] + j);
-		x2 = _mm512_load_si512(src[2] + j);
-		x3 = _mm512_load_si512(src[3] + j);
-		x4 = _mm512_load_si512(src[4] + j);
-		x5 = _mm512_load_si512(src[5] + j);
-		x6 = _mm512_load_si512(src[6] + j);
-		x7 = _mm512_load_si512(src[7] + j);
-		x8 = _mm512_load_si512(src[8] + j);
-		x9 = _mm512_load_si512(src[9] + j);
-		x10 = _mm512_load_si512(src[10] + j);
-		x11 = _mm512_load_si512(src[11] + j);
-		x12 = _mm512_load_si512(src[12] + j);
-		x13 = _mm512_load_si512(src[13] + j);
-		x14 = _mm512_load_si512(src[14] + j);
-		x15 = _mm512_load_si512(src[15] + j);
-		x16 = _mm512_load_si512(src[16] + j);
-		x17 = _mm512_load_si512(src[17] + j);
-		x18 = _mm512_load_si512(src[18] + j);
-		x19 = _mm512_load_si512(src[19] + j);
-		x20 = _mm512_load_si512(src[20] + j);
-		x21 = _mm512_load_si512(src[21] + j);
-		x22 = _mm512_load_si512(src[22] + j);
-		x23 = _mm512_load_si512(src[23] + j);
-		x24 = _mm512_load_si512(src[24] + j);
-		x25 = _mm512_load_si512(src[25] + j);
-		x26 = _mm512_load_si512(src[26] + j);
-		x27 = _mm512_load_si512(src[27] + j);
-		x28 = _mm512_load_si512(src[28] + j);
-		x29 = _mm512_load_si512(src[29] + j);
-		x30 = _mm512_load_si512(src[30] + j);
-		x31 = _mm512_load_si512(src[31] + j);
+		x0 = Traits::load32(src[0] + j);
+		x1 = Traits::load32(src[1] + j);
+		x2 = Traits::load32(src[2] + j);
+		x3 = Traits::load32(src[3] + j);
+		x4 = Traits::load32(src[4] + j);
+		x5 = Traits::load32(src[5] + j);
+		x6 = Traits::load32(src[6] + j);
+		x7 = Traits::load32(src[7] + j);
+		x8 = Traits::load32(src[8] + j);
+		x9 = Traits::load32(src[9] + j);
+		x10 = Traits::load32(src[10] + j);
+		x11 = Traits::load32(src[11] + j);
+		x12 = Traits::load32(src[12] + j);
+		x13 = Traits::load32(src[13] + j);
+		x14 = Traits::load32(src[14] + j);
+		x15 = Traits::load32(src[15] + j);
+		x16 = Traits::load32(src[16] + j);
+		x17 = Traits::load32(src[17] + j);
+		x18 = Traits::load32(src[18] + j);
+		x19 = Traits::load32(src[19] + j);
+		x20 = Traits::load32(src[20] + j);
+		x21 = Traits::load32(src[21] + j);
+		x22 = Traits::load32(src[22] + j);
+		x23 = Traits::load32(src[23] + j);
+		x24 = Traits::load32(src[24] + j);
+		x25 = Traits::load32(src[25] + j);
+		x26 = Traits::load32(src[26] + j);
+		x27 = Traits::load32(src[27] + j);
+		x28 = Traits::load32(src[28] + j);
+		x29 = Traits::load32(src[29] + j);
+		x30 = Traits::load32(src[30] + j);
+		x31 = Traits::load32(src[31] + j);
 
 		mm512_transpose32_epi16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15,
 		                        x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27, x28, x29, x30, x31);
@@ -146,9 +242,9 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	unsigned k_end = Taps > 0 ? 0 : floor_n(filter_width + 1, 8);
 
 	for (unsigned k = 0; k < k_end; k += 8) {
-		coeffs = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(filter_coeffs + k)));
+		coeffs = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128((const __m128i *)(filter_coeffs + k)));
 
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_AAAA);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_AAAA);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 0));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 32));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -159,7 +255,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 		accum_lo = mm512_dpwssd_epi32(accum_lo, c, xl);
 		accum_hi = mm512_dpwssd_epi32(accum_hi, c, xh);
 
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_BBBB);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_BBBB);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 64));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 96));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -170,7 +266,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 		accum_lo = mm512_dpwssd_epi32(accum_lo, c, xl);
 		accum_hi = mm512_dpwssd_epi32(accum_hi, c, xh);
 
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_CCCC);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_CCCC);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 128));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 160));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -181,7 +277,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 		accum_lo = mm512_dpwssd_epi32(accum_lo, c, xl);
 		accum_hi = mm512_dpwssd_epi32(accum_hi, c, xh);
 
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_DDDD);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_DDDD);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 192));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 224));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -196,9 +292,9 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	}
 
 	if (Tail >= 2) {
-		coeffs = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(filter_coeffs + k_end)));
+		coeffs = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128((const __m128i *)(filter_coeffs + k_end)));
 
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_AAAA);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_AAAA);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 0));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 32));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -211,7 +307,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	}
 
 	if (Tail >= 4) {
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_BBBB);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_BBBB);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 64));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 96));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -224,7 +320,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	}
 
 	if (Tail >= 6) {
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_CCCC);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_CCCC);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 128));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 160));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -237,7 +333,7 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	}
 
 	if (Tail >= 8) {
-		c = _mm512_shuffle_epi32(coeffs, _MM_PERM_DDDD);
+		c = _mm512_maskz_shuffle_epi32(0xFFFF, coeffs, _MM_PERM_DDDD);
 		x0 = _mm512_load_si512((const __m256i *)(src_p + 192));
 		x1 = _mm512_load_si512((const __m256i *)(src_p + 224));
 		x0 = _mm512_add_epi16(x0, i16_min);
@@ -255,9 +351,9 @@ inline FORCE_INLINE __m512i resize_line16_h_u16_avx512_xiter(unsigned j,
 	return accum_lo;
 }
 
-template <int Taps>
-void resize_line16_h_u16_avx512(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
-                                const uint16_t * RESTRICT src, uint16_t * const * /* RESTRICT */ dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
+template <class Traits, int Taps>
+void resize_line16_h_int_avx512(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
+                                const uint16_t * RESTRICT src, typename Traits::pixel_type * const * /* RESTRICT */ dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
 {
 	unsigned vec_left = ceil_n(left, 32);
 	unsigned vec_right = floor_n(right, 32);
@@ -267,10 +363,10 @@ void resize_line16_h_u16_avx512(const unsigned * RESTRICT filter_left, const int
 	for (unsigned j = left; j < vec_left; ++j) {
 		__m512i x = XITER(j, XARGS);
 
-		mm_scatter_epi16(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm512_castsi512_si128(x));
-		mm_scatter_epi16(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm512_extracti32x4_epi32(x, 1));
-		mm_scatter_epi16(dst[16] + j, dst[17] + j, dst[18] + j, dst[19] + j, dst[20] + j, dst[21] + j, dst[22] + j, dst[23] + j, _mm512_extracti32x4_epi32(x, 2));
-		mm_scatter_epi16(dst[24] + j, dst[25] + j, dst[26] + j, dst[27] + j, dst[28] + j, dst[29] + j, dst[30] + j, dst[31] + j, _mm512_extracti32x4_epi32(x, 3));
+		Traits::scatter8(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm512_castsi512_si128(x));
+		Traits::scatter8(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 1));
+		Traits::scatter8(dst[16] + j, dst[17] + j, dst[18] + j, dst[19] + j, dst[20] + j, dst[21] + j, dst[22] + j, dst[23] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 2));
+		Traits::scatter8(dst[24] + j, dst[25] + j, dst[26] + j, dst[27] + j, dst[28] + j, dst[29] + j, dst[30] + j, dst[31] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 3));
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 32) {
@@ -319,71 +415,73 @@ void resize_line16_h_u16_avx512(const unsigned * RESTRICT filter_left, const int
 		mm512_transpose32_epi16(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15,
 		                        x16, x17, x18, x19, x20, x21, x22, x23, x24, x25, x26, x27, x28, x29, x30, x31);
 
-		_mm512_store_si512(dst[0] + j, x0);
-		_mm512_store_si512(dst[1] + j, x1);
-		_mm512_store_si512(dst[2] + j, x2);
-		_mm512_store_si512(dst[3] + j, x3);
-		_mm512_store_si512(dst[4] + j, x4);
-		_mm512_store_si512(dst[5] + j, x5);
-		_mm512_store_si512(dst[6] + j, x6);
-		_mm512_store_si512(dst[7] + j, x7);
-		_mm512_store_si512(dst[8] + j, x8);
-		_mm512_store_si512(dst[9] + j, x9);
-		_mm512_store_si512(dst[10] + j, x10);
-		_mm512_store_si512(dst[11] + j, x11);
-		_mm512_store_si512(dst[12] + j, x12);
-		_mm512_store_si512(dst[13] + j, x13);
-		_mm512_store_si512(dst[14] + j, x14);
-		_mm512_store_si512(dst[15] + j, x15);
-		_mm512_store_si512(dst[16] + j, x16);
-		_mm512_store_si512(dst[17] + j, x17);
-		_mm512_store_si512(dst[18] + j, x18);
-		_mm512_store_si512(dst[19] + j, x19);
-		_mm512_store_si512(dst[20] + j, x20);
-		_mm512_store_si512(dst[21] + j, x21);
-		_mm512_store_si512(dst[22] + j, x22);
-		_mm512_store_si512(dst[23] + j, x23);
-		_mm512_store_si512(dst[24] + j, x24);
-		_mm512_store_si512(dst[25] + j, x25);
-		_mm512_store_si512(dst[26] + j, x26);
-		_mm512_store_si512(dst[27] + j, x27);
-		_mm512_store_si512(dst[28] + j, x28);
-		_mm512_store_si512(dst[29] + j, x29);
-		_mm512_store_si512(dst[30] + j, x30);
-		_mm512_store_si512(dst[31] + j, x31);
+		Traits::store32(dst[0] + j, x0);
+		Traits::store32(dst[1] + j, x1);
+		Traits::store32(dst[2] + j, x2);
+		Traits::store32(dst[3] + j, x3);
+		Traits::store32(dst[4] + j, x4);
+		Traits::store32(dst[5] + j, x5);
+		Traits::store32(dst[6] + j, x6);
+		Traits::store32(dst[7] + j, x7);
+		Traits::store32(dst[8] + j, x8);
+		Traits::store32(dst[9] + j, x9);
+		Traits::store32(dst[10] + j, x10);
+		Traits::store32(dst[11] + j, x11);
+		Traits::store32(dst[12] + j, x12);
+		Traits::store32(dst[13] + j, x13);
+		Traits::store32(dst[14] + j, x14);
+		Traits::store32(dst[15] + j, x15);
+		Traits::store32(dst[16] + j, x16);
+		Traits::store32(dst[17] + j, x17);
+		Traits::store32(dst[18] + j, x18);
+		Traits::store32(dst[19] + j, x19);
+		Traits::store32(dst[20] + j, x20);
+		Traits::store32(dst[21] + j, x21);
+		Traits::store32(dst[22] + j, x22);
+		Traits::store32(dst[23] + j, x23);
+		Traits::store32(dst[24] + j, x24);
+		Traits::store32(dst[25] + j, x25);
+		Traits::store32(dst[26] + j, x26);
+		Traits::store32(dst[27] + j, x27);
+		Traits::store32(dst[28] + j, x28);
+		Traits::store32(dst[29] + j, x29);
+		Traits::store32(dst[30] + j, x30);
+		Traits::store32(dst[31] + j, x31);
 	}
 
 	for (unsigned j = vec_right; j < right; ++j) {
 		__m512i x = XITER(j, XARGS);
 
-		mm_scatter_epi16(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm512_castsi512_si128(x));
-		mm_scatter_epi16(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm512_extracti32x4_epi32(x, 1));
-		mm_scatter_epi16(dst[16] + j, dst[17] + j, dst[18] + j, dst[19] + j, dst[20] + j, dst[21] + j, dst[22] + j, dst[23] + j, _mm512_extracti32x4_epi32(x, 2));
-		mm_scatter_epi16(dst[24] + j, dst[25] + j, dst[26] + j, dst[27] + j, dst[28] + j, dst[29] + j, dst[30] + j, dst[31] + j, _mm512_extracti32x4_epi32(x, 3));
+		Traits::scatter8(dst[0] + j, dst[1] + j, dst[2] + j, dst[3] + j, dst[4] + j, dst[5] + j, dst[6] + j, dst[7] + j, _mm512_castsi512_si128(x));
+		Traits::scatter8(dst[8] + j, dst[9] + j, dst[10] + j, dst[11] + j, dst[12] + j, dst[13] + j, dst[14] + j, dst[15] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 1));
+		Traits::scatter8(dst[16] + j, dst[17] + j, dst[18] + j, dst[19] + j, dst[20] + j, dst[21] + j, dst[22] + j, dst[23] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 2));
+		Traits::scatter8(dst[24] + j, dst[25] + j, dst[26] + j, dst[27] + j, dst[28] + j, dst[29] + j, dst[30] + j, dst[31] + j, _mm512_maskz_extracti32x4_epi32(0xF, x, 3));
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line16_h_u16_avx512_jt_small = make_array(
-	resize_line16_h_u16_avx512<2>,
-	resize_line16_h_u16_avx512<2>,
-	resize_line16_h_u16_avx512<4>,
-	resize_line16_h_u16_avx512<4>,
-	resize_line16_h_u16_avx512<6>,
-	resize_line16_h_u16_avx512<6>,
-	resize_line16_h_u16_avx512<8>,
-	resize_line16_h_u16_avx512<8>);
-
-constexpr auto resize_line16_h_u16_avx512_jt_large = make_array(
-	resize_line16_h_u16_avx512<0>,
-	resize_line16_h_u16_avx512<-2>,
-	resize_line16_h_u16_avx512<-2>,
-	resize_line16_h_u16_avx512<-4>,
-	resize_line16_h_u16_avx512<-4>,
-	resize_line16_h_u16_avx512<-6>,
-	resize_line16_h_u16_avx512<-6>,
-	resize_line16_h_u16_avx512<0>);
+template <class Traits>
+constexpr auto resize_line16_h_int_avx512_jt_small = make_array(
+	resize_line16_h_int_avx512<Traits, 2>,
+	resize_line16_h_int_avx512<Traits, 2>,
+	resize_line16_h_int_avx512<Traits, 4>,
+	resize_line16_h_int_avx512<Traits, 4>,
+	resize_line16_h_int_avx512<Traits, 6>,
+	resize_line16_h_int_avx512<Traits, 6>,
+	resize_line16_h_int_avx512<Traits, 8>,
+	resize_line16_h_int_avx512<Traits, 8>);
+
+template <class Traits>
+constexpr auto resize_line16_h_int_avx512_jt_large = make_array(
+	resize_line16_h_int_avx512<Traits, 0>,
+	resize_line16_h_int_avx512<Traits, -2>,
+	resize_line16_h_int_avx512<Traits, -2>,
+	resize_line16_h_int_avx512<Traits, -4>,
+	resize_line16_h_int_avx512<Traits, -4>,
+	resize_line16_h_int_avx512<Traits, -6>,
+	resize_line16_h_int_avx512<Traits, -6>,
+	resize_line16_h_int_avx512<Traits, 0>);
 
 
 template <unsigned Taps>
@@ -521,10 +619,10 @@ constexpr unsigned V_ACCUM_INITIAL = 1;
 constexpr unsigned V_ACCUM_UPDATE = 2;
 constexpr unsigned V_ACCUM_FINAL = 3;
 
-template <unsigned Taps, unsigned AccumMode>
-inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned accum_base,
-                                                           const uint16_t *src_p0, const uint16_t *src_p1, const uint16_t *src_p2, const uint16_t *src_p3,
-                                                           const uint16_t *src_p4, const uint16_t *src_p5, const uint16_t *src_p6, const uint16_t *src_p7,
+template <class Traits, unsigned Taps, unsigned AccumMode, class T = typename Traits::pixel_type>
+inline FORCE_INLINE __m512i resize_line_v_int_avx512_xiter(unsigned j, unsigned accum_base,
+                                                           const T *src_p0, const T *src_p1, const T *src_p2, const T *src_p3,
+                                                           const T *src_p4, const T *src_p5, const T *src_p6, const T *src_p7,
                                                            uint32_t * RESTRICT accum_p, const __m512i &c01, const __m512i &c23, const __m512i &c45, const __m512i &c67, uint16_t limit)
 {
 	static_assert(Taps >= 2 && Taps <= 8, "must have between 2-8 taps");
@@ -538,8 +636,8 @@ inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned
 	__m512i x0, x1, xl, xh;
 
 	if (Taps >= 2) {
-		x0 = _mm512_load_si512(src_p0 + j);
-		x1 = _mm512_load_si512(src_p1 + j);
+		x0 = Traits::load32(src_p0 + j);
+		x1 = Traits::load32(src_p1 + j);
 		x0 = _mm512_add_epi16(x0, i16_min);
 		x1 = _mm512_add_epi16(x1, i16_min);
 
@@ -555,8 +653,8 @@ inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned
 		}
 	}
 	if (Taps >= 4) {
-		x0 = _mm512_load_si512(src_p2 + j);
-		x1 = _mm512_load_si512(src_p3 + j);
+		x0 = Traits::load32(src_p2 + j);
+		x1 = Traits::load32(src_p3 + j);
 		x0 = _mm512_add_epi16(x0, i16_min);
 		x1 = _mm512_add_epi16(x1, i16_min);
 
@@ -567,8 +665,8 @@ inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned
 		accum_hi = mm512_dpwssd_epi32(accum_hi, c23, xh);
 	}
 	if (Taps >= 6) {
-		x0 = _mm512_load_si512(src_p4 + j);
-		x1 = _mm512_load_si512(src_p5 + j);
+		x0 = Traits::load32(src_p4 + j);
+		x1 = Traits::load32(src_p5 + j);
 		x0 = _mm512_add_epi16(x0, i16_min);
 		x1 = _mm512_add_epi16(x1, i16_min);
 
@@ -579,8 +677,8 @@ inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned
 		accum_hi = mm512_dpwssd_epi32(accum_hi, c45, xh);
 	}
 	if (Taps >= 8) {
-		x0 = _mm512_load_si512(src_p6 + j);
-		x1 = _mm512_load_si512(src_p7 + j);
+		x0 = Traits::load32(src_p6 + j);
+		x1 = Traits::load32(src_p7 + j);
 		x0 = _mm512_add_epi16(x0, i16_min);
 		x1 = _mm512_add_epi16(x1, i16_min);
 
@@ -604,18 +702,19 @@ inline FORCE_INLINE __m512i resize_line_v_u16_avx512_xiter(unsigned j, unsigned
 	}
 }
 
-template <unsigned Taps, unsigned AccumMode>
-void resize_line_v_u16_avx512(const int16_t * RESTRICT filter_data, const uint16_t * const * RESTRICT src, uint16_t * RESTRICT dst, uint32_t * RESTRICT accum,
+template <class Traits, unsigned Taps, unsigned AccumMode, class DstTraits = Traits,
+          class T = typename Traits::pixel_type, class U = typename DstTraits::pixel_type>
+void resize_line_v_int_avx512(const int16_t * RESTRICT filter_data, const T * const * RESTRICT src, U * RESTRICT dst, uint32_t * RESTRICT accum,
                               unsigned left, unsigned right, uint16_t limit)
 {
-	const uint16_t *src_p0 = src[0];
-	const uint16_t *src_p1 = src[1];
-	const uint16_t *src_p2 = src[2];
-	const uint16_t *src_p3 = src[3];
-	const uint16_t *src_p4 = src[4];
-	const uint16_t *src_p5 = src[5];
-	const uint16_t *src_p6 = src[6];
-	const uint16_t *src_p7 = src[7];
+	const T *src_p0 = src[0];
+	const T *src_p1 = src[1];
+	const T *src_p2 = src[2];
+	const T *src_p3 = src[3];
+	const T *src_p4 = src[4];
+	const T *src_p5 = src[5];
+	const T *src_p6 = src[6];
+	const T *src_p7 = src[7];
 
 	unsigned vec_left = ceil_n(left, 32);
 	unsigned vec_right = floor_n(right, 32);
@@ -628,54 +727,58 @@ void resize_line_v_u16_avx512(const int16_t * RESTRICT filter_data, const uint16
 
 	__m512i out;
 
-#define XITER resize_line_v_u16_avx512_xiter<Taps, AccumMode>
+#define XITER resize_line_v_int_avx512_xiter<Traits, Taps, AccumMode>
 #define XARGS accum_base, src_p0, src_p1, src_p2, src_p3, src_p4, src_p5, src_p6, src_p7, accum, c01, c23, c45, c67, limit
 	if (left != vec_left) {
 		out = XITER(vec_left - 32, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			_mm512_mask_storeu_epi16(dst + vec_left - 32, mmask32_set_hi(vec_left - left), out);
+			DstTraits::mask_store32(dst + vec_left - 32, mmask32_set_hi(vec_left - left), out);
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 32) {
 		out = XITER(j, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			_mm512_store_si512(dst + j, out);
+			DstTraits::store32(dst + j, out);
 	}
 
 	if (right != vec_right) {
 		out = XITER(vec_right, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			_mm512_mask_storeu_epi16(dst + vec_right, mmask32_set_lo(right - vec_right), out);
+			DstTraits::mask_store32(dst + vec_right, mmask32_set_lo(right - vec_right), out);
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line_v_u16_avx512_jt_small = make_array(
-	resize_line_v_u16_avx512<2, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<2, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<4, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<4, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<6, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<6, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<8, V_ACCUM_NONE>,
-	resize_line_v_u16_avx512<8, V_ACCUM_NONE>);
-
-constexpr auto resize_line_v_u16_avx512_initial = resize_line_v_u16_avx512<8, V_ACCUM_INITIAL>;
-constexpr auto resize_line_v_u16_avx512_update = resize_line_v_u16_avx512<8, V_ACCUM_UPDATE>;
-
-constexpr auto resize_line_v_u16_avx512_jt_final = make_array(
-	resize_line_v_u16_avx512<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<8, V_ACCUM_FINAL>,
-	resize_line_v_u16_avx512<8, V_ACCUM_FINAL>);
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx512_jt_small = make_array(
+	resize_line_v_int_avx512<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 8, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_avx512<Traits, 8, V_ACCUM_NONE, DstTraits>);
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx512_initial = resize_line_v_int_avx512<Traits, 8, V_ACCUM_INITIAL, DstTraits>;
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx512_update = resize_line_v_int_avx512<Traits, 8, V_ACCUM_UPDATE, DstTraits>;
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_avx512_jt_final = make_array(
+	resize_line_v_int_avx512<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 8, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_avx512<Traits, 8, V_ACCUM_FINAL, DstTraits>);
 
 
 inline FORCE_INLINE void calculate_line_address(void *dst, const void *src, ptrdiff_t stride, unsigned mask, unsigned i, unsigned height)
@@ -685,7 +788,7 @@ inline FORCE_INLINE void calculate_line_address(void *dst, const void *src, ptrd
 	__m512i p = _mm512_set1_epi64(reinterpret_cast<intptr_t>(src));
 
 	idx = _mm512_add_epi64(idx, _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
-	idx = _mm512_min_epi64(idx, _mm512_set1_epi64(height - 1));
+	idx = _mm512_maskz_min_epi64(0xFF, idx, _mm512_set1_epi64(height - 1));
 	idx = _mm512_and_epi64(idx, m);
 	idx = _mm512_mullo_epi64(idx, _mm512_set1_epi64(stride));
 
@@ -698,22 +801,26 @@ inline FORCE_INLINE void calculate_line_address(void *dst, const void *src, ptrd
 }
 
 
-class ResizeImplH_U16_AVX512 : public ResizeImplH {
-	decltype(resize_line16_h_u16_avx512_jt_small)::value_type m_func;
+template <class Traits, class DstTraits = Traits>
+class ResizeImplH_Int_AVX512 : public ResizeImplH {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
+	typename decltype(resize_line16_h_int_avx512_jt_small<DstTraits>)::value_type m_func;
 	uint16_t m_pixel_max;
 public:
-	ResizeImplH_U16_AVX512(const FilterContext &filter, unsigned height, unsigned depth) try :
-		ResizeImplH(filter, height, PixelType::WORD),
+	ResizeImplH_Int_AVX512(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth) try :
+		ResizeImplH(filter, height, DstTraits::type_constant),
 		m_func{},
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		m_desc.step = 32;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 32) * sizeof(uint16_t) * 32).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 32) * sizeof(uint16_t) * 32).get();
 
-		if (filter.filter_width > 8)
-			m_func = resize_line16_h_u16_avx512_jt_large[filter.filter_width % 8];
+		if (filter->filter_width > 8)
+			m_func = resize_line16_h_int_avx512_jt_large<DstTraits>[filter->filter_width % 8];
 		else
-			m_func = resize_line16_h_u16_avx512_jt_small[filter.filter_width - 1];
+			m_func = resize_line16_h_int_avx512_jt_small<DstTraits>[filter->filter_width - 1];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -723,8 +830,8 @@ public:
 	{
 		auto range = get_col_deps(left, right);
 
-		alignas(64) const uint16_t *src_ptr[32];
-		alignas(64) uint16_t *dst_ptr[32];
+		alignas(64) const pixel_type *src_ptr[32];
+		alignas(64) dst_pixel_type *dst_ptr[32];
 		uint16_t *transpose_buf = static_cast<uint16_t *>(tmp);
 		unsigned height = m_desc.format.height;
 
@@ -733,7 +840,7 @@ public:
 		calculate_line_address(src_ptr + 16, in->ptr, in->stride, in->mask, i + std::min(16U, height - i - 1), height);
 		calculate_line_address(src_ptr + 24, in->ptr, in->stride, in->mask, i + std::min(24U, height - i - 1), height);
 
-		transpose_line_32x32_epi16(transpose_buf, src_ptr, floor_n(range.first, 32), ceil_n(range.second, 32));
+		transpose_line_32x32<Traits>(transpose_buf, src_ptr, floor_n(range.first, 32), ceil_n(range.second, 32));
 
 		calculate_line_address(dst_ptr + 0, out->ptr, out->stride, out->mask, i + 0, height);
 		calculate_line_address(dst_ptr + 8, out->ptr, out->stride, out->mask, i + std::min(8U, height - i - 1), height);
@@ -775,36 +882,36 @@ class ResizeImplH_Permute_U16_AVX512 : public graph::FilterBase {
 		m_desc.flags.entire_row = !std::is_sorted(m_context.left.begin(), m_context.left.end());
 	}
 public:
-	static std::unique_ptr<graphengine::Filter> create(const FilterContext &filter, unsigned height, unsigned depth)
+	static std::unique_ptr<graphengine::Filter> create(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth)
 	{
 		// Transpose is faster for large filters.
-		if (filter.filter_width > 16)
+		if (filter->filter_width > 16)
 			return nullptr;
 
 		PermuteContext context{};
 
-		unsigned filter_width = ceil_n(filter.filter_width, 2);
+		unsigned filter_width = ceil_n(filter->filter_width, 2);
 
-		context.left.resize(ceil_n(filter.filter_rows, 16) / 16);
-		context.permute.resize(ceil_n(filter.filter_rows, 16) * 2);
-		context.data.resize(ceil_n(filter.filter_rows, 16) * filter_width);
-		context.filter_rows = filter.filter_rows;
+		context.left.resize(ceil_n(filter->filter_rows, 16) / 16);
+		context.permute.resize(ceil_n(filter->filter_rows, 16) * 2);
+		context.data.resize(ceil_n(filter->filter_rows, 16) * filter_width);
+		context.filter_rows = filter->filter_rows;
 		context.filter_width = filter_width;
-		context.input_width = filter.input_width;
+		context.input_width = filter->input_width;
 
-		for (unsigned i = 0; i < filter.filter_rows; i += 16) {
+		for (unsigned i = 0; i < filter->filter_rows; i += 16) {
 			unsigned left_min = UINT_MAX;
 			unsigned left_max = 0U;
 
 			for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-				left_min = std::min(left_min, filter.left[ii]);
-				left_max = std::max(left_max, filter.left[ii]);
+				left_min = std::min(left_min, filter->left[ii]);
+				left_max = std::max(left_max, filter->left[ii]);
 			}
 			if (left_max - left_min >= 32)
 				return nullptr;
 
 			for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-				context.permute[ii * 2 + 0] = filter.left[ii] - left_min;
+				context.permute[ii * 2 + 0] = filter->left[ii] - left_min;
 				context.permute[ii * 2 + 1] = context.permute[ii * 2 + 0] + 1;
 			}
 			context.left[i / 16] = left_min;
@@ -812,8 +919,8 @@ public:
 			int16_t *data = context.data.data() + i * context.filter_width;
 			for (unsigned k = 0; k < context.filter_width; k += 2) {
 				for (unsigned ii = i; ii < std::min(i + 16, context.filter_rows); ++ii) {
-					data[static_cast<size_t>(k / 2) * 32 + (ii - i) * 2 + 0] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 0];
-					data[static_cast<size_t>(k / 2) * 32 + (ii - i) * 2 + 1] = filter.data_i16[ii * static_cast<ptrdiff_t>(filter.stride_i16) + k + 1];
+					data[static_cast<size_t>(k / 2) * 32 + (ii - i) * 2 + 0] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 0];
+					data[static_cast<size_t>(k / 2) * 32 + (ii - i) * 2 + 1] = filter->data_i16[ii * static_cast<ptrdiff_t>(filter->stride_i16) + k + 1];
 				}
 			}
 		}
@@ -843,11 +950,15 @@ public:
 };
 
 
-class ResizeImplV_U16_AVX512 : public ResizeImplV {
+template <class Traits, class DstTraits = Traits>
+class ResizeImplV_Int_AVX512 : public ResizeImplV {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
 	uint16_t m_pixel_max;
 public:
-	ResizeImplV_U16_AVX512(const FilterContext &filter, unsigned width, unsigned depth) try :
-		ResizeImplV(filter, width, PixelType::WORD),
+	ResizeImplV_Int_AVX512(const std::shared_ptr<const FilterContext> &filter, unsigned width, unsigned depth) try :
+		ResizeImplV(filter, width, DstTraits::type_constant),
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		if (m_filter.filter_width > 8)
@@ -859,32 +970,32 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
 	{
-		const int16_t *filter_data = m_filter.data_i16.data() + i * m_filter.stride_i16;
+		const int16_t *filter_data = m_filter.row_i16(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
-		alignas(64) const uint16_t *src_lines[8];
-		uint16_t *dst_line = out->get_line<uint16_t>(i);
+		alignas(64) const pixel_type *src_lines[8];
+		dst_pixel_type *dst_line = out->get_line<dst_pixel_type>(i);
 		uint32_t *accum_buf = static_cast<uint32_t *>(tmp);
 
 		unsigned top = m_filter.left[i];
 
 		if (filter_width <= 8) {
 			calculate_line_address(src_lines, in->ptr, in->stride, in->mask, top + 0, src_height);
-			resize_line_v_u16_avx512_jt_small[filter_width - 1](filter_data, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx512_jt_small<Traits, DstTraits>[filter_width - 1](filter_data, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 		} else {
 			unsigned k_end = ceil_n(filter_width, 8) - 8;
 
 			calculate_line_address(src_lines, in->ptr, in->stride, in->mask, top + 0, src_height);
-			resize_line_v_u16_avx512_initial(filter_data + 0, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx512_initial<Traits, DstTraits>(filter_data + 0, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 
 			for (unsigned k = 8; k < k_end; k += 8) {
 				calculate_line_address(src_lines, in->ptr, in->stride, in->mask, top + k, src_height);
-				resize_line_v_u16_avx512_update(filter_data + k, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+				resize_line_v_int_avx512_update<Traits, DstTraits>(filter_data + k, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 			}
 
 			calculate_line_address(src_lines, in->ptr, in->stride, in->mask, top + k_end, src_height);
-			resize_line_v_u16_avx512_jt_final[filter_width - k_end - 1](filter_data + k_end, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
+			resize_line_v_int_avx512_jt_final<Traits, DstTraits>[filter_width - k_end - 1](filter_data + k_end, src_lines, dst_line, accum_buf, left, right, m_pixel_max);
 		}
 	}
 };
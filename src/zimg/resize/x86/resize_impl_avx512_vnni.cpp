@@ -11,7 +11,7 @@
 namespace zimg {
 namespace resize {
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512_vnni(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512_vnni(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -21,19 +21,47 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_avx512_vnni(const Filt
 #endif
 
 	if (!ret) {
-		if (type == PixelType::WORD)
-			ret = std::make_unique<ResizeImplH_U16_AVX512>(context, height, depth);
+		if (type == PixelType::BYTE)
+			ret = std::make_unique<ResizeImplH_Int_AVX512<u8_traits>>(context, height, depth);
+		else if (type == PixelType::WORD)
+			ret = std::make_unique<ResizeImplH_Int_AVX512<u16_traits>>(context, height, depth);
 	}
 
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx512_vnni(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_avx512_vnni(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
-	if (type == PixelType::WORD)
-		ret = std::make_unique<ResizeImplV_U16_AVX512>(context, width, depth);
+	if (type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u8_traits>>(context, width, depth);
+	else if (type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u16_traits>>(context, width, depth);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_avx512_vnni(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplH_Int_AVX512<u8_wide_traits, u16_traits>>(context, height, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplH_Int_AVX512<u16_traits, u8_narrow_traits>>(context, height, 16);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_avx512_vnni(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u8_wide_traits, u16_traits>>(context, width, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_AVX512<u16_traits, u8_narrow_traits>>(context, width, 16);
 
 	return ret;
 }
@@ -269,17 +269,17 @@ constexpr auto resize_line_v_f32_sse_jt_cont = make_array(
 class ResizeImplH_F32_SSE : public ResizeImplH {
 	decltype(resize_line4_h_f32_sse_jt_small)::value_type m_func;
 public:
-	ResizeImplH_F32_SSE(const FilterContext &filter, unsigned height) try :
+	ResizeImplH_F32_SSE(const std::shared_ptr<const FilterContext> &filter, unsigned height) try :
 		ResizeImplH(filter, height, PixelType::FLOAT),
 		m_func{}
 	{
 		m_desc.step = 4;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 4) * sizeof(float) * 4).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 4) * sizeof(float) * 4).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line4_h_f32_sse_jt_small[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line4_h_f32_sse_jt_small[filter->filter_width - 1];
 		else
-			m_func = resize_line4_h_f32_sse_jt_large[filter.filter_width % 4];
+			m_func = resize_line4_h_f32_sse_jt_large[filter->filter_width % 4];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -314,14 +314,14 @@ public:
 
 class ResizeImplV_F32_SSE : public ResizeImplV {
 public:
-	ResizeImplV_F32_SSE(const FilterContext &filter, unsigned width) :
+	ResizeImplV_F32_SSE(const std::shared_ptr<const FilterContext> &filter, unsigned width) :
 		ResizeImplV(filter, width, PixelType::FLOAT)
 	{}
 
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *) const noexcept override
 	{
-		const float *filter_data = m_filter.data.data() + i * m_filter.stride;
+		const float *filter_data = m_filter.row(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
@@ -357,7 +357,7 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_sse(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_sse(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -367,7 +367,7 @@ std::unique_ptr<graphengine::Filter> create_resize_impl_h_sse(const FilterContex
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_sse(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_sse(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
@@ -20,19 +20,134 @@ namespace resize {
 
 namespace {
 
-void transpose_line_8x8_epi16(uint16_t * RESTRICT dst, const uint16_t * const * RESTRICT src, unsigned left, unsigned right)
+struct u8_traits {
+	typedef uint8_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::BYTE;
+
+	static inline FORCE_INLINE __m128i load8(const pixel_type *ptr)
+	{
+		return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)ptr), _mm_setzero_si128());
+	}
+
+	static inline FORCE_INLINE void store8(pixel_type *ptr, __m128i x)
+	{
+		_mm_storel_epi64((__m128i *)ptr, _mm_packus_epi16(x, x));
+	}
+
+	static inline FORCE_INLINE void store_idxlo(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		alignas(16) uint8_t tmp[16];
+		_mm_store_si128((__m128i *)tmp, _mm_packus_epi16(x, x));
+		std::copy_n(tmp, idx, ptr);
+	}
+
+	static inline FORCE_INLINE void store_idxhi(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		alignas(16) uint8_t tmp[16];
+		_mm_store_si128((__m128i *)tmp, _mm_packus_epi16(x, x));
+		std::copy(tmp + idx, tmp + 8, ptr + idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		*dst0 = static_cast<uint8_t>(_mm_extract_epi16(x, 0));
+		*dst1 = static_cast<uint8_t>(_mm_extract_epi16(x, 1));
+		*dst2 = static_cast<uint8_t>(_mm_extract_epi16(x, 2));
+		*dst3 = static_cast<uint8_t>(_mm_extract_epi16(x, 3));
+		*dst4 = static_cast<uint8_t>(_mm_extract_epi16(x, 4));
+		*dst5 = static_cast<uint8_t>(_mm_extract_epi16(x, 5));
+		*dst6 = static_cast<uint8_t>(_mm_extract_epi16(x, 6));
+		*dst7 = static_cast<uint8_t>(_mm_extract_epi16(x, 7));
+	}
+};
+
+struct u16_traits {
+	typedef uint16_t pixel_type;
+
+	static constexpr PixelType type_constant = PixelType::WORD;
+
+	static inline FORCE_INLINE __m128i load8(const pixel_type *ptr)
+	{
+		return _mm_load_si128((const __m128i *)ptr);
+	}
+
+	static inline FORCE_INLINE void store8(pixel_type *ptr, __m128i x)
+	{
+		_mm_store_si128((__m128i *)ptr, x);
+	}
+
+	static inline FORCE_INLINE void store_idxlo(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		mm_store_idxlo_epi16((__m128i *)ptr, x, idx);
+	}
+
+	static inline FORCE_INLINE void store_idxhi(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		mm_store_idxhi_epi16((__m128i *)ptr, x, idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		mm_scatter_epi16(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, x);
+	}
+};
+
+// Loads 8-bit samples into the high byte of a 16-bit intermediate.
+struct u8_wide_traits : u8_traits {
+	static inline FORCE_INLINE __m128i load8(const pixel_type *ptr)
+	{
+		return _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64((const __m128i *)ptr));
+	}
+};
+
+// Rounds a 16-bit intermediate to 8-bit samples.
+struct u8_narrow_traits : u8_traits {
+	static inline FORCE_INLINE __m128i narrow(__m128i x)
+	{
+		return _mm_srli_epi16(_mm_adds_epu16(x, _mm_set1_epi16(128)), 8);
+	}
+
+	static inline FORCE_INLINE void store8(pixel_type *ptr, __m128i x)
+	{
+		u8_traits::store8(ptr, narrow(x));
+	}
+
+	static inline FORCE_INLINE void store_idxlo(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		u8_traits::store_idxlo(ptr, narrow(x), idx);
+	}
+
+	static inline FORCE_INLINE void store_idxhi(pixel_type *ptr, __m128i x, unsigned idx)
+	{
+		u8_traits::store_idxhi(ptr, narrow(x), idx);
+	}
+
+	static inline FORCE_INLINE void scatter8(pixel_type *dst0, pixel_type *dst1, pixel_type *dst2, pixel_type *dst3,
+	                                         pixel_type *dst4, pixel_type *dst5, pixel_type *dst6, pixel_type *dst7, __m128i x)
+	{
+		u8_traits::scatter8(dst0, dst1, dst2, dst3, dst4, dst5, dst6, dst7, narrow(x));
+	}
+};
+
+
+// Transposes 8 rows into a buffer of 16-bit samples.
+template <class Traits>
+void transpose_line_8x8(uint16_t * RESTRICT dst, const typename Traits::pixel_type * const * RESTRICT src, unsigned left, unsigned right)
 {
 	for (unsigned j = left; j < right; j += 8) {
 		__m128i x0, x1, x2, x3, x4, x5, x6, x7;
 
-		x0 = _mm_load_si128((const __m128i *)(src[0] + j));
-		x1 = _mm_load_si128((const __m128i *)(src[1] + j));
-		x2 = _mm_load_si128((const __m128i *)(src[2] + j));
-		x3 = _mm_load_si128((const __m128i *)(src[3] + j));
-		x4 = _mm_load_si128((const __m128i *)(src[4] + j));
-		x5 = _mm_load_si128((const __m128i *)(src[5] + j));
-		x6 = _mm_load_si128((const __m128i *)(src[6] + j));
-		x7 = _mm_load_si128((const __m128i *)(src[7] + j));
+		x0 = Traits::load8(src[0] + j);
+		x1 = Traits::load8(src[1] + j);
+		x2 = Traits::load8(src[2] + j);
+		x3 = Traits::load8(src[3] + j);
+		x4 = Traits::load8(src[4] + j);
+		x5 = Traits::load8(src[5] + j);
+		x6 = Traits::load8(src[6] + j);
+		x7 = Traits::load8(src[7] + j);
 
 		mm_transpose8_epi16(x0, x1, x2, x3, x4, x5, x6, x7);
 
@@ -221,27 +336,29 @@ inline FORCE_INLINE __m128i resize_line8_h_u16_sse2_xiter(unsigned j,
 	return accum_lo;
 }
 
-template <int Taps>
-void resize_line8_h_u16_sse2(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
-                             const uint16_t * RESTRICT src, uint16_t * const * RESTRICT dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
+template <class Traits, int Taps>
+void resize_line8_h_int_sse2(const unsigned * RESTRICT filter_left, const int16_t * RESTRICT filter_data, unsigned filter_stride, unsigned filter_width,
+                             const uint16_t * RESTRICT src, typename Traits::pixel_type * const * RESTRICT dst, unsigned src_base, unsigned left, unsigned right, uint16_t limit)
 {
+	typedef typename Traits::pixel_type pixel_type;
+
 	unsigned vec_left = ceil_n(left, 8);
 	unsigned vec_right = floor_n(right, 8);
 
-	uint16_t *dst_p0 = dst[0];
-	uint16_t *dst_p1 = dst[1];
-	uint16_t *dst_p2 = dst[2];
-	uint16_t *dst_p3 = dst[3];
-	uint16_t *dst_p4 = dst[4];
-	uint16_t *dst_p5 = dst[5];
-	uint16_t *dst_p6 = dst[6];
-	uint16_t *dst_p7 = dst[7];
+	pixel_type *dst_p0 = dst[0];
+	pixel_type *dst_p1 = dst[1];
+	pixel_type *dst_p2 = dst[2];
+	pixel_type *dst_p3 = dst[3];
+	pixel_type *dst_p4 = dst[4];
+	pixel_type *dst_p5 = dst[5];
+	pixel_type *dst_p6 = dst[6];
+	pixel_type *dst_p7 = dst[7];
 
 #define XITER resize_line8_h_u16_sse2_xiter<Taps>
 #define XARGS filter_left, filter_data, filter_stride, filter_width, src, src_base, limit
 	for (unsigned j = left; j < vec_left; ++j) {
 		__m128i x = XITER(j, XARGS);
-		mm_scatter_epi16(dst_p0 + j, dst_p1 + j, dst_p2 + j, dst_p3 + j, dst_p4 + j, dst_p5 + j, dst_p6 + j, dst_p7 + j, x);
+		Traits::scatter8(dst_p0 + j, dst_p1 + j, dst_p2 + j, dst_p3 + j, dst_p4 + j, dst_p5 + j, dst_p6 + j, dst_p7 + j, x);
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 8) {
@@ -258,43 +375,45 @@ void resize_line8_h_u16_sse2(const unsigned * RESTRICT filter_left, const int16_
 
 		mm_transpose8_epi16(x0, x1, x2, x3, x4, x5, x6, x7);
 
-		_mm_store_si128((__m128i *)(dst_p0 + j), x0);
-		_mm_store_si128((__m128i *)(dst_p1 + j), x1);
-		_mm_store_si128((__m128i *)(dst_p2 + j), x2);
-		_mm_store_si128((__m128i *)(dst_p3 + j), x3);
-		_mm_store_si128((__m128i *)(dst_p4 + j), x4);
-		_mm_store_si128((__m128i *)(dst_p5 + j), x5);
-		_mm_store_si128((__m128i *)(dst_p6 + j), x6);
-		_mm_store_si128((__m128i *)(dst_p7 + j), x7);
+		Traits::store8(dst_p0 + j, x0);
+		Traits::store8(dst_p1 + j, x1);
+		Traits::store8(dst_p2 + j, x2);
+		Traits::store8(dst_p3 + j, x3);
+		Traits::store8(dst_p4 + j, x4);
+		Traits::store8(dst_p5 + j, x5);
+		Traits::store8(dst_p6 + j, x6);
+		Traits::store8(dst_p7 + j, x7);
 	}
 
 	for (unsigned j = vec_right; j < right; ++j) {
 		__m128i x = XITER(j, XARGS);
-		mm_scatter_epi16(dst_p0 + j, dst_p1 + j, dst_p2 + j, dst_p3 + j, dst_p4 + j, dst_p5 + j, dst_p6 + j, dst_p7 + j, x);
+		Traits::scatter8(dst_p0 + j, dst_p1 + j, dst_p2 + j, dst_p3 + j, dst_p4 + j, dst_p5 + j, dst_p6 + j, dst_p7 + j, x);
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line8_h_u16_sse2_jt_small = make_array(
-	resize_line8_h_u16_sse2<2>,
-	resize_line8_h_u16_sse2<2>,
-	resize_line8_h_u16_sse2<4>,
-	resize_line8_h_u16_sse2<4>,
-	resize_line8_h_u16_sse2<6>,
-	resize_line8_h_u16_sse2<6>,
-	resize_line8_h_u16_sse2<8>,
-	resize_line8_h_u16_sse2<8>);
-
-constexpr auto resize_line8_h_u16_sse2_jt_large = make_array(
-	resize_line8_h_u16_sse2<0>,
-	resize_line8_h_u16_sse2<-2>,
-	resize_line8_h_u16_sse2<-2>,
-	resize_line8_h_u16_sse2<-4>,
-	resize_line8_h_u16_sse2<-4>,
-	resize_line8_h_u16_sse2<-6>,
-	resize_line8_h_u16_sse2<-6>,
-	resize_line8_h_u16_sse2<0>);
+template <class Traits>
+constexpr auto resize_line8_h_int_sse2_jt_small = make_array(
+	resize_line8_h_int_sse2<Traits, 2>,
+	resize_line8_h_int_sse2<Traits, 2>,
+	resize_line8_h_int_sse2<Traits, 4>,
+	resize_line8_h_int_sse2<Traits, 4>,
+	resize_line8_h_int_sse2<Traits, 6>,
+	resize_line8_h_int_sse2<Traits, 6>,
+	resize_line8_h_int_sse2<Traits, 8>,
+	resize_line8_h_int_sse2<Traits, 8>);
+
+template <class Traits>
+constexpr auto resize_line8_h_int_sse2_jt_large = make_array(
+	resize_line8_h_int_sse2<Traits, 0>,
+	resize_line8_h_int_sse2<Traits, -2>,
+	resize_line8_h_int_sse2<Traits, -2>,
+	resize_line8_h_int_sse2<Traits, -4>,
+	resize_line8_h_int_sse2<Traits, -4>,
+	resize_line8_h_int_sse2<Traits, -6>,
+	resize_line8_h_int_sse2<Traits, -6>,
+	resize_line8_h_int_sse2<Traits, 0>);
 
 
 constexpr unsigned V_ACCUM_NONE = 0;
@@ -302,10 +421,10 @@ constexpr unsigned V_ACCUM_INITIAL = 1;
 constexpr unsigned V_ACCUM_UPDATE = 2;
 constexpr unsigned V_ACCUM_FINAL = 3;
 
-template <unsigned Taps, unsigned AccumMode>
-inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned accum_base,
-                                                         const uint16_t *src_p0, const uint16_t *src_p1, const uint16_t *src_p2, const uint16_t *src_p3,
-                                                         const uint16_t *src_p4, const uint16_t *src_p5, const uint16_t *src_p6, const uint16_t *src_p7,
+template <class Traits, unsigned Taps, unsigned AccumMode, class T = typename Traits::pixel_type>
+inline FORCE_INLINE __m128i resize_line_v_int_sse2_xiter(unsigned j, unsigned accum_base,
+                                                         const T *src_p0, const T *src_p1, const T *src_p2, const T *src_p3,
+                                                         const T *src_p4, const T *src_p5, const T *src_p6, const T *src_p7,
                                                          uint32_t * RESTRICT accum_p, const __m128i &c01, const __m128i &c23, const __m128i &c45, const __m128i &c67, uint16_t limit)
 {
 	static_assert(Taps >= 2 && Taps <= 8, "must have between 2-8 taps");
@@ -319,8 +438,8 @@ inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned ac
 	__m128i x0, x1, xl, xh;
 
 	if (Taps >= 2) {
-		x0 = _mm_load_si128((const __m128i *)(src_p0 + j));
-		x1 = _mm_load_si128((const __m128i *)(src_p1 + j));
+		x0 = Traits::load8(src_p0 + j);
+		x1 = Traits::load8(src_p1 + j);
 		x0 = _mm_add_epi16(x0, i16_min);
 		x1 = _mm_add_epi16(x1, i16_min);
 
@@ -338,8 +457,8 @@ inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned ac
 		}
 	}
 	if (Taps >= 4) {
-		x0 = _mm_load_si128((const __m128i *)(src_p2 + j));
-		x1 = _mm_load_si128((const __m128i *)(src_p3 + j));
+		x0 = Traits::load8(src_p2 + j);
+		x1 = Traits::load8(src_p3 + j);
 		x0 = _mm_add_epi16(x0, i16_min);
 		x1 = _mm_add_epi16(x1, i16_min);
 
@@ -352,8 +471,8 @@ inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned ac
 		accum_hi = _mm_add_epi32(accum_hi, xh);
 	}
 	if (Taps >= 6) {
-		x0 = _mm_load_si128((const __m128i *)(src_p4 + j));
-		x1 = _mm_load_si128((const __m128i *)(src_p5 + j));
+		x0 = Traits::load8(src_p4 + j);
+		x1 = Traits::load8(src_p5 + j);
 		x0 = _mm_add_epi16(x0, i16_min);
 		x1 = _mm_add_epi16(x1, i16_min);
 
@@ -366,8 +485,8 @@ inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned ac
 		accum_hi = _mm_add_epi32(accum_hi, xh);
 	}
 	if (Taps >= 8) {
-		x0 = _mm_load_si128((const __m128i *)(src_p6 + j));
-		x1 = _mm_load_si128((const __m128i *)(src_p7 + j));
+		x0 = Traits::load8(src_p6 + j);
+		x1 = Traits::load8(src_p7 + j);
 		x0 = _mm_add_epi16(x0, i16_min);
 		x1 = _mm_add_epi16(x1, i16_min);
 
@@ -393,17 +512,18 @@ inline FORCE_INLINE __m128i resize_line_v_u16_sse2_xiter(unsigned j, unsigned ac
 	}
 }
 
-template <unsigned Taps, unsigned AccumMode>
-void resize_line_v_u16_sse2(const int16_t * RESTRICT filter_data, const uint16_t * const * RESTRICT src, uint16_t * RESTRICT dst, uint32_t * RESTRICT accum, unsigned left, unsigned right, uint16_t limit)
+template <class Traits, unsigned Taps, unsigned AccumMode, class DstTraits = Traits,
+          class T = typename Traits::pixel_type, class U = typename DstTraits::pixel_type>
+void resize_line_v_int_sse2(const int16_t * RESTRICT filter_data, const T * const * RESTRICT src, U * RESTRICT dst, uint32_t * RESTRICT accum, unsigned left, unsigned right, uint16_t limit)
 {
-	const uint16_t * RESTRICT src_p0 = src[0];
-	const uint16_t * RESTRICT src_p1 = src[1];
-	const uint16_t * RESTRICT src_p2 = src[2];
-	const uint16_t * RESTRICT src_p3 = src[3];
-	const uint16_t * RESTRICT src_p4 = src[4];
-	const uint16_t * RESTRICT src_p5 = src[5];
-	const uint16_t * RESTRICT src_p6 = src[6];
-	const uint16_t * RESTRICT src_p7 = src[7];
+	const T * RESTRICT src_p0 = src[0];
+	const T * RESTRICT src_p1 = src[1];
+	const T * RESTRICT src_p2 = src[2];
+	const T * RESTRICT src_p3 = src[3];
+	const T * RESTRICT src_p4 = src[4];
+	const T * RESTRICT src_p5 = src[5];
+	const T * RESTRICT src_p6 = src[6];
+	const T * RESTRICT src_p7 = src[7];
 
 	unsigned vec_left = ceil_n(left, 8);
 	unsigned vec_right = floor_n(right, 8);
@@ -416,72 +536,80 @@ void resize_line_v_u16_sse2(const int16_t * RESTRICT filter_data, const uint16_t
 
 	__m128i out;
 
-#define XITER resize_line_v_u16_sse2_xiter<Taps, AccumMode>
+#define XITER resize_line_v_int_sse2_xiter<Traits, Taps, AccumMode>
 #define XARGS accum_base, src_p0, src_p1, src_p2, src_p3, src_p4, src_p5, src_p6, src_p7, accum, c01, c23, c45, c67, limit
 	if (left != vec_left) {
 		out = XITER(vec_left - 8, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			mm_store_idxhi_epi16((__m128i *)(dst + vec_left - 8), out, left % 8);
+			DstTraits::store_idxhi(dst + vec_left - 8, out, left % 8);
 	}
 
 	for (unsigned j = vec_left; j < vec_right; j += 8) {
 		out = XITER(j, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			_mm_store_si128((__m128i *)(dst + j), out);
+			DstTraits::store8(dst + j, out);
 	}
 
 	if (right != vec_right) {
 		out = XITER(vec_right, XARGS);
 
 		if (AccumMode == V_ACCUM_NONE || AccumMode == V_ACCUM_FINAL)
-			mm_store_idxlo_epi16((__m128i *)(dst + vec_right), out, right % 8);
+			DstTraits::store_idxlo(dst + vec_right, out, right % 8);
 	}
 #undef XITER
 #undef XARGS
 }
 
-constexpr auto resize_line_v_u16_sse2_jt_small = make_array(
-	resize_line_v_u16_sse2<2, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<2, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<4, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<4, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<6, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<6, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<8, V_ACCUM_NONE>,
-	resize_line_v_u16_sse2<8, V_ACCUM_NONE>);
-
-constexpr auto resize_line_v_u16_sse2_initial = resize_line_v_u16_sse2<8, V_ACCUM_INITIAL>;
-constexpr auto resize_line_v_u16_sse2_update = resize_line_v_u16_sse2<8, V_ACCUM_UPDATE>;
-
-constexpr auto resize_line_v_u16_sse2_jt_final = make_array(
-	resize_line_v_u16_sse2<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<2, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<4, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<6, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<8, V_ACCUM_FINAL>,
-	resize_line_v_u16_sse2<8, V_ACCUM_FINAL>);
-
-
-class ResizeImplH_U16_SSE2 : public ResizeImplH {
-	decltype(resize_line8_h_u16_sse2_jt_small)::value_type m_func;
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_sse2_jt_small = make_array(
+	resize_line_v_int_sse2<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 2, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 4, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 6, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 8, V_ACCUM_NONE, DstTraits>,
+	resize_line_v_int_sse2<Traits, 8, V_ACCUM_NONE, DstTraits>);
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_sse2_initial = resize_line_v_int_sse2<Traits, 8, V_ACCUM_INITIAL, DstTraits>;
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_sse2_update = resize_line_v_int_sse2<Traits, 8, V_ACCUM_UPDATE, DstTraits>;
+
+template <class Traits, class DstTraits = Traits>
+constexpr auto resize_line_v_int_sse2_jt_final = make_array(
+	resize_line_v_int_sse2<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 2, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 4, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 6, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 8, V_ACCUM_FINAL, DstTraits>,
+	resize_line_v_int_sse2<Traits, 8, V_ACCUM_FINAL, DstTraits>);
+
+
+template <class Traits, class DstTraits = Traits>
+class ResizeImplH_Int_SSE2 : public ResizeImplH {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
+	typename decltype(resize_line8_h_int_sse2_jt_small<DstTraits>)::value_type m_func;
 	uint16_t m_pixel_max;
 public:
-	ResizeImplH_U16_SSE2(const FilterContext &filter, unsigned height, unsigned depth) try :
-		ResizeImplH(filter, height, PixelType::WORD),
+	ResizeImplH_Int_SSE2(const std::shared_ptr<const FilterContext> &filter, unsigned height, unsigned depth) try :
+		ResizeImplH(filter, height, DstTraits::type_constant),
 		m_func{},
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		m_desc.step = 8;
-		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter.input_width }, 8) * sizeof(uint16_t) * 8).get();
+		m_desc.scratchpad_size = (ceil_n(checked_size_t{ filter->input_width }, 8) * sizeof(uint16_t) * 8).get();
 
-		if (filter.filter_width <= 8)
-			m_func = resize_line8_h_u16_sse2_jt_small[filter.filter_width - 1];
+		if (filter->filter_width <= 8)
+			m_func = resize_line8_h_int_sse2_jt_small<DstTraits>[filter->filter_width - 1];
 		else
-			m_func = resize_line8_h_u16_sse2_jt_large[filter.filter_width % 8];
+			m_func = resize_line8_h_int_sse2_jt_large<DstTraits>[filter->filter_width % 8];
 	} catch (const std::overflow_error &) {
 		error::throw_<error::OutOfMemory>();
 	}
@@ -491,19 +619,19 @@ public:
 	{
 		auto range = get_col_deps(left, right);
 
-		const uint16_t *src_ptr[8] = { 0 };
-		uint16_t *dst_ptr[8] = { 0 };
+		const pixel_type *src_ptr[8] = { 0 };
+		dst_pixel_type *dst_ptr[8] = { 0 };
 		uint16_t *transpose_buf = static_cast<uint16_t *>(tmp);
 		unsigned height = m_desc.format.height;
 
 		for (unsigned n = 0; n < 8; ++n) {
-			src_ptr[n] = in->get_line<uint16_t>(std::min(i + n, height - 1));
+			src_ptr[n] = in->get_line<pixel_type>(std::min(i + n, height - 1));
 		}
 
-		transpose_line_8x8_epi16(transpose_buf, src_ptr, floor_n(range.first, 8), ceil_n(range.second, 8));
+		transpose_line_8x8<Traits>(transpose_buf, src_ptr, floor_n(range.first, 8), ceil_n(range.second, 8));
 
 		for (unsigned n = 0; n < 8; ++n) {
-			dst_ptr[n] = out->get_line<uint16_t>(std::min(i + n, height - 1));
+			dst_ptr[n] = out->get_line<dst_pixel_type>(std::min(i + n, height - 1));
 		}
 
 		m_func(m_filter.left.data(), m_filter.data_i16.data(), m_filter.stride_i16, m_filter.filter_width,
@@ -512,11 +640,15 @@ public:
 };
 
 
-class ResizeImplV_U16_SSE2 : public ResizeImplV {
+template <class Traits, class DstTraits = Traits>
+class ResizeImplV_Int_SSE2 : public ResizeImplV {
+	typedef typename Traits::pixel_type pixel_type;
+	typedef typename DstTraits::pixel_type dst_pixel_type;
+
 	uint16_t m_pixel_max;
 public:
-	ResizeImplV_U16_SSE2(const FilterContext &filter, unsigned width, unsigned depth) try :
-		ResizeImplV(filter, width, PixelType::WORD),
+	ResizeImplV_Int_SSE2(const std::shared_ptr<const FilterContext> &filter, unsigned width, unsigned depth) try :
+		ResizeImplV(filter, width, DstTraits::type_constant),
 		m_pixel_max{ static_cast<uint16_t>((1UL << depth) - 1) }
 	{
 		if (m_filter.filter_width > 8)
@@ -528,12 +660,12 @@ public:
 	void process(const graphengine::BufferDescriptor *in, const graphengine::BufferDescriptor *out,
 	             unsigned i, unsigned left, unsigned right, void *, void *tmp) const noexcept override
 	{
-		const int16_t *filter_data = m_filter.data_i16.data() + i * m_filter.stride_i16;
+		const int16_t *filter_data = m_filter.row_i16(i);
 		unsigned filter_width = m_filter.filter_width;
 		unsigned src_height = m_filter.input_width;
 
-		const uint16_t *src_lines[8] = { 0 };
-		uint16_t *dst_line = out->get_line<uint16_t>(i);
+		const pixel_type *src_lines[8] = { 0 };
+		dst_pixel_type *dst_line = out->get_line<dst_pixel_type>(i);
 		uint32_t *accum_buf = static_cast<uint32_t *>(tmp);
 
 		unsigned top = m_filter.left[i];
@@ -541,27 +673,27 @@ public:
 		auto gather_8_lines = [&](unsigned i)
 		{
 			for (unsigned n = 0; n < 8; ++n) {
-				src_lines[n] = in->get_line<uint16_t>(std::min(i + n, src_height - 1));
+				src_lines[n] = in->get_line<pixel_type>(std::min(i + n, src_height - 1));
 			}
 		};
 
 #define XARGS src_lines, dst_line, accum_buf, left, right, m_pixel_max
 		if (filter_width <= 8) {
 			gather_8_lines(top);
-			resize_line_v_u16_sse2_jt_small[filter_width - 1](filter_data, XARGS);
+			resize_line_v_int_sse2_jt_small<Traits, DstTraits>[filter_width - 1](filter_data, XARGS);
 		} else {
 			unsigned k_end = ceil_n(filter_width, 8) - 8;
 
 			gather_8_lines(top);
-			resize_line_v_u16_sse2_initial(filter_data + 0, XARGS);
+			resize_line_v_int_sse2_initial<Traits, DstTraits>(filter_data + 0, XARGS);
 
 			for (unsigned k = 8; k < k_end; k += 8) {
 				gather_8_lines(top + k);
-				resize_line_v_u16_sse2_update(filter_data + k, XARGS);
+				resize_line_v_int_sse2_update<Traits, DstTraits>(filter_data + k, XARGS);
 			}
 
 			gather_8_lines(top + k_end);
-			resize_line_v_u16_sse2_jt_final[filter_width % 8](filter_data + k_end, XARGS);
+			resize_line_v_int_sse2_jt_final<Traits, DstTraits>[filter_width - k_end - 1](filter_data + k_end, XARGS);
 		}
 #undef XARGS
 	}
@@ -570,22 +702,50 @@ public:
 } // namespace
 
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_sse2(const FilterContext &context, unsigned height, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_sse2(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplH_Int_SSE2<u8_traits>>(context, height, depth);
+	else if (type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplH_Int_SSE2<u16_traits>>(context, height, depth);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_sse2(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth)
+{
+	std::unique_ptr<graphengine::Filter> ret;
+
+	if (type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_SSE2<u8_traits>>(context, width, depth);
+	else if (type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_SSE2<u16_traits>>(context, width, depth);
+
+	return ret;
+}
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_sse2(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
-	if (type == PixelType::WORD)
-		ret = std::make_unique<ResizeImplH_U16_SSE2>(context, height, depth);
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplH_Int_SSE2<u8_wide_traits, u16_traits>>(context, height, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplH_Int_SSE2<u16_traits, u8_narrow_traits>>(context, height, 16);
 
 	return ret;
 }
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_sse2(const FilterContext &context, unsigned width, PixelType type, unsigned depth)
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_sse2(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type)
 {
 	std::unique_ptr<graphengine::Filter> ret;
 
-	if (type == PixelType::WORD)
-		ret = std::make_unique<ResizeImplV_U16_SSE2>(context, width, depth);
+	if (type == PixelType::BYTE && dst_type == PixelType::WORD)
+		ret = std::make_unique<ResizeImplV_Int_SSE2<u8_wide_traits, u16_traits>>(context, width, 16);
+	else if (type == PixelType::WORD && dst_type == PixelType::BYTE)
+		ret = std::make_unique<ResizeImplV_Int_SSE2<u16_traits, u8_narrow_traits>>(context, width, 16);
 
 	return ret;
 }
@@ -21,9 +21,9 @@ namespace resize {
 struct FilterContext;
 
 #define DECLARE_IMPL_H(cpu) \
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_##cpu(const FilterContext &context, unsigned height, PixelType type, unsigned depth);
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_##cpu(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth);
 #define DECLARE_IMPL_V(cpu) \
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_##cpu(const FilterContext &context, unsigned width, PixelType type, unsigned depth);
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_##cpu(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth);
 
 DECLARE_IMPL_H(sse)
 DECLARE_IMPL_H(sse2)
@@ -31,6 +31,7 @@ DECLARE_IMPL_H(avx)
 DECLARE_IMPL_H(avx2)
 DECLARE_IMPL_H(avx512)
 DECLARE_IMPL_H(avx512_vnni)
+DECLARE_IMPL_H(decimate_avx2)
 
 DECLARE_IMPL_V(sse)
 DECLARE_IMPL_V(sse2)
@@ -39,11 +40,31 @@ DECLARE_IMPL_V(avx2)
 DECLARE_IMPL_V(avx512)
 DECLARE_IMPL_V(avx512_vnni)
 
+#define DECLARE_IMPL_H_MIXED(cpu) \
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_##cpu(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type);
+#define DECLARE_IMPL_V_MIXED(cpu) \
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_##cpu(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type);
+
+DECLARE_IMPL_H_MIXED(sse2)
+DECLARE_IMPL_H_MIXED(avx2)
+DECLARE_IMPL_H_MIXED(avx512)
+DECLARE_IMPL_H_MIXED(avx512_vnni)
+
+DECLARE_IMPL_V_MIXED(sse2)
+DECLARE_IMPL_V_MIXED(avx2)
+DECLARE_IMPL_V_MIXED(avx512)
+DECLARE_IMPL_V_MIXED(avx512_vnni)
+
 #undef DECLARE_IMPL_H
 #undef DECLARE_IMPL_V
+#undef DECLARE_IMPL_H_MIXED
+#undef DECLARE_IMPL_V_MIXED
+
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_x86(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, unsigned depth, CPUClass cpu);
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_x86(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, unsigned depth, CPUClass cpu);
 
-std::unique_ptr<graphengine::Filter> create_resize_impl_h_x86(const FilterContext &context, unsigned height, PixelType type, unsigned depth, CPUClass cpu);
-std::unique_ptr<graphengine::Filter> create_resize_impl_v_x86(const FilterContext &context, unsigned width, PixelType type, unsigned depth, CPUClass cpu);
+std::unique_ptr<graphengine::Filter> create_resize_impl_h_mixed_x86(const std::shared_ptr<const FilterContext> &context, unsigned height, PixelType type, PixelType dst_type, CPUClass cpu);
+std::unique_ptr<graphengine::Filter> create_resize_impl_v_mixed_x86(const std::shared_ptr<const FilterContext> &context, unsigned width, PixelType type, PixelType dst_type, CPUClass cpu);
 
 } // namespace resize
 } // namespace zimg
@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <string>
+#include <vector>
 #include "api/zimg.h"
+#include "common/alloc.h"
 
 #include "gtest/gtest.h"
 
@@ -70,3 +75,371 @@ TEST(APITest, test_api_2_3_compat)
 		EXPECT_EQ(0xCC, *(reinterpret_cast<unsigned char *>(&format) + i));
 	}
 }
+
+TEST(APITest, test_graph_cache)
+{
+	const unsigned API_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, API_2_5);
+	src_format.width = 640;
+	src_format.height = 480;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = 320;
+	dst_format.height = 240;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, API_2_5);
+
+	auto get_stats = []()
+	{
+		zimg_graph_cache_stats stats;
+		zimg_graph_cache_get_stats(&stats, ZIMG_MAKE_API_VERSION(2, 5));
+		return stats;
+	};
+
+	zimg_graph_cache_set_capacity(1);
+	zimg_graph_cache_clear();
+	zimg_graph_cache_stats base = get_stats();
+	EXPECT_EQ(1U, base.capacity);
+	EXPECT_EQ(0U, base.size);
+
+	zimg_filter_graph *graph1 = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph1);
+	EXPECT_EQ(base.misses + 1, get_stats().misses);
+
+	// Explicit default parameters are equivalent to the defaults.
+	params.filter_param_a = 0.0;
+	params.filter_param_b = 0.5;
+	zimg_filter_graph *graph2 = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph2);
+	EXPECT_EQ(base.hits + 1, get_stats().hits);
+
+	// Evict the first graph. Existing handles remain valid.
+	zimg_filter_graph *graph3 = zimg_filter_graph_build(&src_format, &src_format, &params);
+	ASSERT_TRUE(graph3);
+	EXPECT_EQ(base.misses + 2, get_stats().misses);
+	EXPECT_EQ(base.evictions + 1, get_stats().evictions);
+	EXPECT_EQ(1U, get_stats().size);
+
+	size_t tmp_size;
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph1, &tmp_size));
+	zimg_filter_graph_free(graph1);
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph2, &tmp_size));
+	zimg_filter_graph_free(graph2);
+	zimg_filter_graph_free(graph3);
+
+	zimg_graph_cache_set_capacity(0);
+	EXPECT_EQ(0U, get_stats().size);
+	EXPECT_EQ(0U, get_stats().capacity);
+
+	zimg_filter_graph *graph4 = zimg_filter_graph_build(&src_format, &src_format, &params);
+	ASSERT_TRUE(graph4);
+	EXPECT_EQ(base.misses + 2, get_stats().misses);
+	zimg_filter_graph_free(graph4);
+}
+
+TEST(APITest, test_filter_stats)
+{
+	const unsigned API_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, API_2_5);
+	src_format.width = 64;
+	src_format.height = 48;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+	src_format.color_family = ZIMG_COLOR_GREY;
+
+	zimg_image_format dst_format = src_format;
+	dst_format.width = 32;
+
+	zimg_graph_builder_params params;
+	zimg_graph_builder_params_default(&params, API_2_5);
+	params.enable_profiling = 1;
+
+	zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, &params);
+	ASSERT_TRUE(graph);
+
+	size_t tmp_size;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+	zimg::AlignedVector<unsigned char> tmp(tmp_size);
+	zimg::AlignedVector<unsigned char> src_data(64 * 48);
+	zimg::AlignedVector<unsigned char> dst_data(64 * 48);
+
+	zimg_image_buffer_const src_buf = {};
+	src_buf.version = API_2_5;
+	src_buf.plane[0].data = src_data.data();
+	src_buf.plane[0].stride = 64;
+	src_buf.plane[0].mask = ZIMG_BUFFER_MAX;
+
+	zimg_image_buffer dst_buf = {};
+	dst_buf.version = API_2_5;
+	dst_buf.plane[0].data = dst_data.data();
+	dst_buf.plane[0].stride = 64;
+	dst_buf.plane[0].mask = ZIMG_BUFFER_MAX;
+
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_reset_stats(graph));
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &src_buf, &dst_buf, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+
+	unsigned count = 0;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_stats(graph, nullptr, &count, API_2_5));
+	ASSERT_GE(count, 1U);
+
+	std::vector<zimg_filter_stats> stats(count);
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_stats(graph, stats.data(), &count, API_2_5));
+	ASSERT_EQ(stats.size(), count);
+
+	for (const zimg_filter_stats &node : stats) {
+		EXPECT_EQ(API_2_5, node.version);
+		EXPECT_GT(node.calls, 0U);
+	}
+
+	auto it = std::find_if(stats.begin(), stats.end(), [](const zimg_filter_stats &node) { return std::string{ node.name } == "resize"; });
+	ASSERT_NE(stats.end(), it);
+	EXPECT_EQ(32U * 48, it->pixels);
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_resize_byte_accuracy)
+{
+	const unsigned API_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+	const unsigned src_w = 64;
+	const unsigned src_h = 48;
+	const unsigned stride = 256;
+
+	zimg::AlignedVector<unsigned char> src_data(stride * src_h);
+	for (size_t i = 0; i < src_data.size(); ++i) {
+		src_data[i] = static_cast<unsigned char>((i * 37) ^ (i >> 6));
+	}
+
+	auto convert = [&](unsigned width, unsigned height, zimg_pixel_type_e pixel_type, void *data)
+	{
+		zimg_image_format src_format;
+		zimg_image_format_default(&src_format, API_2_5);
+		src_format.width = src_w;
+		src_format.height = src_h;
+		src_format.pixel_type = ZIMG_PIXEL_BYTE;
+		src_format.color_family = ZIMG_COLOR_GREY;
+
+		zimg_image_format dst_format = src_format;
+		dst_format.width = width;
+		dst_format.height = height;
+		dst_format.pixel_type = pixel_type;
+		dst_format.depth = pixel_type == ZIMG_PIXEL_BYTE ? 8 : 16;
+
+		zimg_filter_graph *graph = zimg_filter_graph_build(&src_format, &dst_format, nullptr);
+		ASSERT_TRUE(graph);
+
+		size_t tmp_size;
+		ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+		zimg::AlignedVector<unsigned char> tmp(tmp_size);
+
+		zimg_image_buffer_const src_buf = {};
+		src_buf.version = API_2_5;
+		src_buf.plane[0].data = src_data.data();
+		src_buf.plane[0].stride = stride;
+		src_buf.plane[0].mask = ZIMG_BUFFER_MAX;
+
+		zimg_image_buffer dst_buf = {};
+		dst_buf.version = API_2_5;
+		dst_buf.plane[0].data = data;
+		dst_buf.plane[0].stride = stride * (pixel_type == ZIMG_PIXEL_BYTE ? 1 : 2);
+		dst_buf.plane[0].mask = ZIMG_BUFFER_MAX;
+
+		EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process(graph, &src_buf, &dst_buf, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+		zimg_filter_graph_free(graph);
+	};
+
+	// Resizing 8-bit data must be as accurate as resizing it at 16 bits and rounding once.
+	const unsigned dims[][2] = { { 96, 48 }, { 64, 72 }, { 96, 72 }, { 40, 30 } };
+
+	for (const auto &dim : dims) {
+		SCOPED_TRACE(dim[0]);
+		SCOPED_TRACE(dim[1]);
+
+		zimg::AlignedVector<uint8_t> dst_byte(stride * dim[1]);
+		zimg::AlignedVector<uint16_t> dst_word(stride * dim[1]);
+		convert(dim[0], dim[1], ZIMG_PIXEL_BYTE, dst_byte.data());
+		convert(dim[0], dim[1], ZIMG_PIXEL_WORD, dst_word.data());
+
+		for (unsigned y = 0; y < dim[1]; ++y) {
+			for (unsigned x = 0; x < dim[0]; ++x) {
+				// Overshoot above 255 is representable in WORD, but not in BYTE.
+				double expected = std::min(dst_word[y * stride + x] / 256.0, 255.0);
+				ASSERT_LE(std::fabs(dst_byte[y * stride + x] - expected), 0.5 + 1.0 / 256.0) << "pixel " << x << ", " << y;
+			}
+		}
+	}
+}
+
+TEST(APITest, test_build_multi)
+{
+	const unsigned API_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, API_2_5);
+	src_format.width = 64;
+	src_format.height = 48;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+	src_format.color_family = ZIMG_COLOR_YUV;
+	src_format.matrix_coefficients = ZIMG_MATRIX_BT709;
+	src_format.transfer_characteristics = ZIMG_TRANSFER_BT709;
+	src_format.color_primaries = ZIMG_PRIMARIES_BT709;
+
+	// The first target uses the same colorspace constants as the source.
+	zimg_image_format yuv_format = src_format;
+	yuv_format.width = 32;
+	yuv_format.height = 24;
+
+	zimg_image_format rgb_format = src_format;
+	rgb_format.color_family = ZIMG_COLOR_RGB;
+	rgb_format.matrix_coefficients = ZIMG_MATRIX_RGB;
+
+	const zimg_image_format *dst_formats[] = { &yuv_format, &rgb_format };
+
+	EXPECT_FALSE(zimg_filter_graph_build_multi(&src_format, dst_formats, 0, nullptr));
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_get_last_error(nullptr, 0));
+	EXPECT_FALSE(zimg_filter_graph_build_multi(&src_format, dst_formats, 17, nullptr));
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_get_last_error(nullptr, 0));
+	zimg_clear_last_error();
+
+	zimg_filter_graph *graph = zimg_filter_graph_build_multi(&src_format, dst_formats, 2, nullptr);
+	ASSERT_TRUE(graph);
+
+	size_t tmp_size;
+	ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+
+	zimg::AlignedVector<unsigned char> src_data(64 * 48 * 3);
+	zimg::AlignedVector<unsigned char> yuv_data(64 * 24 * 3);
+	zimg::AlignedVector<unsigned char> rgb_data(64 * 48 * 3);
+	zimg::AlignedVector<unsigned char> tmp(tmp_size);
+
+	auto init_buffer = [](auto &buffer, unsigned char *data, unsigned stride, unsigned height)
+	{
+		buffer.version = ZIMG_MAKE_API_VERSION(2, 5);
+		for (unsigned p = 0; p < 3; ++p) {
+			buffer.plane[p].data = data + p * stride * height;
+			buffer.plane[p].stride = stride;
+			buffer.plane[p].mask = ZIMG_BUFFER_MAX;
+		}
+	};
+
+	zimg_image_buffer_const src_buf = {};
+	zimg_image_buffer yuv_buf = {};
+	zimg_image_buffer rgb_buf = {};
+	init_buffer(src_buf, src_data.data(), 64, 48);
+	init_buffer(yuv_buf, yuv_data.data(), 64, 24);
+	init_buffer(rgb_buf, rgb_data.data(), 64, 48);
+	const zimg_image_buffer *dst_bufs[] = { &yuv_buf, &rgb_buf };
+
+	EXPECT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process_multi(graph, &src_buf, dst_bufs, 2, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_filter_graph_process_multi(graph, &src_buf, dst_bufs, 1, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+	EXPECT_EQ(ZIMG_ERROR_ILLEGAL_ARGUMENT, zimg_filter_graph_process(graph, &src_buf, &yuv_buf, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+
+	zimg_filter_graph_free(graph);
+}
+
+TEST(APITest, test_build_pyramid)
+{
+	const unsigned API_2_5 = ZIMG_MAKE_API_VERSION(2, 5);
+	const unsigned num_levels = 3;
+
+	zimg_image_format src_format;
+	zimg_image_format_default(&src_format, API_2_5);
+	src_format.width = 64;
+	src_format.height = 48;
+	src_format.pixel_type = ZIMG_PIXEL_BYTE;
+	src_format.color_family = ZIMG_COLOR_GREY;
+
+	zimg_image_format level_format[num_levels];
+	for (unsigned i = 0; i < num_levels; ++i) {
+		level_format[i] = src_format;
+		level_format[i].width = src_format.width >> (i + 1);
+		level_format[i].height = src_format.height >> (i + 1);
+	}
+
+	zimg_filter_graph *graph = zimg_filter_graph_build_pyramid(&src_format, &level_format[0], num_levels, nullptr);
+	ASSERT_TRUE(graph);
+
+	auto init_buffer = [](auto &buffer, unsigned char *data, unsigned stride)
+	{
+		buffer.version = ZIMG_MAKE_API_VERSION(2, 5);
+		buffer.plane[0].data = data;
+		buffer.plane[0].stride = stride;
+		buffer.plane[0].mask = ZIMG_BUFFER_MAX;
+	};
+
+	auto process = [](const zimg_filter_graph *graph, const zimg_image_buffer_const &src, const zimg_image_buffer * const dst[], unsigned num_outputs)
+	{
+		size_t tmp_size;
+		ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_get_tmp_size(graph, &tmp_size));
+
+		zimg::AlignedVector<unsigned char> tmp(tmp_size);
+		ASSERT_EQ(ZIMG_ERROR_SUCCESS, zimg_filter_graph_process_multi(graph, &src, dst, num_outputs, tmp.data(), nullptr, nullptr, nullptr, nullptr));
+	};
+
+	zimg::AlignedVector<unsigned char> src_data(64 * 48);
+	for (size_t i = 0; i < src_data.size(); ++i) {
+		src_data[i] = static_cast<unsigned char>((i * 37) ^ (i >> 6));
+	}
+
+	zimg::AlignedVector<unsigned char> level_data[num_levels];
+	zimg_image_buffer level_buf[num_levels] = {};
+	const zimg_image_buffer *dst_bufs[num_levels];
+
+	for (unsigned i = 0; i < num_levels; ++i) {
+		level_data[i].resize(64 * level_format[i].height);
+		init_buffer(level_buf[i], level_data[i].data(), 64);
+		dst_bufs[i] = &level_buf[i];
+	}
+
+	zimg_image_buffer_const src_buf = {};
+	init_buffer(src_buf, src_data.data(), 64);
+	process(graph, src_buf, dst_bufs, num_levels);
+	zimg_filter_graph_free(graph);
+
+	// Each level must match a separate conversion from the level before it.
+	for (unsigned i = 0; i < num_levels; ++i) {
+		SCOPED_TRACE(i);
+
+		const zimg_image_format &prev_format = i ? level_format[i - 1] : src_format;
+		zimg_image_buffer_const prev_buf = {};
+		init_buffer(prev_buf, i ? level_data[i - 1].data() : src_data.data(), 64);
+
+		zimg::AlignedVector<unsigned char> expected(64 * level_format[i].height);
+		zimg_image_buffer expected_buf = {};
+		init_buffer(expected_buf, expected.data(), 64);
+		const zimg_image_buffer *expected_bufs[] = { &expected_buf };
+
+		zimg_filter_graph *single = zimg_filter_graph_build(&prev_format, &level_format[i], nullptr);
+		ASSERT_TRUE(single);
+		process(single, prev_buf, expected_bufs, 1);
+		zimg_filter_graph_free(single);
+
+		for (unsigned y = 0; y < level_format[i].height; ++y) {
+			for (unsigned x = 0; x < level_format[i].width; ++x) {
+				ASSERT_EQ(expected[y * 64 + x], level_data[i][y * 64 + x]) << "pixel " << x << ", " << y;
+			}
+		}
+	}
+
+	EXPECT_FALSE(zimg_filter_graph_build_pyramid(&src_format, &level_format[0], 17, nullptr));
+
+	// Odd level dimensions are rounded down to the chroma subsampling.
+	zimg_image_format yuv_format;
+	zimg_image_format_default(&yuv_format, API_2_5);
+	yuv_format.width = 1920;
+	yuv_format.height = 1080;
+	yuv_format.pixel_type = ZIMG_PIXEL_BYTE;
+	yuv_format.subsample_w = 1;
+	yuv_format.subsample_h = 1;
+	yuv_format.color_family = ZIMG_COLOR_YUV;
+	yuv_format.matrix_coefficients = ZIMG_MATRIX_BT709;
+
+	graph = zimg_filter_graph_build_pyramid(&yuv_format, &yuv_format, 8, nullptr);
+	EXPECT_TRUE(graph);
+	zimg_filter_graph_free(graph);
+}
@@ -1,5 +1,11 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "common/cpuinfo.h"
+#include "common/except.h"
 #include "common/pixel.h"
 #include "colorspace/colorspace.h"
+#include "colorspace/graph.h"
 #include "graphengine/filter.h"
 
 #include "gtest/gtest.h"
@@ -33,6 +39,74 @@ void test_case(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg:
 		.run();
 }
 
+// Converts a single row of 8-bit pixels with the integer matrix path.
+std::vector<uint8_t> convert_integer_row(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out,
+                                         const zimg::PixelFormat &format_in, const zimg::PixelFormat &format_out, const std::vector<uint8_t> &src)
+{
+	const unsigned w = static_cast<unsigned>(src.size() / 3);
+
+	auto filter = zimg::colorspace::ColorspaceConversion{ w, 1 }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out)
+		.set_pixel_in(format_in)
+		.set_pixel_out(format_out)
+		.set_cpu(zimg::CPUClass::NONE)
+		.create();
+	if (!filter)
+		return {};
+
+	std::vector<uint8_t> src_planes(src.size());
+	std::vector<uint8_t> dst_planes(src.size());
+
+	for (unsigned j = 0; j < w; ++j) {
+		for (unsigned p = 0; p < 3; ++p) {
+			src_planes[p * w + j] = src[j * 3 + p];
+		}
+	}
+
+	graphengine::BufferDescriptor in[3];
+	graphengine::BufferDescriptor out[3];
+	for (unsigned p = 0; p < 3; ++p) {
+		in[p] = { src_planes.data() + p * w, static_cast<ptrdiff_t>(w), graphengine::BUFFER_MAX };
+		out[p] = { dst_planes.data() + p * w, static_cast<ptrdiff_t>(w), graphengine::BUFFER_MAX };
+	}
+	filter->process(in, out, 0, 0, w, nullptr, nullptr);
+
+	std::vector<uint8_t> dst(src.size());
+	for (unsigned j = 0; j < w; ++j) {
+		for (unsigned p = 0; p < 3; ++p) {
+			dst[j * 3 + p] = dst_planes[p * w + j];
+		}
+	}
+	return dst;
+}
+
+// Converts a single row of float pixels, one plane after another.
+std::vector<float> convert_float_row(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out, const std::vector<float> &src)
+{
+	const unsigned w = static_cast<unsigned>(src.size() / 3);
+
+	auto filter = zimg::colorspace::ColorspaceConversion{ w, 1 }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out)
+		.set_cpu(zimg::CPUClass::NONE)
+		.create();
+	if (!filter)
+		return {};
+
+	std::vector<float> dst(src.size());
+
+	graphengine::BufferDescriptor in[3];
+	graphengine::BufferDescriptor out[3];
+	for (unsigned p = 0; p < 3; ++p) {
+		in[p] = { const_cast<float *>(src.data()) + p * w, static_cast<ptrdiff_t>(w * sizeof(float)), graphengine::BUFFER_MAX };
+		out[p] = { dst.data() + p * w, static_cast<ptrdiff_t>(w * sizeof(float)), graphengine::BUFFER_MAX };
+	}
+	filter->process(in, out, 0, 0, w, nullptr, nullptr);
+
+	return dst;
+}
+
 } // namespace
 
 
@@ -63,9 +137,9 @@ TEST(ColorspaceConversionTest, test_matrix_only)
 			"cf8fbed8b60ae7328d43d06523ab25eab1095316"
 		},
 		{
-			"b189703d18508db5e1fa374e7403415728dfaf51",
-			"b81c2d5cf5251aad96797ec0025fe56b2c676853",
-			"03d20fd3a89fa681a461491a2558734636bd7e9b"
+			"eb59e3f589c50e3c2b6f54215207d1471f9b87e2",
+			"997dbbded68c9297d858d01380cb3ca7b86f690b",
+			"29d20c5ef6ead470a2f6fc081ef4ea929e3130f9"
 		},
 		{
 			"3732b8f5fb4b5282ab1912a689f3d25cf5651bcb",
@@ -421,3 +495,224 @@ TEST(ColorspaceConversionTest, test_rec2100_ictcp)
 	}
 }
 
+TEST(ColorspaceConversionTest, test_integer_matrix)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::REC_709, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const zimg::PixelFormat format_rgb{ zimg::PixelType::BYTE, 8, true, false };
+	const zimg::PixelFormat format_yuv{ zimg::PixelType::BYTE, 8, false, true };
+
+	{
+		SCOPED_TRACE("709->rgb");
+		// Black, white, BT.709 red, and out-of-range values that must be clamped.
+		const std::vector<uint8_t> src = { 16, 128, 128, 235, 128, 128, 63, 102, 240, 0, 0, 0, 255, 255, 255 };
+		const std::vector<uint8_t> expected = { 0, 0, 0, 255, 255, 255, 255, 1, 0, 0, 77, 0, 255, 184, 255 };
+
+		std::vector<uint8_t> dst = convert_integer_row(csp_709, csp_rgb, format_yuv, format_rgb, src);
+		ASSERT_EQ(expected.size(), dst.size());
+
+		for (size_t i = 0; i < expected.size(); ++i) {
+			SCOPED_TRACE(i);
+			EXPECT_NEAR(expected[i], dst[i], 1);
+		}
+	}
+	{
+		SCOPED_TRACE("rgb->709");
+		const std::vector<uint8_t> src = { 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255 };
+		const std::vector<uint8_t> expected = { 16, 128, 128, 235, 128, 128, 63, 102, 240, 173, 42, 26, 32, 240, 118 };
+
+		std::vector<uint8_t> dst = convert_integer_row(csp_rgb, csp_709, format_rgb, format_yuv, src);
+		ASSERT_EQ(expected.size(), dst.size());
+
+		for (size_t i = 0; i < expected.size(); ++i) {
+			SCOPED_TRACE(i);
+			EXPECT_EQ(expected[i], dst[i]);
+		}
+	}
+}
+
+TEST(ColorspaceConversionTest, test_lut3d)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_709_yuv{ MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	const ColorspaceDefinition csp_709_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	const ColorspaceDefinition csp_2020_pq{ MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::ST_2084, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_2020_pq_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::ST_2084, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_linear{ MatrixCoefficients::RGB, TransferCharacteristics::LINEAR, ColorPrimaries::REC_709 };
+
+	{
+		SCOPED_TRACE("matrix only");
+		// Affine conversions are reproduced exactly by tetrahedral interpolation.
+		auto conv = ColorspaceConversion{ 640, 480 }
+			.set_csp_in(csp_709_yuv)
+			.set_csp_out(csp_709_rgb)
+			.set_cpu(zimg::CPUClass::NONE)
+			.set_lut_size(2);
+		Lut3DAccuracy accuracy = measure_lut3d_accuracy(conv, 33);
+		EXPECT_EQ(33ULL * 33 * 33, accuracy.num_samples);
+		EXPECT_LT(accuracy.max_error, 1e-5);
+	}
+	{
+		SCOPED_TRACE("st2084->709");
+		// Sample between the nodes of both tables.
+		auto conv = ColorspaceConversion{ 640, 480 }
+			.set_csp_in(csp_2020_pq_rgb)
+			.set_csp_out(csp_709_rgb)
+			.set_cpu(zimg::CPUClass::NONE);
+
+		Lut3DAccuracy coarse = measure_lut3d_accuracy(conv.set_lut_size(17), 50);
+		Lut3DAccuracy fine = measure_lut3d_accuracy(conv.set_lut_size(65), 50);
+		EXPECT_LT(fine.max_error, coarse.max_error);
+		EXPECT_LT(fine.rms_error, coarse.rms_error);
+		EXPECT_LT(fine.rms_error, 0.02);
+	}
+	{
+		SCOPED_TRACE("linear input");
+		EXPECT_FALSE(is_lut3d_supported(csp_linear));
+		EXPECT_TRUE(is_lut3d_supported(csp_2020_pq));
+
+		auto conv = ColorspaceConversion{ 640, 480 }
+			.set_csp_in(csp_linear)
+			.set_csp_out(csp_709_rgb)
+			.set_lut_size(33);
+		EXPECT_THROW(measure_lut3d_accuracy(conv, 33), zimg::error::IllegalArgument);
+		EXPECT_TRUE(conv.create());
+	}
+}
+
+TEST(ColorspaceConversionTest, test_matrix_collapse)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_601{ MatrixCoefficients::REC_601, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::REC_709, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+
+	// Planar Y, U, V of black, white, grey and saturated colors.
+	const std::vector<float> src = {
+		0.0f, 1.0f, 0.5f, 0.3f, 0.6f, 0.1f,
+		0.0f, 0.0f, 0.0f, -0.2f, 0.4f, 0.5f,
+		0.0f, 0.0f, 0.0f, 0.5f, -0.3f, -0.5f,
+	};
+
+	// The YUV->RGB->YUV path is applied as a single matrix.
+	std::vector<float> direct = convert_float_row(csp_601, csp_709, src);
+	std::vector<float> two_step = convert_float_row(csp_rgb, csp_709, convert_float_row(csp_601, csp_rgb, src));
+	ASSERT_EQ(src.size(), direct.size());
+	ASSERT_EQ(src.size(), two_step.size());
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		SCOPED_TRACE(i);
+		EXPECT_NEAR(two_step[i], direct[i], 1e-6);
+	}
+}
+
+TEST(ColorspaceConversionTest, test_operation_path)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	const ColorspaceDefinition csp_ictcp{ MatrixCoefficients::REC_2100_ICTCP, TransferCharacteristics::ST_2084, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_unspec{ MatrixCoefficients::UNSPECIFIED, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+
+	const std::vector<OperationFactory> &path = get_operation_path(csp_ictcp, csp_709);
+	ASSERT_EQ(6U, path.size());
+	EXPECT_EQ(csp_ictcp, path.front().in);
+	EXPECT_EQ(csp_709, path.back().out);
+
+	for (size_t i = 1; i < path.size(); ++i) {
+		EXPECT_EQ(path[i - 1].out, path[i].in);
+	}
+
+	// Repeated searches return the remembered path.
+	EXPECT_EQ(&path, &get_operation_path(csp_ictcp, csp_709));
+	EXPECT_EQ(1U, get_operation_path(csp_709, csp_709.to_rgb()).size());
+	EXPECT_TRUE(get_operation_path(csp_709, csp_709).empty());
+
+	EXPECT_THROW(get_operation_path(csp_709, csp_unspec), zimg::error::NoColorspaceConversion);
+	EXPECT_THROW(get_operation_path(csp_709, csp_unspec), zimg::error::NoColorspaceConversion);
+}
+
+TEST(ColorspaceConversionTest, test_integer_transfer)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::RGB, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	const ColorspaceDefinition csp_2020_pq{ MatrixCoefficients::RGB, TransferCharacteristics::ST_2084, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_2020_yuv{ MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::REC_709, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_b67{ MatrixCoefficients::RGB, TransferCharacteristics::ARIB_B67, ColorPrimaries::REC_2020 };
+	const zimg::PixelFormat format_float = zimg::PixelType::FLOAT;
+
+	EXPECT_TRUE(is_integer_transfer_supported(csp_709, csp_709.to_linear(), { zimg::PixelType::BYTE, 8, true }, format_float, false, false));
+	EXPECT_TRUE(is_integer_transfer_supported(csp_2020_pq, csp_709, { zimg::PixelType::WORD, 12 }, format_float, false, false));
+	EXPECT_FALSE(is_integer_transfer_supported(csp_709, csp_709, { zimg::PixelType::WORD, 16 }, format_float, false, false));
+	EXPECT_FALSE(is_integer_transfer_supported(csp_709, csp_709.to_linear(), { zimg::PixelType::WORD, 10 }, { zimg::PixelType::WORD, 10 }, false, false));
+	EXPECT_FALSE(is_integer_transfer_supported(csp_2020_yuv, csp_709, { zimg::PixelType::WORD, 10 }, format_float, false, false));
+	EXPECT_FALSE(is_integer_transfer_supported(csp_709.to_linear(), csp_709, { zimg::PixelType::WORD, 10 }, format_float, false, false));
+	EXPECT_FALSE(is_integer_transfer_supported(csp_b67, csp_709, { zimg::PixelType::WORD, 10 }, format_float, false, false));
+	EXPECT_TRUE(is_integer_transfer_supported(csp_b67, csp_709, { zimg::PixelType::WORD, 10 }, format_float, false, true));
+
+	auto test_format = [&](const ColorspaceDefinition &csp_in, const ColorspaceDefinition &csp_out, const zimg::PixelFormat &format)
+	{
+		const unsigned num_codes = 1U << format.depth;
+		const double range = format.fullrange ? num_codes - 1 : 219 << (format.depth - 8);
+		const double offset = format.fullrange ? 0 : 16 << (format.depth - 8);
+
+		auto filter = ColorspaceConversion{ num_codes, 1 }
+			.set_csp_in(csp_in)
+			.set_csp_out(csp_out)
+			.set_pixel_in(format)
+			.set_cpu(zimg::CPUClass::NONE)
+			.create();
+		ASSERT_TRUE(filter);
+
+		// Every code value in each plane, offset by one pixel between planes.
+		std::vector<uint16_t> src(num_codes * 3);
+		std::vector<float> src_float(num_codes * 3);
+		for (unsigned p = 0; p < 3; ++p) {
+			for (unsigned x = 0; x < num_codes; ++x) {
+				uint16_t code = static_cast<uint16_t>((x + p) % num_codes);
+				src[p * num_codes + x] = code;
+				src_float[p * num_codes + x] = static_cast<float>((code - offset) / range);
+			}
+		}
+
+		std::vector<float> dst(num_codes * 3);
+		std::vector<uint8_t> src_byte(src.begin(), src.end());
+
+		graphengine::BufferDescriptor in[3];
+		graphengine::BufferDescriptor out[3];
+		for (unsigned p = 0; p < 3; ++p) {
+			if (format.type == zimg::PixelType::BYTE)
+				in[p] = { src_byte.data() + p * num_codes, static_cast<ptrdiff_t>(num_codes), graphengine::BUFFER_MAX };
+			else
+				in[p] = { src.data() + p * num_codes, static_cast<ptrdiff_t>(num_codes * sizeof(uint16_t)), graphengine::BUFFER_MAX };
+			out[p] = { dst.data() + p * num_codes, static_cast<ptrdiff_t>(num_codes * sizeof(float)), graphengine::BUFFER_MAX };
+		}
+		filter->process(in, out, 0, 0, num_codes, nullptr, nullptr);
+
+		std::vector<float> expected = convert_float_row(csp_in, csp_out, src_float);
+		ASSERT_EQ(expected.size(), dst.size());
+
+		for (size_t i = 0; i < dst.size(); ++i) {
+			SCOPED_TRACE(i);
+			EXPECT_NEAR(expected[i], dst[i], std::abs(expected[i]) * 1e-6 + 1e-6);
+		}
+	};
+
+	{
+		SCOPED_TRACE("8-bit full range 709->linear");
+		test_format(csp_709, csp_709.to_linear(), { zimg::PixelType::BYTE, 8, true });
+	}
+	{
+		SCOPED_TRACE("10-bit limited range st2084->709");
+		test_format(csp_2020_pq, csp_709, { zimg::PixelType::WORD, 10 });
+	}
+	{
+		SCOPED_TRACE("12-bit limited range 709->2020 yuv");
+		test_format(csp_709, csp_2020_yuv, { zimg::PixelType::WORD, 12 });
+	}
+}
@@ -48,18 +48,170 @@ void test_case(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg:
 		.run();
 }
 
+void test_case_exact(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out, const char * const expected_sha1[3], double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	bool yuv_in = csp_in.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+	bool yuv_out = csp_out.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto builder = zimg::colorspace::ColorspaceConversion{ w, h }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out);
+
+	auto filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+	auto filter_avx2 = builder.set_cpu(zimg::CPUClass::X86_AVX2).create();
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_avx2);
+
+	graphengine::FilterValidation(filter_avx2.get(), { w, h, zimg::pixel_size(zimg::PixelType::FLOAT) })
+		.set_reference_filter(filter_c.get(), expected_snr)
+		.set_input_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_input_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_input_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_output_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_output_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_output_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.set_sha1(2, expected_sha1[2])
+		.run();
+}
+
+void test_case_integer(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out,
+                       const zimg::PixelFormat &format_in, const zimg::PixelFormat &format_out, const char * const expected_sha1[3])
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto builder = zimg::colorspace::ColorspaceConversion{ w, h }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out)
+		.set_pixel_in(format_in)
+		.set_pixel_out(format_out);
+
+	auto filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+	auto filter_avx2 = builder.set_cpu(zimg::CPUClass::X86_AVX2).create();
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_avx2);
+
+	graphengine::FilterValidation(filter_avx2.get(), { w, h, zimg::pixel_size(format_in.type) })
+		.set_reference_filter(filter_c.get(), INFINITY)
+		.set_input_pixel_format(0, { format_in.depth, false, false })
+		.set_input_pixel_format(1, { format_in.depth, false, format_in.chroma })
+		.set_input_pixel_format(2, { format_in.depth, false, format_in.chroma })
+		.set_output_pixel_format(0, { format_out.depth, false, false })
+		.set_output_pixel_format(1, { format_out.depth, false, format_out.chroma })
+		.set_output_pixel_format(2, { format_out.depth, false, format_out.chroma })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.set_sha1(2, expected_sha1[2])
+		.run();
+}
+
+void test_case_lut3d(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out, unsigned lut_size, const char * const expected_sha1[3])
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	bool yuv_in = csp_in.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+	bool yuv_out = csp_out.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	auto builder = zimg::colorspace::ColorspaceConversion{ w, h }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out)
+		.set_lut_size(lut_size);
+
+	auto filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+	auto filter_avx2 = builder.set_cpu(zimg::CPUClass::X86_AVX2).create();
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_avx2);
+
+	graphengine::FilterValidation(filter_avx2.get(), { w, h, zimg::pixel_size(zimg::PixelType::FLOAT) })
+		.set_reference_filter(filter_c.get(), 100.0)
+		.set_input_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_input_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_input_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_output_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_output_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_output_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.set_sha1(2, expected_sha1[2])
+		.run();
+}
+
 } // namespace
 
 
+TEST(ColorspaceConversionAVX2Test, test_integer_matrix)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::REC_709, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_2020{ MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+
+	static const char *expected_sha1[][3] = {
+		{
+			"6936d08cdf9a4e5ee2209d50b40f022a3ba68da9",
+			"7d59c07395f205b00d3ed419108e0d7a3d806c86",
+			"40e6fd2576c07d44e76ff222f0078f3e1650b1bf"
+		},
+		{
+			"3cbe714081332e632801887add28bf952fee86a0",
+			"836c8e9986bc93bf28a5613ed418f8fb64245e94",
+			"ed7597b4b9123c6773d668ef77b8c4d9e3c1bc0f"
+		},
+		{
+			"7d4069351b8e1ad85e8227bf841f3e308f75ad56",
+			"c99e6a782ae52c6c3f92957aa50e35cb07eaeb60",
+			"13f6301fdf6e9d8151fbbd7a4d275a645d321cd8"
+		},
+		{
+			"716dd3d8957719d62046db54abece758d426b8a8",
+			"3dda914be598f2a681d179033f45040f48eeba37",
+			"839744496d8a7ade26346f68ba3f0a46358c3b0e"
+		},
+	};
+
+	SCOPED_TRACE("b2b 709->rgb");
+	test_case_integer(csp_709, csp_rgb, { zimg::PixelType::BYTE, 8, false, true }, { zimg::PixelType::BYTE, 8, true, false }, expected_sha1[0]);
+	SCOPED_TRACE("b2w rgb->709");
+	test_case_integer(csp_rgb, csp_709, { zimg::PixelType::BYTE, 8, true, false }, { zimg::PixelType::WORD, 10, false, true }, expected_sha1[1]);
+	SCOPED_TRACE("w2b 2020->rgb");
+	test_case_integer(csp_2020, csp_rgb, { zimg::PixelType::WORD, 10, false, true }, { zimg::PixelType::BYTE, 8, true, false }, expected_sha1[2]);
+	SCOPED_TRACE("w2w 709->2020");
+	test_case_integer(csp_709, csp_2020, { zimg::PixelType::WORD, 12, true, true }, { zimg::PixelType::WORD, 12, false, true }, expected_sha1[3]);
+}
+
 TEST(ColorspaceConversionAVX2Test, test_transfer_lut)
 {
 	using namespace zimg::colorspace;
 
 	static const char *expected_sha1[][3] = {
 		{
-			"23d012fcb280f601e2e3c349229d0108e3cd632a",
-			"7ae186215d5fa45065f7aeac74ab2dc74b556696",
-			"bad84d4e0de8572c81df6d9f91fef05b1576f9e5"
+			// BT.1886 to linear is evaluated by polynomial instead.
+			"08d5b0c5299a03d6ca7a477dcf2853ece6f31a96",
+			"1f1421c4a1c923f286314bcca9cb3b5d9a6ba4cc",
+			"1f64edd1c042f14261b4b6a4d1f6a7eb3aeb32b6"
 		},
 		{
 			"011ee645ad30bb6ad6d93d8980d89a3e3e073c19",
@@ -98,4 +250,105 @@ TEST(ColorspaceConversionAVX2Test, test_transfer_lut)
 	          expected_sha1[3], expected_togamma_snr);
 }
 
+TEST(ColorspaceConversionAVX2Test, test_transfer_srgb)
+{
+	using namespace zimg::colorspace;
+
+	static const char *expected_sha1[3] = {
+		"43c2d947ab229997b225ac5ba9d96010048fa895",
+		"06c3c947a9b14727ea8f4344550e4a39f1407cc7",
+		"37ff78604039771f13bc986031aa1e94bf87828f"
+	};
+
+	SCOPED_TRACE("tolinear");
+	test_case({ MatrixCoefficients::RGB, TransferCharacteristics::SRGB, ColorPrimaries::UNSPECIFIED },
+	          { MatrixCoefficients::RGB, TransferCharacteristics::LINEAR, ColorPrimaries::UNSPECIFIED },
+	          expected_sha1, 120.0);
+}
+
+TEST(ColorspaceConversionAVX2Test, test_arib_b67_display_referred)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_gamma{ MatrixCoefficients::RGB, TransferCharacteristics::ARIB_B67, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_linear = csp_gamma.to_linear();
+
+	static const char *expected_sha1[][3] = {
+		{
+			"9a14ae915be9ac6b8fc40e4b406f5b0d919939d4",
+			"4427e88e475f0f7253ae0ac2eaeedad6cd86d7da",
+			"1126cb031695e662ea0898f3e1fad444ec5055b6"
+		},
+		{
+			"303bb7b4c68159826d803c1d5a437bfe608aed91",
+			"78f07c188750cef705bfcbde69dc49fc2af480a2",
+			"cefc082cac6b74f4e936961dea522835a8dfe9f6"
+		},
+	};
+
+	SCOPED_TRACE("tolinear");
+	test_case_exact(csp_gamma, csp_linear, expected_sha1[0], 120.0);
+	SCOPED_TRACE("togamma");
+	test_case_exact(csp_linear, csp_gamma, expected_sha1[1], 120.0);
+}
+
+TEST(ColorspaceConversionAVX2Test, test_constant_luminance)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_yuv{ MatrixCoefficients::REC_2020_CL, TransferCharacteristics::REC_709, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_linear{ MatrixCoefficients::RGB, TransferCharacteristics::LINEAR, ColorPrimaries::REC_2020 };
+
+	static const char *expected_sha1[][3] = {
+		{
+			"8bbe7e907d116f1464dfe3df9a0096cce5e35ee1",
+			"51ed62c905627db7ef4ce4ef4fe86352fd119f53",
+			"6fc1998dce565edfaff341c7c1f549e2807a3b04"
+		},
+		{
+			"bdb08ac3a2984cff85e79964f50959e7d819f927",
+			"df4230f456762f685e3fea27999d342b5f101e42",
+			"966bf751c90b9b2f2af2012e88864b2ef754546e"
+		},
+	};
+
+	SCOPED_TRACE("yuv->rgb");
+	test_case_exact(csp_yuv, csp_linear, expected_sha1[0], 120.0);
+	SCOPED_TRACE("rgb->yuv");
+	test_case_exact(csp_linear, csp_yuv, expected_sha1[1], 120.0);
+}
+
+TEST(ColorspaceConversionAVX2Test, test_lut3d)
+{
+	using namespace zimg::colorspace;
+
+	static const char *expected_sha1[][3] = {
+		{
+			"5843a7b543dd8958cab66a14282af0709225d0e8",
+			"4390688e4337824b4f4e937faca888087fb79491",
+			"4dd6bf0d30cee8467d9c271f4c7cf3cb4688a985"
+		},
+		{
+			"aec84638d0fe56d00e40c19c89caba2871055f3e",
+			"dfb798ac35d5df70293a9a83c7bf75b829854f28",
+			"669b5a5a6195e0be6bfa1ae2d9d5b0eb858c6738"
+		},
+		{
+			"a6a403bfbfe03e496e157a7d6c1dd89e97077792",
+			"22e1fc0be47ae6cb18e71783d25b31657ba096e3",
+			"f94d8d00243acd5f2704b6f18c24eeaa3ecf4f13"
+		},
+	};
+
+	SCOPED_TRACE("709->rgb 17");
+	test_case_lut3d({ MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 },
+	                { MatrixCoefficients::RGB, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 }, 17, expected_sha1[0]);
+	SCOPED_TRACE("2020 st2084->709 33");
+	test_case_lut3d({ MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::ST_2084, ColorPrimaries::REC_2020 },
+	                { MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 }, 33, expected_sha1[1]);
+	SCOPED_TRACE("rgb->rgb 2");
+	test_case_lut3d({ MatrixCoefficients::RGB, TransferCharacteristics::SRGB, ColorPrimaries::REC_709 },
+	                { MatrixCoefficients::RGB, TransferCharacteristics::SRGB, ColorPrimaries::DCI_P3_D65 }, 2, expected_sha1[2]);
+}
+
 #endif // ZIMG_X86
@@ -48,9 +48,123 @@ void test_case(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg:
 		.run();
 }
 
+void test_case_exact(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out, const char * const expected_sha1[3], double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	bool yuv_in = csp_in.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+	bool yuv_out = csp_out.matrix != zimg::colorspace::MatrixCoefficients::RGB;
+
+	if (!zimg::query_x86_capabilities().sse2) {
+		SUCCEED() << "sse2 not available, skipping";
+		return;
+	}
+
+	auto builder = zimg::colorspace::ColorspaceConversion{ w, h }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out);
+
+	auto filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+	auto filter_sse2 = builder.set_cpu(zimg::CPUClass::X86_SSE2).create();
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_sse2);
+
+	graphengine::FilterValidation(filter_sse2.get(), { w, h, zimg::pixel_size(zimg::PixelType::FLOAT) })
+		.set_reference_filter(filter_c.get(), expected_snr)
+		.set_input_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_input_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_input_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_in })
+		.set_output_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, false })
+		.set_output_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_output_pixel_format(2, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, yuv_out })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.set_sha1(2, expected_sha1[2])
+		.run();
+}
+
+void test_case_integer(const zimg::colorspace::ColorspaceDefinition &csp_in, const zimg::colorspace::ColorspaceDefinition &csp_out,
+                       const zimg::PixelFormat &format_in, const zimg::PixelFormat &format_out, const char * const expected_sha1[3])
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().sse2) {
+		SUCCEED() << "sse2 not available, skipping";
+		return;
+	}
+
+	auto builder = zimg::colorspace::ColorspaceConversion{ w, h }
+		.set_csp_in(csp_in)
+		.set_csp_out(csp_out)
+		.set_pixel_in(format_in)
+		.set_pixel_out(format_out);
+
+	auto filter_c = builder.set_cpu(zimg::CPUClass::NONE).create();
+	auto filter_sse2 = builder.set_cpu(zimg::CPUClass::X86_SSE2).create();
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_sse2);
+
+	graphengine::FilterValidation(filter_sse2.get(), { w, h, zimg::pixel_size(format_in.type) })
+		.set_reference_filter(filter_c.get(), INFINITY)
+		.set_input_pixel_format(0, { format_in.depth, false, false })
+		.set_input_pixel_format(1, { format_in.depth, false, format_in.chroma })
+		.set_input_pixel_format(2, { format_in.depth, false, format_in.chroma })
+		.set_output_pixel_format(0, { format_out.depth, false, false })
+		.set_output_pixel_format(1, { format_out.depth, false, format_out.chroma })
+		.set_output_pixel_format(2, { format_out.depth, false, format_out.chroma })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.set_sha1(2, expected_sha1[2])
+		.run();
+}
+
 } // namespace
 
 
+TEST(ColorspaceConversionSSE2Test, test_integer_matrix)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_rgb{ MatrixCoefficients::RGB, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_709{ MatrixCoefficients::REC_709, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+	const ColorspaceDefinition csp_2020{ MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::UNSPECIFIED, ColorPrimaries::UNSPECIFIED };
+
+	static const char *expected_sha1[][3] = {
+		{
+			"6936d08cdf9a4e5ee2209d50b40f022a3ba68da9",
+			"7d59c07395f205b00d3ed419108e0d7a3d806c86",
+			"40e6fd2576c07d44e76ff222f0078f3e1650b1bf"
+		},
+		{
+			"3cbe714081332e632801887add28bf952fee86a0",
+			"836c8e9986bc93bf28a5613ed418f8fb64245e94",
+			"ed7597b4b9123c6773d668ef77b8c4d9e3c1bc0f"
+		},
+		{
+			"7d4069351b8e1ad85e8227bf841f3e308f75ad56",
+			"c99e6a782ae52c6c3f92957aa50e35cb07eaeb60",
+			"13f6301fdf6e9d8151fbbd7a4d275a645d321cd8"
+		},
+		{
+			"716dd3d8957719d62046db54abece758d426b8a8",
+			"3dda914be598f2a681d179033f45040f48eeba37",
+			"839744496d8a7ade26346f68ba3f0a46358c3b0e"
+		},
+	};
+
+	SCOPED_TRACE("b2b 709->rgb");
+	test_case_integer(csp_709, csp_rgb, { zimg::PixelType::BYTE, 8, false, true }, { zimg::PixelType::BYTE, 8, true, false }, expected_sha1[0]);
+	SCOPED_TRACE("b2w rgb->709");
+	test_case_integer(csp_rgb, csp_709, { zimg::PixelType::BYTE, 8, true, false }, { zimg::PixelType::WORD, 10, false, true }, expected_sha1[1]);
+	SCOPED_TRACE("w2b 2020->rgb");
+	test_case_integer(csp_2020, csp_rgb, { zimg::PixelType::WORD, 10, false, true }, { zimg::PixelType::BYTE, 8, true, false }, expected_sha1[2]);
+	SCOPED_TRACE("w2w 709->2020");
+	test_case_integer(csp_709, csp_2020, { zimg::PixelType::WORD, 12, true, true }, { zimg::PixelType::WORD, 12, false, true }, expected_sha1[3]);
+}
+
 TEST(ColorspaceConversionSSE2Test, test_transfer_lut)
 {
 	using namespace zimg::colorspace;
@@ -98,4 +212,56 @@ TEST(ColorspaceConversionSSE2Test, test_transfer_lut)
 	          expected_sha1[3], expected_togamma_snr);
 }
 
+TEST(ColorspaceConversionSSE2Test, test_arib_b67_display_referred)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_gamma{ MatrixCoefficients::RGB, TransferCharacteristics::ARIB_B67, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_linear = csp_gamma.to_linear();
+
+	static const char *expected_sha1[][3] = {
+		{
+			"70659e55537207139ac20d4febe69fc152a29537",
+			"220dda5f5876ceaffdb03e9823b8f8cd4071a746",
+			"92bcb777e9b96fcb51541ce220a9a9328e604d51"
+		},
+		{
+			"936efb4a2e7a37265e7a59ab60ebb82f93acceb7",
+			"51563ae2c382e45d854e05254e5374d512fd0f8f",
+			"fb5f53840d86800150105f913d2a047b7ac26f5e"
+		},
+	};
+
+	SCOPED_TRACE("tolinear");
+	test_case_exact(csp_gamma, csp_linear, expected_sha1[0], 120.0);
+	SCOPED_TRACE("togamma");
+	test_case_exact(csp_linear, csp_gamma, expected_sha1[1], 120.0);
+}
+
+TEST(ColorspaceConversionSSE2Test, test_constant_luminance)
+{
+	using namespace zimg::colorspace;
+
+	const ColorspaceDefinition csp_yuv{ MatrixCoefficients::REC_2020_CL, TransferCharacteristics::REC_709, ColorPrimaries::REC_2020 };
+	const ColorspaceDefinition csp_linear{ MatrixCoefficients::RGB, TransferCharacteristics::LINEAR, ColorPrimaries::REC_2020 };
+
+	static const char *expected_sha1[][3] = {
+		{
+			"bdaddf99fcf0be148a08f9c2061eb712773cd9ea",
+			"05d5bd118ce10361bca29d7e7f817dad525623e5",
+			"d2cc1fac792fc3faf588edf2c8737aa26708f688"
+		},
+		{
+			"cdcdd6b10526885466e8a96013818942e142d17f",
+			"00e5843c26588f6c5eb4faa98e719b4aea5fb75e",
+			"0ba9001488e577cee0708ea4bcdf854f49cb49bd"
+		},
+	};
+
+	SCOPED_TRACE("yuv->rgb");
+	test_case_exact(csp_yuv, csp_linear, expected_sha1[0], 120.0);
+	SCOPED_TRACE("rgb->yuv");
+	test_case_exact(csp_linear, csp_yuv, expected_sha1[1], 120.0);
+}
+
 #endif // ZIMG_X86
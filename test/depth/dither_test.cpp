@@ -1,8 +1,14 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "common/alloc.h"
 #include "common/cpuinfo.h"
 #include "common/pixel.h"
 #include "graphengine/filter.h"
 #include "depth/depth.h"
 #include "depth/dither.h"
+#include "depth/wavefront.h"
 
 #include "gtest/gtest.h"
 #include "graphengine/filter_validation.h"
@@ -45,6 +51,25 @@ void test_case(zimg::depth::DitherType type, bool fullrange, bool chroma, const
 	}
 }
 
+
+std::vector<uint8_t> dither_constant_plane(const graphengine::Filter *filter, float value, unsigned w, unsigned h, unsigned split)
+{
+	zimg::AlignedVector<float> src(w, value);
+	zimg::AlignedVector<uint8_t> dst(w);
+	zimg::AlignedVector<unsigned char> tmp(filter->descriptor().scratchpad_size);
+	std::vector<uint8_t> plane;
+
+	graphengine::BufferDescriptor in{ src.data(), 0, graphengine::BUFFER_MAX };
+	graphengine::BufferDescriptor out{ dst.data(), 0, graphengine::BUFFER_MAX };
+
+	for (unsigned i = 0; i < h; ++i) {
+		filter->process(&in, &out, i, 0, split, nullptr, tmp.data());
+		filter->process(&in, &out, i, split, w, nullptr, tmp.data());
+		plane.insert(plane.end(), dst.begin(), dst.end());
+	}
+	return plane;
+}
+
 } // namespace
 
 
@@ -181,3 +206,87 @@ TEST(DitherTest, test_error_diffusion)
 	test_case(zimg::depth::DitherType::ERROR_DIFFUSION, false, false, expected_sha1);
 }
 
+
+TEST(DitherTest, test_error_diffusion_threads)
+{
+	const unsigned w = 641;
+	const unsigned h = 479;
+	const zimg::depth::DitherType dither = zimg::depth::DitherType::ERROR_DIFFUSION;
+
+	const zimg::PixelFormat formats[][2] = {
+		{ { zimg::PixelType::WORD, 16, true }, { zimg::PixelType::BYTE, 8, true } },
+		{ { zimg::PixelType::HALF, 16 }, { zimg::PixelType::BYTE, 8 } },
+		{ { zimg::PixelType::FLOAT, 32 }, { zimg::PixelType::WORD, 10 } },
+	};
+
+	for (zimg::CPUClass cpu : { zimg::CPUClass::NONE, zimg::CPUClass::AUTO_64B }) {
+		for (const auto &format : formats) {
+			for (unsigned threads : { 2U, 3U, 16U }) {
+				SCOPED_TRACE(static_cast<int>(cpu));
+				SCOPED_TRACE(static_cast<int>(format[0].type));
+				SCOPED_TRACE(threads);
+
+				bool planes[] = { true, false, false, false };
+				zimg::depth::DepthConversion::result serial = zimg::depth::create_dither(dither, w, h, format[0], format[1], planes, cpu);
+				zimg::depth::DepthConversion::result parallel = zimg::depth::create_dither(dither, w, h, format[0], format[1], planes, cpu, threads);
+				ASSERT_TRUE(serial.filter_refs[0]);
+				ASSERT_TRUE(parallel.filter_refs[0]);
+				EXPECT_GT(parallel.filter_refs[0]->descriptor().step, serial.filter_refs[0]->descriptor().step);
+
+				// The graph supplies the threads when the filter is processed.
+				zimg::depth::WavefrontPool pool{ threads };
+				zimg::depth::WavefrontScope scope{ &pool };
+
+				graphengine::FilterValidation(parallel.filter_refs[0], { w, h, zimg::pixel_size(format[0].type) })
+					.set_input_pixel_format({ format[0].depth, zimg::pixel_is_float(format[0].type), format[0].chroma })
+					.set_output_pixel_format({ format[1].depth, zimg::pixel_is_float(format[1].type), format[1].chroma })
+					.set_reference_filter(serial.filter_refs[0], INFINITY)
+					.run();
+			}
+		}
+	}
+}
+
+TEST(DitherTest, test_random_counter)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::depth::DitherType dither = zimg::depth::DitherType::RANDOM_COUNTER;
+
+	zimg::PixelFormat fmt_in{ zimg::PixelType::FLOAT, 32, true, false };
+	zimg::PixelFormat fmt_out{ zimg::PixelType::BYTE, 8, true, false };
+
+	// A quarter of the way from 100 to 101.
+	const float value = 100.25f / 255.0f;
+	std::vector<uint8_t> reference;
+
+	for (zimg::CPUClass cpu : { zimg::CPUClass::NONE, zimg::CPUClass::AUTO_64B }) {
+		SCOPED_TRACE(static_cast<int>(cpu));
+
+		bool planes[] = { true, true, false, false };
+		zimg::depth::DepthConversion::result result = zimg::depth::create_dither(dither, w, h, fmt_in, fmt_out, planes, cpu);
+		ASSERT_TRUE(result.filter_refs[0]);
+		ASSERT_TRUE(result.filter_refs[1]);
+
+		std::vector<uint8_t> plane0 = dither_constant_plane(result.filter_refs[0], value, w, h, w);
+		std::vector<uint8_t> plane0_split = dither_constant_plane(result.filter_refs[0], value, w, h, 200);
+		std::vector<uint8_t> plane1 = dither_constant_plane(result.filter_refs[1], value, w, h, w);
+
+		// The noise does not depend on the span of the row processed or on the CPU.
+		EXPECT_EQ(plane0, plane0_split);
+		EXPECT_NE(plane0, plane1);
+		if (reference.empty())
+			reference = plane0;
+		EXPECT_EQ(reference, plane0);
+
+		size_t lo = std::count(plane0.begin(), plane0.end(), 100);
+		size_t hi = std::count(plane0.begin(), plane0.end(), 101);
+		EXPECT_EQ(static_cast<size_t>(w) * h, lo + hi);
+		EXPECT_NEAR(0.25, static_cast<double>(hi) / (static_cast<size_t>(w) * h), 0.01);
+
+		graphengine::FilterValidation(result.filter_refs[0], { w, h, zimg::pixel_size(fmt_in.type) })
+			.set_input_pixel_format({ fmt_in.depth, zimg::pixel_is_float(fmt_in.type), fmt_in.chroma })
+			.set_output_pixel_format({ fmt_out.depth, zimg::pixel_is_float(fmt_out.type), fmt_out.chroma })
+			.run();
+	}
+}
@@ -36,6 +36,29 @@ void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel
 		.run();
 }
 
+
+void test_case_counter(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel_out, double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+	const zimg::depth::DitherType dither = zimg::depth::DitherType::RANDOM_COUNTER;
+
+	if (!zimg::query_x86_capabilities().sse2) {
+		SUCCEED() << "sse2 not available, skipping";
+		return;
+	}
+
+	bool planes[] = { true, false, false, false };
+	auto result_c = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, planes, zimg::CPUClass::NONE);
+	auto result_sse2 = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, planes, zimg::CPUClass::X86_SSE2);
+
+	graphengine::FilterValidation(result_sse2.filter_refs[0], { w, h, zimg::pixel_size(pixel_in.type) })
+		.set_reference_filter(result_c.filter_refs[0], expected_snr)
+		.set_input_pixel_format({ pixel_in.depth, zimg::pixel_is_float(pixel_in.type), pixel_in.chroma })
+		.set_output_pixel_format({ pixel_out.depth, zimg::pixel_is_float(pixel_out.type), pixel_out.chroma })
+		.run();
+}
+
 } // namespace
 
 
@@ -100,4 +123,21 @@ TEST(DitherSSE2Test, test_ordered_dither_f2w)
 	test_case(pixel_in, pixel_out, expected_sha1, INFINITY);
 }
 
+
+TEST(DitherSSE2Test, test_random_counter_w2b)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::WORD;
+	zimg::PixelFormat pixel_out = zimg::PixelType::BYTE;
+
+	test_case_counter(pixel_in, pixel_out, INFINITY);
+}
+
+TEST(DitherSSE2Test, test_random_counter_f2w)
+{
+	zimg::PixelFormat pixel_in = zimg::PixelType::FLOAT;
+	zimg::PixelFormat pixel_out = zimg::PixelType::WORD;
+
+	test_case_counter(pixel_in, pixel_out, INFINITY);
+}
+
 #endif // ZIMG_X86
@@ -38,6 +38,18 @@ void test_case(const zimg::PixelFormat &pixel_in, const zimg::PixelFormat &pixel
 		.set_reference_filter(result_c.filter_refs[0], expected_snr)
 		.set_sha1(0, expected_sha1)
 		.run();
+
+	// Processing blocks of rows concurrently gives the same result.
+	zimg::depth::DepthConversion::result result_mt = zimg::depth::create_dither(dither, w, h, pixel_in, pixel_out, planes, zimg::CPUClass::X86_SSE2, 4);
+	ASSERT_TRUE(result_mt.filter_refs[0]);
+	EXPECT_GT(result_mt.filter_refs[0]->descriptor().step, result_sse2.filter_refs[0]->descriptor().step);
+
+	graphengine::FilterValidation(result_mt.filter_refs[0], { w, h, zimg::pixel_size(pixel_in.type) })
+		.set_input_pixel_format({ pixel_in.depth, zimg::pixel_is_float(pixel_in.type), pixel_in.chroma })
+		.set_output_pixel_format({ pixel_out.depth, zimg::pixel_is_float(pixel_out.type), pixel_out.chroma })
+		.set_reference_filter(result_sse2.filter_refs[0], INFINITY)
+		.set_sha1(0, expected_sha1)
+		.run();
 }
 
 } // namespace
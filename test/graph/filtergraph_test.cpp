@@ -0,0 +1,724 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/alloc.h"
+#include "common/cpuinfo.h"
+#include "common/except.h"
+#include "common/pixel.h"
+#include "depth/depth.h"
+#include "depth/quantize.h"
+#include "graph/filtergraph.h"
+#include "graph/fused_filter.h"
+#include "graph/graphbuilder.h"
+#include "graph/profiler.h"
+#include "graph/simple_filters.h"
+#include "graphengine/types.h"
+#include "resize/filter.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using zimg::colorspace::MatrixCoefficients;
+using zimg::colorspace::TransferCharacteristics;
+using zimg::colorspace::ColorPrimaries;
+using zimg::graph::GraphBuilder;
+
+class ImageBuffer {
+	zimg::AlignedVector<unsigned char> m_data[4];
+	std::array<graphengine::BufferDescriptor, 4> m_buffer;
+	std::array<size_t, 4> m_row_size;
+	std::array<unsigned, 4> m_height;
+public:
+	explicit ImageBuffer(const GraphBuilder::state &state) : m_buffer{}, m_row_size{}, m_height{}
+	{
+		for (unsigned p = 0; p < 4; ++p) {
+			bool chroma = p == 1 || p == 2;
+
+			if ((chroma && state.color == GraphBuilder::ColorFamily::GREY) || (p == 3 && state.alpha == GraphBuilder::AlphaType::NONE))
+				continue;
+
+			unsigned width = chroma ? state.width >> state.subsample_w : state.width;
+			unsigned height = chroma ? state.height >> state.subsample_h : state.height;
+			size_t stride = zimg::ceil_n(static_cast<size_t>(width) * zimg::pixel_size(state.type), zimg::ALIGNMENT);
+
+			m_data[p].resize(stride * height);
+			m_row_size[p] = static_cast<size_t>(width) * zimg::pixel_size(state.type);
+			m_height[p] = height;
+			m_buffer[p] = { m_data[p].data(), static_cast<ptrdiff_t>(stride), graphengine::BUFFER_MAX };
+		}
+	}
+
+	const std::array<graphengine::BufferDescriptor, 4> &buffer() const { return m_buffer; }
+
+	void fill_random(const GraphBuilder::state &state, std::mt19937 &engine)
+	{
+		std::uniform_int_distribution<unsigned> int_dist(0, zimg::pixel_is_integer(state.type) ? (1U << state.depth) - 1 : 0);
+		std::uniform_real_distribution<float> float_dist(0.0f, 1.0f);
+
+		for (unsigned p = 0; p < 4; ++p) {
+			for (size_t i = 0; i < m_data[p].size() / zimg::pixel_size(state.type); ++i) {
+				switch (state.type) {
+				case zimg::PixelType::BYTE:
+					m_data[p][i] = static_cast<uint8_t>(int_dist(engine));
+					break;
+				case zimg::PixelType::WORD:
+					reinterpret_cast<uint16_t *>(m_data[p].data())[i] = static_cast<uint16_t>(int_dist(engine));
+					break;
+				case zimg::PixelType::FLOAT:
+					reinterpret_cast<float *>(m_data[p].data())[i] = float_dist(engine);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	}
+
+	bool equals(const ImageBuffer &other) const
+	{
+		for (unsigned p = 0; p < 4; ++p) {
+			for (unsigned i = 0; i < m_height[p]; ++i) {
+				if (std::memcmp(m_buffer[p].get_line(i), other.m_buffer[p].get_line(i), m_row_size[p]))
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+GraphBuilder::state make_state(unsigned width, unsigned height, zimg::PixelType type, GraphBuilder::ColorFamily color)
+{
+	GraphBuilder::state state{};
+	state.width = width;
+	state.height = height;
+	state.type = type;
+	state.color = color;
+	state.colorspace = { color == GraphBuilder::ColorFamily::RGB ? MatrixCoefficients::RGB : MatrixCoefficients::REC_709, TransferCharacteristics::REC_709, ColorPrimaries::REC_709 };
+	state.depth = zimg::pixel_depth(type);
+	state.fullrange = false;
+	state.parity = GraphBuilder::FieldParity::PROGRESSIVE;
+	state.chroma_location_w = GraphBuilder::ChromaLocationW::LEFT;
+	state.chroma_location_h = GraphBuilder::ChromaLocationH::CENTER;
+	state.active_left = 0.0;
+	state.active_top = 0.0;
+	state.active_width = width;
+	state.active_height = height;
+	state.alpha = GraphBuilder::AlphaType::NONE;
+	return state;
+}
+
+int serial_dispatch(void *user, unsigned num_tasks, void (*task)(void *, unsigned), void *task_data)
+{
+	++*static_cast<unsigned *>(user);
+
+	for (unsigned i = num_tasks; i != 0; --i) {
+		task(task_data, i - 1);
+	}
+	return 0;
+}
+
+void test_case(const GraphBuilder::state &source, const GraphBuilder::state &target, const GraphBuilder::params &params)
+{
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(target, &params).build_graph();
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	ImageBuffer dst_ref{ target };
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst_ref.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	for (unsigned num_threads : { 2U, 3U, 8U }) {
+		SCOPED_TRACE(num_threads);
+
+		ImageBuffer dst_mt{ target };
+		graph->process_mt(src.buffer(), dst_mt.buffer(), num_threads, nullptr, nullptr);
+		EXPECT_TRUE(dst_mt.equals(dst_ref));
+
+		unsigned dispatch_count = 0;
+		ImageBuffer dst_user{ target };
+		graph->process_mt(src.buffer(), dst_user.buffer(), num_threads, serial_dispatch, &dispatch_count);
+		EXPECT_TRUE(dst_user.equals(dst_ref));
+		EXPECT_EQ(1U, dispatch_count);
+	}
+}
+
+void test_case_region(const GraphBuilder::state &source, const GraphBuilder::state &target, unsigned tile_width, unsigned tile_height, const GraphBuilder::params *params = nullptr)
+{
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(target, params).build_graph();
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	ImageBuffer dst_ref{ target };
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst_ref.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	ImageBuffer dst{ target };
+	for (unsigned i = 0; i < target.height; i += tile_height) {
+		for (unsigned j = 0; j < target.width; j += tile_width) {
+			unsigned width = std::min(tile_width, target.width - j);
+			unsigned height = std::min(tile_height, target.height - i);
+
+			zimg::AlignedVector<unsigned char> tile_tmp(graph->get_tmp_size(j, i, width, height));
+			graph->process_region(src.buffer(), dst.buffer(), tile_tmp.data(), j, i, width, height);
+		}
+	}
+	EXPECT_TRUE(dst.equals(dst_ref));
+}
+
+} // namespace
+
+
+TEST(FilterGraphTest, test_process_region)
+{
+	auto source = make_state(640, 480, zimg::PixelType::WORD, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	auto target = make_state(999, 555, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+
+	test_case_region(source, target, 128, 64);
+	test_case_region(source, target, 100, 37);
+	test_case_region(source, target, 999, 1);
+}
+
+TEST(FilterGraphTest, test_process_region_subsampled)
+{
+	auto source = make_state(1920, 1080, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	auto target = make_state(1280, 720, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	target.subsample_w = 1;
+	target.subsample_h = 1;
+
+	test_case_region(source, target, 256, 96);
+	test_case_region(source, target, 66, 2);
+}
+
+TEST(FilterGraphTest, test_process_region_tmp_size)
+{
+	auto source = make_state(1920, 1080, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	auto target = make_state(1280, 720, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(target, nullptr).build_graph();
+
+	// Intermediate buffers only hold the rows in flight, so the temporary
+	// size does not grow with the height of the region.
+	size_t band_size = graph->get_tmp_size(0, 0, target.width, 16);
+	size_t frame_size = graph->get_tmp_size(0, 0, target.width, target.height);
+	EXPECT_LE(band_size, frame_size);
+	EXPECT_LT(frame_size, band_size * 2);
+}
+
+TEST(FilterGraphTest, test_process_region_unresize)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	auto target = make_state(320, 240, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	GraphBuilder::params params;
+	params.unresize = true;
+
+	test_case_region(source, target, 320, 240, &params);
+	test_case_region(source, target, 320, 16, &params);
+	test_case_region(source, target, 100, 37, &params);
+}
+
+TEST(FilterGraphTest, test_process_region_invalid)
+{
+	auto source = make_state(640, 480, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(source, nullptr).build_graph();
+
+	EXPECT_THROW(graph->get_tmp_size(0, 0, 641, 480), zimg::error::InvalidImageSize);
+	EXPECT_THROW(graph->get_tmp_size(640, 0, 1, 480), zimg::error::InvalidImageSize);
+	EXPECT_THROW(graph->get_tmp_size(0, 0, 0, 480), zimg::error::InvalidImageSize);
+	EXPECT_THROW(graph->get_tmp_size(1, 0, 64, 64), zimg::error::ImageNotDivisible);
+	EXPECT_THROW(graph->get_tmp_size(0, 0, 64, 63), zimg::error::ImageNotDivisible);
+	EXPECT_NO_THROW(graph->get_tmp_size(0, 478, 640, 2));
+}
+
+TEST(FilterGraphTest, test_process_mt_resize)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	auto target = make_state(1000, 333, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	test_case(source, target, GraphBuilder::params{});
+}
+
+TEST(FilterGraphTest, test_process_mt_yuv420_to_rgb)
+{
+	auto source = make_state(640, 480, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	auto target = make_state(1280, 720, zimg::PixelType::WORD, GraphBuilder::ColorFamily::RGB);
+	GraphBuilder::params params;
+	params.dither_type = zimg::depth::DitherType::ORDERED;
+	test_case(source, target, params);
+}
+
+TEST(FilterGraphTest, test_process_mt_rgb_to_yuv420)
+{
+	auto source = make_state(1920, 1080, zimg::PixelType::WORD, GraphBuilder::ColorFamily::RGB);
+	auto target = make_state(1280, 720, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	target.subsample_w = 1;
+	target.subsample_h = 1;
+	test_case(source, target, GraphBuilder::params{});
+}
+
+TEST(FilterGraphTest, test_process_mt_greyalpha)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	source.alpha = GraphBuilder::AlphaType::STRAIGHT;
+
+	auto target = make_state(320, 240, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	target.alpha = GraphBuilder::AlphaType::STRAIGHT;
+	test_case(source, target, GraphBuilder::params{});
+}
+
+TEST(FilterGraphTest, test_process_mt_unresize)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	auto target = make_state(320, 240, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	GraphBuilder::params params;
+	params.unresize = true;
+	test_case(source, target, params);
+}
+
+TEST(FilterGraphTest, test_process_mt_error_diffusion)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	auto target = make_state(640, 480, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::GREY);
+	GraphBuilder::params params;
+	params.dither_type = zimg::depth::DitherType::ERROR_DIFFUSION;
+
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(target, &params).build_graph();
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	ImageBuffer dst_ref{ target };
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst_ref.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	// Stateful graphs run serially and never reach the dispatcher.
+	unsigned dispatch_count = 0;
+	ImageBuffer dst_mt{ target };
+	graph->process_mt(src.buffer(), dst_mt.buffer(), 4, serial_dispatch, &dispatch_count);
+	EXPECT_TRUE(dst_mt.equals(dst_ref));
+	EXPECT_EQ(0U, dispatch_count);
+}
+
+TEST(FilterGraphTest, test_profile)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	auto target = make_state(320, 240, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	GraphBuilder::params params;
+	params.profile = true;
+
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(target, &params).build_graph();
+	ASSERT_TRUE(graph->get_profiler());
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	ImageBuffer dst{ target };
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	auto stats = graph->get_profiler()->get_stats();
+	ASSERT_EQ(6U, stats.size());
+
+	for (const auto &node : stats) {
+		SCOPED_TRACE(node.plane);
+		EXPECT_STREQ("resize", node.name);
+		EXPECT_GT(node.calls, 0U);
+		EXPECT_EQ(static_cast<uint64_t>(node.width) * node.height, node.pixels);
+		EXPECT_EQ(node.pixels * sizeof(float), node.bytes_written);
+		EXPECT_GE(node.bytes_read, node.bytes_written);
+	}
+
+	graph->get_profiler()->reset();
+	EXPECT_EQ(0U, graph->get_profiler()->get_stats()[0].calls);
+
+	ImageBuffer dst_mt{ target };
+	graph->process_mt(src.buffer(), dst_mt.buffer(), 4, nullptr, nullptr);
+	EXPECT_TRUE(dst_mt.equals(dst));
+	EXPECT_GT(graph->get_profiler()->get_stats().back().calls, 0U);
+
+	GraphBuilder builder_noprofile;
+	EXPECT_FALSE(builder_noprofile.set_source(source).connect(target, nullptr).build_graph()->get_profiler());
+}
+
+TEST(FilterGraphTest, test_fuse_point_filters)
+{
+	auto yuv = make_state(1000, 64, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	yuv.subsample_w = 1;
+	yuv.subsample_h = 1;
+	auto rgb = make_state(1000, 64, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::RGB);
+	auto rgb16 = make_state(1000, 64, zimg::PixelType::WORD, GraphBuilder::ColorFamily::RGB);
+
+	const std::pair<GraphBuilder::state, GraphBuilder::state> cases[] = { { yuv, rgb }, { rgb, yuv }, { rgb16, rgb } };
+
+	for (const auto &c : cases) {
+		const GraphBuilder::state &source = c.first;
+		const GraphBuilder::state &target = c.second;
+
+		GraphBuilder::params params;
+		params.dither_type = zimg::depth::DitherType::ORDERED;
+		auto fused_graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+		params.fuse_filters = false;
+		auto graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+		std::mt19937 engine;
+		ImageBuffer src{ source };
+		src.fill_random(source, engine);
+
+		ImageBuffer dst_ref{ target };
+		zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+		graph->process(src.buffer(), dst_ref.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+		ImageBuffer dst{ target };
+		tmp.resize(fused_graph->get_tmp_size());
+		fused_graph->process(src.buffer(), dst.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+		EXPECT_TRUE(dst.equals(dst_ref));
+
+		ImageBuffer dst_mt{ target };
+		fused_graph->process_mt(src.buffer(), dst_mt.buffer(), 3, nullptr, nullptr);
+		EXPECT_TRUE(dst_mt.equals(dst_ref));
+
+		ImageBuffer dst_region{ target };
+		for (unsigned j = 0; j < target.width; j += 300) {
+			unsigned width = std::min(300U, target.width - j);
+			zimg::AlignedVector<unsigned char> tile_tmp(fused_graph->get_tmp_size(j, 0, width, target.height));
+			fused_graph->process_region(src.buffer(), dst_region.buffer(), tile_tmp.data(), j, 0, width, target.height);
+		}
+		EXPECT_TRUE(dst_region.equals(dst_ref));
+	}
+}
+
+TEST(FilterGraphTest, test_fused_filter_in_place)
+{
+	using zimg::graph::FusedPointFilter;
+
+	const zimg::PixelFormat format = zimg::PixelType::FLOAT;
+	zimg::graph::PremultiplyFilter premultiply{ 64, 64, format, zimg::CPUClass::NONE };
+	zimg::graph::UnpremultiplyFilter unpremultiply{ 64, 64, format, zimg::CPUClass::NONE };
+
+	// Each input is read before the output aliasing it is written.
+	{
+		std::vector<FusedPointFilter::stage> stages(2);
+		stages[0] = { &premultiply, { { -1, 0 }, { -1, 1 } } };
+		stages[1] = { &unpremultiply, { { 0, 0 }, { -1, 1 } } };
+
+		FusedPointFilter fused{ stages, { { 1, 0 } }, 2 };
+		EXPECT_TRUE(fused.descriptor().flags.in_place);
+	}
+
+	// The second stage reads input 0 after output 0 is written.
+	{
+		std::vector<FusedPointFilter::stage> stages(2);
+		stages[0] = { &premultiply, { { -1, 0 }, { -1, 1 } } };
+		stages[1] = { &premultiply, { { -1, 0 }, { 0, 0 } } };
+
+		FusedPointFilter fused{ stages, { { 0, 0 }, { 1, 0 } }, 2 };
+		EXPECT_FALSE(fused.descriptor().flags.in_place);
+	}
+
+	// The stages change the sample size.
+	{
+		zimg::graph::PremultiplyFilter premultiply_b{ 64, 64, zimg::PixelType::BYTE, zimg::CPUClass::NONE };
+
+		std::vector<FusedPointFilter::stage> stages(1);
+		stages[0] = { &premultiply_b, { { -1, 0 }, { -1, 1 } } };
+
+		FusedPointFilter fused{ stages, { { 0, 0 } }, 2 };
+		EXPECT_FALSE(fused.descriptor().flags.in_place);
+	}
+}
+
+TEST(FilterGraphTest, test_chroma_upsample)
+{
+	const zimg::resize::BicubicFilter bicubic{};
+	const zimg::resize::LanczosFilter lanczos{ 3 };
+
+	// Short filters upsample both planes in a single node.
+	const std::pair<const zimg::resize::Filter *, size_t> cases[] = { { &bicubic, 1 }, { &lanczos, 4 } };
+
+	for (zimg::PixelType type : { zimg::PixelType::WORD, zimg::PixelType::FLOAT }) {
+		SCOPED_TRACE(static_cast<int>(type));
+
+		auto source = make_state(640, 480, type, GraphBuilder::ColorFamily::YUV);
+		source.subsample_w = 1;
+		source.subsample_h = 1;
+		auto target = make_state(640, 480, type, GraphBuilder::ColorFamily::RGB);
+
+		for (const auto &c : cases) {
+			SCOPED_TRACE(c.first->support());
+
+			GraphBuilder::params params;
+			params.filter_uv = c.first;
+			params.profile = true;
+			auto graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+			std::mt19937 engine;
+			ImageBuffer src{ source };
+			src.fill_random(source, engine);
+
+			ImageBuffer dst{ target };
+			zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+			graph->process(src.buffer(), dst.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+			auto stats = graph->get_profiler()->get_stats();
+			size_t num_resize = std::count_if(stats.begin(), stats.end(), [](const zimg::graph::FilterProfiler::node_stats &node)
+			{
+				return std::string{ node.name } == "resize";
+			});
+			EXPECT_EQ(c.second, num_resize);
+		}
+	}
+}
+
+TEST(FilterGraphTest, test_premultiply_opaque)
+{
+	auto source = make_state(640, 480, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	source.alpha = GraphBuilder::AlphaType::STRAIGHT;
+	auto target = source;
+	target.alpha = GraphBuilder::AlphaType::PREMULTIPLIED;
+
+	GraphBuilder::params params;
+	params.profile = true;
+	auto graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	// Opaque on the left half of the image.
+	for (unsigned i = 0; i < source.height; ++i) {
+		float *alpha = src.buffer()[3].get_line<float>(i);
+		std::fill_n(alpha, source.width / 2, 1.0f);
+	}
+
+	ImageBuffer dst{ target };
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	for (unsigned p = 0; p < 3; ++p) {
+		for (unsigned i = 0; i < source.height; ++i) {
+			const float *src_p = src.buffer()[p].get_line<const float>(i);
+			const float *alpha = src.buffer()[3].get_line<const float>(i);
+			const float *dst_p = dst.buffer()[p].get_line<const float>(i);
+
+			for (unsigned j = 0; j < source.width; ++j) {
+				ASSERT_EQ(src_p[j] * alpha[j], dst_p[j]) << p << " " << i << " " << j;
+			}
+		}
+	}
+
+	for (const auto &node : graph->get_profiler()->get_stats()) {
+		SCOPED_TRACE(node.plane);
+		EXPECT_STREQ("premultiply", node.name);
+		EXPECT_EQ(node.pixels / 2, node.pixels_skipped);
+	}
+
+	// Resizing an integer image is exact in the opaque area.
+	source.type = zimg::PixelType::WORD;
+	source.depth = 16;
+	target = source;
+	target.width = 320;
+	target.height = 240;
+	target.active_width = 320;
+	target.active_height = 240;
+
+	graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+	ImageBuffer src_w{ source };
+	src_w.fill_random(source, engine);
+
+	for (unsigned i = 0; i < source.height; ++i) {
+		uint16_t *alpha = src_w.buffer()[3].get_line<uint16_t>(i);
+		std::fill_n(alpha, source.width / 2, static_cast<uint16_t>(UINT16_MAX));
+	}
+
+	ImageBuffer dst_w{ target };
+	tmp.resize(graph->get_tmp_size());
+	graph->process(src_w.buffer(), dst_w.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	auto stats = graph->get_profiler()->get_stats();
+	auto num_skipped = [&](const char *name)
+	{
+		uint64_t count = 0;
+		for (const auto &node : stats) {
+			if (std::string{ node.name } == name)
+				count += node.pixels_skipped;
+		}
+		return count;
+	};
+
+	EXPECT_EQ(3ULL * 320 * 480, num_skipped("premultiply"));
+	// Near the edge of the opaque area, alpha is blurred by the resize.
+	EXPECT_GE(num_skipped("unpremultiply"), 3ULL * 128 * 240);
+	EXPECT_LE(num_skipped("unpremultiply"), 3ULL * 160 * 240);
+
+	// 8-bit images are widened to 16 bits in the opaque area.
+	source.type = zimg::PixelType::BYTE;
+	source.depth = 8;
+	source.fullrange = true;
+	target = source;
+	target.type = zimg::PixelType::WORD;
+	target.depth = 16;
+
+	graph = GraphBuilder{}.set_source(source).connect(target, &params).build_graph();
+
+	ImageBuffer src_b{ source };
+	src_b.fill_random(source, engine);
+
+	for (unsigned i = 0; i < source.height; ++i) {
+		uint8_t *alpha = src_b.buffer()[3].get_line<uint8_t>(i);
+		std::fill_n(alpha, source.width / 2, static_cast<uint8_t>(UINT8_MAX));
+	}
+
+	ImageBuffer dst_b{ target };
+	tmp.resize(graph->get_tmp_size());
+	graph->process(src_b.buffer(), dst_b.buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+	for (unsigned p = 0; p < 3; ++p) {
+		for (unsigned i = 0; i < source.height; ++i) {
+			const uint8_t *src_p = src_b.buffer()[p].get_line<const uint8_t>(i);
+			const uint16_t *dst_p = dst_b.buffer()[p].get_line<const uint16_t>(i);
+
+			for (unsigned j = 0; j < source.width / 2; ++j) {
+				ASSERT_EQ(src_p[j] * 257U, dst_p[j]) << p << " " << i << " " << j;
+			}
+		}
+	}
+
+	stats = graph->get_profiler()->get_stats();
+	EXPECT_EQ(3ULL * 320 * 480, num_skipped("premultiply"));
+}
+
+TEST(FilterGraphTest, test_premultiply_fixed_point)
+{
+	const zimg::PixelFormat formats[] = {
+		{ zimg::PixelType::BYTE, 8, true, false },
+		{ zimg::PixelType::BYTE, 8, false, false },
+		{ zimg::PixelType::BYTE, 8, false, true },
+	};
+
+	for (const zimg::PixelFormat &format : formats) {
+		SCOPED_TRACE(format.fullrange);
+		SCOPED_TRACE(format.chroma);
+
+		zimg::PixelFormat format_out = zimg::graph::premultiplied_format(format);
+		double scale = static_cast<double>(zimg::depth::integer_range(format_out)) / zimg::depth::integer_range(format);
+		double offset_in = zimg::depth::integer_offset(format);
+		double offset_out = zimg::depth::integer_offset(format_out);
+
+		// Every combination of sample and alpha.
+		const unsigned w = 256 * 256;
+		zimg::AlignedVector<uint8_t> src(w);
+		zimg::AlignedVector<uint8_t> alpha(w);
+		zimg::AlignedVector<uint16_t> dst(w);
+
+		for (unsigned j = 0; j < w; ++j) {
+			src[j] = static_cast<uint8_t>(j % 256);
+			alpha[j] = static_cast<uint8_t>(j / 256);
+		}
+
+		zimg::graph::PremultiplyFilter filter{ w, 1, format, zimg::CPUClass::NONE };
+		const graphengine::BufferDescriptor in[2] = { { src.data(), 0, 0 }, { alpha.data(), 0, 0 } };
+		const graphengine::BufferDescriptor out{ dst.data(), 0, 0 };
+		filter.process(in, &out, 0, 0, w, nullptr, nullptr);
+
+		for (unsigned j = 0; j < w; ++j) {
+			double expected = (src[j] - offset_in) * scale * alpha[j] / 255.0 + offset_out;
+			expected = std::min(std::max(expected, 0.0), static_cast<double>(UINT16_MAX));
+			ASSERT_LE(std::fabs(dst[j] - expected), 0.5) << static_cast<unsigned>(src[j]) << " " << static_cast<unsigned>(alpha[j]);
+		}
+	}
+}
+
+TEST(FilterGraphTest, test_multiple_outputs)
+{
+	auto source = make_state(640, 480, zimg::PixelType::WORD, GraphBuilder::ColorFamily::YUV);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+	source.depth = 10;
+
+	auto yuv = make_state(320, 240, zimg::PixelType::BYTE, GraphBuilder::ColorFamily::YUV);
+	yuv.subsample_w = 1;
+	yuv.subsample_h = 1;
+	auto rgb = make_state(800, 600, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::RGB);
+	auto grey = make_state(640, 480, zimg::PixelType::WORD, GraphBuilder::ColorFamily::GREY);
+	auto greyalpha = make_state(320, 240, zimg::PixelType::FLOAT, GraphBuilder::ColorFamily::GREY);
+	greyalpha.alpha = GraphBuilder::AlphaType::STRAIGHT;
+
+	const GraphBuilder::state targets[] = { yuv, rgb, grey, greyalpha };
+	constexpr unsigned num_targets = 4;
+
+	GraphBuilder::params params;
+	params.dither_type = zimg::depth::DitherType::ORDERED;
+
+	GraphBuilder builder;
+	auto graph = builder.set_source(source).connect(targets, num_targets, &params).build_graph();
+	ASSERT_EQ(num_targets, graph->get_num_outputs());
+
+	std::mt19937 engine;
+	ImageBuffer src{ source };
+	src.fill_random(source, engine);
+
+	std::vector<ImageBuffer> dst;
+	std::array<graphengine::BufferDescriptor, 4> dst_buffers[num_targets];
+	for (unsigned i = 0; i < num_targets; ++i) {
+		dst.emplace_back(targets[i]);
+		dst_buffers[i] = dst[i].buffer();
+	}
+
+	auto count_rows = [](void *user, unsigned, unsigned, unsigned) { ++*static_cast<unsigned *>(user); return 0; };
+	unsigned rows[num_targets] = {};
+	int (*pack_cb[num_targets])(void *, unsigned, unsigned, unsigned) = { count_rows, count_rows, count_rows, count_rows };
+	void *pack_user[num_targets] = { &rows[0], &rows[1], &rows[2], &rows[3] };
+
+	zimg::AlignedVector<unsigned char> tmp(graph->get_tmp_size());
+	graph->process(src.buffer(), dst_buffers, tmp.data(), nullptr, nullptr, pack_cb, pack_user);
+
+	for (unsigned i = 0; i < num_targets; ++i) {
+		SCOPED_TRACE(i);
+
+		auto single_graph = GraphBuilder{}.set_source(source).connect(targets[i], &params).build_graph();
+		ImageBuffer dst_ref{ targets[i] };
+		zimg::AlignedVector<unsigned char> single_tmp(single_graph->get_tmp_size());
+		single_graph->process(src.buffer(), dst_ref.buffer(), single_tmp.data(), nullptr, nullptr, nullptr, nullptr);
+
+		EXPECT_TRUE(dst[i].equals(dst_ref));
+		EXPECT_GT(rows[i], 0U);
+	}
+
+	EXPECT_THROW(graph->process(src.buffer(), dst[0].buffer(), tmp.data(), nullptr, nullptr, nullptr, nullptr), zimg::error::IllegalArgument);
+	EXPECT_THROW(graph->process_region(src.buffer(), dst[0].buffer(), tmp.data(), 0, 0, 16, 16), zimg::error::UnsupportedOperation);
+}
@@ -147,11 +147,16 @@ void set_resolution(GraphBuilder::state &state, unsigned width, unsigned height)
 	state.active_height = height;
 }
 
-void test_case(const GraphBuilder::state &source, const GraphBuilder::state &target, const TraceList &trace)
+void test_case(const GraphBuilder::state &source, const std::vector<GraphBuilder::state> &targets, const TraceList &trace, bool chain = false)
 {
 	GraphBuilder builder;
 	TracingObserver observer;
-	builder.set_source(source).connect(target, nullptr, &observer).build_graph();
+	builder.set_source(source);
+
+	if (chain)
+		builder.connect_chain(targets.data(), static_cast<unsigned>(targets.size()), nullptr, &observer).build_graph();
+	else
+		builder.connect(targets.data(), static_cast<unsigned>(targets.size()), nullptr, &observer).build_graph();
 
 	EXPECT_EQ(trace.size(), observer.trace().size());
 	for (size_t i = 0; i < std::min(trace.size(), observer.trace().size()); ++i) {
@@ -163,6 +168,11 @@ void test_case(const GraphBuilder::state &source, const GraphBuilder::state &tar
 	}
 }
 
+void test_case(const GraphBuilder::state &source, const GraphBuilder::state &target, const TraceList &trace)
+{
+	test_case(source, std::vector<GraphBuilder::state>{ target }, trace);
+}
+
 } // namespace
 
 
@@ -325,13 +335,65 @@ TEST(GraphBuilderTest, test_resize_byte_fast_path)
 	auto target = source;
 	set_resolution(target, 128, 96);
 
+	if (zimg::resize::byte_resize_supported()) {
+		test_case(source, target, {
+			"resize",
+		});
+	} else {
+		test_case(source, target, {
+			"depth[0]: [0/8 l:l] => [1/16 l:l]",
+			"resize",
+			"depth[0]: [1/16 l:l] => [0/8 l:l]",
+		});
+	}
+}
+
+TEST(GraphBuilderTest, test_resize_byte_two_pass_downscale)
+{
+	if (!zimg::resize::byte_resize_supported()) {
+		SUCCEED() << "no BYTE resize, skipping";
+		return;
+	}
+
+	auto source = make_basic_rgb_state();
+	source.type = zimg::PixelType::BYTE;
+	source.depth = 8;
+	source.fullrange = true;
+	set_resolution(source, 1920, 1080);
+
+	auto target = source;
+	set_resolution(target, 1280, 720);
+
+	// No depth conversion around the resize.
 	test_case(source, target, {
-		"depth[0]: [0/8 l:l] => [1/16 l:l]",
 		"resize",
-		"depth[0]: [1/16 l:l] => [0/8 l:l]",
 	});
 }
 
+TEST(GraphBuilderTest, test_resize_byte_single_pass)
+{
+	auto source = make_basic_rgb_state();
+	source.type = zimg::PixelType::BYTE;
+	source.depth = 8;
+	source.fullrange = true;
+	set_resolution(source, 64, 48);
+
+	auto target = source;
+	set_resolution(target, 128, 48);
+
+	if (zimg::resize::byte_resize_supported()) {
+		test_case(source, target, {
+			"resize",
+		});
+	} else {
+		test_case(source, target, {
+			"depth[0]: [0/8 l:l] => [1/16 l:l]",
+			"resize",
+			"depth[0]: [1/16 l:l] => [0/8 l:l]",
+		});
+	}
+}
+
 TEST(GraphBuilderTest, test_resize_byte_slow_path)
 {
 	auto source = make_basic_rgb_state();
@@ -404,6 +466,48 @@ TEST(GraphBuilderTest, test_colorspace_only)
 	test_case(source, target, { "colorspace" });
 }
 
+TEST(GraphBuilderTest, test_colorspace_integer)
+{
+	auto source = make_basic_yuv_state();
+	source.type = zimg::PixelType::BYTE;
+	source.depth = 8;
+	source.subsample_w = 1;
+	set_resolution(source, 64, 48);
+
+	auto target = make_basic_rgb_state();
+	target.type = zimg::PixelType::BYTE;
+	target.depth = 8;
+	target.fullrange = true;
+	set_resolution(target, 64, 48);
+
+	// Matrix-only conversions between integer formats do not pass through FLOAT.
+	test_case(source, target, {
+		"resize[1]: [32, 48] => [64, 48]",
+		"colorspace",
+	});
+}
+
+TEST(GraphBuilderTest, test_colorspace_integer_transfer)
+{
+	auto source = make_basic_rgb_state();
+	source.type = zimg::PixelType::WORD;
+	source.depth = 10;
+
+	auto target = make_basic_rgb_state();
+	target.colorspace = { MatrixCoefficients::RGB, TransferCharacteristics::REC_709, ColorPrimaries::REC_2020 };
+
+	// Integer RGB is linearized by table lookup, without a separate conversion to FLOAT.
+	test_case(source, target, { "colorspace" });
+
+	set_resolution(source, 128, 96);
+	// Resampling happens before the colorspace conversion, which then takes FLOAT.
+	test_case(source, target, {
+		"resize[0]: [128, 96] => [64, 48]",
+		"depth[0]: [1/10 l:l] => [3/32 l:l]",
+		"colorspace",
+	});
+}
+
 TEST(GraphBuilderTest, test_upscale_colorspace)
 {
 	auto source = make_basic_yuv_state();
@@ -442,6 +546,48 @@ TEST(GraphBuilderTest, test_downscale_colorspace)
 	});
 }
 
+TEST(GraphBuilderTest, test_multiple_targets)
+{
+	auto source = make_basic_yuv_state();
+	set_resolution(source, 64, 48);
+	source.subsample_w = 1;
+	source.subsample_h = 1;
+
+	auto target1 = source;
+	set_resolution(target1, 96, 72);
+	target1.colorspace = { MatrixCoefficients::REC_2020_NCL, TransferCharacteristics::REC_709, ColorPrimaries::REC_2020 };
+
+	auto target2 = target1;
+	set_resolution(target2, 128, 96);
+
+	// The chroma upsampling and colorspace conversion are shared.
+	test_case(source, { target1, target2, target1 }, {
+		"resize[1]: [32, 24] => [64, 48]",
+		"colorspace",
+		"resize[0]: [64, 48] => [96, 72]",
+		"resize[1]: [64, 48] => [48, 36]",
+		"resize[0]: [64, 48] => [128, 96]",
+	});
+}
+
+TEST(GraphBuilderTest, test_chained_targets)
+{
+	auto source = make_basic_rgb_state();
+	set_resolution(source, 64, 48);
+
+	auto level1 = source;
+	set_resolution(level1, 32, 24);
+
+	auto level2 = source;
+	set_resolution(level2, 16, 12);
+
+	// Each level is resized from the previous level.
+	test_case(source, { level1, level2 }, {
+		"resize[0]: [64, 48] => [32, 24]",
+		"resize[0]: [32, 24] => [16, 12]",
+	}, true);
+}
+
 TEST(GraphBuilderTest, test_upscale_colorspace_tile)
 {
 	auto source = make_basic_yuv_state();
@@ -642,6 +788,29 @@ TEST(GraphBuilderTest, test_resize_straight_alpha)
 	});
 }
 
+TEST(GraphBuilderTest, test_resize_straight_alpha_integer)
+{
+	auto source = make_basic_rgb_state();
+	set_resolution(source, 64, 48);
+	source.type = zimg::PixelType::BYTE;
+	source.depth = 8;
+	source.fullrange = true;
+	source.alpha = GraphBuilder::AlphaType::STRAIGHT;
+
+	auto target = source;
+	set_resolution(target, 128, 96);
+
+	test_case(source, target, {
+		"premultiply",
+		"resize[0]: [64, 48] => [128, 96]",
+		"depth[3]: [0/8 f:l] => [1/16 f:l]",
+		"resize[3]: [64, 48] => [128, 96]",
+		"unpremultiply",
+		"depth[0]: [1/16 f:l] => [0/8 f:l]",
+		"depth[3]: [1/16 f:l] => [0/8 f:l]",
+	});
+}
+
 TEST(GraphBuilderTest, test_resize_premul_alpha)
 {
 	auto source = make_basic_rgb_state();
@@ -0,0 +1,138 @@
+#ifdef ZIMG_X86
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/alloc.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "graph/simple_filters.h"
+#include "graph/x86/premultiply_x86.h"
+#include "graphengine/filter.h"
+
+#include "gtest/gtest.h"
+#include "graphengine/filter_validation.h"
+
+namespace {
+
+void test_case(const zimg::PixelFormat &format, bool unpremultiply, const char *expected_sha1, double expected_snr)
+{
+	const unsigned w = 640;
+	const unsigned h = 480;
+
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	std::unique_ptr<graphengine::Filter> filter_c;
+	std::unique_ptr<graphengine::Filter> filter_avx2;
+	zimg::PixelFormat format_out = format;
+
+	if (unpremultiply) {
+		filter_c = std::make_unique<zimg::graph::UnpremultiplyFilter>(w, h, format, zimg::CPUClass::NONE);
+		filter_avx2 = std::make_unique<zimg::graph::UnpremultiplyFilter>(w, h, format, zimg::CPUClass::X86_AVX2);
+	} else {
+		filter_c = std::make_unique<zimg::graph::PremultiplyFilter>(w, h, format, zimg::CPUClass::NONE);
+		filter_avx2 = std::make_unique<zimg::graph::PremultiplyFilter>(w, h, format, zimg::CPUClass::X86_AVX2);
+		format_out = zimg::graph::premultiplied_format(format);
+	}
+
+	graphengine::FilterValidation(filter_avx2.get(), { w, h, zimg::pixel_size(format.type) })
+		.set_reference_filter(filter_c.get(), expected_snr)
+		.set_input_pixel_format({ format.depth, zimg::pixel_is_float(format.type), format.chroma })
+		.set_output_pixel_format({ format_out.depth, zimg::pixel_is_float(format_out.type), format_out.chroma })
+		.set_sha1(0, expected_sha1)
+		.run();
+}
+
+template <class T>
+void test_case_opaque(zimg::graph::alpha_opaque_func func, T alpha_max)
+{
+	if (!zimg::query_x86_capabilities().avx2) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	const unsigned w = 256;
+	zimg::graph::PremultiplyParams params{};
+	params.alpha_max = static_cast<int32_t>(alpha_max);
+
+	zimg::AlignedVector<T> alpha(w, alpha_max);
+
+	// A single transparent sample must be found at any position in the range.
+	for (unsigned n = 0; n < w; n += 7) {
+		alpha[n] = static_cast<T>(alpha_max / 2);
+
+		for (unsigned left : { 0U, 1U, 31U, 64U, 100U }) {
+			for (unsigned right : { 101U, 128U, 200U, 255U, 256U }) {
+				bool expected = std::all_of(alpha.data() + left, alpha.data() + right, [=](T a) { return a == alpha_max; });
+				ASSERT_EQ(expected, func(alpha.data(), params, left, right)) << n << " " << left << " " << right;
+			}
+		}
+
+		alpha[n] = alpha_max;
+	}
+}
+
+} // namespace
+
+
+TEST(PremultiplyAVX2Test, test_premultiply_b2w)
+{
+	static const char *expected_sha1[] = {
+		"086a258078ca90ab80130642598761b9aceb23e4",
+		"7ec2286d794c6dbd5cd223f64a4adb7b9a754b07",
+		"6533005925d2e6bfe936d8f289c595daab4a91ca"
+	};
+
+	test_case({ zimg::PixelType::BYTE, 8, true, false }, false, expected_sha1[0], INFINITY);
+	test_case({ zimg::PixelType::BYTE, 8, false, false }, false, expected_sha1[1], INFINITY);
+	test_case({ zimg::PixelType::BYTE, 8, false, true }, false, expected_sha1[2], INFINITY);
+}
+
+TEST(PremultiplyAVX2Test, test_premultiply_w2w)
+{
+	static const char *expected_sha1[] = {
+		"2d82ac2543b9c7a7b22839daa61febe26459eff0",
+		"073d9ffed0e7c46854dff21374e367b78194cbd8"
+	};
+
+	test_case({ zimg::PixelType::WORD, 10, false, false }, false, expected_sha1[0], INFINITY);
+	test_case({ zimg::PixelType::WORD, 16, true, false }, false, expected_sha1[1], INFINITY);
+}
+
+TEST(PremultiplyAVX2Test, test_premultiply_f32)
+{
+	test_case(zimg::PixelType::FLOAT, false, "2d6687a7824ca99105a4551475334f55ba29fd3a", INFINITY);
+}
+
+TEST(PremultiplyAVX2Test, test_unpremultiply_w2w)
+{
+	static const char *expected_sha1[] = {
+		"3d9b2a3e2f7e82434c9747d10a184fd90e46cfde",
+		"40c9c9a28544cf47502a1f32deef0ba812120cf1"
+	};
+
+	test_case({ zimg::PixelType::WORD, 16, true, false }, true, expected_sha1[0], INFINITY);
+	test_case({ zimg::PixelType::WORD, 16, false, true }, true, expected_sha1[1], INFINITY);
+}
+
+TEST(PremultiplyAVX2Test, test_unpremultiply_f32)
+{
+	test_case(zimg::PixelType::FLOAT, true, "91d4a8b3bcf614b191becee3caf96a97d2029178", INFINITY);
+}
+
+TEST(PremultiplyAVX2Test, test_alpha_opaque)
+{
+	SCOPED_TRACE("b");
+	test_case_opaque<uint8_t>(zimg::graph::alpha_opaque_b_avx2, 255);
+	SCOPED_TRACE("w");
+	test_case_opaque<uint16_t>(zimg::graph::alpha_opaque_w_avx2, 1023);
+	SCOPED_TRACE("f32");
+	test_case_opaque<float>(zimg::graph::alpha_opaque_f32_avx2, 1.0f);
+}
+
+#endif // ZIMG_X86
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "graphengine/filter.h"
+#include "resize/chroma_upsample.h"
+#include "resize/filter.h"
+#include "resize/resize.h"
+#include "resize/resize_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Plane {
+	std::vector<unsigned char> data;
+	unsigned width;
+	unsigned height;
+	zimg::PixelType type;
+
+	Plane(unsigned width, unsigned height, zimg::PixelType type) :
+		data(static_cast<size_t>(width) * height * zimg::pixel_size(type)),
+		width{ width },
+		height{ height },
+		type{ type }
+	{}
+
+	graphengine::BufferDescriptor buffer() { return{ data.data(), static_cast<ptrdiff_t>(width * zimg::pixel_size(type)), graphengine::BUFFER_MAX }; }
+
+	void fill_random(std::mt19937 &engine, unsigned depth)
+	{
+		size_t n = static_cast<size_t>(width) * height;
+
+		if (type == zimg::PixelType::FLOAT) {
+			std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+			for (size_t i = 0; i < n; ++i) {
+				float x = dist(engine);
+				std::memcpy(&data[i * sizeof(float)], &x, sizeof(float));
+			}
+		} else {
+			std::uniform_int_distribution<unsigned> dist(0, (1U << depth) - 1);
+			for (size_t i = 0; i < n; ++i) {
+				if (type == zimg::PixelType::BYTE) {
+					data[i] = static_cast<uint8_t>(dist(engine));
+				} else {
+					uint16_t x = static_cast<uint16_t>(dist(engine));
+					std::memcpy(&data[i * sizeof(uint16_t)], &x, sizeof(uint16_t));
+				}
+			}
+		}
+	}
+};
+
+void run_filter(const graphengine::Filter &filter, const graphengine::BufferDescriptor in[], const graphengine::BufferDescriptor out[], unsigned tile_width)
+{
+	const graphengine::FilterDescriptor &desc = filter.descriptor();
+	std::vector<unsigned char> tmp(desc.scratchpad_size + 64);
+
+	for (unsigned i = 0; i < desc.format.height; i += desc.step) {
+		for (unsigned j = 0; j < desc.format.width; j += tile_width) {
+			filter.process(in, out, i, j, std::min(j + tile_width, desc.format.width), nullptr, tmp.data());
+		}
+	}
+}
+
+// Resizes each plane with the separable C resizer, vertical pass first.
+Plane reference_resize(const zimg::resize::ResizeConversion &conv, Plane src)
+{
+	auto builder = zimg::resize::ResizeImplBuilder{ src.width, src.height, conv.type }
+		.set_depth(conv.depth)
+		.set_filter(conv.filter)
+		.set_cpu(zimg::CPUClass::NONE);
+
+	if (conv.dst_height != conv.src_height || conv.shift_h) {
+		Plane dst{ src.width, conv.dst_height, conv.type };
+		auto filter = builder.set_horizontal(false).set_dst_dim(conv.dst_height).set_shift(conv.shift_h).set_subwidth(conv.subheight).create();
+		graphengine::BufferDescriptor in = src.buffer();
+		graphengine::BufferDescriptor out = dst.buffer();
+		run_filter(*filter, &in, &out, dst.width);
+		src = std::move(dst);
+	}
+	if (conv.dst_width != conv.src_width || conv.shift_w) {
+		Plane dst{ conv.dst_width, src.height, conv.type };
+		builder.src_height = src.height;
+		auto filter = builder.set_horizontal(true).set_dst_dim(conv.dst_width).set_shift(conv.shift_w).set_subwidth(conv.subwidth).create();
+		graphengine::BufferDescriptor in = src.buffer();
+		graphengine::BufferDescriptor out = dst.buffer();
+		run_filter(*filter, &in, &out, dst.width);
+		src = std::move(dst);
+	}
+	return src;
+}
+
+void test_case(const zimg::resize::Filter &resample_filter, zimg::PixelType type, unsigned depth, unsigned subsample_w, unsigned subsample_h, double shift_w, double shift_h)
+{
+	const unsigned src_w = 160;
+	const unsigned src_h = 90;
+	const unsigned dst_w = src_w << subsample_w;
+	const unsigned dst_h = src_h << subsample_h;
+
+	zimg::resize::ResizeConversion conv{ src_w, src_h, type };
+	conv.set_depth(depth)
+		.set_filter(&resample_filter)
+		.set_dst_width(dst_w)
+		.set_dst_height(dst_h)
+		.set_shift_w(shift_w)
+		.set_shift_h(shift_h);
+
+	auto filter = zimg::resize::create_chroma_upsample(conv);
+	ASSERT_TRUE(filter);
+	EXPECT_EQ(2U, filter->descriptor().num_deps);
+	EXPECT_EQ(2U, filter->descriptor().num_planes);
+
+	std::mt19937 engine;
+	Plane src[2] = { { src_w, src_h, type }, { src_w, src_h, type } };
+
+	for (Plane &plane : src) {
+		plane.fill_random(engine, depth);
+	}
+
+	Plane expected[2] = { reference_resize(conv, src[0]), reference_resize(conv, src[1]) };
+
+	// Odd tile widths start some tiles on the second phase of the filter.
+	for (unsigned tile_width : { dst_w, 37U }) {
+		SCOPED_TRACE(tile_width);
+
+		Plane dst[2] = { { dst_w, dst_h, type }, { dst_w, dst_h, type } };
+		graphengine::BufferDescriptor in[2] = { src[0].buffer(), src[1].buffer() };
+		graphengine::BufferDescriptor out[2] = { dst[0].buffer(), dst[1].buffer() };
+		run_filter(*filter, in, out, tile_width);
+
+		for (unsigned p = 0; p < 2; ++p) {
+			for (size_t i = 0; i < dst[p].data.size(); ++i) {
+				ASSERT_EQ(expected[p].data[i], dst[p].data[i]) << "plane " << p << " byte " << i;
+			}
+		}
+	}
+}
+
+void test_case(const zimg::resize::Filter &resample_filter, unsigned subsample_w, unsigned subsample_h, double shift_w, double shift_h)
+{
+	const std::pair<zimg::PixelType, unsigned> formats[] = {
+		{ zimg::PixelType::BYTE, 8 },
+		{ zimg::PixelType::WORD, 10 },
+		{ zimg::PixelType::WORD, 16 },
+		{ zimg::PixelType::FLOAT, 32 },
+	};
+
+	for (const auto &format : formats) {
+		SCOPED_TRACE(static_cast<int>(format.first));
+		SCOPED_TRACE(format.second);
+
+		// 8-bit images are upsampled in one direction only.
+		if (format.first == zimg::PixelType::BYTE && (subsample_w || shift_w) && (subsample_h || shift_h))
+			continue;
+
+		test_case(resample_filter, format.first, format.second, subsample_w, subsample_h, shift_w, shift_h);
+	}
+}
+
+} // namespace
+
+
+TEST(ChromaUpsampleTest, test_420)
+{
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::BicubicFilter bicubic{};
+	const zimg::resize::Spline16Filter spline16{};
+	const zimg::resize::Filter *resample_filters[] = { &bilinear, &bicubic, &spline16 };
+
+	for (const zimg::resize::Filter *resample_filter : resample_filters) {
+		SCOPED_TRACE(resample_filter->support());
+
+		SCOPED_TRACE("left");
+		test_case(*resample_filter, 1, 1, -0.25, 0.0);
+		SCOPED_TRACE("center");
+		test_case(*resample_filter, 1, 1, 0.0, 0.0);
+		SCOPED_TRACE("top-left");
+		test_case(*resample_filter, 1, 1, -0.25, -0.25);
+	}
+}
+
+TEST(ChromaUpsampleTest, test_422_440)
+{
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::BicubicFilter bicubic{};
+	const zimg::resize::Filter *resample_filters[] = { &bilinear, &bicubic };
+
+	for (const zimg::resize::Filter *resample_filter : resample_filters) {
+		SCOPED_TRACE(resample_filter->support());
+
+		SCOPED_TRACE("422");
+		test_case(*resample_filter, 1, 0, -0.25, 0.0);
+		SCOPED_TRACE("440");
+		test_case(*resample_filter, 0, 1, 0.0, -0.25);
+		SCOPED_TRACE("422 field");
+		test_case(*resample_filter, 1, 0, -0.25, 0.25);
+	}
+}
+
+TEST(ChromaUpsampleTest, test_unsupported)
+{
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::LanczosFilter lanczos{ 3 };
+
+	zimg::resize::ResizeConversion conv{ 160, 90, zimg::PixelType::FLOAT };
+	conv.set_filter(&bilinear)
+		.set_dst_width(320)
+		.set_dst_height(180);
+	EXPECT_TRUE(zimg::resize::create_chroma_upsample(conv));
+
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv }.set_filter(&lanczos)));
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv }.set_dst_width(480)));
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv }.set_dst_width(80)));
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv }.set_subwidth(100.0)));
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv }.set_dst_width(160).set_dst_height(90)));
+
+	zimg::resize::ResizeConversion conv_half{ 160, 90, zimg::PixelType::HALF };
+	conv_half.set_filter(&bilinear)
+		.set_dst_width(320)
+		.set_dst_height(180);
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(conv_half));
+
+	zimg::resize::ResizeConversion conv_byte{ 160, 90, zimg::PixelType::BYTE };
+	conv_byte.set_filter(&bilinear)
+		.set_dst_width(320)
+		.set_dst_height(180);
+	EXPECT_FALSE(zimg::resize::create_chroma_upsample(conv_byte));
+	EXPECT_TRUE(zimg::resize::create_chroma_upsample(zimg::resize::ResizeConversion{ conv_byte }.set_dst_height(90)));
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include "resize/filter.h"
 
@@ -104,3 +105,76 @@ TEST(FilterTest, test_lanczos)
 		check_interpolating(f);
 	}
 }
+
+TEST(FilterTest, test_compute_filter_shared)
+{
+	zimg::resize::LanczosFilter lanczos3{ 3 };
+	zimg::resize::LanczosFilter lanczos4{ 4 };
+	zimg::resize::BicubicFilter bicubic{};
+
+	auto a = zimg::resize::compute_filter_shared(lanczos3, 1920, 1280, 0.0, 1920.0);
+	auto b = zimg::resize::compute_filter_shared(zimg::resize::LanczosFilter{ 3 }, 1920, 1280, -0.0, 1920.0);
+	EXPECT_EQ(a, b);
+
+	EXPECT_NE(a, zimg::resize::compute_filter_shared(lanczos4, 1920, 1280, 0.0, 1920.0));
+	EXPECT_NE(a, zimg::resize::compute_filter_shared(bicubic, 1920, 1280, 0.0, 1920.0));
+	EXPECT_NE(a, zimg::resize::compute_filter_shared(lanczos3, 1920, 1280, 0.25, 1920.0));
+	EXPECT_NE(a, zimg::resize::compute_filter_shared(lanczos3, 1920, 720, 0.0, 1920.0));
+
+	zimg::resize::FilterContext ref = zimg::resize::compute_filter(lanczos3, 1920, 1280, 0.0, 1920.0);
+	EXPECT_EQ(ref.filter_width, a->filter_width);
+	EXPECT_EQ(ref.filter_rows, a->filter_rows);
+	EXPECT_TRUE(std::equal(ref.data.begin(), ref.data.end(), a->data.begin(), a->data.end()));
+	EXPECT_TRUE(std::equal(ref.data_i16.begin(), ref.data_i16.end(), a->data_i16.begin(), a->data_i16.end()));
+	EXPECT_TRUE(std::equal(ref.left.begin(), ref.left.end(), a->left.begin(), a->left.end()));
+}
+
+TEST(FilterTest, test_compute_filter_shared_reuse)
+{
+	zimg::resize::Spline36Filter spline36;
+
+	// Release the first instance before requesting it again, as when a graph
+	// is freed and then rebuilt with the same parameters.
+	auto a = zimg::resize::compute_filter_shared(spline36, 3840, 1366, 0.0, 3840.0);
+	const zimg::resize::FilterContext *first = a.get();
+	a.reset();
+
+	auto b = zimg::resize::compute_filter_shared(spline36, 3840, 1366, 0.0, 3840.0);
+	EXPECT_EQ(first, b.get());
+}
+
+TEST(FilterTest, test_polyphase_filter)
+{
+	zimg::resize::LanczosFilter lanczos4{ 4 };
+
+	auto check_rows = [](const zimg::resize::FilterContext &dense, const zimg::resize::FilterContext &poly)
+	{
+		ASSERT_EQ(dense.filter_rows, poly.filter_rows);
+		EXPECT_TRUE(std::equal(dense.left.begin(), dense.left.end(), poly.left.begin(), poly.left.end()));
+
+		for (unsigned i = 0; i < dense.filter_rows; ++i) {
+			ASSERT_TRUE(std::equal(dense.row(i), dense.row(i) + dense.filter_width, poly.row(i))) << "row " << i;
+			ASSERT_TRUE(std::equal(dense.row_i16(i), dense.row_i16(i) + dense.filter_width, poly.row_i16(i))) << "row " << i;
+		}
+	};
+
+	// 4320 to 2880 lines repeats two phases away from the edges.
+	zimg::resize::FilterContext dense = zimg::resize::compute_filter(lanczos4, 4320, 2880, 0.0, 4320.0);
+	zimg::resize::FilterContext poly = zimg::resize::make_polyphase_filter(dense);
+	EXPECT_TRUE(dense.phase.empty());
+	EXPECT_EQ(dense.filter_rows, poly.phase.size());
+	EXPECT_LT(poly.data.size(), dense.data.size() / 64);
+	check_rows(dense, poly);
+
+	// Irrational scale factors have no repeated rows.
+	dense = zimg::resize::compute_filter(lanczos4, 4320, 2880, 0.0, 4320.0 * std::sqrt(2.0));
+	poly = zimg::resize::make_polyphase_filter(dense);
+	EXPECT_TRUE(poly.phase.empty());
+	check_rows(dense, poly);
+
+	auto a = zimg::resize::compute_filter_shared(lanczos4, 4320, 2880, 0.0, 4320.0);
+	auto b = zimg::resize::compute_filter_shared(lanczos4, 4320, 2880, 0.0, 4320.0, true);
+	EXPECT_NE(a, b);
+	EXPECT_TRUE(a->phase.empty());
+	EXPECT_FALSE(b->phase.empty());
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
 #include "common/cpuinfo.h"
 #include "common/pixel.h"
 #include "graphengine/filter.h"
@@ -45,6 +49,68 @@ void test_case(const zimg::PixelFormat &format, bool horizontal, double scale_fa
 	}
 }
 
+// Resizes 8-bit data as BYTE and as WORD and checks that the results are identical.
+void test_case_byte(bool horizontal, double scale_factor)
+{
+	const unsigned src_w = 640;
+	const unsigned src_h = 480;
+	const unsigned dst_w = horizontal ? static_cast<unsigned>(std::lrint(scale_factor * src_w)) : src_w;
+	const unsigned dst_h = horizontal ? src_h : static_cast<unsigned>(std::lrint(scale_factor * src_h));
+
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::LanczosFilter lanczos4{ 4 };
+	const zimg::resize::Filter *resample_filters[] = { &bilinear, &lanczos4 };
+
+	std::mt19937 engine;
+	std::vector<uint8_t> src_u8(static_cast<size_t>(src_w) * src_h);
+	std::vector<uint16_t> src_u16(src_u8.size());
+
+	for (size_t i = 0; i < src_u8.size(); ++i) {
+		src_u8[i] = static_cast<uint8_t>(engine() & 0xFF);
+		src_u16[i] = src_u8[i];
+	}
+
+	for (const zimg::resize::Filter *resample_filter : resample_filters) {
+		SCOPED_TRACE(resample_filter->support());
+
+		auto builder = zimg::resize::ResizeImplBuilder{ src_w, src_h, zimg::PixelType::BYTE }
+			.set_horizontal(horizontal)
+			.set_dst_dim(horizontal ? dst_w : dst_h)
+			.set_depth(8)
+			.set_filter(resample_filter)
+			.set_shift(0.0)
+			.set_subwidth(horizontal ? src_w : src_h)
+			.set_cpu(zimg::CPUClass::NONE);
+
+		auto filter_u8 = builder.create();
+		builder.type = zimg::PixelType::WORD;
+		auto filter_u16 = builder.create();
+
+		ASSERT_TRUE(filter_u8);
+		ASSERT_TRUE(filter_u16);
+
+		std::vector<uint8_t> dst_u8(static_cast<size_t>(dst_w) * dst_h);
+		std::vector<uint16_t> dst_u16(dst_u8.size());
+		std::vector<unsigned char> tmp(std::max(filter_u8->descriptor().scratchpad_size, filter_u16->descriptor().scratchpad_size) + 64);
+
+		graphengine::BufferDescriptor in_u8{ src_u8.data(), static_cast<ptrdiff_t>(src_w), graphengine::BUFFER_MAX };
+		graphengine::BufferDescriptor out_u8{ dst_u8.data(), static_cast<ptrdiff_t>(dst_w), graphengine::BUFFER_MAX };
+		graphengine::BufferDescriptor in_u16{ src_u16.data(), static_cast<ptrdiff_t>(src_w * sizeof(uint16_t)), graphengine::BUFFER_MAX };
+		graphengine::BufferDescriptor out_u16{ dst_u16.data(), static_cast<ptrdiff_t>(dst_w * sizeof(uint16_t)), graphengine::BUFFER_MAX };
+
+		for (unsigned i = 0; i < dst_h; i += filter_u8->descriptor().step) {
+			filter_u8->process(&in_u8, &out_u8, i, 0, dst_w, nullptr, tmp.data());
+		}
+		for (unsigned i = 0; i < dst_h; i += filter_u16->descriptor().step) {
+			filter_u16->process(&in_u16, &out_u16, i, 0, dst_w, nullptr, tmp.data());
+		}
+
+		for (size_t i = 0; i < dst_u8.size(); ++i) {
+			ASSERT_EQ(dst_u16[i], dst_u8[i]) << "pixel " << i;
+		}
+	}
+}
+
 } // namespace
 
 
@@ -292,3 +358,51 @@ TEST(ResizeImplTest, test_vertical_shift)
 		test_case(zimg::PixelType::FLOAT, false, 1.0 / 2.1, shift, subwidth_factor, expected_sha1_down);
 	}
 }
+
+TEST(ResizeImplTest, test_byte)
+{
+	{
+		SCOPED_TRACE("horizontal-up");
+		test_case_byte(true, 2.1);
+	}
+	{
+		SCOPED_TRACE("horizontal-down");
+		test_case_byte(true, 1.0 / 2.1);
+	}
+	{
+		SCOPED_TRACE("vertical-up");
+		test_case_byte(false, 2.1);
+	}
+	{
+		SCOPED_TRACE("vertical-down");
+		test_case_byte(false, 1.0 / 2.1);
+	}
+}
+
+TEST(ResizeImplTest, test_filter_decimation)
+{
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::LanczosFilter lanczos4{ 4 };
+	const zimg::resize::Filter *resample_filters[] = { &bilinear, &lanczos4 };
+
+	auto is_empty = [](const zimg::resize::FilterDecimation &decimation) { return decimation.left == decimation.right; };
+
+	for (const zimg::resize::Filter *resample_filter : resample_filters) {
+		SCOPED_TRACE(resample_filter->support());
+
+		zimg::resize::FilterContext filter = zimg::resize::compute_filter(*resample_filter, 1280, 640, 0.0, 1280.0);
+		zimg::resize::FilterDecimation decimation = zimg::resize::find_filter_decimation(filter);
+
+		EXPECT_LT(decimation.left, decimation.right);
+		EXPECT_LE(decimation.right, filter.filter_rows);
+
+		for (unsigned j = decimation.left; j < decimation.right; ++j) {
+			ASSERT_EQ(static_cast<int>(j * 2) + decimation.offset, static_cast<int>(filter.left[j])) << "column " << j;
+		}
+
+		EXPECT_TRUE(is_empty(zimg::resize::find_filter_decimation(zimg::resize::compute_filter(*resample_filter, 640, 1280, 0.0, 640.0))));
+		EXPECT_TRUE(is_empty(zimg::resize::find_filter_decimation(zimg::resize::compute_filter(*resample_filter, 1344, 640, 0.0, 1344.0))));
+		EXPECT_TRUE(is_empty(zimg::resize::find_filter_decimation(zimg::resize::compute_filter(*resample_filter, 640 * 3, 640, 0.0, 640.0 * 3))));
+		EXPECT_TRUE(is_empty(zimg::resize::find_filter_decimation(zimg::resize::compute_filter(*resample_filter, 640 * 4, 640, 0.0, 640.0 * 4))));
+	}
+}
@@ -0,0 +1,131 @@
+#ifdef ZIMG_X86
+
+#include <cmath>
+#include "common/cpuinfo.h"
+#include "common/pixel.h"
+#include "common/x86/cpuinfo_x86.h"
+#include "graphengine/filter.h"
+#include "resize/chroma_upsample.h"
+#include "resize/filter.h"
+#include "resize/resize.h"
+
+#include "gtest/gtest.h"
+#include "graphengine/filter_validation.h"
+
+namespace {
+
+void test_case(const zimg::resize::Filter &filter, unsigned subsample_w, unsigned subsample_h, double shift_w, double shift_h, const char * const expected_sha1[2], double expected_snr)
+{
+	const unsigned src_w = 320;
+	const unsigned src_h = 240;
+
+	if (!zimg::query_x86_capabilities().avx2 || !zimg::query_x86_capabilities().fma) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	SCOPED_TRACE(filter.support());
+
+	zimg::resize::ResizeConversion conv{ src_w, src_h, zimg::PixelType::FLOAT };
+	conv.set_filter(&filter)
+		.set_dst_width(src_w << subsample_w)
+		.set_dst_height(src_h << subsample_h)
+		.set_shift_w(shift_w)
+		.set_shift_h(shift_h);
+
+	auto filter_c = zimg::resize::create_chroma_upsample(conv.set_cpu(zimg::CPUClass::NONE));
+	auto filter_avx2 = zimg::resize::create_chroma_upsample(conv.set_cpu(zimg::CPUClass::X86_AVX2));
+
+	ASSERT_TRUE(filter_c);
+	ASSERT_TRUE(filter_avx2);
+
+	graphengine::FilterValidation(filter_avx2.get(), { src_w, src_h, zimg::pixel_size(zimg::PixelType::FLOAT) })
+		.set_reference_filter(filter_c.get(), expected_snr)
+		.set_input_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, true })
+		.set_input_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, true })
+		.set_output_pixel_format(0, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, true })
+		.set_output_pixel_format(1, { zimg::pixel_depth(zimg::PixelType::FLOAT), true, true })
+		.set_sha1(0, expected_sha1[0])
+		.set_sha1(1, expected_sha1[1])
+		.run();
+}
+
+} // namespace
+
+
+TEST(ChromaUpsampleAVX2Test, test_420)
+{
+	static const char *expected_sha1[][2] = {
+		{ "7f872e3f8f5e62f1c349591628f7cd65d94a4171", "ceebd842f586959a19f7d335644ffa86e9faab48" },
+		{ "5426dec9649c8b343a51d2ffdd85b7199c6eba5b", "28de3b8b4c3bbf75caf439c4a452e481661138e3" },
+		{ "612180a0c99ff4ff57e0f616da77fd5a94b5d832", "dc470ee994f51b80b04bb800520bf8a5173da5d1" },
+	};
+
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::BicubicFilter bicubic{};
+	const double expected_snr = 120.0;
+
+	test_case(bilinear, 1, 1, -0.25, 0.0, expected_sha1[0], expected_snr);
+	test_case(bicubic, 1, 1, -0.25, 0.0, expected_sha1[1], expected_snr);
+	test_case(bicubic, 1, 1, 0.0, 0.0, expected_sha1[2], expected_snr);
+}
+
+TEST(ChromaUpsampleAVX2Test, test_422_440)
+{
+	static const char *expected_sha1[][2] = {
+		{ "65062545d964acc36414145cc6dc748ec4a5cf78", "5e64f86180454cab97aa7d72739602456b5f910b" },
+		{ "7b52a3ff0362d9df6ade392d77f20f8fb6feac59", "72e0e1c2f54899611b274e0705acefcdd1caaa6f" },
+		{ "fd8742feda9ab04faf199d0fe016438f538cb882", "1c3679791a34459bc5b0a007e47d0a240f965eac" },
+		{ "fcd2a88408f5fee9233b14dfc6f548fb6c286ae9", "0f73f9c2fa4d28939900f0db34bfac4e11156f50" },
+	};
+
+	const zimg::resize::BilinearFilter bilinear{};
+	const zimg::resize::BicubicFilter bicubic{};
+	const double expected_snr = 120.0;
+
+	test_case(bilinear, 1, 0, -0.25, 0.0, expected_sha1[0], expected_snr);
+	test_case(bicubic, 1, 0, -0.25, 0.0, expected_sha1[1], expected_snr);
+	test_case(bilinear, 0, 1, 0.0, -0.25, expected_sha1[2], expected_snr);
+	test_case(bicubic, 0, 1, 0.0, -0.25, expected_sha1[3], expected_snr);
+}
+
+TEST(ChromaUpsampleAVX2Test, test_integer)
+{
+	const unsigned src_w = 320;
+	const unsigned src_h = 240;
+
+	if (!zimg::query_x86_capabilities().avx2 || !zimg::query_x86_capabilities().fma) {
+		SUCCEED() << "avx2 not available, skipping";
+		return;
+	}
+
+	const zimg::resize::BicubicFilter bicubic{};
+	const zimg::PixelType types[] = { zimg::PixelType::BYTE, zimg::PixelType::WORD };
+
+	// The integer kernels round exactly like the C kernels.
+	for (zimg::PixelType type : types) {
+		SCOPED_TRACE(static_cast<int>(type));
+
+		zimg::resize::ResizeConversion conv{ src_w, src_h, type };
+		conv.set_filter(&bicubic)
+			.set_dst_width(src_w * 2)
+			.set_dst_height(type == zimg::PixelType::BYTE ? src_h : src_h * 2)
+			.set_shift_w(-0.25);
+
+		auto filter_c = zimg::resize::create_chroma_upsample(conv.set_cpu(zimg::CPUClass::NONE));
+		auto filter_avx2 = zimg::resize::create_chroma_upsample(conv.set_cpu(zimg::CPUClass::X86_AVX2));
+
+		ASSERT_TRUE(filter_c);
+		ASSERT_TRUE(filter_avx2);
+
+		graphengine::FilterValidation(filter_avx2.get(), { src_w, src_h, zimg::pixel_size(type) })
+			.set_reference_filter(filter_c.get(), INFINITY)
+			.set_input_pixel_format(0, { zimg::pixel_depth(type), false, true })
+			.set_input_pixel_format(1, { zimg::pixel_depth(type), false, true })
+			.set_output_pixel_format(0, { zimg::pixel_depth(type), false, true })
+			.set_output_pixel_format(1, { zimg::pixel_depth(type), false, true })
+			.run();
+	}
+}
+
+#endif // ZIMG_X86
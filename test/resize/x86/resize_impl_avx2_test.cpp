@@ -55,6 +55,27 @@ void test_case(const zimg::resize::Filter &filter, bool horizontal, unsigned src
 } // namespace
 
 
+TEST(ResizeImplAVX2Test, test_resize_h_u8)
+{
+	const unsigned src_w = 640;
+	const unsigned dst_w = 960;
+	const unsigned h = 480;
+	const zimg::PixelFormat format{ zimg::PixelType::BYTE, 8 };
+
+	static const char *expected_sha1[] = {
+		"d25af586a747c02b3f07d17168ecba710f570957",
+		"9fac889f1f1cf657304f7ce98d7b084abcea4555",
+		"b87a817d682b4b86e68bcc3340a0bfbeb24149b1",
+		"7113b2c9468bc4b8d748cf48e4e808f4ba2a178c"
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(zimg::resize::BilinearFilter{}, true, src_w, h, dst_w, h, format, expected_sha1[0], expected_snr);
+	test_case(zimg::resize::Spline16Filter{}, true, src_w, h, dst_w, h, format, expected_sha1[1], expected_snr);
+	test_case(zimg::resize::LanczosFilter{ 4 }, true, src_w, h, dst_w, h, format, expected_sha1[2], expected_snr);
+	test_case(zimg::resize::LanczosFilter{ 4 }, true, dst_w, h, src_w, h, format, expected_sha1[3], expected_snr);
+}
+
 TEST(ResizeImplAVX2Test, test_resize_h_u10)
 {
 	const unsigned src_w = 640;
@@ -97,6 +118,27 @@ TEST(ResizeImplAVX2Test, test_resize_h_u16)
 	test_case(zimg::resize::LanczosFilter{ 4 }, true, dst_w, h, src_w, h, format, expected_sha1[3], expected_snr);
 }
 
+TEST(ResizeImplAVX2Test, test_resize_v_u8)
+{
+	const unsigned w = 640;
+	const unsigned src_h = 480;
+	const unsigned dst_h = 720;
+	const zimg::PixelFormat format{ zimg::PixelType::BYTE, 8 };
+
+	static const char *expected_sha1[] = {
+		"08d0ac1e90d884a0da4b9dae5cede654e33fdc75",
+		"41654c038c26c15b408366993257a9bdca5a8d73",
+		"d1a168cacbe9ce4321c716cf2ce73af31ccbfdbc",
+		"17569d3afa2d4072372a0157b3bdb150ad4ab9e2"
+	};
+	const double expected_snr = INFINITY;
+
+	test_case(zimg::resize::BilinearFilter{}, false, w, src_h, w, dst_h, format, expected_sha1[0], expected_snr);
+	test_case(zimg::resize::Spline16Filter{}, false, w, src_h, w, dst_h, format, expected_sha1[1], expected_snr);
+	test_case(zimg::resize::LanczosFilter{ 4 }, false, w, src_h, w, dst_h, format, expected_sha1[2], expected_snr);
+	test_case(zimg::resize::LanczosFilter{ 4 }, false, w, dst_h, w, src_h, format, expected_sha1[3], expected_snr);
+}
+
 TEST(ResizeImplAVX2Test, test_resize_v_u10)
 {
 	const unsigned w = 640;
@@ -200,6 +242,25 @@ TEST(ResizeImplAVX2Test, test_resize_h_f32)
 	test_case(zimg::resize::LanczosFilter{ 4 }, true, dst_w, h, src_w, h, format, expected_sha1[3], expected_snr);
 }
 
+TEST(ResizeImplAVX2Test, test_resize_h_f32_decimate)
+{
+	const unsigned src_w = 1282;
+	const unsigned dst_w = 641;
+	const unsigned h = 480;
+	const zimg::PixelType format = zimg::PixelType::FLOAT;
+
+	static const char *expected_sha1[] = {
+		"17fc8a96f80b8aa647e3b2d099b24c800c8cf8dc",
+		"cb9c181999ba1d55efa6533fa328b4ecf27be62b",
+		"ec80e746df5a9c295eb05b42dc77ff812ea032f1"
+	};
+	const double expected_snr = 120.0;
+
+	test_case(zimg::resize::BilinearFilter{}, true, src_w, h, dst_w, h, format, expected_sha1[0], expected_snr);
+	test_case(zimg::resize::Spline16Filter{}, true, src_w, h, dst_w, h, format, expected_sha1[1], expected_snr);
+	test_case(zimg::resize::LanczosFilter{ 4 }, true, src_w, h, dst_w, h, format, expected_sha1[2], expected_snr);
+}
+
 TEST(ResizeImplAVX2Test, test_resize_v_f32)
 {
 	const unsigned w = 640;